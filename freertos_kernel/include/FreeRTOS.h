@@ -58,6 +58,27 @@ extern "C" {
 /* Basic FreeRTOS definitions. */
 #include "projdefs.h"
 
+/* Must be defaulted before portable.h is included, as it declares the heap
+call site functions only if configHEAP_CALL_SITE_COUNT is not 0. */
+#ifndef configHEAP_CALL_SITE_COUNT
+	#define configHEAP_CALL_SITE_COUNT 0
+#endif
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+	/* The call site of pvPortMalloc() recorded by the heap, also used by the
+	wrappers that call pvPortMallocFrom() to give the call site of their own
+	caller. */
+	#ifndef configHEAP_CALL_SITE
+		#ifdef __GNUC__
+			/* The address the function that expands it returns to. */
+			#define configHEAP_CALL_SITE()	__builtin_return_address( 0 )
+		#else
+			/* The task that calls the function that expands it. */
+			#define configHEAP_CALL_SITE()	( ( void * ) xTaskGetCurrentTaskHandle() )
+		#endif
+	#endif
+#endif
+
 /* Definitions specific to the port being used. */
 #include "portable.h"
 
@@ -258,6 +279,26 @@ extern "C" {
 
 #endif /* configUSE_TIMERS */
 
+#ifndef configUSE_TIMER_WHEEL
+	/* Set to 1 to hold active timers in a hierarchical timing wheel, making
+	timer start, reset and stop constant time, instead of in two lists sorted
+	by expiry time. */
+	#define configUSE_TIMER_WHEEL 0
+#endif
+
+#ifndef configTIMER_WHEEL_SLOT_BITS
+	/* Each level of the timing wheel has ( 1 << configTIMER_WHEEL_SLOT_BITS )
+	slots, each of which is a List_t.  Must be between 1 and 5. */
+	#define configTIMER_WHEEL_SLOT_BITS 4
+#endif
+
+#ifndef configUSE_TIMER_DIRECT_COMMANDS
+	/* Set to 1 to let tasks apply timer commands to the timing wheel directly,
+	rather than through the timer command queue, while the timer service task
+	is blocked.  Requires configUSE_TIMER_WHEEL. */
+	#define configUSE_TIMER_DIRECT_COMMANDS 0
+#endif
+
 #ifndef portSET_INTERRUPT_MASK_FROM_ISR
 	#define portSET_INTERRUPT_MASK_FROM_ISR() 0
 #endif
@@ -484,6 +525,22 @@ extern "C" {
 	#define traceQUEUE_PEEK_FROM_ISR_FAILED( pxQueue )
 #endif
 
+#ifndef traceQUEUE_SEND_MULTIPLE
+	#define traceQUEUE_SEND_MULTIPLE( pxQueue, uxItemCount )
+#endif
+
+#ifndef traceQUEUE_SEND_MULTIPLE_FROM_ISR
+	#define traceQUEUE_SEND_MULTIPLE_FROM_ISR( pxQueue, uxItemCount )
+#endif
+
+#ifndef traceQUEUE_RECEIVE_MULTIPLE
+	#define traceQUEUE_RECEIVE_MULTIPLE( pxQueue, uxItemCount )
+#endif
+
+#ifndef traceQUEUE_RECEIVE_MULTIPLE_FROM_ISR
+	#define traceQUEUE_RECEIVE_MULTIPLE_FROM_ISR( pxQueue, uxItemCount )
+#endif
+
 #ifndef traceQUEUE_DELETE
 	#define traceQUEUE_DELETE( pxQueue )
 #endif
@@ -710,6 +767,31 @@ extern "C" {
 
 #endif /* configGENERATE_RUN_TIME_STATS */
 
+#ifndef configUSE_SCHEDULER_PROFILER
+	/* Set to 1 to record per task scheduling latency, run slice, preemption
+	and blocking statistics - see vTaskGetProfile() in task.h. */
+	#define configUSE_SCHEDULER_PROFILER 0
+#endif
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	#if ( configGENERATE_RUN_TIME_STATS == 0 )
+		#error configUSE_SCHEDULER_PROFILER requires configGENERATE_RUN_TIME_STATS to be set to 1, as the profiler is timed using the run time counter.
+	#endif /* configGENERATE_RUN_TIME_STATS */
+
+	#ifndef configPROFILER_HISTOGRAM_BUCKETS
+		/* Number of power of two buckets in each profiler histogram. */
+		#define configPROFILER_HISTOGRAM_BUCKETS 16
+	#endif
+
+	#ifndef configPROFILER_WAIT_OBJECTS
+		/* Number of queues, semaphores or event groups for which each task
+		records its blocking time separately. */
+		#define configPROFILER_WAIT_OBJECTS 4
+	#endif
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+
 #ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
 	#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
 #endif
@@ -841,6 +923,10 @@ extern "C" {
 	#define configMESSAGE_BUFFER_LENGTH_TYPE size_t
 #endif
 
+#ifndef configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS
+	#define configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS 0
+#endif
+
 /* Sanity check the configuration. */
 #if( configUSE_TICKLESS_IDLE != 0 )
 	#if( INCLUDE_vTaskSuspend != 1 )
@@ -1071,6 +1157,45 @@ typedef struct xSTATIC_LIST
 	#endif
 } StaticList_t;
 
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	/*
+	 * The scheduler profiler types are defined here, rather than in task.h,
+	 * because each TCB, and therefore StaticTask_t, contains a TaskProfile_t.
+	 * See vTaskGetProfile() in task.h.  All times are in run time counter
+	 * units.
+	 */
+
+	/* A histogram with power of two buckets.  A value v is counted in bucket 0
+	if it is 0, otherwise in the bucket given by the number of bits needed to
+	hold v, with the last bucket also counting all larger values. */
+	typedef struct xTASK_PROFILE_HISTOGRAM
+	{
+		uint32_t ulCount;										/*< Number of values recorded. */
+		uint32_t ulMax;											/*< Largest value recorded. */
+		uint32_t ulBuckets[ configPROFILER_HISTOGRAM_BUCKETS ];	/*< Number of values recorded in each bucket. */
+	} TaskProfileHistogram_t;
+
+	/* Time a task spent blocked on one object. */
+	typedef struct xTASK_PROFILE_WAIT
+	{
+		void *pvObject;			/*< The queue, semaphore or event group handle, or NULL for waits on no (or no other) object. */
+		uint32_t ulCount;		/*< Number of times the task blocked. */
+		uint32_t ulTotalTime;	/*< Total time from blocking until being made ready. */
+		uint32_t ulMaxTime;		/*< Longest time from blocking until being made ready. */
+	} TaskProfileWait_t;
+
+	typedef struct xTASK_PROFILE
+	{
+		TaskProfileHistogram_t xWakeLatency;	/*< Time from the task leaving the Blocked or Suspended state until it next runs. */
+		TaskProfileHistogram_t xRunSlice;		/*< Time the task ran each time it was switched in. */
+		uint32_t ulPreemptions;					/*< Number of times the task was switched out while still Ready. */
+		TaskProfileWait_t xWaits[ configPROFILER_WAIT_OBJECTS ];	/*< Blocking time on the first objects the task blocked on. */
+		TaskProfileWait_t xOtherWaits;			/*< Blocking time on no object (delays, notifications, suspension) or on objects that did not fit in xWaits. */
+	} TaskProfile_t;
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+
 /*
  * In line with software engineering best practice, especially when supplying a
  * library that is likely to change in future versions, FreeRTOS implements a
@@ -1132,6 +1257,12 @@ typedef struct xSTATIC_TCB
 	#if ( configUSE_POSIX_ERRNO == 1 )
 		int				iDummy22;
 	#endif
+	#if ( configUSE_SCHEDULER_PROFILER == 1 )
+		TaskProfile_t	xDummy23;
+		void			*pvDummy24;
+		uint32_t		ulDummy25;
+		uint8_t			ucDummy26;
+	#endif
 } StaticTask_t;
 
 /*
@@ -1257,6 +1388,9 @@ typedef struct xSTATIC_STREAM_BUFFER
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxDummy4;
 	#endif
+	#if ( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+		uint32_t ulDummy5[ 2 ];
+	#endif
 } StaticStreamBuffer_t;
 
 /* Message buffers are built on stream buffers. */
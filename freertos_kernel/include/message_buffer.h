@@ -795,6 +795,174 @@ BaseType_t xMessageBufferReceiveCompletedFromISR( MessageBufferHandle_t xStreamB
  */
 #define xMessageBufferReceiveCompletedFromISR( xMessageBuffer, pxHigherPriorityTaskWoken ) xStreamBufferReceiveCompletedFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pxHigherPriorityTaskWoken )
 
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferSendAcquire( MessageBufferHandle_t xMessageBuffer,
+                                  size_t xDataLengthBytes,
+                                  StreamBufferRegion_t * const pxRegion,
+                                  TickType_t xTicksToWait );
+size_t xMessageBufferSendAcquireFromISR( MessageBufferHandle_t xMessageBuffer,
+                                         size_t xDataLengthBytes,
+                                         StreamBufferRegion_t * const pxRegion );
+size_t xMessageBufferSendCommit( MessageBufferHandle_t xMessageBuffer, size_t xBytesWritten );
+size_t xMessageBufferSendCommitFromISR( MessageBufferHandle_t xMessageBuffer,
+                                        size_t xBytesWritten,
+                                        BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Writes a message in place.  xMessageBufferSendAcquire() hands out the space
+ * for a message of xDataLengthBytes bytes, waiting for up to xTicksToWait
+ * ticks for it to become free, or returns 0.  Once the message is written
+ * xMessageBufferSendCommit() makes it available to the reader, with the length
+ * xBytesWritten, which must not exceed the length acquired.  See
+ * xStreamBufferSendAcquire() and xStreamBufferSendCommit() in stream_buffer.h.
+ *
+ * \defgroup xMessageBufferSendAcquire xMessageBufferSendAcquire
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferSendAcquire( xMessageBuffer, xDataLengthBytes, pxRegion, xTicksToWait ) xStreamBufferSendAcquire( ( StreamBufferHandle_t ) xMessageBuffer, xDataLengthBytes, pxRegion, xTicksToWait )
+#define xMessageBufferSendAcquireFromISR( xMessageBuffer, xDataLengthBytes, pxRegion ) xStreamBufferSendAcquireFromISR( ( StreamBufferHandle_t ) xMessageBuffer, xDataLengthBytes, pxRegion )
+#define xMessageBufferSendCommit( xMessageBuffer, xBytesWritten ) xStreamBufferSendCommit( ( StreamBufferHandle_t ) xMessageBuffer, xBytesWritten )
+#define xMessageBufferSendCommitFromISR( xMessageBuffer, xBytesWritten, pxHigherPriorityTaskWoken ) xStreamBufferSendCommitFromISR( ( StreamBufferHandle_t ) xMessageBuffer, xBytesWritten, pxHigherPriorityTaskWoken )
+
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferReceiveAcquire( MessageBufferHandle_t xMessageBuffer,
+                                     StreamBufferRegion_t * const pxRegion,
+                                     TickType_t xTicksToWait );
+size_t xMessageBufferReceiveAcquireFromISR( MessageBufferHandle_t xMessageBuffer,
+                                            StreamBufferRegion_t * const pxRegion );
+size_t xMessageBufferReceiveRelease( MessageBufferHandle_t xMessageBuffer, size_t xBytesConsumed );
+size_t xMessageBufferReceiveReleaseFromISR( MessageBufferHandle_t xMessageBuffer,
+                                            size_t xBytesConsumed,
+                                            BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Reads a message in place.  xMessageBufferReceiveAcquire() hands out the next
+ * message, waiting for up to xTicksToWait ticks for one to arrive, and returns
+ * its length, or 0.  Once the message has been used
+ * xMessageBufferReceiveRelease() removes it from the buffer - xBytesConsumed
+ * must be the length returned by xMessageBufferReceiveAcquire().  See
+ * xStreamBufferReceiveAcquire() and xStreamBufferReceiveRelease() in
+ * stream_buffer.h.
+ *
+ * \defgroup xMessageBufferReceiveAcquire xMessageBufferReceiveAcquire
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferReceiveAcquire( xMessageBuffer, pxRegion, xTicksToWait ) xStreamBufferReceiveAcquire( ( StreamBufferHandle_t ) xMessageBuffer, pxRegion, xTicksToWait )
+#define xMessageBufferReceiveAcquireFromISR( xMessageBuffer, pxRegion ) xStreamBufferReceiveAcquireFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pxRegion )
+#define xMessageBufferReceiveRelease( xMessageBuffer, xBytesConsumed ) xStreamBufferReceiveRelease( ( StreamBufferHandle_t ) xMessageBuffer, xBytesConsumed )
+#define xMessageBufferReceiveReleaseFromISR( xMessageBuffer, xBytesConsumed, pxHigherPriorityTaskWoken ) xStreamBufferReceiveReleaseFromISR( ( StreamBufferHandle_t ) xMessageBuffer, xBytesConsumed, pxHigherPriorityTaskWoken )
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+/**
+ * message_buffer.h
+ *
+<pre>
+MessageBufferHandle_t xMessageBufferCreateMultiProducer( size_t xBufferSizeBytes );
+MessageBufferHandle_t xMessageBufferCreateMultiProducerStatic( size_t xBufferSizeBytes,
+                                                               uint8_t *pucMessageBufferStorageArea,
+                                                               StaticMessageBuffer_t *pxStaticMessageBuffer );
+</pre>
+ *
+ * Creates a message buffer that any number of tasks and interrupts can send
+ * to at the same time, and that one task or interrupt reads from.  Sending
+ * reserves space with an atomic compare and swap (see atomic.h) rather than a
+ * critical section.  configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS must be set to 1
+ * in FreeRTOSConfig.h for these functions to be available.  Send and receive with
+ * the xMessageBufferMultiProducer*() macros below.  xMessageBufferReset(),
+ * vMessageBufferDelete(), xMessageBufferSpaceAvailable(),
+ * xMessageBufferIsEmpty(), xMessageBufferIsFull() and
+ * xMessageBufferNextLengthBytes() can be used as for any message buffer.
+ *
+ * Each message takes its length rounded up to a multiple of 8 bytes, plus an
+ * 8 byte header, of buffer space, and a message is never split across the end
+ * of the buffer.  Only the largest power of two bytes of the buffer is used,
+ * so xBufferSizeBytes is best a power of two.
+ * pucMessageBufferStorageArea must be aligned to 4 bytes.  Otherwise the
+ * parameters and return value are as for xMessageBufferCreate() and
+ * xMessageBufferCreateStatic().
+ *
+ * \defgroup xMessageBufferCreateMultiProducer xMessageBufferCreateMultiProducer
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferCreateMultiProducer( xBufferSizeBytes ) ( MessageBufferHandle_t ) xStreamBufferGenericCreate( xBufferSizeBytes, ( size_t ) 0, sbMULTI_PRODUCER_MESSAGE_BUFFER )
+#define xMessageBufferCreateMultiProducerStatic( xBufferSizeBytes, pucMessageBufferStorageArea, pxStaticMessageBuffer ) ( MessageBufferHandle_t ) xStreamBufferGenericCreateStatic( xBufferSizeBytes, 0, sbMULTI_PRODUCER_MESSAGE_BUFFER, pucMessageBufferStorageArea, pxStaticMessageBuffer )
+
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferMultiProducerSend( MessageBufferHandle_t xMessageBuffer,
+                                        const void *pvTxData,
+                                        size_t xDataLengthBytes );
+size_t xMessageBufferMultiProducerSendFromISR( MessageBufferHandle_t xMessageBuffer,
+                                               const void *pvTxData,
+                                               size_t xDataLengthBytes,
+                                               BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Sends a message to a multi-producer message buffer.  The sender never blocks
+ * - xDataLengthBytes is returned if the message was written, or 0 if it did not
+ * fit.  See xStreamBufferMultiProducerSend() in stream_buffer.h.
+ *
+ * Example use:
+<pre>
+void vAnInterruptServiceRoutine( void )
+{
+uint8_t ucEvent[ 6 ];
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    // Tasks send to xMessageBuffer with xMessageBufferMultiProducerSend() at
+    // the same time as this interrupt, without a critical section.
+    if( xMessageBufferMultiProducerSendFromISR( xMessageBuffer,
+                                                ( void * ) ucEvent,
+                                                sizeof( ucEvent ),
+                                                &xHigherPriorityTaskWoken ) == 0 )
+    {
+        // The message buffer was full, so the event was dropped.
+    }
+
+    portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
+}
+</pre>
+ * \defgroup xMessageBufferMultiProducerSend xMessageBufferMultiProducerSend
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferMultiProducerSend( xMessageBuffer, pvTxData, xDataLengthBytes ) xStreamBufferMultiProducerSend( ( StreamBufferHandle_t ) xMessageBuffer, pvTxData, xDataLengthBytes )
+#define xMessageBufferMultiProducerSendFromISR( xMessageBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferMultiProducerSendFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pvTxData, xDataLengthBytes, pxHigherPriorityTaskWoken )
+
+/**
+ * message_buffer.h
+ *
+<pre>
+size_t xMessageBufferMultiProducerReceive( MessageBufferHandle_t xMessageBuffer,
+                                           void *pvRxData,
+                                           size_t xBufferLengthBytes,
+                                           TickType_t xTicksToWait );
+size_t xMessageBufferMultiProducerReceiveFromISR( MessageBufferHandle_t xMessageBuffer,
+                                                  void *pvRxData,
+                                                  size_t xBufferLengthBytes,
+                                                  BaseType_t *pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * Receives the next message from a multi-producer message buffer, as
+ * xMessageBufferReceive() does.  See xStreamBufferMultiProducerReceive() in
+ * stream_buffer.h.
+ *
+ * \defgroup xMessageBufferMultiProducerReceive xMessageBufferMultiProducerReceive
+ * \ingroup MessageBufferManagement
+ */
+#define xMessageBufferMultiProducerReceive( xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait ) xStreamBufferMultiProducerReceive( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, xTicksToWait )
+#define xMessageBufferMultiProducerReceiveFromISR( xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken ) xStreamBufferMultiProducerReceiveFromISR( ( StreamBufferHandle_t ) xMessageBuffer, pvRxData, xBufferLengthBytes, pxHigherPriorityTaskWoken )
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+
 #if defined( __cplusplus )
 } /* extern "C" */
 #endif
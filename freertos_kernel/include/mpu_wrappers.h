@@ -78,6 +78,9 @@ only for ports that are using the MPU. */
 		#define vTaskList								MPU_vTaskList
 		#define vTaskGetRunTimeStats					MPU_vTaskGetRunTimeStats
 		#define xTaskGetIdleRunTimeCounter				MPU_xTaskGetIdleRunTimeCounter
+		#define vTaskGetProfile							MPU_vTaskGetProfile
+		#define vTaskResetProfile						MPU_vTaskResetProfile
+		#define xTaskSerialiseProfile					MPU_xTaskSerialiseProfile
 		#define xTaskGenericNotify						MPU_xTaskGenericNotify
 		#define xTaskNotifyWait							MPU_xTaskNotifyWait
 		#define ulTaskNotifyTake						MPU_ulTaskNotifyTake
@@ -91,6 +94,8 @@ only for ports that are using the MPU. */
 		/* Map standard queue.h API functions to the MPU equivalents. */
 		#define xQueueGenericSend						MPU_xQueueGenericSend
 		#define xQueueReceive							MPU_xQueueReceive
+		#define uxQueueSendMultiple						MPU_uxQueueSendMultiple
+		#define uxQueueReceiveMultiple					MPU_uxQueueReceiveMultiple
 		#define xQueuePeek								MPU_xQueuePeek
 		#define xQueueSemaphoreTake						MPU_xQueueSemaphoreTake
 		#define uxQueueMessagesWaiting					MPU_uxQueueMessagesWaiting
@@ -144,6 +149,12 @@ only for ports that are using the MPU. */
 		equivalents. */
 		#define xStreamBufferSend						MPU_xStreamBufferSend
 		#define xStreamBufferReceive					MPU_xStreamBufferReceive
+		#define xStreamBufferSendAcquire				MPU_xStreamBufferSendAcquire
+		#define xStreamBufferSendCommit					MPU_xStreamBufferSendCommit
+		#define xStreamBufferReceiveAcquire				MPU_xStreamBufferReceiveAcquire
+		#define xStreamBufferReceiveRelease				MPU_xStreamBufferReceiveRelease
+		#define xStreamBufferMultiProducerSend			MPU_xStreamBufferMultiProducerSend
+		#define xStreamBufferMultiProducerReceive		MPU_xStreamBufferMultiProducerReceive
 		#define xStreamBufferNextMessageLengthBytes		MPU_xStreamBufferNextMessageLengthBytes
 		#define vStreamBufferDelete						MPU_vStreamBufferDelete
 		#define xStreamBufferIsFull						MPU_xStreamBufferIsFull
@@ -144,6 +144,71 @@ void vPortInitialiseBlocks( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 size_t xPortGetMinimumEverFreeHeapSize( void ) PRIVILEGED_FUNCTION;
 
+/* The number of entries in the xFreeBlockHistogram member of HeapStats_t. */
+#define portHEAP_HISTOGRAM_SIZE		12
+
+/* Used by vPortGetHeapStats() to pass information about the heap out. */
+typedef struct xHeapStats
+{
+	size_t xAvailableHeapSpaceInBytes;		/* The total heap size currently available - this is the sum of all the free blocks, not the largest block that can be allocated. */
+	size_t xSizeOfLargestFreeBlockInBytes;	/* The maximum size, in bytes, of all the free blocks within the heap at the time vPortGetHeapStats() is called. */
+	size_t xSizeOfSmallestFreeBlockInBytes;	/* The minimum size, in bytes, of all the free blocks within the heap at the time vPortGetHeapStats() is called. */
+	size_t xNumberOfFreeBlocks;				/* The number of free memory blocks within the heap at the time vPortGetHeapStats() is called. */
+	size_t xMinimumEverFreeBytesRemaining;	/* The minimum amount of total free memory (sum of all free blocks) there has been in the heap since the system booted. */
+	size_t xNumberOfSuccessfulAllocations;	/* The number of calls to pvPortMalloc() that have returned a valid memory block. */
+	size_t xNumberOfSuccessfulFrees;		/* The number of calls to vPortFree() that has successfully freed a block of memory. */
+	UBaseType_t uxFragmentationPercent;		/* The part of the free heap that is not in the largest free block, from 0 (one free block) to 100. */
+	size_t xFreeBlockHistogram[ portHEAP_HISTOGRAM_SIZE ];	/* Entry n counts the free blocks of less than ( 32 << n ) bytes not counted in entry n - 1; the last entry counts all the larger blocks. */
+} HeapStats_t;
+
+/*
+ * Fills a HeapStats_t structure with information about the free blocks of the
+ * heap.  The free list is walked with the scheduler suspended, so the time
+ * taken grows with the number of free blocks.  Implemented by heap_4.c.
+ */
+void vPortGetHeapStats( HeapStats_t *pxHeapStats ) PRIVILEGED_FUNCTION;
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+
+	/* Used by uxPortGetHeapCallSites() to pass the heap usage of each call site
+	of pvPortMalloc() out. */
+	typedef struct xHeapCallSite
+	{
+		void *pvCallSite;		/* The value of configHEAP_CALL_SITE() in the calls to pvPortMalloc(), or NULL for the entry that collects the call sites that did not fit in the table. */
+		size_t xLiveBytes;		/* The heap space, block headers included, of the blocks allocated from the call site and not yet freed. */
+		size_t xLiveBlocks;		/* The number of blocks allocated from the call site and not yet freed. */
+		size_t xPeakLiveBytes;	/* The largest value xLiveBytes has had. */
+		size_t xAllocations;	/* The number of successful allocations from the call site. */
+		size_t xFailures;		/* The number of allocations from the call site that returned NULL. */
+	} HeapCallSite_t;
+
+	/*
+	 * Allocates as pvPortMalloc(), but records the allocation under pvCallSite
+	 * rather than under the caller.  Used by allocation wrappers, which pass
+	 * configHEAP_CALL_SITE() so that the blocks are recorded under the call site
+	 * of the wrapper.  Implemented by heap_4.c.
+	 */
+	void *pvPortMallocFrom( size_t xSize, void *pvCallSite ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Copies up to uxMaxCount entries of the table of call sites of pvPortMalloc()
+	 * to pxCallSites, and returns the number of entries in use in the table.  The
+	 * table holds configHEAP_CALL_SITE_COUNT entries, the last of which collects
+	 * the call sites found once the others are taken.  Implemented by heap_4.c.
+	 */
+	UBaseType_t uxPortGetHeapCallSites( HeapCallSite_t *pxCallSites, UBaseType_t uxMaxCount ) PRIVILEGED_FUNCTION;
+
+#endif /* configHEAP_CALL_SITE_COUNT */
+
+/*
+ * Writes a human readable report of the heap to pcWriteBuffer: the information
+ * returned by vPortGetHeapStats() then, if configHEAP_CALL_SITE_COUNT is not 0,
+ * one line per call site of pvPortMalloc().  The report is truncated to
+ * xBufferLength bytes, the terminating null included.  Implemented by heap_4.c
+ * when configUSE_STATS_FORMATTING_FUNCTIONS is not 0.
+ */
+void vPortGetHeapReport( char *pcWriteBuffer, size_t xBufferLength ) PRIVILEGED_FUNCTION;
+
 /*
  * Setup the hardware ready for the scheduler to take control.  This generally
  * sets up a tick interrupt and sets timers for the correct tick frequency.
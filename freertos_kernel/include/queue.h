@@ -867,6 +867,144 @@ BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue, void * const pvBuffer ) PRIV
  */
 BaseType_t xQueueReceive( QueueHandle_t xQueue, void * const pvBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t uxQueueSendMultiple(
+									QueueHandle_t xQueue,
+									const void * const pvItems,
+									const UBaseType_t uxItemCount,
+									TickType_t xTicksToWait
+								);
+ * </pre>
+ *
+ * Post several items to the back of a queue.  As many of the items as there is
+ * space for are copied onto the queue, and the tasks waiting to receive them
+ * are unblocked, within a single critical section, so the cost of entering and
+ * leaving the kernel is paid once for the whole batch rather than once per
+ * item.  The remaining items, if any, are posted as space becomes available,
+ * for up to xTicksToWait ticks.
+ *
+ * The items are queued by copy, in order.  The queue must have been created
+ * with a non zero item size, so semaphores and mutexes cannot be given with
+ * this function.
+ *
+ * This function must not be called from an interrupt service routine.
+ * See uxQueueSendMultipleFromISR() for an alternative which may be used
+ * in an ISR.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItems A pointer to an array of uxItemCount items, each of the size
+ * defined when the queue was created.
+ *
+ * @param uxItemCount The number of items to post.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for space to become available on the queue should it be full.  The
+ * call will return immediately, having posted only the items that fit, if this
+ * is set to 0.
+ *
+ * @return The number of items posted, from the start of pvItems.  This is less
+ * than uxItemCount if the block time expired before all the items could be
+ * posted.
+ *
+ * Example usage:
+   <pre>
+ #define BATCH_SIZE 8
+
+ void vASensorTask( void *pvParameters )
+ {
+ uint32_t ulSamples[ BATCH_SIZE ];
+ UBaseType_t uxSent;
+
+	// Create a queue capable of containing 64 uint32_t values.
+	xQueue = xQueueCreate( 64, sizeof( uint32_t ) );
+
+	for( ;; )
+	{
+		vReadSamples( ulSamples, BATCH_SIZE );
+
+		// Post the samples, blocking for up to 10 ticks if the queue is full.
+		uxSent = uxQueueSendMultiple( xQueue, ulSamples, BATCH_SIZE, ( TickType_t ) 10 );
+
+		if( uxSent != BATCH_SIZE )
+		{
+			// The last BATCH_SIZE - uxSent samples were not posted.
+		}
+	}
+ }
+ </pre>
+ * \defgroup uxQueueSendMultiple uxQueueSendMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItemCount, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t uxQueueReceiveMultiple(
+									QueueHandle_t xQueue,
+									void * const pvBuffer,
+									const UBaseType_t uxMaxItems,
+									TickType_t xTicksToWait
+								);
+ * </pre>
+ *
+ * Receive several items from a queue.  Up to uxMaxItems of the items in the
+ * queue are copied out, and the tasks waiting for space on the queue are
+ * unblocked, within a single critical section.  If the queue is empty the
+ * calling task blocks for up to xTicksToWait ticks for an item to arrive, then
+ * returns the items available at that time - it does not wait for uxMaxItems
+ * items to be available.
+ *
+ * The queue must have been created with a non zero item size.
+ *
+ * This function must not be used in an interrupt service routine.  See
+ * uxQueueReceiveMultipleFromISR for an alternative that can.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the received items will
+ * be copied.  The buffer must be large enough to hold uxMaxItems items.
+ *
+ * @param uxMaxItems The maximum number of items to receive.  Must be greater
+ * than 0.
+ *
+ * @param xTicksToWait The maximum amount of time the task should block
+ * waiting for an item to receive should the queue be empty at the time
+ * of the call.  uxQueueReceiveMultiple() will return immediately if
+ * xTicksToWait is zero and the queue is empty.
+ *
+ * @return The number of items received, which is 0 if the block time expired
+ * before any item was available.
+ *
+ * Example usage:
+   <pre>
+ void vAProcessingTask( void *pvParameters )
+ {
+ uint32_t ulSamples[ BATCH_SIZE ];
+ UBaseType_t uxReceived, uxSample;
+
+	for( ;; )
+	{
+		// Wait for up to 100 ticks for samples to arrive, then take up to
+		// BATCH_SIZE of them at once.
+		uxReceived = uxQueueReceiveMultiple( xQueue, ulSamples, BATCH_SIZE, ( TickType_t ) 100 );
+
+		for( uxSample = 0; uxSample < uxReceived; uxSample++ )
+		{
+			vProcessSample( ulSamples[ uxSample ] );
+		}
+	}
+ }
+ </pre>
+ * \defgroup uxQueueReceiveMultiple uxQueueReceiveMultiple
+ * \ingroup QueueManagement
+ */
+UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
 /**
  * queue. h
  * <pre>UBaseType_t uxQueueMessagesWaiting( const QueueHandle_t xQueue );</pre>
@@ -1384,6 +1522,78 @@ BaseType_t xQueueGiveFromISR( QueueHandle_t xQueue, BaseType_t * const pxHigherP
  */
 BaseType_t xQueueReceiveFromISR( QueueHandle_t xQueue, void * const pvBuffer, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t uxQueueSendMultipleFromISR(
+										QueueHandle_t xQueue,
+										const void * const pvItems,
+										const UBaseType_t uxItemCount,
+										BaseType_t *pxHigherPriorityTaskWoken
+									);
+ * </pre>
+ *
+ * A version of uxQueueSendMultiple() that can be called from an interrupt
+ * service routine.  As many of the items as there is space for are posted,
+ * with interrupts masked only once.  If the queue is locked by a task at the
+ * time of the call at most 127 items, less the items already posted while it
+ * was locked, are posted, as the task unlocking the queue must be able to
+ * count them.
+ *
+ * @param xQueue The handle to the queue on which the items are to be posted.
+ *
+ * @param pvItems A pointer to an array of uxItemCount items.
+ *
+ * @param uxItemCount The number of items to post.
+ *
+ * @param pxHigherPriorityTaskWoken uxQueueSendMultipleFromISR() will set
+ * *pxHigherPriorityTaskWoken to pdTRUE if posting the items caused a task to
+ * unblock, and the unblocked task has a priority higher than the currently
+ * running task.  If uxQueueSendMultipleFromISR() sets this value to pdTRUE
+ * then a context switch should be requested before the interrupt is exited.
+ *
+ * @return The number of items posted, from the start of pvItems.
+ *
+ * \defgroup uxQueueSendMultipleFromISR uxQueueSendMultipleFromISR
+ * \ingroup QueueManagement
+ */
+UBaseType_t uxQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * queue. h
+ * <pre>
+ UBaseType_t uxQueueReceiveMultipleFromISR(
+										QueueHandle_t xQueue,
+										void * const pvBuffer,
+										const UBaseType_t uxMaxItems,
+										BaseType_t *pxHigherPriorityTaskWoken
+									);
+ * </pre>
+ *
+ * A version of uxQueueReceiveMultiple() that can be called from an interrupt
+ * service routine.  Up to uxMaxItems items are received, with interrupts
+ * masked only once.  As with uxQueueSendMultipleFromISR(), at most 127 items
+ * are removed from a queue that is locked by a task.
+ *
+ * @param xQueue The handle to the queue from which the items are to be
+ * received.
+ *
+ * @param pvBuffer Pointer to the buffer into which the received items will
+ * be copied.  The buffer must be large enough to hold uxMaxItems items.
+ *
+ * @param uxMaxItems The maximum number of items to receive.
+ *
+ * @param pxHigherPriorityTaskWoken Set to pdTRUE if removing the items caused
+ * a task waiting for space on the queue to unblock, and the unblocked task has
+ * a priority higher than the currently running task, otherwise left unchanged.
+ *
+ * @return The number of items received.
+ *
+ * \defgroup uxQueueReceiveMultipleFromISR uxQueueReceiveMultipleFromISR
+ * \ingroup QueueManagement
+ */
+UBaseType_t uxQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
 /*
  * Utilities to query queues that are safe to use from an ISR.  These utilities
  * should be used only from witin an ISR, or within a critical section.
@@ -68,6 +68,20 @@ extern "C" {
 struct StreamBufferDef_t;
 typedef struct StreamBufferDef_t * StreamBufferHandle_t;
 
+/**
+ * Describes a part of the storage area of a stream buffer handed out by
+ * xStreamBufferSendAcquire() or xStreamBufferReceiveAcquire().  The part wraps
+ * around the end of the storage area if pucSecond is not NULL, in which case
+ * the bytes at pucSecond follow the bytes at pucFirst.
+ */
+typedef struct StreamBufferRegion
+{
+	uint8_t *pucFirst;				/* The first contiguous part of the region. */
+	size_t xFirstLengthBytes;		/* The number of bytes at pucFirst. */
+	uint8_t *pucSecond;				/* The start of the storage area if the region wraps, otherwise NULL. */
+	size_t xSecondLengthBytes;		/* The number of bytes at pucSecond, or 0. */
+} StreamBufferRegion_t;
+
 
 /**
  * message_buffer.h
@@ -833,7 +847,402 @@ BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuf
  */
 BaseType_t xStreamBufferReceiveCompletedFromISR( StreamBufferHandle_t xStreamBuffer, BaseType_t *pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
 
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+                                 size_t xDataLengthBytes,
+                                 StreamBufferRegion_t * const pxRegion,
+                                 TickType_t xTicksToWait );
+</pre>
+ *
+ * Hands out free space in a stream buffer for the writer to fill in place, for
+ * example as the destination of a DMA transfer, rather than having the data
+ * copied in by xStreamBufferSend().  The data only becomes available to the
+ * reader when xStreamBufferSendCommit() is called.  The same single writer
+ * rules as xStreamBufferSend() apply, and the writer must not send anything
+ * else to the buffer between the two calls.
+ *
+ * The space handed out is described in *pxRegion, as one contiguous part or
+ * as two parts if it wraps around the end of the storage area.
+ *
+ * Use xStreamBufferSendAcquireFromISR() in an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to write to.
+ *
+ * @param xDataLengthBytes The number of bytes wanted.  A stream buffer hands
+ * out as much of this as is free.  A message buffer hands out space for a
+ * message of exactly this length, or nothing.
+ *
+ * @param pxRegion Receives the description of the space handed out.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for xDataLengthBytes bytes to become
+ * free, as for xStreamBufferSend().
+ *
+ * @return The number of bytes handed out, which is 0 if no space was free.
+ *
+ * Example use:
+<pre>
+void vAFunction( StreamBufferHandle_t xStreamBuffer )
+{
+StreamBufferRegion_t xRegion;
+size_t xLength;
+
+    // Wait up to 100ms for 64 bytes to become free.
+    xLength = xStreamBufferSendAcquire( xStreamBuffer, 64, &xRegion, pdMS_TO_TICKS( 100 ) );
+
+    if( xLength > 0 )
+    {
+        // Have the UART driver receive directly into the stream buffer.
+        xLength = xUARTRead( xRegion.pucFirst, xRegion.xFirstLengthBytes );
+
+        // Make the bytes received available to the reader.
+        ( void ) xStreamBufferSendCommit( xStreamBuffer, xLength );
+    }
+}
+</pre>
+ * \defgroup xStreamBufferSendAcquire xStreamBufferSendAcquire
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+								 size_t xDataLengthBytes,
+								 StreamBufferRegion_t * const pxRegion,
+								 TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferSendAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+                                        size_t xDataLengthBytes,
+                                        StreamBufferRegion_t * const pxRegion );
+</pre>
+ *
+ * A version of xStreamBufferSendAcquire() that can be called from an interrupt
+ * service routine.  It never blocks.
+ *
+ * \defgroup xStreamBufferSendAcquireFromISR xStreamBufferSendAcquireFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										size_t xDataLengthBytes,
+										StreamBufferRegion_t * const pxRegion ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer, size_t xBytesWritten );
+</pre>
+ *
+ * Makes the first xBytesWritten bytes of the space handed out by the last call
+ * to xStreamBufferSendAcquire() available to the reader, and unblocks the
+ * reader if the trigger level is reached.  The bytes are taken from the start
+ * of the region, first part first.  For a message buffer xBytesWritten is the
+ * length of the message, which may be less than the length asked for when the
+ * space was acquired.  The space not committed is returned to the buffer.
+ *
+ * Use xStreamBufferSendCommitFromISR() in an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer written to.
+ *
+ * @param xBytesWritten The number of bytes written in place.  Committing 0
+ * bytes writes nothing.
+ *
+ * @return The number of bytes made available to the reader.
+ *
+ * \defgroup xStreamBufferSendCommit xStreamBufferSendCommit
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer, size_t xBytesWritten ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+                                       size_t xBytesWritten,
+                                       BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * A version of xStreamBufferSendCommit() that can be called from an interrupt
+ * service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if the reader
+ * was unblocked and has a priority above that of the interrupted task, as for
+ * xStreamBufferSendFromISR().
+ *
+ * \defgroup xStreamBufferSendCommitFromISR xStreamBufferSendCommitFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+									   size_t xBytesWritten,
+									   BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+                                    StreamBufferRegion_t * const pxRegion,
+                                    TickType_t xTicksToWait );
+</pre>
+ *
+ * Hands out the data in a stream buffer for the reader to use in place, for
+ * example to parse it or as the source of a DMA transfer, rather than having
+ * it copied out by xStreamBufferReceive().  The data stays in the buffer until
+ * xStreamBufferReceiveRelease() is called.  The same single reader rules as
+ * xStreamBufferReceive() apply.
+ *
+ * The data is described in *pxRegion, as one contiguous part or as two parts
+ * if it wraps around the end of the storage area.
+ *
+ * Use xStreamBufferReceiveAcquireFromISR() in an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer to read from.
+ *
+ * @param pxRegion Receives the description of the data handed out - all the
+ * bytes available in a stream buffer, or the next message in a message buffer.
+ *
+ * @param xTicksToWait The maximum amount of time the calling task should
+ * remain in the Blocked state to wait for data, as for xStreamBufferReceive().
+ *
+ * @return The number of bytes handed out, which is 0 if no data was
+ * available.
+ *
+ * Example use:
+<pre>
+void vAFunction( StreamBufferHandle_t xStreamBuffer )
+{
+StreamBufferRegion_t xRegion;
+size_t xLength, xParsed;
+
+    xLength = xStreamBufferReceiveAcquire( xStreamBuffer, &xRegion, portMAX_DELAY );
+
+    if( xLength > 0 )
+    {
+        // Parse the complete records in the first part of the data.
+        xParsed = xParseRecords( xRegion.pucFirst, xRegion.xFirstLengthBytes );
+
+        // Remove the parsed bytes, leaving any partial record in place.
+        ( void ) xStreamBufferReceiveRelease( xStreamBuffer, xParsed );
+    }
+}
+</pre>
+ * \defgroup xStreamBufferReceiveAcquire xStreamBufferReceiveAcquire
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+									StreamBufferRegion_t * const pxRegion,
+									TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReceiveAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+                                           StreamBufferRegion_t * const pxRegion );
+</pre>
+ *
+ * A version of xStreamBufferReceiveAcquire() that can be called from an
+ * interrupt service routine.  It never blocks.
+ *
+ * \defgroup xStreamBufferReceiveAcquireFromISR xStreamBufferReceiveAcquireFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										   StreamBufferRegion_t * const pxRegion ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReceiveRelease( StreamBufferHandle_t xStreamBuffer, size_t xBytesConsumed );
+</pre>
+ *
+ * Removes the first xBytesConsumed bytes of the data handed out by the last
+ * call to xStreamBufferReceiveAcquire() from the buffer, and unblocks the
+ * writer if it was waiting for space.  A message buffer always removes the
+ * whole message, so xBytesConsumed must be the length of the message.
+ *
+ * Use xStreamBufferReceiveReleaseFromISR() in an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the stream buffer read from.
+ *
+ * @param xBytesConsumed The number of bytes to remove.  Releasing 0 bytes
+ * leaves the buffer unchanged.
+ *
+ * @return The number of bytes removed.
+ *
+ * \defgroup xStreamBufferReceiveRelease xStreamBufferReceiveRelease
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveRelease( StreamBufferHandle_t xStreamBuffer, size_t xBytesConsumed ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferReceiveReleaseFromISR( StreamBufferHandle_t xStreamBuffer,
+                                           size_t xBytesConsumed,
+                                           BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * A version of xStreamBufferReceiveRelease() that can be called from an
+ * interrupt service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if
+ * the writer was unblocked and has a priority above that of the interrupted
+ * task, as for xStreamBufferReceiveFromISR().
+ *
+ * \defgroup xStreamBufferReceiveReleaseFromISR xStreamBufferReceiveReleaseFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferReceiveReleaseFromISR( StreamBufferHandle_t xStreamBuffer,
+										   size_t xBytesConsumed,
+										   BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferMultiProducerSend( StreamBufferHandle_t xStreamBuffer,
+                                       const void *pvTxData,
+                                       size_t xDataLengthBytes );
+</pre>
+ *
+ * Sends a message to a message buffer created with
+ * xMessageBufferCreateMultiProducer() or
+ * xMessageBufferCreateMultiProducerStatic().  Use the
+ * xMessageBufferMultiProducerSend() macro in message_buffer.h rather than
+ * calling this function directly.
+ *
+ * Unlike xStreamBufferSend(), any number of tasks and interrupts can send to
+ * the same multi-producer message buffer at the same time without a critical
+ * section.  Each message is written to a record whose space is reserved with
+ * a single atomic compare and swap, and the message becomes visible to the
+ * reader when its record is marked as committed.  The message is copied into
+ * the buffer without interrupts being disabled.
+ *
+ * The sender never blocks - if the message does not fit it is not written and
+ * 0 is returned.  Use xStreamBufferMultiProducerSendFromISR() in an interrupt
+ * service routine.
+ *
+ * @param xStreamBuffer The handle of the message buffer to which the message
+ * is being sent.
+ *
+ * @param pvTxData A pointer to the message to copy into the buffer.
+ *
+ * @param xDataLengthBytes The length of the message in bytes.  The message
+ * takes the length rounded up to a multiple of 8 bytes, plus an 8 byte
+ * header, of buffer space.
+ *
+ * @return xDataLengthBytes if the message was written, or 0 if there was not
+ * enough free space.
+ *
+ * \defgroup xStreamBufferMultiProducerSend xStreamBufferMultiProducerSend
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferMultiProducerSend( StreamBufferHandle_t xStreamBuffer,
+									   const void *pvTxData,
+									   size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferMultiProducerSendFromISR( StreamBufferHandle_t xStreamBuffer,
+                                              const void *pvTxData,
+                                              size_t xDataLengthBytes,
+                                              BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * A version of xStreamBufferMultiProducerSend() that can be called from an
+ * interrupt service routine.  *pxHigherPriorityTaskWoken is set to pdTRUE if
+ * the reader was unblocked and has a priority above that of the interrupted
+ * task, as for xStreamBufferSendFromISR().
+ *
+ * \defgroup xStreamBufferMultiProducerSendFromISR xStreamBufferMultiProducerSendFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferMultiProducerSendFromISR( StreamBufferHandle_t xStreamBuffer,
+											  const void *pvTxData,
+											  size_t xDataLengthBytes,
+											  BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferMultiProducerReceive( StreamBufferHandle_t xStreamBuffer,
+                                          void *pvRxData,
+                                          size_t xBufferLengthBytes,
+                                          TickType_t xTicksToWait );
+</pre>
+ *
+ * Receives the next message from a multi-producer message buffer, waiting for
+ * up to xTicksToWait ticks for one to arrive.  Use the
+ * xMessageBufferMultiProducerReceive() macro in message_buffer.h rather than
+ * calling this function directly.
+ *
+ * Messages are received in the order their records were reserved, so a
+ * message committed after a record that is still being written is not received
+ * until that record is committed too.  There must only be one reader, as for
+ * xStreamBufferReceive().  Use xStreamBufferMultiProducerReceiveFromISR() in
+ * an interrupt service routine.
+ *
+ * @param xStreamBuffer The handle of the message buffer from which a message
+ * is being received.
+ *
+ * @param pvRxData A pointer to the buffer into which the message is copied.
+ *
+ * @param xBufferLengthBytes The length of the buffer pointed to by pvRxData.
+ * The message is left in the message buffer if it is longer.
+ *
+ * @param xTicksToWait The maximum amount of time the task should remain in the
+ * Blocked state to wait for a message, should the message buffer be empty.
+ *
+ * @return The length, in bytes, of the message received, or 0 if no message
+ * was received.
+ *
+ * \defgroup xStreamBufferMultiProducerReceive xStreamBufferMultiProducerReceive
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferMultiProducerReceive( StreamBufferHandle_t xStreamBuffer,
+										  void *pvRxData,
+										  size_t xBufferLengthBytes,
+										  TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/**
+ * stream_buffer.h
+ *
+<pre>
+size_t xStreamBufferMultiProducerReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
+                                                 void *pvRxData,
+                                                 size_t xBufferLengthBytes,
+                                                 BaseType_t * const pxHigherPriorityTaskWoken );
+</pre>
+ *
+ * A version of xStreamBufferMultiProducerReceive() that can be called from an
+ * interrupt service routine.  The senders to a multi-producer message buffer
+ * never block, so *pxHigherPriorityTaskWoken is left unchanged.
+ *
+ * \defgroup xStreamBufferMultiProducerReceiveFromISR xStreamBufferMultiProducerReceiveFromISR
+ * \ingroup StreamBufferManagement
+ */
+size_t xStreamBufferMultiProducerReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
+												 void *pvRxData,
+												 size_t xBufferLengthBytes,
+												 BaseType_t * const pxHigherPriorityTaskWoken ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+
 /* Functions below here are not part of the public API. */
+
+/* Passed as the xIsMessageBuffer parameter of the functions below to create a
+multi-producer message buffer. */
+#define sbMULTI_PRODUCER_MESSAGE_BUFFER ( ( BaseType_t ) 2 )
+
 StreamBufferHandle_t xStreamBufferGenericCreate( size_t xBufferSizeBytes,
 												 size_t xTriggerLevelBytes,
 												 BaseType_t xIsMessageBuffer ) PRIVILEGED_FUNCTION;
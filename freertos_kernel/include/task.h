@@ -228,6 +228,14 @@ is used in assert() statements. */
 #define taskSCHEDULER_NOT_STARTED	( ( BaseType_t ) 1 )
 #define taskSCHEDULER_RUNNING		( ( BaseType_t ) 2 )
 
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	/* The version of the record written by xTaskSerialiseProfile(), and the
+	number of bytes it writes.  The size depends on the configuration, see
+	xTaskSerialiseProfile(). */
+	#define taskPROFILE_SERIALISED_VERSION	( 1 )
+	#define taskPROFILE_SERIALISED_SIZE		( 5 + configMAX_TASK_NAME_LEN + 16 + ( 2 * ( 8 + ( 4 * configPROFILER_HISTOGRAM_BUCKETS ) ) ) + ( ( configPROFILER_WAIT_OBJECTS + 1 ) * ( sizeof( portPOINTER_SIZE_TYPE ) + 12 ) ) )
+#endif
+
 
 /*-----------------------------------------------------------
  * TASK CREATION API
@@ -1766,6 +1774,112 @@ void vTaskGetRunTimeStats( char *pcWriteBuffer ) PRIVILEGED_FUNCTION; /*lint !e9
 */
 TickType_t xTaskGetIdleRunTimeCounter( void ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>void vTaskGetProfile( TaskHandle_t xTask, TaskProfile_t *pxProfile );</PRE>
+ *
+ * configUSE_SCHEDULER_PROFILER must be defined as 1 for this function to be
+ * available.  The profiler requires configGENERATE_RUN_TIME_STATS to also be
+ * defined as 1, and all times it records are in the units of the run time
+ * counter (see vTaskGetRunTimeStats()).  As the counter keeps running while
+ * the tick is suppressed, the statistics remain accurate when
+ * configUSE_TICKLESS_IDLE is used - although the run slices of the idle task
+ * then include the time spent in low power mode.
+ *
+ * When the profiler is enabled the kernel collects the following for each
+ * task:
+ *
+ * xWakeLatency - a histogram of the time between the task being unblocked and
+ * the task actually running.
+ *
+ * xRunSlice - a histogram of the time the task runs each time it is switched
+ * in.
+ *
+ * ulPreemptions - the number of times the task was switched out while it was
+ * still able to run.
+ *
+ * xWaits - the number of times, total time and longest time the task spent
+ * Blocked on each of the first configPROFILER_WAIT_OBJECTS queues, semaphores,
+ * mutexes and event groups it blocked on.  Blocking on any other object, or
+ * in a call such as vTaskDelay(), is accumulated in xOtherWaits.
+ *
+ * Histogram bucket 0 counts values of 0, bucket n counts values from 2^(n-1)
+ * up to (2^n)-1, and the last bucket also counts all larger values.
+ *
+ * @param xTask The handle of the task being queried.  Passing NULL queries
+ * the calling task.
+ *
+ * @param pxProfile The structure into which a copy of the task's statistics
+ * is written.
+ *
+ * \defgroup vTaskGetProfile vTaskGetProfile
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	void vTaskGetProfile( TaskHandle_t xTask, TaskProfile_t *pxProfile ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ * <PRE>void vTaskResetProfile( TaskHandle_t xTask );</PRE>
+ *
+ * configUSE_SCHEDULER_PROFILER must be defined as 1 for this function to be
+ * available.  See vTaskGetProfile().
+ *
+ * Clears the statistics collected for a task.
+ *
+ * @param xTask The handle of the task whose statistics are cleared.  Passing
+ * NULL clears the statistics of the calling task.
+ *
+ * \defgroup vTaskResetProfile vTaskResetProfile
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	void vTaskResetProfile( TaskHandle_t xTask ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ * <PRE>size_t xTaskSerialiseProfile( TaskHandle_t xTask, uint8_t *pucBuffer, size_t xBufferLength );</PRE>
+ *
+ * configUSE_SCHEDULER_PROFILER must be defined as 1 for this function to be
+ * available.  See vTaskGetProfile().
+ *
+ * Writes the statistics collected for a task into a buffer in a compact
+ * binary form, so they can be sent off target for analysis.  All multi-byte
+ * values are little endian, and all values other than pointers are 32 bits.
+ * The record is laid out as:
+ *
+ * + 1 byte: taskPROFILE_SERIALISED_VERSION.
+ * + 1 byte each: configPROFILER_HISTOGRAM_BUCKETS, configPROFILER_WAIT_OBJECTS,
+ *   sizeof( portPOINTER_SIZE_TYPE ) and configMAX_TASK_NAME_LEN.
+ * + configMAX_TASK_NAME_LEN bytes: the task's name.
+ * + The task number (0 if configUSE_TRACE_FACILITY is not 1), priority,
+ *   total run time and number of preemptions.
+ * + The wake latency and then the run slice histogram, each as the count, the
+ *   largest value and then the buckets.
+ * + configPROFILER_WAIT_OBJECTS + 1 wait entries, the last being xOtherWaits.
+ *   Each is the object's address (sizeof( portPOINTER_SIZE_TYPE ) bytes), the
+ *   count, the total time and the longest time.
+ *
+ * @param xTask The handle of the task being queried.  Passing NULL queries
+ * the calling task.
+ *
+ * @param pucBuffer The buffer into which the record is written.
+ *
+ * @param xBufferLength The size of pucBuffer in bytes.  Must be at least
+ * taskPROFILE_SERIALISED_SIZE.
+ *
+ * @return The number of bytes written to pucBuffer, which is
+ * taskPROFILE_SERIALISED_SIZE, or 0 if the buffer is too small.
+ *
+ * \defgroup xTaskSerialiseProfile xTaskSerialiseProfile
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	size_t xTaskSerialiseProfile( TaskHandle_t xTask, uint8_t *pucBuffer, size_t xBufferLength ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  * <PRE>BaseType_t xTaskNotify( TaskHandle_t xTaskToNotify, uint32_t ulValue, eNotifyAction eAction );</PRE>
@@ -2256,6 +2370,22 @@ BaseType_t xTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 void vTaskPlaceOnEventList( List_t * const pxEventList, const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 void vTaskPlaceOnUnorderedEventList( List_t * pxEventList, const TickType_t xItemValue, const TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
+ * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * Records the object the calling task is about to block on, so the scheduler
+ * profiler can attribute the time spent Blocked to that object.  Called through
+ * taskPROFILE_WAIT_OBJECT(), which compiles away when
+ * configUSE_SCHEDULER_PROFILER is 0.
+ */
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	void vTaskProfileSetWaitObject( void * const pvObject ) PRIVILEGED_FUNCTION;
+	#define taskPROFILE_WAIT_OBJECT( pvObject ) vTaskProfileSetWaitObject( ( void * ) ( pvObject ) )
+#else
+	#define taskPROFILE_WAIT_OBJECT( pvObject )
+#endif
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -32,6 +32,17 @@
  *
  * See heap_1.c, heap_2.c and heap_3.c for alternative implementations, and the
  * memory management pages of http://www.FreeRTOS.org for more information.
+ *
+ * vPortGetHeapStats() describes the free blocks: their number, the largest and
+ * the smallest, a histogram of their sizes and a fragmentation index.  If
+ * configHEAP_CALL_SITE_COUNT is not 0 each allocated block is also tagged with
+ * the call site that allocated it, configHEAP_CALL_SITE(), and the live bytes,
+ * live blocks and failed allocations of up to configHEAP_CALL_SITE_COUNT call
+ * sites are returned by uxPortGetHeapCallSites().  By default the call site is
+ * the return address of pvPortMalloc() with GCC, and the calling task with
+ * other compilers.  Allocation wrappers call pvPortMallocFrom() instead, to
+ * give the call site of their own caller.  vPortGetHeapReport() formats all of
+ * this as text.
  */
 #include <stdlib.h>
 
@@ -45,6 +56,12 @@ task.h is included from an application file. */
 
 #undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
 
+#if( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+	/* Used by vPortGetHeapReport(). */
+	#include <stdarg.h>
+	#include <stdio.h>
+#endif
+
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
 	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
 #endif
@@ -55,6 +72,16 @@ task.h is included from an application file. */
 /* Assumes 8bit bytes! */
 #define heapBITS_PER_BYTE		( ( size_t ) 8 )
 
+/* The size of the blocks counted by the first entry of the free block
+histogram of HeapStats_t. */
+#define heapHISTOGRAM_FIRST_SIZE	( ( size_t ) 32 )
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+	/* The index of the table entry that collects the call sites that do not
+	fit in the table. */
+	#define heapOTHER_CALL_SITES	( ( UBaseType_t ) configHEAP_CALL_SITE_COUNT - 1U )
+#endif
+
 /* Allocate the memory for the heap. */
 #if( configAPPLICATION_ALLOCATED_HEAP == 1 )
 	/* The application writer has already defined the array used for the RTOS
@@ -70,6 +97,9 @@ typedef struct A_BLOCK_LINK
 {
 	struct A_BLOCK_LINK *pxNextFreeBlock;	/*<< The next free block in the list. */
 	size_t xBlockSize;						/*<< The size of the free block. */
+	#if( configHEAP_CALL_SITE_COUNT > 0 )
+		UBaseType_t uxCallSite;				/*<< The index in xCallSites of the call site that allocated the block. */
+	#endif
 } BlockLink_t;
 
 /*-----------------------------------------------------------*/
@@ -88,6 +118,28 @@ static void prvInsertBlockIntoFreeList( BlockLink_t *pxBlockToInsert );
  */
 static void prvHeapInit( void );
 
+#if( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+
+	/*
+	 * Appends text formatted as by snprintf() to the xUsed bytes already in
+	 * pcWriteBuffer, truncated to the xBufferLength bytes of the buffer, and
+	 * returns the new number of bytes used.
+	 */
+	static size_t prvAppendToReport( char *pcWriteBuffer, size_t xBufferLength, size_t xUsed, const char *pcFormat, ... );
+
+#endif
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+
+	/*
+	 * Returns the index in xCallSites of the entry of pvCallSite, which is
+	 * created if it does not exist yet.  Must be called with the scheduler
+	 * suspended.
+	 */
+	static UBaseType_t prvGetCallSite( void *pvCallSite );
+
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* The size of the structure placed at the beginning of each allocated memory
@@ -108,13 +160,44 @@ application.  When the bit is free the block is still part of the free heap
 space. */
 static size_t xBlockAllocatedBit = 0;
 
+/* Counts the successful calls to pvPortMalloc() and vPortFree(). */
+static size_t xNumberOfSuccessfulAllocations = 0;
+static size_t xNumberOfSuccessfulFrees = 0;
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+	/* The heap usage of each call site of pvPortMalloc(), and the number of
+	entries in use. */
+	static HeapCallSite_t xCallSites[ configHEAP_CALL_SITE_COUNT ];
+	static UBaseType_t uxCallSitesInUse = 0U;
+#endif
+
 /*-----------------------------------------------------------*/
 
-void *pvPortMalloc( size_t xWantedSize )
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+
+	void *pvPortMalloc( size_t xWantedSize )
+	{
+		/* Read before the scheduler is suspended, as the default with compilers
+		other than GCC asks the scheduler for the calling task. */
+		return pvPortMallocFrom( xWantedSize, configHEAP_CALL_SITE() );
+	}
+	/*-----------------------------------------------------------*/
+
+	void *pvPortMallocFrom( size_t xWantedSize, void *pvCallSite )
+
+#else
+
+	void *pvPortMalloc( size_t xWantedSize )
+
+#endif /* configHEAP_CALL_SITE_COUNT */
 {
 BlockLink_t *pxBlock, *pxPreviousBlock, *pxNewBlockLink;
 void *pvReturn = NULL;
 
+	#if( configHEAP_CALL_SITE_COUNT > 0 )
+		UBaseType_t uxCallSite;
+	#endif
+
 	vTaskSuspendAll();
 	{
 		/* If this is the first call to malloc then the heap will require
@@ -128,6 +211,12 @@ void *pvReturn = NULL;
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		#if( configHEAP_CALL_SITE_COUNT > 0 )
+		{
+			uxCallSite = prvGetCallSite( pvCallSite );
+		}
+		#endif
+
 		/* Check the requested block size is not so large that the top bit is
 		set.  The top bit of the block size member of the BlockLink_t structure
 		is used to determine who owns the block - the application or the
@@ -221,6 +310,27 @@ void *pvReturn = NULL;
 					by the application and has no "next" block. */
 					pxBlock->xBlockSize |= xBlockAllocatedBit;
 					pxBlock->pxNextFreeBlock = NULL;
+					xNumberOfSuccessfulAllocations++;
+
+					#if( configHEAP_CALL_SITE_COUNT > 0 )
+					{
+						/* Tag the block with its call site, so that vPortFree()
+						can update the usage of the call site. */
+						pxBlock->uxCallSite = uxCallSite;
+						xCallSites[ uxCallSite ].xLiveBytes += pxBlock->xBlockSize & ~xBlockAllocatedBit;
+						xCallSites[ uxCallSite ].xLiveBlocks++;
+						xCallSites[ uxCallSite ].xAllocations++;
+
+						if( xCallSites[ uxCallSite ].xLiveBytes > xCallSites[ uxCallSite ].xPeakLiveBytes )
+						{
+							xCallSites[ uxCallSite ].xPeakLiveBytes = xCallSites[ uxCallSite ].xLiveBytes;
+						}
+						else
+						{
+							mtCOVERAGE_TEST_MARKER();
+						}
+					}
+					#endif
 				}
 				else
 				{
@@ -237,6 +347,19 @@ void *pvReturn = NULL;
 			mtCOVERAGE_TEST_MARKER();
 		}
 
+		#if( configHEAP_CALL_SITE_COUNT > 0 )
+		{
+			if( pvReturn == NULL )
+			{
+				xCallSites[ uxCallSite ].xFailures++;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+
 		traceMALLOC( pvReturn, xWantedSize );
 	}
 	( void ) xTaskResumeAll();
@@ -290,6 +413,15 @@ BlockLink_t *pxLink;
 				{
 					/* Add this block to the list of free blocks. */
 					xFreeBytesRemaining += pxLink->xBlockSize;
+					xNumberOfSuccessfulFrees++;
+
+					#if( configHEAP_CALL_SITE_COUNT > 0 )
+					{
+						xCallSites[ pxLink->uxCallSite ].xLiveBytes -= pxLink->xBlockSize;
+						xCallSites[ pxLink->uxCallSite ].xLiveBlocks--;
+					}
+					#endif
+
 					traceFREE( pv, pxLink->xBlockSize );
 					prvInsertBlockIntoFreeList( ( ( BlockLink_t * ) pxLink ) );
 				}
@@ -326,6 +458,194 @@ void vPortInitialiseBlocks( void )
 }
 /*-----------------------------------------------------------*/
 
+void vPortGetHeapStats( HeapStats_t *pxHeapStats )
+{
+BlockLink_t *pxBlock;
+size_t xBlocks = 0, xMaxSize = 0, xMinSize = ~( ( size_t ) 0 ), xFreeBytes = 0, xHistogramSize;
+UBaseType_t uxEntry;
+
+	configASSERT( pxHeapStats != NULL );
+
+	for( uxEntry = 0; uxEntry < ( UBaseType_t ) portHEAP_HISTOGRAM_SIZE; uxEntry++ )
+	{
+		pxHeapStats->xFreeBlockHistogram[ uxEntry ] = 0;
+	}
+
+	vTaskSuspendAll();
+	{
+		pxBlock = xStart.pxNextFreeBlock;
+
+		/* pxBlock will be NULL if the heap has not been initialised.  The heap
+		is initialised automatically when the first allocation is made. */
+		if( pxBlock != NULL )
+		{
+			while( pxBlock != pxEnd )
+			{
+				/* Increment the number of blocks and record the largest and
+				smallest block sizes. */
+				xBlocks++;
+				xFreeBytes += pxBlock->xBlockSize;
+
+				if( pxBlock->xBlockSize > xMaxSize )
+				{
+					xMaxSize = pxBlock->xBlockSize;
+				}
+
+				if( pxBlock->xBlockSize < xMinSize )
+				{
+					xMinSize = pxBlock->xBlockSize;
+				}
+
+				/* Count the block in the first histogram entry whose size is
+				above the size of the block. */
+				xHistogramSize = heapHISTOGRAM_FIRST_SIZE;
+
+				for( uxEntry = 0; uxEntry < ( ( UBaseType_t ) portHEAP_HISTOGRAM_SIZE - 1U ); uxEntry++ )
+				{
+					if( pxBlock->xBlockSize < xHistogramSize )
+					{
+						break;
+					}
+
+					xHistogramSize <<= 1;
+				}
+
+				pxHeapStats->xFreeBlockHistogram[ uxEntry ]++;
+
+				/* Move to the next block in the chain until the last block is
+				reached. */
+				pxBlock = pxBlock->pxNextFreeBlock;
+			}
+		}
+
+		pxHeapStats->xAvailableHeapSpaceInBytes = xFreeBytesRemaining;
+		pxHeapStats->xMinimumEverFreeBytesRemaining = xMinimumEverFreeBytesRemaining;
+		pxHeapStats->xNumberOfSuccessfulAllocations = xNumberOfSuccessfulAllocations;
+		pxHeapStats->xNumberOfSuccessfulFrees = xNumberOfSuccessfulFrees;
+	}
+	( void ) xTaskResumeAll();
+
+	configASSERT( xFreeBytes == pxHeapStats->xAvailableHeapSpaceInBytes );
+
+	pxHeapStats->xSizeOfLargestFreeBlockInBytes = xMaxSize;
+	pxHeapStats->xSizeOfSmallestFreeBlockInBytes = ( xBlocks == 0 ) ? 0 : xMinSize;
+	pxHeapStats->xNumberOfFreeBlocks = xBlocks;
+
+	/* The part of the free space that cannot be allocated in one block. */
+	if( xFreeBytes == 0 )
+	{
+		pxHeapStats->uxFragmentationPercent = 0U;
+	}
+	else if( xFreeBytes <= ( ~( ( size_t ) 0 ) / 100U ) )
+	{
+		pxHeapStats->uxFragmentationPercent = ( UBaseType_t ) ( ( ( xFreeBytes - xMaxSize ) * 100U ) / xFreeBytes );
+	}
+	else
+	{
+		/* Avoid the overflow of the multiplication. */
+		pxHeapStats->uxFragmentationPercent = ( UBaseType_t ) ( ( xFreeBytes - xMaxSize ) / ( xFreeBytes / 100U ) );
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+
+	UBaseType_t uxPortGetHeapCallSites( HeapCallSite_t *pxCallSites, UBaseType_t uxMaxCount )
+	{
+	UBaseType_t uxEntry, uxInUse;
+
+		vTaskSuspendAll();
+		{
+			uxInUse = uxCallSitesInUse;
+
+			for( uxEntry = 0; ( uxEntry < uxInUse ) && ( uxEntry < uxMaxCount ); uxEntry++ )
+			{
+				pxCallSites[ uxEntry ] = xCallSites[ uxEntry ];
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return uxInUse;
+	}
+
+#endif /* configHEAP_CALL_SITE_COUNT */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+
+	void vPortGetHeapReport( char *pcWriteBuffer, size_t xBufferLength )
+	{
+	HeapStats_t xStats;
+	size_t xUsed = 0, xHistogramSize = heapHISTOGRAM_FIRST_SIZE;
+	UBaseType_t uxEntry;
+
+		if( ( pcWriteBuffer != NULL ) && ( xBufferLength > 0 ) )
+		{
+			pcWriteBuffer[ 0 ] = 0x00;
+			vPortGetHeapStats( &xStats );
+
+			xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, "Heap: %u bytes free in %u blocks, largest %u, smallest %u, minimum ever free %u, fragmentation %u%%\r\n",
+						( unsigned int ) xStats.xAvailableHeapSpaceInBytes,
+						( unsigned int ) xStats.xNumberOfFreeBlocks,
+						( unsigned int ) xStats.xSizeOfLargestFreeBlockInBytes,
+						( unsigned int ) xStats.xSizeOfSmallestFreeBlockInBytes,
+						( unsigned int ) xStats.xMinimumEverFreeBytesRemaining,
+						( unsigned int ) xStats.uxFragmentationPercent );
+			xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, "Heap: %u allocations, %u frees\r\nFree blocks by size:",
+						( unsigned int ) xStats.xNumberOfSuccessfulAllocations,
+						( unsigned int ) xStats.xNumberOfSuccessfulFrees );
+
+			for( uxEntry = 0; uxEntry < ( ( UBaseType_t ) portHEAP_HISTOGRAM_SIZE - 1U ); uxEntry++ )
+			{
+				xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, " <%u:%u", ( unsigned int ) xHistogramSize, ( unsigned int ) xStats.xFreeBlockHistogram[ uxEntry ] );
+				xHistogramSize <<= 1;
+			}
+
+			xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, " more:%u\r\n", ( unsigned int ) xStats.xFreeBlockHistogram[ uxEntry ] );
+
+			#if( configHEAP_CALL_SITE_COUNT > 0 )
+			{
+			HeapCallSite_t xCallSite;
+			UBaseType_t uxInUse;
+
+				xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, "Call site\tLive bytes\tLive blocks\tPeak bytes\tAllocations\tFailures\r\n" );
+
+				uxInUse = uxPortGetHeapCallSites( NULL, 0 );
+
+				for( uxEntry = 0; uxEntry < uxInUse; uxEntry++ )
+				{
+					/* Copy the entry with the scheduler suspended, so that its
+					counters are consistent. */
+					vTaskSuspendAll();
+					{
+						xCallSite = xCallSites[ uxEntry ];
+					}
+					( void ) xTaskResumeAll();
+
+					if( uxEntry == heapOTHER_CALL_SITES )
+					{
+						xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, "others" );
+					}
+					else
+					{
+						xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, "%p", xCallSite.pvCallSite );
+					}
+
+					xUsed = prvAppendToReport( pcWriteBuffer, xBufferLength, xUsed, "\t%u\t%u\t%u\t%u\t%u\r\n",
+								( unsigned int ) xCallSite.xLiveBytes,
+								( unsigned int ) xCallSite.xLiveBlocks,
+								( unsigned int ) xCallSite.xPeakLiveBytes,
+								( unsigned int ) xCallSite.xAllocations,
+								( unsigned int ) xCallSite.xFailures );
+				}
+			}
+			#endif /* configHEAP_CALL_SITE_COUNT */
+		}
+	}
+
+#endif /* configUSE_STATS_FORMATTING_FUNCTIONS */
+/*-----------------------------------------------------------*/
+
 static void prvHeapInit( void )
 {
 BlockLink_t *pxFirstFreeBlock;
@@ -433,4 +753,85 @@ uint8_t *puc;
 		mtCOVERAGE_TEST_MARKER();
 	}
 }
+/*-----------------------------------------------------------*/
+
+#if( configHEAP_CALL_SITE_COUNT > 0 )
+
+	static UBaseType_t prvGetCallSite( void *pvCallSite )
+	{
+	UBaseType_t uxEntry;
+
+		/* The last entry is kept for the call sites that do not fit. */
+		for( uxEntry = 0; uxEntry < uxCallSitesInUse; uxEntry++ )
+		{
+			if( ( xCallSites[ uxEntry ].pvCallSite == pvCallSite ) && ( uxEntry != heapOTHER_CALL_SITES ) )
+			{
+				break;
+			}
+		}
+
+		if( uxEntry == uxCallSitesInUse )
+		{
+			/* A new call site, which takes the next entry, or shares the last
+			one if the table is full. */
+			if( uxCallSitesInUse < ( UBaseType_t ) configHEAP_CALL_SITE_COUNT )
+			{
+				uxCallSitesInUse++;
+			}
+			else
+			{
+				uxEntry = heapOTHER_CALL_SITES;
+			}
+
+			xCallSites[ uxEntry ].pvCallSite = ( uxEntry == heapOTHER_CALL_SITES ) ? NULL : pvCallSite;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return uxEntry;
+	}
+
+#endif /* configHEAP_CALL_SITE_COUNT */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+
+	static size_t prvAppendToReport( char *pcWriteBuffer, size_t xBufferLength, size_t xUsed, const char *pcFormat, ... )
+	{
+	va_list xArguments;
+	int iWritten;
+
+		/* Once the buffer is full, the rest of the report is dropped. */
+		if( xUsed < ( xBufferLength - 1U ) )
+		{
+			va_start( xArguments, pcFormat );
+			iWritten = vsnprintf( pcWriteBuffer + xUsed, xBufferLength - xUsed, pcFormat, xArguments );
+			va_end( xArguments );
+
+			if( iWritten > 0 )
+			{
+				xUsed += ( size_t ) iWritten;
+
+				/* snprintf() returns the length the text would have had in a
+				buffer large enough. */
+				if( xUsed >= xBufferLength )
+				{
+					xUsed = xBufferLength - 1U;
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xUsed;
+	}
 
+#endif /* configUSE_STATS_FORMATTING_FUNCTIONS */
@@ -0,0 +1,771 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+
+/*
+ * A sample implementation of pvPortMalloc() and vPortFree() that uses a two
+ * level segregated fit allocator, so that vPortFree() takes a bounded time and
+ * pvPortMalloc() does not walk all the free blocks, and combines (coalescences)
+ * adjacent memory blocks as they are freed.
+ *
+ * Free blocks are kept in one list per size class.  The first level splits the
+ * sizes in powers of two, and the second level splits each power of two in
+ * heapSL_INDEX_COUNT equal ranges.  A bitmap per level records which lists
+ * are not empty, so the lists that can satisfy a request are found with bit
+ * scans.  To limit fragmentation the block is chosen by address among the
+ * first block of each of those lists, and the blocks large enough of the list
+ * of the size asked for: small blocks are taken from the lowest
+ * address, and large blocks from the highest address and from the end of the
+ * free block, so that long lived large blocks gather at the top of the heap
+ * and the short lived small blocks at the bottom.  The time taken depends on
+ * the number of size classes in use, and on the length of the list of the
+ * size asked for, but not on the total number of free blocks.
+ *
+ * See heap_1.c, heap_2.c, heap_3.c, heap_4.c and heap_5.c for alternative
+ * implementations, and the memory management pages of http://www.FreeRTOS.org
+ * for more information.
+ *
+ * Usage notes:
+ *
+ * If configTOTAL_HEAP_SIZE is defined then, as with heap_4.c, the heap starts
+ * with an array of configTOTAL_HEAP_SIZE bytes, which is allocated by the
+ * application if configAPPLICATION_ALLOCATED_HEAP is 1.
+ *
+ * As with heap_5.c, vPortDefineHeapRegions() adds an array of HeapRegion_t
+ * structures to the heap, which lets the heap span multiple non-contiguous
+ * blocks of memory.  The array is terminated using a NULL zero sized region
+ * definition.  Unlike heap_5.c, the regions may appear in any order, and
+ * vPortDefineHeapRegions() may be called more than once, including after
+ * pvPortMalloc() has been called.  If configTOTAL_HEAP_SIZE is not defined,
+ * vPortDefineHeapRegions() ***must*** be called before pvPortMalloc().
+ *
+ * portBYTE_ALIGNMENT must be at least 4, as the two low bits of the size of a
+ * block are used as flags.
+ */
+#include <stdlib.h>
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#if( configSUPPORT_DYNAMIC_ALLOCATION == 0 )
+	#error This file must not be used if configSUPPORT_DYNAMIC_ALLOCATION is 0
+#endif
+
+#if( portBYTE_ALIGNMENT < 4 )
+	#error heap_6.c requires portBYTE_ALIGNMENT to be at least 4
+#endif
+
+/* The number of second level lists in each first level class, as a power of
+two.  Must not be more than 5, as the second level bitmaps are 32 bits. */
+#define heapSL_INDEX_COUNT_LOG2		( ( UBaseType_t ) 4 )
+#define heapSL_INDEX_COUNT			( ( UBaseType_t ) 1 << heapSL_INDEX_COUNT_LOG2 )
+
+/* Blocks smaller than heapSMALL_BLOCK_SIZE all belong to the first first level
+class, split in lists of portBYTE_ALIGNMENT bytes.  Each following class holds
+blocks twice as large as the previous one. */
+#define heapSMALL_BLOCK_SIZE		( ( size_t ) portBYTE_ALIGNMENT * heapSL_INDEX_COUNT )
+
+/* Requests of at least heapLARGE_BLOCK_SIZE bytes are placed at the highest
+free address rather than the lowest. */
+#define heapLARGE_BLOCK_SIZE		( ( size_t ) 4096 )
+
+/* The number of first level classes, which sets the size of the largest block.
+Must not be more than 32, as the first level bitmap is 32 bits. */
+#define heapFL_INDEX_COUNT			( ( UBaseType_t ) 24 )
+
+/* The largest block, header included.  Larger regions are split in several
+blocks that are never combined. */
+#define heapMAXIMUM_BLOCK_SIZE		( ( heapSMALL_BLOCK_SIZE << ( heapFL_INDEX_COUNT - 1 ) ) - ( size_t ) portBYTE_ALIGNMENT )
+
+/* Flags kept in the low bits of the xBlockSize member of a BlockHeader_t. */
+#define heapBLOCK_FREE				( ( size_t ) 1 )
+#define heapPREVIOUS_BLOCK_FREE		( ( size_t ) 2 )
+#define heapBLOCK_FLAGS				( heapBLOCK_FREE | heapPREVIOUS_BLOCK_FREE )
+
+/* The size of a block, without its flags. */
+#define heapBLOCK_SIZE( pxBlock )	( ( pxBlock )->xBlockSize & ~heapBLOCK_FLAGS )
+
+/* The block that follows a block in memory. */
+#define heapNEXT_BLOCK( pxBlock )	( ( BlockHeader_t * ) ( ( ( uint8_t * ) ( pxBlock ) ) + heapBLOCK_SIZE( pxBlock ) ) )
+
+/* Block sizes must not get too small. */
+#define heapMINIMUM_BLOCK_SIZE		( ( ( sizeof( BlockHeader_t ) + ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK ) ) )
+
+/* Allocate the memory for the heap. */
+#ifdef configTOTAL_HEAP_SIZE
+	#if( configAPPLICATION_ALLOCATED_HEAP == 1 )
+		/* The application writer has already defined the array used for the RTOS
+		heap - probably so it can be placed in a special segment or address. */
+		extern uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+	#else
+		static uint8_t ucHeap[ configTOTAL_HEAP_SIZE ];
+	#endif /* configAPPLICATION_ALLOCATED_HEAP */
+#endif /* configTOTAL_HEAP_SIZE */
+
+/* The header at the start of every block.  Only the first two members are kept
+while the block is allocated; the free list links overlap the memory returned
+to the application. */
+typedef struct A_BLOCK_HEADER
+{
+	struct A_BLOCK_HEADER *pxPreviousPhysicalBlock;	/*<< The block before this one in memory, only valid if heapPREVIOUS_BLOCK_FREE is set. */
+	size_t xBlockSize;								/*<< The size of the block, header included, and the heapBLOCK_FLAGS. */
+	struct A_BLOCK_HEADER *pxNextFreeBlock;			/*<< The next block in the same free list, only valid if heapBLOCK_FREE is set. */
+	struct A_BLOCK_HEADER *pxPreviousFreeBlock;		/*<< The previous block in the same free list, only valid if heapBLOCK_FREE is set. */
+} BlockHeader_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Add a region of memory to the heap.  The region is ended by a zero sized
+ * block that is never free, so blocks are never combined across regions.
+ */
+static void prvAddRegion( uint8_t *pucStartAddress, size_t xSizeInBytes );
+
+/*
+ * Adds a block to the free list of its size class, and marks it free.
+ */
+static void prvInsertFreeBlock( BlockHeader_t *pxBlock );
+
+/*
+ * Removes a block from the free list of its size class, and marks it allocated.
+ */
+static void prvRemoveFreeBlock( BlockHeader_t *pxBlock );
+
+/*
+ * Returns a free block of at least xWantedSize bytes, or NULL if there is none.
+ * The block is chosen among those of the list of xWantedSize bytes that fit,
+ * and the first block of each list whose blocks are all large enough, as the
+ * one with the lowest address, or the highest for a large block.
+ */
+static BlockHeader_t *prvFindFreeBlock( size_t xWantedSize );
+
+/*
+ * Returns pdTRUE if pxBlock should be used rather than pxBestBlock, which may
+ * be NULL: if it has a lower address, or a higher one for a large block.
+ */
+static BaseType_t prvIsBetterBlock( const BlockHeader_t *pxBlock, const BlockHeader_t *pxBestBlock, BaseType_t xLargeBlock );
+
+/*
+ * Computes the first and second level indexes of the list that holds free
+ * blocks of xBlockSize bytes.
+ */
+static void prvMapSize( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel );
+
+/*
+ * Returns the index of the most significant and least significant bit set in
+ * ulValue, which must not be 0.
+ */
+static UBaseType_t prvFindLastSet( uint32_t ulValue );
+static UBaseType_t prvFindFirstSet( uint32_t ulValue );
+
+/*-----------------------------------------------------------*/
+
+/* The size of the part of the header kept while a block is allocated, which
+must be correctly byte aligned. */
+static const size_t xHeapStructSize	= ( sizeof( BlockHeader_t * ) + sizeof( size_t ) + ( ( size_t ) ( portBYTE_ALIGNMENT - 1 ) ) ) & ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+/* The free lists, and the bitmaps of the lists that are not empty. */
+static BlockHeader_t *pxFreeLists[ heapFL_INDEX_COUNT ][ heapSL_INDEX_COUNT ];
+static uint32_t ulFirstLevelBitmap = 0U;
+static uint32_t ulSecondLevelBitmaps[ heapFL_INDEX_COUNT ];
+
+/* Keeps track of the number of free bytes remaining, but says nothing about
+fragmentation. */
+static size_t xFreeBytesRemaining = 0U;
+static size_t xMinimumEverFreeBytesRemaining = 0U;
+
+#ifdef configTOTAL_HEAP_SIZE
+	/* Set once ucHeap has been added to the heap. */
+	static BaseType_t xHeapInitialised = pdFALSE;
+#endif
+
+/*-----------------------------------------------------------*/
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+BlockHeader_t *pxBlock, *pxNewBlock;
+void *pvReturn = NULL;
+
+	vTaskSuspendAll();
+	{
+		#ifdef configTOTAL_HEAP_SIZE
+		{
+			/* If this is the first call to malloc then the heap will require
+			initialisation to setup the free lists. */
+			if( xHeapInitialised == pdFALSE )
+			{
+				xHeapInitialised = pdTRUE;
+				prvAddRegion( ucHeap, configTOTAL_HEAP_SIZE );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif
+
+		/* Check the requested block size is not larger than the largest block,
+		once the header is added. */
+		if( ( xWantedSize > 0 ) && ( xWantedSize <= ( heapMAXIMUM_BLOCK_SIZE - xHeapStructSize ) ) )
+		{
+			/* The wanted size is increased so it can contain the header in
+			addition to the requested amount of bytes, and so that blocks are
+			always aligned to the required number of bytes. */
+			xWantedSize += xHeapStructSize;
+
+			if( ( xWantedSize & portBYTE_ALIGNMENT_MASK ) != 0x00 )
+			{
+				/* Byte alignment required. */
+				xWantedSize += ( portBYTE_ALIGNMENT - ( xWantedSize & portBYTE_ALIGNMENT_MASK ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			/* The block must be able to hold the free list links once it is
+			freed. */
+			if( xWantedSize < heapMINIMUM_BLOCK_SIZE )
+			{
+				xWantedSize = heapMINIMUM_BLOCK_SIZE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxBlock = prvFindFreeBlock( xWantedSize );
+
+			if( pxBlock != NULL )
+			{
+				/* This block is being returned for use so must be taken out
+				of the list of free blocks. */
+				prvRemoveFreeBlock( pxBlock );
+
+				/* If the block is larger than required it can be split into
+				two. */
+				if( ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) >= heapMINIMUM_BLOCK_SIZE )
+				{
+					if( xWantedSize < heapLARGE_BLOCK_SIZE )
+					{
+						/* This block is to be split into two.  Create a new
+						block following the number of bytes requested. The void
+						cast is used to prevent byte alignment warnings from the
+						compiler. */
+						pxNewBlock = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xWantedSize );
+
+						/* Calculate the sizes of two blocks split from the
+						single block. */
+						pxNewBlock->xBlockSize = heapBLOCK_SIZE( pxBlock ) - xWantedSize;
+						pxBlock->xBlockSize = xWantedSize | ( pxBlock->xBlockSize & heapBLOCK_FLAGS );
+
+						/* Insert the new block into the list of free blocks. */
+						prvInsertFreeBlock( pxNewBlock );
+					}
+					else
+					{
+						/* Large blocks are taken from the end of the free
+						block, which stays free. */
+						pxNewBlock = ( void * ) ( ( ( uint8_t * ) pxBlock ) + ( heapBLOCK_SIZE( pxBlock ) - xWantedSize ) );
+						pxNewBlock->xBlockSize = xWantedSize;
+						pxBlock->xBlockSize -= xWantedSize;
+
+						/* Inserting the free block marks the block returned as
+						following a free block. */
+						prvInsertFreeBlock( pxBlock );
+						pxBlock = pxNewBlock;
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				xFreeBytesRemaining -= heapBLOCK_SIZE( pxBlock );
+
+				if( xFreeBytesRemaining < xMinimumEverFreeBytesRemaining )
+				{
+					xMinimumEverFreeBytesRemaining = xFreeBytesRemaining;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* Return the memory space pointed to - jumping over the part
+				of the header kept while the block is allocated. */
+				pvReturn = ( void * ) ( ( ( uint8_t * ) pxBlock ) + xHeapStructSize );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceMALLOC( pvReturn, xWantedSize );
+	}
+	( void ) xTaskResumeAll();
+
+	#if( configUSE_MALLOC_FAILED_HOOK == 1 )
+	{
+		if( pvReturn == NULL )
+		{
+			extern void vApplicationMallocFailedHook( void );
+			vApplicationMallocFailedHook();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif
+
+	configASSERT( ( ( ( size_t ) pvReturn ) & ( size_t ) portBYTE_ALIGNMENT_MASK ) == 0 );
+	return pvReturn;
+}
+/*-----------------------------------------------------------*/
+
+void vPortFree( void *pv )
+{
+uint8_t *puc = ( uint8_t * ) pv;
+BlockHeader_t *pxBlock, *pxNeighbour;
+
+	if( pv != NULL )
+	{
+		/* The memory being freed will have a block header immediately before
+		it. */
+		puc -= xHeapStructSize;
+
+		/* This casting is to keep the compiler from issuing warnings. */
+		pxBlock = ( void * ) puc;
+
+		/* Check the block is actually allocated. */
+		configASSERT( ( pxBlock->xBlockSize & heapBLOCK_FREE ) == 0 );
+		configASSERT( heapBLOCK_SIZE( pxBlock ) >= heapMINIMUM_BLOCK_SIZE );
+
+		if( ( pxBlock->xBlockSize & heapBLOCK_FREE ) == 0 )
+		{
+			vTaskSuspendAll();
+			{
+				xFreeBytesRemaining += heapBLOCK_SIZE( pxBlock );
+				traceFREE( pv, heapBLOCK_SIZE( pxBlock ) );
+
+				/* Combine the block with the block before it, if that block is
+				free. */
+				if( ( pxBlock->xBlockSize & heapPREVIOUS_BLOCK_FREE ) != 0 )
+				{
+					pxNeighbour = pxBlock->pxPreviousPhysicalBlock;
+					prvRemoveFreeBlock( pxNeighbour );
+					pxNeighbour->xBlockSize += heapBLOCK_SIZE( pxBlock );
+					pxBlock = pxNeighbour;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* Combine the block with the block after it, if that block is
+				free.  The block that ends each region is never free. */
+				pxNeighbour = heapNEXT_BLOCK( pxBlock );
+
+				if( ( pxNeighbour->xBlockSize & heapBLOCK_FREE ) != 0 )
+				{
+					prvRemoveFreeBlock( pxNeighbour );
+					pxBlock->xBlockSize += heapBLOCK_SIZE( pxNeighbour );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				/* Add this block to the list of free blocks. */
+				prvInsertFreeBlock( pxBlock );
+			}
+			( void ) xTaskResumeAll();
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetFreeHeapSize( void )
+{
+	return xFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+size_t xPortGetMinimumEverFreeHeapSize( void )
+{
+	return xMinimumEverFreeBytesRemaining;
+}
+/*-----------------------------------------------------------*/
+
+void vPortDefineHeapRegions( const HeapRegion_t * const pxHeapRegions )
+{
+const HeapRegion_t *pxHeapRegion = pxHeapRegions;
+
+	vTaskSuspendAll();
+	{
+		while( pxHeapRegion->xSizeInBytes > 0 )
+		{
+			prvAddRegion( pxHeapRegion->pucStartAddress, pxHeapRegion->xSizeInBytes );
+
+			/* Move onto the next HeapRegion_t structure. */
+			pxHeapRegion++;
+		}
+	}
+	( void ) xTaskResumeAll();
+
+	/* Check something was actually defined before it is accessed. */
+	configASSERT( xFreeBytesRemaining );
+}
+/*-----------------------------------------------------------*/
+
+static void prvAddRegion( uint8_t *pucStartAddress, size_t xSizeInBytes )
+{
+BlockHeader_t *pxBlock, *pxEndMarker;
+size_t xAddress, xBlockSize;
+
+	/* Ensure the heap region starts on a correctly aligned boundary. */
+	xAddress = ( size_t ) pucStartAddress;
+
+	if( ( xAddress & portBYTE_ALIGNMENT_MASK ) != 0 )
+	{
+		xAddress += ( portBYTE_ALIGNMENT - 1 );
+		xAddress &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+		/* Adjust the size for the bytes lost to alignment. */
+		xSizeInBytes -= xAddress - ( size_t ) pucStartAddress;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	xSizeInBytes &= ~( ( size_t ) portBYTE_ALIGNMENT_MASK );
+
+	/* Split the region in blocks no larger than the largest block, each
+	followed by a zero sized end marker. */
+	while( xSizeInBytes >= ( heapMINIMUM_BLOCK_SIZE + xHeapStructSize ) )
+	{
+		xBlockSize = xSizeInBytes - xHeapStructSize;
+
+		if( xBlockSize > heapMAXIMUM_BLOCK_SIZE )
+		{
+			xBlockSize = heapMAXIMUM_BLOCK_SIZE;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxBlock = ( BlockHeader_t * ) xAddress;
+		pxBlock->pxPreviousPhysicalBlock = NULL;
+		pxBlock->xBlockSize = xBlockSize;
+
+		pxEndMarker = heapNEXT_BLOCK( pxBlock );
+		pxEndMarker->xBlockSize = 0;
+
+		prvInsertFreeBlock( pxBlock );
+
+		xFreeBytesRemaining += xBlockSize;
+		xMinimumEverFreeBytesRemaining += xBlockSize;
+
+		xAddress += xBlockSize + xHeapStructSize;
+		xSizeInBytes -= xBlockSize + xHeapStructSize;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvInsertFreeBlock( BlockHeader_t *pxBlock )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+BlockHeader_t *pxNextBlock;
+
+	prvMapSize( heapBLOCK_SIZE( pxBlock ), &uxFirstLevel, &uxSecondLevel );
+
+	/* Add the block at the head of its list. */
+	pxBlock->pxPreviousFreeBlock = NULL;
+	pxBlock->pxNextFreeBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPreviousFreeBlock = pxBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock;
+	ulFirstLevelBitmap |= ( uint32_t ) 1U << uxFirstLevel;
+	ulSecondLevelBitmaps[ uxFirstLevel ] |= ( uint32_t ) 1U << uxSecondLevel;
+
+	/* Mark the block free, and tell the block after it where to find it. */
+	pxBlock->xBlockSize |= heapBLOCK_FREE;
+	pxNextBlock = heapNEXT_BLOCK( pxBlock );
+	pxNextBlock->xBlockSize |= heapPREVIOUS_BLOCK_FREE;
+	pxNextBlock->pxPreviousPhysicalBlock = pxBlock;
+}
+/*-----------------------------------------------------------*/
+
+static void prvRemoveFreeBlock( BlockHeader_t *pxBlock )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel;
+
+	prvMapSize( heapBLOCK_SIZE( pxBlock ), &uxFirstLevel, &uxSecondLevel );
+
+	if( pxBlock->pxNextFreeBlock != NULL )
+	{
+		pxBlock->pxNextFreeBlock->pxPreviousFreeBlock = pxBlock->pxPreviousFreeBlock;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( pxBlock->pxPreviousFreeBlock != NULL )
+	{
+		pxBlock->pxPreviousFreeBlock->pxNextFreeBlock = pxBlock->pxNextFreeBlock;
+	}
+	else
+	{
+		/* The block was at the head of its list, so the list may now be
+		empty. */
+		pxFreeLists[ uxFirstLevel ][ uxSecondLevel ] = pxBlock->pxNextFreeBlock;
+
+		if( pxBlock->pxNextFreeBlock == NULL )
+		{
+			ulSecondLevelBitmaps[ uxFirstLevel ] &= ~( ( uint32_t ) 1U << uxSecondLevel );
+
+			if( ulSecondLevelBitmaps[ uxFirstLevel ] == 0U )
+			{
+				ulFirstLevelBitmap &= ~( ( uint32_t ) 1U << uxFirstLevel );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+	/* Mark the block allocated, for the block after it too. */
+	pxBlock->xBlockSize &= ~heapBLOCK_FREE;
+	heapNEXT_BLOCK( pxBlock )->xBlockSize &= ~heapPREVIOUS_BLOCK_FREE;
+}
+/*-----------------------------------------------------------*/
+
+static BlockHeader_t *prvFindFreeBlock( size_t xWantedSize )
+{
+UBaseType_t uxFirstLevel, uxSecondLevel, uxMinimumFirstLevel, uxMinimumSecondLevel;
+uint32_t ulFirstLevels, ulSecondLevels;
+BlockHeader_t *pxBlock, *pxBestBlock = NULL;
+const BaseType_t xLargeBlock = ( xWantedSize >= heapLARGE_BLOCK_SIZE ) ? pdTRUE : pdFALSE;
+
+	/* The list of the size asked for holds blocks that are too small too, so
+	all its blocks are compared. */
+	prvMapSize( xWantedSize, &uxFirstLevel, &uxSecondLevel );
+
+	if( uxFirstLevel < heapFL_INDEX_COUNT )
+	{
+		for( pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ]; pxBlock != NULL; pxBlock = pxBlock->pxNextFreeBlock )
+		{
+			if( ( heapBLOCK_SIZE( pxBlock ) >= xWantedSize ) && ( prvIsBetterBlock( pxBlock, pxBestBlock, xLargeBlock ) != pdFALSE ) )
+			{
+				pxBestBlock = pxBlock;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	/* Round the size up to the next list boundary, so that any block of the
+	lists that follow is large enough. */
+	if( xWantedSize >= heapSMALL_BLOCK_SIZE )
+	{
+		xWantedSize += ( ( size_t ) 1 << ( prvFindLastSet( ( uint32_t ) xWantedSize ) - heapSL_INDEX_COUNT_LOG2 ) ) - 1;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	prvMapSize( xWantedSize, &uxMinimumFirstLevel, &uxMinimumSecondLevel );
+
+	if( uxMinimumFirstLevel < heapFL_INDEX_COUNT )
+	{
+		/* Compare the first block of each of these lists, in the same first
+		level class and in the larger ones. */
+		ulFirstLevels = ulFirstLevelBitmap & ( ( uint32_t ) 0xFFFFFFFFUL << uxMinimumFirstLevel );
+
+		while( ulFirstLevels != 0U )
+		{
+			uxFirstLevel = prvFindFirstSet( ulFirstLevels );
+			ulFirstLevels &= ulFirstLevels - 1U;
+			ulSecondLevels = ulSecondLevelBitmaps[ uxFirstLevel ];
+
+			if( uxFirstLevel == uxMinimumFirstLevel )
+			{
+				ulSecondLevels &= ( uint32_t ) 0xFFFFFFFFUL << uxMinimumSecondLevel;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			while( ulSecondLevels != 0U )
+			{
+				uxSecondLevel = prvFindFirstSet( ulSecondLevels );
+				ulSecondLevels &= ulSecondLevels - 1U;
+				pxBlock = pxFreeLists[ uxFirstLevel ][ uxSecondLevel ];
+
+				if( prvIsBetterBlock( pxBlock, pxBestBlock, xLargeBlock ) != pdFALSE )
+				{
+					pxBestBlock = pxBlock;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return pxBestBlock;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvIsBetterBlock( const BlockHeader_t *pxBlock, const BlockHeader_t *pxBestBlock, BaseType_t xLargeBlock )
+{
+BaseType_t xReturn;
+
+	if( pxBestBlock == NULL )
+	{
+		xReturn = pdTRUE;
+	}
+	else if( xLargeBlock == pdFALSE )
+	{
+		xReturn = ( pxBlock < pxBestBlock ) ? pdTRUE : pdFALSE;
+	}
+	else
+	{
+		xReturn = ( pxBlock > pxBestBlock ) ? pdTRUE : pdFALSE;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static void prvMapSize( size_t xBlockSize, UBaseType_t *puxFirstLevel, UBaseType_t *puxSecondLevel )
+{
+UBaseType_t uxLastSet;
+
+	if( xBlockSize < heapSMALL_BLOCK_SIZE )
+	{
+		/* Small blocks are split linearly. */
+		*puxFirstLevel = 0;
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize / portBYTE_ALIGNMENT );
+	}
+	else
+	{
+		/* The first level is the power of two of the size, the second level is
+		given by the bits that follow the most significant one. */
+		uxLastSet = prvFindLastSet( ( uint32_t ) xBlockSize );
+		*puxSecondLevel = ( UBaseType_t ) ( xBlockSize >> ( uxLastSet - heapSL_INDEX_COUNT_LOG2 ) ) ^ heapSL_INDEX_COUNT;
+		*puxFirstLevel = uxLastSet - prvFindLastSet( ( uint32_t ) heapSMALL_BLOCK_SIZE ) + 1U;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFindLastSet( uint32_t ulValue )
+{
+	#if defined( __GNUC__ )
+	{
+		return ( UBaseType_t ) ( ( sizeof( unsigned long ) * 8U ) - 1U - ( size_t ) __builtin_clzl( ( unsigned long ) ulValue ) );
+	}
+	#else
+	{
+	UBaseType_t uxBit = 0;
+
+		while( ( ulValue >> uxBit ) > 1U )
+		{
+			uxBit++;
+		}
+
+		return uxBit;
+	}
+	#endif
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvFindFirstSet( uint32_t ulValue )
+{
+	#if defined( __GNUC__ )
+	{
+		return ( UBaseType_t ) __builtin_ctzl( ( unsigned long ) ulValue );
+	}
+	#else
+	{
+	UBaseType_t uxBit = 0;
+
+		while( ( ulValue & ( ( uint32_t ) 1U << uxBit ) ) == 0U )
+		{
+			uxBit++;
+		}
+
+		return uxBit;
+	}
+	#endif
+}
@@ -0,0 +1,515 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*-----------------------------------------------------------
+ * Implementation of functions defined in portable.h for a POSIX host (Linux)
+ * using GCC.
+ *
+ * Each task runs in its own pthread, but only the thread of the task selected
+ * by the scheduler is ever allowed to run.  Every other task thread waits on a
+ * per-thread condition variable.  A context switch signals the thread being
+ * switched in and then makes the thread being switched out wait.
+ *
+ * Interrupts are simulated with signals.  The tick is generated by an interval
+ * timer that raises SIGALRM.  Only the thread of the running task leaves
+ * SIGALRM unblocked, so the tick handler always executes in the context of the
+ * running task, exactly as a tick interrupt would on a microcontroller, and
+ * can switch context before it returns.  Disabling interrupts blocks the
+ * signals in the calling thread.
+ *
+ * Code called from tasks must not block SIGALRM indefinitely, and threads that
+ * are not created by the kernel must block it, as otherwise the tick could be
+ * delivered to them.
+ *----------------------------------------------------------*/
+
+/* Standard includes. */
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <time.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/*-----------------------------------------------------------*/
+
+#define portSIGNAL_TICK		SIGALRM
+
+/* The state of the thread that runs a task.  Like the Windows port, the
+structure is placed on the task's stack, which is otherwise unused as the
+thread has a stack of its own. */
+typedef struct THREAD
+{
+	pthread_t xThread;			/* The thread that runs the task. */
+	TaskFunction_t pxCode;		/* The task function. */
+	void *pvParams;				/* Parameter passed to the task function. */
+	BaseType_t xDying;			/* Set when the task has deleted itself. */
+
+	/* The thread runs only while xResume is set.  xMutex and xCond implement
+	an event on which the thread waits while it is switched out. */
+	pthread_mutex_t xMutex;
+	pthread_cond_t xCond;
+	BaseType_t xResume;
+} Thread_t;
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The entry point of every task thread.  Waits to be switched in for the
+ * first time before calling the task function.
+ */
+static void *prvWaitForStart( void *pvParams );
+
+/*
+ * Map a task handle to the state of its thread.
+ */
+static Thread_t *prvGetThreadFromTask( void *pvTask );
+
+/*
+ * Make the calling thread wait until prvResumeThread() is called for it.
+ */
+static void prvSuspendSelf( Thread_t *pxThread );
+
+/*
+ * Allow a thread waiting in prvSuspendSelf() to run.
+ */
+static void prvResumeThread( Thread_t *pxThread );
+
+/*
+ * Switch from the thread of one task to the thread of another.
+ */
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend );
+
+/*
+ * Release the mutex of a thread that is cancelled while suspended.
+ */
+static void prvSuspendCleanup( void *pvMutex );
+
+/*
+ * The tick interrupt.
+ */
+static void prvTickSignalHandler( int iSignal );
+
+/*
+ * Start the host timer that raises the tick signal.
+ */
+static void prvSetupTimerInterrupt( void );
+
+/*-----------------------------------------------------------*/
+
+/* Pointer to the TCB of the currently executing task. */
+extern void *pxCurrentTCB;
+
+/* The critical nesting count.  Only one task thread runs at a time, and a
+thread saves and restores the count around each context switch, so a single
+variable serves all the tasks. */
+static volatile UBaseType_t uxCriticalNesting = 0;
+
+/* All the signals blocked while interrupts are disabled.  SIGINT is left
+unblocked so that a debugger can always break in, and the signals raised by
+faults are left unblocked so that their handlers (or the default action of
+dumping core) still run. */
+static sigset_t xAllSignals;
+
+/* Set by vPortEndScheduler() to release the thread that started the
+scheduler. */
+static pthread_mutex_t xSchedulerEndMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t xSchedulerEndCond = PTHREAD_COND_INITIALIZER;
+static BaseType_t xSchedulerEnd = pdFALSE;
+
+/* Host time at which the scheduler was started, used for run time stats. */
+static struct timespec xStartTime;
+
+/*-----------------------------------------------------------*/
+
+StackType_t *pxPortInitialiseStack( StackType_t *pxTopOfStack, TaskFunction_t pxCode, void *pvParameters )
+{
+Thread_t *pxThread;
+pthread_attr_t xThreadAttributes;
+sigset_t xPreviousSignals;
+int iResult;
+
+	/* A stack is not initialised.  Instead a thread is created to run the
+	task, and the Thread_t structure is placed at the top of the stack that was
+	allocated for the task. */
+	pxThread = ( Thread_t * ) ( ( ( portPOINTER_SIZE_TYPE ) pxTopOfStack - sizeof( Thread_t ) ) & ~( ( portPOINTER_SIZE_TYPE ) portBYTE_ALIGNMENT_MASK ) );
+
+	pxThread->pxCode = pxCode;
+	pxThread->pvParams = pvParameters;
+	pxThread->xDying = pdFALSE;
+	pxThread->xResume = pdFALSE;
+	pthread_mutex_init( &( pxThread->xMutex ), NULL );
+	pthread_cond_init( &( pxThread->xCond ), NULL );
+
+	pthread_attr_init( &xThreadAttributes );
+	pthread_attr_setdetachstate( &xThreadAttributes, PTHREAD_CREATE_JOINABLE );
+
+	/* The new thread inherits the signal mask of the creating thread.  Create
+	it with every signal blocked so that it is never interrupted before it
+	runs the task for the first time. */
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, &xPreviousSignals );
+	iResult = pthread_create( &( pxThread->xThread ), &xThreadAttributes, prvWaitForStart, pxThread );
+	pthread_sigmask( SIG_SETMASK, &xPreviousSignals, NULL );
+
+	pthread_attr_destroy( &xThreadAttributes );
+	configASSERT( iResult == 0 );
+	( void ) iResult;
+
+	return ( StackType_t * ) pxThread;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xPortStartScheduler( void )
+{
+struct sigaction xTickAction;
+Thread_t *pxFirstThread;
+int iResult;
+
+	/* The thread that starts the scheduler does not run a task, so it must
+	never receive the tick. */
+	pthread_sigmask( SIG_SETMASK, &xAllSignals, NULL );
+
+	memset( &xTickAction, 0x00, sizeof( xTickAction ) );
+	xTickAction.sa_handler = prvTickSignalHandler;
+	xTickAction.sa_flags = SA_RESTART;
+
+	/* Interrupts are disabled while the tick handler executes. */
+	xTickAction.sa_mask = xAllSignals;
+	iResult = sigaction( portSIGNAL_TICK, &xTickAction, NULL );
+	configASSERT( iResult == 0 );
+	( void ) iResult;
+
+	clock_gettime( CLOCK_MONOTONIC, &xStartTime );
+	prvSetupTimerInterrupt();
+
+	/* Start the first task.  The task thread clears the critical nesting
+	count and enables interrupts itself. */
+	pxFirstThread = prvGetThreadFromTask( pxCurrentTCB );
+	prvResumeThread( pxFirstThread );
+
+	/* Wait until vPortEndScheduler() is called. */
+	pthread_mutex_lock( &xSchedulerEndMutex );
+
+	while( xSchedulerEnd == pdFALSE )
+	{
+		pthread_cond_wait( &xSchedulerEndCond, &xSchedulerEndMutex );
+	}
+
+	pthread_mutex_unlock( &xSchedulerEndMutex );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+void vPortEndScheduler( void )
+{
+struct itimerval xTimer;
+
+	/* Stop the tick. */
+	memset( &xTimer, 0x00, sizeof( xTimer ) );
+	setitimer( ITIMER_REAL, &xTimer, NULL );
+
+	/* Release the thread that started the scheduler so that
+	vTaskStartScheduler() returns. */
+	pthread_mutex_lock( &xSchedulerEndMutex );
+	xSchedulerEnd = pdTRUE;
+	pthread_cond_signal( &xSchedulerEndCond );
+	pthread_mutex_unlock( &xSchedulerEndMutex );
+
+	/* The calling task never runs again. */
+	vPortDisableInterrupts();
+	prvSuspendSelf( prvGetThreadFromTask( pxCurrentTCB ) );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnterCritical( void )
+{
+	if( uxCriticalNesting == 0 )
+	{
+		vPortDisableInterrupts();
+	}
+
+	uxCriticalNesting++;
+}
+/*-----------------------------------------------------------*/
+
+void vPortExitCritical( void )
+{
+	configASSERT( uxCriticalNesting > 0 );
+
+	uxCriticalNesting--;
+
+	/* If the nesting level has reached zero then any tick that arrived
+	during the critical section is delivered now. */
+	if( uxCriticalNesting == 0 )
+	{
+		vPortEnableInterrupts();
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortDisableInterrupts( void )
+{
+	pthread_sigmask( SIG_BLOCK, &xAllSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+void vPortEnableInterrupts( void )
+{
+	pthread_sigmask( SIG_UNBLOCK, &xAllSignals, NULL );
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t xPortSetInterruptMask( void )
+{
+sigset_t xPreviousSignals;
+
+	/* Called from a task as well as from the tick handler, for example by the
+	Atomic_*() functions, so the signals are blocked here and the mask returned
+	records whether the tick signal was already blocked. */
+	pthread_sigmask( SIG_BLOCK, &xAllSignals, &xPreviousSignals );
+
+	return ( UBaseType_t ) sigismember( &xPreviousSignals, portSIGNAL_TICK );
+}
+/*-----------------------------------------------------------*/
+
+void vPortClearInterruptMask( UBaseType_t xMask )
+{
+	/* Only unblock the signals if they were not blocked when the mask was
+	set, so that a nested call, or a call from the tick handler, leaves them
+	blocked. */
+	if( xMask == 0 )
+	{
+		pthread_sigmask( SIG_UNBLOCK, &xAllSignals, NULL );
+	}
+}
+/*-----------------------------------------------------------*/
+
+void vPortYieldFromISR( void )
+{
+Thread_t *pxThreadToSuspend;
+Thread_t *pxThreadToResume;
+
+	pxThreadToSuspend = prvGetThreadFromTask( pxCurrentTCB );
+	vTaskSwitchContext();
+	pxThreadToResume = prvGetThreadFromTask( pxCurrentTCB );
+
+	prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+}
+/*-----------------------------------------------------------*/
+
+void vPortYield( void )
+{
+	vPortEnterCritical();
+	vPortYieldFromISR();
+	vPortExitCritical();
+}
+/*-----------------------------------------------------------*/
+
+void vPortThreadDying( void *pxTaskToDelete, volatile BaseType_t *pxPendYield )
+{
+Thread_t *pxThread = prvGetThreadFromTask( pxTaskToDelete );
+
+	( void ) pxPendYield;
+
+	/* The thread exits when it is next switched out. */
+	pxThread->xDying = pdTRUE;
+}
+/*-----------------------------------------------------------*/
+
+void vPortCancelThread( void *pxTaskToDelete )
+{
+Thread_t *pxThread = prvGetThreadFromTask( pxTaskToDelete );
+
+	/* The thread is either suspended, in which case cancelling it makes it
+	exit, or has already exited because the task deleted itself.  In both
+	cases it can be joined. */
+	pthread_cancel( pxThread->xThread );
+	pthread_join( pxThread->xThread, NULL );
+
+	pthread_cond_destroy( &( pxThread->xCond ) );
+	pthread_mutex_destroy( &( pxThread->xMutex ) );
+}
+/*-----------------------------------------------------------*/
+
+unsigned long ulPortGetRunTime( void )
+{
+struct timespec xNow;
+
+	/* Run time is counted in microseconds since the scheduler started. */
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( unsigned long ) ( ( ( xNow.tv_sec - xStartTime.tv_sec ) * 1000000L ) +
+							   ( ( xNow.tv_nsec - xStartTime.tv_nsec ) / 1000L ) );
+}
+/*-----------------------------------------------------------*/
+
+static void *prvWaitForStart( void *pvParams )
+{
+Thread_t *pxThread = ( Thread_t * ) pvParams;
+
+	prvSuspendSelf( pxThread );
+
+	/* The task is running for the first time.  The thread that switched to
+	it did so with interrupts disabled, so clear the nesting count and let
+	the tick in. */
+	uxCriticalNesting = 0;
+	vPortEnableInterrupts();
+
+	pxThread->pxCode( pxThread->pvParams );
+
+	/* Task functions must not return, but if one does, delete the task rather
+	than letting the thread run on unscheduled. */
+	vTaskDelete( NULL );
+
+	return NULL;
+}
+/*-----------------------------------------------------------*/
+
+static Thread_t *prvGetThreadFromTask( void *pvTask )
+{
+	/* The first member of the TCB is the top of stack, which points to the
+	Thread_t structure. */
+	return ( Thread_t * ) *( ( StackType_t ** ) pvTask );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendCleanup( void *pvMutex )
+{
+	pthread_mutex_unlock( ( pthread_mutex_t * ) pvMutex );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSuspendSelf( Thread_t *pxThread )
+{
+	pthread_mutex_lock( &( pxThread->xMutex ) );
+
+	/* A suspended thread is cancelled when its task is deleted by another
+	task, and must not exit holding its mutex. */
+	pthread_cleanup_push( prvSuspendCleanup, &( pxThread->xMutex ) );
+
+	while( pxThread->xResume == pdFALSE )
+	{
+		pthread_cond_wait( &( pxThread->xCond ), &( pxThread->xMutex ) );
+	}
+
+	pxThread->xResume = pdFALSE;
+
+	pthread_cleanup_pop( 1 );
+}
+/*-----------------------------------------------------------*/
+
+static void prvResumeThread( Thread_t *pxThread )
+{
+	pthread_mutex_lock( &( pxThread->xMutex ) );
+	pxThread->xResume = pdTRUE;
+	pthread_cond_signal( &( pxThread->xCond ) );
+	pthread_mutex_unlock( &( pxThread->xMutex ) );
+}
+/*-----------------------------------------------------------*/
+
+static void prvSwitchThread( Thread_t *pxThreadToResume, Thread_t *pxThreadToSuspend )
+{
+UBaseType_t uxSavedCriticalNesting;
+
+	if( pxThreadToSuspend != pxThreadToResume )
+	{
+		/* The critical nesting count belongs to the task being switched out,
+		and is restored when the task is switched back in. */
+		uxSavedCriticalNesting = uxCriticalNesting;
+
+		prvResumeThread( pxThreadToResume );
+
+		if( pxThreadToSuspend->xDying != pdFALSE )
+		{
+			/* The task deleted itself.  The idle task joins the thread when it
+			frees the task. */
+			pthread_exit( NULL );
+		}
+
+		prvSuspendSelf( pxThreadToSuspend );
+
+		uxCriticalNesting = uxSavedCriticalNesting;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static void prvTickSignalHandler( int iSignal )
+{
+Thread_t *pxThreadToSuspend;
+Thread_t *pxThreadToResume;
+
+	( void ) iSignal;
+
+	/* Signals are blocked while the handler executes. */
+	uxCriticalNesting++;
+
+	if( xTaskIncrementTick() != pdFALSE )
+	{
+		pxThreadToSuspend = prvGetThreadFromTask( pxCurrentTCB );
+		vTaskSwitchContext();
+		pxThreadToResume = prvGetThreadFromTask( pxCurrentTCB );
+
+		prvSwitchThread( pxThreadToResume, pxThreadToSuspend );
+	}
+
+	uxCriticalNesting--;
+}
+/*-----------------------------------------------------------*/
+
+static void prvSetupTimerInterrupt( void )
+{
+struct itimerval xTimer;
+int iResult;
+
+	xTimer.it_interval.tv_sec = 0;
+	xTimer.it_interval.tv_usec = ( suseconds_t ) ( 1000000UL / configTICK_RATE_HZ );
+	xTimer.it_value = xTimer.it_interval;
+
+	iResult = setitimer( ITIMER_REAL, &xTimer, NULL );
+	configASSERT( iResult == 0 );
+	( void ) iResult;
+}
+/*-----------------------------------------------------------*/
+
+/* The signal set must be ready before the first task is created, which can
+happen before the scheduler is started. */
+static void __attribute__( ( constructor ) ) prvInitialiseSignals( void )
+{
+	sigfillset( &xAllSignals );
+	sigdelset( &xAllSignals, SIGINT );
+	sigdelset( &xAllSignals, SIGSEGV );
+	sigdelset( &xAllSignals, SIGBUS );
+	sigdelset( &xAllSignals, SIGFPE );
+	sigdelset( &xAllSignals, SIGILL );
+	sigdelset( &xAllSignals, SIGABRT );
+}
+/*-----------------------------------------------------------*/
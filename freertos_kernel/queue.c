@@ -52,6 +52,11 @@ correct privileged Vs unprivileged linkage and placement. */
 #define queueUNLOCKED					( ( int8_t ) -1 )
 #define queueLOCKED_UNMODIFIED			( ( int8_t ) 0 )
 
+/* The largest value of the cRxLock and cTxLock structure members.  The
+functions that move several items from an ISR move no more items than can be
+counted while the queue is locked. */
+#define queueMAX_LOCK_COUNT				( ( int8_t ) 127 )
+
 /* When the Queue_t structure is used to represent a base queue its pcHead and
 pcTail members are used as pointers into the queue storage area.  When the
 Queue_t structure is used to represent a mutex pcHead and pcTail pointers are
@@ -198,6 +203,39 @@ static BaseType_t prvCopyDataToQueue( Queue_t * const pxQueue, const void *pvIte
  */
 static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer ) PRIVILEGED_FUNCTION;
 
+/*
+ * Copies as many of the uxItemCount items at pvItems as there is space for
+ * onto the back of a queue, and returns the number of items copied.  Must be
+ * called from a critical section, and only for queues that hold data.
+ */
+static UBaseType_t prvCopyMultipleDataToQueue( Queue_t * const pxQueue, const int8_t *pcItems, const UBaseType_t uxItemCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Copies up to uxMaxItems items out of a queue into pvBuffer, and returns the
+ * number of items copied.  Must be called from a critical section, and only
+ * for queues that hold data.
+ */
+static UBaseType_t prvCopyMultipleDataFromQueue( Queue_t * const pxQueue, int8_t *pcBuffer, const UBaseType_t uxMaxItems ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called when uxItemCount items have been added to a queue that is not locked.
+ * Unblocks up to uxItemCount tasks waiting to receive from the queue, or
+ * notifies the queue set the queue is a member of once per item.
+ *
+ * @return pdTRUE if a task with a priority higher than that of the calling
+ * task was unblocked, otherwise pdFALSE.
+ */
+static BaseType_t prvUnblockMultipleReceivers( Queue_t * const pxQueue, const UBaseType_t uxItemCount ) PRIVILEGED_FUNCTION;
+
+/*
+ * Called when uxItemCount items have been removed from a queue that is not
+ * locked.  Unblocks up to uxItemCount tasks waiting to send to the queue.
+ *
+ * @return pdTRUE if a task with a priority higher than that of the calling
+ * task was unblocked, otherwise pdFALSE.
+ */
+static BaseType_t prvUnblockMultipleSenders( Queue_t * const pxQueue, const UBaseType_t uxItemCount ) PRIVILEGED_FUNCTION;
+
 #if ( configUSE_QUEUE_SETS == 1 )
 	/*
 	 * Checks to see if a queue is a member of a queue set, and if so, notifies
@@ -915,6 +953,7 @@ Queue_t * const pxQueue = xQueue;
 			if( prvIsQueueFull( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+				taskPROFILE_WAIT_OBJECT( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
 
 				/* Unlocking the queue means queue events can effect the
@@ -1371,6 +1410,7 @@ Queue_t * const pxQueue = xQueue;
 			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				taskPROFILE_WAIT_OBJECT( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
@@ -1562,6 +1602,7 @@ Queue_t * const pxQueue = xQueue;
 				}
 				#endif
 
+				taskPROFILE_WAIT_OBJECT( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
@@ -1738,6 +1779,7 @@ Queue_t * const pxQueue = xQueue;
 			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
 			{
 				traceBLOCKING_ON_QUEUE_PEEK( pxQueue );
+				taskPROFILE_WAIT_OBJECT( pxQueue );
 				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
 				prvUnlockQueue( pxQueue );
 				if( xTaskResumeAll() == pdFALSE )
@@ -1869,6 +1911,406 @@ Queue_t * const pxQueue = xQueue;
 }
 /*-----------------------------------------------------------*/
 
+UBaseType_t uxQueueSendMultiple( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItemCount, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+UBaseType_t uxItemsSent = 0, uxItemsCopied;
+Queue_t * const pxQueue = xQueue;
+const int8_t * const pcItems = ( const int8_t * ) pvItems;
+
+	configASSERT( pxQueue );
+	configASSERT( !( ( pvItems == NULL ) && ( uxItemCount != ( UBaseType_t ) 0U ) ) );
+
+	/* Semaphores and mutexes do not hold data, so cannot be given several
+	times in one call. */
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+
+	/*lint -save -e904 This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			/* Copy as many of the remaining items as there is room for, then
+			unblock the tasks that can receive them, all without leaving the
+			critical section. */
+			if( pxQueue->uxMessagesWaiting < pxQueue->uxLength )
+			{
+				uxItemsCopied = prvCopyMultipleDataToQueue( pxQueue, pcItems + ( uxItemsSent * pxQueue->uxItemSize ), uxItemCount - uxItemsSent ); /*lint !e9016 Pointer arithmetic on char types ok. */
+				uxItemsSent += uxItemsCopied;
+				traceQUEUE_SEND_MULTIPLE( pxQueue, uxItemsCopied );
+
+				if( prvUnblockMultipleReceivers( pxQueue, uxItemsCopied ) != pdFALSE )
+				{
+					/* A task with a priority higher than our own was
+					unblocked.  Yes it is ok to yield from within the critical
+					section - the kernel takes care of that. */
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( uxItemsSent == uxItemCount )
+			{
+				taskEXIT_CRITICAL();
+				return uxItemsSent;
+			}
+			else if( xTicksToWait == ( TickType_t ) 0 )
+			{
+				/* The queue is full and no block time is specified (or the
+				block time has expired) so leave now. */
+				taskEXIT_CRITICAL();
+				traceQUEUE_SEND_FAILED( pxQueue );
+				return uxItemsSent;
+			}
+			else if( xEntryTimeSet == pdFALSE )
+			{
+				/* The queue is full and a block time was specified so
+				configure the timeout structure. */
+				vTaskInternalSetTimeOutState( &xTimeOut );
+				xEntryTimeSet = pdTRUE;
+			}
+			else
+			{
+				/* Entry time was already set. */
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Interrupts and other tasks can send to and receive from the queue
+		now the critical section has been exited. */
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		/* Update the timeout state to see if it has expired yet. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			if( prvIsQueueFull( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_SEND( pxQueue );
+				taskPROFILE_WAIT_OBJECT( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToSend ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* Try again. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* The timeout has expired.  Items may have been removed from the
+			queue since it was last checked, so loop back once more to send
+			what fits without blocking. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+			xTicksToWait = ( TickType_t ) 0;
+		}
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueSendMultipleFromISR( QueueHandle_t xQueue, const void * const pvItems, const UBaseType_t uxItemCount, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxItemsSent, uxMaxItems = uxItemCount;
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( !( ( pvItems == NULL ) && ( uxItemCount != ( UBaseType_t ) 0U ) ) );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* See the comments in xQueueGenericSendFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cTxLock = pxQueue->cTxLock;
+
+		/* If the queue is locked the items sent are counted in cTxLock, so
+		send no more than can be counted. */
+		if( ( cTxLock != queueUNLOCKED ) && ( uxMaxItems > ( UBaseType_t ) ( queueMAX_LOCK_COUNT - cTxLock ) ) )
+		{
+			uxMaxItems = ( UBaseType_t ) ( queueMAX_LOCK_COUNT - cTxLock );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		uxItemsSent = prvCopyMultipleDataToQueue( pxQueue, ( const int8_t * ) pvItems, uxMaxItems );
+
+		if( uxItemsSent > ( UBaseType_t ) 0 )
+		{
+			traceQUEUE_SEND_MULTIPLE_FROM_ISR( pxQueue, uxItemsSent );
+
+			/* The event lists are not altered if the queue is locked.  This
+			will be done when the queue is unlocked later. */
+			if( cTxLock == queueUNLOCKED )
+			{
+				if( prvUnblockMultipleReceivers( pxQueue, uxItemsSent ) != pdFALSE )
+				{
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* Increase the lock count so the task that unlocks the queue
+				knows how many items were posted while it was locked. */
+				pxQueue->cTxLock = ( int8_t ) ( cTxLock + ( int8_t ) uxItemsSent );
+			}
+		}
+		else
+		{
+			traceQUEUE_SEND_FROM_ISR_FAILED( pxQueue );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return uxItemsSent;
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueReceiveMultiple( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, TickType_t xTicksToWait )
+{
+BaseType_t xEntryTimeSet = pdFALSE;
+TimeOut_t xTimeOut;
+UBaseType_t uxItemsReceived;
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+	configASSERT( uxMaxItems > ( UBaseType_t ) 0U );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* Cannot block if the scheduler is suspended. */
+	#if ( ( INCLUDE_xTaskGetSchedulerState == 1 ) || ( configUSE_TIMERS == 1 ) )
+	{
+		configASSERT( !( ( xTaskGetSchedulerState() == taskSCHEDULER_SUSPENDED ) && ( xTicksToWait != 0 ) ) );
+	}
+	#endif
+
+
+	/*lint -save -e904  This function relaxes the coding standard somewhat to
+	allow return statements within the function itself.  This is done in the
+	interest of execution time efficiency. */
+	for( ;; )
+	{
+		taskENTER_CRITICAL();
+		{
+			/* Is there data in the queue now?  To be running the calling task
+			must be the highest priority task wanting to access the queue. */
+			if( pxQueue->uxMessagesWaiting > ( UBaseType_t ) 0 )
+			{
+				/* Data available, remove as many items as are wanted, then
+				unblock the tasks that can use the space freed. */
+				uxItemsReceived = prvCopyMultipleDataFromQueue( pxQueue, ( int8_t * ) pvBuffer, uxMaxItems );
+				traceQUEUE_RECEIVE_MULTIPLE( pxQueue, uxItemsReceived );
+
+				if( prvUnblockMultipleSenders( pxQueue, uxItemsReceived ) != pdFALSE )
+				{
+					queueYIELD_IF_USING_PREEMPTION();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				taskEXIT_CRITICAL();
+				return uxItemsReceived;
+			}
+			else
+			{
+				if( xTicksToWait == ( TickType_t ) 0 )
+				{
+					/* The queue was empty and no block time is specified (or
+					the block time has expired) so leave now. */
+					taskEXIT_CRITICAL();
+					traceQUEUE_RECEIVE_FAILED( pxQueue );
+					return ( UBaseType_t ) 0;
+				}
+				else if( xEntryTimeSet == pdFALSE )
+				{
+					/* The queue was empty and a block time was specified so
+					configure the timeout structure. */
+					vTaskInternalSetTimeOutState( &xTimeOut );
+					xEntryTimeSet = pdTRUE;
+				}
+				else
+				{
+					/* Entry time was already set. */
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		/* Interrupts and other tasks can send to and receive from the queue
+		now the critical section has been exited. */
+
+		vTaskSuspendAll();
+		prvLockQueue( pxQueue );
+
+		/* Update the timeout state to see if it has expired yet. */
+		if( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE )
+		{
+			/* The timeout has not expired.  If the queue is still empty place
+			the task on the list of tasks waiting to receive from the queue. */
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue );
+				taskPROFILE_WAIT_OBJECT( pxQueue );
+				vTaskPlaceOnEventList( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait );
+				prvUnlockQueue( pxQueue );
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* The queue contains data again.  Loop back to try and read the
+				data. */
+				prvUnlockQueue( pxQueue );
+				( void ) xTaskResumeAll();
+			}
+		}
+		else
+		{
+			/* Timed out.  If there is no data in the queue exit, otherwise loop
+			back and attempt to read the data. */
+			prvUnlockQueue( pxQueue );
+			( void ) xTaskResumeAll();
+
+			if( prvIsQueueEmpty( pxQueue ) != pdFALSE )
+			{
+				traceQUEUE_RECEIVE_FAILED( pxQueue );
+				return ( UBaseType_t ) 0;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+	} /*lint -restore */
+}
+/*-----------------------------------------------------------*/
+
+UBaseType_t uxQueueReceiveMultipleFromISR( QueueHandle_t xQueue, void * const pvBuffer, const UBaseType_t uxMaxItems, BaseType_t * const pxHigherPriorityTaskWoken )
+{
+UBaseType_t uxItemsReceived, uxItemsWanted = uxMaxItems;
+UBaseType_t uxSavedInterruptStatus;
+Queue_t * const pxQueue = xQueue;
+
+	configASSERT( pxQueue );
+	configASSERT( pvBuffer );
+	configASSERT( pxQueue->uxItemSize != ( UBaseType_t ) 0U );
+
+	/* See the comments in xQueueReceiveFromISR(). */
+	portASSERT_IF_INTERRUPT_PRIORITY_INVALID();
+
+	uxSavedInterruptStatus = portSET_INTERRUPT_MASK_FROM_ISR();
+	{
+		const int8_t cRxLock = pxQueue->cRxLock;
+
+		/* If the queue is locked the items removed are counted in cRxLock,
+		so remove no more than can be counted. */
+		if( ( cRxLock != queueUNLOCKED ) && ( uxItemsWanted > ( UBaseType_t ) ( queueMAX_LOCK_COUNT - cRxLock ) ) )
+		{
+			uxItemsWanted = ( UBaseType_t ) ( queueMAX_LOCK_COUNT - cRxLock );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		uxItemsReceived = prvCopyMultipleDataFromQueue( pxQueue, ( int8_t * ) pvBuffer, uxItemsWanted );
+
+		if( uxItemsReceived > ( UBaseType_t ) 0 )
+		{
+			traceQUEUE_RECEIVE_MULTIPLE_FROM_ISR( pxQueue, uxItemsReceived );
+
+			/* If the queue is locked the event list will not be modified.
+			Instead update the lock count so the task that unlocks the queue
+			will know how many items an ISR removed while the queue was
+			locked. */
+			if( cRxLock == queueUNLOCKED )
+			{
+				if( prvUnblockMultipleSenders( pxQueue, uxItemsReceived ) != pdFALSE )
+				{
+					if( pxHigherPriorityTaskWoken != NULL )
+					{
+						*pxHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				pxQueue->cRxLock = ( int8_t ) ( cRxLock + ( int8_t ) uxItemsReceived );
+			}
+		}
+		else
+		{
+			traceQUEUE_RECEIVE_FROM_ISR_FAILED( pxQueue );
+		}
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( uxSavedInterruptStatus );
+
+	return uxItemsReceived;
+}
+/*-----------------------------------------------------------*/
+
 BaseType_t xQueuePeekFromISR( QueueHandle_t xQueue,  void * const pvBuffer )
 {
 BaseType_t xReturn;
@@ -2164,6 +2606,252 @@ static void prvCopyDataFromQueue( Queue_t * const pxQueue, void * const pvBuffer
 }
 /*-----------------------------------------------------------*/
 
+static UBaseType_t prvCopyMultipleDataToQueue( Queue_t * const pxQueue, const int8_t *pcItems, const UBaseType_t uxItemCount )
+{
+UBaseType_t uxItemsToCopy, uxItemsBeforeTail;
+size_t xBytesToCopy;
+
+	/* This function is called from a critical section. */
+
+	uxItemsToCopy = pxQueue->uxLength - pxQueue->uxMessagesWaiting;
+
+	if( uxItemsToCopy > uxItemCount )
+	{
+		uxItemsToCopy = uxItemCount;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( uxItemsToCopy > ( UBaseType_t ) 0 )
+	{
+		/* The free space may wrap around the end of the storage area, in
+		which case the items are copied in two parts. */
+		uxItemsBeforeTail = ( UBaseType_t ) ( ( size_t ) ( pxQueue->u.xQueue.pcTail - pxQueue->pcWriteTo ) / ( size_t ) pxQueue->uxItemSize ); /*lint !e946 !e9033 MISRA exception justified as both pointers point into the storage area. */
+
+		if( uxItemsBeforeTail > uxItemsToCopy )
+		{
+			uxItemsBeforeTail = uxItemsToCopy;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xBytesToCopy = ( size_t ) uxItemsBeforeTail * ( size_t ) pxQueue->uxItemSize;
+		( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) pcItems, xBytesToCopy ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+		pxQueue->pcWriteTo += xBytesToCopy; /*lint !e9016 Pointer arithmetic on char types ok, especially in this use case where it is the clearest way of conveying intent. */
+
+		if( pxQueue->pcWriteTo >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as comparison of pointers is the cleanest solution. */
+		{
+			pxQueue->pcWriteTo = pxQueue->pcHead;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		if( uxItemsToCopy > uxItemsBeforeTail )
+		{
+			pcItems += xBytesToCopy; /*lint !e9016 Pointer arithmetic on char types ok. */
+			xBytesToCopy = ( size_t ) ( uxItemsToCopy - uxItemsBeforeTail ) * ( size_t ) pxQueue->uxItemSize;
+			( void ) memcpy( ( void * ) pxQueue->pcWriteTo, ( const void * ) pcItems, xBytesToCopy ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+			pxQueue->pcWriteTo += xBytesToCopy; /*lint !e9016 Pointer arithmetic on char types ok. */
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxQueue->uxMessagesWaiting += uxItemsToCopy;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return uxItemsToCopy;
+}
+/*-----------------------------------------------------------*/
+
+static UBaseType_t prvCopyMultipleDataFromQueue( Queue_t * const pxQueue, int8_t *pcBuffer, const UBaseType_t uxMaxItems )
+{
+UBaseType_t uxItemsToCopy, uxItemsBeforeTail;
+size_t xBytesToCopy;
+int8_t *pcReadFrom;
+
+	/* This function is called from a critical section. */
+
+	uxItemsToCopy = pxQueue->uxMessagesWaiting;
+
+	if( uxItemsToCopy > uxMaxItems )
+	{
+		uxItemsToCopy = uxMaxItems;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	if( uxItemsToCopy > ( UBaseType_t ) 0 )
+	{
+		/* pcReadFrom points to the last item read, so the first item to
+		read follows it. */
+		pcReadFrom = pxQueue->u.xQueue.pcReadFrom + pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+
+		if( pcReadFrom >= pxQueue->u.xQueue.pcTail ) /*lint !e946 MISRA exception justified as use of the relational operator is the cleanest solutions. */
+		{
+			pcReadFrom = pxQueue->pcHead;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* The items may wrap around the end of the storage area, in which
+		case they are copied in two parts. */
+		uxItemsBeforeTail = ( UBaseType_t ) ( ( size_t ) ( pxQueue->u.xQueue.pcTail - pcReadFrom ) / ( size_t ) pxQueue->uxItemSize ); /*lint !e946 !e9033 MISRA exception justified as both pointers point into the storage area. */
+
+		if( uxItemsBeforeTail > uxItemsToCopy )
+		{
+			uxItemsBeforeTail = uxItemsToCopy;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xBytesToCopy = ( size_t ) uxItemsBeforeTail * ( size_t ) pxQueue->uxItemSize;
+		( void ) memcpy( ( void * ) pcBuffer, ( void * ) pcReadFrom, xBytesToCopy ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+		pcReadFrom += xBytesToCopy; /*lint !e9016 Pointer arithmetic on char types ok. */
+
+		if( uxItemsToCopy > uxItemsBeforeTail )
+		{
+			pcBuffer += xBytesToCopy; /*lint !e9016 Pointer arithmetic on char types ok. */
+			xBytesToCopy = ( size_t ) ( uxItemsToCopy - uxItemsBeforeTail ) * ( size_t ) pxQueue->uxItemSize;
+			( void ) memcpy( ( void * ) pcBuffer, ( void * ) pxQueue->pcHead, xBytesToCopy ); /*lint !e961 !e418 !e9087 MISRA exception as the casts are only redundant for some ports. */
+			pcReadFrom = pxQueue->pcHead + xBytesToCopy; /*lint !e9016 Pointer arithmetic on char types ok. */
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Leave pcReadFrom pointing to the last item read. */
+		pxQueue->u.xQueue.pcReadFrom = pcReadFrom - pxQueue->uxItemSize; /*lint !e9016 Pointer arithmetic on char types ok. */
+		pxQueue->uxMessagesWaiting -= uxItemsToCopy;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return uxItemsToCopy;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUnblockMultipleReceivers( Queue_t * const pxQueue, const UBaseType_t uxItemCount )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+UBaseType_t uxItem;
+
+	/* This function is called from a critical section. */
+
+	for( uxItem = 0; uxItem < uxItemCount; uxItem++ )
+	{
+		#if ( configUSE_QUEUE_SETS == 1 )
+		{
+			if( pxQueue->pxQueueSetContainer != NULL )
+			{
+				/* The queue set holds the handle of the queue once for each
+				item in the queue. */
+				if( prvNotifyQueueSetContainer( pxQueue, queueSEND_TO_BACK ) != pdFALSE )
+				{
+					xHigherPriorityTaskWoken = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+				{
+					if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+					{
+						xHigherPriorityTaskWoken = pdTRUE;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					/* No more tasks are waiting. */
+					break;
+				}
+			}
+		}
+		#else /* configUSE_QUEUE_SETS */
+		{
+			if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToReceive ) ) == pdFALSE )
+			{
+				if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToReceive ) ) != pdFALSE )
+				{
+					xHigherPriorityTaskWoken = pdTRUE;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				/* No more tasks are waiting. */
+				break;
+			}
+		}
+		#endif /* configUSE_QUEUE_SETS */
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
+static BaseType_t prvUnblockMultipleSenders( Queue_t * const pxQueue, const UBaseType_t uxItemCount )
+{
+BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+UBaseType_t uxItem;
+
+	/* This function is called from a critical section. */
+
+	for( uxItem = 0; uxItem < uxItemCount; uxItem++ )
+	{
+		if( listLIST_IS_EMPTY( &( pxQueue->xTasksWaitingToSend ) ) == pdFALSE )
+		{
+			if( xTaskRemoveFromEventList( &( pxQueue->xTasksWaitingToSend ) ) != pdFALSE )
+			{
+				xHigherPriorityTaskWoken = pdTRUE;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			/* No more tasks are waiting. */
+			break;
+		}
+	}
+
+	return xHigherPriorityTaskWoken;
+}
+/*-----------------------------------------------------------*/
+
 static void prvUnlockQueue( Queue_t * const pxQueue )
 {
 	/* THIS FUNCTION MUST BE CALLED WITH THE SCHEDULER SUSPENDED. */
@@ -2752,6 +3440,7 @@ Queue_t * const pxQueue = xQueue;
 		if( pxQueue->uxMessagesWaiting == ( UBaseType_t ) 0U )
 		{
 			/* There is nothing in the queue, block for the specified period. */
+			taskPROFILE_WAIT_OBJECT( pxQueue );
 			vTaskPlaceOnEventListRestricted( &( pxQueue->xTasksWaitingToReceive ), xTicksToWait, xWaitIndefinitely );
 		}
 		else
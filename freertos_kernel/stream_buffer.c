@@ -39,6 +39,10 @@ task.h is included from an application file. */
 #include "task.h"
 #include "stream_buffer.h"
 
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	#include "atomic.h"
+#endif
+
 #if( configUSE_TASK_NOTIFICATIONS != 1 )
 	#error configUSE_TASK_NOTIFICATIONS must be set to 1 to build stream_buffer.c
 #endif
@@ -134,6 +138,23 @@ that uses task notifications. */
 /* Bits stored in the ucFlags field of the stream buffer. */
 #define sbFLAGS_IS_MESSAGE_BUFFER		( ( uint8_t ) 1 ) /* Set if the stream buffer was created as a message buffer, in which case it holds discrete messages rather than a stream. */
 #define sbFLAGS_IS_STATICALLY_ALLOCATED ( ( uint8_t ) 2 ) /* Set if the stream buffer was created using statically allocated memory. */
+#define sbFLAGS_IS_MULTI_PRODUCER		( ( uint8_t ) 4 ) /* Set if the message buffer was created as a multi-producer message buffer, in which case it holds records written by any number of writers rather than a stream. */
+
+/* States of a record in a multi-producer message buffer.  A record is zero, so
+neither committed nor padding, from the time it is reserved until it is
+committed. */
+#define sbRECORD_COMMITTED				( ( uint32_t ) 1 )
+#define sbRECORD_PADDING				( ( uint32_t ) 2 )
+
+/* The space taken by a record holding a message of xDataLengthBytes bytes.
+Records start on multiples of the record header size, so a header always fits
+between the end of a record and the end of the storage area. */
+#define sbRECORD_SIZE( xDataLengthBytes ) ( ( ( xDataLengthBytes ) + ( 2 * sizeof( MessageRecord_t ) ) - 1 ) & ~( sizeof( MessageRecord_t ) - 1 ) )
+
+/* The offset in the storage area of a multi-producer message buffer of a
+free running record index.  The length of the storage area used is a power of
+two. */
+#define sbRECORD_OFFSET( pxStreamBuffer, ulIndex ) ( ( ulIndex ) & ( ( uint32_t ) ( pxStreamBuffer )->xLength - ( uint32_t ) 1 ) )
 
 /*-----------------------------------------------------------*/
 
@@ -152,8 +173,21 @@ typedef struct StreamBufferDef_t /*lint !e9058 Style convention uses tag. */
 	#if ( configUSE_TRACE_FACILITY == 1 )
 		UBaseType_t uxStreamBufferNumber;		/* Used for tracing purposes. */
 	#endif
+
+	#if ( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+		volatile uint32_t ulReserveIndex;		/* Multi-producer message buffers only.  Free running index of the next record to reserve, so it only repeats after 2^32 bytes have been reserved. */
+		volatile uint32_t ulReadIndex;			/* Multi-producer message buffers only.  Free running index of the next record to read. */
+	#endif
 } StreamBuffer_t;
 
+/* The header of a record in a multi-producer message buffer.  The message
+follows the header. */
+typedef struct MessageRecord
+{
+	volatile uint32_t ulState;	/* Zero, sbRECORD_COMMITTED or sbRECORD_PADDING. */
+	uint32_t ulLength;			/* The length of the message, or of the padding, that follows the header. */
+} MessageRecord_t;
+
 /*
  * The number of bytes available to be read from the buffer.
  */
@@ -212,6 +246,100 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 										  size_t xTriggerLevelBytes,
 										  uint8_t ucFlags ) PRIVILEGED_FUNCTION;
 
+/*
+ * The space needed to write xDataLengthBytes bytes, which includes the bytes
+ * that hold the length of the message if the stream buffer is being used as a
+ * message buffer.
+ */
+static size_t prvRequiredSpace( const StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+/*
+ * Blocks for up to xTicksToWait ticks until xRequiredSpace bytes are free, as
+ * xStreamBufferSend() does, then returns the number of bytes free.
+ */
+static size_t prvWaitForSpace( StreamBuffer_t * const pxStreamBuffer, size_t xRequiredSpace, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Blocks for up to xTicksToWait ticks until data is available, as
+ * xStreamBufferReceive() does, then returns the number of bytes available.
+ */
+static size_t prvWaitForData( StreamBuffer_t * const pxStreamBuffer, TickType_t xTicksToWait ) PRIVILEGED_FUNCTION;
+
+/*
+ * Describes the xCount bytes of the storage area that start at index xStart
+ * in pxRegion, as one or two (if they wrap) contiguous parts.
+ */
+static void prvFillRegion( const StreamBuffer_t * const pxStreamBuffer, size_t xStart, size_t xCount, StreamBufferRegion_t * const pxRegion ) PRIVILEGED_FUNCTION;
+
+/*
+ * Describes in pxRegion the free space xStreamBufferSendAcquire() hands out
+ * for xDataLengthBytes bytes, and returns its size.
+ */
+static size_t prvGetFreeRegion( const StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes, size_t xSpace, StreamBufferRegion_t * const pxRegion ) PRIVILEGED_FUNCTION;
+
+/*
+ * Describes in pxRegion the data xStreamBufferReceiveAcquire() hands out -
+ * all the bytes available in a stream buffer, or the next message in a
+ * message buffer - and returns its size.
+ */
+static size_t prvGetDataRegion( const StreamBuffer_t * const pxStreamBuffer, size_t xBytesAvailable, StreamBufferRegion_t * const pxRegion ) PRIVILEGED_FUNCTION;
+
+/*
+ * Adds the xBytesWritten bytes already written in place to the buffer, writing
+ * the length of the message first if the buffer is a message buffer.
+ */
+static size_t prvCommitBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, size_t xBytesWritten ) PRIVILEGED_FUNCTION;
+
+/*
+ * Removes the xBytesConsumed bytes already read in place from the buffer,
+ * together with the length of the message if the buffer is a message buffer.
+ */
+static size_t prvReleaseBytesFromBuffer( StreamBuffer_t * const pxStreamBuffer, size_t xBytesConsumed ) PRIVILEGED_FUNCTION;
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	/*
+	 * The number of bytes of the storage area of a multi-producer message
+	 * buffer taken by records that have not yet been read.
+	 */
+	static uint32_t prvRecordBytesInUse( const StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Reserves a record for a message of xDataLengthBytes bytes in a
+	 * multi-producer message buffer, or returns NULL if there is not enough
+	 * space.  Safe to call from any number of tasks and interrupts at once, as
+	 * the reservation is a single compare and swap.
+	 */
+	static MessageRecord_t *prvReserveRecord( StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Reserves a record, copies the message into it and commits it.  Returns
+	 * xDataLengthBytes, or 0 if the message did not fit.
+	 */
+	static size_t prvWriteRecordToBuffer( StreamBuffer_t * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Returns the next message record to read from a multi-producer message
+	 * buffer, skipping padding, or NULL if there is none or it is still being
+	 * written.  Only called by the reader.
+	 */
+	static MessageRecord_t *prvNextRecord( StreamBuffer_t * const pxStreamBuffer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Hands the space taken by the record at the read index back to the
+	 * writers.  Only called by the reader.
+	 */
+	static void prvReleaseRecord( StreamBuffer_t * const pxStreamBuffer, MessageRecord_t * const pxRecord ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Copies the next message out of a multi-producer message buffer and
+	 * releases its record.  Returns the length of the message, or 0 if there
+	 * is no message or it is longer than xBufferLengthBytes.
+	 */
+	static size_t prvReadRecordFromBuffer( StreamBuffer_t * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+
 /*-----------------------------------------------------------*/
 
 #if( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
@@ -225,7 +353,7 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 		(that is, it will hold discrete messages with a little meta data that
 		says how big the next message is) check the buffer will be large enough
 		to hold at least one message. */
-		if( xIsMessageBuffer == pdTRUE )
+		if( xIsMessageBuffer != pdFALSE )
 		{
 			/* Is a message buffer but not statically allocated. */
 			ucFlags = sbFLAGS_IS_MESSAGE_BUFFER;
@@ -239,6 +367,22 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 		}
 		configASSERT( xTriggerLevelBytes <= xBufferSizeBytes );
 
+		#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+		{
+			if( xIsMessageBuffer == sbMULTI_PRODUCER_MESSAGE_BUFFER )
+			{
+				/* The buffer must be large enough to hold the record of a one
+				byte message. */
+				ucFlags |= sbFLAGS_IS_MULTI_PRODUCER;
+				configASSERT( xBufferSizeBytes >= sbRECORD_SIZE( 1 ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+
 		/* A trigger level of 0 would cause a waiting task to unblock even when
 		the buffer was empty. */
 		if( xTriggerLevelBytes == ( size_t ) 0 )
@@ -312,6 +456,24 @@ static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
 			ucFlags = sbFLAGS_IS_STATICALLY_ALLOCATED;
 		}
 
+		#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+		{
+			if( xIsMessageBuffer == sbMULTI_PRODUCER_MESSAGE_BUFFER )
+			{
+				/* The storage area holds records that start with 32-bit
+				words, and must be large enough to hold the record of a one
+				byte message. */
+				ucFlags |= sbFLAGS_IS_MULTI_PRODUCER;
+				configASSERT( ( ( ( portPOINTER_SIZE_TYPE ) pucStreamBufferStorageArea ) & ( sizeof( uint32_t ) - 1 ) ) == 0 );
+				configASSERT( xBufferSizeBytes >= sbRECORD_SIZE( 1 ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+
 		/* In case the stream buffer is going to be used as a message buffer
 		(that is, it will hold discrete messages with a little meta data that
 		says how big the next message is) check the buffer will be large enough
@@ -474,17 +636,28 @@ size_t xSpace;
 
 	configASSERT( pxStreamBuffer );
 
-	xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
-	xSpace -= pxStreamBuffer->xHead;
-	xSpace -= ( size_t ) 1;
-
-	if( xSpace >= pxStreamBuffer->xLength )
+	#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 )
 	{
-		xSpace -= pxStreamBuffer->xLength;
+		/* Each message also takes a record header, and the padding that
+		rounds the record up to a multiple of the header size. */
+		xSpace = pxStreamBuffer->xLength - ( size_t ) prvRecordBytesInUse( pxStreamBuffer );
 	}
 	else
+	#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
 	{
-		mtCOVERAGE_TEST_MARKER();
+		xSpace = pxStreamBuffer->xLength + pxStreamBuffer->xTail;
+		xSpace -= pxStreamBuffer->xHead;
+		xSpace -= ( size_t ) 1;
+
+		if( xSpace >= pxStreamBuffer->xLength )
+		{
+			xSpace -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 	}
 
 	return xSpace;
@@ -498,7 +671,17 @@ size_t xReturn;
 
 	configASSERT( pxStreamBuffer );
 
-	xReturn = prvBytesInBuffer( pxStreamBuffer );
+	#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 )
+	{
+		xReturn = ( size_t ) prvRecordBytesInUse( pxStreamBuffer );
+	}
+	else
+	#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+	{
+		xReturn = prvBytesInBuffer( pxStreamBuffer );
+	}
+
 	return xReturn;
 }
 /*-----------------------------------------------------------*/
@@ -515,6 +698,7 @@ TimeOut_t xTimeOut;
 
 	configASSERT( pvTxData );
 	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
 
 	/* This send function is used to write to both message buffers and stream
 	buffers.  If this is a message buffer then the space needed must be
@@ -562,6 +746,7 @@ TimeOut_t xTimeOut;
 			taskEXIT_CRITICAL();
 
 			traceBLOCKING_ON_STREAM_BUFFER_SEND( xStreamBuffer );
+			taskPROFILE_WAIT_OBJECT( pxStreamBuffer );
 			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
 			pxStreamBuffer->xTaskWaitingToSend = NULL;
 
@@ -618,6 +803,7 @@ size_t xRequiredSpace = xDataLengthBytes;
 
 	configASSERT( pvTxData );
 	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
 
 	/* This send function is used to write to both message buffers and stream
 	buffers.  If this is a message buffer then the space needed must be
@@ -720,6 +906,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 
 	configASSERT( pvRxData );
 	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
 
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
@@ -768,6 +955,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 		{
 			/* Wait for data to be available. */
 			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+			taskPROFILE_WAIT_OBJECT( pxStreamBuffer );
 			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
 			pxStreamBuffer->xTaskWaitingToReceive = NULL;
 
@@ -819,9 +1007,20 @@ size_t xStreamBufferNextMessageLengthBytes( StreamBufferHandle_t xStreamBuffer )
 StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 size_t xReturn, xBytesAvailable, xOriginalTail;
 configMESSAGE_BUFFER_LENGTH_TYPE xTempReturn;
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	const MessageRecord_t *pxRecord;
+#endif
 
 	configASSERT( pxStreamBuffer );
 
+	#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 )
+	{
+		pxRecord = prvNextRecord( pxStreamBuffer );
+		xReturn = ( pxRecord != NULL ) ? ( size_t ) pxRecord->ulLength : ( size_t ) 0;
+	}
+	else
+	#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
 	/* Ensure the stream buffer is being used as a message buffer. */
 	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
 	{
@@ -868,6 +1067,7 @@ size_t xReceivedLength = 0, xBytesAvailable, xBytesToStoreMessageLength;
 
 	configASSERT( pvRxData );
 	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
 
 	/* This receive function is used by both message buffers, which store
 	discrete messages, and stream buffers, which store a continuous stream of
@@ -971,13 +1171,27 @@ BaseType_t xStreamBufferIsEmpty( StreamBufferHandle_t xStreamBuffer )
 {
 const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 BaseType_t xReturn;
-size_t xTail;
+size_t xHead, xTail;
 
 	configASSERT( pxStreamBuffer );
 
+	#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 )
+	{
+		/* The read and reserve indexes of a multi-producer message buffer
+		take the place of the tail and head. */
+		xTail = ( size_t ) pxStreamBuffer->ulReadIndex;
+		xHead = ( size_t ) pxStreamBuffer->ulReserveIndex;
+	}
+	else
+	#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+	{
+		xTail = pxStreamBuffer->xTail;
+		xHead = pxStreamBuffer->xHead;
+	}
+
 	/* True if no bytes are available. */
-	xTail = pxStreamBuffer->xTail;
-	if( pxStreamBuffer->xHead == xTail )
+	if( xHead == xTail )
 	{
 		xReturn = pdTRUE;
 	}
@@ -1002,6 +1216,14 @@ const StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 	buffers, which store discrete messages, and stream buffers, which store a
 	continuous stream of bytes.  Discrete messages include an additional
 	sbBYTES_TO_STORE_MESSAGE_LENGTH bytes that hold the length of the message. */
+	#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 )
+	{
+		/* A message in a multi-producer message buffer takes a whole record. */
+		xBytesToStoreMessageLength = sbRECORD_SIZE( 1 ) - ( size_t ) 1;
+	}
+	else
+	#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
 	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
 	{
 		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
@@ -1085,151 +1307,1081 @@ UBaseType_t uxSavedInterruptStatus;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount )
+size_t xStreamBufferSendAcquire( StreamBufferHandle_t xStreamBuffer,
+								 size_t xDataLengthBytes,
+								 StreamBufferRegion_t * const pxRegion,
+								 TickType_t xTicksToWait )
 {
-size_t xNextHead, xFirstLength;
-
-	configASSERT( xCount > ( size_t ) 0 );
-
-	xNextHead = pxStreamBuffer->xHead;
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn, xSpace;
 
-	/* Calculate the number of bytes that can be added in the first write -
-	which may be less than the total number of bytes that need to be added if
-	the buffer will wrap back to the beginning. */
-	xFirstLength = configMIN( pxStreamBuffer->xLength - xNextHead, xCount );
+	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
+	configASSERT( pxRegion );
 
-	/* Write as many bytes as can be written in the first write. */
-	configASSERT( ( xNextHead + xFirstLength ) <= pxStreamBuffer->xLength );
-	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	xSpace = prvWaitForSpace( pxStreamBuffer, prvRequiredSpace( pxStreamBuffer, xDataLengthBytes ), xTicksToWait );
+	xReturn = prvGetFreeRegion( pxStreamBuffer, xDataLengthBytes, xSpace, pxRegion );
 
-	/* If the number of bytes written was less than the number that could be
-	written in the first write... */
-	if( xCount > xFirstLength )
+	if( xReturn == ( size_t ) 0 )
 	{
-		/* ...then write the remaining bytes to the start of the buffer. */
-		configASSERT( ( xCount - xFirstLength ) <= pxStreamBuffer->xLength );
-		( void ) memcpy( ( void * ) pxStreamBuffer->pucBuffer, ( const void * ) &( pucData[ xFirstLength ] ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+		traceSTREAM_BUFFER_SEND_FAILED( xStreamBuffer );
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	xNextHead += xCount;
-	if( xNextHead >= pxStreamBuffer->xLength )
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										size_t xDataLengthBytes,
+										StreamBufferRegion_t * const pxRegion )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
+	configASSERT( pxRegion );
+
+	return prvGetFreeRegion( pxStreamBuffer, xDataLengthBytes, xStreamBufferSpacesAvailable( pxStreamBuffer ), pxRegion );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferSendCommit( StreamBufferHandle_t xStreamBuffer, size_t xBytesWritten )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	xReturn = prvCommitBytesToBuffer( pxStreamBuffer, xBytesWritten );
+
+	if( xReturn > ( size_t ) 0 )
 	{
-		xNextHead -= pxStreamBuffer->xLength;
+		traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
+
+		/* Was a task waiting for the data? */
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
+		{
+			sbSEND_COMPLETED( pxStreamBuffer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	pxStreamBuffer->xHead = xNextHead;
-
-	return xCount;
+	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xMaxCount, size_t xBytesAvailable )
+size_t xStreamBufferSendCommitFromISR( StreamBufferHandle_t xStreamBuffer,
+									   size_t xBytesWritten,
+									   BaseType_t * const pxHigherPriorityTaskWoken )
 {
-size_t xCount, xFirstLength, xNextTail;
-
-	/* Use the minimum of the wanted bytes and the available bytes. */
-	xCount = configMIN( xBytesAvailable, xMaxCount );
-
-	if( xCount > ( size_t ) 0 )
-	{
-		xNextTail = pxStreamBuffer->xTail;
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn;
 
-		/* Calculate the number of bytes that can be read - which may be
-		less than the number wanted if the data wraps around to the start of
-		the buffer. */
-		xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
+	configASSERT( pxStreamBuffer );
 
-		/* Obtain the number of bytes it is possible to obtain in the first
-		read.  Asserts check bounds of read and write. */
-		configASSERT( xFirstLength <= xMaxCount );
-		configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
-		( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	xReturn = prvCommitBytesToBuffer( pxStreamBuffer, xBytesWritten );
 
-		/* If the total number of wanted bytes is greater than the number
-		that could be read in the first read... */
-		if( xCount > xFirstLength )
+	if( xReturn > ( size_t ) 0 )
+	{
+		/* Was a task waiting for the data? */
+		if( prvBytesInBuffer( pxStreamBuffer ) >= pxStreamBuffer->xTriggerLevelBytes )
 		{
-			/*...then read the remaining bytes from the start of the buffer. */
-			configASSERT( xCount <= xMaxCount );
-			( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+			sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
 		}
 		else
 		{
 			mtCOVERAGE_TEST_MARKER();
 		}
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-		/* Move the tail pointer to effectively remove the data read from
-		the buffer. */
-		xNextTail += xCount;
+	traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xReturn );
 
-		if( xNextTail >= pxStreamBuffer->xLength )
-		{
-			xNextTail -= pxStreamBuffer->xLength;
-		}
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
 
-		pxStreamBuffer->xTail = xNextTail;
+size_t xStreamBufferReceiveAcquire( StreamBufferHandle_t xStreamBuffer,
+									StreamBufferRegion_t * const pxRegion,
+									TickType_t xTicksToWait )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn, xBytesAvailable;
+
+	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
+	configASSERT( pxRegion );
+
+	xBytesAvailable = prvWaitForData( pxStreamBuffer, xTicksToWait );
+	xReturn = prvGetDataRegion( pxStreamBuffer, xBytesAvailable, pxRegion );
+
+	if( xReturn == ( size_t ) 0 )
+	{
+		traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	return xCount;
+	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer )
+size_t xStreamBufferReceiveAcquireFromISR( StreamBufferHandle_t xStreamBuffer,
+										   StreamBufferRegion_t * const pxRegion )
 {
-/* Returns the distance between xTail and xHead. */
-size_t xCount;
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
 
-	xCount = pxStreamBuffer->xLength + pxStreamBuffer->xHead;
-	xCount -= pxStreamBuffer->xTail;
-	if ( xCount >= pxStreamBuffer->xLength )
+	configASSERT( pxStreamBuffer );
+	configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) == ( uint8_t ) 0 );
+	configASSERT( pxRegion );
+
+	return prvGetDataRegion( pxStreamBuffer, prvBytesInBuffer( pxStreamBuffer ), pxRegion );
+}
+/*-----------------------------------------------------------*/
+
+size_t xStreamBufferReceiveRelease( StreamBufferHandle_t xStreamBuffer, size_t xBytesConsumed )
+{
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	xReturn = prvReleaseBytesFromBuffer( pxStreamBuffer, xBytesConsumed );
+
+	/* Was a task waiting for space in the buffer? */
+	if( xReturn > ( size_t ) 0 )
 	{
-		xCount -= pxStreamBuffer->xLength;
+		traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReturn );
+		sbRECEIVE_COMPLETED( pxStreamBuffer );
 	}
 	else
 	{
 		mtCOVERAGE_TEST_MARKER();
 	}
 
-	return xCount;
+	return xReturn;
 }
 /*-----------------------------------------------------------*/
 
-static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
-										  uint8_t * const pucBuffer,
-										  size_t xBufferSizeBytes,
-										  size_t xTriggerLevelBytes,
-										  uint8_t ucFlags )
+size_t xStreamBufferReceiveReleaseFromISR( StreamBufferHandle_t xStreamBuffer,
+										   size_t xBytesConsumed,
+										   BaseType_t * const pxHigherPriorityTaskWoken )
 {
-	/* Assert here is deliberately writing to the entire buffer to ensure it can
-	be written to without generating exceptions, and is setting the buffer to a
-	known value to assist in development/debugging. */
-	#if( configASSERT_DEFINED == 1 )
+StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+size_t xReturn;
+
+	configASSERT( pxStreamBuffer );
+
+	xReturn = prvReleaseBytesFromBuffer( pxStreamBuffer, xBytesConsumed );
+
+	/* Was a task waiting for space in the buffer? */
+	if( xReturn > ( size_t ) 0 )
 	{
-		/* The value written just has to be identifiable when looking at the
-		memory.  Don't use 0xA5 as that is the stack fill value and could
-		result in confusion as to what is actually being observed. */
-		const BaseType_t xWriteValue = 0x55;
-		configASSERT( memset( pucBuffer, ( int ) xWriteValue, xBufferSizeBytes ) == pucBuffer );
-	} /*lint !e529 !e438 xWriteValue is only used if configASSERT() is defined. */
-	#endif
+		sbRECEIVE_COMPLETED_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
 
-	( void ) memset( ( void * ) pxStreamBuffer, 0x00, sizeof( StreamBuffer_t ) ); /*lint !e9087 memset() requires void *. */
-	pxStreamBuffer->pucBuffer = pucBuffer;
-	pxStreamBuffer->xLength = xBufferSizeBytes;
+	traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReturn );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	size_t xStreamBufferMultiProducerSend( StreamBufferHandle_t xStreamBuffer,
+										   const void *pvTxData,
+										   size_t xDataLengthBytes )
+	{
+	StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+	size_t xReturn;
+
+		configASSERT( pvTxData );
+		configASSERT( pxStreamBuffer );
+		configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 );
+
+		xReturn = prvWriteRecordToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes );
+
+		if( xReturn > ( size_t ) 0 )
+		{
+			traceSTREAM_BUFFER_SEND( xStreamBuffer, xReturn );
+
+			/* The reader only waits when there is no committed message, so
+			is woken by any message committed while it waits. */
+			sbSEND_COMPLETED( pxStreamBuffer );
+		}
+		else
+		{
+			traceSTREAM_BUFFER_SEND_FAILED( xStreamBuffer );
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	size_t xStreamBufferMultiProducerSendFromISR( StreamBufferHandle_t xStreamBuffer,
+												  const void *pvTxData,
+												  size_t xDataLengthBytes,
+												  BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+	size_t xReturn;
+
+		configASSERT( pvTxData );
+		configASSERT( pxStreamBuffer );
+		configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 );
+
+		xReturn = prvWriteRecordToBuffer( pxStreamBuffer, pvTxData, xDataLengthBytes );
+
+		if( xReturn > ( size_t ) 0 )
+		{
+			sbSEND_COMPLETE_FROM_ISR( pxStreamBuffer, pxHigherPriorityTaskWoken );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		traceSTREAM_BUFFER_SEND_FROM_ISR( xStreamBuffer, xReturn );
+
+		return xReturn;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	size_t xStreamBufferMultiProducerReceive( StreamBufferHandle_t xStreamBuffer,
+											  void *pvRxData,
+											  size_t xBufferLengthBytes,
+											  TickType_t xTicksToWait )
+	{
+	StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+	size_t xReceivedLength;
+	TimeOut_t xTimeOut;
+
+		configASSERT( pvRxData );
+		configASSERT( pxStreamBuffer );
+		configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 );
+
+		if( xTicksToWait != ( TickType_t ) 0 )
+		{
+			vTaskSetTimeOutState( &xTimeOut );
+
+			/* A writer that was preempted between reserving and committing
+			its record holds back the messages committed after it, so the
+			reader can be woken while the next message is still being written,
+			in which case it waits again for the rest of the block time. */
+			do
+			{
+				/* Checking if there is a message and clearing the notification
+				state must be performed atomically. */
+				taskENTER_CRITICAL();
+				{
+					if( prvNextRecord( pxStreamBuffer ) == NULL )
+					{
+						/* Clear notification state as going to wait for data. */
+						( void ) xTaskNotifyStateClear( NULL );
+
+						/* Should only be one reader. */
+						configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+						pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+					}
+					else
+					{
+						taskEXIT_CRITICAL();
+						break;
+					}
+				}
+				taskEXIT_CRITICAL();
+
+				traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( xStreamBuffer );
+				taskPROFILE_WAIT_OBJECT( pxStreamBuffer );
+				( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+				pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+			} while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xReceivedLength = prvReadRecordFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes );
+
+		/* The writers never block, so there is no writer to unblock. */
+		if( xReceivedLength != ( size_t ) 0 )
+		{
+			traceSTREAM_BUFFER_RECEIVE( xStreamBuffer, xReceivedLength );
+		}
+		else
+		{
+			traceSTREAM_BUFFER_RECEIVE_FAILED( xStreamBuffer );
+		}
+
+		return xReceivedLength;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	size_t xStreamBufferMultiProducerReceiveFromISR( StreamBufferHandle_t xStreamBuffer,
+													 void *pvRxData,
+													 size_t xBufferLengthBytes,
+													 BaseType_t * const pxHigherPriorityTaskWoken )
+	{
+	StreamBuffer_t * const pxStreamBuffer = xStreamBuffer;
+	size_t xReceivedLength;
+
+		configASSERT( pvRxData );
+		configASSERT( pxStreamBuffer );
+		configASSERT( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 );
+
+		/* The writers never block, so reading never unblocks a task. */
+		( void ) pxHigherPriorityTaskWoken;
+
+		xReceivedLength = prvReadRecordFromBuffer( pxStreamBuffer, pvRxData, xBufferLengthBytes );
+
+		traceSTREAM_BUFFER_RECEIVE_FROM_ISR( xStreamBuffer, xReceivedLength );
+
+		return xReceivedLength;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+static size_t prvWriteBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, const uint8_t *pucData, size_t xCount )
+{
+size_t xNextHead, xFirstLength;
+
+	configASSERT( xCount > ( size_t ) 0 );
+
+	xNextHead = pxStreamBuffer->xHead;
+
+	/* Calculate the number of bytes that can be added in the first write -
+	which may be less than the total number of bytes that need to be added if
+	the buffer will wrap back to the beginning. */
+	xFirstLength = configMIN( pxStreamBuffer->xLength - xNextHead, xCount );
+
+	/* Write as many bytes as can be written in the first write. */
+	configASSERT( ( xNextHead + xFirstLength ) <= pxStreamBuffer->xLength );
+	( void ) memcpy( ( void* ) ( &( pxStreamBuffer->pucBuffer[ xNextHead ] ) ), ( const void * ) pucData, xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+
+	/* If the number of bytes written was less than the number that could be
+	written in the first write... */
+	if( xCount > xFirstLength )
+	{
+		/* ...then write the remaining bytes to the start of the buffer. */
+		configASSERT( ( xCount - xFirstLength ) <= pxStreamBuffer->xLength );
+		( void ) memcpy( ( void * ) pxStreamBuffer->pucBuffer, ( const void * ) &( pucData[ xFirstLength ] ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	xNextHead += xCount;
+	if( xNextHead >= pxStreamBuffer->xLength )
+	{
+		xNextHead -= pxStreamBuffer->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	pxStreamBuffer->xHead = xNextHead;
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReadBytesFromBuffer( StreamBuffer_t *pxStreamBuffer, uint8_t *pucData, size_t xMaxCount, size_t xBytesAvailable )
+{
+size_t xCount, xFirstLength, xNextTail;
+
+	/* Use the minimum of the wanted bytes and the available bytes. */
+	xCount = configMIN( xBytesAvailable, xMaxCount );
+
+	if( xCount > ( size_t ) 0 )
+	{
+		xNextTail = pxStreamBuffer->xTail;
+
+		/* Calculate the number of bytes that can be read - which may be
+		less than the number wanted if the data wraps around to the start of
+		the buffer. */
+		xFirstLength = configMIN( pxStreamBuffer->xLength - xNextTail, xCount );
+
+		/* Obtain the number of bytes it is possible to obtain in the first
+		read.  Asserts check bounds of read and write. */
+		configASSERT( xFirstLength <= xMaxCount );
+		configASSERT( ( xNextTail + xFirstLength ) <= pxStreamBuffer->xLength );
+		( void ) memcpy( ( void * ) pucData, ( const void * ) &( pxStreamBuffer->pucBuffer[ xNextTail ] ), xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+
+		/* If the total number of wanted bytes is greater than the number
+		that could be read in the first read... */
+		if( xCount > xFirstLength )
+		{
+			/*...then read the remaining bytes from the start of the buffer. */
+			configASSERT( xCount <= xMaxCount );
+			( void ) memcpy( ( void * ) &( pucData[ xFirstLength ] ), ( void * ) ( pxStreamBuffer->pucBuffer ), xCount - xFirstLength ); /*lint !e9087 memcpy() requires void *. */
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		/* Move the tail pointer to effectively remove the data read from
+		the buffer. */
+		xNextTail += xCount;
+
+		if( xNextTail >= pxStreamBuffer->xLength )
+		{
+			xNextTail -= pxStreamBuffer->xLength;
+		}
+
+		pxStreamBuffer->xTail = xNextTail;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvBytesInBuffer( const StreamBuffer_t * const pxStreamBuffer )
+{
+/* Returns the distance between xTail and xHead. */
+size_t xCount;
+
+	xCount = pxStreamBuffer->xLength + pxStreamBuffer->xHead;
+	xCount -= pxStreamBuffer->xTail;
+	if ( xCount >= pxStreamBuffer->xLength )
+	{
+		xCount -= pxStreamBuffer->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xCount;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvRequiredSpace( const StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes )
+{
+size_t xRequiredSpace = xDataLengthBytes;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+	{
+		xRequiredSpace += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+
+		/* Overflow? */
+		configASSERT( xRequiredSpace > xDataLengthBytes );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	return xRequiredSpace;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWaitForSpace( StreamBuffer_t * const pxStreamBuffer, size_t xRequiredSpace, TickType_t xTicksToWait )
+{
+size_t xSpace = 0;
+TimeOut_t xTimeOut;
+
+	/* As in xStreamBufferSend(). */
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		vTaskSetTimeOutState( &xTimeOut );
+
+		do
+		{
+			taskENTER_CRITICAL();
+			{
+				xSpace = xStreamBufferSpacesAvailable( pxStreamBuffer );
+
+				if( xSpace < xRequiredSpace )
+				{
+					/* Clear notification state as going to wait for space. */
+					( void ) xTaskNotifyStateClear( NULL );
+
+					/* Should only be one writer. */
+					configASSERT( pxStreamBuffer->xTaskWaitingToSend == NULL );
+					pxStreamBuffer->xTaskWaitingToSend = xTaskGetCurrentTaskHandle();
+				}
+				else
+				{
+					taskEXIT_CRITICAL();
+					break;
+				}
+			}
+			taskEXIT_CRITICAL();
+
+			traceBLOCKING_ON_STREAM_BUFFER_SEND( pxStreamBuffer );
+			taskPROFILE_WAIT_OBJECT( pxStreamBuffer );
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToSend = NULL;
+
+		} while( xTaskCheckForTimeOut( &xTimeOut, &xTicksToWait ) == pdFALSE );
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	/* The space may have grown since it was last checked. */
+	return xStreamBufferSpacesAvailable( pxStreamBuffer );
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvWaitForData( StreamBuffer_t * const pxStreamBuffer, TickType_t xTicksToWait )
+{
+size_t xBytesAvailable, xBytesToStoreMessageLength;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+	{
+		xBytesToStoreMessageLength = sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xBytesToStoreMessageLength = 0;
+	}
+
+	/* As in xStreamBufferReceive(). */
+	if( xTicksToWait != ( TickType_t ) 0 )
+	{
+		/* Checking if there is data and clearing the notification state must be
+		performed atomically. */
+		taskENTER_CRITICAL();
+		{
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+
+			if( xBytesAvailable <= xBytesToStoreMessageLength )
+			{
+				/* Clear notification state as going to wait for data. */
+				( void ) xTaskNotifyStateClear( NULL );
+
+				/* Should only be one reader. */
+				configASSERT( pxStreamBuffer->xTaskWaitingToReceive == NULL );
+				pxStreamBuffer->xTaskWaitingToReceive = xTaskGetCurrentTaskHandle();
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		taskEXIT_CRITICAL();
+
+		if( xBytesAvailable <= xBytesToStoreMessageLength )
+		{
+			/* Wait for data to be available. */
+			traceBLOCKING_ON_STREAM_BUFFER_RECEIVE( pxStreamBuffer );
+			taskPROFILE_WAIT_OBJECT( pxStreamBuffer );
+			( void ) xTaskNotifyWait( ( uint32_t ) 0, ( uint32_t ) 0, NULL, xTicksToWait );
+			pxStreamBuffer->xTaskWaitingToReceive = NULL;
+
+			/* Recheck the data available after blocking. */
+			xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	else
+	{
+		xBytesAvailable = prvBytesInBuffer( pxStreamBuffer );
+	}
+
+	return xBytesAvailable;
+}
+/*-----------------------------------------------------------*/
+
+static void prvFillRegion( const StreamBuffer_t * const pxStreamBuffer, size_t xStart, size_t xCount, StreamBufferRegion_t * const pxRegion )
+{
+	if( xStart >= pxStreamBuffer->xLength )
+	{
+		xStart -= pxStreamBuffer->xLength;
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+
+	/* The region wraps back to the start of the storage area if it does not
+	fit before its end. */
+	pxRegion->pucFirst = &( pxStreamBuffer->pucBuffer[ xStart ] );
+	pxRegion->xFirstLengthBytes = configMIN( pxStreamBuffer->xLength - xStart, xCount );
+	pxRegion->xSecondLengthBytes = xCount - pxRegion->xFirstLengthBytes;
+
+	if( pxRegion->xSecondLengthBytes > ( size_t ) 0 )
+	{
+		pxRegion->pucSecond = pxStreamBuffer->pucBuffer;
+	}
+	else
+	{
+		pxRegion->pucSecond = NULL;
+	}
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvGetFreeRegion( const StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes, size_t xSpace, StreamBufferRegion_t * const pxRegion )
+{
+size_t xReturn, xStart = pxStreamBuffer->xHead;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 )
+	{
+		/* A stream buffer hands out as much of the wanted space as is free. */
+		xReturn = configMIN( xDataLengthBytes, xSpace );
+	}
+	else if( ( xDataLengthBytes > ( size_t ) 0 ) && ( xSpace >= prvRequiredSpace( pxStreamBuffer, xDataLengthBytes ) ) )
+	{
+		/* A message buffer hands out space for the whole message, after the
+		bytes the length of the message is written to on commit. */
+		xStart += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		xReturn = xDataLengthBytes;
+	}
+	else
+	{
+		xReturn = 0;
+	}
+
+	prvFillRegion( pxStreamBuffer, xStart, xReturn, pxRegion );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvGetDataRegion( const StreamBuffer_t * const pxStreamBuffer, size_t xBytesAvailable, StreamBufferRegion_t * const pxRegion )
+{
+size_t xReturn, xStart = pxStreamBuffer->xTail;
+
+	if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) == ( uint8_t ) 0 )
+	{
+		/* A stream buffer hands out all the bytes available. */
+		xReturn = xBytesAvailable;
+	}
+	else if( xBytesAvailable > sbBYTES_TO_STORE_MESSAGE_LENGTH )
+	{
+		/* A message buffer hands out the next message, which follows its
+		length. */
+		xReturn = xStreamBufferNextMessageLengthBytes( ( StreamBufferHandle_t ) pxStreamBuffer ); /*lint !e9087 The handle is the structure. */
+		xStart += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+	}
+	else
+	{
+		xReturn = 0;
+	}
+
+	prvFillRegion( pxStreamBuffer, xStart, xReturn, pxRegion );
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvCommitBytesToBuffer( StreamBuffer_t * const pxStreamBuffer, size_t xBytesWritten )
+{
+size_t xNextHead;
+configMESSAGE_BUFFER_LENGTH_TYPE xMessageLength;
+
+	if( xBytesWritten == ( size_t ) 0 )
+	{
+		/* Nothing to commit. */
+		mtCOVERAGE_TEST_MARKER();
+	}
+	else
+	{
+		/* The data is already in place, after the length of the message in
+		the case of a message buffer, so only the length and the head need
+		to be written.  The space must have been acquired first. */
+		configASSERT( xStreamBufferSpacesAvailable( pxStreamBuffer ) >= prvRequiredSpace( pxStreamBuffer, xBytesWritten ) );
+
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			xMessageLength = ( configMESSAGE_BUFFER_LENGTH_TYPE ) xBytesWritten;
+			configASSERT( ( size_t ) xMessageLength == xBytesWritten );
+			( void ) prvWriteBytesToBuffer( pxStreamBuffer, ( const uint8_t * ) &xMessageLength, sbBYTES_TO_STORE_MESSAGE_LENGTH );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		xNextHead = pxStreamBuffer->xHead + xBytesWritten;
+
+		if( xNextHead >= pxStreamBuffer->xLength )
+		{
+			xNextHead -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxStreamBuffer->xHead = xNextHead;
+	}
+
+	return xBytesWritten;
+}
+/*-----------------------------------------------------------*/
+
+static size_t prvReleaseBytesFromBuffer( StreamBuffer_t * const pxStreamBuffer, size_t xBytesConsumed )
+{
+size_t xNextTail, xBytesToRemove = xBytesConsumed;
+
+	if( xBytesConsumed == ( size_t ) 0 )
+	{
+		/* Nothing to release. */
+		mtCOVERAGE_TEST_MARKER();
+	}
+	else
+	{
+		if( ( pxStreamBuffer->ucFlags & sbFLAGS_IS_MESSAGE_BUFFER ) != ( uint8_t ) 0 )
+		{
+			/* A message is always removed whole, together with its length. */
+			configASSERT( xBytesConsumed == xStreamBufferNextMessageLengthBytes( ( StreamBufferHandle_t ) pxStreamBuffer ) ); /*lint !e9087 The handle is the structure. */
+			xBytesToRemove += sbBYTES_TO_STORE_MESSAGE_LENGTH;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		configASSERT( xBytesToRemove <= prvBytesInBuffer( pxStreamBuffer ) );
+
+		xNextTail = pxStreamBuffer->xTail + xBytesToRemove;
+
+		if( xNextTail >= pxStreamBuffer->xLength )
+		{
+			xNextTail -= pxStreamBuffer->xLength;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxStreamBuffer->xTail = xNextTail;
+	}
+
+	return xBytesConsumed;
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	static uint32_t prvRecordBytesInUse( const StreamBuffer_t * const pxStreamBuffer )
+	{
+	const uint32_t ulReadIndex = pxStreamBuffer->ulReadIndex;
+
+		/* The read index is read first, as it never passes the reserve
+		index. */
+		return pxStreamBuffer->ulReserveIndex - ulReadIndex;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	static MessageRecord_t *prvReserveRecord( StreamBuffer_t * const pxStreamBuffer, size_t xDataLengthBytes )
+	{
+	MessageRecord_t *pxRecord = NULL, *pxPadding;
+	const uint32_t ulLength = ( uint32_t ) pxStreamBuffer->xLength;
+	const uint32_t ulRecordSize = ( uint32_t ) sbRECORD_SIZE( xDataLengthBytes );
+	uint32_t ulReserveIndex, ulReadIndex, ulOffset, ulInUse, ulRequiredSpace, ulNextIndex;
+
+		for( ;; )
+		{
+			/* The read index is read first, as it never passes the reserve
+			index, so the space in use is never under estimated. */
+			ulReadIndex = pxStreamBuffer->ulReadIndex;
+			ulReserveIndex = pxStreamBuffer->ulReserveIndex;
+			ulOffset = sbRECORD_OFFSET( pxStreamBuffer, ulReserveIndex );
+			ulInUse = ulReserveIndex - ulReadIndex;
+
+			/* A record is never split, so one that does not fit before the end
+			of the storage area is preceded by padding up to the end. */
+			ulRequiredSpace = ulRecordSize;
+
+			if( ( ulOffset + ulRecordSize ) > ulLength )
+			{
+				ulRequiredSpace += ulLength - ulOffset;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( ( ulInUse + ulRequiredSpace ) > ulLength )
+			{
+				/* There is not enough space.  Writers never wait for space, as
+				a stream buffer only records one task waiting to send. */
+				break;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			ulNextIndex = ulReserveIndex + ulRequiredSpace;
+
+			/* Another writer that reserved a record since the indexes were read
+			makes the compare and swap fail, in which case try again.  The
+			indexes are free running, so a writer preempted for less than 2^32
+			bytes of reservations never sees the reserve index it read again. */
+			if( Atomic_CompareAndSwap_u32( &( pxStreamBuffer->ulReserveIndex ), ulNextIndex, ulReserveIndex ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+			{
+				if( ulRequiredSpace != ulRecordSize )
+				{
+					pxPadding = ( MessageRecord_t * ) &( pxStreamBuffer->pucBuffer[ ulOffset ] ); /*lint !e9087 !e826 Records are aligned to the record header size. */
+					pxPadding->ulLength = ulLength - ulOffset - ( uint32_t ) sizeof( MessageRecord_t );
+					( void ) Atomic_OR_u32( &( pxPadding->ulState ), sbRECORD_PADDING );
+					ulOffset = 0;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				pxRecord = ( MessageRecord_t * ) &( pxStreamBuffer->pucBuffer[ ulOffset ] ); /*lint !e9087 !e826 Records are aligned to the record header size. */
+				break;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		return pxRecord;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	static size_t prvWriteRecordToBuffer( StreamBuffer_t * const pxStreamBuffer, const void *pvTxData, size_t xDataLengthBytes )
+	{
+	MessageRecord_t *pxRecord;
+	size_t xReturn = 0;
+
+		if( ( xDataLengthBytes > ( size_t ) 0 ) && ( xDataLengthBytes < pxStreamBuffer->xLength ) )
+		{
+			pxRecord = prvReserveRecord( pxStreamBuffer, xDataLengthBytes );
+
+			if( pxRecord != NULL )
+			{
+				pxRecord->ulLength = ( uint32_t ) xDataLengthBytes;
+				( void ) memcpy( ( void * ) &( pxRecord[ 1 ] ), pvTxData, xDataLengthBytes ); /*lint !e9087 The message follows the record header. */
+
+				/* The atomic operation orders the writes above before the
+				record is seen as committed by the reader. */
+				( void ) Atomic_OR_u32( &( pxRecord->ulState ), sbRECORD_COMMITTED );
+				xReturn = xDataLengthBytes;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	static MessageRecord_t *prvNextRecord( StreamBuffer_t * const pxStreamBuffer )
+	{
+	MessageRecord_t *pxRecord = NULL;
+	uint32_t ulReadIndex, ulOffset;
+
+		for( ;; )
+		{
+			ulReadIndex = pxStreamBuffer->ulReadIndex;
+
+			if( ulReadIndex == pxStreamBuffer->ulReserveIndex )
+			{
+				/* No records are reserved. */
+				pxRecord = NULL;
+				break;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			ulOffset = sbRECORD_OFFSET( pxStreamBuffer, ulReadIndex );
+			pxRecord = ( MessageRecord_t * ) &( pxStreamBuffer->pucBuffer[ ulOffset ] ); /*lint !e9087 !e826 Records are aligned to the record header size. */
+
+			if( pxRecord->ulState == sbRECORD_PADDING )
+			{
+				prvReleaseRecord( pxStreamBuffer, pxRecord );
+			}
+			else
+			{
+				if( pxRecord->ulState != sbRECORD_COMMITTED )
+				{
+					/* The record is still being written.  Its writer notifies
+					the reader once it is committed. */
+					pxRecord = NULL;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				break;
+			}
+		}
+
+		return pxRecord;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	static void prvReleaseRecord( StreamBuffer_t * const pxStreamBuffer, MessageRecord_t * const pxRecord )
+	{
+	const uint32_t ulRecordSize = ( uint32_t ) sbRECORD_SIZE( pxRecord->ulLength );
+	const uint32_t ulReadIndex = pxStreamBuffer->ulReadIndex;
+	const uint32_t ulNextIndex = ulReadIndex + ulRecordSize;
+
+		/* Clear the whole record, so stale bytes are never mistaken for the
+		header of a later record, before handing it back to the writers.  The
+		compare and swap orders the clearing before the release, and cannot
+		fail as there is only one reader. */
+		( void ) memset( ( void * ) pxRecord, 0x00, ( size_t ) ulRecordSize );
+		( void ) Atomic_CompareAndSwap_u32( &( pxStreamBuffer->ulReadIndex ), ulNextIndex, ulReadIndex );
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+
+	static size_t prvReadRecordFromBuffer( StreamBuffer_t * const pxStreamBuffer, void *pvRxData, size_t xBufferLengthBytes )
+	{
+	MessageRecord_t * const pxRecord = prvNextRecord( pxStreamBuffer );
+	size_t xReceivedLength = 0;
+
+		if( pxRecord != NULL )
+		{
+			/* The message is left in the buffer if the user has provided
+			insufficient space to read it. */
+			if( ( size_t ) pxRecord->ulLength <= xBufferLengthBytes )
+			{
+				xReceivedLength = ( size_t ) pxRecord->ulLength;
+				( void ) memcpy( pvRxData, ( const void * ) &( pxRecord[ 1 ] ), xReceivedLength ); /*lint !e9087 The message follows the record header. */
+				prvReleaseRecord( pxStreamBuffer, pxRecord );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReceivedLength;
+	}
+
+#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
+/*-----------------------------------------------------------*/
+
+static void prvInitialiseNewStreamBuffer( StreamBuffer_t * const pxStreamBuffer,
+										  uint8_t * const pucBuffer,
+										  size_t xBufferSizeBytes,
+										  size_t xTriggerLevelBytes,
+										  uint8_t ucFlags )
+{
+	/* Assert here is deliberately writing to the entire buffer to ensure it can
+	be written to without generating exceptions, and is setting the buffer to a
+	known value to assist in development/debugging. */
+	#if( configASSERT_DEFINED == 1 )
+	{
+		/* The value written just has to be identifiable when looking at the
+		memory.  Don't use 0xA5 as that is the stack fill value and could
+		result in confusion as to what is actually being observed. */
+		const BaseType_t xWriteValue = 0x55;
+		configASSERT( memset( pucBuffer, ( int ) xWriteValue, xBufferSizeBytes ) == pucBuffer );
+	} /*lint !e529 !e438 xWriteValue is only used if configASSERT() is defined. */
+	#endif
+
+	( void ) memset( ( void * ) pxStreamBuffer, 0x00, sizeof( StreamBuffer_t ) ); /*lint !e9087 memset() requires void *. */
+	pxStreamBuffer->pucBuffer = pucBuffer;
+	pxStreamBuffer->xLength = xBufferSizeBytes;
 	pxStreamBuffer->xTriggerLevelBytes = xTriggerLevelBytes;
 	pxStreamBuffer->ucFlags = ucFlags;
+
+	#if( configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS == 1 )
+	{
+		if( ( ucFlags & sbFLAGS_IS_MULTI_PRODUCER ) != ( uint8_t ) 0 )
+		{
+			/* The record indexes are free running and masked to give offsets,
+			so only the largest power of two bytes of the storage area is used,
+			which is also a multiple of the record header size.  A record is
+			not committed until its writer marks it as such, so the storage
+			area starts zeroed. */
+			pxStreamBuffer->xLength = sizeof( MessageRecord_t );
+
+			while( pxStreamBuffer->xLength <= ( xBufferSizeBytes / ( size_t ) 2 ) )
+			{
+				pxStreamBuffer->xLength *= ( size_t ) 2;
+			}
+
+			configASSERT( pxStreamBuffer->xLength <= ( size_t ) 0x7fffffffUL );
+			( void ) memset( ( void * ) pucBuffer, 0x00, pxStreamBuffer->xLength );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+	#endif /* configUSE_MULTI_PRODUCER_MESSAGE_BUFFERS */
 }
 
 #if ( configUSE_TRACE_FACILITY == 1 )
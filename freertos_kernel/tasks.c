@@ -211,12 +211,31 @@ count overflows. */
 
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	/* Values for the ucProfileState member of the TCB. */
+	#define taskPROFILE_RUNNING_OR_READY	( ( uint8_t ) 0 )
+	#define taskPROFILE_BLOCKED				( ( uint8_t ) 1 )
+	#define taskPROFILE_WOKEN				( ( uint8_t ) 2 )
+
+	/* Called each time a task is moved to a ready list, or to the pending ready
+	list, so the profiler can note the end of a blocked period. */
+	#define taskPROFILE_TASK_READIED( pxTCB ) prvProfileTaskReadied( pxTCB )
+
+#else
+
+	#define taskPROFILE_TASK_READIED( pxTCB )
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
 /*
  * Place the task represented by pxTCB into the appropriate ready list for
  * the task.  It is inserted at the end of the list.
  */
 #define prvAddTaskToReadyList( pxTCB )																\
 	traceMOVED_TASK_TO_READY_STATE( pxTCB );														\
+	taskPROFILE_TASK_READIED( pxTCB );																\
 	taskRECORD_READY_PRIORITY( ( pxTCB )->uxPriority );												\
 	vListInsertEnd( &( pxReadyTasksLists[ ( pxTCB )->uxPriority ] ), &( ( pxTCB )->xStateListItem ) ); \
 	tracePOST_MOVED_TASK_TO_READY_STATE( pxTCB )
@@ -323,6 +342,13 @@ typedef struct tskTaskControlBlock 			/* The old naming convention is used to pr
 		int iTaskErrno;
 	#endif
 
+	#if( configUSE_SCHEDULER_PROFILER == 1 )
+		TaskProfile_t	xProfile;				/*< Scheduling statistics, see vTaskGetProfile(). */
+		void			*pvProfileWaitObject;	/*< The object the task is blocking on, if any. */
+		uint32_t		ulProfileTimeStamp;		/*< Run time counter value when the task was last switched in, blocked or woken. */
+		uint8_t			ucProfileState;			/*< One of the taskPROFILE_ values. */
+	#endif
+
 } tskTCB;
 
 /* The old tskTCB name is maintained above then typedefed to the new TCB_t name
@@ -541,6 +567,37 @@ static void prvResetNextTaskUnblockTime( void );
 
 #endif
 
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	/*
+	 * pxTCB is leaving the Blocked or Suspended state.  Record how long it was
+	 * blocked and note the time, so its wake latency can be recorded when it
+	 * next runs.
+	 */
+	static void prvProfileTaskReadied( TCB_t * const pxTCB ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Called by vTaskSwitchContext() when the Running task changes from
+	 * pxPreviousTCB to pxCurrentTCB at time ulTimeNow.
+	 */
+	static void prvProfileTaskSwitched( TCB_t * const pxPreviousTCB, const uint32_t ulTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Add ulValue to a profiler histogram.
+	 */
+	static void prvProfileRecord( TaskProfileHistogram_t * const pxHistogram, const uint32_t ulValue ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Write ulValue, or the pointer pv, or the histogram pxHistogram, to
+	 * pucBuffer least significant byte first, and return the address after the
+	 * last byte written.  Used by xTaskSerialiseProfile().
+	 */
+	static uint8_t *prvProfileWriteValue( uint8_t *pucBuffer, uint32_t ulValue ) PRIVILEGED_FUNCTION;
+	static uint8_t *prvProfileWritePointer( uint8_t *pucBuffer, const void * const pv ) PRIVILEGED_FUNCTION;
+	static uint8_t *prvProfileWriteHistogram( uint8_t *pucBuffer, const TaskProfileHistogram_t * const pxHistogram ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+
 /*
  * Called after a Task_t structure has been allocated either statically or
  * dynamically to fill in the structure's members.
@@ -964,6 +1021,15 @@ UBaseType_t x;
 	}
 	#endif /* configGENERATE_RUN_TIME_STATS */
 
+	#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	{
+		( void ) memset( &( pxNewTCB->xProfile ), 0x00, sizeof( TaskProfile_t ) );
+		pxNewTCB->pvProfileWaitObject = NULL;
+		pxNewTCB->ulProfileTimeStamp = 0UL;
+		pxNewTCB->ucProfileState = taskPROFILE_RUNNING_OR_READY;
+	}
+	#endif /* configUSE_SCHEDULER_PROFILER */
+
 	#if ( portUSING_MPU_WRAPPERS == 1 )
 	{
 		vPortStoreTaskMPUSettings( &( pxNewTCB->xMPUSettings ), xRegions, pxNewTCB->pxStack, ulStackDepth );
@@ -2553,6 +2619,341 @@ TCB_t *pxTCB;
 #endif /* configUSE_TRACE_FACILITY */
 /*----------------------------------------------------------*/
 
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	void vTaskGetProfile( TaskHandle_t xTask, TaskProfile_t *pxProfile )
+	{
+	TCB_t *pxTCB;
+
+		configASSERT( pxProfile );
+
+		/* If null is passed in here then the profile of the calling task is
+		being queried. */
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		/* The profile is updated from interrupts when a task is readied. */
+		taskENTER_CRITICAL();
+		{
+			*pxProfile = pxTCB->xProfile;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	void vTaskResetProfile( TaskHandle_t xTask )
+	{
+	TCB_t *pxTCB;
+
+		pxTCB = prvGetTCBFromHandle( xTask );
+
+		/* Only the statistics are cleared.  The task's current state is
+		kept so a wake or run slice already in progress is still recorded. */
+		taskENTER_CRITICAL();
+		{
+			( void ) memset( &( pxTCB->xProfile ), 0x00, sizeof( TaskProfile_t ) );
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	size_t xTaskSerialiseProfile( TaskHandle_t xTask, uint8_t *pucBuffer, size_t xBufferLength )
+	{
+	TCB_t *pxTCB;
+	TaskProfile_t xProfile;
+	uint8_t *pucNext = pucBuffer;
+	UBaseType_t uxPriority, x;
+	uint32_t ulRunTimeCounter;
+	const TaskProfileWait_t *pxWait;
+	size_t xReturn = 0;
+
+		configASSERT( pucBuffer );
+
+		if( xBufferLength >= ( size_t ) taskPROFILE_SERIALISED_SIZE )
+		{
+			pxTCB = prvGetTCBFromHandle( xTask );
+
+			/* Take a consistent copy of everything that is written. */
+			taskENTER_CRITICAL();
+			{
+				xProfile = pxTCB->xProfile;
+				uxPriority = pxTCB->uxPriority;
+				ulRunTimeCounter = pxTCB->ulRunTimeCounter;
+			}
+			taskEXIT_CRITICAL();
+
+			/* The header describes the dimensions of the record, so records
+			from differently configured builds can be decoded.  See
+			xTaskSerialiseProfile() in task.h for the layout. */
+			*pucNext = ( uint8_t ) taskPROFILE_SERIALISED_VERSION;
+			pucNext++;
+			*pucNext = ( uint8_t ) configPROFILER_HISTOGRAM_BUCKETS;
+			pucNext++;
+			*pucNext = ( uint8_t ) configPROFILER_WAIT_OBJECTS;
+			pucNext++;
+			*pucNext = ( uint8_t ) sizeof( portPOINTER_SIZE_TYPE );
+			pucNext++;
+			*pucNext = ( uint8_t ) configMAX_TASK_NAME_LEN;
+			pucNext++;
+
+			for( x = ( UBaseType_t ) 0; x < ( UBaseType_t ) configMAX_TASK_NAME_LEN; x++ )
+			{
+				*pucNext = ( uint8_t ) pxTCB->pcTaskName[ x ];
+				pucNext++;
+			}
+
+			#if ( configUSE_TRACE_FACILITY == 1 )
+			{
+				pucNext = prvProfileWriteValue( pucNext, ( uint32_t ) pxTCB->uxTCBNumber );
+			}
+			#else
+			{
+				pucNext = prvProfileWriteValue( pucNext, 0UL );
+			}
+			#endif
+			pucNext = prvProfileWriteValue( pucNext, ( uint32_t ) uxPriority );
+			pucNext = prvProfileWriteValue( pucNext, ulRunTimeCounter );
+			pucNext = prvProfileWriteValue( pucNext, xProfile.ulPreemptions );
+			pucNext = prvProfileWriteHistogram( pucNext, &( xProfile.xWakeLatency ) );
+			pucNext = prvProfileWriteHistogram( pucNext, &( xProfile.xRunSlice ) );
+
+			for( x = ( UBaseType_t ) 0; x <= ( UBaseType_t ) configPROFILER_WAIT_OBJECTS; x++ )
+			{
+				if( x < ( UBaseType_t ) configPROFILER_WAIT_OBJECTS )
+				{
+					pxWait = &( xProfile.xWaits[ x ] );
+				}
+				else
+				{
+					pxWait = &( xProfile.xOtherWaits );
+				}
+
+				pucNext = prvProfileWritePointer( pucNext, pxWait->pvObject );
+				pucNext = prvProfileWriteValue( pucNext, pxWait->ulCount );
+				pucNext = prvProfileWriteValue( pucNext, pxWait->ulTotalTime );
+				pucNext = prvProfileWriteValue( pucNext, pxWait->ulMaxTime );
+			}
+
+			xReturn = ( size_t ) ( pucNext - pucBuffer );
+			configASSERT( xReturn == ( size_t ) taskPROFILE_SERIALISED_SIZE );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		return xReturn;
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	void vTaskProfileSetWaitObject( void * const pvObject )
+	{
+		/* Only the running task writes this, just before it blocks. */
+		pxCurrentTCB->pvProfileWaitObject = pvObject;
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	static void prvProfileTaskReadied( TCB_t * const pxTCB )
+	{
+	uint32_t ulTimeNow, ulBlockedTime;
+	TaskProfileWait_t *pxWait = NULL;
+	UBaseType_t x;
+
+		/* A task is readied more than once per wake only if it is moved between
+		ready lists, for example by priority inheritance, or goes through the
+		pending ready list.  Only the first counts. */
+		if( pxTCB->ucProfileState == taskPROFILE_BLOCKED )
+		{
+			#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+				portALT_GET_RUN_TIME_COUNTER_VALUE( ulTimeNow );
+			#else
+				ulTimeNow = portGET_RUN_TIME_COUNTER_VALUE();
+			#endif
+
+			ulBlockedTime = ulTimeNow - pxTCB->ulProfileTimeStamp;
+
+			/* Find the object in the table, or the first free entry. */
+			if( pxTCB->pvProfileWaitObject != NULL )
+			{
+				for( x = ( UBaseType_t ) 0; x < ( UBaseType_t ) configPROFILER_WAIT_OBJECTS; x++ )
+				{
+					if( ( pxTCB->xProfile.xWaits[ x ].pvObject == pxTCB->pvProfileWaitObject ) || ( pxTCB->xProfile.xWaits[ x ].ulCount == 0UL ) )
+					{
+						pxWait = &( pxTCB->xProfile.xWaits[ x ] );
+						pxWait->pvObject = pxTCB->pvProfileWaitObject;
+						break;
+					}
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			if( pxWait == NULL )
+			{
+				pxWait = &( pxTCB->xProfile.xOtherWaits );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			( pxWait->ulCount )++;
+			pxWait->ulTotalTime += ulBlockedTime;
+
+			if( ulBlockedTime > pxWait->ulMaxTime )
+			{
+				pxWait->ulMaxTime = ulBlockedTime;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			pxTCB->pvProfileWaitObject = NULL;
+			pxTCB->ulProfileTimeStamp = ulTimeNow;
+			pxTCB->ucProfileState = taskPROFILE_WOKEN;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	static void prvProfileTaskSwitched( TCB_t * const pxPreviousTCB, const uint32_t ulTimeNow )
+	{
+		/* The run slice of the task being switched out has ended. */
+		prvProfileRecord( &( pxPreviousTCB->xProfile.xRunSlice ), ulTimeNow - pxPreviousTCB->ulProfileTimeStamp );
+
+		if( listIS_CONTAINED_WITHIN( &( pxReadyTasksLists[ pxPreviousTCB->uxPriority ] ), &( pxPreviousTCB->xStateListItem ) ) != pdFALSE )
+		{
+			/* Still Ready, so it was preempted (or yielded). */
+			( pxPreviousTCB->xProfile.ulPreemptions )++;
+			pxPreviousTCB->pvProfileWaitObject = NULL;
+		}
+		else
+		{
+			/* Blocked, suspended or deleted.  Any wait object set while the
+			task was still running is the one it is now blocked on. */
+			pxPreviousTCB->ulProfileTimeStamp = ulTimeNow;
+			pxPreviousTCB->ucProfileState = taskPROFILE_BLOCKED;
+		}
+
+		if( pxCurrentTCB->ucProfileState == taskPROFILE_WOKEN )
+		{
+			prvProfileRecord( &( pxCurrentTCB->xProfile.xWakeLatency ), ulTimeNow - pxCurrentTCB->ulProfileTimeStamp );
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		pxCurrentTCB->ulProfileTimeStamp = ulTimeNow;
+		pxCurrentTCB->ucProfileState = taskPROFILE_RUNNING_OR_READY;
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	static void prvProfileRecord( TaskProfileHistogram_t * const pxHistogram, const uint32_t ulValue )
+	{
+	UBaseType_t uxBucket = ( UBaseType_t ) 0;
+
+		while( ( uxBucket < ( UBaseType_t ) ( configPROFILER_HISTOGRAM_BUCKETS - 1 ) ) && ( ( ulValue >> uxBucket ) != 0UL ) )
+		{
+			uxBucket++;
+		}
+
+		( pxHistogram->ulBuckets[ uxBucket ] )++;
+		( pxHistogram->ulCount )++;
+
+		if( ulValue > pxHistogram->ulMax )
+		{
+			pxHistogram->ulMax = ulValue;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+	static uint8_t *prvProfileWriteValue( uint8_t *pucBuffer, uint32_t ulValue )
+	{
+	uint8_t x;
+
+		for( x = 0U; x < 4U; x++ )
+		{
+			*pucBuffer = ( uint8_t ) ( ulValue & 0xffUL );
+			pucBuffer++;
+			ulValue >>= 8U;
+		}
+
+		return pucBuffer;
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint8_t *prvProfileWritePointer( uint8_t *pucBuffer, const void * const pv )
+	{
+	portPOINTER_SIZE_TYPE xValue = ( portPOINTER_SIZE_TYPE ) pv;
+	uint8_t x;
+
+		for( x = 0U; x < ( uint8_t ) sizeof( portPOINTER_SIZE_TYPE ); x++ )
+		{
+			*pucBuffer = ( uint8_t ) ( xValue & ( portPOINTER_SIZE_TYPE ) 0xffU );
+			pucBuffer++;
+			xValue >>= 8U;
+		}
+
+		return pucBuffer;
+	}
+	/*-----------------------------------------------------------*/
+
+	static uint8_t *prvProfileWriteHistogram( uint8_t *pucBuffer, const TaskProfileHistogram_t * const pxHistogram )
+	{
+	UBaseType_t x;
+
+		pucBuffer = prvProfileWriteValue( pucBuffer, pxHistogram->ulCount );
+		pucBuffer = prvProfileWriteValue( pucBuffer, pxHistogram->ulMax );
+
+		for( x = ( UBaseType_t ) 0; x < ( UBaseType_t ) configPROFILER_HISTOGRAM_BUCKETS; x++ )
+		{
+			pucBuffer = prvProfileWriteValue( pucBuffer, pxHistogram->ulBuckets[ x ] );
+		}
+
+		return pucBuffer;
+	}
+
+#endif /* configUSE_SCHEDULER_PROFILER */
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
 
 	TaskHandle_t xTaskGetIdleTaskHandle( void )
@@ -2945,6 +3346,10 @@ BaseType_t xSwitchRequired = pdFALSE;
 
 void vTaskSwitchContext( void )
 {
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+	TCB_t * const pxPreviousTCB = pxCurrentTCB;
+#endif
+
 	if( uxSchedulerSuspended != ( UBaseType_t ) pdFALSE )
 	{
 		/* The scheduler is currently suspended - do not allow a context
@@ -2998,6 +3403,21 @@ void vTaskSwitchContext( void )
 		taskSELECT_HIGHEST_PRIORITY_TASK(); /*lint !e9079 void * is used as this macro is used with timers and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
 		traceTASK_SWITCHED_IN();
 
+		#if ( configUSE_SCHEDULER_PROFILER == 1 )
+		{
+			/* ulTotalRunTime was sampled above, as the profiler requires
+			configGENERATE_RUN_TIME_STATS. */
+			if( pxCurrentTCB != pxPreviousTCB )
+			{
+				prvProfileTaskSwitched( pxPreviousTCB, ulTotalRunTime );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_SCHEDULER_PROFILER */
+
 		/* After the new task is switched in, update the global errno. */
 		#if( configUSE_POSIX_ERRNO == 1 )
 		{
@@ -3134,8 +3554,10 @@ BaseType_t xReturn;
 	else
 	{
 		/* The delayed and ready lists cannot be accessed, so hold this task
-		pending until the scheduler is resumed. */
+		pending until the scheduler is resumed.  The task is woken now as far
+		as the profiler is concerned. */
 		vListInsertEnd( &( xPendingReadyList ), &( pxUnblockedTCB->xEventListItem ) );
+		taskPROFILE_TASK_READIED( pxUnblockedTCB );
 	}
 
 	if( pxUnblockedTCB->uxPriority > pxCurrentTCB->uxPriority )
@@ -4600,6 +5022,16 @@ TickType_t uxReturn;
 		taskENTER_CRITICAL();
 		{
 			traceTASK_NOTIFY_TAKE();
+
+			#if ( configUSE_SCHEDULER_PROFILER == 1 )
+			{
+				/* An object named through taskPROFILE_WAIT_OBJECT() has already
+				been accounted for if the task blocked, and must not be charged
+				for a later wait if it did not. */
+				pxCurrentTCB->pvProfileWaitObject = NULL;
+			}
+			#endif /* configUSE_SCHEDULER_PROFILER */
+
 			ulReturn = pxCurrentTCB->ulNotifiedValue;
 
 			if( ulReturn != 0UL )
@@ -4674,6 +5106,13 @@ TickType_t uxReturn;
 		{
 			traceTASK_NOTIFY_WAIT();
 
+			#if ( configUSE_SCHEDULER_PROFILER == 1 )
+			{
+				/* As in ulTaskNotifyTake(). */
+				pxCurrentTCB->pvProfileWaitObject = NULL;
+			}
+			#endif /* configUSE_SCHEDULER_PROFILER */
+
 			if( pulNotificationValue != NULL )
 			{
 				/* Output the current notification value, which may or may not
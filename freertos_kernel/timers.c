@@ -42,6 +42,14 @@ task.h is included from an application file. */
 	#error configUSE_TIMERS must be set to 1 to make the xTimerPendFunctionCall() function available.
 #endif
 
+#if ( configUSE_TIMER_DIRECT_COMMANDS == 1 ) && ( configUSE_TIMER_WHEEL == 0 )
+	#error configUSE_TIMER_WHEEL must be set to 1 to make configUSE_TIMER_DIRECT_COMMANDS available.
+#endif
+
+#if ( configUSE_TIMER_WHEEL == 1 ) && ( ( configTIMER_WHEEL_SLOT_BITS < 1 ) || ( configTIMER_WHEEL_SLOT_BITS > 5 ) )
+	#error configTIMER_WHEEL_SLOT_BITS must be between 1 and 5.
+#endif
+
 /* Lint e9021, e961 and e750 are suppressed as a MISRA exception justified
 because the MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined
 for the header files above, but not in this file, in order to generate the
@@ -69,6 +77,24 @@ defining trmTIMER_SERVICE_TASK_NAME in FreeRTOSConfig.h. */
 #define tmrSTATUS_IS_STATICALLY_ALLOCATED	( ( uint8_t ) 0x02 )
 #define tmrSTATUS_IS_AUTORELOAD				( ( uint8_t ) 0x04 )
 
+#if( configUSE_TIMER_WHEEL == 1 )
+	/* Dimensions of the timing wheel.  Each level holds tmrWHEEL_SLOTS lists,
+	each level covers tmrWHEEL_SLOT_BITS bits of the tick count, and there are
+	enough levels to cover every bit of TickType_t. */
+	#define tmrTICK_BITS				( sizeof( TickType_t ) * ( size_t ) 8 )
+	#define tmrWHEEL_SLOT_BITS			( ( UBaseType_t ) configTIMER_WHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOTS				( ( UBaseType_t ) 1 << tmrWHEEL_SLOT_BITS )
+	#define tmrWHEEL_SLOT_INDEX_MASK	( tmrWHEEL_SLOTS - ( UBaseType_t ) 1 )
+	#define tmrWHEEL_OCCUPIED_MASK		( 0xffffffffUL >> ( 32U - tmrWHEEL_SLOTS ) )
+	#define tmrWHEEL_LEVELS				( ( tmrTICK_BITS + configTIMER_WHEEL_SLOT_BITS - 1 ) / configTIMER_WHEEL_SLOT_BITS )
+
+	/* The slot within level uxLevel that xTime falls into. */
+	#define tmrWHEEL_SLOT_OF( xTime, uxLevel ) ( ( UBaseType_t ) ( ( xTime ) >> ( ( uxLevel ) * tmrWHEEL_SLOT_BITS ) ) & tmrWHEEL_SLOT_INDEX_MASK )
+
+	/* The level of the wheel that contains the list pxList. */
+	#define tmrWHEEL_LEVEL_OF( pxList ) ( ( UBaseType_t ) ( ( pxList ) - &( xTimerWheel[ 0 ][ 0 ] ) ) / tmrWHEEL_SLOTS )
+#endif
+
 /* The definition of the timers themselves. */
 typedef struct tmrTimerControl /* The old naming convention is used to prevent breaking kernel aware debuggers. */
 {
@@ -126,6 +152,8 @@ typedef struct tmrTimerQueueMessage
 /*lint -save -e956 A manual analysis and inspection has been used to determine
 which static variables must be declared volatile. */
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 /* The list in which active timers are stored.  Timers are referenced in expire
 time order, with the nearest expiry time at the front of the list.  Only the
 timer service task is allowed to access these lists.
@@ -137,6 +165,38 @@ PRIVILEGED_DATA static List_t xActiveTimerList2;
 PRIVILEGED_DATA static List_t *pxCurrentTimerList;
 PRIVILEGED_DATA static List_t *pxOverflowTimerList;
 
+#endif /* configUSE_TIMER_WHEEL */
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/* The timing wheel in which active timers are stored.  A timer is held in
+	the lowest level at which its expiry time shares all higher slot indexes
+	with xWheelTime, in the slot given by its expiry time at that level.  The
+	lists are not sorted.  When xWheelTime reaches the start of a slot above
+	level 0 the timers in that slot are moved down to a lower level; when it
+	reaches a slot in level 0 the timers in that slot expire.  Bit n of
+	ulWheelOccupied[ x ] is set when xTimerWheel[ x ][ n ] is not empty.  Only
+	the timer service task (or a task holding the scheduler suspended while
+	the timer service task is blocked) is allowed to access the wheel. */
+	PRIVILEGED_DATA static List_t xTimerWheel[ tmrWHEEL_LEVELS ][ tmrWHEEL_SLOTS ];
+	PRIVILEGED_DATA static uint32_t ulWheelOccupied[ tmrWHEEL_LEVELS ];
+	PRIVILEGED_DATA static TickType_t xWheelTime = ( TickType_t ) 0U;
+
+	/* The slot found by prvGetNextExpireTime(). */
+	PRIVILEGED_DATA static List_t *pxCurrentTimerList;
+
+#endif /* configUSE_TIMER_WHEEL */
+
+#if( configUSE_TIMER_DIRECT_COMMANDS == 1 )
+
+	/* Set while the timer service task is blocked waiting for xDaemonWakeTime
+	or a command - the only time another task may access the timing wheel. */
+	PRIVILEGED_DATA static volatile BaseType_t xDaemonIsWaiting = pdFALSE;
+	PRIVILEGED_DATA static TickType_t xDaemonWakeTime = ( TickType_t ) 0U;
+	PRIVILEGED_DATA static BaseType_t xDaemonWaitsIndefinitely = pdTRUE;
+
+#endif /* configUSE_TIMER_DIRECT_COMMANDS */
+
 /* A queue that is used to send commands to the timer service task. */
 PRIVILEGED_DATA static QueueHandle_t xTimerQueue = NULL;
 PRIVILEGED_DATA static TaskHandle_t xTimerTaskHandle = NULL;
@@ -180,18 +240,74 @@ static void prvProcessReceivedCommands( void ) PRIVILEGED_FUNCTION;
  */
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime ) PRIVILEGED_FUNCTION;
 
+/*
+ * Remove the timer from the active timer list or timing wheel slot that
+ * references it, if any.
+ */
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
 /*
  * An active timer has reached its expire time.  Reload the timer if it is an
  * auto reload timer, then call its callback.
  */
 static void prvProcessExpiredTimer( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 /*
  * The tick count has overflowed.  Switch the timer lists after ensuring the
  * current timer list does not still reference some timers.
  */
 static void prvSwitchTimerLists( void ) PRIVILEGED_FUNCTION;
 
+#endif /* configUSE_TIMER_WHEEL */
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	/*
+	 * Initialise the lists of the timing wheel, leaving every slot empty.
+	 */
+	static void prvInitialiseTimerWheel( void ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * The timing wheel has reached the slot pxCurrentTimerList, found by
+	 * prvGetNextExpireTime().  Process the timers that expire in a level 0
+	 * slot, or move the timers in a higher slot down the wheel.
+	 */
+	static void prvAdvanceTimerWheel( const TickType_t xNextExpireTime, const TickType_t xTimeNow ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Place the timer in the timing wheel slot that matches the expiry time held
+	 * in its list item, relative to xWheelTime.
+	 */
+	static void prvPlaceTimerInWheel( Timer_t * const pxTimer ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * xWheelTime has reached the start of the slot pxList, which is above level
+	 * 0.  Move each timer in the slot down to a lower level.
+	 */
+	static void prvCascadeWheelSlot( List_t * const pxList ) PRIVILEGED_FUNCTION;
+
+	/*
+	 * Return the index of the first bit set in ulOccupied, searching upwards
+	 * from bit uxStart and wrapping round to bit 0.  ulOccupied must not be 0.
+	 */
+	static UBaseType_t prvFirstOccupiedSlot( const uint32_t ulOccupied, const UBaseType_t uxStart ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_WHEEL */
+
+#if( configUSE_TIMER_DIRECT_COMMANDS == 1 )
+
+	/*
+	 * Called by xTimerGenericCommand() to apply a command sent from a task
+	 * directly to the timing wheel, rather than posting it to the timer queue.
+	 * Returns pdFAIL, having changed nothing, if the command must be posted to
+	 * the timer queue instead.
+	 */
+	static BaseType_t prvExecuteCommandDirectly( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue ) PRIVILEGED_FUNCTION;
+
+#endif /* configUSE_TIMER_DIRECT_COMMANDS */
+
 /*
  * Obtain the current tick count, setting *pxTimerListsWereSwitched to pdTRUE
  * if a tick count overflow occurred since prvSampleTimeNow() was last called.
@@ -398,7 +514,22 @@ DaemonTaskMessage_t xMessage;
 		{
 			if( xTaskGetSchedulerState() == taskSCHEDULER_RUNNING )
 			{
-				xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				#if( configUSE_TIMER_DIRECT_COMMANDS == 1 )
+				{
+					/* Skip the timer queue if the command can be applied to
+					the timing wheel from this task. */
+					xReturn = prvExecuteCommandDirectly( xTimer, xCommandID, xOptionalValue );
+				}
+				#endif /* configUSE_TIMER_DIRECT_COMMANDS */
+
+				if( xReturn == pdFAIL )
+				{
+					xReturn = xQueueSendToBack( xTimerQueue, &xMessage, xTicksToWait );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
 			}
 			else
 			{
@@ -486,7 +617,7 @@ Timer_t * const pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxCurrentTi
 
 	/* Remove the timer from the list of active timers.  A check has already
 	been performed to ensure the list is not empty. */
-	( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+	prvRemoveTimerFromActiveList( pxTimer );
 	traceTIMER_EXPIRED( pxTimer );
 
 	/* If the timer is an auto reload timer then calculate the next
@@ -556,6 +687,8 @@ BaseType_t xListWasEmpty;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
 {
 TickType_t xTimeNow;
@@ -614,8 +747,75 @@ BaseType_t xTimerListsWereSwitched;
 		}
 	}
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvProcessTimerOrBlockTask( const TickType_t xNextExpireTime, BaseType_t xListWasEmpty )
+	{
+	TickType_t xTimeNow;
+	BaseType_t xTimerListsWereSwitched;
+
+		vTaskSuspendAll();
+		{
+			/* Obtain the time now to make an assessment as to whether the wheel
+			has reached the next slot or not.  The wheel never switches lists, so
+			the times are compared relative to the time the wheel has reached. */
+			xTimeNow = prvSampleTimeNow( &xTimerListsWereSwitched );
+			( void ) xTimerListsWereSwitched;
+
+			if( ( xListWasEmpty == pdFALSE ) && ( ( TickType_t ) ( xTimeNow - xWheelTime ) >= ( TickType_t ) ( xNextExpireTime - xWheelTime ) ) )
+			{
+				( void ) xTaskResumeAll();
+				prvAdvanceTimerWheel( xNextExpireTime, xTimeNow );
+			}
+			else
+			{
+				/* The next slot has not been reached yet.  This task should
+				therefore block to wait for the start of the slot or a command to
+				be received - whichever comes first. */
+				#if( configUSE_TIMER_DIRECT_COMMANDS == 1 )
+				{
+					/* Other tasks may use the wheel from now until this task
+					runs again, provided they do not need it to wake any
+					earlier. */
+					xDaemonWakeTime = xNextExpireTime;
+					xDaemonWaitsIndefinitely = xListWasEmpty;
+					xDaemonIsWaiting = pdTRUE;
+				}
+				#endif /* configUSE_TIMER_DIRECT_COMMANDS */
+
+				vQueueWaitForMessageRestricted( xTimerQueue, ( xNextExpireTime - xTimeNow ), xListWasEmpty );
+
+				if( xTaskResumeAll() == pdFALSE )
+				{
+					/* Yield to wait for either a command to arrive, or the
+					block time to expire.  If a command arrived between the
+					critical section being exited and this yield then the yield
+					will not cause the task to block. */
+					portYIELD_WITHIN_API();
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				#if( configUSE_TIMER_DIRECT_COMMANDS == 1 )
+				{
+					xDaemonIsWaiting = pdFALSE;
+				}
+				#endif /* configUSE_TIMER_DIRECT_COMMANDS */
+			}
+		}
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
 {
 TickType_t xNextExpireTime;
@@ -640,8 +840,87 @@ TickType_t xNextExpireTime;
 
 	return xNextExpireTime;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static TickType_t prvGetNextExpireTime( BaseType_t * const pxListWasEmpty )
+	{
+	TickType_t xNextExpireTime = ( TickType_t ) 0U, xDelta, xNearestDelta = ( TickType_t ) 0U;
+	TickType_t xSlotTime;
+	UBaseType_t uxLevel, uxShift, uxStart, uxSlot;
+
+		/* The next event is the start of the first occupied slot the wheel will
+		reach.  In level 0 that is the expiry time of the timers in the slot.  In
+		higher levels it is the time at which the timers in the slot must move
+		down a level.  Within each level the search starts from the slot after
+		the one xWheelTime is in (from the slot xWheelTime is in for level 0), and
+		wraps round - slots before that one only hold timers that are due after
+		the tick count has wrapped back round to them.  If there are no active
+		timers then just set the next expire time to 0 and *pxListWasEmpty to
+		pdTRUE, so this task blocks until a command is received. */
+		*pxListWasEmpty = pdTRUE;
+
+		for( uxLevel = ( UBaseType_t ) 0; uxLevel < ( UBaseType_t ) tmrWHEEL_LEVELS; uxLevel++ )
+		{
+			if( ulWheelOccupied[ uxLevel ] != 0UL )
+			{
+				uxShift = uxLevel * tmrWHEEL_SLOT_BITS;
+				uxStart = tmrWHEEL_SLOT_OF( xWheelTime, uxLevel );
+
+				if( uxLevel != ( UBaseType_t ) 0 )
+				{
+					uxStart = ( uxStart + ( UBaseType_t ) 1 ) & tmrWHEEL_SLOT_INDEX_MASK;
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				uxSlot = prvFirstOccupiedSlot( ulWheelOccupied[ uxLevel ], uxStart );
+
+				/* The slot starts at xWheelTime with the bits at and below this
+				level replaced by the slot index. */
+				if( ( uxShift + tmrWHEEL_SLOT_BITS ) < ( UBaseType_t ) tmrTICK_BITS )
+				{
+					xSlotTime = xWheelTime & ~( ( ( TickType_t ) 1 << ( uxShift + tmrWHEEL_SLOT_BITS ) ) - ( TickType_t ) 1 );
+				}
+				else
+				{
+					xSlotTime = ( TickType_t ) 0U;
+				}
+
+				xSlotTime |= ( TickType_t ) ( ( TickType_t ) uxSlot << uxShift );
+				xDelta = xSlotTime - xWheelTime;
+
+				if( ( *pxListWasEmpty != pdFALSE ) || ( xDelta < xNearestDelta ) )
+				{
+					*pxListWasEmpty = pdFALSE;
+					xNearestDelta = xDelta;
+					xNextExpireTime = xSlotTime;
+					pxCurrentTimerList = &( xTimerWheel[ uxLevel ][ uxSlot ] );
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+
+		return xNextExpireTime;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
 {
 TickType_t xTimeNow;
@@ -663,8 +942,26 @@ PRIVILEGED_DATA static TickType_t xLastTime = ( TickType_t ) 0U; /*lint !e956 Va
 
 	return xTimeNow;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static TickType_t prvSampleTimeNow( BaseType_t * const pxTimerListsWereSwitched )
+	{
+		/* Times in the wheel are compared relative to xWheelTime, so there are no
+		lists to switch when the tick count overflows. */
+		*pxTimerListsWereSwitched = pdFALSE;
+
+		return xTaskGetTickCount();
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
 {
 BaseType_t xProcessTimerNow = pdFALSE;
@@ -704,6 +1001,312 @@ BaseType_t xProcessTimerNow = pdFALSE;
 
 	return xProcessTimerNow;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static BaseType_t prvInsertTimerInActiveList( Timer_t * const pxTimer, const TickType_t xNextExpiryTime, const TickType_t xTimeNow, const TickType_t xCommandTime )
+	{
+	BaseType_t xProcessTimerNow = pdFALSE;
+	UBaseType_t uxLevel;
+
+		listSET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ), xNextExpiryTime );
+		listSET_LIST_ITEM_OWNER( &( pxTimer->xTimerListItem ), pxTimer );
+
+		/* Has the expiry time elapsed between the command to start/reset a timer
+		was issued, and the time the command was processed?  The expiry time is
+		always xCommandTime plus the period, so this also covers the tick count
+		overflowing in between. */
+		if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) ) >= pxTimer->xTimerPeriodInTicks ) /*lint !e961 MISRA exception as the casts are only redundant for some ports. */
+		{
+			xProcessTimerNow = pdTRUE;
+		}
+		else
+		{
+			/* An empty wheel can be moved straight to the current time, which
+			keeps new timers in the lowest level possible. */
+			for( uxLevel = ( UBaseType_t ) 0; uxLevel < ( UBaseType_t ) tmrWHEEL_LEVELS; uxLevel++ )
+			{
+				if( ulWheelOccupied[ uxLevel ] != 0UL )
+				{
+					break;
+				}
+			}
+
+			if( uxLevel == ( UBaseType_t ) tmrWHEEL_LEVELS )
+			{
+				xWheelTime = xTimeNow;
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+
+			prvPlaceTimerInWheel( pxTimer );
+		}
+
+		return xProcessTimerNow;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+static void prvRemoveTimerFromActiveList( Timer_t * const pxTimer )
+{
+#if( configUSE_TIMER_WHEEL == 1 )
+	List_t * const pxList = ( List_t * ) listLIST_ITEM_CONTAINER( &( pxTimer->xTimerListItem ) );
+	UBaseType_t uxIndex;
+#endif
+
+	if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
+	{
+		/* The timer is in a list, remove it. */
+		( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
+
+		#if( configUSE_TIMER_WHEEL == 1 )
+		{
+			/* Note when the wheel slot becomes empty. */
+			if( listLIST_IS_EMPTY( pxList ) != pdFALSE )
+			{
+				uxIndex = ( UBaseType_t ) ( pxList - &( xTimerWheel[ 0 ][ 0 ] ) );
+				ulWheelOccupied[ uxIndex / tmrWHEEL_SLOTS ] &= ~( ( uint32_t ) 1 << ( uxIndex & tmrWHEEL_SLOT_INDEX_MASK ) );
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		#endif /* configUSE_TIMER_WHEEL */
+	}
+	else
+	{
+		mtCOVERAGE_TEST_MARKER();
+	}
+}
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_WHEEL == 1 )
+
+	static void prvInitialiseTimerWheel( void )
+	{
+	UBaseType_t uxLevel, uxSlot;
+
+		for( uxLevel = ( UBaseType_t ) 0; uxLevel < ( UBaseType_t ) tmrWHEEL_LEVELS; uxLevel++ )
+		{
+			for( uxSlot = ( UBaseType_t ) 0; uxSlot < tmrWHEEL_SLOTS; uxSlot++ )
+			{
+				vListInitialise( &( xTimerWheel[ uxLevel ][ uxSlot ] ) );
+			}
+
+			ulWheelOccupied[ uxLevel ] = 0UL;
+		}
+
+		pxCurrentTimerList = &( xTimerWheel[ 0 ][ 0 ] );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvAdvanceTimerWheel( const TickType_t xNextExpireTime, const TickType_t xTimeNow )
+	{
+		/* Timers only expire from level 0, higher slots are moved down the
+		wheel. */
+		xWheelTime = xNextExpireTime;
+
+		if( tmrWHEEL_LEVEL_OF( pxCurrentTimerList ) == ( UBaseType_t ) 0 )
+		{
+			prvProcessExpiredTimer( xNextExpireTime, xTimeNow );
+		}
+		else
+		{
+			prvCascadeWheelSlot( pxCurrentTimerList );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvPlaceTimerInWheel( Timer_t * const pxTimer )
+	{
+	const TickType_t xDifference = listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ) ^ xWheelTime;
+	UBaseType_t uxLevel = ( UBaseType_t ) 0, uxSlot;
+
+		/* The timer goes in the level containing the most significant bit in
+		which its expiry time differs from xWheelTime. */
+		while( ( ( uxLevel + ( UBaseType_t ) 1 ) < ( UBaseType_t ) tmrWHEEL_LEVELS ) && ( ( xDifference >> ( ( uxLevel + ( UBaseType_t ) 1 ) * tmrWHEEL_SLOT_BITS ) ) != ( TickType_t ) 0U ) )
+		{
+			uxLevel++;
+		}
+
+		uxSlot = tmrWHEEL_SLOT_OF( listGET_LIST_ITEM_VALUE( &( pxTimer->xTimerListItem ) ), uxLevel );
+		vListInsertEnd( &( xTimerWheel[ uxLevel ][ uxSlot ] ), &( pxTimer->xTimerListItem ) );
+		ulWheelOccupied[ uxLevel ] |= ( ( uint32_t ) 1 << uxSlot );
+	}
+	/*-----------------------------------------------------------*/
+
+	static void prvCascadeWheelSlot( List_t * const pxList )
+	{
+	Timer_t *pxTimer;
+
+		/* xWheelTime is now the start of the slot, so every timer in the slot
+		differs from xWheelTime only in lower levels. */
+		while( listLIST_IS_EMPTY( pxList ) == pdFALSE )
+		{
+			pxTimer = ( Timer_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxList ); /*lint !e9087 !e9079 void * is used as this macro is used with tasks and co-routines too.  Alignment is known to be fine as the type of the pointer stored and retrieved is the same. */
+			prvRemoveTimerFromActiveList( pxTimer );
+			prvPlaceTimerInWheel( pxTimer );
+		}
+	}
+	/*-----------------------------------------------------------*/
+
+	static UBaseType_t prvFirstOccupiedSlot( const uint32_t ulOccupied, const UBaseType_t uxStart )
+	{
+	/* Bit positions indexed by the top five bits of the de Bruijn sequence
+	0x077CB531 multiplied by a single set bit. */
+	static const uint8_t ucBitPosition[ 32 ] =
+	{
+		0U, 1U, 28U, 2U, 29U, 14U, 24U, 3U, 30U, 22U, 20U, 15U, 25U, 17U, 4U, 8U,
+		31U, 27U, 13U, 23U, 21U, 19U, 16U, 7U, 26U, 12U, 18U, 6U, 11U, 5U, 10U, 9U
+	};
+	uint32_t ulRotated = ulOccupied;
+
+		configASSERT( ulOccupied != 0UL );
+
+		/* Rotate the slot map so the search starts from bit 0, then isolate
+		the lowest set bit. */
+		if( uxStart != ( UBaseType_t ) 0 )
+		{
+			ulRotated = ( ( ulOccupied >> uxStart ) | ( ulOccupied << ( tmrWHEEL_SLOTS - uxStart ) ) ) & tmrWHEEL_OCCUPIED_MASK;
+		}
+		else
+		{
+			mtCOVERAGE_TEST_MARKER();
+		}
+
+		ulRotated &= ( ~ulRotated + 1UL );
+
+		return ( uxStart + ( UBaseType_t ) ucBitPosition[ ( uint32_t ) ( ulRotated * 0x077CB531UL ) >> 27 ] ) & tmrWHEEL_SLOT_INDEX_MASK;
+	}
+
+#endif /* configUSE_TIMER_WHEEL */
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TIMER_DIRECT_COMMANDS == 1 )
+
+	static BaseType_t prvExecuteCommandDirectly( Timer_t * const pxTimer, const BaseType_t xCommandID, const TickType_t xOptionalValue )
+	{
+	BaseType_t xReturn = pdFAIL;
+	TickType_t xTimeNow, xNextExpiryTime = ( TickType_t ) 0U, xCommandTime = ( TickType_t ) 0U, xPeriod = pxTimer->xTimerPeriodInTicks;
+
+		vTaskSuspendAll();
+		{
+			/* The wheel can only be used from this task while the timer
+			service task is blocked, as with the scheduler suspended it cannot
+			then run until this function has finished.  Commands already in
+			the queue must be processed first to keep commands in order. */
+			if( ( xDaemonIsWaiting != pdFALSE ) && ( uxQueueMessagesWaiting( xTimerQueue ) == ( UBaseType_t ) 0 ) )
+			{
+				xTimeNow = xTaskGetTickCount();
+
+				switch( xCommandID )
+				{
+					case tmrCOMMAND_START :
+					case tmrCOMMAND_RESET :
+						xCommandTime = xOptionalValue;
+						xReturn = pdPASS;
+						break;
+
+					case tmrCOMMAND_CHANGE_PERIOD :
+						configASSERT( ( xOptionalValue > 0 ) );
+						xCommandTime = xTimeNow;
+						xPeriod = xOptionalValue;
+						xReturn = pdPASS;
+						break;
+
+					case tmrCOMMAND_STOP :
+					case tmrCOMMAND_DELETE :
+						xReturn = pdPASS;
+						break;
+
+					default :
+						/* Includes tmrCOMMAND_START_DONT_TRACE, which is only
+						sent by the timer service task itself. */
+						break;
+				}
+
+				if( ( xCommandID == tmrCOMMAND_START ) || ( xCommandID == tmrCOMMAND_RESET ) || ( xCommandID == tmrCOMMAND_CHANGE_PERIOD ) )
+				{
+					/* A timer that has already expired must have its callback
+					executed by the timer service task, and the timer service
+					task must not be left blocked past the new expiry time. */
+					xNextExpiryTime = xCommandTime + xPeriod;
+
+					if( ( ( TickType_t ) ( xTimeNow - xCommandTime ) >= xPeriod ) ||
+						( xDaemonWaitsIndefinitely != pdFALSE ) ||
+						( ( TickType_t ) ( xDaemonWakeTime - xTimeNow ) > ( TickType_t ) ( xNextExpiryTime - xTimeNow ) ) )
+					{
+						xReturn = pdFAIL;
+					}
+					else
+					{
+						mtCOVERAGE_TEST_MARKER();
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+
+				if( xReturn != pdFAIL )
+				{
+					traceTIMER_COMMAND_RECEIVED( pxTimer, xCommandID, xOptionalValue );
+					prvRemoveTimerFromActiveList( pxTimer );
+
+					if( xCommandID == tmrCOMMAND_STOP )
+					{
+						pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+					}
+					else if( xCommandID == tmrCOMMAND_DELETE )
+					{
+						#if ( configSUPPORT_DYNAMIC_ALLOCATION == 1 )
+						{
+							if( ( pxTimer->ucStatus & tmrSTATUS_IS_STATICALLY_ALLOCATED ) == ( uint8_t ) 0 )
+							{
+								vPortFree( pxTimer );
+							}
+							else
+							{
+								pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+							}
+						}
+						#else
+						{
+							pxTimer->ucStatus &= ~tmrSTATUS_IS_ACTIVE;
+						}
+						#endif /* configSUPPORT_DYNAMIC_ALLOCATION */
+					}
+					else
+					{
+						/* The checks above mean the timer cannot be due yet. */
+						pxTimer->ucStatus |= tmrSTATUS_IS_ACTIVE;
+						pxTimer->xTimerPeriodInTicks = xPeriod;
+						( void ) prvInsertTimerInActiveList( pxTimer, xNextExpiryTime, xTimeNow, xCommandTime );
+					}
+				}
+				else
+				{
+					mtCOVERAGE_TEST_MARKER();
+				}
+			}
+			else
+			{
+				mtCOVERAGE_TEST_MARKER();
+			}
+		}
+		( void ) xTaskResumeAll();
+
+		return xReturn;
+	}
+
+#endif /* configUSE_TIMER_DIRECT_COMMANDS */
 /*-----------------------------------------------------------*/
 
 static void	prvProcessReceivedCommands( void )
@@ -745,15 +1348,7 @@ TickType_t xTimeNow;
 			software timer. */
 			pxTimer = xMessage.u.xTimerParameters.pxTimer;
 
-			if( listIS_CONTAINED_WITHIN( NULL, &( pxTimer->xTimerListItem ) ) == pdFALSE ) /*lint !e961. The cast is only redundant when NULL is passed into the macro. */
-			{
-				/* The timer is in a list, remove it. */
-				( void ) uxListRemove( &( pxTimer->xTimerListItem ) );
-			}
-			else
-			{
-				mtCOVERAGE_TEST_MARKER();
-			}
+			prvRemoveTimerFromActiveList( pxTimer );
 
 			traceTIMER_COMMAND_RECEIVED( pxTimer, xMessage.xMessageID, xMessage.u.xTimerParameters.xMessageValue );
 
@@ -854,6 +1449,8 @@ TickType_t xTimeNow;
 }
 /*-----------------------------------------------------------*/
 
+#if( configUSE_TIMER_WHEEL == 0 )
+
 static void prvSwitchTimerLists( void )
 {
 TickType_t xNextExpireTime, xReloadTime;
@@ -911,6 +1508,8 @@ BaseType_t xResult;
 	pxCurrentTimerList = pxOverflowTimerList;
 	pxOverflowTimerList = pxTemp;
 }
+
+#endif /* configUSE_TIMER_WHEEL */
 /*-----------------------------------------------------------*/
 
 static void prvCheckForValidListAndQueue( void )
@@ -922,10 +1521,18 @@ static void prvCheckForValidListAndQueue( void )
 	{
 		if( xTimerQueue == NULL )
 		{
+			#if( configUSE_TIMER_WHEEL == 0 )
 			vListInitialise( &xActiveTimerList1 );
 			vListInitialise( &xActiveTimerList2 );
 			pxCurrentTimerList = &xActiveTimerList1;
 			pxOverflowTimerList = &xActiveTimerList2;
+			#endif /* configUSE_TIMER_WHEEL */
+
+			#if( configUSE_TIMER_WHEEL == 1 )
+			{
+				prvInitialiseTimerWheel();
+			}
+			#endif /* configUSE_TIMER_WHEEL */
 
 			#if( configSUPPORT_STATIC_ALLOCATION == 1 )
 			{
@@ -0,0 +1,325 @@
+/*
+ * Amazon FreeRTOS Platform V1.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ */
+
+/**
+ * @file iot_memory_afr.c
+ * @brief Implementation of the functions in iot_memory.h for Amazon FreeRTOS systems.
+ *
+ * Amazon FreeRTOS runs the scheduler on a single core, so there is one
+ * magazine per size class, shared by all tasks. The magazines are accessed in
+ * critical sections, which last a few instructions, where the system heap
+ * suspends the scheduler for the whole of pvPortMalloc() and vPortFree().
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+
+/* Platform memory include. */
+#include "platform/iot_memory.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/**
+ * @cond DOXYGEN_IGNORE
+ * Doxygen should ignore this section.
+ *
+ * Provide default values for undefined configuration settings.
+ */
+#ifndef IOT_MEMORY_CACHE_CLASS_COUNT
+    #define IOT_MEMORY_CACHE_CLASS_COUNT    ( 5 )
+#endif
+#ifndef IOT_MEMORY_CACHE_MIN_BLOCK_SIZE
+    #define IOT_MEMORY_CACHE_MIN_BLOCK_SIZE    ( 32 )
+#endif
+#ifndef IOT_MEMORY_MAGAZINE_SIZE
+    #define IOT_MEMORY_MAGAZINE_SIZE    ( 8 )
+#endif
+/** @endcond */
+
+/**
+ * @brief Allocate from the system heap on behalf of `pCallSite`.
+ *
+ * When the heap records the call site of its allocations, the blocks are
+ * recorded under the caller of #IotMemory_Malloc rather than under
+ * #IotMemory_Malloc itself, so that the libraries that share the magazines
+ * can be told apart.
+ */
+#if ( configHEAP_CALL_SITE_COUNT > 0 ) && !defined( IotMemory_HeapMalloc )
+    #define _heapMalloc( size, pCallSite )    pvPortMallocFrom( ( size ), ( pCallSite ) )
+#else
+    #define _heapMalloc( size, pCallSite )    ( ( void ) ( pCallSite ), IotMemory_HeapMalloc( size ) )
+#endif
+
+/*
+ * Provide default values for undefined memory allocation functions.
+ */
+#ifndef IotMemory_HeapMalloc
+
+/**
+ * @brief Memory allocation of the system heap, used for the allocations that
+ * the magazines cannot serve. This function should have the same signature as
+ * [malloc](http://pubs.opengroup.org/onlinepubs/9699919799/functions/malloc.html).
+ */
+    #define IotMemory_HeapMalloc    pvPortMalloc
+#endif
+#ifndef IotMemory_HeapFree
+
+/**
+ * @brief Free memory of the system heap. This function should have the same
+ * signature as [free](http://pubs.opengroup.org/onlinepubs/9699919799/functions/free.html).
+ */
+    #define IotMemory_HeapFree    vPortFree
+#endif
+
+/* Check the configuration. */
+#if IOT_MEMORY_CACHE_CLASS_COUNT > 16
+    #error "IOT_MEMORY_CACHE_CLASS_COUNT cannot be more than 16."
+#endif
+#if ( IOT_MEMORY_CACHE_MIN_BLOCK_SIZE & ( IOT_MEMORY_CACHE_MIN_BLOCK_SIZE - 1 ) ) != 0
+    #error "IOT_MEMORY_CACHE_MIN_BLOCK_SIZE must be a power of 2."
+#endif
+
+/**
+ * @brief The class index stored in the header of blocks that no magazine
+ * takes.
+ */
+#define _UNCACHED_CLASS    ( ( size_t ) IOT_MEMORY_CACHE_CLASS_COUNT )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Header placed in front of each block, which keeps the size class of
+ * the block for #IotMemory_Free.
+ *
+ * The union pads the header so that the memory following it keeps the
+ * alignment of the system heap.
+ */
+typedef union _blockHeader
+{
+    size_t classIndex;                       /**< @brief Size class of the block; #_UNCACHED_CLASS if none. */
+    uint8_t alignment[ portBYTE_ALIGNMENT ]; /**< @brief Pads the header to the heap alignment. */
+} _blockHeader_t;
+
+/**
+ * @brief The magazine of a size class: a stack of free blocks.
+ */
+typedef struct _magazine
+{
+    size_t count;                                         /**< @brief Number of blocks in `pRounds`. */
+    _blockHeader_t * pRounds[ IOT_MEMORY_MAGAZINE_SIZE ]; /**< @brief The free blocks. */
+    uint32_t hits;                                        /**< @brief Allocations served from the magazine. */
+    uint32_t misses;                                      /**< @brief Allocations of this class served by the heap. */
+} _magazine_t;
+
+/*-----------------------------------------------------------*/
+
+#if IOT_MEMORY_CACHE_CLASS_COUNT > 0
+
+/**
+ * @brief The magazines, from the smallest size class.
+ */
+    static _magazine_t _magazines[ IOT_MEMORY_CACHE_CLASS_COUNT ] = { { 0 } };
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the size class of an allocation.
+ *
+ * @param[in] size The number of bytes required.
+ *
+ * @return The smallest class whose blocks hold `size` bytes; #_UNCACHED_CLASS
+ * if `size` is larger than the largest class.
+ */
+static size_t _sizeClass( size_t size )
+{
+    size_t classIndex = 0;
+    size_t blockSize = IOT_MEMORY_CACHE_MIN_BLOCK_SIZE;
+
+    while( ( classIndex < _UNCACHED_CLASS ) && ( size > blockSize ) )
+    {
+        classIndex++;
+        blockSize <<= 1;
+    }
+
+    return classIndex;
+}
+
+/*-----------------------------------------------------------*/
+
+void * IotMemory_Malloc( size_t size )
+{
+    _blockHeader_t * pBlock = NULL;
+    const size_t classIndex = _sizeClass( size );
+
+    #if configHEAP_CALL_SITE_COUNT > 0
+        void * const pCallSite = configHEAP_CALL_SITE();
+    #else
+        void * const pCallSite = NULL;
+    #endif
+
+    #if IOT_MEMORY_CACHE_CLASS_COUNT > 0
+        if( classIndex < _UNCACHED_CLASS )
+        {
+            _magazine_t * const pMagazine = &( _magazines[ classIndex ] );
+
+            /* All blocks of a class have the size of the largest allocation of
+             * the class, so that any of them can serve the next allocation. */
+            size = ( size_t ) IOT_MEMORY_CACHE_MIN_BLOCK_SIZE << classIndex;
+
+            taskENTER_CRITICAL();
+            {
+                if( pMagazine->count > 0 )
+                {
+                    pMagazine->count--;
+                    pBlock = pMagazine->pRounds[ pMagazine->count ];
+                    pMagazine->hits++;
+                }
+                else
+                {
+                    pMagazine->misses++;
+                }
+            }
+            taskEXIT_CRITICAL();
+        }
+    #endif /* if IOT_MEMORY_CACHE_CLASS_COUNT > 0 */
+
+    /* Allocate a new block if the magazine was empty. */
+    if( pBlock == NULL )
+    {
+        if( size <= SIZE_MAX - sizeof( _blockHeader_t ) )
+        {
+            pBlock = _heapMalloc( size + sizeof( _blockHeader_t ), pCallSite );
+        }
+
+        if( pBlock != NULL )
+        {
+            pBlock->classIndex = classIndex;
+        }
+    }
+
+    return ( pBlock == NULL ) ? NULL : ( void * ) ( pBlock + 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+void IotMemory_Free( void * ptr )
+{
+    _blockHeader_t * pBlock = NULL;
+    bool cached = false;
+
+    if( ptr != NULL )
+    {
+        pBlock = ( ( _blockHeader_t * ) ptr ) - 1;
+
+        #if IOT_MEMORY_CACHE_CLASS_COUNT > 0
+            if( pBlock->classIndex < _UNCACHED_CLASS )
+            {
+                _magazine_t * const pMagazine = &( _magazines[ pBlock->classIndex ] );
+
+                taskENTER_CRITICAL();
+                {
+                    if( pMagazine->count < IOT_MEMORY_MAGAZINE_SIZE )
+                    {
+                        pMagazine->pRounds[ pMagazine->count ] = pBlock;
+                        pMagazine->count++;
+                        cached = true;
+                    }
+                }
+                taskEXIT_CRITICAL();
+            }
+        #endif
+
+        /* Return the block to the heap if its magazine is full. */
+        if( cached == false )
+        {
+            IotMemory_HeapFree( pBlock );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void IotMemory_FlushCaches( void )
+{
+    #if IOT_MEMORY_CACHE_CLASS_COUNT > 0
+        size_t classIndex = 0;
+        _blockHeader_t * pBlock = NULL;
+
+        for( classIndex = 0; classIndex < _UNCACHED_CLASS; classIndex++ )
+        {
+            do
+            {
+                /* Take one block at a time, so that the heap is not called in a
+                 * critical section. */
+                pBlock = NULL;
+
+                taskENTER_CRITICAL();
+                {
+                    if( _magazines[ classIndex ].count > 0 )
+                    {
+                        _magazines[ classIndex ].count--;
+                        pBlock = _magazines[ classIndex ].pRounds[ _magazines[ classIndex ].count ];
+                    }
+                }
+                taskEXIT_CRITICAL();
+
+                if( pBlock != NULL )
+                {
+                    IotMemory_HeapFree( pBlock );
+                }
+            } while( pBlock != NULL );
+        }
+    #endif /* if IOT_MEMORY_CACHE_CLASS_COUNT > 0 */
+}
+
+/*-----------------------------------------------------------*/
+
+size_t IotMemory_GetCacheStats( IotMemoryCacheStats_t * pStats,
+                                size_t maxCount )
+{
+    size_t classIndex = 0;
+
+    for( classIndex = 0; ( classIndex < _UNCACHED_CLASS ) && ( classIndex < maxCount ); classIndex++ )
+    {
+        pStats[ classIndex ].blockSize = ( size_t ) IOT_MEMORY_CACHE_MIN_BLOCK_SIZE << classIndex;
+
+        #if IOT_MEMORY_CACHE_CLASS_COUNT > 0
+            taskENTER_CRITICAL();
+            {
+                pStats[ classIndex ].cached = _magazines[ classIndex ].count;
+                pStats[ classIndex ].hits = _magazines[ classIndex ].hits;
+                pStats[ classIndex ].misses = _magazines[ classIndex ].misses;
+            }
+            taskEXIT_CRITICAL();
+        #endif
+    }
+
+    return _UNCACHED_CLASS;
+}
+
+/*-----------------------------------------------------------*/
@@ -65,6 +65,19 @@
     #define IOT_NETWORK_SOCKET_POLL_MS    ( 1000 )
 #endif
 
+/* Provide a default size for the per-connection receive buffer. The default
+ * holds an MQTT fixed header with a small packet, such as several acks or a
+ * short PUBLISH, so that each is not read with separate socket reads. Set it
+ * to 1 to simulate poll() with a 1-byte receive as before. */
+#ifndef IOT_NETWORK_RECEIVE_BUFFER_SIZE
+    #define IOT_NETWORK_RECEIVE_BUFFER_SIZE    ( 128 )
+#endif
+
+/* A receive buffer of at least 1 byte is required to simulate poll(). */
+#if IOT_NETWORK_RECEIVE_BUFFER_SIZE < 1
+    #error "IOT_NETWORK_RECEIVE_BUFFER_SIZE must be at least 1."
+#endif
+
 /**
  * @brief The event group bit to set when a connection's socket is shut down.
  */
@@ -91,8 +104,17 @@ typedef struct _networkConnection
     TaskHandle_t receiveTask;                    /**< @brief Handle of the receive task, if any. */
     IotNetworkReceiveCallback_t receiveCallback; /**< @brief Network receive callback, if any. */
     void * pReceiveContext;                      /**< @brief The context for the receive callback. */
-    bool bufferedByteValid;                      /**< @brief Used to determine if the buffered byte is valid. */
-    uint8_t bufferedByte;                        /**< @brief A single byte buffered from a receive, since AFR Secure Sockets does not have poll(). */
+    size_t bufferedOffset;                       /**< @brief Offset of the first unread byte in the receive buffer. */
+    size_t bufferedLength;                       /**< @brief Number of unread bytes in the receive buffer. */
+
+    /**
+     * @brief Bytes buffered from a receive, since AFR Secure Sockets does not have poll().
+     *
+     * The receive task fills this buffer with a single socket read. Any bytes
+     * beyond the first packet are kept for subsequent calls to the receive
+     * callback, so that many small packets may be framed from one socket read.
+     */
+    uint8_t receiveBuffer[ IOT_NETWORK_RECEIVE_BUFFER_SIZE ];
 } _networkConnection_t;
 
 /*-----------------------------------------------------------*/
@@ -107,7 +129,8 @@ const IotNetworkInterface_t IotNetworkAfr =
     .send               = IotNetworkAfr_Send,
     .receive            = IotNetworkAfr_Receive,
     .close              = IotNetworkAfr_Close,
-    .destroy            = IotNetworkAfr_Destroy
+    .destroy            = IotNetworkAfr_Destroy,
+    .sendv              = IotNetworkAfr_SendV
 };
 
 /*-----------------------------------------------------------*/
@@ -133,6 +156,48 @@ static void _destroyConnection( _networkConnection_t * pNetworkConnection )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Copy bytes out of a connection's receive buffer.
+ *
+ * @param[in] pNetworkConnection The connection with buffered data.
+ * @param[out] pBuffer Where to copy the buffered bytes.
+ * @param[in] bytesRequested The maximum number of bytes to copy.
+ *
+ * @return The number of bytes copied, which may be `0` if nothing is buffered.
+ */
+static size_t _copyBufferedData( _networkConnection_t * pNetworkConnection,
+                                 uint8_t * pBuffer,
+                                 size_t bytesRequested )
+{
+    size_t bytesCopied = pNetworkConnection->bufferedLength;
+
+    if( bytesCopied > bytesRequested )
+    {
+        bytesCopied = bytesRequested;
+    }
+
+    if( bytesCopied > 0 )
+    {
+        ( void ) memcpy( pBuffer,
+                         pNetworkConnection->receiveBuffer + pNetworkConnection->bufferedOffset,
+                         bytesCopied );
+
+        pNetworkConnection->bufferedOffset += bytesCopied;
+        pNetworkConnection->bufferedLength -= bytesCopied;
+
+        /* Rewind the buffer once it is drained so that the next socket read
+         * may use all of it. */
+        if( pNetworkConnection->bufferedLength == 0 )
+        {
+            pNetworkConnection->bufferedOffset = 0;
+        }
+    }
+
+    return bytesCopied;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Task routine that waits on incoming network data.
  *
@@ -149,35 +214,51 @@ static void _networkReceiveTask( void * pArgument )
 
     while( true )
     {
-        /* No buffered byte should be in the connection. */
-        configASSERT( pNetworkConnection->bufferedByteValid == false );
-
-        /* Block and wait for 1 byte of data. This simulates the behavior of poll().
-         * THIS IS A TEMPORARY WORKAROUND AND DOES NOT PROVIDE THREAD-SAFETY AGAINST
-         * MULTIPLE CALLS OF RECEIVE. */
-        do
+        /* Only wait on the socket once all buffered data has been consumed by
+         * the receive callback. */
+        if( pNetworkConnection->bufferedLength == 0 )
         {
-            socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
-                                         &( pNetworkConnection->bufferedByte ),
-                                         1,
-                                         0 );
+            /* Block and wait for data. This simulates the behavior of poll().
+             * Everything available (up to the size of the receive buffer) is read
+             * at once so that multiple packets may be processed from one read.
+             * THIS IS A TEMPORARY WORKAROUND AND DOES NOT PROVIDE THREAD-SAFETY AGAINST
+             * MULTIPLE CALLS OF RECEIVE. */
+            do
+            {
+                socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                             pNetworkConnection->receiveBuffer,
+                                             IOT_NETWORK_RECEIVE_BUFFER_SIZE,
+                                             0 );
 
-            connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
+                connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
 
-            if( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN )
+                if( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN )
+                {
+                    socketStatus = SOCKETS_ECLOSED;
+                }
+
+                /* Check for timeout. Some ports return 0, some return EWOULDBLOCK. */
+            } while( ( socketStatus == 0 ) || ( socketStatus == SOCKETS_EWOULDBLOCK ) );
+
+            if( socketStatus <= 0 )
             {
-                socketStatus = SOCKETS_ECLOSED;
+                break;
             }
 
-            /* Check for timeout. Some ports return 0, some return EWOULDBLOCK. */
-        } while( ( socketStatus == 0 ) || ( socketStatus == SOCKETS_EWOULDBLOCK ) );
-
-        if( socketStatus <= 0 )
-        {
-            break;
+            pNetworkConnection->bufferedOffset = 0;
+            pNetworkConnection->bufferedLength = ( size_t ) socketStatus;
         }
+        else
+        {
+            /* Discard buffered data if the connection was closed by a previous
+             * invocation of the receive callback. */
+            connectionFlags = xEventGroupGetBits( ( EventGroupHandle_t ) &( pNetworkConnection->connectionFlags ) );
 
-        pNetworkConnection->bufferedByteValid = true;
+            if( ( connectionFlags & _FLAG_SHUTDOWN ) == _FLAG_SHUTDOWN )
+            {
+                break;
+            }
+        }
 
         /* Invoke the network callback. */
         pNetworkConnection->receiveCallback( pNetworkConnection,
@@ -504,6 +585,52 @@ size_t IotNetworkAfr_Send( void * pConnection,
 
 /*-----------------------------------------------------------*/
 
+size_t IotNetworkAfr_SendV( void * pConnection,
+                            const IotNetworkIoVector_t * pVectors,
+                            size_t vectorCount )
+{
+    size_t bytesSent = 0, i = 0;
+    int32_t socketStatus = SOCKETS_ERROR_NONE;
+
+    /* Cast network connection to the correct type. */
+    _networkConnection_t * pNetworkConnection = ( _networkConnection_t * ) pConnection;
+
+    /* Secure Sockets has no gather send. Hold the socket mutex across all
+     * buffers so that no other thread's data is sent between them. */
+    if( xSemaphoreTake( ( QueueHandle_t ) &( pNetworkConnection->socketMutex ),
+                        portMAX_DELAY ) == pdTRUE )
+    {
+        for( i = 0; i < vectorCount; i++ )
+        {
+            if( pVectors[ i ].length > 0 )
+            {
+                socketStatus = SOCKETS_Send( pNetworkConnection->socket,
+                                             pVectors[ i ].pBuffer,
+                                             pVectors[ i ].length,
+                                             0 );
+
+                if( socketStatus > 0 )
+                {
+                    bytesSent += ( size_t ) socketStatus;
+                }
+
+                /* Stop on an error or a partial send; the caller will see that
+                 * fewer bytes were sent than requested. */
+                if( socketStatus != ( int32_t ) pVectors[ i ].length )
+                {
+                    break;
+                }
+            }
+        }
+
+        xSemaphoreGive( ( QueueHandle_t ) &( pNetworkConnection->socketMutex ) );
+    }
+
+    return bytesSent;
+}
+
+/*-----------------------------------------------------------*/
+
 size_t IotNetworkAfr_Receive( void * pConnection,
                               uint8_t * pBuffer,
                               size_t bytesRequested )
@@ -514,23 +641,41 @@ size_t IotNetworkAfr_Receive( void * pConnection,
     /* Cast network connection to the correct type. */
     _networkConnection_t * pNetworkConnection = ( _networkConnection_t * ) pConnection;
 
-    /* Write the buffered byte. THIS IS A TEMPORARY WORKAROUND AND ASSUMES THIS
+    /* Write the buffered bytes. THIS IS A TEMPORARY WORKAROUND AND ASSUMES THIS
      * FUNCTION IS ALWAYS CALLED FROM THE RECEIVE CALLBACK. */
-    if( pNetworkConnection->bufferedByteValid == true )
-    {
-        *pBuffer = pNetworkConnection->bufferedByte;
-        bytesReceived = 1;
-        bytesRemaining--;
-        pNetworkConnection->bufferedByteValid = false;
-    }
+    bytesReceived = _copyBufferedData( pNetworkConnection, pBuffer, bytesRequested );
+    bytesRemaining -= bytesReceived;
 
     /* Block and wait for incoming data. */
     while( bytesRemaining > 0 )
     {
-        socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
-                                     pBuffer + bytesReceived,
-                                     bytesRemaining,
-                                     0 );
+        /* Small requests are read through the receive buffer so that any
+         * following packets are picked up by the same socket read. Requests
+         * that would not fit in the buffer are read directly. */
+        if( bytesRemaining < ( size_t ) IOT_NETWORK_RECEIVE_BUFFER_SIZE )
+        {
+            socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                         pNetworkConnection->receiveBuffer,
+                                         IOT_NETWORK_RECEIVE_BUFFER_SIZE,
+                                         0 );
+
+            if( socketStatus > 0 )
+            {
+                pNetworkConnection->bufferedOffset = 0;
+                pNetworkConnection->bufferedLength = ( size_t ) socketStatus;
+
+                socketStatus = ( int32_t ) _copyBufferedData( pNetworkConnection,
+                                                              pBuffer + bytesReceived,
+                                                              bytesRemaining );
+            }
+        }
+        else
+        {
+            socketStatus = SOCKETS_Recv( pNetworkConnection->socket,
+                                         pBuffer + bytesReceived,
+                                         bytesRemaining,
+                                         0 );
+        }
 
         if( socketStatus == SOCKETS_EWOULDBLOCK )
         {
@@ -0,0 +1,134 @@
+/*
+ * Amazon FreeRTOS Platform V1.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_memory.h
+ * @brief Small-object memory allocator with per-core magazine caches.
+ *
+ * Blocks of the common small sizes are kept, once freed, in a magazine per
+ * size class, and reused by the next allocation of that class. Taking a block
+ * from or returning it to a magazine only masks interrupts for a few
+ * instructions, so the allocations served by the magazines never take the
+ * lock of the system heap. Other allocations, and allocations that find their
+ * magazine empty, go to the system heap.
+ *
+ * Libraries use this allocator when their memory allocation functions are set
+ * to @ref platform_memory_function_malloc and @ref platform_memory_function_free,
+ * for example:
+ * @code{c}
+ * #define IotMqtt_MallocOperation    IotMemory_Malloc
+ * #define IotMqtt_FreeOperation      IotMemory_Free
+ * @endcode
+ */
+
+#ifndef IOT_MEMORY_H_
+#define IOT_MEMORY_H_
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @functionspage{platform_memory,platform memory component,Memory}
+ * - @functionname{platform_memory_function_malloc}
+ * - @functionname{platform_memory_function_free}
+ * - @functionname{platform_memory_function_flushcaches}
+ * - @functionname{platform_memory_function_getcachestats}
+ */
+
+/**
+ * @brief Usage statistics of a size class, returned by
+ * @ref platform_memory_function_getcachestats.
+ */
+typedef struct IotMemoryCacheStats
+{
+    size_t blockSize; /**< @brief Largest allocation served by this class. */
+    size_t cached;    /**< @brief Number of free blocks held in the magazine. */
+    uint32_t hits;    /**< @brief Allocations served from the magazine. */
+    uint32_t misses;  /**< @brief Allocations of this class served by the system heap. */
+} IotMemoryCacheStats_t;
+
+/**
+ * @functionpage{IotMemory_Malloc,platform_memory,malloc}
+ * @functionpage{IotMemory_Free,platform_memory,free}
+ * @functionpage{IotMemory_FlushCaches,platform_memory,flushcaches}
+ * @functionpage{IotMemory_GetCacheStats,platform_memory,getcachestats}
+ */
+
+/**
+ * @brief Allocate memory, from a magazine if one holds a block large enough.
+ *
+ * This function has the same signature as [malloc](http://pubs.opengroup.org/onlinepubs/9699919799/functions/malloc.html).
+ * Memory it returns must be freed with @ref platform_memory_function_free.
+ *
+ * @param[in] size The number of bytes required.
+ *
+ * @return The allocated memory; `NULL` if the system heap is exhausted.
+ */
+/* @[declare_platform_memory_malloc] */
+void * IotMemory_Malloc( size_t size );
+/* @[declare_platform_memory_malloc] */
+
+/**
+ * @brief Free memory returned by @ref platform_memory_function_malloc.
+ *
+ * The block is kept in the magazine of its size class if that magazine has
+ * room, and returned to the system heap otherwise.
+ *
+ * @param[in] ptr The memory to free. May be `NULL`.
+ */
+/* @[declare_platform_memory_free] */
+void IotMemory_Free( void * ptr );
+/* @[declare_platform_memory_free] */
+
+/**
+ * @brief Return all the blocks held in the magazines to the system heap.
+ *
+ * Blocks in the magazines count as used in the system heap. This function
+ * gives them back, for example before measuring the free heap size or before
+ * a large allocation.
+ */
+/* @[declare_platform_memory_flushcaches] */
+void IotMemory_FlushCaches( void );
+/* @[declare_platform_memory_flushcaches] */
+
+/**
+ * @brief Get the usage statistics of the size classes.
+ *
+ * @param[out] pStats Receives one #IotMemoryCacheStats_t per size class, from
+ * the smallest class.
+ * @param[in] maxCount The number of entries `pStats` has room for.
+ *
+ * @return The number of size classes, which may be more than `maxCount`.
+ */
+/* @[declare_platform_memory_getcachestats] */
+size_t IotMemory_GetCacheStats( IotMemoryCacheStats_t * pStats,
+                                size_t maxCount );
+/* @[declare_platform_memory_getcachestats] */
+
+#endif /* ifndef IOT_MEMORY_H_ */
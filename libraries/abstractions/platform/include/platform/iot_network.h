@@ -67,6 +67,7 @@ typedef enum IotNetworkError
  * - @functionname{platform_network_function_receive}
  * - @functionname{platform_network_function_close}
  * - @functionname{platform_network_function_destroy}
+ * - @functionname{platform_network_function_sendv}
  * - @functionname{platform_network_function_receivecallback}
  */
 
@@ -77,6 +78,7 @@ typedef enum IotNetworkError
  * @functionpage{IotNetworkInterface_t::receive,platform_network,receive}
  * @functionpage{IotNetworkInterface_t::close,platform_network,close}
  * @functionpage{IotNetworkInterface_t::destroy,platform_network,destroy}
+ * @functionpage{IotNetworkInterface_t::sendv,platform_network,sendv}
  * @functionpage{IotNetworkReceiveCallback_t,platform_network,receivecallback}
  */
 
@@ -95,6 +97,16 @@ typedef void ( * IotNetworkReceiveCallback_t )( void * pConnection,
                                                 void * pContext );
 /* @[declare_platform_network_receivecallback] */
 
+/**
+ * @ingroup platform_datatypes_paramstructs
+ * @brief A buffer to send with @ref platform_network_function_sendv.
+ */
+typedef struct IotNetworkIoVector
+{
+    const uint8_t * pBuffer; /**< @brief The data to send. */
+    size_t length;           /**< @brief Length of `pBuffer`. */
+} IotNetworkIoVector_t;
+
 /**
  * @ingroup platform_datatypes_paramstructs
  * @brief Represents the functions of a network stack.
@@ -232,6 +244,31 @@ typedef struct IotNetworkInterface
     /* @[declare_platform_network_destroy] */
     IotNetworkError_t ( * destroy )( void * pConnection );
     /* @[declare_platform_network_destroy] */
+
+    /**
+     * @brief Send data from multiple buffers over a network connection.
+     *
+     * Attempts to transmit the buffers in `pVectors`, in order, as one
+     * contiguous message across the connection represented by `pConnection`.
+     * No other data may be sent on the connection between the buffers.
+     * Returns the total number of bytes actually sent, `0` on failure.
+     *
+     * This function is optional; set it to `NULL` if the network stack does
+     * not support it. Libraries fall back to @ref platform_network_function_send
+     * with a single contiguous buffer when it is `NULL`.
+     *
+     * @param[in] pConnection The connection used to send data, defined by the
+     * network stack.
+     * @param[in] pVectors The buffers to send.
+     * @param[in] vectorCount The number of entries in `pVectors`.
+     *
+     * @return The number of bytes successfully sent, `0` on failure.
+     */
+    /* @[declare_platform_network_sendv] */
+    size_t ( * sendv )( void * pConnection,
+                        const IotNetworkIoVector_t * pVectors,
+                        size_t vectorCount );
+    /* @[declare_platform_network_sendv] */
 } IotNetworkInterface_t;
 
 /**
@@ -0,0 +1,479 @@
+/*
+ * Amazon FreeRTOS Platform V1.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_test_platform_memory.c
+ * @brief Tests for the functions in iot_memory.h
+ */
+
+#include "iot_config.h"
+
+/* Test framework includes. */
+#include <stdbool.h>
+#include <string.h>
+#include "unity_fixture.h"
+
+#include "platform/iot_memory.h"
+#include "FreeRTOS.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The number of blocks allocated by the tests, more than a magazine holds.
+ */
+#define TEST_BLOCK_COUNT    ( 64 )
+
+/**
+ * @brief An allocation size larger than the size classes.
+ */
+#define TEST_LARGE_SIZE     ( 64 * 1024 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the statistics of the size class that serves allocations of
+ * `size` bytes.
+ */
+static bool _getClassStats( size_t size,
+                            IotMemoryCacheStats_t * pClassStats )
+{
+    IotMemoryCacheStats_t stats[ 16 ];
+    size_t classCount = IotMemory_GetCacheStats( stats, 16 ), i = 0;
+
+    for( i = 0; i < classCount; i++ )
+    {
+        if( stats[ i ].blockSize >= size )
+        {
+            *pClassStats = stats[ i ];
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+#if configHEAP_CALL_SITE_COUNT > 0
+
+/**
+ * @brief Get the entry of a call site in the table of the heap.
+ *
+ * @return `false` if the call site has no entry of its own, which happens
+ * once the table is full.
+ */
+    static bool _getCallSite( const void * pCallSite,
+                              HeapCallSite_t * pEntry )
+    {
+        static HeapCallSite_t callSites[ configHEAP_CALL_SITE_COUNT ];
+        UBaseType_t count = uxPortGetHeapCallSites( callSites, configHEAP_CALL_SITE_COUNT ), i = 0;
+
+        for( i = 0; i < count; i++ )
+        {
+            if( ( callSites[ i ].pvCallSite == pCallSite ) && ( pCallSite != NULL ) )
+            {
+                *pEntry = callSites[ i ];
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Count the call sites in the table of the heap that hold a live block
+ * of at least `size` bytes.
+ */
+    static size_t _countLargeCallSites( size_t size )
+    {
+        static HeapCallSite_t callSites[ configHEAP_CALL_SITE_COUNT ];
+        UBaseType_t count = uxPortGetHeapCallSites( callSites, configHEAP_CALL_SITE_COUNT ), i = 0;
+        size_t largeCallSites = 0;
+
+        for( i = 0; i < count; i++ )
+        {
+            if( ( callSites[ i ].pvCallSite != NULL ) && ( callSites[ i ].xLiveBytes >= size ) )
+            {
+                largeCallSites++;
+            }
+        }
+
+        return largeCallSites;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check the free block information of a HeapStats_t is consistent.
+ */
+    static void _checkHeapStats( const HeapStats_t * pStats )
+    {
+        size_t histogramCount = 0, i = 0;
+
+        for( i = 0; i < portHEAP_HISTOGRAM_SIZE; i++ )
+        {
+            histogramCount += pStats->xFreeBlockHistogram[ i ];
+        }
+
+        TEST_ASSERT_EQUAL( pStats->xNumberOfFreeBlocks, histogramCount );
+        TEST_ASSERT_TRUE( pStats->xSizeOfSmallestFreeBlockInBytes <= pStats->xSizeOfLargestFreeBlockInBytes );
+        TEST_ASSERT_TRUE( pStats->xSizeOfLargestFreeBlockInBytes <= pStats->xAvailableHeapSpaceInBytes );
+        TEST_ASSERT_TRUE( pStats->xMinimumEverFreeBytesRemaining <= pStats->xAvailableHeapSpaceInBytes );
+        TEST_ASSERT_TRUE( pStats->uxFragmentationPercent <= 100 );
+
+        /* A single free block is never fragmented. */
+        if( pStats->xNumberOfFreeBlocks <= 1 )
+        {
+            TEST_ASSERT_EQUAL( 0, pStats->uxFragmentationPercent );
+        }
+    }
+
+#endif /* if configHEAP_CALL_SITE_COUNT > 0 */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for Platform Memory tests.
+ */
+TEST_GROUP( UTIL_Platform_Memory );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for Platform Memory tests.
+ */
+TEST_SETUP( UTIL_Platform_Memory )
+{
+    /* Start each test with empty magazines. */
+    IotMemory_FlushCaches();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for Platform Memory tests.
+ */
+TEST_TEAR_DOWN( UTIL_Platform_Memory )
+{
+    IotMemory_FlushCaches();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for Platform Memory tests.
+ */
+TEST_GROUP_RUNNER( UTIL_Platform_Memory )
+{
+    RUN_TEST_CASE( UTIL_Platform_Memory, IotMemory_MallocSizes );
+    RUN_TEST_CASE( UTIL_Platform_Memory, IotMemory_CachedReuse );
+    RUN_TEST_CASE( UTIL_Platform_Memory, IotMemory_MagazineFull );
+
+    #if configHEAP_CALL_SITE_COUNT > 0
+        RUN_TEST_CASE( UTIL_Platform_Memory, Heap_Stats );
+        RUN_TEST_CASE( UTIL_Platform_Memory, Heap_CallSites );
+        RUN_TEST_CASE( UTIL_Platform_Memory, IotMemory_CallSites );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Allocations of all sizes are aligned, writable and freed.
+ */
+TEST( UTIL_Platform_Memory, IotMemory_MallocSizes )
+{
+    const size_t sizes[] = { 0, 1, 8, 31, 32, 33, 100, 128, 255, 256, 511, 512, 513, 2000, TEST_LARGE_SIZE };
+    void * pBlocks[ sizeof( sizes ) / sizeof( sizes[ 0 ] ) ] = { 0 };
+    size_t i = 0, freeHeapSize = xPortGetFreeHeapSize();
+
+    for( i = 0; i < sizeof( sizes ) / sizeof( sizes[ 0 ] ); i++ )
+    {
+        pBlocks[ i ] = IotMemory_Malloc( sizes[ i ] );
+        TEST_ASSERT_NOT_NULL( pBlocks[ i ] );
+        TEST_ASSERT_EQUAL( 0, ( ( uintptr_t ) pBlocks[ i ] ) & portBYTE_ALIGNMENT_MASK );
+        memset( pBlocks[ i ], 0xA5, sizes[ i ] );
+    }
+
+    for( i = 0; i < sizeof( sizes ) / sizeof( sizes[ 0 ] ); i++ )
+    {
+        IotMemory_Free( pBlocks[ i ] );
+    }
+
+    /* Freeing NULL does nothing. */
+    IotMemory_Free( NULL );
+
+    /* Once the magazines are flushed, all the memory is back in the heap. */
+    IotMemory_FlushCaches();
+    TEST_ASSERT_EQUAL( freeHeapSize, xPortGetFreeHeapSize() );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A freed block is reused by the next allocation of its size class.
+ */
+TEST( UTIL_Platform_Memory, IotMemory_CachedReuse )
+{
+    void * pBlock = NULL, * pLargeBlock = NULL;
+    IotMemoryCacheStats_t before = { 0 }, after = { 0 };
+
+    TEST_ASSERT_TRUE( _getClassStats( 40, &before ) );
+    TEST_ASSERT_EQUAL( 0, before.cached );
+
+    /* The first allocation finds the magazine empty. */
+    pBlock = IotMemory_Malloc( 40 );
+    TEST_ASSERT_NOT_NULL( pBlock );
+    IotMemory_Free( pBlock );
+
+    /* The second allocation of the class, even of another size, reuses the
+     * block. */
+    TEST_ASSERT_EQUAL_PTR( pBlock, IotMemory_Malloc( before.blockSize ) );
+
+    TEST_ASSERT_TRUE( _getClassStats( 40, &after ) );
+    TEST_ASSERT_EQUAL( before.misses + 1, after.misses );
+    TEST_ASSERT_EQUAL( before.hits + 1, after.hits );
+    TEST_ASSERT_EQUAL( 0, after.cached );
+
+    IotMemory_Free( pBlock );
+
+    /* Allocations larger than the size classes are not cached. */
+    TEST_ASSERT_FALSE( _getClassStats( TEST_LARGE_SIZE, &after ) );
+    pLargeBlock = IotMemory_Malloc( TEST_LARGE_SIZE );
+    TEST_ASSERT_NOT_NULL( pLargeBlock );
+    IotMemory_Free( pLargeBlock );
+
+    TEST_ASSERT_TRUE( _getClassStats( 40, &after ) );
+    TEST_ASSERT_EQUAL( 1, after.cached );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Blocks freed into a full magazine go back to the heap.
+ */
+TEST( UTIL_Platform_Memory, IotMemory_MagazineFull )
+{
+    void * pBlocks[ TEST_BLOCK_COUNT ] = { 0 };
+    IotMemoryCacheStats_t stats = { 0 };
+    size_t i = 0, freeHeapSize = xPortGetFreeHeapSize(), allocatedHeapSize = 0;
+
+    for( i = 0; i < TEST_BLOCK_COUNT; i++ )
+    {
+        pBlocks[ i ] = IotMemory_Malloc( 100 );
+        TEST_ASSERT_NOT_NULL( pBlocks[ i ] );
+    }
+
+    allocatedHeapSize = xPortGetFreeHeapSize();
+
+    for( i = 0; i < TEST_BLOCK_COUNT; i++ )
+    {
+        IotMemory_Free( pBlocks[ i ] );
+    }
+
+    /* The magazine keeps some of the blocks, the heap gets the others. */
+    TEST_ASSERT_TRUE( _getClassStats( 100, &stats ) );
+    TEST_ASSERT_GREATER_THAN( 0, stats.cached );
+    TEST_ASSERT_LESS_THAN( TEST_BLOCK_COUNT, stats.cached );
+    TEST_ASSERT_GREATER_THAN( allocatedHeapSize, xPortGetFreeHeapSize() );
+    TEST_ASSERT_LESS_THAN( freeHeapSize, xPortGetFreeHeapSize() );
+
+    /* Allocations are served from the magazine, without the heap, until it
+     * is empty. */
+    allocatedHeapSize = xPortGetFreeHeapSize();
+
+    for( i = 0; i < stats.cached; i++ )
+    {
+        pBlocks[ i ] = IotMemory_Malloc( 100 );
+        TEST_ASSERT_NOT_NULL( pBlocks[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL( allocatedHeapSize, xPortGetFreeHeapSize() );
+
+    for( i = 0; i < stats.cached; i++ )
+    {
+        IotMemory_Free( pBlocks[ i ] );
+    }
+
+    IotMemory_FlushCaches();
+    TEST_ASSERT_EQUAL( freeHeapSize, xPortGetFreeHeapSize() );
+}
+
+/*-----------------------------------------------------------*/
+
+#if configHEAP_CALL_SITE_COUNT > 0
+
+/**
+ * @brief The heap statistics count allocations and frees, and describe the
+ * free block left between two allocated blocks.
+ */
+    TEST( UTIL_Platform_Memory, Heap_Stats )
+    {
+        void * pBlocks[ TEST_BLOCK_COUNT ] = { 0 };
+        HeapStats_t before = { 0 }, during = { 0 }, after = { 0 };
+        size_t i = 0, hole = 0, stride = 0, histogramIndex = 0;
+
+        vPortGetHeapStats( &before );
+        _checkHeapStats( &before );
+        TEST_ASSERT_EQUAL( xPortGetFreeHeapSize(), before.xAvailableHeapSpaceInBytes );
+
+        for( i = 0; i < TEST_BLOCK_COUNT; i++ )
+        {
+            pBlocks[ i ] = pvPortMalloc( 200 );
+            TEST_ASSERT_NOT_NULL( pBlocks[ i ] );
+        }
+
+        /* Free a block that lies between the blocks allocated before and after
+         * it, so that it becomes a free block of its own. */
+        for( i = 1; ( i < TEST_BLOCK_COUNT - 1 ) && ( hole == 0 ); i++ )
+        {
+            stride = ( size_t ) ( ( uint8_t * ) pBlocks[ i ] - ( uint8_t * ) pBlocks[ i - 1 ] );
+
+            if( ( ( uint8_t * ) pBlocks[ i ] + stride == ( uint8_t * ) pBlocks[ i + 1 ] ) && ( stride < 400 ) )
+            {
+                hole = i;
+            }
+        }
+
+        TEST_ASSERT_NOT_EQUAL( 0, hole );
+        vPortFree( pBlocks[ hole ] );
+        pBlocks[ hole ] = NULL;
+
+        vPortGetHeapStats( &during );
+        _checkHeapStats( &during );
+        TEST_ASSERT_EQUAL( before.xNumberOfSuccessfulAllocations + TEST_BLOCK_COUNT, during.xNumberOfSuccessfulAllocations );
+        TEST_ASSERT_EQUAL( before.xNumberOfSuccessfulFrees + 1, during.xNumberOfSuccessfulFrees );
+        TEST_ASSERT_EQUAL( xPortGetFreeHeapSize(), during.xAvailableHeapSpaceInBytes );
+        TEST_ASSERT_TRUE( during.xSizeOfSmallestFreeBlockInBytes <= stride );
+        TEST_ASSERT_GREATER_THAN( 1, during.xNumberOfFreeBlocks );
+
+        /* The histogram counts the hole in the entry of its size. */
+        while( ( histogramIndex < portHEAP_HISTOGRAM_SIZE - 1 ) && ( stride >= ( ( size_t ) 32 << histogramIndex ) ) )
+        {
+            histogramIndex++;
+        }
+
+        TEST_ASSERT_GREATER_THAN( 0, during.xFreeBlockHistogram[ histogramIndex ] );
+
+        for( i = 0; i < TEST_BLOCK_COUNT; i++ )
+        {
+            vPortFree( pBlocks[ i ] );
+        }
+
+        vPortGetHeapStats( &after );
+        _checkHeapStats( &after );
+        TEST_ASSERT_EQUAL( before.xAvailableHeapSpaceInBytes, after.xAvailableHeapSpaceInBytes );
+        TEST_ASSERT_EQUAL( during.xNumberOfSuccessfulFrees + TEST_BLOCK_COUNT - 1, after.xNumberOfSuccessfulFrees );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The heap keeps the live blocks, the live bytes and the peak of each
+ * call site given to pvPortMallocFrom().
+ */
+    TEST( UTIL_Platform_Memory, Heap_CallSites )
+    {
+        static const uint8_t callSite = 0;
+        HeapCallSite_t entry = { 0 };
+        void * pFirst = NULL, * pSecond = NULL;
+        size_t peak = 0;
+
+        if( uxPortGetHeapCallSites( NULL, 0 ) >= configHEAP_CALL_SITE_COUNT - 1 )
+        {
+            TEST_IGNORE_MESSAGE( "The table of call sites is full." );
+        }
+
+        pFirst = pvPortMallocFrom( 100, ( void * ) &callSite );
+        TEST_ASSERT_NOT_NULL( pFirst );
+        pSecond = pvPortMallocFrom( 300, ( void * ) &callSite );
+        TEST_ASSERT_NOT_NULL( pSecond );
+
+        TEST_ASSERT_TRUE( _getCallSite( &callSite, &entry ) );
+        TEST_ASSERT_EQUAL( 2, entry.xLiveBlocks );
+        TEST_ASSERT_EQUAL( 2, entry.xAllocations );
+        TEST_ASSERT_TRUE( entry.xLiveBytes >= 400 );
+        TEST_ASSERT_EQUAL( entry.xLiveBytes, entry.xPeakLiveBytes );
+        TEST_ASSERT_EQUAL( 0, entry.xFailures );
+        peak = entry.xPeakLiveBytes;
+
+        /* Freeing lowers the live bytes, but not the peak. */
+        vPortFree( pSecond );
+        TEST_ASSERT_TRUE( _getCallSite( &callSite, &entry ) );
+        TEST_ASSERT_EQUAL( 1, entry.xLiveBlocks );
+        TEST_ASSERT_TRUE( entry.xLiveBytes >= 100 );
+        TEST_ASSERT_LESS_THAN( 300, entry.xLiveBytes );
+        TEST_ASSERT_EQUAL( peak, entry.xPeakLiveBytes );
+
+        vPortFree( pFirst );
+        TEST_ASSERT_TRUE( _getCallSite( &callSite, &entry ) );
+        TEST_ASSERT_EQUAL( 0, entry.xLiveBlocks );
+        TEST_ASSERT_EQUAL( 0, entry.xLiveBytes );
+        TEST_ASSERT_EQUAL( 2, entry.xAllocations );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The blocks IotMemory_Malloc() takes from the heap are recorded under
+ * the caller of IotMemory_Malloc(), so two callers get two call sites.
+ */
+    TEST( UTIL_Platform_Memory, IotMemory_CallSites )
+    {
+        void * pFirst = NULL, * pSecond = NULL;
+        size_t largeCallSites = 0;
+
+        if( uxPortGetHeapCallSites( NULL, 0 ) >= configHEAP_CALL_SITE_COUNT - 2 )
+        {
+            TEST_IGNORE_MESSAGE( "The table of call sites is full." );
+        }
+
+        largeCallSites = _countLargeCallSites( TEST_LARGE_SIZE );
+
+        /* Allocations larger than the size classes always come from the heap. */
+        pFirst = IotMemory_Malloc( TEST_LARGE_SIZE );
+        TEST_ASSERT_NOT_NULL( pFirst );
+        pSecond = IotMemory_Malloc( TEST_LARGE_SIZE );
+        TEST_ASSERT_NOT_NULL( pSecond );
+
+        #ifdef __GNUC__
+            /* The default call site is a return address, so the two calls are
+             * two call sites. */
+            TEST_ASSERT_EQUAL( largeCallSites + 2, _countLargeCallSites( TEST_LARGE_SIZE ) );
+        #else
+            TEST_ASSERT_GREATER_THAN( largeCallSites, _countLargeCallSites( TEST_LARGE_SIZE ) );
+        #endif
+
+        IotMemory_Free( pFirst );
+        IotMemory_Free( pSecond );
+
+        TEST_ASSERT_EQUAL( largeCallSites, _countLargeCallSites( TEST_LARGE_SIZE ) );
+    }
+
+#endif /* if configHEAP_CALL_SITE_COUNT > 0 */
+
+/*-----------------------------------------------------------*/
@@ -31,8 +31,10 @@
 #endif
 
 /*
- * Called once to create the logging task and queue.  Must be called before any
- * calls to vLoggingPrintf().
+ * Called once to create the logging task and the ring buffer it outputs log
+ * messages from.  Must be called before any calls to vLoggingPrintf().  The
+ * ring buffer is large enough to hold uxQueueLength messages of the maximum
+ * length, configLOGGING_MAX_MESSAGE_LENGTH, and more shorter messages.
  */
 BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
                                    UBaseType_t uxPriority,
@@ -48,4 +50,16 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
 void vLoggingPrintf( const char * pcFormat,
                      ... );
 
+/*
+ * Output a string without formatting.  vLoggingPrint() is called from tasks,
+ * vLoggingPrintFromISR() from interrupts.  These are only provided by the
+ * implementations that use a logging task.  Messages are copied to a ring
+ * buffer that is allocated once by xLoggingTaskInitialize(), so logging never
+ * allocates memory; a message that does not fit in the ring buffer is dropped
+ * and counted.
+ */
+void vLoggingPrint( const char * pcMessage );
+void vLoggingPrintFromISR( const char * pcMessage,
+                           BaseType_t * pxHigherPriorityTaskWoken );
+
 #endif /* AWS_LOGGING_TASK_H */
@@ -0,0 +1,178 @@
+/*
+ * Amazon FreeRTOS Common V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_slab.h
+ * @brief Fixed-size block allocator with size classes.
+ *
+ * A slab hands out blocks of one size from a caller-provided array. Freed
+ * blocks are kept on a free list, so allocation and free are O(1) regardless
+ * of how many blocks the slab holds. An array of slabs sorted by increasing
+ * block size forms a set of size classes: each allocation is taken from the
+ * smallest class that fits and has a free block.
+ *
+ * The slab functions are not thread-safe; callers must provide their own
+ * synchronization.
+ */
+
+#ifndef IOT_SLAB_H_
+#define IOT_SLAB_H_
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @functionspage{slab,slab allocator}
+ * - @functionname{slab_function_alloc}
+ * - @functionname{slab_function_find}
+ * - @functionname{slab_function_free}
+ * - @functionname{slab_function_getstats}
+ */
+
+/**
+ * @brief A pool of fixed-size blocks.
+ *
+ * Slabs should be initialized with #IOT_SLAB_INITIALIZER, which allows them
+ * to be statically allocated and used without an initialization function.
+ *
+ * @note The members of this struct should not be accessed directly.
+ */
+typedef struct IotSlab
+{
+    uint8_t * pBlocks;  /**< @brief Start of the block array. */
+    size_t blockSize;   /**< @brief Size of each block. */
+    size_t blockCount;  /**< @brief Number of blocks in the array. */
+    size_t nextUnused;  /**< @brief Index of the first block never handed out. */
+    void * pFreeList;   /**< @brief Blocks that were handed out and freed. */
+    size_t inUse;       /**< @brief Number of blocks currently allocated. */
+    size_t highWater;   /**< @brief Largest value of inUse seen. */
+    size_t failures;    /**< @brief Allocations that fit this class but found it empty. */
+} IotSlab_t;
+
+/**
+ * @brief Usage statistics of a slab, returned by @ref slab_function_getstats.
+ */
+typedef struct IotSlabStats
+{
+    size_t blockSize;  /**< @brief Size of each block in the slab. */
+    size_t blockCount; /**< @brief Total number of blocks in the slab. */
+    size_t inUse;      /**< @brief Number of blocks currently allocated. */
+    size_t highWater;  /**< @brief Largest number of blocks allocated at once. */
+
+    /**
+     * @brief Number of allocations for which this was the smallest fitting class
+     * but which found it empty.
+     *
+     * These allocations were either taken from a larger class or failed.
+     */
+    size_t failures;
+} IotSlabStats_t;
+
+/**
+ * @brief Initializer for an #IotSlab_t.
+ *
+ * @param[in] pBlockArray The array of blocks managed by the slab.
+ * @param[in] size The size of each block. Must be at least `sizeof( void * )`.
+ * @param[in] count The number of blocks in `pBlockArray`.
+ */
+/* @[define_slab_initializer] */
+#define IOT_SLAB_INITIALIZER( pBlockArray, size, count ) \
+    { ( uint8_t * ) ( pBlockArray ), ( size ), ( count ), 0, NULL, 0, 0, 0 }
+/* @[define_slab_initializer] */
+
+/**
+ * @functionpage{IotSlab_Alloc,slab,alloc}
+ * @functionpage{IotSlab_Find,slab,find}
+ * @functionpage{IotSlab_Free,slab,free}
+ * @functionpage{IotSlab_GetStats,slab,getstats}
+ */
+
+/**
+ * @brief Allocate a block from a set of size classes.
+ *
+ * The block is taken from the first slab in `pSlabs` whose block size is at
+ * least `size` and which has a free block.
+ *
+ * @param[in] pSlabs The size classes, sorted by increasing block size.
+ * @param[in] classCount The number of slabs in `pSlabs`.
+ * @param[in] size The number of bytes required.
+ *
+ * @return A block of at least `size` bytes; `NULL` if no class can satisfy the
+ * request. The first `sizeof( void * )` bytes of the block are zero; the
+ * remaining bytes hold whatever was last written to them.
+ */
+/* @[declare_slab_alloc] */
+void * IotSlab_Alloc( IotSlab_t * pSlabs,
+                      size_t classCount,
+                      size_t size );
+/* @[declare_slab_alloc] */
+
+/**
+ * @brief Find the slab that owns a block.
+ *
+ * @param[in] pSlabs The size classes that may own `ptr`.
+ * @param[in] classCount The number of slabs in `pSlabs`.
+ * @param[in] ptr A block previously returned by @ref slab_function_alloc.
+ *
+ * @return The slab that owns `ptr`; `NULL` if `ptr` is not the start of a
+ * block in any of the slabs.
+ */
+/* @[declare_slab_find] */
+IotSlab_t * IotSlab_Find( IotSlab_t * pSlabs,
+                          size_t classCount,
+                          const void * ptr );
+/* @[declare_slab_find] */
+
+/**
+ * @brief Return a block to its slab.
+ *
+ * @param[in] pSlab The slab that owns `ptr`, as returned by @ref slab_function_find.
+ * @param[in] ptr The block to free.
+ */
+/* @[declare_slab_free] */
+void IotSlab_Free( IotSlab_t * pSlab,
+                   void * ptr );
+/* @[declare_slab_free] */
+
+/**
+ * @brief Get the usage statistics of a set of size classes.
+ *
+ * @param[in] pSlabs The size classes.
+ * @param[in] classCount The number of slabs in `pSlabs`.
+ * @param[out] pStats Receives one #IotSlabStats_t per slab; must have room
+ * for `classCount` entries.
+ */
+/* @[declare_slab_getstats] */
+void IotSlab_GetStats( const IotSlab_t * pSlabs,
+                       size_t classCount,
+                       IotSlabStats_t * pStats );
+/* @[declare_slab_getstats] */
+
+#endif /* ifndef IOT_SLAB_H_ */
@@ -57,7 +57,11 @@
  * - @functionname{taskpool_function_recyclejob}
  * - @functionname{taskpool_function_schedule}
  * - @functionname{taskpool_function_scheduledeferred}
+ * - @functionname{taskpool_function_setjobclass}
+ * - @functionname{taskpool_function_setlatejobcallback}
  * - @functionname{taskpool_function_getstatus}
+ * - @functionname{taskpool_function_getstats}
+ * - @functionname{taskpool_function_resetstats}
  * - @functionname{taskpool_function_trycancel}
  * - @functionname{taskpool_function_getjobstoragefromhandle}
  * - @functionname{taskpool_function_strerror}
@@ -75,7 +79,11 @@
  * @functionpage{IotTaskPool_RecycleJob,taskpool,recyclejob}
  * @functionpage{IotTaskPool_Schedule,taskpool,schedule}
  * @functionpage{IotTaskPool_ScheduleDeferred,taskpool,scheduledeferred}
+ * @functionpage{IotTaskPool_SetJobClass,taskpool,setjobclass}
+ * @functionpage{IotTaskPool_SetLateJobCallback,taskpool,setlatejobcallback}
  * @functionpage{IotTaskPool_GetStatus,taskpool,getstatus}
+ * @functionpage{IotTaskPool_GetStats,taskpool,getstats}
+ * @functionpage{IotTaskPool_ResetStats,taskpool,resetstats}
  * @functionpage{IotTaskPool_TryCancel,taskpool,trycancel}
  * @functionpage{IotTaskPool_GetJobStorageFromHandle,taskpool,getjobstoragefromhandle}
  * @functionpage{IotTaskPool_strerror,taskpool,strerror}
@@ -331,7 +339,8 @@ IotTaskPoolError_t IotTaskPool_RecycleJob( IotTaskPool_t taskPool,
  * @param[in] taskPool A handle to the task pool that must have been previously initialized with.
  * a call to @ref IotTaskPool_Create.
  * @param[in] job A job to schedule for execution. This must be first initialized with a call to @ref IotTaskPool_CreateJob.
- * @param[in] flags Flags to be passed by the user, e.g. to identify the job as high priority by specifying #IOT_TASKPOOL_JOB_HIGH_PRIORITY.
+ * @param[in] flags Flags to be passed by the user, e.g. to identify the job as high priority by specifying #IOT_TASKPOOL_JOB_HIGH_PRIORITY,
+ * or to keep related jobs on the same workers by specifying #IOT_TASKPOOL_JOB_AFFINITY.
  *
  * @return One of the following:
  * - #IOT_TASKPOOL_SUCCESS
@@ -444,6 +453,61 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPool,
                                                  uint32_t timeMs );
 /* @[declare_taskpool_scheduledeferred] */
 
+/**
+ * @brief This function sets the priority class and the deadline of a job.
+ *
+ * A job created with @ref IotTaskPool_CreateJob or @ref IotTaskPool_CreateRecyclableJob belongs to
+ * #IOT_TASKPOOL_CLASS_DEFAULT and has no deadline. The class and the deadline apply every time the job
+ * is scheduled, until the job is created again.
+ *
+ * A job that has not started executing `deadlineMs` milliseconds after it was queued for execution is
+ * late: it jumps ahead of the other jobs of its lane as soon as it reaches the head of the queue of its
+ * class, and it is reported to the callback set with @ref IotTaskPool_SetLateJobCallback. For a job
+ * scheduled with @ref IotTaskPool_ScheduleDeferred, the deadline starts when the job's timer expires.
+ *
+ * @param[in] job A job created with @ref IotTaskPool_CreateJob or @ref IotTaskPool_CreateRecyclableJob.
+ * @param[in] jobClass The priority class of the job.
+ * @param[in] deadlineMs The deadline in milliseconds, or `0` for no deadline.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_ILLEGAL_OPERATION
+ *
+ * @note This function will not allocate memory.
+ *
+ * @warning The class and deadline of a job that is scheduled or deferred cannot be changed.
+ */
+/* @[declare_taskpool_setjobclass] */
+IotTaskPoolError_t IotTaskPool_SetJobClass( IotTaskPoolJob_t job,
+                                            IotTaskPoolJobClass_t jobClass,
+                                            uint32_t deadlineMs );
+/* @[declare_taskpool_setjobclass] */
+
+/**
+ * @brief This function sets the callback to report jobs that start executing past their deadline.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with
+ * a call to @ref IotTaskPool_Create or @ref IotTaskPool_CreateSystemTaskPool.
+ * @param[in] lateJobCallback The callback, or `NULL` to stop reporting late jobs.
+ * @param[in] pContext The context to pass to the callback.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ *
+ * @note The callback runs in the task pool thread that is about to execute the late job, and
+ * delays it further: it should return quickly.
+ *
+ * @warning Set the callback before scheduling jobs with a deadline; jobs that are already executing
+ * may still be reported to the previous callback.
+ */
+/* @[declare_taskpool_setlatejobcallback] */
+IotTaskPoolError_t IotTaskPool_SetLateJobCallback( IotTaskPool_t taskPool,
+                                                   IotTaskPoolLateJobCallback_t lateJobCallback,
+                                                   void * pContext );
+/* @[declare_taskpool_setlatejobcallback] */
+
 /**
  * @brief This function retrieves the current status of a job.
  *
@@ -466,6 +530,46 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPool,
                                           IotTaskPoolJobStatus_t * const pStatus );
 /* @[declare_taskpool_getstatus] */
 
+/**
+ * @brief This function retrieves the runtime statistics of a task pool.
+ *
+ * The statistics help size the task pool: long queueing delays with all threads busy call for a
+ * larger #IotTaskPoolInfo_t.maxThreads, while frequent growing and shrinking call for a larger
+ * #IotTaskPoolInfo_t.minThreads. The statistics can be encoded for export with the serializer library.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with
+ * a call to @ref IotTaskPool_Create or @ref IotTaskPool_CreateSystemTaskPool.
+ * @param[out] pStats The statistics of the task pool.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
+ *
+ * @note The statistics of each lane are consistent, but the lanes are sampled one after the other.
+ */
+/* @[declare_taskpool_getstats] */
+IotTaskPoolError_t IotTaskPool_GetStats( IotTaskPool_t taskPool,
+                                         IotTaskPoolStats_t * const pStats );
+/* @[declare_taskpool_getstats] */
+
+/**
+ * @brief This function clears the counters and histograms in the runtime statistics of a task pool.
+ *
+ * Use this function to take statistics over a window of time. Gauges are not affected.
+ *
+ * @param[in] taskPool A handle to the task pool that must have been previously initialized with
+ * a call to @ref IotTaskPool_Create or @ref IotTaskPool_CreateSystemTaskPool.
+ *
+ * @return One of the following:
+ * - #IOT_TASKPOOL_SUCCESS
+ * - #IOT_TASKPOOL_BAD_PARAMETER
+ * - #IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS
+ */
+/* @[declare_taskpool_resetstats] */
+IotTaskPoolError_t IotTaskPool_ResetStats( IotTaskPool_t taskPool );
+/* @[declare_taskpool_resetstats] */
+
 /**
  * @brief This function tries to cancel a job that was previously scheduled with @ref IotTaskPool_Schedule.
  *
@@ -555,4 +659,51 @@ const char * IotTaskPool_strerror( IotTaskPoolError_t status );
     #define IOT_TASKPOOL_JOB_WAIT_TIMEOUT_MS    ( 60 * 1000UL )
 #endif
 
+/**
+ * @brief The maximum number of dispatch lanes in a task pool. A task pool uses as many lanes as
+ * its minimum number of threads, up to this limit.
+ */
+#ifndef IOT_TASKPOOL_DISPATCH_QUEUES
+    #define IOT_TASKPOOL_DISPATCH_QUEUES    ( 4UL )
+#endif
+
+/**
+ * @brief The resolution in milliseconds of the timer wheel for deferred jobs. Deferred jobs that
+ * expire within the same tick are dispatched by the same timer wakeup.
+ */
+#ifndef IOT_TASKPOOL_TIMER_WHEEL_TICK_MS
+    #define IOT_TASKPOOL_TIMER_WHEEL_TICK_MS    ( 10UL )
+#endif
+
+/**
+ * @brief The base 2 logarithm of the number of slots in each level of the timer wheel for deferred jobs.
+ */
+#ifndef IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS
+    #define IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS    ( 5UL )
+#endif
+
+/**
+ * @brief The number of #IOT_TASKPOOL_CLASS_CONTROL jobs a lane dequeues in a row before the lower
+ * classes get a turn.
+ */
+#ifndef IOT_TASKPOOL_CLASS_CONTROL_WEIGHT
+    #define IOT_TASKPOOL_CLASS_CONTROL_WEIGHT    ( 8UL )
+#endif
+
+/**
+ * @brief The number of #IOT_TASKPOOL_CLASS_DEFAULT jobs a lane dequeues in a row before
+ * #IOT_TASKPOOL_CLASS_BULK jobs get a turn.
+ */
+#ifndef IOT_TASKPOOL_CLASS_DEFAULT_WEIGHT
+    #define IOT_TASKPOOL_CLASS_DEFAULT_WEIGHT    ( 4UL )
+#endif
+
+/**
+ * @brief The number of #IOT_TASKPOOL_CLASS_BULK jobs a lane dequeues in a row when the higher
+ * classes are busy.
+ */
+#ifndef IOT_TASKPOOL_CLASS_BULK_WEIGHT
+    #define IOT_TASKPOOL_CLASS_BULK_WEIGHT    ( 1UL )
+#endif
+
 #endif /* ifndef IOT_TASKPOOL_H_ */
@@ -42,15 +42,22 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/* Slab allocator include. */
+#include "iot_slab.h"
+
 /**
  * @functionspage{static_memory,static memory component}
  * - @functionname{static_memory_function_init}
  * - @functionname{static_memory_function_cleanup}
  * - @functionname{static_memory_function_findfree}
  * - @functionname{static_memory_function_returninuse}
+ * - @functionname{static_memory_function_alloc}
+ * - @functionname{static_memory_function_free}
+ * - @functionname{static_memory_function_getstats}
  * - @functionname{static_memory_function_messagebuffersize}
  * - @functionname{static_memory_function_mallocmessagebuffer}
  * - @functionname{static_memory_function_freemessagebuffer}
+ * - @functionname{static_memory_function_messagebufferstats}
  */
 
 /*----------------------- Initialization and cleanup ------------------------*/
@@ -196,12 +203,86 @@ void IotStaticMemory_ReturnInUse( void * ptr,
                                   size_t elementSize );
 /* @[declare_static_memory_returninuse] */
 
+/*-------------------------- Slab allocation and free -----------------------*/
+
+/**
+ * @functionpage{IotStaticMemory_Alloc,static_memory,alloc}
+ * @functionpage{IotStaticMemory_Free,static_memory,free}
+ * @functionpage{IotStaticMemory_GetStats,static_memory,getstats}
+ */
+
+/**
+ * @brief Allocate a block from a set of statically-allocated size classes.
+ *
+ * Unlike @ref static_memory_function_findfree, this function takes O(1) time
+ * in the number of buffers. It is a thread-safe wrapper of @ref slab_function_alloc.
+ *
+ * @param[in] pSlabs The size classes, sorted by increasing block size.
+ * @param[in] classCount The number of slabs in `pSlabs`.
+ * @param[in] size The number of bytes required.
+ *
+ * @return A zeroed block of at least `size` bytes; `NULL` if no class can
+ * satisfy the request.
+ *
+ * <b>Example</b>:
+ * @code{c}
+ * #define NUMBER_OF_OBJECTS    ...
+ * static uint8_t _pObjects[ NUMBER_OF_OBJECTS ][ sizeof( Object_t ) ] = { { 0 } };
+ * static IotSlab_t _objectSlab = IOT_SLAB_INITIALIZER( _pObjects, sizeof( Object_t ), NUMBER_OF_OBJECTS );
+ *
+ * void * Iot_MallocObject( size_t size )
+ * {
+ *     return IotStaticMemory_Alloc( &_objectSlab, 1, size );
+ * }
+ *
+ * void Iot_FreeObject( void * ptr )
+ * {
+ *     IotStaticMemory_Free( &_objectSlab, 1, ptr );
+ * }
+ * @endcode
+ */
+/* @[declare_static_memory_alloc] */
+void * IotStaticMemory_Alloc( IotSlab_t * pSlabs,
+                             size_t classCount,
+                             size_t size );
+/* @[declare_static_memory_alloc] */
+
+/**
+ * @brief Return a block allocated with @ref static_memory_function_alloc.
+ *
+ * The block is cleared before it is returned. Pointers that are not blocks
+ * of `pSlabs` are ignored.
+ *
+ * @param[in] pSlabs The size classes that `ptr` was allocated from.
+ * @param[in] classCount The number of slabs in `pSlabs`.
+ * @param[in] ptr The block to free.
+ */
+/* @[declare_static_memory_free] */
+void IotStaticMemory_Free( IotSlab_t * pSlabs,
+                           size_t classCount,
+                           void * ptr );
+/* @[declare_static_memory_free] */
+
+/**
+ * @brief Get the usage statistics of a set of statically-allocated size classes.
+ *
+ * @param[in] pSlabs The size classes.
+ * @param[in] classCount The number of slabs in `pSlabs`.
+ * @param[out] pStats Receives one #IotSlabStats_t per slab.
+ */
+/* @[declare_static_memory_getstats] */
+void IotStaticMemory_GetStats( const IotSlab_t * pSlabs,
+                               size_t classCount,
+                               IotSlabStats_t * pStats );
+/* @[declare_static_memory_getstats] */
+
 /*------------------------ Message buffer management ------------------------*/
 
 /**
  * @functionpage{Iot_MessageBufferSize,static_memory,messagebuffersize}
  * @functionpage{Iot_MallocMessageBuffer,static_memory,mallocmessagebuffer}
  * @functionpage{Iot_FreeMessageBuffer,static_memory,freemessagebuffer}
+ * @functionpage{Iot_MessageBufferStats,static_memory,messagebufferstats}
  */
 
 /**
@@ -226,6 +307,9 @@ size_t Iot_MessageBufferSize( void );
  *
  * @param[in] size Requested size for a message buffer.
  *
+ * If [size classes](@ref IOT_MESSAGE_BUFFER_SIZE_CLASSES) are enabled, the
+ * buffer is taken from the smallest class that fits `size` and has a free buffer.
+ *
  * @return Pointer to the start of a message buffer. If the `size` argument is larger
  * than the [fixed size of a message buffer](@ref IOT_MESSAGE_BUFFER_SIZE)
  * or no message buffers are available, `NULL` is returned.
@@ -246,5 +330,21 @@ void * Iot_MallocMessageBuffer( size_t size );
 /* @[declare_static_memory_freemessagebuffer] */
 void Iot_FreeMessageBuffer( void * ptr );
 /* @[declare_static_memory_freemessagebuffer] */
+
+/**
+ * @brief Get the usage statistics of the message buffers.
+ *
+ * One #IotSlabStats_t is returned per message buffer size class, in increasing
+ * size. There is a single class unless @ref IOT_MESSAGE_BUFFER_SIZE_CLASSES is `1`.
+ *
+ * @param[out] pStats Receives the statistics of each size class.
+ * @param[in] maxClasses The number of entries in `pStats`.
+ *
+ * @return The number of entries written to `pStats`.
+ */
+/* @[declare_static_memory_messagebufferstats] */
+size_t Iot_MessageBufferStats( IotSlabStats_t * pStats,
+                               size_t maxClasses );
+/* @[declare_static_memory_messagebufferstats] */
  
 #endif /* if !defined( IOT_STATIC_MEMORY_H_ ) && ( IOT_STATIC_MEMORY_ONLY == 1 ) */
@@ -217,6 +217,42 @@
  * A macros to manage task pool memory allocation.
  */
 #define IOT_TASK_POOL_INTERNAL_STATIC    ( ( uint32_t ) 0x00000001 )      /* Flag to mark a job as user-allocated. */
+#define IOT_TASK_POOL_INTERNAL_PINNED    ( ( uint32_t ) 0x00000002 )      /* Flag to mark a job as not eligible for stealing. */
+/** @endcond */
+
+#if IOT_TASKPOOL_DISPATCH_QUEUES < 1
+    #error "IOT_TASKPOOL_DISPATCH_QUEUES cannot be 0 or negative."
+#endif
+
+#if IOT_TASKPOOL_TIMER_WHEEL_TICK_MS < 1
+    #error "IOT_TASKPOOL_TIMER_WHEEL_TICK_MS cannot be 0 or negative."
+#endif
+
+#if ( IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS < 1 ) || ( IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS > 16 )
+    #error "IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS must be between 1 and 16."
+#endif
+
+#if ( IOT_TASKPOOL_CLASS_CONTROL_WEIGHT < 1 ) || ( IOT_TASKPOOL_CLASS_DEFAULT_WEIGHT < 1 ) || ( IOT_TASKPOOL_CLASS_BULK_WEIGHT < 1 )
+    #error "The weights of the task pool job classes cannot be 0 or negative."
+#endif
+
+/**
+ * @cond DOXYGEN_IGNORE
+ * Doxygen should ignore this section.
+ *
+ * The number of job classes, see #IotTaskPoolJobClass_t.
+ */
+#define TASKPOOL_JOB_CLASSES    ( 3U )
+/** @endcond */
+
+/**
+ * @cond DOXYGEN_IGNORE
+ * Doxygen should ignore this section.
+ *
+ * The geometry of the timer wheel for deferred jobs.
+ */
+#define TASKPOOL_TIMER_WHEEL_LEVELS    ( 3U )                                           /* Number of levels of the timer wheel. */
+#define TASKPOOL_TIMER_WHEEL_SLOTS     ( 1U << IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS )     /* Number of slots in each level. */
 /** @endcond */
 
 /**
@@ -232,6 +268,53 @@ typedef struct _taskPoolCache
     uint32_t freeCount;       /**< @brief A counter to track the number of jobs in the cache. */
 } _taskPoolCache_t;
 
+/**
+ * @brief A dispatch lane: a queue of jobs and the set of worker threads bound to it.
+ *
+ * Workers dequeue from their own lane first and steal from the other lanes when their own lane
+ * is empty. Within a lane, jobs are dequeued by class in weighted round robin order. The lane lock
+ * protects the dispatch queues, the credits, the job counters, the queue statistics and the status of
+ * the jobs in the queues; it is always acquired after the task pool lock, never before.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolLane
+{
+    IotDeQueue_t dispatchQueues[ TASKPOOL_JOB_CLASSES ]; /**< @brief The queues for the jobs waiting to be executed, one per job class. */
+    uint32_t credits[ TASKPOOL_JOB_CLASSES ];            /**< @brief The jobs each class may still dequeue in the current round. */
+    uint32_t activeJobs;                                 /**< @brief The number of jobs queued in, or executing on, this lane. */
+    uint32_t workers;                                    /**< @brief The number of worker threads bound to this lane, protected by the task pool lock. */
+    uint32_t queuedJobs;                                 /**< @brief The number of jobs in the dispatch queues. */
+    uint32_t peakQueuedJobs;                             /**< @brief The highest number of jobs in the dispatch queues since the statistics were reset. */
+    IotTaskPoolHistogram_t queueDelay;                   /**< @brief The time the jobs executed by this lane waited in a dispatch queue. */
+    IotTaskPoolHistogram_t executionTime;                /**< @brief The time the jobs executed by this lane took to execute. */
+    IotSemaphore_t dispatchSignal;                       /**< @brief The synchronization object on which the lane workers are waiting for incoming jobs. */
+    IotMutex_t lock;                                     /**< @brief The lock to protect the lane data structure access. */
+    struct _taskPool * pTaskPool;                        /**< @brief The task pool this lane belongs to. */
+} _taskPoolLane_t;
+
+/**
+ * @brief A hierarchical timer wheel for the deferred jobs of a task pool.
+ *
+ * Slot `i` of level `n` holds the timer events that expire in the `i`-th span of
+ * #TASKPOOL_TIMER_WHEEL_SLOTS<sup>n</sup> ticks of the current span of the level above. Level 0
+ * slots are expired one tick at a time; the slots of the upper levels are cascaded into the lower
+ * levels when the current tick reaches them. Inserting and removing a timer event take constant time.
+ *
+ * @warning This is a system-level data type that should not be modified or used directly in any application.
+ * @warning This is a system-level data type that can and will change across different versions of the platform, with no regards for backward compatibility.
+ *
+ */
+typedef struct _taskPoolTimerWheel
+{
+    IotListDouble_t slots[ TASKPOOL_TIMER_WHEEL_LEVELS ][ TASKPOOL_TIMER_WHEEL_SLOTS ]; /**< @brief The timer events, by level and slot. */
+    uint32_t pending[ TASKPOOL_TIMER_WHEEL_LEVELS ];                                   /**< @brief The number of timer events in each level. */
+    uint64_t currentTick;                                                              /**< @brief The last tick processed. */
+    uint64_t armedTick;                                                                /**< @brief The tick the task pool timer is armed for, or `UINT64_MAX`. */
+} _taskPoolTimerWheel_t;
+
 /**
  * @brief The task pool data structure keeps track of the internal state and the signals for the dispatcher threads.
  * The task pool is a thread safe data structure.
@@ -242,19 +325,23 @@ typedef struct _taskPoolCache
  */
 typedef struct _taskPool
 {
-    IotDeQueue_t dispatchQueue;      /**< @brief The queue for the jobs waiting to be executed. */
-    IotListDouble_t timerEventsList; /**< @brief The timeouts queue for all deferred jobs waiting to be executed. */
-    _taskPoolCache_t jobsCache;      /**< @brief A cache to re-use jobs in order to limit memory allocations. */
-    uint32_t minThreads;             /**< @brief The minimum number of threads for the task pool. */
-    uint32_t maxThreads;             /**< @brief The maximum number of threads for the task pool. */
-    uint32_t activeThreads;          /**< @brief The number of threads in the task pool at any given time. */
-    uint32_t activeJobs;             /**< @brief The number of active jobs in the task pool at any given time. */
-    uint32_t stackSize;              /**< @brief The stack size for all task pool threads. */
-    int32_t priority;                /**< @brief The priority for all task pool threads. */
-    IotSemaphore_t dispatchSignal;   /**< @brief The synchronization object on which threads are waiting for incoming jobs. */
-    IotSemaphore_t startStopSignal;  /**< @brief The synchronization object for threads to signal start and stop condition. */
-    IotTimer_t timer;                /**< @brief The timer for deferred jobs. */
-    IotMutex_t lock;                 /**< @brief The lock to protect the task pool data structure access. */
+    _taskPoolLane_t lanes[ IOT_TASKPOOL_DISPATCH_QUEUES ]; /**< @brief The dispatch lanes, only the first #_taskPool_t.laneCount are in use. */
+    uint32_t laneCount;                                    /**< @brief The number of dispatch lanes in use. */
+    uint32_t nextLane;                                     /**< @brief The count of the jobs dispatched without an affinity hint, updated atomically; selects their lane. */
+    uint32_t activeJobs;                                   /**< @brief The number of jobs queued in, or executing on, all lanes, updated atomically. */
+    _taskPoolTimerWheel_t timerWheel;                      /**< @brief The timer wheel for all deferred jobs waiting to be executed. */
+    _taskPoolCache_t jobsCache;                            /**< @brief A cache to re-use jobs in order to limit memory allocations. */
+    uint32_t minThreads;                                   /**< @brief The minimum number of threads for the task pool. */
+    uint32_t maxThreads;                                   /**< @brief The maximum number of threads for the task pool. */
+    uint32_t activeThreads;                                /**< @brief The number of threads in the task pool at any given time. */
+    uint32_t stackSize;                                    /**< @brief The stack size for all task pool threads. */
+    int32_t priority;                                      /**< @brief The priority for all task pool threads. */
+    IotSemaphore_t startStopSignal;                        /**< @brief The synchronization object for threads to signal start and stop condition. */
+    IotTimer_t timer;                                      /**< @brief The timer for deferred jobs. */
+    IotMutex_t lock;                                       /**< @brief The lock to protect the task pool data structure access. */
+    IotTaskPoolLateJobCallback_t lateJobCallback;          /**< @brief The callback to report late jobs. */
+    void * pLateJobContext;                                /**< @brief The context for #_taskPool_t.lateJobCallback. */
+    IotTaskPoolStats_t stats;                              /**< @brief The thread, cache and timer statistics; the queue statistics are kept by the lanes. */
 } _taskPool_t;
 
 /**
@@ -266,24 +353,39 @@ typedef struct _taskPool
  */
 typedef struct _taskPoolJob
 {
-    IotLink_t link;                    /**< @brief The link to insert the job in the dispatch queue. */
-    IotTaskPoolRoutine_t userCallback; /**< @brief The user provided callback. */
-    void * pUserContext;               /**< @brief The user provided context. */
-    uint32_t flags;                    /**< @brief Internal flags. */
-    IotTaskPoolJobStatus_t status;     /**< @brief The status for the job. */
+    IotLink_t link;                           /**< @brief The link to insert the job in the dispatch queue. */
+    IotTaskPoolRoutine_t userCallback;        /**< @brief The user provided callback. */
+    void * pUserContext;                      /**< @brief The user provided context. */
+    uint32_t flags;                           /**< @brief Internal flags. */
+    IotTaskPoolJobStatus_t status;            /**< @brief The status for the job. */
+    uint32_t lane;                            /**< @brief The lane the job was last dispatched to. */
+    struct _taskPoolTimerEvent * pTimerEvent; /**< @brief The timer event of a deferred job, or `NULL`. */
+    IotTaskPoolJobClass_t jobClass;           /**< @brief The priority class of the job. */
+    uint32_t deadlineMs;                      /**< @brief The deadline of the job relative to its dispatch, or 0. */
+    uint64_t deadline;                        /**< @brief The absolute deadline of the job while it is queued, or 0. */
+    uint64_t queuedTime;                      /**< @brief When the job was last queued for execution. */
 } _taskPoolJob_t;
 
+/**
+ * @brief The times of a job completed by a worker, to record in the statistics of the worker's lane.
+ */
+typedef struct _taskPoolJobTimes
+{
+    uint32_t queueDelayMs;    /**< @brief The time the job waited in a dispatch queue. */
+    uint32_t executionTimeMs; /**< @brief The time the job took to execute. */
+} _taskPoolJobTimes_t;
+
 /**
  * @brief Represents an operation that is subject to a timer.
  *
- * These events are queued per MQTT connection. They are sorted by their
- * expiration time.
+ * These events are linked in a slot of the timer wheel of the task pool.
  */
 typedef struct _taskPoolTimerEvent
 {
     IotLink_t link;          /**< @brief List link member. */
     uint64_t expirationTime; /**< @brief When this event should be processed. */
     _taskPoolJob_t * pJob;   /**< @brief The task pool job associated with this event. */
+    uint32_t level;          /**< @brief The level of the timer wheel the event is linked in. */
 } _taskPoolTimerEvent_t;
 
 #endif /* ifndef IOT_TASKPOOL_INTERNAL_H_ */
@@ -195,6 +195,40 @@ typedef enum IotTaskPoolJobStatus
     IOT_TASKPOOL_STATUS_UNDEFINED,
 } IotTaskPoolJobStatus_t;
 
+/**
+ * @ingroup taskpool_datatypes_enums
+ * @brief Priority classes of [task pool Job](@ref IotTaskPoolJob_t).
+ *
+ * Each lane of a task pool keeps one queue per class. Workers dequeue from the
+ * classes in order of priority, but each class may only dequeue up to its weight
+ * before the lower classes get a turn, so that no class is starved.
+ *
+ * @see @ref taskpool_function_setjobclass
+ */
+typedef enum IotTaskPoolJobClass
+{
+    /**
+     * @brief Short, latency-sensitive jobs, e.g. protocol acknowledgements and keep-alive.
+     *
+     * @see @ref IOT_TASKPOOL_CLASS_CONTROL_WEIGHT
+     */
+    IOT_TASKPOOL_CLASS_CONTROL = 0,
+
+    /**
+     * @brief The class of jobs that were not assigned one, e.g. telemetry.
+     *
+     * @see @ref IOT_TASKPOOL_CLASS_DEFAULT_WEIGHT
+     */
+    IOT_TASKPOOL_CLASS_DEFAULT,
+
+    /**
+     * @brief Long-running, throughput-oriented jobs, e.g. file transfers.
+     *
+     * @see @ref IOT_TASKPOOL_CLASS_BULK_WEIGHT
+     */
+    IOT_TASKPOOL_CLASS_BULK,
+} IotTaskPoolJobClass_t;
+
 /*------------------------- Task pool types and handles --------------------------*/
 
 /**
@@ -230,6 +264,12 @@ typedef struct IotTaskPoolJobStorage
     void * dummy3;                  /**< @brief Placeholder. */
     uint32_t dummy4;                /**< @brief Placeholder. */
     IotTaskPoolJobStatus_t status;  /**< @brief Placeholder. */
+    uint32_t dummy6;                /**< @brief Placeholder. */
+    void * dummy7;                  /**< @brief Placeholder. */
+    IotTaskPoolJobClass_t dummy8;   /**< @brief Placeholder. */
+    uint32_t dummy9;                /**< @brief Placeholder. */
+    uint64_t dummy10;               /**< @brief Placeholder. */
+    uint64_t dummy11;               /**< @brief Placeholder. */
 } IotTaskPoolJobStorage_t;
 
 /**
@@ -263,6 +303,22 @@ typedef void ( * IotTaskPoolRoutine_t )( IotTaskPool_t pTaskPool,
                                          IotTaskPoolJob_t pJob,
                                          void * pUserContext );
 
+/**
+ * @ingroup taskpool_datatypes_functionpointers
+ * @brief Callback type for reporting late jobs.
+ *
+ * This callback is invoked by a task pool thread right before executing a job that missed
+ * the deadline set with @ref taskpool_function_setjobclass, with the `pContext` parameter
+ * passed to @ref taskpool_function_setlatejobcallback. The job is executed after the
+ * callback returns.
+ *
+ * `lateMs` is how many milliseconds after its deadline the job started.
+ */
+typedef void ( * IotTaskPoolLateJobCallback_t )( IotTaskPool_t pTaskPool,
+                                                 IotTaskPoolJob_t pJob,
+                                                 uint32_t lateMs,
+                                                 void * pContext );
+
 /**
  * @ingroup taskpool_datatypes_paramstructs
  * @brief Initialization information to create one task pool instance.
@@ -290,6 +346,51 @@ typedef struct IotTaskPoolInfo
     int32_t priority;    /**< @brief priority for every task pool thread. The priority for each thread is fixed after the task pool is created and cannot be changed. */
 } IotTaskPoolInfo_t;
 
+/**
+ * @brief The number of buckets of a #IotTaskPoolHistogram_t.
+ */
+#define IOT_TASKPOOL_HISTOGRAM_BUCKETS    ( 16 )
+
+/**
+ * @ingroup taskpool_datatypes_structs
+ * @brief A histogram of durations in milliseconds, with logarithmic buckets.
+ *
+ * Bucket 0 counts the durations shorter than 1 ms, and bucket `i` counts the durations
+ * of at least 2<sup>i-1</sup> ms and shorter than 2<sup>i</sup> ms. The last bucket
+ * also counts all the longer durations.
+ */
+typedef struct IotTaskPoolHistogram
+{
+    uint32_t count;                                      /**< @brief The number of durations recorded. */
+    uint32_t maxMs;                                      /**< @brief The longest duration recorded. */
+    uint64_t sumMs;                                      /**< @brief The sum of all durations recorded, to compute the mean. */
+    uint32_t buckets[ IOT_TASKPOOL_HISTOGRAM_BUCKETS ]; /**< @brief The number of durations recorded in each bucket. */
+} IotTaskPoolHistogram_t;
+
+/**
+ * @ingroup taskpool_datatypes_structs
+ * @brief Runtime statistics of a task pool instance.
+ *
+ * Returned by @ref taskpool_function_getstats. Counters and histograms accumulate from the
+ * creation of the task pool, or from the last call to @ref taskpool_function_resetstats.
+ * Gauges reflect the state of the task pool when the statistics were taken.
+ */
+typedef struct IotTaskPoolStats
+{
+    uint32_t queuedJobs;                  /**< @brief Gauge of the jobs waiting in the dispatch queues. */
+    uint32_t peakQueuedJobs;              /**< @brief The highest number of jobs waiting in the dispatch queues of one lane. */
+    uint32_t deferredJobs;                /**< @brief Gauge of the deferred jobs waiting for their timer. */
+    uint32_t activeThreads;               /**< @brief Gauge of the worker threads. */
+    uint32_t threadsCreated;              /**< @brief The number of worker threads the task pool grew by. */
+    uint32_t threadsExited;               /**< @brief The number of worker threads the task pool shrank by. */
+    uint32_t threadCreateFailures;        /**< @brief The number of times the task pool failed to grow. */
+    uint32_t cacheHits;                   /**< @brief The number of recyclable jobs taken from the jobs cache. */
+    uint32_t cacheMisses;                 /**< @brief The number of recyclable jobs allocated because the jobs cache was empty. */
+    IotTaskPoolHistogram_t queueDelay;    /**< @brief The time jobs waited in a dispatch queue before starting. */
+    IotTaskPoolHistogram_t executionTime; /**< @brief The time jobs took to execute. */
+    IotTaskPoolHistogram_t timerLateness; /**< @brief The time deferred jobs were queued after their timer expired. */
+} IotTaskPoolStats_t;
+
 /*------------------------- TASKPOOL defined constants --------------------------*/
 
 /**
@@ -337,7 +438,7 @@ typedef struct IotTaskPoolInfo
 /** @brief Initializer for a #IotTaskPool_t. */
 #define IOT_TASKPOOL_INITIALIZER                NULL           
 /** @brief Initializer for a #IotTaskPoolJobStorage_t. */
-#define IOT_TASKPOOL_JOB_STORAGE_INITIALIZER    { { NULL, NULL }, NULL, NULL, 0, IOT_TASKPOOL_STATUS_UNDEFINED }              
+#define IOT_TASKPOOL_JOB_STORAGE_INITIALIZER    { { NULL, NULL }, NULL, NULL, 0, IOT_TASKPOOL_STATUS_UNDEFINED, 0, NULL, IOT_TASKPOOL_CLASS_DEFAULT, 0, 0, 0 }           
 /** @brief Initializer for a #IotTaskPoolJob_t. */
 #define IOT_TASKPOOL_JOB_INITIALIZER            NULL                                                                                                                    
 /* @[define_taskpool_initializers] */
@@ -351,6 +452,19 @@ typedef struct IotTaskPoolInfo
  */
 #define IOT_TASKPOOL_JOB_HIGH_PRIORITY    ( ( uint32_t ) 0x00000001 )
 
+/**
+ * @brief Flag for scheduling a job with an affinity hint.
+ *
+ * Jobs scheduled with the same `key` are always dispatched to the same lane of the task pool, and
+ * are never stolen by workers of other lanes. Use this to keep related jobs, e.g. all the jobs of one
+ * network connection, on the same workers. Jobs without an affinity hint are spread across lanes.
+ *
+ * Only the lower 16 bits of `key` are used. This flag can be combined with #IOT_TASKPOOL_JOB_HIGH_PRIORITY.
+ *
+ * @see @ref IOT_TASKPOOL_DISPATCH_QUEUES
+ */
+#define IOT_TASKPOOL_JOB_AFFINITY( key )    ( ( ( uint32_t ) 0x00000002 ) | ( ( ( uint32_t ) ( key ) & 0xFFFFUL ) << 16 ) )
+
 /**
  * @brief Allows the use of the handle to the system task pool.
  *
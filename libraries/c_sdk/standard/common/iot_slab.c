@@ -0,0 +1,175 @@
+/*
+ * Amazon FreeRTOS Common V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_slab.c
+ * @brief Implementation of the slab allocator in iot_slab.h
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* Slab include. */
+#include "iot_slab.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take a block from a single slab.
+ *
+ * @param[in] pSlab The slab to allocate from.
+ *
+ * @return A free block; `NULL` if the slab is empty.
+ */
+static void * _takeBlock( IotSlab_t * pSlab );
+
+/*-----------------------------------------------------------*/
+
+static void * _takeBlock( IotSlab_t * pSlab )
+{
+    void * pBlock = NULL;
+
+    if( pSlab->pFreeList != NULL )
+    {
+        /* Pop the free list. The link is copied out of the block, as blocks in
+         * byte arrays may not be aligned for a pointer. */
+        pBlock = pSlab->pFreeList;
+        ( void ) memcpy( &( pSlab->pFreeList ), pBlock, sizeof( void * ) );
+        ( void ) memset( pBlock, 0x00, sizeof( void * ) );
+    }
+    else if( pSlab->nextUnused < pSlab->blockCount )
+    {
+        /* Blocks that were never handed out are not on the free list, so that
+         * a statically-initialized slab needs no setup. */
+        pBlock = pSlab->pBlocks + ( pSlab->nextUnused * pSlab->blockSize );
+        pSlab->nextUnused++;
+    }
+
+    if( pBlock != NULL )
+    {
+        pSlab->inUse++;
+
+        if( pSlab->inUse > pSlab->highWater )
+        {
+            pSlab->highWater = pSlab->inUse;
+        }
+    }
+
+    return pBlock;
+}
+
+/*-----------------------------------------------------------*/
+
+void * IotSlab_Alloc( IotSlab_t * pSlabs,
+                      size_t classCount,
+                      size_t size )
+{
+    size_t i = 0;
+    bool smallestFit = true;
+    void * pBlock = NULL;
+
+    for( i = 0; ( i < classCount ) && ( pBlock == NULL ); i++ )
+    {
+        if( pSlabs[ i ].blockSize >= size )
+        {
+            pBlock = _takeBlock( &( pSlabs[ i ] ) );
+
+            /* Count a failure against the class this allocation should have
+             * come from, whether or not a larger class satisfies it. */
+            if( ( pBlock == NULL ) && ( smallestFit == true ) )
+            {
+                pSlabs[ i ].failures++;
+            }
+
+            smallestFit = false;
+        }
+    }
+
+    return pBlock;
+}
+
+/*-----------------------------------------------------------*/
+
+IotSlab_t * IotSlab_Find( IotSlab_t * pSlabs,
+                          size_t classCount,
+                          const void * ptr )
+{
+    size_t i = 0, offset = 0;
+    IotSlab_t * pOwner = NULL;
+    const uint8_t * pBlock = ptr;
+
+    for( i = 0; i < classCount; i++ )
+    {
+        if( ( pBlock >= pSlabs[ i ].pBlocks ) &&
+            ( pBlock < pSlabs[ i ].pBlocks + ( pSlabs[ i ].blockSize * pSlabs[ i ].blockCount ) ) )
+        {
+            offset = ( size_t ) ( pBlock - pSlabs[ i ].pBlocks );
+
+            /* Only the start of a block may be freed. */
+            if( ( offset % pSlabs[ i ].blockSize ) == 0 )
+            {
+                pOwner = &( pSlabs[ i ] );
+            }
+
+            break;
+        }
+    }
+
+    return pOwner;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotSlab_Free( IotSlab_t * pSlab,
+                   void * ptr )
+{
+    /* Push the block onto the free list. */
+    ( void ) memcpy( ptr, &( pSlab->pFreeList ), sizeof( void * ) );
+    pSlab->pFreeList = ptr;
+    pSlab->inUse--;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotSlab_GetStats( const IotSlab_t * pSlabs,
+                       size_t classCount,
+                       IotSlabStats_t * pStats )
+{
+    size_t i = 0;
+
+    for( i = 0; i < classCount; i++ )
+    {
+        pStats[ i ].blockSize = pSlabs[ i ].blockSize;
+        pStats[ i ].blockCount = pSlabs[ i ].blockCount;
+        pStats[ i ].inUse = pSlabs[ i ].inUse;
+        pStats[ i ].highWater = pSlabs[ i ].highWater;
+        pStats[ i ].failures = pSlabs[ i ].failures;
+    }
+}
+
+/*-----------------------------------------------------------*/
@@ -46,6 +46,9 @@
 /* Static memory include. */
 #include "private/iot_static_memory.h"
 
+/* Slab allocator include. */
+#include "iot_slab.h"
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -55,10 +58,30 @@
  * Provide default values for undefined configuration constants.
  */
 #ifndef IOT_MESSAGE_BUFFERS
-    #define IOT_MESSAGE_BUFFERS        ( 8 )
+    #define IOT_MESSAGE_BUFFERS               ( 8 )
 #endif
 #ifndef IOT_MESSAGE_BUFFER_SIZE
-    #define IOT_MESSAGE_BUFFER_SIZE    ( 1024 )
+    #define IOT_MESSAGE_BUFFER_SIZE           ( 1024 )
+#endif
+#ifndef IOT_MESSAGE_BUFFER_SIZE_CLASSES
+    #define IOT_MESSAGE_BUFFER_SIZE_CLASSES    ( 0 )
+#endif
+#if IOT_MESSAGE_BUFFER_SIZE_CLASSES == 1
+    #ifndef IOT_MESSAGE_BUFFERS_SMALL
+        #define IOT_MESSAGE_BUFFERS_SMALL          ( 8 )
+    #endif
+    #ifndef IOT_MESSAGE_BUFFER_SMALL_SIZE
+        #define IOT_MESSAGE_BUFFER_SMALL_SIZE      ( 32 )
+    #endif
+    #ifndef IOT_MESSAGE_BUFFERS_MEDIUM
+        #define IOT_MESSAGE_BUFFERS_MEDIUM         ( 4 )
+    #endif
+    #ifndef IOT_MESSAGE_BUFFER_MEDIUM_SIZE
+        #define IOT_MESSAGE_BUFFER_MEDIUM_SIZE     ( 256 )
+    #endif
+    #ifndef IOT_MESSAGE_BUFFERS_LARGE
+        #define IOT_MESSAGE_BUFFERS_LARGE          ( 2 )
+    #endif
 #endif
 /** @endcond */
 
@@ -66,8 +89,19 @@
 #if IOT_MESSAGE_BUFFERS <= 0
     #error "IOT_MESSAGE_BUFFERS cannot be 0 or negative."
 #endif
-#if IOT_MESSAGE_BUFFER_SIZE <= 0
-    #error "IOT_MESSAGE_BUFFER_SIZE cannot be 0 or negative."
+#if IOT_MESSAGE_BUFFER_SIZE < 8
+    #error "IOT_MESSAGE_BUFFER_SIZE cannot be less than 8."
+#endif
+#if IOT_MESSAGE_BUFFER_SIZE_CLASSES == 1
+    #if ( IOT_MESSAGE_BUFFERS_SMALL <= 0 ) || ( IOT_MESSAGE_BUFFERS_MEDIUM <= 0 ) || ( IOT_MESSAGE_BUFFERS_LARGE <= 0 )
+        #error "IOT_MESSAGE_BUFFERS_SMALL, IOT_MESSAGE_BUFFERS_MEDIUM, and IOT_MESSAGE_BUFFERS_LARGE cannot be 0 or negative."
+    #endif
+    #if IOT_MESSAGE_BUFFER_SMALL_SIZE < 8
+        #error "IOT_MESSAGE_BUFFER_SMALL_SIZE cannot be less than 8."
+    #endif
+    #if ( IOT_MESSAGE_BUFFER_MEDIUM_SIZE <= IOT_MESSAGE_BUFFER_SMALL_SIZE ) || ( IOT_MESSAGE_BUFFER_SIZE <= IOT_MESSAGE_BUFFER_MEDIUM_SIZE )
+        #error "Message buffer size classes must be in increasing order: IOT_MESSAGE_BUFFER_SMALL_SIZE, IOT_MESSAGE_BUFFER_MEDIUM_SIZE, IOT_MESSAGE_BUFFER_SIZE."
+    #endif
 #endif
 
 /*-----------------------------------------------------------*/
@@ -78,10 +112,38 @@
 static IotMutex_t _mutex;
 
 /*
- * Static memory buffers and flags, allocated and zeroed at compile-time.
+ * Static memory buffers, allocated and zeroed at compile-time.
+ */
+#if IOT_MESSAGE_BUFFER_SIZE_CLASSES == 1
+    static char _pSmallMessageBuffers[ IOT_MESSAGE_BUFFERS_SMALL ][ IOT_MESSAGE_BUFFER_SMALL_SIZE ] = { { 0 } };    /**< @brief Small message buffers. */
+    static char _pMediumMessageBuffers[ IOT_MESSAGE_BUFFERS_MEDIUM ][ IOT_MESSAGE_BUFFER_MEDIUM_SIZE ] = { { 0 } }; /**< @brief Medium message buffers. */
+    static char _pMessageBuffers[ IOT_MESSAGE_BUFFERS_LARGE ][ IOT_MESSAGE_BUFFER_SIZE ] = { { 0 } };               /**< @brief Large message buffers. */
+
+/**
+ * @brief Message buffer size classes, in increasing size.
+ */
+    static IotSlab_t _pMessageBufferSlabs[] =
+    {
+        IOT_SLAB_INITIALIZER( _pSmallMessageBuffers, IOT_MESSAGE_BUFFER_SMALL_SIZE, IOT_MESSAGE_BUFFERS_SMALL ),
+        IOT_SLAB_INITIALIZER( _pMediumMessageBuffers, IOT_MESSAGE_BUFFER_MEDIUM_SIZE, IOT_MESSAGE_BUFFERS_MEDIUM ),
+        IOT_SLAB_INITIALIZER( _pMessageBuffers, IOT_MESSAGE_BUFFER_SIZE, IOT_MESSAGE_BUFFERS_LARGE )
+    };
+#else
+    static char _pMessageBuffers[ IOT_MESSAGE_BUFFERS ][ IOT_MESSAGE_BUFFER_SIZE ] = { { 0 } }; /**< @brief Message buffers. */
+
+/**
+ * @brief Message buffers, in a single size class.
+ */
+    static IotSlab_t _pMessageBufferSlabs[] =
+    {
+        IOT_SLAB_INITIALIZER( _pMessageBuffers, IOT_MESSAGE_BUFFER_SIZE, IOT_MESSAGE_BUFFERS )
+    };
+#endif /* if IOT_MESSAGE_BUFFER_SIZE_CLASSES == 1 */
+
+/**
+ * @brief The number of message buffer size classes.
  */
-static bool _pInUseMessageBuffers[ IOT_MESSAGE_BUFFERS ] = { 0 };                           /**< @brief Message buffer in-use flags. */
-static char _pMessageBuffers[ IOT_MESSAGE_BUFFERS ][ IOT_MESSAGE_BUFFER_SIZE ] = { { 0 } }; /**< @brief Message buffers. */
+#define MESSAGE_BUFFER_CLASSES    ( sizeof( _pMessageBufferSlabs ) / sizeof( _pMessageBufferSlabs[ 0 ] ) )
 
 /*-----------------------------------------------------------*/
 
@@ -149,6 +211,56 @@ void IotStaticMemory_ReturnInUse( void * ptr,
 
 /*-----------------------------------------------------------*/
 
+void * IotStaticMemory_Alloc( IotSlab_t * pSlabs,
+                             size_t classCount,
+                             size_t size )
+{
+    void * pBlock = NULL;
+
+    IotMutex_Lock( &( _mutex ) );
+    pBlock = IotSlab_Alloc( pSlabs, classCount, size );
+    IotMutex_Unlock( &( _mutex ) );
+
+    return pBlock;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotStaticMemory_Free( IotSlab_t * pSlabs,
+                           size_t classCount,
+                           void * ptr )
+{
+    IotSlab_t * pOwner = NULL;
+
+    IotMutex_Lock( &( _mutex ) );
+
+    /* Ignore pointers that are not from pSlabs, as IotStaticMemory_ReturnInUse
+     * does. Blocks are cleared when returned so that they are zeroed when next
+     * allocated. */
+    pOwner = IotSlab_Find( pSlabs, classCount, ptr );
+
+    if( pOwner != NULL )
+    {
+        ( void ) memset( ptr, 0x00, pOwner->blockSize );
+        IotSlab_Free( pOwner, ptr );
+    }
+
+    IotMutex_Unlock( &( _mutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void IotStaticMemory_GetStats( const IotSlab_t * pSlabs,
+                               size_t classCount,
+                               IotSlabStats_t * pStats )
+{
+    IotMutex_Lock( &( _mutex ) );
+    IotSlab_GetStats( pSlabs, classCount, pStats );
+    IotMutex_Unlock( &( _mutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
 bool IotStaticMemory_Init( void )
 {
     return IotMutex_Create( &( _mutex ), false );
@@ -172,23 +284,10 @@ size_t Iot_MessageBufferSize( void )
 
 void * Iot_MallocMessageBuffer( size_t size )
 {
-    int32_t freeIndex = -1;
-    void * pNewBuffer = NULL;
-
-    /* Check that size is within the fixed message buffer size. */
-    if( size <= IOT_MESSAGE_BUFFER_SIZE )
-    {
-        /* Get the index of a free message buffer. */
-        freeIndex = IotStaticMemory_FindFree( _pInUseMessageBuffers,
-                                              IOT_MESSAGE_BUFFERS );
-
-        if( freeIndex != -1 )
-        {
-            pNewBuffer = &( _pMessageBuffers[ freeIndex ][ 0 ] );
-        }
-    }
-
-    return pNewBuffer;
+    /* Take the buffer from the smallest size class that fits. */
+    return IotStaticMemory_Alloc( _pMessageBufferSlabs,
+                                  MESSAGE_BUFFER_CLASSES,
+                                  size );
 }
 
 /*-----------------------------------------------------------*/
@@ -196,11 +295,26 @@ void * Iot_MallocMessageBuffer( size_t size )
 void Iot_FreeMessageBuffer( void * ptr )
 {
     /* Return the in-use message buffer. */
-    IotStaticMemory_ReturnInUse( ptr,
-                                 _pMessageBuffers,
-                                 _pInUseMessageBuffers,
-                                 IOT_MESSAGE_BUFFERS,
-                                 IOT_MESSAGE_BUFFER_SIZE );
+    IotStaticMemory_Free( _pMessageBufferSlabs,
+                          MESSAGE_BUFFER_CLASSES,
+                          ptr );
+}
+
+/*-----------------------------------------------------------*/
+
+size_t Iot_MessageBufferStats( IotSlabStats_t * pStats,
+                               size_t maxClasses )
+{
+    size_t classCount = MESSAGE_BUFFER_CLASSES;
+
+    if( classCount > maxClasses )
+    {
+        classCount = maxClasses;
+    }
+
+    IotStaticMemory_GetStats( _pMessageBufferSlabs, classCount, pStats );
+
+    return classCount;
 }
 
 /*-----------------------------------------------------------*/
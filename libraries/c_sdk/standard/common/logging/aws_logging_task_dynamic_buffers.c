@@ -26,7 +26,7 @@
 /* FreeRTOS includes. */
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
+#include "atomic.h"
 
 /* Logging includes. */
 #include "aws_logging_task.h"
@@ -49,8 +49,29 @@
     #error configLOGGING_INCLUDE_TIME_AND_TASK_NAME must be defined in FreeRTOSConfig.h to use this logging file.  Set configLOGGING_INCLUDE_TIME_AND_TASK_NAME to 1 to prepend a time stamp, message number and the name of the calling task to each logged message.  Otherwise set to 0.
 #endif
 
-/* A block time of 0 just means don't block. */
-#define loggingDONT_BLOCK    0
+/* States of a record in the ring buffer.  A record is zero, so neither
+ * committed nor padding, from the time it is reserved until it is committed. */
+#define loggingRECORD_COMMITTED    ( ( uint32_t ) 1 )
+#define loggingRECORD_PADDING      ( ( uint32_t ) 2 )
+
+/* Records start on multiples of the record header size, so a header always
+ * fits between the end of a record and the end of the ring buffer. */
+#define loggingRECORD_ALIGN( x )    ( ( ( x ) + sizeof( LogRecord_t ) - 1 ) & ~( sizeof( LogRecord_t ) - 1 ) )
+
+/* The size of the buffer used to report dropped messages. */
+#define loggingDROPPED_MESSAGE_LENGTH    48
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The header of a record in the ring buffer.  The NULL terminated log message
+ * follows the header.
+ */
+typedef struct LogRecord
+{
+    volatile uint32_t ulState; /* Zero, loggingRECORD_COMMITTED or loggingRECORD_PADDING. */
+    uint32_t ulSize;           /* Size of the record, header included, in bytes. */
+} LogRecord_t;
 
 /*-----------------------------------------------------------*/
 
@@ -60,21 +81,69 @@
  * outputting the log message having to wait for the message to be completely
  * written.  Using a separate task also serialises access to the output port.
  *
- * The structure of this task is very simple; it blocks on a queue to wait for
- * a pointer to a string, sending any received strings to a macro that performs
- * the actual output.  The macro is port specific, so implemented outside of
- * this file.  This version uses dynamic memory, so the buffer that contained
- * the log message is freed after it has been output.
+ * The structure of this task is very simple; it waits for a notification that
+ * records were committed to the ring buffer, then sends all the committed
+ * records, in order, to a macro that performs the actual output.  The macro is
+ * port specific, so implemented outside of this file.
  */
 static void prvLoggingTask( void * pvParameters );
 
+/*
+ * Reserve a record of xLength bytes, header included, in the ring buffer, and
+ * return the index of the record in *pulIndex.  Returns NULL and counts the
+ * message as dropped if the ring buffer is full.  Safe to call from any task
+ * or interrupt, as the reservation is a single compare and swap.
+ */
+static LogRecord_t * prvReserveRecord( size_t xLength,
+                                       uint32_t * pulIndex );
+
+/*
+ * Commit a record reserved with prvReserveRecord(), shrinking it to the xLength
+ * bytes of its message if no other record was reserved after it.  An empty
+ * message is committed as padding, so is skipped by the logging task.
+ */
+static void prvCommitRecord( LogRecord_t * pxRecord,
+                             uint32_t ulIndex,
+                             size_t xLength );
+
+/*
+ * Copy a message to the ring buffer, without notifying the logging task.
+ */
+static void prvWriteMessage( const char * pcMessage );
+
+/*
+ * Output, in order, all the records committed to the ring buffer since the last
+ * call, stopping at the first record still being written.
+ */
+static void prvDrainRecords( void );
+
 /*-----------------------------------------------------------*/
 
 /*
- * The queue used to pass pointers to log messages from the task that created
- * the message to the task that will performs the output.
+ * The ring buffer, allocated once by xLoggingTaskInitialize(), into which log
+ * messages are written by the tasks and interrupts that log, and from which the
+ * logging task outputs them.
  */
-static QueueHandle_t xQueue = NULL;
+static uint8_t * pucRingBuffer = NULL;
+static uint32_t ulRingBufferSize = 0;
+
+/*
+ * Indexes of the next record to reserve and the next record to output.  They
+ * are free running: they count the bytes reserved and output since the ring
+ * buffer was created, and are masked with the size of the ring buffer, a power
+ * of two, to find the offset of a record.  A full ring buffer is told apart from
+ * an empty one by the difference of the indexes, and an index only repeats
+ * after 4 GB of messages, so a compare and swap never succeeds on an index
+ * that was read before the ring buffer was filled and emptied again.
+ */
+static volatile uint32_t ulWriteIndex = 0;
+static volatile uint32_t ulReadIndex = 0;
+
+/* The number of messages dropped because the ring buffer was full. */
+static volatile uint32_t ulDroppedMessages = 0;
+
+/* The logging task, notified when records are committed. */
+static TaskHandle_t xLoggingTask = NULL;
 
 /*-----------------------------------------------------------*/
 
@@ -83,23 +152,38 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
                                    UBaseType_t uxQueueLength )
 {
     BaseType_t xReturn = pdFAIL;
+    uint32_t ulMinimumSize;
 
     /* Ensure the logging task has not been created already. */
-    if( xQueue == NULL )
+    if( pucRingBuffer == NULL )
     {
-        /* Create the queue used to pass pointers to strings to the logging task. */
-        xQueue = xQueueCreate( uxQueueLength, sizeof( char ** ) );
+        /* Create the ring buffer, large enough to hold uxQueueLength messages of
+         * the maximum length, rounded up to a power of two so that the indexes
+         * can be masked. */
+        ulMinimumSize = ( uint32_t ) ( uxQueueLength * loggingRECORD_ALIGN( sizeof( LogRecord_t ) + configLOGGING_MAX_MESSAGE_LENGTH ) );
+
+        ulRingBufferSize = sizeof( LogRecord_t );
+
+        while( ulRingBufferSize < ulMinimumSize )
+        {
+            ulRingBufferSize <<= 1;
+        }
 
-        if( xQueue != NULL )
+        pucRingBuffer = pvPortMalloc( ulRingBufferSize );
+
+        if( pucRingBuffer != NULL )
         {
-            if( xTaskCreate( prvLoggingTask, "Logging", usStackSize, NULL, uxPriority, NULL ) == pdPASS )
+            memset( pucRingBuffer, 0x00, ulRingBufferSize );
+
+            if( xTaskCreate( prvLoggingTask, "Logging", usStackSize, NULL, uxPriority, &xLoggingTask ) == pdPASS )
             {
                 xReturn = pdPASS;
             }
             else
             {
-                /* Could not create the task, so delete the queue again. */
-                vQueueDelete( xQueue );
+                /* Could not create the task, so delete the ring buffer again. */
+                vPortFree( pucRingBuffer );
+                pucRingBuffer = NULL;
             }
         }
     }
@@ -110,23 +194,139 @@ BaseType_t xLoggingTaskInitialize( uint16_t usStackSize,
 
 static void prvLoggingTask( void * pvParameters )
 {
-    char * pcReceivedString = NULL;
+    ( void ) pvParameters;
 
     for( ; ; )
     {
-        /* Block to wait for the next string to print. */
-        if( xQueueReceive( xQueue, &pcReceivedString, portMAX_DELAY ) == pdPASS )
+        /* Block to wait for the next records to print, then print all of them. */
+        ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        prvDrainRecords();
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvDrainRecords( void )
+{
+    LogRecord_t * pxRecord;
+    uint32_t ulIndex = ulReadIndex, ulDropped;
+    char cDroppedMessage[ loggingDROPPED_MESSAGE_LENGTH ];
+
+    while( ulIndex != ulWriteIndex )
+    {
+        pxRecord = ( LogRecord_t * ) &( pucRingBuffer[ ulIndex & ( ulRingBufferSize - 1 ) ] );
+
+        if( pxRecord->ulState == 0 )
         {
-            configPRINT_STRING( pcReceivedString );
-            vPortFree( ( void * ) pcReceivedString );
+            /* The record is still being written, its producer will notify this
+             * task again once it is committed. */
+            break;
         }
+
+        if( pxRecord->ulState == loggingRECORD_COMMITTED )
+        {
+            configPRINT_STRING( ( const char * ) ( pxRecord + 1 ) );
+        }
+
+        /* Clear the whole record, so that stale bytes are never mistaken for
+         * the header of a later record, before handing it back to the producers.
+         * The compare and swap orders the clearing before the release. */
+        ulIndex += pxRecord->ulSize;
+        memset( pxRecord, 0x00, pxRecord->ulSize );
+
+        ( void ) Atomic_CompareAndSwap_u32( &ulReadIndex, ulIndex, ulReadIndex );
+    }
+
+    /* Report the messages that could not be logged since the last report. */
+    ulDropped = Atomic_AND_u32( &ulDroppedMessages, 0 );
+
+    if( ulDropped > 0 )
+    {
+        snprintf( cDroppedMessage, sizeof( cDroppedMessage ), "%lu log messages dropped.\r\n", ( unsigned long ) ulDropped );
+        configPRINT_STRING( cDroppedMessage );
+    }
+}
+/*-----------------------------------------------------------*/
+
+static LogRecord_t * prvReserveRecord( size_t xLength,
+                                       uint32_t * pulIndex )
+{
+    LogRecord_t * pxPadding;
+    uint32_t ulWrite, ulRead, ulOffset, ulNeeded;
+    const uint32_t ulLength = ( uint32_t ) loggingRECORD_ALIGN( xLength );
+
+    do
+    {
+        /* The read index is read first.  It never passes the write index, so
+         * the space in use is never underestimated. */
+        ulRead = ulReadIndex;
+        ulWrite = ulWriteIndex;
+        ulOffset = ulWrite & ( ulRingBufferSize - 1 );
+
+        /* A record is never split, so one that does not fit before the end of
+         * the ring buffer is preceded by padding up to the end. */
+        ulNeeded = ulLength;
+
+        if( ulOffset + ulLength > ulRingBufferSize )
+        {
+            ulNeeded += ulRingBufferSize - ulOffset;
+        }
+
+        if( ( ulWrite - ulRead ) + ulNeeded > ulRingBufferSize )
+        {
+            ( void ) Atomic_Increment_u32( &ulDroppedMessages );
+
+            return NULL;
+        }
+    } while( Atomic_CompareAndSwap_u32( &ulWriteIndex, ulWrite + ulNeeded, ulWrite ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
+
+    if( ulNeeded != ulLength )
+    {
+        pxPadding = ( LogRecord_t * ) &( pucRingBuffer[ ulOffset ] );
+        pxPadding->ulSize = ulRingBufferSize - ulOffset;
+        ( void ) Atomic_OR_u32( &( pxPadding->ulState ), loggingRECORD_PADDING );
+
+        ulWrite += pxPadding->ulSize;
+        ulOffset = 0;
+    }
+
+    *pulIndex = ulWrite;
+
+    return ( LogRecord_t * ) &( pucRingBuffer[ ulOffset ] );
+}
+/*-----------------------------------------------------------*/
+
+static void prvCommitRecord( LogRecord_t * pxRecord,
+                             uint32_t ulIndex,
+                             size_t xLength )
+{
+    uint32_t ulReservedEnd, ulEnd;
+
+    pxRecord->ulSize = ( uint32_t ) loggingRECORD_ALIGN( xLength );
+
+    /* Give back the unused end of the record if it is still the last one
+     * reserved; otherwise the logging task skips it with the record. */
+    ulReservedEnd = ulIndex + ( uint32_t ) loggingRECORD_ALIGN( sizeof( LogRecord_t ) + configLOGGING_MAX_MESSAGE_LENGTH );
+    ulEnd = ulIndex + pxRecord->ulSize;
+
+    if( Atomic_CompareAndSwap_u32( &ulWriteIndex, ulEnd, ulReservedEnd ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+    {
+        pxRecord->ulSize = ( uint32_t ) loggingRECORD_ALIGN( sizeof( LogRecord_t ) + configLOGGING_MAX_MESSAGE_LENGTH );
+    }
+
+    if( xLength > sizeof( LogRecord_t ) + 1 )
+    {
+        ( void ) Atomic_OR_u32( &( pxRecord->ulState ), loggingRECORD_COMMITTED );
+    }
+    else
+    {
+        ( void ) Atomic_OR_u32( &( pxRecord->ulState ), loggingRECORD_PADDING );
     }
 }
 /*-----------------------------------------------------------*/
 
 /*!
- * \brief Formats a string to be printed and sends it
- * to the print queue.
+ * \brief Formats a string to be printed and writes it
+ * to the logging ring buffer.
  *
  * Appends the message number, time (in ticks), and task
  * that called vLoggingPrintf to the beginning of each
@@ -140,16 +340,21 @@ void vLoggingPrintf( const char * pcFormat,
     int32_t xLength2 = 0;
     va_list args;
     char * pcPrintString = NULL;
+    LogRecord_t * pxRecord = NULL;
+    uint32_t ulIndex = 0;
 
-    /* The queue is created by xLoggingTaskInitialize().  Check
+    /* The ring buffer is created by xLoggingTaskInitialize().  Check
      * xLoggingTaskInitialize() has been called. */
-    configASSERT( xQueue );
+    configASSERT( pucRingBuffer );
 
-    /* Allocate a buffer to hold the log message. */
-    pcPrintString = pvPortMalloc( configLOGGING_MAX_MESSAGE_LENGTH );
+    /* Reserve a record large enough for a message of the maximum length.  The
+     * part not used by the message is given back on commit. */
+    pxRecord = prvReserveRecord( sizeof( LogRecord_t ) + configLOGGING_MAX_MESSAGE_LENGTH, &ulIndex );
 
-    if( pcPrintString != NULL )
+    if( pxRecord != NULL )
     {
+        pcPrintString = ( char * ) ( pxRecord + 1 );
+
         /* There are a variable number of parameters. */
         va_start( args, pcFormat );
 
@@ -193,8 +398,8 @@ void vLoggingPrintf( const char * pcFormat,
              * part of the buffer may be empty if the value of
              * configLOGGING_INCLUDE_TIME_AND_TASK_NAME is not
              * 1 and as a result, the whole buffer may be empty.
-             * That's the reason we have a check for xLength > 0
-             * before sending the buffer to the logging task.
+             * An empty message is committed as padding, so is
+             * not output by the logging task.
              */
             xLength2 = 0;
             pcPrintString[ xLength ] = '\0';
@@ -203,48 +408,62 @@ void vLoggingPrintf( const char * pcFormat,
         xLength += ( size_t ) xLength2;
         va_end( args );
 
-        /* Only send the buffer to the logging task if it is
-         * not empty. */
-        if( xLength > 0 )
+        /* The message was truncated if it did not fit. */
+        if( xLength >= configLOGGING_MAX_MESSAGE_LENGTH )
         {
-            /* Send the string to the logging task for IO. */
-            if( xQueueSend( xQueue, &pcPrintString, loggingDONT_BLOCK ) != pdPASS )
-            {
-                /* The buffer was not sent so must be freed again. */
-                vPortFree( ( void * ) pcPrintString );
-            }
-        }
-        else
-        {
-            /* The buffer was not sent, so it must be
-             * freed. */
-            vPortFree( ( void * ) pcPrintString );
+            xLength = configLOGGING_MAX_MESSAGE_LENGTH - 1;
         }
+
+        /* Commit the message and its terminating NULL character. */
+        prvCommitRecord( pxRecord, ulIndex, sizeof( LogRecord_t ) + xLength + 1 );
     }
+
+    /* Notify the logging task, also when the message was dropped, so that the
+     * drop is reported. */
+    xTaskNotifyGive( xLoggingTask );
 }
 /*-----------------------------------------------------------*/
 
 void vLoggingPrint( const char * pcMessage )
 {
-    char * pcPrintString = NULL;
-    size_t xLength = 0;
-
-    /* The queue is created by xLoggingTaskInitialize().  Check
+    /* The ring buffer is created by xLoggingTaskInitialize().  Check
      * xLoggingTaskInitialize() has been called. */
-    configASSERT( xQueue );
+    configASSERT( pucRingBuffer );
+
+    prvWriteMessage( pcMessage );
+    xTaskNotifyGive( xLoggingTask );
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintFromISR( const char * pcMessage,
+                           BaseType_t * pxHigherPriorityTaskWoken )
+{
+    configASSERT( pucRingBuffer );
 
-    xLength = strlen( pcMessage ) + 1;
-    pcPrintString = pvPortMalloc( xLength );
+    prvWriteMessage( pcMessage );
+    vTaskNotifyGiveFromISR( xLoggingTask, pxHigherPriorityTaskWoken );
+}
+/*-----------------------------------------------------------*/
+
+static void prvWriteMessage( const char * pcMessage )
+{
+    LogRecord_t * pxRecord = NULL;
+    uint32_t ulIndex = 0;
+    size_t xLength = strlen( pcMessage );
 
-    if( pcPrintString != NULL )
+    /* Messages longer than the maximum length are truncated. */
+    if( xLength >= configLOGGING_MAX_MESSAGE_LENGTH )
     {
-        strncpy( pcPrintString, pcMessage, xLength );
+        xLength = configLOGGING_MAX_MESSAGE_LENGTH - 1;
+    }
 
-        /* Send the string to the logging task for IO. */
-        if( xQueueSend( xQueue, &pcPrintString, loggingDONT_BLOCK ) != pdPASS )
-        {
-            /* The buffer was not sent so must be freed again. */
-            vPortFree( ( void * ) pcPrintString );
-        }
+    pxRecord = prvReserveRecord( sizeof( LogRecord_t ) + configLOGGING_MAX_MESSAGE_LENGTH, &ulIndex );
+
+    if( pxRecord != NULL )
+    {
+        memcpy( pxRecord + 1, pcMessage, xLength );
+        ( ( char * ) ( pxRecord + 1 ) )[ xLength ] = '\0';
+
+        prvCommitRecord( pxRecord, ulIndex, sizeof( LogRecord_t ) + xLength + 1 );
     }
 }
@@ -74,6 +74,40 @@
     #define IotLogging_Puts    puts
 #endif
 
+/**
+ * @def IOT_LOG_BINARY
+ * @brief Whether log messages are encoded in binary instead of formatted.
+ *
+ * See @ref logging_binary.
+ */
+#ifndef IOT_LOG_BINARY
+    #define IOT_LOG_BINARY    ( 0 )
+#endif
+
+#if IOT_LOG_BINARY == 1
+
+/**
+ * @def IOT_LOG_BINARY_MAX_RECORD_SIZE
+ * @brief The size of the buffer a binary log record is encoded in. Arguments
+ * that do not fit are dropped, and the record is marked as truncated.
+ */
+    #ifndef IOT_LOG_BINARY_MAX_RECORD_SIZE
+        #define IOT_LOG_BINARY_MAX_RECORD_SIZE    ( 96 )
+    #endif
+
+/**
+ * @def IotLogging_PutBinary( pRecord, recordLength )
+ * @brief Function the logging library uses to output a binary log record.
+ *
+ * By default, the record is encoded in base64 and printed with
+ * #IotLogging_Puts on a line that starts with #BINARY_LINE_PREFIX, so that
+ * it can go through any channel that accepts text.
+ */
+    #ifndef IotLogging_PutBinary
+        #define IotLogging_PutBinary    _putBinaryAsText
+    #endif
+#endif /* if IOT_LOG_BINARY == 1 */
+
 /*
  * Provide default values for undefined memory allocation functions based on
  * the usage of dynamic memory allocation.
@@ -141,6 +175,40 @@
  */
 #define BYTES_PER_LINE           ( 16 )
 
+#if IOT_LOG_BINARY == 1
+
+/**
+ * @brief Version of the binary log record format, in the low bits of the
+ * first byte of each record.
+ */
+    #define BINARY_VERSION           ( 1 )
+
+/**
+ * @brief Set in the first byte of a binary log record if some arguments did
+ * not fit in the record.
+ */
+    #define BINARY_TRUNCATED         ( 0x10 )
+
+/**
+ * @brief Set in the second byte of a binary log record, next to the log level,
+ * for the #IotLogConfig_t members that are `true`.
+ */
+    #define BINARY_HIDE_LOG_LEVEL    ( 0x10 )
+    #define BINARY_HIDE_LIBRARY      ( 0x20 )
+    #define BINARY_HIDE_TIMESTRING   ( 0x40 )
+
+/**
+ * @brief The longest string argument copied to a binary log record. The
+ * length of a string is encoded in one byte.
+ */
+    #define BINARY_MAX_STRING_LENGTH ( 255 )
+
+/**
+ * @brief Start of the text lines that carry binary log records.
+ */
+    #define BINARY_LINE_PREFIX       '#'
+#endif /* if IOT_LOG_BINARY == 1 */
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -157,6 +225,428 @@ static const char * const _pLogLevelStrings[ 5 ] =
     "DEBUG"  /* IOT_LOG_DEBUG */
 };
 
+#if IOT_LOG_BINARY == 1
+
+/**
+ * @brief Reference point for the addresses of format strings and library names
+ * in binary log records.
+ *
+ * Binary log records carry the distance from this array to the format string
+ * and library name, which is the same in the running image and in the ELF file
+ * the host decodes against, even when the image is relocated.
+ */
+    const char IotLog_BinaryAnchor[] = "IotLog_BinaryAnchor";
+
+/**
+ * @brief A binary log record being encoded.
+ */
+    typedef struct _binaryRecord
+    {
+        size_t length;                                      /**< @brief Bytes encoded so far. */
+        uint8_t pBuffer[ IOT_LOG_BINARY_MAX_RECORD_SIZE ]; /**< @brief The encoded record. */
+    } _binaryRecord_t;
+#endif
+
+/*-----------------------------------------------------------*/
+
+#if IOT_LOG_BINARY == 1
+
+/**
+ * @brief Append a value to a binary log record, in little endian order.
+ *
+ * @param[in] pRecord The record to append to.
+ * @param[in] value The value to append.
+ * @param[in] size The number of low order bytes of `value` to append.
+ */
+    static void _binaryAppend( _binaryRecord_t * pRecord,
+                               uint64_t value,
+                               size_t size )
+    {
+        size_t i = 0;
+
+        if( ( pRecord->pBuffer[ 0 ] & BINARY_TRUNCATED ) != 0 )
+        {
+            return;
+        }
+
+        if( pRecord->length + size > IOT_LOG_BINARY_MAX_RECORD_SIZE )
+        {
+            pRecord->pBuffer[ 0 ] |= BINARY_TRUNCATED;
+
+            return;
+        }
+
+        for( i = 0; i < size; i++ )
+        {
+            pRecord->pBuffer[ pRecord->length ] = ( uint8_t ) ( value >> ( 8 * i ) );
+            pRecord->length++;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Append a string to a binary log record, as a one byte length followed
+ * by the characters, truncated if needed.
+ *
+ * @param[in] pRecord The record to append to.
+ * @param[in] pString The string to append.
+ * @param[in] maxLength The precision of the conversion. No more than this many
+ * characters of `pString` are read, so it need not be NUL terminated.
+ */
+    static void _binaryAppendString( _binaryRecord_t * pRecord,
+                                     const char * pString,
+                                     size_t maxLength )
+    {
+        size_t stringLength = 0;
+
+        if( pString == NULL )
+        {
+            pString = "(null)";
+        }
+
+        /* Append the length, as many characters as fit, then fix the length. */
+        _binaryAppend( pRecord, 0, 1 );
+
+        if( ( pRecord->pBuffer[ 0 ] & BINARY_TRUNCATED ) != 0 )
+        {
+            return;
+        }
+
+        while( ( stringLength < maxLength ) &&
+               ( pString[ stringLength ] != '\0' ) &&
+               ( stringLength < BINARY_MAX_STRING_LENGTH ) &&
+               ( pRecord->length < IOT_LOG_BINARY_MAX_RECORD_SIZE ) )
+        {
+            pRecord->pBuffer[ pRecord->length ] = ( uint8_t ) pString[ stringLength ];
+            pRecord->length++;
+            stringLength++;
+        }
+
+        pRecord->pBuffer[ pRecord->length - stringLength - 1 ] = ( uint8_t ) stringLength;
+
+        if( ( stringLength < maxLength ) && ( pString[ stringLength ] != '\0' ) )
+        {
+            pRecord->pBuffer[ 0 ] |= BINARY_TRUNCATED;
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Append the arguments of a log message to a binary log record.
+ *
+ * The format string is only scanned for conversion specifications, to know the
+ * type of each argument; nothing is formatted. Integers are appended in 4 bytes,
+ * or 8 bytes with the `l`, `ll`, `j`, `z` and `t` length modifiers, so that the
+ * record does not depend on the size of `long` on the device. Pointers and
+ * floating point numbers are appended in 8 bytes.
+ *
+ * @param[in] pRecord The record to append to.
+ * @param[in] pFormat The format string of the log message.
+ * @param[in] args The arguments of the log message.
+ */
+    static void _binaryAppendArguments( _binaryRecord_t * pRecord,
+                                        const char * pFormat,
+                                        va_list args )
+    {
+        const char * pCurrent = pFormat;
+        char lengthModifier = '\0';
+        int precision = 0;
+        double floatValue = 0.0;
+        uint64_t floatBits = 0;
+
+        while( *pCurrent != '\0' )
+        {
+            if( *pCurrent != '%' )
+            {
+                pCurrent++;
+                continue;
+            }
+
+            pCurrent++;
+
+            /* Skip flags. */
+            while( ( *pCurrent == '-' ) || ( *pCurrent == '+' ) || ( *pCurrent == ' ' ) ||
+                   ( *pCurrent == '#' ) || ( *pCurrent == '0' ) )
+            {
+                pCurrent++;
+            }
+
+            /* Width and precision given as arguments are appended; others are
+             * part of the format string. */
+            if( *pCurrent == '*' )
+            {
+                _binaryAppend( pRecord, ( uint64_t ) va_arg( args, int ), 4 );
+                pCurrent++;
+            }
+
+            while( ( *pCurrent >= '0' ) && ( *pCurrent <= '9' ) )
+            {
+                pCurrent++;
+            }
+
+            /* A negative precision is taken as if it were omitted. */
+            precision = -1;
+
+            if( *pCurrent == '.' )
+            {
+                pCurrent++;
+                precision = 0;
+
+                if( *pCurrent == '*' )
+                {
+                    precision = va_arg( args, int );
+                    _binaryAppend( pRecord, ( uint64_t ) precision, 4 );
+                    pCurrent++;
+                }
+
+                while( ( *pCurrent >= '0' ) && ( *pCurrent <= '9' ) )
+                {
+                    precision = precision * 10 + ( *pCurrent - '0' );
+                    pCurrent++;
+                }
+            }
+
+            /* Length modifier. "hh" is the same as "h" and "ll" is stored as 'q'. */
+            lengthModifier = '\0';
+
+            if( ( *pCurrent == 'h' ) || ( *pCurrent == 'l' ) || ( *pCurrent == 'j' ) ||
+                ( *pCurrent == 'z' ) || ( *pCurrent == 't' ) || ( *pCurrent == 'L' ) )
+            {
+                lengthModifier = *pCurrent;
+                pCurrent++;
+
+                if( ( lengthModifier == 'h' ) && ( *pCurrent == 'h' ) )
+                {
+                    pCurrent++;
+                }
+                else if( ( lengthModifier == 'l' ) && ( *pCurrent == 'l' ) )
+                {
+                    lengthModifier = 'q';
+                    pCurrent++;
+                }
+            }
+
+            switch( *pCurrent )
+            {
+                case 'd':
+                case 'i':
+
+                    switch( lengthModifier )
+                    {
+                        case 'l':
+                            _binaryAppend( pRecord, ( uint64_t ) ( int64_t ) va_arg( args, long ), 8 );
+                            break;
+
+                        case 'q':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, long long ), 8 );
+                            break;
+
+                        case 'j':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, intmax_t ), 8 );
+                            break;
+
+                        case 'z':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, size_t ), 8 );
+                            break;
+
+                        case 't':
+                            _binaryAppend( pRecord, ( uint64_t ) ( int64_t ) va_arg( args, ptrdiff_t ), 8 );
+                            break;
+
+                        default:
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, int ), 4 );
+                            break;
+                    }
+
+                    break;
+
+                case 'u':
+                case 'o':
+                case 'x':
+                case 'X':
+
+                    switch( lengthModifier )
+                    {
+                        case 'l':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, unsigned long ), 8 );
+                            break;
+
+                        case 'q':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, unsigned long long ), 8 );
+                            break;
+
+                        case 'j':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, uintmax_t ), 8 );
+                            break;
+
+                        case 'z':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, size_t ), 8 );
+                            break;
+
+                        case 't':
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, ptrdiff_t ), 8 );
+                            break;
+
+                        default:
+                            _binaryAppend( pRecord, ( uint64_t ) va_arg( args, unsigned int ), 4 );
+                            break;
+                    }
+
+                    break;
+
+                case 'c':
+                    _binaryAppend( pRecord, ( uint64_t ) va_arg( args, int ), 4 );
+                    break;
+
+                case 'p':
+                    _binaryAppend( pRecord, ( uint64_t ) ( uintptr_t ) va_arg( args, void * ), 8 );
+                    break;
+
+                case 's':
+                    _binaryAppendString( pRecord,
+                                         va_arg( args, const char * ),
+                                         ( precision < 0 ) ? SIZE_MAX : ( size_t ) precision );
+                    break;
+
+                case 'f':
+                case 'F':
+                case 'e':
+                case 'E':
+                case 'g':
+                case 'G':
+                case 'a':
+                case 'A':
+
+                    if( lengthModifier == 'L' )
+                    {
+                        floatValue = ( double ) va_arg( args, long double );
+                    }
+                    else
+                    {
+                        floatValue = va_arg( args, double );
+                    }
+
+                    ( void ) memcpy( &floatBits, &floatValue, sizeof( floatBits ) );
+                    _binaryAppend( pRecord, floatBits, 8 );
+                    break;
+
+                case 'n':
+                    ( void ) va_arg( args, void * );
+                    break;
+
+                case '%':
+                    break;
+
+                default:
+
+                    /* The type of the remaining arguments is unknown. */
+                    pRecord->pBuffer[ 0 ] |= BINARY_TRUNCATED;
+
+                    return;
+            }
+
+            if( *pCurrent != '\0' )
+            {
+                pCurrent++;
+            }
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Print a binary log record as a line of base64 text.
+ *
+ * @param[in] pRecord The record to print.
+ * @param[in] recordLength The length of `pRecord`.
+ */
+    static void _putBinaryAsText( const uint8_t * pRecord,
+                                  size_t recordLength )
+    {
+        static const char pBase64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        char pLine[ 1 + ( ( IOT_LOG_BINARY_MAX_RECORD_SIZE + 2 ) / 3 ) * 4 + 1 ];
+        size_t i = 0, linePosition = 0;
+        uint32_t group = 0;
+
+        pLine[ linePosition ] = BINARY_LINE_PREFIX;
+        linePosition++;
+
+        for( i = 0; i < recordLength; i += 3 )
+        {
+            group = ( uint32_t ) pRecord[ i ] << 16;
+
+            if( i + 1 < recordLength )
+            {
+                group |= ( uint32_t ) pRecord[ i + 1 ] << 8;
+            }
+
+            if( i + 2 < recordLength )
+            {
+                group |= ( uint32_t ) pRecord[ i + 2 ];
+            }
+
+            pLine[ linePosition ] = pBase64[ ( group >> 18 ) & 0x3f ];
+            pLine[ linePosition + 1 ] = pBase64[ ( group >> 12 ) & 0x3f ];
+            pLine[ linePosition + 2 ] = ( i + 1 < recordLength ) ? pBase64[ ( group >> 6 ) & 0x3f ] : '=';
+            pLine[ linePosition + 3 ] = ( i + 2 < recordLength ) ? pBase64[ group & 0x3f ] : '=';
+            linePosition += 4;
+        }
+
+        pLine[ linePosition ] = '\0';
+
+        IotLogging_Puts( pLine );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Encode a log message as a binary log record and output it.
+ *
+ * See @ref logging_binary for the record format.
+ *
+ * @param[in] pLibraryName The library name of the message.
+ * @param[in] messageLevel The log level of the message.
+ * @param[in] pLogConfig The log configuration of the message.
+ * @param[in] pFormat The format string of the message.
+ * @param[in] args The arguments of the message.
+ */
+    static void _logBinary( const char * const pLibraryName,
+                            int messageLevel,
+                            const IotLogConfig_t * const pLogConfig,
+                            const char * const pFormat,
+                            va_list args )
+    {
+        _binaryRecord_t record = { 0 };
+        uint8_t flags = ( uint8_t ) messageLevel;
+
+        if( pLogConfig != NULL )
+        {
+            flags |= ( pLogConfig->hideLogLevel == true ) ? BINARY_HIDE_LOG_LEVEL : 0;
+            flags |= ( pLogConfig->hideLibraryName == true ) ? BINARY_HIDE_LIBRARY : 0;
+            flags |= ( pLogConfig->hideTimestring == true ) ? BINARY_HIDE_TIMESTRING : 0;
+        }
+
+        /* Header: version, flags and log level, then the library name and format
+         * string as signed distances from IotLog_BinaryAnchor. */
+        _binaryAppend( &record, BINARY_VERSION, 1 );
+        _binaryAppend( &record, flags, 1 );
+        _binaryAppend( &record, ( uint64_t ) ( ( intptr_t ) pLibraryName - ( intptr_t ) IotLog_BinaryAnchor ), 4 );
+        _binaryAppend( &record, ( uint64_t ) ( ( intptr_t ) pFormat - ( intptr_t ) IotLog_BinaryAnchor ), 4 );
+
+        /* The time in milliseconds replaces the timestring. */
+        if( ( flags & BINARY_HIDE_TIMESTRING ) == 0 )
+        {
+            _binaryAppend( &record, IotClock_GetTimeMs(), 4 );
+        }
+
+        _binaryAppendArguments( &record, pFormat, args );
+
+        IotLogging_PutBinary( record.pBuffer, record.length );
+    }
+#endif /* if IOT_LOG_BINARY == 1 */
+
 /*-----------------------------------------------------------*/
 
 #if !defined( IOT_STATIC_MEMORY_ONLY ) || ( IOT_STATIC_MEMORY_ONLY == 0 )
@@ -208,6 +698,15 @@ void IotLog_Generic( int libraryLogSetting,
         return;
     }
 
+    /* In binary mode, encode the message instead of formatting it. */
+    #if IOT_LOG_BINARY == 1
+        va_start( args, pFormat );
+        _logBinary( pLibraryName, messageLevel, pLogConfig, pFormat, args );
+        va_end( args );
+
+        return;
+    #endif
+
     if( ( pLogConfig == NULL ) || ( pLogConfig->hideLogLevel == false ) )
     {
         /* Add length of log level if requested. */
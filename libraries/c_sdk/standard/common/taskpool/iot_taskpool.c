@@ -43,6 +43,9 @@
 /* Task pool internal include. */
 #include "private/iot_taskpool_internal.h"
 
+/* Atomics include. */
+#include "iot_atomic.h"
+
 /**
  * @brief Enter a critical section by locking a mutex.
  *
@@ -55,6 +58,18 @@
  */
 #define TASKPOOL_EXIT_CRITICAL()         IotMutex_Unlock( &( pTaskPool->lock ) )
 
+/**
+ * @brief Enter the critical section of a dispatch lane by locking its mutex.
+ *
+ */
+#define TASKPOOL_ENTER_LANE_CRITICAL( pLane )    IotMutex_Lock( &( ( pLane )->lock ) )
+
+/**
+ * @brief Exit the critical section of a dispatch lane by unlocking its mutex.
+ *
+ */
+#define TASKPOOL_EXIT_LANE_CRITICAL( pLane )     IotMutex_Unlock( &( ( pLane )->lock ) )
+
 /**
  * @brief Maximum semaphore value for wait operations.
  */
@@ -65,6 +80,42 @@
  */
 #define TASKPOOL_JOB_RESCHEDULE_DELAY_MS    ( 10ULL )
 
+/**
+ * @brief The flag bit of #IOT_TASKPOOL_JOB_AFFINITY, without a key.
+ */
+#define TASKPOOL_JOB_AFFINITY_FLAG          IOT_TASKPOOL_JOB_AFFINITY( 0 )
+
+/**
+ * @brief All the flags that can be passed to @ref IotTaskPool_Schedule.
+ */
+#define TASKPOOL_JOB_VALID_FLAGS            ( IOT_TASKPOOL_JOB_HIGH_PRIORITY | IOT_TASKPOOL_JOB_AFFINITY( 0xFFFF ) )
+
+/**
+ * @brief Extract the key of #IOT_TASKPOOL_JOB_AFFINITY from the scheduling flags.
+ */
+#define TASKPOOL_JOB_AFFINITY_KEY( flags )    ( ( flags ) >> 16 )
+
+/**
+ * @brief Multiplier to scramble affinity keys (Knuth's multiplicative hash), so that keys derived
+ * from addresses spread evenly across lanes.
+ */
+#define TASKPOOL_AFFINITY_HASH_MULTIPLIER    ( 2654435761UL )
+
+/**
+ * @brief Mask of the slot index in a level of the timer wheel.
+ */
+#define TASKPOOL_TIMER_WHEEL_MASK            ( ( uint64_t ) TASKPOOL_TIMER_WHEEL_SLOTS - 1ULL )
+
+/**
+ * @brief The base 2 logarithm of the number of ticks spanned by a slot of a level of the timer wheel.
+ */
+#define TASKPOOL_TIMER_WHEEL_SHIFT( level )    ( ( uint32_t ) IOT_TASKPOOL_TIMER_WHEEL_SLOT_BITS * ( uint32_t ) ( level ) )
+
+/**
+ * @brief The value of #_taskPoolTimerWheel_t.armedTick when the task pool timer is not armed.
+ */
+#define TASKPOOL_TIMER_WHEEL_DISARMED        ( UINT64_MAX )
+
 /* ---------------------------------------------------------------------------------- */
 
 /**
@@ -75,7 +126,7 @@
  * the system libraries as well. The system task pool needs to be initialized before any library is used or
  * before any code that posts jobs to the task pool runs.
  */
-_taskPool_t _IotSystemTaskPool = { .dispatchQueue = IOT_DEQUEUE_INITIALIZER };
+_taskPool_t _IotSystemTaskPool = { .laneCount = 0 };
 
 /* -------------- Convenience functions to create/recycle/destroy jobs -------------- */
 
@@ -134,25 +185,157 @@ static void _destroyJob( _taskPoolJob_t * const pJob );
  */
 static void _taskPoolWorker( void * pUserContext );
 
+/**
+ * Fetches the next job for a worker thread: the first job in the lane of the worker or, if there
+ * is none, a job stolen from another lane.
+ *
+ * @param[in] pTaskPool The task pool the worker belongs to.
+ * @param[in] pLane The lane of the worker.
+ * @param[in] pCompletedJob The times of the job the worker just completed, or `NULL`.
+ * @param[out] pUserCallback The callback of the job, if a job was fetched.
+ *
+ */
+static _taskPoolJob_t * _fetchJob( _taskPool_t * const pTaskPool,
+                                   _taskPoolLane_t * const pLane,
+                                   const _taskPoolJobTimes_t * const pCompletedJob,
+                                   IotTaskPoolRoutine_t * const pUserCallback );
+
+/**
+ * Matches a job that workers of other lanes are allowed to steal.
+ *
+ * @param[in] pLink A pointer to the job link in the dispatch queue.
+ * @param[in] pMatch Unused.
+ *
+ */
+static bool _matchStealableJob( const IotLink_t * const pLink,
+                                void * pMatch );
+
+/**
+ * Dequeues the next job of a lane: a job that missed its deadline at the head of the queue of
+ * its class first, otherwise the next job in weighted round robin order of the classes. The lane
+ * lock must be held.
+ *
+ * @param[in] pLane The lane to dequeue from.
+ *
+ */
+static IotLink_t * _dequeueWeighted( _taskPoolLane_t * const pLane );
+
+/**
+ * Starts a new round of weighted round robin dequeueing for a lane.
+ *
+ * @param[in] pLane The lane.
+ *
+ */
+static void _refillCredits( _taskPoolLane_t * const pLane );
+
+/**
+ * Reports a job that starts executing past its deadline to the late job callback of the task pool.
+ *
+ * @param[in] pTaskPool The task pool the job belongs to.
+ * @param[in] pJob The job about to be executed.
+ *
+ */
+static void _reportLateJob( _taskPool_t * const pTaskPool,
+                            _taskPoolJob_t * const pJob );
+
+/* -------------- Convenience functions to handle statistics  -------------- */
+
+/**
+ * Records a duration in a histogram.
+ *
+ * @param[in] pHistogram The histogram.
+ * @param[in] durationMs The duration in milliseconds.
+ *
+ */
+static void _histogramRecord( IotTaskPoolHistogram_t * const pHistogram,
+                              uint64_t durationMs );
+
+/**
+ * Adds the durations recorded in a histogram to another histogram.
+ *
+ * @param[in] pTotal The histogram to add to.
+ * @param[in] pHistogram The histogram to add.
+ *
+ */
+static void _histogramMerge( IotTaskPoolHistogram_t * const pTotal,
+                             const IotTaskPoolHistogram_t * const pHistogram );
+
 /* -------------- Convenience functions to handle timer events  -------------- */
 
 /**
- * Comparer for the time list.
+ * Initializes an empty timer wheel.
+ *
+ * param[in] pWheel The timer wheel to initialize.
+ */
+static void _timerWheelInit( _taskPoolTimerWheel_t * const pWheel );
+
+/**
+ * Converts an expiration time to the first tick of the timer wheel at or after it.
+ *
+ * param[in] expirationTime The expiration time in milliseconds.
+ */
+static uint64_t _timerWheelExpirationTick( uint64_t expirationTime );
+
+/**
+ * Links a timer event in the timer wheel.
+ *
+ * param[in] pWheel The timer wheel.
+ * param[in] pTimerEvent The timer event to link.
+ *
+ * @return The tick at which the timer event will expire.
+ */
+static uint64_t _timerWheelInsert( _taskPoolTimerWheel_t * const pWheel,
+                                   _taskPoolTimerEvent_t * const pTimerEvent );
+
+/**
+ * Unlinks a timer event from the timer wheel.
  *
- * param[in] pTimerEventLink1 The link to the first timer event.
- * param[in] pTimerEventLink1 The link to the first timer event.
+ * param[in] pWheel The timer wheel.
+ * param[in] pTimerEvent The timer event to unlink.
  */
-static int32_t _timerEventCompare( const IotLink_t * const pTimerEventLink1,
-                                   const IotLink_t * const pTimerEventLink2 );
+static void _timerWheelRemove( _taskPoolTimerWheel_t * const pWheel,
+                               _taskPoolTimerEvent_t * const pTimerEvent );
 
 /**
- * Reschedules the timer for handling deferred jobs to the next timeout.
+ * Moves the timer events in the current slot of a level of the timer wheel to the lower levels, or
+ * to the list of expired events.
  *
- * param[in] pTimer The timer to reschedule.
- * param[in] pFirstTimerEvent The timer event that carries the timeout and job information.
+ * param[in] pWheel The timer wheel.
+ * param[in] level The level to cascade, greater than 0.
+ * param[out] pExpired The list of expired timer events.
  */
-static void _rescheduleDeferredJobsTimer( IotTimer_t * const pTimer,
-                                          _taskPoolTimerEvent_t * const pFirstTimerEvent );
+static void _timerWheelCascade( _taskPoolTimerWheel_t * const pWheel,
+                                uint32_t level,
+                                IotListDouble_t * const pExpired );
+
+/**
+ * Advances the timer wheel up to a tick, collecting the timer events that expired.
+ *
+ * param[in] pWheel The timer wheel.
+ * param[in] nowTick The tick to advance to.
+ * param[out] pExpired The list of expired timer events.
+ */
+static void _timerWheelAdvance( _taskPoolTimerWheel_t * const pWheel,
+                                uint64_t nowTick,
+                                IotListDouble_t * const pExpired );
+
+/**
+ * Finds the next tick at which the timer wheel has a slot to expire or to cascade.
+ *
+ * param[in] pWheel The timer wheel.
+ *
+ * @return The next tick, or #TASKPOOL_TIMER_WHEEL_DISARMED if the timer wheel is empty.
+ */
+static uint64_t _timerWheelNextTick( const _taskPoolTimerWheel_t * const pWheel );
+
+/**
+ * Reschedules the timer for handling deferred jobs to a tick of the timer wheel.
+ *
+ * param[in] pTaskPool The task pool owning the timer.
+ * param[in] wakeTick The tick at which the timer should fire.
+ */
+static void _rescheduleDeferredJobsTimer( _taskPool_t * const pTaskPool,
+                                          uint64_t wakeTick );
 
 /**
  * The task pool timer procedure for scheduling deferred jobs.
@@ -199,6 +382,24 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
  */
 static void _destroyTaskPool( _taskPool_t * const pTaskPool );
 
+/**
+ * Initializes one dispatch lane of a task pool.
+ *
+ * @param[in] pTaskPool The task pool the lane belongs to.
+ * @param[in] pLane The lane to initialize.
+ *
+ */
+static bool _initLane( _taskPool_t * const pTaskPool,
+                       _taskPoolLane_t * const pLane );
+
+/**
+ * Destroys one dispatch lane of a task pool.
+ *
+ * @param[in] pLane The lane to destroy.
+ *
+ */
+static void _destroyLane( _taskPoolLane_t * const pLane );
+
 /**
  * Check for the exit condition.
  *
@@ -208,14 +409,53 @@ static void _destroyTaskPool( _taskPool_t * const pTaskPool );
 static bool _IsShutdownStarted( const _taskPool_t * const pTaskPool );
 
 /**
- * Set the exit condition.
+ * Set the exit condition and wake up all worker threads. Must be called with the task pool lock held.
  *
  * @param[in] pTaskPool The task pool to destroy.
- * @param[in] threads The number of threads active in the task pool at shutdown time.
  *
  */
-static void _signalShutdown( _taskPool_t * const pTaskPool,
-                             uint32_t threads );
+static void _signalShutdown( _taskPool_t * const pTaskPool );
+
+/**
+ * Selects the lane to dispatch a job to.
+ *
+ * @param[in] pTaskPool The task pool to schedule the job with.
+ * @param[in] flags The job flags.
+ *
+ */
+static uint32_t _selectLane( _taskPool_t * const pTaskPool,
+                             uint32_t flags );
+
+/**
+ * Checks whether scheduling a job should create a new worker thread. The result is only a hint
+ * unless the task pool lock is held.
+ *
+ * @param[in] pTaskPool The task pool to schedule the job with.
+ * @param[in] flags The job flags.
+ *
+ */
+static bool _shouldGrow( const _taskPool_t * const pTaskPool,
+                         uint32_t flags );
+
+/**
+ * Wakes up a worker of a lane with idle workers, so that it steals a job from a busy lane.
+ *
+ * @param[in] pTaskPool The task pool the lanes belong to.
+ * @param[in] busyLane The index of the busy lane.
+ *
+ */
+static void _wakeIdleLane( _taskPool_t * const pTaskPool,
+                           uint32_t busyLane );
+
+/**
+ * Reads the status of a job under the lock of the lane the job was dispatched to.
+ *
+ * @param[in] pTaskPool The task pool the job belongs to.
+ * @param[in] pJob The job to read the status of.
+ *
+ */
+static IotTaskPoolJobStatus_t _getJobStatus( _taskPool_t * const pTaskPool,
+                                             _taskPoolJob_t * const pJob );
 
 /**
  * Places a job in the dispatch queue.
@@ -230,14 +470,35 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
                                              uint32_t flags );
 
 /**
- * Matches a deferred job in the timer queue with its timer event wrapper.
+ * Places a job in the dispatch queue of a lane, under the lock of that lane only.
+ *
+ * @param[in] pTaskPool The task pool to schedule the job with.
+ * @param[in] pJob The job to schedule.
+ * @param[in] lane The lane to dispatch the job to.
+ * @param[in] flags The job flags.
+ *
+ * @return `false` if the task pool is shutting down and the job was not dispatched.
+ *
+ */
+static bool _dispatchJob( _taskPool_t * const pTaskPool,
+                          _taskPoolJob_t * const pJob,
+                          uint32_t lane,
+                          uint32_t flags );
+
+/**
+ * Schedules a job without taking the task pool lock, if the job is not in a dispatch queue, the
+ * timer wheel or the cache, and does not need a new worker thread.
  *
- * @param[in] pLink A pointer to the timer event link in the timer queue.
- * @param[in] pMatch A pointer to the job to match.
+ * @param[in] pTaskPool The task pool to schedule the job with.
+ * @param[in] pJob The job to schedule.
+ * @param[in] flags The job flags.
+ *
+ * @return `true` if the job was scheduled; otherwise, the job must be scheduled under the task pool lock.
  *
  */
-static bool _matchJobByPointer( const IotLink_t * const pLink,
-                                void * pMatch );
+static bool _tryScheduleUnlocked( _taskPool_t * const pTaskPool,
+                                  _taskPoolJob_t * const pJob,
+                                  uint32_t flags );
 
 /**
  * Tries to cancel a job.
@@ -337,7 +598,7 @@ IotTaskPoolError_t IotTaskPool_Destroy( IotTaskPool_t taskPoolHandle )
 {
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
 
-    uint32_t count;
+    uint32_t count, lane;
     bool completeShutdown = true;
 
     _taskPool_t * pTaskPool = ( _taskPool_t * )taskPoolHandle;
@@ -358,68 +619,91 @@ IotTaskPoolError_t IotTaskPool_Destroy( IotTaskPool_t taskPoolHandle )
         /* Record how many active threads in the task pool. */
         activeThreads = pTaskPool->activeThreads;
 
-        /* Destroying a Task pool happens in six (6) stages: First, (1) we clear the job queue and (2) the timer queue.
+        /* Destroying a Task pool happens in six (6) stages: First, (1) we clear the job queues and (2) the timer queue.
          * Then (3) we clear the jobs cache. We will then (4) wait for all worker threads to signal exit,
          * before (5) setting the exit condition and wake up all active worker threads. Finally (6) destroying
          * all task pool data structures and release the associated memory.
          */
 
-        /* (1) Clear the job queue. */
-        do
-        {
-            pItemLink = NULL;
+        /* Stop the dispatch of new jobs before the lanes are cleared. Jobs are dispatched under the lock
+         * of their lane only, so a lane checks the exit condition before it accepts a job. */
+        pTaskPool->maxThreads = 0;
 
-            pItemLink = IotDeQueue_DequeueHead( &pTaskPool->dispatchQueue );
+        /* (1) Clear the job queues of all lanes. */
+        for( lane = 0; lane < pTaskPool->laneCount; ++lane )
+        {
+            _taskPoolLane_t * pLane = &pTaskPool->lanes[ lane ];
 
-            if( pItemLink != NULL )
+            TASKPOOL_ENTER_LANE_CRITICAL( pLane );
             {
-                _taskPoolJob_t * pJob = IotLink_Container( _taskPoolJob_t, pItemLink, link );
+                uint32_t jobClass;
 
-                _destroyJob( pJob );
+                for( jobClass = 0; jobClass < TASKPOOL_JOB_CLASSES; ++jobClass )
+                {
+                    do
+                    {
+                        pItemLink = NULL;
+
+                        pItemLink = IotDeQueue_DequeueHead( &pLane->dispatchQueues[ jobClass ] );
+
+                        if( pItemLink != NULL )
+                        {
+                            _taskPoolJob_t * pJob = IotLink_Container( _taskPoolJob_t, pItemLink, link );
+
+                            pLane->activeJobs--;
+                            pLane->queuedJobs--;
+                            ( void ) Atomic_Decrement_u32( &pTaskPool->activeJobs );
+
+                            _destroyJob( pJob );
+                        }
+                    } while( pItemLink );
+                }
             }
-        } while( pItemLink );
+            TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+        }
 
-        /* (2) Clear the timer queue. */
+        /* (2) Clear the timer wheel. */
         {
-            _taskPoolTimerEvent_t * pTimerEvent;
+            uint32_t level, slot;
 
             /* A deferred job may have fired already. Since deferred jobs will go through the same mutex
              * the shutdown sequence is holding at this stage, there is no risk for race conditions. Yet, we
              * need to let the deferred job to destroy the task pool. */
-
-            pItemLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-
-            if( pItemLink != NULL )
+            if( ( pTaskPool->timerWheel.armedTick != TASKPOOL_TIMER_WHEEL_DISARMED ) &&
+                ( ( pTaskPool->timerWheel.armedTick * IOT_TASKPOOL_TIMER_WHEEL_TICK_MS ) <= IotClock_GetTimeMs() ) )
             {
-                uint64_t now = IotClock_GetTimeMs();
+                IotLogDebug( "Shutdown will be deferred to the timer thread" );
 
-                pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pItemLink, link );
+                /* Timer may have fired already! Let the timer thread destroy
+                 * complete the taskpool destruction sequence. */
+                completeShutdown = false;
+            }
 
-                if( pTimerEvent->expirationTime <= now )
+            /* Remove all timers from the timer wheel. */
+            for( level = 0; level < TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+            {
+                for( slot = 0; slot < TASKPOOL_TIMER_WHEEL_SLOTS; ++slot )
                 {
-                    IotLogDebug( "Shutdown will be deferred to the timer thread" );
-
-                    /* Timer may have fired already! Let the timer thread destroy
-                     * complete the taskpool destruction sequence. */
-                    completeShutdown = false;
-                }
+                    for( ; ; )
+                    {
+                        _taskPoolTimerEvent_t * pTimerEvent;
 
-                /* Remove all timers from the timeout list. */
-                for( ; ; )
-                {
-                    pItemLink = IotListDouble_RemoveHead( &pTaskPool->timerEventsList );
+                        pItemLink = IotListDouble_RemoveHead( &pTaskPool->timerWheel.slots[ level ][ slot ] );
 
-                    if( pItemLink == NULL )
-                    {
-                        break;
-                    }
+                        if( pItemLink == NULL )
+                        {
+                            break;
+                        }
 
-                    pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pItemLink, link );
+                        pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pItemLink, link );
 
-                    _destroyJob( pTimerEvent->pJob );
+                        _destroyJob( pTimerEvent->pJob );
 
-                    IotTaskPool_FreeTimerEvent( pTimerEvent );
+                        IotTaskPool_FreeTimerEvent( pTimerEvent );
+                    }
                 }
+
+                pTaskPool->timerWheel.pending[ level ] = 0;
             }
         }
 
@@ -439,7 +723,7 @@ IotTaskPoolError_t IotTaskPool_Destroy( IotTaskPool_t taskPoolHandle )
         } while( pItemLink );
 
         /* (4) Set the exit condition. */
-        _signalShutdown( pTaskPool, activeThreads );
+        _signalShutdown( pTaskPool );
     }
     TASKPOOL_EXIT_CRITICAL();
 
@@ -501,7 +785,8 @@ IotTaskPoolError_t IotTaskPool_SetMaxThreads( IotTaskPool_t taskPoolHandle,
         count = previousMaxThreads - maxThreads;
 
         /* If the number of maximum threads in the pool is set to be smaller than the current value,
-         * then we need to signal all redundant threads to exit.
+         * then we need to signal all redundant threads to exit. Spread the signals across lanes,
+         * since every lane keeps at least one worker.
          */
         if( maxThreads < previousMaxThreads )
         {
@@ -511,7 +796,7 @@ IotTaskPoolError_t IotTaskPool_SetMaxThreads( IotTaskPool_t taskPoolHandle,
 
             while( i > 0UL )
             {
-                IotSemaphore_Post( &pTaskPool->dispatchSignal );
+                IotSemaphore_Post( &pTaskPool->lanes[ i % pTaskPool->laneCount ].dispatchSignal );
 
                 --i;
             }
@@ -574,6 +859,15 @@ IotTaskPoolError_t IotTaskPool_CreateRecyclableJob( IotTaskPool_t taskPoolHandle
                 TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
             }
 
+            if( pTaskPool->jobsCache.freeCount > 0UL )
+            {
+                pTaskPool->stats.cacheHits++;
+            }
+            else
+            {
+                pTaskPool->stats.cacheMisses++;
+            }
+
             pTempJob = _fetchOrAllocateJob( &pTaskPool->jobsCache );
         }
         TASKPOOL_EXIT_CRITICAL();
@@ -700,29 +994,35 @@ IotTaskPoolError_t IotTaskPool_Schedule( IotTaskPool_t taskPoolHandle,
     /* Parameter checking. */
     TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
     TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
-    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( flags != 0UL ) && ( flags != IOT_TASKPOOL_JOB_HIGH_PRIORITY ) );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( flags & ~TASKPOOL_JOB_VALID_FLAGS ) != 0UL );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( ( flags & TASKPOOL_JOB_AFFINITY_FLAG ) == 0UL ) && ( TASKPOOL_JOB_AFFINITY_KEY( flags ) != 0UL ) );
 
     pTaskPool = ( _taskPool_t * )taskPoolHandle;
 
-    TASKPOOL_ENTER_CRITICAL();
+    /* Most jobs are dispatched under the lock of their lane only. The task pool lock is needed to
+     * extract a job from where it is queued, to grow the task pool, or to report a shutdown. */
+    if( _tryScheduleUnlocked( pTaskPool, pJob, flags ) == false )
     {
-        /* Bail out early if this task pool is shutting down. */
-        if( _IsShutdownStarted( pTaskPool ) )
-        {
-            status = IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS;
-        }
-        else
+        TASKPOOL_ENTER_CRITICAL();
         {
-            status = _trySafeExtraction( pTaskPool, pJob, false );
-        }
+            /* Bail out early if this task pool is shutting down. */
+            if( _IsShutdownStarted( pTaskPool ) )
+            {
+                status = IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS;
+            }
+            else
+            {
+                status = _trySafeExtraction( pTaskPool, pJob, false );
+            }
 
-        /* If all safety checks completed, proceed. */
-        if( TASKPOOL_SUCCEEDED( status ) )
-        {
-            status = _scheduleInternal( pTaskPool, pJob, flags );
+            /* If all safety checks completed, proceed. */
+            if( TASKPOOL_SUCCEEDED( status ) )
+            {
+                status = _scheduleInternal( pTaskPool, pJob, flags );
+            }
         }
+        TASKPOOL_EXIT_CRITICAL();
     }
-    TASKPOOL_EXIT_CRITICAL();
 
     TASKPOOL_NO_FUNCTION_CLEANUP();
 }
@@ -760,8 +1060,7 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPoolHandle,
         /* If all safety checks completed, proceed. */
         if( TASKPOOL_SUCCEEDED( _trySafeExtraction( pTaskPool, pJob, false ) ) )
         {
-            IotLink_t * pTimerEventLink;
-            uint64_t now;
+            uint64_t expirationTick;
 
             _taskPoolTimerEvent_t * pTimerEvent = ( _taskPoolTimerEvent_t * )IotTaskPool_MallocTimerEvent( sizeof( _taskPoolTimerEvent_t ) );
 
@@ -774,31 +1073,23 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPoolHandle,
 
             memset( pTimerEvent, 0x00, sizeof( _taskPoolTimerEvent_t ) );
 
-            now = IotClock_GetTimeMs();
-
             pTimerEvent->link.pNext = NULL;
             pTimerEvent->link.pPrevious = NULL;
-            pTimerEvent->expirationTime = now + timeMs;
+            pTimerEvent->expirationTime = IotClock_GetTimeMs() + timeMs;
             pTimerEvent->pJob = ( _taskPoolJob_t * )pJob;
+            pJob->pTimerEvent = pTimerEvent;
 
-            /* Append the timer event to the timer list. */
-            IotListDouble_InsertSorted( &pTaskPool->timerEventsList, &pTimerEvent->link, _timerEventCompare );
+            /* Link the timer event in the timer wheel. */
+            expirationTick = _timerWheelInsert( &pTaskPool->timerWheel, pTimerEvent );
 
-            /* Update the job status to 'scheduled'. */
+            /* Update the job status to 'deferred'. */
             pJob->status = IOT_TASKPOOL_STATUS_DEFERRED;
 
-            /* Peek the first event in the timer event list. There must be at least one,
-             * since we just inserted it. */
-            pTimerEventLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-            IotTaskPool_Assert( pTimerEventLink != NULL );
-
-            /* If the event we inserted is at the front of the queue, then
+            /* If the event we inserted expires before the timer is due to fire, then
              * we need to reschedule the underlying timer. */
-            if( pTimerEventLink == &pTimerEvent->link )
+            if( expirationTick < pTaskPool->timerWheel.armedTick )
             {
-                pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pTimerEventLink, link );
-
-                _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerEvent );
+                _rescheduleDeferredJobsTimer( pTaskPool, expirationTick );
             }
         }
         else
@@ -815,6 +1106,54 @@ IotTaskPoolError_t IotTaskPool_ScheduleDeferred( IotTaskPool_t taskPoolHandle,
 
 /*-----------------------------------------------------------*/
 
+IotTaskPoolError_t IotTaskPool_SetJobClass( IotTaskPoolJob_t pJob,
+                                            IotTaskPoolJobClass_t jobClass,
+                                            uint32_t deadlineMs )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
+    TASKPOOL_ON_ARG_ERROR_GOTO_CLEANUP( ( uint32_t ) jobClass >= TASKPOOL_JOB_CLASSES );
+
+    /* The class and the deadline are read when the job is queued, so they cannot change
+     * while the job is waiting in a queue. */
+    if( ( pJob->status == IOT_TASKPOOL_STATUS_SCHEDULED ) || ( pJob->status == IOT_TASKPOOL_STATUS_DEFERRED ) )
+    {
+        TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_ILLEGAL_OPERATION );
+    }
+
+    pJob->jobClass = jobClass;
+    pJob->deadlineMs = deadlineMs;
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotTaskPoolError_t IotTaskPool_SetLateJobCallback( IotTaskPool_t taskPoolHandle,
+                                                   IotTaskPoolLateJobCallback_t lateJobCallback,
+                                                   void * pContext )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+
+    _taskPool_t * pTaskPool = ( _taskPool_t * ) taskPoolHandle;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pTaskPool );
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        pTaskPool->lateJobCallback = lateJobCallback;
+        pTaskPool->pLateJobContext = pContext;
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPoolHandle,
                                           IotTaskPoolJob_t pJob,
                                           IotTaskPoolJobStatus_t * const pStatus )
@@ -841,7 +1180,7 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPoolHandle,
             TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
         }
 
-        *pStatus = pJob->status;
+        *pStatus = _getJobStatus( pTaskPool, pJob );
     }
     TASKPOOL_EXIT_CRITICAL();
 
@@ -850,27 +1189,23 @@ IotTaskPoolError_t IotTaskPool_GetStatus( IotTaskPool_t taskPoolHandle,
 
 /*-----------------------------------------------------------*/
 
-IotTaskPoolError_t IotTaskPool_TryCancel( IotTaskPool_t taskPoolHandle,
-                                          IotTaskPoolJob_t pJob,
-                                          IotTaskPoolJobStatus_t * const pStatus )
+IotTaskPoolError_t IotTaskPool_GetStats( IotTaskPool_t taskPoolHandle,
+                                         IotTaskPoolStats_t * const pStats )
 {
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
     _taskPool_t * pTaskPool = NULL;
 
     /* Parameter checking. */
     TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
-    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pStats );
 
     pTaskPool = ( _taskPool_t * )taskPoolHandle;
 
-    if( pStatus != NULL )
-    {
-        *pStatus = IOT_TASKPOOL_STATUS_UNDEFINED;
-    }
-
     TASKPOOL_ENTER_CRITICAL();
     {
-        /* Check again if this task pool is shutting down. */
+        uint32_t lane, level;
+
+        /* Bail out early if this task pool is shutting down. */
         if( _IsShutdownStarted( pTaskPool ) )
         {
             TASKPOOL_EXIT_CRITICAL();
@@ -878,15 +1213,125 @@ IotTaskPoolError_t IotTaskPool_TryCancel( IotTaskPool_t taskPoolHandle,
             TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
         }
 
-        status = _tryCancelInternal( pTaskPool, pJob, pStatus );
-    }
-    TASKPOOL_EXIT_CRITICAL();
+        /* Start from the statistics kept by the task pool, and add the gauges and the statistics of the lanes. */
+        *pStats = pTaskPool->stats;
 
-    TASKPOOL_NO_FUNCTION_CLEANUP();
-}
+        pStats->activeThreads = pTaskPool->activeThreads;
 
-IotTaskPoolJobStorage_t * IotTaskPool_GetJobStorageFromHandle( IotTaskPoolJob_t pJob )
-{
+        for( level = 0; level < TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+        {
+            pStats->deferredJobs += pTaskPool->timerWheel.pending[ level ];
+        }
+
+        for( lane = 0; lane < pTaskPool->laneCount; ++lane )
+        {
+            _taskPoolLane_t * pLane = &pTaskPool->lanes[ lane ];
+
+            TASKPOOL_ENTER_LANE_CRITICAL( pLane );
+            {
+                pStats->queuedJobs += pLane->queuedJobs;
+
+                if( pLane->peakQueuedJobs > pStats->peakQueuedJobs )
+                {
+                    pStats->peakQueuedJobs = pLane->peakQueuedJobs;
+                }
+
+                _histogramMerge( &pStats->queueDelay, &pLane->queueDelay );
+                _histogramMerge( &pStats->executionTime, &pLane->executionTime );
+            }
+            TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+        }
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotTaskPoolError_t IotTaskPool_ResetStats( IotTaskPool_t taskPoolHandle )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+    _taskPool_t * pTaskPool = NULL;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
+
+    pTaskPool = ( _taskPool_t * )taskPoolHandle;
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        uint32_t lane;
+
+        /* Bail out early if this task pool is shutting down. */
+        if( _IsShutdownStarted( pTaskPool ) )
+        {
+            TASKPOOL_EXIT_CRITICAL();
+
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
+        }
+
+        /* The gauges are computed when the statistics are taken, so clearing everything is safe. */
+        memset( &pTaskPool->stats, 0x00, sizeof( IotTaskPoolStats_t ) );
+
+        for( lane = 0; lane < pTaskPool->laneCount; ++lane )
+        {
+            _taskPoolLane_t * pLane = &pTaskPool->lanes[ lane ];
+
+            TASKPOOL_ENTER_LANE_CRITICAL( pLane );
+            {
+                pLane->peakQueuedJobs = pLane->queuedJobs;
+
+                memset( &pLane->queueDelay, 0x00, sizeof( IotTaskPoolHistogram_t ) );
+                memset( &pLane->executionTime, 0x00, sizeof( IotTaskPoolHistogram_t ) );
+            }
+            TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+        }
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotTaskPoolError_t IotTaskPool_TryCancel( IotTaskPool_t taskPoolHandle,
+                                          IotTaskPoolJob_t pJob,
+                                          IotTaskPoolJobStatus_t * const pStatus )
+{
+    TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
+    _taskPool_t * pTaskPool = NULL;
+
+    /* Parameter checking. */
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( taskPoolHandle );
+    TASKPOOL_ON_NULL_ARG_GOTO_CLEANUP( pJob );
+
+    pTaskPool = ( _taskPool_t * )taskPoolHandle;
+
+    if( pStatus != NULL )
+    {
+        *pStatus = IOT_TASKPOOL_STATUS_UNDEFINED;
+    }
+
+    TASKPOOL_ENTER_CRITICAL();
+    {
+        /* Check again if this task pool is shutting down. */
+        if( _IsShutdownStarted( pTaskPool ) )
+        {
+            TASKPOOL_EXIT_CRITICAL();
+
+            TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_SHUTDOWN_IN_PROGRESS );
+        }
+
+        status = _tryCancelInternal( pTaskPool, pJob, pStatus );
+    }
+    TASKPOOL_EXIT_CRITICAL();
+
+    TASKPOOL_NO_FUNCTION_CLEANUP();
+}
+
+IotTaskPoolJobStorage_t * IotTaskPool_GetJobStorageFromHandle( IotTaskPoolJob_t pJob )
+{
     return ( IotTaskPoolJobStorage_t * )pJob;
 }
 
@@ -952,7 +1397,7 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
 
     bool semStartStopInit = false;
     bool lockInit = false;
-    bool semDispatchInit = false;
+    uint32_t lanesInit = 0;
     bool timerInit = false;
 
     /* Zero out all data structures. */
@@ -961,14 +1406,21 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
     /* Initialize a job data structures that require no de-initialization.
      * All other data structures carry a value of 'NULL' before initialization.
      */
-    IotDeQueue_Create( &pTaskPool->dispatchQueue );
-    IotListDouble_Create( &pTaskPool->timerEventsList );
+    _timerWheelInit( &pTaskPool->timerWheel );
 
     pTaskPool->minThreads = pInfo->minThreads;
     pTaskPool->maxThreads = pInfo->maxThreads;
     pTaskPool->stackSize = pInfo->stackSize;
     pTaskPool->priority = pInfo->priority;
 
+    /* Use one lane per minimum thread, so that every lane always has at least one worker. */
+    pTaskPool->laneCount = pInfo->minThreads;
+
+    if( pTaskPool->laneCount > IOT_TASKPOOL_DISPATCH_QUEUES )
+    {
+        pTaskPool->laneCount = IOT_TASKPOOL_DISPATCH_QUEUES;
+    }
+
     _initJobsCache( &pTaskPool->jobsCache );
 
     /* Initialize the semaphore to ensure all threads have started. */
@@ -980,11 +1432,15 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
         {
             lockInit = true;
 
-            /* Initialize the semaphore for waiting for incoming work. */
-            if( IotSemaphore_Create( &pTaskPool->dispatchSignal, 0, TASKPOOL_MAX_SEM_VALUE ) == true )
+            /* Initialize the lanes for dispatching incoming work. */
+            while( ( lanesInit < pTaskPool->laneCount ) &&
+                   ( _initLane( pTaskPool, &pTaskPool->lanes[ lanesInit ] ) == true ) )
             {
-                semDispatchInit = true;
+                ++lanesInit;
+            }
 
+            if( lanesInit == pTaskPool->laneCount )
+            {
                 /* Create the timer mutex for a new connection. */
                 if( IotClock_TimerCreate( &( pTaskPool->timer ), _timerThread, pTaskPool ) == true )
                 {
@@ -1024,9 +1480,11 @@ static IotTaskPoolError_t _initTaskPoolControlStructures( const IotTaskPoolInfo_
             IotMutex_Destroy( &pTaskPool->lock );
         }
 
-        if( semDispatchInit == true )
+        while( lanesInit > 0UL )
         {
-            IotSemaphore_Destroy( &pTaskPool->dispatchSignal );
+            --lanesInit;
+
+            _destroyLane( &pTaskPool->lanes[ lanesInit ] );
         }
 
         if( timerInit == true )
@@ -1060,12 +1518,15 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
     /* jobs. A thread can be woken up for exit or for new jobs only at that point in time.  */
     /* The exit condition is setting the maximum number of threads to 0. */
 
-    /* Create the minimum number of threads specified by the user, and if one fails shutdown and return error. */
+    /* Create the minimum number of threads specified by the user, and if one fails shutdown and return error.
+     * Threads are bound to lanes in a round robin fashion. */
     for( ; threadsCreated < pTaskPool->minThreads; )
     {
+        _taskPoolLane_t * pLane = &pTaskPool->lanes[ threadsCreated % pTaskPool->laneCount ];
+
         /* Create one thread. */
         if( Iot_CreateDetachedThread( _taskPoolWorker,
-                                      pTaskPool,
+                                      pLane,
                                       pTaskPool->priority,
                                       pTaskPool->stackSize ) == false )
         {
@@ -1077,6 +1538,7 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
 
         /* Upon successful thread creation, increase the number of active threads. */
         pTaskPool->activeThreads++;
+        pLane->workers++;
 
         ++threadsCreated;
     }
@@ -1093,7 +1555,12 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
     if( TASKPOOL_FAILED( status ) )
     {
         /* Set the exit condition for the newly created threads. */
-        _signalShutdown( pTaskPool, threadsCreated );
+        if( controlInit == true )
+        {
+            TASKPOOL_ENTER_CRITICAL();
+            _signalShutdown( pTaskPool );
+            TASKPOOL_EXIT_CRITICAL();
+        }
 
         /* Signal all threads to exit. */
         for( count = 0; count < threadsCreated; ++count )
@@ -1114,12 +1581,62 @@ static IotTaskPoolError_t _createTaskPool( const IotTaskPoolInfo_t * const pInfo
 
 static void _destroyTaskPool( _taskPool_t * const pTaskPool )
 {
+    uint32_t lane;
+
     IotClock_TimerDestroy( &pTaskPool->timer );
-    IotSemaphore_Destroy( &pTaskPool->dispatchSignal );
+
+    for( lane = 0; lane < pTaskPool->laneCount; ++lane )
+    {
+        _destroyLane( &pTaskPool->lanes[ lane ] );
+    }
+
     IotSemaphore_Destroy( &pTaskPool->startStopSignal );
     IotMutex_Destroy( &pTaskPool->lock );
 }
 
+/*-----------------------------------------------------------*/
+
+static bool _initLane( _taskPool_t * const pTaskPool,
+                       _taskPoolLane_t * const pLane )
+{
+    bool result = false;
+    uint32_t jobClass;
+
+    for( jobClass = 0; jobClass < TASKPOOL_JOB_CLASSES; ++jobClass )
+    {
+        IotDeQueue_Create( &pLane->dispatchQueues[ jobClass ] );
+    }
+
+    _refillCredits( pLane );
+
+    pLane->activeJobs = 0;
+    pLane->workers = 0;
+    pLane->pTaskPool = pTaskPool;
+
+    if( IotMutex_Create( &pLane->lock, false ) == true )
+    {
+        /* Initialize the semaphore for waiting for incoming work. */
+        if( IotSemaphore_Create( &pLane->dispatchSignal, 0, TASKPOOL_MAX_SEM_VALUE ) == true )
+        {
+            result = true;
+        }
+        else
+        {
+            IotMutex_Destroy( &pLane->lock );
+        }
+    }
+
+    return result;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _destroyLane( _taskPoolLane_t * const pLane )
+{
+    IotSemaphore_Destroy( &pLane->dispatchSignal );
+    IotMutex_Destroy( &pLane->lock );
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 
 static void _taskPoolWorker( void * pUserContext )
@@ -1128,9 +1645,11 @@ static void _taskPoolWorker( void * pUserContext )
 
     IotTaskPoolRoutine_t userCallback = NULL;
     bool running = true;
+    _taskPoolJobTimes_t completedJob = { 0 };
 
-    /* Extract pTaskPool pointer from context. */
-    _taskPool_t * pTaskPool = ( _taskPool_t * ) pUserContext;
+    /* Extract the lane of this worker and the pTaskPool pointer from context. */
+    _taskPoolLane_t * pLane = ( _taskPoolLane_t * ) pUserContext;
+    _taskPool_t * pTaskPool = pLane->pTaskPool;
 
     /* Signal that this worker completed initialization and it is ready to receive notifications. */
     IotSemaphore_Post( &pTaskPool->startStopSignal );
@@ -1142,193 +1661,393 @@ static void _taskPoolWorker( void * pUserContext )
     do
     {
         bool jobAvailable;
-        IotLink_t * pFirst;
         _taskPoolJob_t * pJob = NULL;
 
-        /* Wait on incoming notifications. If waiting on the semaphore return with timeout, then
+        /* Wait on incoming notifications for this lane. If waiting on the semaphore return with timeout, then
          * it means that this thread should consider shutting down for the task pool to fold back
          * to its minimum number of threads. */
-        jobAvailable = IotSemaphore_TimedWait( &pTaskPool->dispatchSignal, IOT_TASKPOOL_JOB_WAIT_TIMEOUT_MS );
+        jobAvailable = IotSemaphore_TimedWait( &pLane->dispatchSignal, IOT_TASKPOOL_JOB_WAIT_TIMEOUT_MS );
+
+        /* Only look for a job if waiting did not timed out. Fetching a job only acquires
+         * lane locks, so that workers do not contend on the task pool lock. */
+        if( jobAvailable == true )
+        {
+            pJob = _fetchJob( pTaskPool, pLane, NULL, &userCallback );
+        }
 
-        /* Acquire the lock to check the exit condition, and release the lock if the exit condition is verified,
-         * or before waiting for incoming notifications.
+        /* Acquire the lock to check the exit condition only if there is no job to execute. Shutting down,
+         * reducing the max threads quota and shrinking all wake up workers without queuing a job.
          */
-        TASKPOOL_ENTER_CRITICAL();
+        if( pJob == NULL )
         {
-            /* If the exit condition is verified, update the number of active threads and exit the loop. */
-            if( _IsShutdownStarted( pTaskPool ) )
+            TASKPOOL_ENTER_CRITICAL();
             {
-                IotLogDebug( "Worker thread exiting because shutdown condition was set." );
-
-                /* Decrease the number of active threads. */
-                pTaskPool->activeThreads--;
-
-                TASKPOOL_EXIT_CRITICAL();
+                /* If the exit condition is verified, update the number of active threads and exit the loop. */
+                if( _IsShutdownStarted( pTaskPool ) )
+                {
+                    IotLogDebug( "Worker thread exiting because shutdown condition was set." );
 
-                /* Signal that this worker is exiting. */
-                IotSemaphore_Post( &pTaskPool->startStopSignal );
+                    /* Decrease the number of active threads. */
+                    pTaskPool->activeThreads--;
+                    pLane->workers--;
 
-                /* On shutdown, abandon the OUTER LOOP immediately. */
-                break;
-            }
+                    TASKPOOL_EXIT_CRITICAL();
 
-            /* Check if this thread needs to exit because 'max threads' quota was exceeded.
-             * In that case, let it run once, so we can support the case for scheduling 'high priority'
-             * jobs that causes exceeding the max threads quota for the purpose of executing
-             * the high-priority task. */
-            if( pTaskPool->activeThreads > pTaskPool->maxThreads )
-            {
-                IotLogDebug( "Worker thread will exit because maximum quota was exceeded." );
+                    /* Signal that this worker is exiting. */
+                    IotSemaphore_Post( &pTaskPool->startStopSignal );
 
-                /* Decrease the number of active threads pro-actively. */
-                pTaskPool->activeThreads--;
+                    /* On shutdown, abandon the OUTER LOOP immediately. */
+                    break;
+                }
 
-                /* Mark this thread as dead. */
-                running = false;
-            }
-            /* Check if this thread needs to exit  because the worker woke up after a timeout. */
-            else if( jobAvailable == false )
-            {
-                /* If there was a timeout, shrink back the task pool to the minimum number of threads. */
-                if( pTaskPool->activeThreads > pTaskPool->minThreads )
+                /* A lane always keeps at least one worker, otherwise jobs with an affinity hint for
+                 * the lane could not be executed. */
+                if( pLane->workers > 1UL )
                 {
-                    /* After waking up from a timeout, the thread will try and pick up a new job.
-                     * But if there is no job available, the thread will exit to ensure that
-                     * the taskpool does not have more than minimum number of active threads. */
-                    IotLogDebug( "Worker will exit because task pool is shrinking." );
+                    /* Check if this thread needs to exit because 'max threads' quota was exceeded.
+                     * Threads may exceed the quota for the purpose of executing 'high priority' jobs. */
+                    if( pTaskPool->activeThreads > pTaskPool->maxThreads )
+                    {
+                        IotLogDebug( "Worker thread will exit because maximum quota was exceeded." );
 
-                    /* Decrease the number of active threads pro-actively. */
-                    pTaskPool->activeThreads--;
+                        /* Mark this thread as dead. */
+                        running = false;
+                    }
+                    /* Check if this thread needs to exit because the worker woke up after a timeout. */
+                    else if( ( jobAvailable == false ) && ( pTaskPool->activeThreads > pTaskPool->minThreads ) )
+                    {
+                        /* If there was a timeout, shrink back the task pool to the minimum number of threads. */
+                        IotLogDebug( "Worker will exit because task pool is shrinking." );
 
-                    /* Mark this thread as dead. */
-                    running = false;
+                        /* Mark this thread as dead. */
+                        running = false;
+                    }
                 }
-            }
-
-            /* Only look for a job if waiting did not timed out. */
-            if( jobAvailable == true )
-            {
-                /* Dequeue the first job in FIFO order. */
-                pFirst = IotDeQueue_DequeueHead( &pTaskPool->dispatchQueue );
 
-                /* If there is indeed a job, then update status under lock, and release the lock before processing the job. */
-                if( pFirst != NULL )
+                if( running == false )
                 {
-                    /* Extract the job from its link. */
-                    pJob = IotLink_Container( _taskPoolJob_t, pFirst, link );
+                    /* Decrease the number of active threads pro-actively. */
+                    pTaskPool->activeThreads--;
+                    pLane->workers--;
 
-                    /* Update status to 'executing'. */
-                    pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
-                    userCallback = pJob->userCallback;
+                    pTaskPool->stats.threadsExited++;
                 }
             }
+            TASKPOOL_EXIT_CRITICAL();
         }
-        TASKPOOL_EXIT_CRITICAL();
 
         /* INNER LOOP: it controls the execution of jobs: the exit condition is the lack of a job to execute. */
         while( pJob != NULL )
         {
+            /* The job may be recycled by its callback, so its queueing time must be read before. */
+            uint64_t startTime = IotClock_GetTimeMs();
+
+            completedJob.queueDelayMs = ( startTime > pJob->queuedTime ) ? ( uint32_t ) ( startTime - pJob->queuedTime ) : 0UL;
+
             /* Process the job by invoking the associated callback with the user context.
              * This task pool thread will not be available until the user callback returns.
              */
+            IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
+            IotTaskPool_Assert( userCallback != NULL );
+
+            if( pJob->deadline != 0ULL )
             {
-                IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) == false );
-                IotTaskPool_Assert( userCallback != NULL );
+                _reportLateJob( pTaskPool, pJob );
+            }
 
-                userCallback( pTaskPool, pJob, pJob->pUserContext );
+            userCallback( pTaskPool, pJob, pJob->pUserContext );
 
-                /* This job is finished, clear its pointer. */
-                pJob = NULL;
-                userCallback = NULL;
+            completedJob.executionTimeMs = ( uint32_t ) ( IotClock_GetTimeMs() - startTime );
 
-                /* If this thread exceeded the quota, then let it terminate. */
-                if( running == false )
-                {
-                    /* Abandon the INNER LOOP. Execution will tranfer back to the OUTER LOOP condition. */
-                    break;
-                }
-            }
+            /* This job is finished, clear its pointer. */
+            pJob = NULL;
+            userCallback = NULL;
 
-            /* Acquire the lock before updating the job status. */
-            TASKPOOL_ENTER_CRITICAL();
-            {
-                /* Update the number of busy threads, so new requests can be served by creating new threads, up to maxThreads. */
-                pTaskPool->activeJobs--;
+            /* Update the number of busy workers and the statistics of the lane, and try and fetch the next job. */
+            pJob = _fetchJob( pTaskPool, pLane, &completedJob, &userCallback );
+        }
+    } while( running == true );
+}
 
-                /* Try and dequeue the next job in the dispatch queue. */
-                IotLink_t * pItem = NULL;
+/*-----------------------------------------------------------*/
 
-                /* Dequeue the next job from the dispatch queue. */
-                pItem = IotDeQueue_DequeueHead( &pTaskPool->dispatchQueue );
+static _taskPoolJob_t * _fetchJob( _taskPool_t * const pTaskPool,
+                                   _taskPoolLane_t * const pLane,
+                                   const _taskPoolJobTimes_t * const pCompletedJob,
+                                   IotTaskPoolRoutine_t * const pUserCallback )
+{
+    _taskPoolJob_t * pJob = NULL;
+    IotLink_t * pItem = NULL;
+    uint32_t lane = ( uint32_t ) ( pLane - pTaskPool->lanes );
+    uint32_t count;
 
-                /* If there is no job left in the dispatch queue, update the worker status and leave. */
-                if( pItem == NULL )
-                {
-                    TASKPOOL_EXIT_CRITICAL();
+    TASKPOOL_ENTER_LANE_CRITICAL( pLane );
+    {
+        /* A job is counted by its lane until it completes, so dequeuing it does not change the count. */
+        if( pCompletedJob != NULL )
+        {
+            pLane->activeJobs--;
+            ( void ) Atomic_Decrement_u32( &pTaskPool->activeJobs );
 
-                    /* Abandon the INNER LOOP. Execution will tranfer back to the OUTER LOOP condition. */
-                    break;
-                }
-                else
-                {
-                    pJob = IotLink_Container( _taskPoolJob_t, pItem, link );
+            _histogramRecord( &pLane->queueDelay, pCompletedJob->queueDelayMs );
+            _histogramRecord( &pLane->executionTime, pCompletedJob->executionTimeMs );
+        }
 
-                    userCallback = pJob->userCallback;
-                }
+        /* Dequeue the next job in order of deadline and class. */
+        pItem = _dequeueWeighted( pLane );
+
+        if( pItem != NULL )
+        {
+            pLane->queuedJobs--;
+
+            pJob = IotLink_Container( _taskPoolJob_t, pItem, link );
+
+            /* Update status to 'executing'. */
+            pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
+            *pUserCallback = pJob->userCallback;
+        }
+    }
+    TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+
+    /* If this lane is empty, steal the first job that is not pinned to its lane from the other lanes,
+     * from the highest class that has one. */
+    for( count = 1; ( pJob == NULL ) && ( count < pTaskPool->laneCount ); ++count )
+    {
+        _taskPoolLane_t * pVictim = &pTaskPool->lanes[ ( lane + count ) % pTaskPool->laneCount ];
+        uint32_t jobClass;
+
+        TASKPOOL_ENTER_LANE_CRITICAL( pVictim );
+        {
+            pItem = NULL;
+
+            for( jobClass = 0; ( pItem == NULL ) && ( jobClass < TASKPOOL_JOB_CLASSES ); ++jobClass )
+            {
+                pItem = IotListDouble_FindFirstMatch( &pVictim->dispatchQueues[ jobClass ], NULL, _matchStealableJob, NULL );
+            }
 
+            if( pItem != NULL )
+            {
+                IotDeQueue_Remove( pItem );
+
+                pVictim->activeJobs--;
+                pVictim->queuedJobs--;
+
+                pJob = IotLink_Container( _taskPoolJob_t, pItem, link );
+
+                /* Update status to 'executing'. */
                 pJob->status = IOT_TASKPOOL_STATUS_COMPLETED;
+                *pUserCallback = pJob->userCallback;
             }
-            TASKPOOL_EXIT_CRITICAL();
         }
-    } while( running == true );
-}
+        TASKPOOL_EXIT_LANE_CRITICAL( pVictim );
 
-/* ---------------------------------------------------------------------------------------------- */
+        /* The stolen job is now counted by the lane of this worker. */
+        if( pJob != NULL )
+        {
+            IotLogDebug( "Worker of lane %u stole a job from lane %u.", lane, ( lane + count ) % pTaskPool->laneCount );
 
-static void _initJobsCache( _taskPoolCache_t * const pCache )
-{
-    IotDeQueue_Create( &pCache->freeList );
+            TASKPOOL_ENTER_LANE_CRITICAL( pLane );
+            pLane->activeJobs++;
+            TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+        }
+    }
 
-    pCache->freeCount = 0;
+    return pJob;
 }
 
 /*-----------------------------------------------------------*/
 
-static void _initializeJob( _taskPoolJob_t * const pJob,
-                            IotTaskPoolRoutine_t userCallback,
-                            void * pUserContext,
-                            bool isStatic )
+static bool _matchStealableJob( const IotLink_t * const pLink,
+                                void * pMatch )
 {
-    pJob->link.pNext = NULL;
-    pJob->link.pPrevious = NULL;
-    pJob->userCallback = userCallback;
-    pJob->pUserContext = pUserContext;
+    const _taskPoolJob_t * const pJob = IotLink_Container( _taskPoolJob_t, pLink, link );
 
-    if( isStatic )
-    {
-        pJob->flags = IOT_TASK_POOL_INTERNAL_STATIC;
-        pJob->status = IOT_TASKPOOL_STATUS_READY;
-    }
-    else
-    {
-        pJob->status = IOT_TASKPOOL_STATUS_READY;
-    }
+    ( void ) pMatch;
+
+    return( ( pJob->flags & IOT_TASK_POOL_INTERNAL_PINNED ) == 0UL );
 }
 
-static _taskPoolJob_t * _fetchOrAllocateJob( _taskPoolCache_t * const pCache )
+/*-----------------------------------------------------------*/
+
+static IotLink_t * _dequeueWeighted( _taskPoolLane_t * const pLane )
 {
-    _taskPoolJob_t * pJob = NULL;
-    IotLink_t * pLink = IotListDouble_RemoveHead( &( pCache->freeList ) );
+    IotLink_t * pItem = NULL;
+    uint32_t jobClass, round;
+    uint64_t now = 0;
 
-    if( pLink != NULL )
+    /* A job at the head of its queue that missed its deadline goes first. Only the heads are
+     * checked, so that dequeueing takes constant time. */
+    for( jobClass = 0; ( pItem == NULL ) && ( jobClass < TASKPOOL_JOB_CLASSES ); ++jobClass )
     {
-        pJob = IotLink_Container( _taskPoolJob_t, pLink, link );
-    }
+        IotLink_t * pHead = IotDeQueue_PeekHead( &pLane->dispatchQueues[ jobClass ] );
 
-    /* If there is no available job in the cache, then allocate one. */
-    if( pJob == NULL )
-    {
-        pJob = ( _taskPoolJob_t * ) IotTaskPool_MallocJob( sizeof( _taskPoolJob_t ) );
+        if( ( pHead != NULL ) && ( IotLink_Container( _taskPoolJob_t, pHead, link )->deadline != 0ULL ) )
+        {
+            if( now == 0ULL )
+            {
+                now = IotClock_GetTimeMs();
+            }
+
+            if( IotLink_Container( _taskPoolJob_t, pHead, link )->deadline <= now )
+            {
+                IotDeQueue_Remove( pHead );
+
+                pItem = pHead;
+            }
+        }
+    }
+
+    /* Otherwise serve the classes in order of priority, each up to its weight. When no class with
+     * queued jobs has credits left, start a new round. */
+    for( round = 0; ( pItem == NULL ) && ( round < 2U ); ++round )
+    {
+        for( jobClass = 0; jobClass < TASKPOOL_JOB_CLASSES; ++jobClass )
+        {
+            if( ( pLane->credits[ jobClass ] > 0U ) &&
+                ( IotDeQueue_IsEmpty( &pLane->dispatchQueues[ jobClass ] ) == false ) )
+            {
+                pLane->credits[ jobClass ]--;
+
+                pItem = IotDeQueue_DequeueHead( &pLane->dispatchQueues[ jobClass ] );
+
+                break;
+            }
+        }
+
+        if( pItem == NULL )
+        {
+            _refillCredits( pLane );
+        }
+    }
+
+    return pItem;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _refillCredits( _taskPoolLane_t * const pLane )
+{
+    pLane->credits[ IOT_TASKPOOL_CLASS_CONTROL ] = IOT_TASKPOOL_CLASS_CONTROL_WEIGHT;
+    pLane->credits[ IOT_TASKPOOL_CLASS_DEFAULT ] = IOT_TASKPOOL_CLASS_DEFAULT_WEIGHT;
+    pLane->credits[ IOT_TASKPOOL_CLASS_BULK ] = IOT_TASKPOOL_CLASS_BULK_WEIGHT;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _reportLateJob( _taskPool_t * const pTaskPool,
+                            _taskPoolJob_t * const pJob )
+{
+    uint64_t now = IotClock_GetTimeMs();
+    IotTaskPoolLateJobCallback_t lateJobCallback = pTaskPool->lateJobCallback;
+
+    if( now > pJob->deadline )
+    {
+        IotLogDebug( "Job %p started %lu ms past its deadline.", pJob, ( unsigned long ) ( now - pJob->deadline ) );
+
+        if( lateJobCallback != NULL )
+        {
+            lateJobCallback( pTaskPool, pJob, ( uint32_t ) ( now - pJob->deadline ), pTaskPool->pLateJobContext );
+        }
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+static void _histogramRecord( IotTaskPoolHistogram_t * const pHistogram,
+                              uint64_t durationMs )
+{
+    uint32_t bucket = 0;
+    uint32_t clampedMs = ( durationMs > UINT32_MAX ) ? UINT32_MAX : ( uint32_t ) durationMs;
+
+    /* Bucket i holds the durations in [2^(i-1), 2^i) ms, bucket 0 the durations under 1 ms. */
+    while( ( bucket < ( IOT_TASKPOOL_HISTOGRAM_BUCKETS - 1 ) ) && ( ( clampedMs >> bucket ) != 0UL ) )
+    {
+        bucket++;
+    }
+
+    pHistogram->buckets[ bucket ]++;
+    pHistogram->count++;
+    pHistogram->sumMs += clampedMs;
+
+    if( clampedMs > pHistogram->maxMs )
+    {
+        pHistogram->maxMs = clampedMs;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _histogramMerge( IotTaskPoolHistogram_t * const pTotal,
+                             const IotTaskPoolHistogram_t * const pHistogram )
+{
+    uint32_t bucket;
+
+    for( bucket = 0; bucket < IOT_TASKPOOL_HISTOGRAM_BUCKETS; ++bucket )
+    {
+        pTotal->buckets[ bucket ] += pHistogram->buckets[ bucket ];
+    }
+
+    pTotal->count += pHistogram->count;
+    pTotal->sumMs += pHistogram->sumMs;
+
+    if( pHistogram->maxMs > pTotal->maxMs )
+    {
+        pTotal->maxMs = pHistogram->maxMs;
+    }
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+static void _initJobsCache( _taskPoolCache_t * const pCache )
+{
+    IotDeQueue_Create( &pCache->freeList );
+
+    pCache->freeCount = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _initializeJob( _taskPoolJob_t * const pJob,
+                            IotTaskPoolRoutine_t userCallback,
+                            void * pUserContext,
+                            bool isStatic )
+{
+    pJob->link.pNext = NULL;
+    pJob->link.pPrevious = NULL;
+    pJob->userCallback = userCallback;
+    pJob->pUserContext = pUserContext;
+    pJob->lane = 0;
+    pJob->pTimerEvent = NULL;
+    pJob->jobClass = IOT_TASKPOOL_CLASS_DEFAULT;
+    pJob->deadlineMs = 0;
+    pJob->deadline = 0;
+    pJob->queuedTime = 0;
+
+    if( isStatic )
+    {
+        pJob->flags = IOT_TASK_POOL_INTERNAL_STATIC;
+        pJob->status = IOT_TASKPOOL_STATUS_READY;
+    }
+    else
+    {
+        pJob->status = IOT_TASKPOOL_STATUS_READY;
+    }
+}
+
+static _taskPoolJob_t * _fetchOrAllocateJob( _taskPoolCache_t * const pCache )
+{
+    _taskPoolJob_t * pJob = NULL;
+    IotLink_t * pLink = IotListDouble_RemoveHead( &( pCache->freeList ) );
+
+    if( pLink != NULL )
+    {
+        pJob = IotLink_Container( _taskPoolJob_t, pLink, link );
+    }
+
+    /* If there is no available job in the cache, then allocate one. */
+    if( pJob == NULL )
+    {
+        pJob = ( _taskPoolJob_t * ) IotTaskPool_MallocJob( sizeof( _taskPoolJob_t ) );
 
         if( pJob != NULL )
         {
@@ -1408,21 +2127,106 @@ static bool _IsShutdownStarted( const _taskPool_t * const pTaskPool )
 
 /*-----------------------------------------------------------*/
 
-static void _signalShutdown( _taskPool_t * const pTaskPool,
-                             uint32_t threads )
+static void _signalShutdown( _taskPool_t * const pTaskPool )
 {
-    uint32_t count;
+    uint32_t count, lane;
 
     /* Set the exit condition. */
     pTaskPool->maxThreads = 0;
 
     /* Broadcast to all active threads to wake-up. Active threads do check the exit condition right after waking up. */
-    for( count = 0; count < threads; ++count )
+    for( lane = 0; lane < pTaskPool->laneCount; ++lane )
     {
-        IotSemaphore_Post( &pTaskPool->dispatchSignal );
+        for( count = 0; count < pTaskPool->lanes[ lane ].workers; ++count )
+        {
+            IotSemaphore_Post( &pTaskPool->lanes[ lane ].dispatchSignal );
+        }
     }
 }
 
+/*-----------------------------------------------------------*/
+
+static uint32_t _selectLane( _taskPool_t * const pTaskPool,
+                             uint32_t flags )
+{
+    uint32_t lane;
+
+    if( ( flags & TASKPOOL_JOB_AFFINITY_FLAG ) == TASKPOOL_JOB_AFFINITY_FLAG )
+    {
+        /* Jobs with the same affinity key always go to the same lane. */
+        lane = ( ( uint32_t ) ( TASKPOOL_JOB_AFFINITY_KEY( flags ) * TASKPOOL_AFFINITY_HASH_MULTIPLIER ) >> 16 ) % pTaskPool->laneCount;
+    }
+    else
+    {
+        /* Spread all other jobs across lanes in a round robin fashion. */
+        lane = Atomic_Increment_u32( &pTaskPool->nextLane ) % pTaskPool->laneCount;
+    }
+
+    return lane;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _shouldGrow( const _taskPool_t * const pTaskPool,
+                         uint32_t flags )
+{
+    bool shouldGrow = false;
+    uint32_t activeThreads = pTaskPool->activeThreads;
+
+    /* Only count the active jobs if the task pool can grow at all. */
+    if( ( ( flags & IOT_TASKPOOL_JOB_HIGH_PRIORITY ) == IOT_TASKPOOL_JOB_HIGH_PRIORITY ) ||
+        ( activeThreads < pTaskPool->maxThreads ) )
+    {
+        /* Count the new job optimistically, so new requests can be served by creating new threads. */
+        shouldGrow = ( activeThreads <= ( pTaskPool->activeJobs + 1UL ) );
+    }
+
+    return shouldGrow;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _wakeIdleLane( _taskPool_t * const pTaskPool,
+                           uint32_t busyLane )
+{
+    uint32_t count;
+    bool idle = false;
+
+    for( count = 1; ( idle == false ) && ( count < pTaskPool->laneCount ); ++count )
+    {
+        _taskPoolLane_t * pLane = &pTaskPool->lanes[ ( busyLane + count ) % pTaskPool->laneCount ];
+
+        /* The number of workers in a lane is protected by the task pool lock, which the caller may not
+         * hold. A stale count only wakes a worker that finds nothing to steal, or none at all. */
+        TASKPOOL_ENTER_LANE_CRITICAL( pLane );
+        idle = ( pLane->activeJobs < pLane->workers );
+        TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+
+        if( idle == true )
+        {
+            IotSemaphore_Post( &pLane->dispatchSignal );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static IotTaskPoolJobStatus_t _getJobStatus( _taskPool_t * const pTaskPool,
+                                             _taskPoolJob_t * const pJob )
+{
+    IotTaskPoolJobStatus_t status;
+    _taskPoolLane_t * pLane = &pTaskPool->lanes[ pJob->lane ];
+
+    IotTaskPool_Assert( pJob->lane < pTaskPool->laneCount );
+
+    /* Workers update the status of a scheduled job under the lock of its lane. */
+    TASKPOOL_ENTER_LANE_CRITICAL( pLane );
+    status = pJob->status;
+    TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+
+    return status;
+}
+
 /* ---------------------------------------------------------------------------------------------- */
 
 static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
@@ -1433,19 +2237,14 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
 
     bool mustGrow = false;
     bool shouldGrow = false;
-
-    /* Update the job status to 'scheduled'. */
-    pJob->status = IOT_TASKPOOL_STATUS_SCHEDULED;
-
-    /* Update the number of active jobs optimistically, so new requests can be served by creating new threads. */
-    pTaskPool->activeJobs++;
+    uint32_t lane = _selectLane( pTaskPool, flags );
+    _taskPoolLane_t * pLane = &pTaskPool->lanes[ lane ];
 
     /* If all threads are busy, try and create a new one. Failing to create a new thread
      * only has performance implications on correctly executing the scheduled job.
+     * The new thread is bound to the lane of the job.
      */
-    uint32_t activeThreads = pTaskPool->activeThreads;
-
-    if( activeThreads <= pTaskPool->activeJobs )
+    if( _shouldGrow( pTaskPool, flags ) == true )
     {
         /* If the job scheduling is tagged as high priority, then we must grow the task pool,
          * no matter how many threads are active already. */
@@ -1457,38 +2256,39 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
         /* Grow the task pool up to the maximum number of threads indicated by the user.
          * Growing the taskpool can safely fail, the existing threads will eventually pick up
          * the job sometimes later. */
-        else if( activeThreads < pTaskPool->maxThreads )
+        else
         {
             shouldGrow = true;
         }
-        else
+    }
+
+    if( ( mustGrow == true ) || ( shouldGrow == true ) )
+    {
+        IotLogInfo( "Growing a Task pool with a new worker thread..." );
+
+        if( Iot_CreateDetachedThread( _taskPoolWorker,
+                                      pLane,
+                                      pTaskPool->priority,
+                                      pTaskPool->stackSize ) )
         {
-            /* Nothing to do. */
-        }
+            IotSemaphore_Wait( &pTaskPool->startStopSignal );
+
+            pTaskPool->activeThreads++;
+            pLane->workers++;
 
-        if( ( mustGrow == true ) || ( shouldGrow == true ) )
+            pTaskPool->stats.threadsCreated++;
+        }
+        else
         {
-            IotLogInfo( "Growing a Task pool with a new worker thread..." );
+            /* Failure to create a worker thread may not hinder functional correctness, but rather just responsiveness. */
+            IotLogWarn( "Task pool failed to create a worker thread." );
 
-            if( Iot_CreateDetachedThread( _taskPoolWorker,
-                                          pTaskPool,
-                                          pTaskPool->priority,
-                                          pTaskPool->stackSize ) )
-            {
-                IotSemaphore_Wait( &pTaskPool->startStopSignal );
+            pTaskPool->stats.threadCreateFailures++;
 
-                pTaskPool->activeThreads++;
-            }
-            else
+            /* Failure to create a worker thread for a high priority job is considered a failure. */
+            if( mustGrow )
             {
-                /* Failure to create a worker thread may not hinder functional correctness, but rather just responsiveness. */
-                IotLogWarn( "Task pool failed to create a worker thread." );
-
-                /* Failure to create a worker thread for a high priority job is considered a failure. */
-                if( mustGrow )
-                {
-                    TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_NO_MEMORY );
-                }
+                TASKPOOL_SET_AND_GOTO_CLEANUP( IOT_TASKPOOL_NO_MEMORY );
             }
         }
     }
@@ -1497,31 +2297,15 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
 
     if( TASKPOOL_SUCCEEDED( status ) )
     {
-        /* Append the job to the dispatch queue.
-         * Put the job at the front, if it is a high priority job. */
-        if(mustGrow == true )
-        {
-            IotLogDebug( "High priority job: placing job at the head of the queue." );
-
-            IotDeQueue_EnqueueHead( &pTaskPool->dispatchQueue, &pJob->link );
-        }
-        else
-        {
-            IotDeQueue_EnqueueTail( &pTaskPool->dispatchQueue, &pJob->link );
-        }
-
-
-        /* Signal a worker to pick up the job. */
-        IotSemaphore_Post( &pTaskPool->dispatchSignal );
+        /* Dispatching cannot fail, the caller holds the task pool lock and checked that the task
+         * pool is not shutting down. */
+        ( void ) _dispatchJob( pTaskPool, pJob, lane, flags );
     }
     else
     {
         /* Scheduling can only fail to allocate a new worker, which is an error
          * only for high priority tasks. */
         IotTaskPool_Assert( mustGrow == true );
-
-        /* Revert updating the number of active jobs. */
-        pTaskPool->activeJobs--;
     }
 
     TASKPOOL_FUNCTION_CLEANUP_END();
@@ -1529,19 +2313,108 @@ static IotTaskPoolError_t _scheduleInternal( _taskPool_t * const pTaskPool,
 
 /*-----------------------------------------------------------*/
 
-static bool _matchJobByPointer( const IotLink_t * const pLink,
-                                void * pMatch )
+static bool _dispatchJob( _taskPool_t * const pTaskPool,
+                          _taskPoolJob_t * const pJob,
+                          uint32_t lane,
+                          uint32_t flags )
 {
-    const _taskPoolJob_t * const pJob = ( _taskPoolJob_t * ) pMatch;
+    bool dispatched = false;
+    bool laneIsBusy = false;
+    bool pinned = ( ( flags & TASKPOOL_JOB_AFFINITY_FLAG ) == TASKPOOL_JOB_AFFINITY_FLAG );
+    _taskPoolLane_t * pLane = &pTaskPool->lanes[ lane ];
+    uint64_t now = IotClock_GetTimeMs();
+    uint64_t deadline = 0;
 
-    const _taskPoolTimerEvent_t * const pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
+    /* The deadline of a job starts when the job is queued for execution. */
+    if( pJob->deadlineMs != 0UL )
+    {
+        deadline = now + pJob->deadlineMs;
+    }
 
-    if( pJob == pTimerEvent->pJob )
+    TASKPOOL_ENTER_LANE_CRITICAL( pLane );
     {
-        return true;
+        /* The task pool clears the lanes after it sets the exit condition, so a job accepted
+         * here is either cleared or executed. */
+        if( _IsShutdownStarted( pTaskPool ) == false )
+        {
+            /* Update the job status to 'scheduled'. */
+            pJob->status = IOT_TASKPOOL_STATUS_SCHEDULED;
+            pJob->lane = lane;
+            pJob->deadline = deadline;
+            pJob->queuedTime = now;
+
+            /* Jobs with an affinity hint must not be stolen by workers of other lanes. */
+            if( pinned == true )
+            {
+                pJob->flags |= IOT_TASK_POOL_INTERNAL_PINNED;
+            }
+            else
+            {
+                pJob->flags &= ~IOT_TASK_POOL_INTERNAL_PINNED;
+            }
+
+            /* Append the job to the dispatch queue of its class in the lane.
+             * Put the job at the front, if it is a high priority job. */
+            if( ( flags & IOT_TASKPOOL_JOB_HIGH_PRIORITY ) == IOT_TASKPOOL_JOB_HIGH_PRIORITY )
+            {
+                IotLogDebug( "High priority job: placing job at the head of the queue." );
+
+                IotDeQueue_EnqueueHead( &pLane->dispatchQueues[ pJob->jobClass ], &pJob->link );
+            }
+            else
+            {
+                IotDeQueue_EnqueueTail( &pLane->dispatchQueues[ pJob->jobClass ], &pJob->link );
+            }
+
+            pLane->activeJobs++;
+            pLane->queuedJobs++;
+            ( void ) Atomic_Increment_u32( &pTaskPool->activeJobs );
+
+            if( pLane->queuedJobs > pLane->peakQueuedJobs )
+            {
+                pLane->peakQueuedJobs = pLane->queuedJobs;
+            }
+
+            laneIsBusy = ( pLane->activeJobs > pLane->workers );
+            dispatched = true;
+        }
     }
+    TASKPOOL_EXIT_LANE_CRITICAL( pLane );
+
+    if( dispatched == true )
+    {
+        /* Signal a worker of the lane to pick up the job. */
+        IotSemaphore_Post( &pLane->dispatchSignal );
 
-    return false;
+        /* If all workers of the lane are busy, let an idle worker of another lane steal the job.
+         * The job must not be accessed anymore at this point, a worker may have executed it already. */
+        if( ( laneIsBusy == true ) && ( pinned == false ) )
+        {
+            _wakeIdleLane( pTaskPool, lane );
+        }
+    }
+
+    return dispatched;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _tryScheduleUnlocked( _taskPool_t * const pTaskPool,
+                                  _taskPoolJob_t * const pJob,
+                                  uint32_t flags )
+{
+    bool scheduled = false;
+
+    /* A job that is scheduled, deferred or in the cache must be extracted under the task pool lock,
+     * and only the task pool lock allows to create a new worker thread. */
+    if( ( _getJobStatus( pTaskPool, pJob ) == IOT_TASKPOOL_STATUS_READY ) &&
+        ( IotLink_IsLinked( &pJob->link ) == false ) &&
+        ( _shouldGrow( pTaskPool, flags ) == false ) )
+    {
+        scheduled = _dispatchJob( pTaskPool, pJob, _selectLane( pTaskPool, flags ), flags );
+    }
+
+    return scheduled;
 }
 
 /*-----------------------------------------------------------*/
@@ -1553,30 +2426,60 @@ static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
 
     bool cancelable = false;
+    _taskPoolLane_t * pLane = &pTaskPool->lanes[ pJob->lane ];
+
+    IotTaskPool_Assert( pJob->lane < pTaskPool->laneCount );
 
     /* We can only cancel jobs that are either 'ready' (waiting to be scheduled). 'deferred', or 'scheduled'. */
 
-    IotTaskPoolJobStatus_t currentStatus = pJob->status;
+    IotTaskPoolJobStatus_t currentStatus;
 
-    switch( currentStatus )
+    /* Hold the lane lock, so that a worker cannot dequeue a 'scheduled' job while it is canceled. */
+    TASKPOOL_ENTER_LANE_CRITICAL( pLane );
     {
-        case IOT_TASKPOOL_STATUS_READY:
-        case IOT_TASKPOOL_STATUS_DEFERRED:
-        case IOT_TASKPOOL_STATUS_SCHEDULED:
-        case IOT_TASKPOOL_STATUS_CANCELED:
-            cancelable = true;
-            break;
+        currentStatus = pJob->status;
 
-        case IOT_TASKPOOL_STATUS_COMPLETED:
-            /* Log message for debugging purposes. */
-            IotLogWarn( "Attempt to cancel a job that is already executing, or canceled." );
-            break;
+        switch( currentStatus )
+        {
+            case IOT_TASKPOOL_STATUS_READY:
+            case IOT_TASKPOOL_STATUS_DEFERRED:
+            case IOT_TASKPOOL_STATUS_SCHEDULED:
+            case IOT_TASKPOOL_STATUS_CANCELED:
+                cancelable = true;
+                break;
 
-        default:
-            /* Log message for debugging purposes. */
-            IotLogError( "Attempt to cancel a job with an undefined state." );
-            break;
+            case IOT_TASKPOOL_STATUS_COMPLETED:
+                /* Log message for debugging purposes. */
+                IotLogWarn( "Attempt to cancel a job that is already executing, or canceled." );
+                break;
+
+            default:
+                /* Log message for debugging purposes. */
+                IotLogError( "Attempt to cancel a job with an undefined state." );
+                break;
+        }
+
+        if( cancelable == true )
+        {
+            /* Update the status of the job. */
+            pJob->status = IOT_TASKPOOL_STATUS_CANCELED;
+
+            /* If the job is cancelable and its current status is 'scheduled' then unlink it from the dispatch
+             * queue of its lane. */
+            if( currentStatus == IOT_TASKPOOL_STATUS_SCHEDULED )
+            {
+                /* A scheduled work items must be in the dispatch queue. */
+                IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) );
+
+                IotDeQueue_Remove( &pJob->link );
+
+                pLane->activeJobs--;
+                pLane->queuedJobs--;
+                ( void ) Atomic_Decrement_u32( &pTaskPool->activeJobs );
+            }
+        }
     }
+    TASKPOOL_EXIT_LANE_CRITICAL( pLane );
 
     /* Update the returned status to the current status of the job. */
     if( pStatus != NULL )
@@ -1590,59 +2493,31 @@ static IotTaskPoolError_t _tryCancelInternal( _taskPool_t * const pTaskPool,
     }
     else
     {
-        /* Update the status of the job. */
-        pJob->status = IOT_TASKPOOL_STATUS_CANCELED;
-
-        /* If the job is cancelable and its current status is 'scheduled' then unlink it from the dispatch
-         * queue and signal any waiting threads. */
-        if( currentStatus == IOT_TASKPOOL_STATUS_SCHEDULED )
-        {
-            /* A scheduled work items must be in the dispatch queue. */
-            IotTaskPool_Assert( IotLink_IsLinked( &pJob->link ) );
-
-            IotDeQueue_Remove( &pJob->link );
-        }
-
         /* If the job current status is 'deferred' then the job has to be pending
          * in the timeouts queue. */
-        else if( currentStatus == IOT_TASKPOOL_STATUS_DEFERRED )
+        if( currentStatus == IOT_TASKPOOL_STATUS_DEFERRED )
         {
-            /* Find the timer event associated with the current job. There MUST be one, hence assert if not. */
-            IotLink_t * pTimerEventLink = IotListDouble_FindFirstMatch( &pTaskPool->timerEventsList, NULL, _matchJobByPointer, pJob );
-            IotTaskPool_Assert( pTimerEventLink != NULL );
+            /* The timer event of a deferred job is linked in the timer wheel. There MUST be one, hence assert if not. */
+            _taskPoolTimerEvent_t * pTimerEvent = pJob->pTimerEvent;
+            IotTaskPool_Assert( pTimerEvent != NULL );
 
-            if( pTimerEventLink != NULL )
+            if( pTimerEvent != NULL )
             {
-                bool shouldReschedule = false;
-
-                /* If the job being cancelled was at the head of the timeouts queue, then we need to reschedule the timer
-                 * with the next job timeout */
-                IotLink_t * pHeadLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-
-                if( pHeadLink == pTimerEventLink )
-                {
-                    shouldReschedule = true;
-                }
-
-                /* Remove the timer event associated with the canceled job and free the associated memory. */
-                IotListDouble_Remove( pTimerEventLink );
-                IotTaskPool_FreeTimerEvent( IotLink_Container( _taskPoolTimerEvent_t, pTimerEventLink, link ) );
+                /* Remove the timer event associated with the canceled job and free the associated memory.
+                 * The timer is left armed: if it fires with nothing to process, it is re-armed for the
+                 * next deferred job. */
+                _timerWheelRemove( &pTaskPool->timerWheel, pTimerEvent );
+                pJob->pTimerEvent = NULL;
 
-                if( shouldReschedule )
-                {
-                    IotLink_t * pNextTimerEventLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-
-                    if( pNextTimerEventLink != NULL )
-                    {
-                        _rescheduleDeferredJobsTimer( &pTaskPool->timer, IotLink_Container( _taskPoolTimerEvent_t, pNextTimerEventLink, link ) );
-                    }
-                }
+                IotTaskPool_FreeTimerEvent( pTimerEvent );
             }
         }
         else
         {
             /* A cancelable job status should be either 'scheduled' or 'deferrred'. */
-            IotTaskPool_Assert( ( currentStatus == IOT_TASKPOOL_STATUS_READY ) || ( currentStatus == IOT_TASKPOOL_STATUS_CANCELED ) );
+            IotTaskPool_Assert( ( currentStatus == IOT_TASKPOOL_STATUS_READY ) ||
+                                ( currentStatus == IOT_TASKPOOL_STATUS_SCHEDULED ) ||
+                                ( currentStatus == IOT_TASKPOOL_STATUS_CANCELED ) );
         }
     }
 
@@ -1657,7 +2532,7 @@ static IotTaskPoolError_t _trySafeExtraction( _taskPool_t * const pTaskPool,
 {
     TASKPOOL_FUNCTION_ENTRY( IOT_TASKPOOL_SUCCESS );
 
-    IotTaskPoolJobStatus_t currentStatus = pJob->status;
+    IotTaskPoolJobStatus_t currentStatus = _getJobStatus( pTaskPool, pJob );
 
     /* if the job is executing, we cannot touch it. */
     if( ( atCompletion == false ) && ( currentStatus == IOT_TASKPOOL_STATUS_COMPLETED ) )
@@ -1706,40 +2581,210 @@ static IotTaskPoolError_t _trySafeExtraction( _taskPool_t * const pTaskPool,
 
 /*-----------------------------------------------------------*/
 
-static int32_t _timerEventCompare( const IotLink_t * const pTimerEventLink1,
-                                   const IotLink_t * const pTimerEventLink2 )
+static void _timerWheelInit( _taskPoolTimerWheel_t * const pWheel )
 {
-    const _taskPoolTimerEvent_t * const pTimerEvent1 = IotLink_Container( _taskPoolTimerEvent_t,
-                                                                          pTimerEventLink1,
-                                                                          link );
-    const _taskPoolTimerEvent_t * const pTimerEvent2 = IotLink_Container( _taskPoolTimerEvent_t,
-                                                                          pTimerEventLink2,
-                                                                          link );
+    uint32_t level, slot;
 
-    if( pTimerEvent1->expirationTime < pTimerEvent2->expirationTime )
+    for( level = 0; level < TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
     {
-        return -1;
+        for( slot = 0; slot < TASKPOOL_TIMER_WHEEL_SLOTS; ++slot )
+        {
+            IotListDouble_Create( &pWheel->slots[ level ][ slot ] );
+        }
+
+        pWheel->pending[ level ] = 0;
+    }
+
+    /* Start from the current time, so that the first events are placed in the lowest level. */
+    pWheel->currentTick = IotClock_GetTimeMs() / IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
+    pWheel->armedTick = TASKPOOL_TIMER_WHEEL_DISARMED;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t _timerWheelExpirationTick( uint64_t expirationTime )
+{
+    /* Round up, so that no job is dispatched before its expiration time. */
+    return ( expirationTime + IOT_TASKPOOL_TIMER_WHEEL_TICK_MS - 1ULL ) / IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t _timerWheelInsert( _taskPoolTimerWheel_t * const pWheel,
+                                   _taskPoolTimerEvent_t * const pTimerEvent )
+{
+    uint32_t level = 0;
+    uint64_t expirationTick = _timerWheelExpirationTick( pTimerEvent->expirationTime );
+
+    /* The slot of the current tick was processed already. */
+    if( expirationTick <= pWheel->currentTick )
+    {
+        expirationTick = pWheel->currentTick + 1ULL;
     }
 
-    if( pTimerEvent1->expirationTime > pTimerEvent2->expirationTime )
+    /* Use the lowest level whose current span also contains the expiration tick. Events beyond the
+     * span of the top level wrap around it, and go back to the top level every time their slot is
+     * cascaded, until they get close enough. */
+    while( ( level < ( TASKPOOL_TIMER_WHEEL_LEVELS - 1U ) ) &&
+           ( ( expirationTick >> TASKPOOL_TIMER_WHEEL_SHIFT( level + 1U ) ) !=
+             ( pWheel->currentTick >> TASKPOOL_TIMER_WHEEL_SHIFT( level + 1U ) ) ) )
     {
-        return 1;
+        level++;
     }
 
-    return 0;
+    pTimerEvent->level = level;
+
+    IotListDouble_InsertTail( &pWheel->slots[ level ][ ( expirationTick >> TASKPOOL_TIMER_WHEEL_SHIFT( level ) ) & TASKPOOL_TIMER_WHEEL_MASK ],
+                              &pTimerEvent->link );
+
+    pWheel->pending[ level ]++;
+
+    return expirationTick;
 }
 
 /*-----------------------------------------------------------*/
 
-static void _rescheduleDeferredJobsTimer( IotTimer_t * const pTimer,
-                                          _taskPoolTimerEvent_t * const pFirstTimerEvent )
+static void _timerWheelRemove( _taskPoolTimerWheel_t * const pWheel,
+                               _taskPoolTimerEvent_t * const pTimerEvent )
+{
+    IotTaskPool_Assert( IotLink_IsLinked( &pTimerEvent->link ) );
+    IotTaskPool_Assert( pWheel->pending[ pTimerEvent->level ] > 0U );
+
+    IotListDouble_Remove( &pTimerEvent->link );
+
+    pWheel->pending[ pTimerEvent->level ]--;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _timerWheelCascade( _taskPoolTimerWheel_t * const pWheel,
+                                uint32_t level,
+                                IotListDouble_t * const pExpired )
+{
+    IotLink_t * pLink;
+    IotListDouble_t cascaded;
+    IotListDouble_t * const pSlot = &pWheel->slots[ level ][ ( pWheel->currentTick >> TASKPOOL_TIMER_WHEEL_SHIFT( level ) ) & TASKPOOL_TIMER_WHEEL_MASK ];
+
+    IotListDouble_Create( &cascaded );
+
+    /* Empty the slot first: events beyond the span of the top level are linked back into it. */
+    while( ( pLink = IotListDouble_RemoveHead( pSlot ) ) != NULL )
+    {
+        _taskPoolTimerEvent_t * pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
+
+        pWheel->pending[ level ]--;
+
+        if( _timerWheelExpirationTick( pTimerEvent->expirationTime ) <= pWheel->currentTick )
+        {
+            IotListDouble_InsertTail( pExpired, pLink );
+        }
+        else
+        {
+            IotListDouble_InsertTail( &cascaded, pLink );
+        }
+    }
+
+    while( ( pLink = IotListDouble_RemoveHead( &cascaded ) ) != NULL )
+    {
+        ( void ) _timerWheelInsert( pWheel, IotLink_Container( _taskPoolTimerEvent_t, pLink, link ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _timerWheelAdvance( _taskPoolTimerWheel_t * const pWheel,
+                                uint64_t nowTick,
+                                IotListDouble_t * const pExpired )
+{
+    IotLink_t * pLink;
+
+    while( pWheel->currentTick < nowTick )
+    {
+        uint32_t level = 0;
+        uint64_t nextTick;
+
+        /* Nothing happens before the next slot boundary of the lowest level holding events, so jump
+         * straight to it. */
+        while( ( level < TASKPOOL_TIMER_WHEEL_LEVELS ) && ( pWheel->pending[ level ] == 0U ) )
+        {
+            level++;
+        }
+
+        if( level == TASKPOOL_TIMER_WHEEL_LEVELS )
+        {
+            pWheel->currentTick = nowTick;
+            break;
+        }
+
+        nextTick = ( ( pWheel->currentTick >> TASKPOOL_TIMER_WHEEL_SHIFT( level ) ) + 1ULL ) << TASKPOOL_TIMER_WHEEL_SHIFT( level );
+
+        if( nextTick > nowTick )
+        {
+            pWheel->currentTick = nowTick;
+            break;
+        }
+
+        pWheel->currentTick = nextTick;
+
+        /* Cascade the upper levels whose slot boundary was reached, top down, so that an event can
+         * move down more than one level at once. */
+        for( level = TASKPOOL_TIMER_WHEEL_LEVELS - 1U; level > 0U; --level )
+        {
+            if( ( nextTick & ( ( 1ULL << TASKPOOL_TIMER_WHEEL_SHIFT( level ) ) - 1ULL ) ) == 0ULL )
+            {
+                _timerWheelCascade( pWheel, level, pExpired );
+            }
+        }
+
+        /* All the events in the level 0 slot of this tick expire now. */
+        while( ( pLink = IotListDouble_RemoveHead( &pWheel->slots[ 0 ][ nextTick & TASKPOOL_TIMER_WHEEL_MASK ] ) ) != NULL )
+        {
+            pWheel->pending[ 0 ]--;
+
+            IotListDouble_InsertTail( pExpired, pLink );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static uint64_t _timerWheelNextTick( const _taskPoolTimerWheel_t * const pWheel )
+{
+    uint32_t level, distance;
+
+    /* The slots of a level are all reached after the slots of the levels below it, so the first
+     * level holding events has the next tick. */
+    for( level = 0; level < TASKPOOL_TIMER_WHEEL_LEVELS; ++level )
+    {
+        if( pWheel->pending[ level ] > 0U )
+        {
+            uint64_t base = pWheel->currentTick >> TASKPOOL_TIMER_WHEEL_SHIFT( level );
+
+            for( distance = 1; distance <= TASKPOOL_TIMER_WHEEL_SLOTS; ++distance )
+            {
+                if( IotListDouble_IsEmpty( &pWheel->slots[ level ][ ( base + distance ) & TASKPOOL_TIMER_WHEEL_MASK ] ) == false )
+                {
+                    return ( base + distance ) << TASKPOOL_TIMER_WHEEL_SHIFT( level );
+                }
+            }
+        }
+    }
+
+    return TASKPOOL_TIMER_WHEEL_DISARMED;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _rescheduleDeferredJobsTimer( _taskPool_t * const pTaskPool,
+                                          uint64_t wakeTick )
 {
     uint64_t delta = 0;
     uint64_t now = IotClock_GetTimeMs();
+    uint64_t wakeTime = wakeTick * IOT_TASKPOOL_TIMER_WHEEL_TICK_MS;
 
-    if( pFirstTimerEvent->expirationTime > now )
+    if( wakeTime > now )
     {
-        delta = pFirstTimerEvent->expirationTime - now;
+        delta = wakeTime - now;
     }
 
     if( delta < TASKPOOL_JOB_RESCHEDULE_DELAY_MS )
@@ -1747,9 +2792,17 @@ static void _rescheduleDeferredJobsTimer( IotTimer_t * const pTimer,
         delta = TASKPOOL_JOB_RESCHEDULE_DELAY_MS; /* The job will be late... */
     }
 
+    /* Waking up early is harmless: the timer is re-armed for the same tick. */
+    if( delta > UINT32_MAX )
+    {
+        delta = UINT32_MAX;
+    }
+
     IotTaskPool_Assert( delta > 0 );
 
-    if( IotClock_TimerArm( pTimer, ( uint32_t ) delta, 0 ) == false )
+    pTaskPool->timerWheel.armedTick = wakeTick;
+
+    if( IotClock_TimerArm( &pTaskPool->timer, ( uint32_t ) delta, 0 ) == false )
     {
         IotLogWarn( "Failed to re-arm timer for task pool" );
     }
@@ -1764,12 +2817,14 @@ static void _timerThread( void * pArgument )
 
     IotLogDebug( "Timer thread started for task pool %p.", pTaskPool );
 
-    /* Attempt to lock the timer mutex. Return immediately if the mutex cannot be locked.
-     * If this mutex cannot be locked it means that another thread is manipulating the
-     * timeouts list, and will reset the timer to fire again, although it will be late.
-     */
+    /* Lock the task pool mutex, which protects the timer wheel. */
     TASKPOOL_ENTER_CRITICAL();
     {
+        IotListDouble_t expiredEvents;
+        IotLink_t * pLink;
+        uint64_t nextTick;
+        uint64_t now;
+
         /* Check again for shutdown and bail out early in case. */
         if( _IsShutdownStarted( pTaskPool ) )
         {
@@ -1783,53 +2838,47 @@ static void _timerThread( void * pArgument )
             return;
         }
 
-        /* Dispatch all deferred job whose timer expired, then reset the timer for the next
-         * job down the line. */
-        for( ; ; )
-        {
-            /* Peek the first event in the timer event list. */
-            IotLink_t * pLink = IotListDouble_PeekHead( &pTaskPool->timerEventsList );
-
-            /* Check if the timer misfired for any reason.  */
-            if( pLink != NULL )
-            {
-                /* Record the current time. */
-                uint64_t now = IotClock_GetTimeMs();
+        pTaskPool->timerWheel.armedTick = TASKPOOL_TIMER_WHEEL_DISARMED;
 
-                /* Extract the job from its envelope. */
-                pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
+        /* Collect all the deferred jobs whose timer expired, in all the ticks elapsed since the
+         * last wakeup. */
+        IotListDouble_Create( &expiredEvents );
 
-                /* Check if the first event should be processed now. */
-                if( pTimerEvent->expirationTime <= now )
-                {
-                    /*  Remove the timer event for immediate processing. */
-                    IotListDouble_Remove( &( pTimerEvent->link ) );
-                }
-                else
-                {
-                    /* The first element in the timer queue shouldn't be processed yet.
-                     * Arm the timer for when it should be processed and leave altogether. */
-                    _rescheduleDeferredJobsTimer( &pTaskPool->timer, pTimerEvent );
+        now = IotClock_GetTimeMs();
 
-                    break;
-                }
-            }
-            /* If there are no timer events to process, terminate this thread. */
-            else
-            {
-                IotLogDebug( "No further timer events to process. Exiting timer thread." );
+        _timerWheelAdvance( &pTaskPool->timerWheel,
+                            now / IOT_TASKPOOL_TIMER_WHEEL_TICK_MS,
+                            &expiredEvents );
 
-                break;
-            }
+        while( ( pLink = IotListDouble_RemoveHead( &expiredEvents ) ) != NULL )
+        {
+            pTimerEvent = IotLink_Container( _taskPoolTimerEvent_t, pLink, link );
 
             IotLogDebug( "Scheduling job from timer event." );
 
+            _histogramRecord( &pTaskPool->stats.timerLateness,
+                              ( now > pTimerEvent->expirationTime ) ? ( now - pTimerEvent->expirationTime ) : 0ULL );
+
+            pTimerEvent->pJob->pTimerEvent = NULL;
+
             /* Queue the job associated with the received timer event. */
             ( void ) _scheduleInternal( pTaskPool, pTimerEvent->pJob, 0 );
 
             /* Free the timer event. */
             IotTaskPool_FreeTimerEvent( pTimerEvent );
         }
+
+        /* Arm the timer for the next tick with work to do, if any. */
+        nextTick = _timerWheelNextTick( &pTaskPool->timerWheel );
+
+        if( nextTick != TASKPOOL_TIMER_WHEEL_DISARMED )
+        {
+            _rescheduleDeferredJobsTimer( pTaskPool, nextTick );
+        }
+        else
+        {
+            IotLogDebug( "No further timer events to process." );
+        }
     }
     TASKPOOL_EXIT_CRITICAL();
 }
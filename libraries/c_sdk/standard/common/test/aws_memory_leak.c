@@ -40,6 +40,36 @@
 
 #define memoryleakPRINTF( x )    vLoggingPrintf x
 
+/* Size of the buffer that receives the heap report printed when a leak is found. */
+#define memoryleakHEAP_REPORT_SIZE    ( 4096 )
+
+#if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+
+/* Print the heap report of heap_4.c, one line at a time, so that the lines of the
+ * call sites that still hold blocks show which library leaked. */
+    static void prvPrintHeapReport( void )
+    {
+        static char cHeapReport[ memoryleakHEAP_REPORT_SIZE ];
+        char * pcLine = cHeapReport;
+        char * pcEnd;
+
+        vPortGetHeapReport( cHeapReport, sizeof( cHeapReport ) );
+
+        while( *pcLine != '\0' )
+        {
+            pcEnd = strchr( pcLine, '\n' );
+
+            if( pcEnd == NULL )
+            {
+                pcEnd = pcLine + strlen( pcLine );
+            }
+
+            memoryleakPRINTF( ( "%.*s\n", ( int ) ( pcEnd - pcLine ), pcLine ) );
+            pcLine = ( *pcEnd == '\0' ) ? pcEnd : pcEnd + 1;
+        }
+    }
+#endif /* if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 ) */
+
 TEST_GROUP( Full_MemoryLeak );
 TEST_SETUP( Full_MemoryLeak )
 {
@@ -66,6 +96,13 @@ TEST( Full_MemoryLeak, CheckHeap )
                         xHeapAfter,
                         xHeapChange ) );
 
+    #if ( configUSE_STATS_FORMATTING_FUNCTIONS > 0 )
+        if( xHeapChange != 0 )
+        {
+            prvPrintHeapReport();
+        }
+    #endif
+
     TEST_ASSERT_EQUAL_INT32_MESSAGE( 0,
                                      xHeapChange,
                                      "Free heap before and after tests was not the same." );
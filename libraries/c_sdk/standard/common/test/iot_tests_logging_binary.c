@@ -0,0 +1,317 @@
+/*
+ * Amazon FreeRTOS Common V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_logging_binary.c
+ * @brief Tests for the binary records of the logging library.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Binary logging is not enabled in any build, so the logging library is
+ * compiled into this test in binary mode, with its public functions renamed,
+ * and its records captured.
+ */
+#undef IOT_LOG_BINARY
+#define IOT_LOG_BINARY                    ( 1 )
+
+#undef IOT_LOG_BINARY_MAX_RECORD_SIZE
+#define IOT_LOG_BINARY_MAX_RECORD_SIZE    ( 48 )
+
+#define IotLog_Generic                    IotTestLog_Generic
+#define IotLog_GenericPrintBuffer         IotTestLog_GenericPrintBuffer
+#define IotLog_BinaryAnchor               IotTestLog_BinaryAnchor
+
+#undef IotLogging_Puts
+#define IotLogging_Puts                   _captureLine
+
+#undef IotLogging_PutBinary
+#define IotLogging_PutBinary              _captureRecord
+
+/**
+ * @brief Record a binary log record, then print it as text.
+ */
+static void _captureRecord( const uint8_t * pRecord,
+                            size_t recordLength );
+
+/**
+ * @brief Record a line printed by the logging library.
+ */
+static int _captureLine( const char * pLine );
+
+#include "../logging/iot_logging.c"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Size of the header of a record logged with #_logConfig.
+ */
+#define TEST_HEADER_SIZE    ( 10 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Library name of the test messages. Its address is recorded.
+ */
+static const char _pLibraryName[] = "TEST";
+
+/**
+ * @brief Hide the time, so that records do not depend on the clock.
+ */
+static const IotLogConfig_t _logConfig = { .hideTimestring = true };
+
+/**
+ * @brief The last record output.
+ */
+static uint8_t _pRecord[ IOT_LOG_BINARY_MAX_RECORD_SIZE ];
+
+/**
+ * @brief The length of #_pRecord.
+ */
+static size_t _recordLength;
+
+/**
+ * @brief The last line printed.
+ */
+static char _pLine[ 80 ];
+
+/*-----------------------------------------------------------*/
+
+static void _captureRecord( const uint8_t * pRecord,
+                            size_t recordLength )
+{
+    TEST_ASSERT_TRUE( recordLength <= sizeof( _pRecord ) );
+
+    ( void ) memcpy( _pRecord, pRecord, recordLength );
+    _recordLength = recordLength;
+
+    _putBinaryAsText( pRecord, recordLength );
+}
+
+/*-----------------------------------------------------------*/
+
+static int _captureLine( const char * pLine )
+{
+    TEST_ASSERT_LESS_THAN( sizeof( _pLine ), strlen( pLine ) );
+
+    ( void ) strcpy( _pLine, pLine );
+
+    return 0;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check the header of the last record, and that its arguments are
+ * `pArguments`.
+ */
+static void _checkRecord( const char * pFormat,
+                          uint8_t flags,
+                          const uint8_t * pArguments,
+                          size_t argumentsLength )
+{
+    uint8_t pHeader[ TEST_HEADER_SIZE ] = { 0 };
+    int32_t offset = 0;
+
+    pHeader[ 0 ] = BINARY_VERSION | flags;
+    pHeader[ 1 ] = IOT_LOG_INFO | BINARY_HIDE_TIMESTRING;
+
+    offset = ( int32_t ) ( ( intptr_t ) _pLibraryName - ( intptr_t ) IotTestLog_BinaryAnchor );
+    ( void ) memcpy( &pHeader[ 2 ], &offset, sizeof( offset ) );
+    offset = ( int32_t ) ( ( intptr_t ) pFormat - ( intptr_t ) IotTestLog_BinaryAnchor );
+    ( void ) memcpy( &pHeader[ 6 ], &offset, sizeof( offset ) );
+
+    TEST_ASSERT_EQUAL( TEST_HEADER_SIZE + argumentsLength, _recordLength );
+    TEST_ASSERT_EQUAL_HEX8_ARRAY( pHeader, _pRecord, TEST_HEADER_SIZE );
+
+    if( argumentsLength > 0 )
+    {
+        TEST_ASSERT_EQUAL_HEX8_ARRAY( pArguments, &_pRecord[ TEST_HEADER_SIZE ], argumentsLength );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for binary logging tests.
+ */
+TEST_GROUP( Common_Unit_Logging_Binary );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for binary logging tests.
+ */
+TEST_SETUP( Common_Unit_Logging_Binary )
+{
+    ( void ) memset( _pRecord, 0x00, sizeof( _pRecord ) );
+    _recordLength = 0;
+    _pLine[ 0 ] = '\0';
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for binary logging tests.
+ */
+TEST_TEAR_DOWN( Common_Unit_Logging_Binary )
+{
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for binary logging tests.
+ */
+TEST_GROUP_RUNNER( Common_Unit_Logging_Binary )
+{
+    RUN_TEST_CASE( Common_Unit_Logging_Binary, Arguments );
+    RUN_TEST_CASE( Common_Unit_Logging_Binary, PrecisionArgument );
+    RUN_TEST_CASE( Common_Unit_Logging_Binary, LiteralPrecision );
+    RUN_TEST_CASE( Common_Unit_Logging_Binary, Truncated );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Integers, characters and strings are appended in the order of the
+ * format string, and the record is printed as base64 text.
+ */
+TEST( Common_Unit_Logging_Binary, Arguments )
+{
+    static const char pFormat[] = "%d %lu %c %s";
+    const uint8_t pArguments[] =
+    {
+        0xfe, 0xff, 0xff, 0xff,                         /* -2 */
+        0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* 0x201 */
+        'x',  0x00, 0x00, 0x00,                         /* 'x' */
+        0x02, 'o',  'k'                                 /* "ok" */
+    };
+
+    IotTestLog_Generic( IOT_LOG_DEBUG, _pLibraryName, IOT_LOG_INFO, &_logConfig,
+                        pFormat, -2, 0x201UL, 'x', "ok" );
+
+    _checkRecord( pFormat, 0, pArguments, sizeof( pArguments ) );
+
+    /* 29 bytes are 40 base64 characters after the prefix. */
+    TEST_ASSERT_EQUAL( BINARY_LINE_PREFIX, _pLine[ 0 ] );
+    TEST_ASSERT_EQUAL( 41, strlen( _pLine ) );
+    TEST_ASSERT_EQUAL_STRING_LEN( "//8BAgAA", &_pLine[ 1 + 16 ], 8 ); /* Bytes 12 to 17. */
+    TEST_ASSERT_EQUAL_STRING( "b2s=", &_pLine[ 1 + 36 ] );             /* "ok" and padding. */
+
+    /* Messages above the log level of the library are not output. */
+    _recordLength = 0;
+    IotTestLog_Generic( IOT_LOG_WARN, _pLibraryName, IOT_LOG_INFO, &_logConfig, pFormat, -2, 0x201UL, 'x', "ok" );
+    TEST_ASSERT_EQUAL( 0, _recordLength );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A string with a precision given as an argument is read only up to
+ * that precision, so it need not be NUL terminated.
+ */
+TEST( Common_Unit_Logging_Binary, PrecisionArgument )
+{
+    static const char pFormat[] = "Topic %.*s, %.*s";
+    const uint8_t pArguments[] =
+    {
+        0x03, 0x00, 0x00, 0x00, 0x03, 'a', 'b', 'c',      /* 3, "abc" */
+        0xff, 0xff, 0xff, 0xff, 0x04, 'a', 'b', 'c', 'd'  /* -1, "abcd" */
+    };
+    char * pTopic = malloc( 3 );
+
+    TEST_ASSERT_NOT_NULL( pTopic );
+    ( void ) memcpy( pTopic, "abc", 3 );
+
+    /* A negative precision is taken as if it were omitted. */
+    IotTestLog_Generic( IOT_LOG_DEBUG, _pLibraryName, IOT_LOG_INFO, &_logConfig,
+                        pFormat, 3, pTopic, -1, "abcd" );
+
+    free( pTopic );
+
+    _checkRecord( pFormat, 0, pArguments, sizeof( pArguments ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A precision in the format string limits the characters copied, but
+ * is not appended.
+ */
+TEST( Common_Unit_Logging_Binary, LiteralPrecision )
+{
+    static const char pFormat[] = "%.2s|%.0s|%10.12s|%-4s";
+    const uint8_t pArguments[] =
+    {
+        0x02, 'h', 'e',     /* "he" */
+        0x00,               /* "" */
+        0x05, 'w', 'o', 'r', 'l', 'd',
+        0x02, 'h', 'i'
+    };
+    char pShort[ 2 ] = { 'h', 'e' };
+
+    IotTestLog_Generic( IOT_LOG_DEBUG, _pLibraryName, IOT_LOG_INFO, &_logConfig,
+                        pFormat, pShort, pShort, "world", "hi" );
+
+    _checkRecord( pFormat, 0, pArguments, sizeof( pArguments ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Strings that do not fit are cut at the end of the record, and the
+ * record is marked as truncated.
+ */
+TEST( Common_Unit_Logging_Binary, Truncated )
+{
+    static const char pFormat[] = "%s %d";
+    uint8_t pArguments[ IOT_LOG_BINARY_MAX_RECORD_SIZE - TEST_HEADER_SIZE ] = { 0 };
+    char pLong[ 2 * IOT_LOG_BINARY_MAX_RECORD_SIZE ] = { 0 };
+
+    ( void ) memset( pLong, 'z', sizeof( pLong ) - 1 );
+    ( void ) memset( pArguments, 'z', sizeof( pArguments ) );
+    pArguments[ 0 ] = sizeof( pArguments ) - 1;
+
+    IotTestLog_Generic( IOT_LOG_DEBUG, _pLibraryName, IOT_LOG_INFO, &_logConfig,
+                        pFormat, pLong, 1 );
+
+    _checkRecord( pFormat, BINARY_TRUNCATED, pArguments, sizeof( pArguments ) );
+}
+
+/*-----------------------------------------------------------*/
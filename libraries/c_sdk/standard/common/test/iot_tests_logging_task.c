@@ -0,0 +1,339 @@
+/*
+ * Amazon FreeRTOS Common V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_logging_task.c
+ * @brief Tests for the ring buffer of the logging task.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of tasks logging at the same time.
+ */
+#define WRITER_COUNT                   ( 4 )
+
+/**
+ * @brief Number of messages logged by each task.
+ */
+#define WRITER_MESSAGES                ( 500 )
+
+/**
+ * @brief Number of messages of the maximum length the ring buffer holds.
+ */
+#define RING_BUFFER_MESSAGES           ( 4 )
+
+/**
+ * @brief Priority of the logging task and the tasks logging.
+ */
+#define TEST_TASK_PRIORITY             ( tskIDLE_PRIORITY + 1 )
+
+/**
+ * @brief Stack size of the logging task and the tasks logging.
+ */
+#define TEST_TASK_STACK_SIZE           ( configMINIMAL_STACK_SIZE * 4 )
+
+/**
+ * @brief Time to wait for all messages to be output.
+ */
+#define TEST_TIMEOUT_MS                ( 10000 )
+
+/*
+ * The PC simulators log through their own implementation of the logging
+ * functions, so the logging task is compiled into this test with its public
+ * functions renamed, and its output captured.
+ */
+#define xLoggingTaskInitialize         xTestLoggingTaskInitialize
+#define vLoggingPrintf                 vTestLoggingPrintf
+#define vLoggingPrint                  vTestLoggingPrint
+#define vLoggingPrintFromISR           vTestLoggingPrintFromISR
+
+#undef configPRINT_STRING
+#define configPRINT_STRING( x )    _captureString( x )
+
+#ifndef configLOGGING_MAX_MESSAGE_LENGTH
+    #define configLOGGING_MAX_MESSAGE_LENGTH           ( 64 )
+#endif
+#ifndef configLOGGING_INCLUDE_TIME_AND_TASK_NAME
+    #define configLOGGING_INCLUDE_TIME_AND_TASK_NAME    ( 1 )
+#endif
+
+/**
+ * @brief Record a string output by the logging task.
+ */
+static void _captureString( const char * pString );
+
+#include "../logging/aws_logging_task_dynamic_buffers.c"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The next message expected from each writer.
+ */
+static uint32_t _pNextMessage[ WRITER_COUNT ];
+
+/**
+ * @brief Number of messages output.
+ */
+static volatile uint32_t _receivedMessages;
+
+/**
+ * @brief Number of messages reported as dropped.
+ */
+static volatile uint32_t _droppedMessages;
+
+/**
+ * @brief Number of strings output that were not a message, or out of order.
+ */
+static volatile uint32_t _badMessages;
+
+/**
+ * @brief Given by each writer when it is done.
+ */
+static SemaphoreHandle_t _writersDone;
+
+/*-----------------------------------------------------------*/
+
+static void _captureString( const char * pString )
+{
+    unsigned int writer = 0, message = 0, dropped = 0;
+    const char * pMessage = strstr( pString, "writer " );
+
+    if( ( pMessage != NULL ) &&
+        ( sscanf( pMessage, "writer %u message %u", &writer, &message ) == 2 ) &&
+        ( writer < WRITER_COUNT ) &&
+        ( message >= _pNextMessage[ writer ] ) )
+    {
+        /* Messages of one writer are output in order, some may be dropped. */
+        _pNextMessage[ writer ] = message + 1;
+        _receivedMessages++;
+    }
+    else if( sscanf( pString, "%u log messages dropped.", &dropped ) == 1 )
+    {
+        _droppedMessages += dropped;
+    }
+    else
+    {
+        _badMessages++;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait until the logging task accounted for a number of messages.
+ */
+static bool _waitForMessages( uint32_t messageCount )
+{
+    TickType_t waited = 0;
+
+    while( ( _receivedMessages + _droppedMessages < messageCount ) &&
+           ( waited < pdMS_TO_TICKS( TEST_TIMEOUT_MS ) ) )
+    {
+        vTaskDelay( 1 );
+        waited++;
+    }
+
+    return( _receivedMessages + _droppedMessages == messageCount );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Log numbered messages, alternating between the formatted and the
+ * unformatted logging functions.
+ */
+static void _writerTask( void * pArgument )
+{
+    uint32_t writer = ( uint32_t ) ( uintptr_t ) pArgument, message = 0;
+    char pMessage[ 32 ] = { 0 };
+
+    for( message = 0; message < WRITER_MESSAGES; message++ )
+    {
+        if( ( message % 2 ) == 0 )
+        {
+            vTestLoggingPrintf( "writer %u message %u\r\n", ( unsigned int ) writer, ( unsigned int ) message );
+        }
+        else
+        {
+            ( void ) snprintf( pMessage, sizeof( pMessage ), "writer %u message %u\r\n", ( unsigned int ) writer, ( unsigned int ) message );
+            vTestLoggingPrint( pMessage );
+        }
+    }
+
+    ( void ) xSemaphoreGive( _writersDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for logging task tests.
+ */
+TEST_GROUP( Common_Unit_Logging_Task );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for logging task tests.
+ */
+TEST_SETUP( Common_Unit_Logging_Task )
+{
+    ( void ) memset( _pNextMessage, 0x00, sizeof( _pNextMessage ) );
+    _receivedMessages = 0;
+    _droppedMessages = 0;
+    _badMessages = 0;
+
+    _writersDone = xSemaphoreCreateCounting( WRITER_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( _writersDone );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTestLoggingTaskInitialize( TEST_TASK_STACK_SIZE,
+                                                           TEST_TASK_PRIORITY,
+                                                           RING_BUFFER_MESSAGES ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for logging task tests.
+ */
+TEST_TEAR_DOWN( Common_Unit_Logging_Task )
+{
+    /* Only delete the logging task once it waits for a notification, and not
+     * while it outputs a message. */
+    while( eTaskGetState( xLoggingTask ) != eBlocked )
+    {
+        vTaskDelay( 1 );
+    }
+
+    vTaskDelete( xLoggingTask );
+    xLoggingTask = NULL;
+
+    vPortFree( pucRingBuffer );
+    pucRingBuffer = NULL;
+    ulWriteIndex = 0;
+    ulReadIndex = 0;
+    ulDroppedMessages = 0;
+
+    vSemaphoreDelete( _writersDone );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for logging task tests.
+ */
+TEST_GROUP_RUNNER( Common_Unit_Logging_Task )
+{
+    RUN_TEST_CASE( Common_Unit_Logging_Task, MultipleWriters );
+    RUN_TEST_CASE( Common_Unit_Logging_Task, IndexWrap );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tasks that log at the same time reserve records in the ring buffer
+ * concurrently. Every message is either output whole and in order, or counted
+ * as dropped.
+ */
+TEST( Common_Unit_Logging_Task, MultipleWriters )
+{
+    uint32_t writer = 0;
+
+    for( writer = 0; writer < WRITER_COUNT; writer++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _writerTask,
+                                                "LogWriter",
+                                                TEST_TASK_STACK_SIZE,
+                                                ( void * ) ( uintptr_t ) writer,
+                                                TEST_TASK_PRIORITY,
+                                                NULL ) );
+    }
+
+    for( writer = 0; writer < WRITER_COUNT; writer++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _writersDone, pdMS_TO_TICKS( TEST_TIMEOUT_MS ) ) );
+    }
+
+    TEST_ASSERT_TRUE( _waitForMessages( WRITER_COUNT * WRITER_MESSAGES ) );
+    TEST_ASSERT_EQUAL_UINT32( 0, _badMessages );
+    TEST_ASSERT_GREATER_THAN_UINT32( 0, _receivedMessages );
+
+    /* Every record was output and cleared. */
+    TEST_ASSERT_EQUAL_UINT32( ulWriteIndex, ulReadIndex );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The indexes of the ring buffer are free running, so messages are
+ * output in order when the indexes wrap around.
+ */
+TEST( Common_Unit_Logging_Task, IndexWrap )
+{
+    uint32_t message = 0;
+    char pMessage[ 32 ] = { 0 };
+
+    /* Start just before the indexes wrap, in the middle of the empty ring
+     * buffer. */
+    ulWriteIndex = 0U - ( ulRingBufferSize / 2U );
+    ulReadIndex = ulWriteIndex;
+
+    for( message = 0; message < 4 * RING_BUFFER_MESSAGES; message++ )
+    {
+        ( void ) snprintf( pMessage, sizeof( pMessage ), "writer 0 message %u\r\n", ( unsigned int ) message );
+        vTestLoggingPrint( pMessage );
+
+        /* Wait for each message, so that none is dropped. */
+        TEST_ASSERT_TRUE( _waitForMessages( message + 1 ) );
+    }
+
+    TEST_ASSERT_EQUAL_UINT32( 4 * RING_BUFFER_MESSAGES, _receivedMessages );
+    TEST_ASSERT_EQUAL_UINT32( 0, _droppedMessages );
+    TEST_ASSERT_EQUAL_UINT32( 0, _badMessages );
+
+    /* The indexes wrapped around. */
+    TEST_ASSERT_LESS_THAN_UINT32( ulRingBufferSize * 4U, ulWriteIndex );
+    TEST_ASSERT_EQUAL_UINT32( ulWriteIndex, ulReadIndex );
+}
+
+/*-----------------------------------------------------------*/
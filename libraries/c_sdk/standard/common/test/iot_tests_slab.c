@@ -0,0 +1,224 @@
+/*
+ * Amazon FreeRTOS Common V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_slab.c
+ * @brief Tests for the slab allocator.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Slab allocator include. */
+#include "iot_slab.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Size of the blocks in the small class.
+ */
+#define SMALL_SIZE      ( 16 )
+
+/**
+ * @brief Number of blocks in the small class.
+ */
+#define SMALL_COUNT     ( 4 )
+
+/**
+ * @brief Size of the blocks in the large class.
+ */
+#define LARGE_SIZE      ( 64 )
+
+/**
+ * @brief Number of blocks in the large class.
+ */
+#define LARGE_COUNT     ( 2 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Blocks of the small class.
+ */
+static uint8_t _pSmallBlocks[ SMALL_COUNT ][ SMALL_SIZE ];
+
+/**
+ * @brief Blocks of the large class.
+ */
+static uint8_t _pLargeBlocks[ LARGE_COUNT ][ LARGE_SIZE ];
+
+/**
+ * @brief The size classes used by the tests.
+ */
+static IotSlab_t _pSlabs[ 2 ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for slab allocator tests.
+ */
+TEST_GROUP( Common_Unit_Slab );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for slab allocator tests.
+ */
+TEST_SETUP( Common_Unit_Slab )
+{
+    const IotSlab_t pInitialSlabs[ 2 ] =
+    {
+        IOT_SLAB_INITIALIZER( _pSmallBlocks, SMALL_SIZE, SMALL_COUNT ),
+        IOT_SLAB_INITIALIZER( _pLargeBlocks, LARGE_SIZE, LARGE_COUNT )
+    };
+
+    ( void ) memcpy( _pSlabs, pInitialSlabs, sizeof( _pSlabs ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for slab allocator tests.
+ */
+TEST_TEAR_DOWN( Common_Unit_Slab )
+{
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for slab allocator tests.
+ */
+TEST_GROUP_RUNNER( Common_Unit_Slab )
+{
+    RUN_TEST_CASE( Common_Unit_Slab, AllocFree );
+    RUN_TEST_CASE( Common_Unit_Slab, SizeClasses );
+    RUN_TEST_CASE( Common_Unit_Slab, Find );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that every block of a slab can be allocated and that freed
+ * blocks are reused.
+ */
+TEST( Common_Unit_Slab, AllocFree )
+{
+    size_t i = 0;
+    uint8_t * pBlocks[ SMALL_COUNT ] = { 0 };
+    IotSlabStats_t stats = { 0 };
+
+    /* Allocate every block of the small class. */
+    for( i = 0; i < SMALL_COUNT; i++ )
+    {
+        pBlocks[ i ] = IotSlab_Alloc( _pSlabs, 1, SMALL_SIZE );
+        TEST_ASSERT_EQUAL_PTR( _pSmallBlocks[ i ], pBlocks[ i ] );
+    }
+
+    TEST_ASSERT_NULL( IotSlab_Alloc( _pSlabs, 1, SMALL_SIZE ) );
+
+    /* Freed blocks are reused, most recently freed first. */
+    ( void ) memset( pBlocks[ 1 ], 0xff, SMALL_SIZE );
+    IotSlab_Free( &( _pSlabs[ 0 ] ), pBlocks[ 1 ] );
+    IotSlab_Free( &( _pSlabs[ 0 ] ), pBlocks[ 2 ] );
+    TEST_ASSERT_EQUAL_PTR( pBlocks[ 2 ], IotSlab_Alloc( _pSlabs, 1, 1 ) );
+    TEST_ASSERT_EQUAL_PTR( pBlocks[ 1 ], IotSlab_Alloc( _pSlabs, 1, 1 ) );
+
+    /* The free list link is cleared when a block is allocated. */
+    for( i = 0; i < sizeof( void * ); i++ )
+    {
+        TEST_ASSERT_EQUAL_UINT8( 0, pBlocks[ 1 ][ i ] );
+    }
+
+    IotSlab_Free( &( _pSlabs[ 0 ] ), pBlocks[ 0 ] );
+
+    IotSlab_GetStats( _pSlabs, 1, &stats );
+    TEST_ASSERT_EQUAL( SMALL_SIZE, stats.blockSize );
+    TEST_ASSERT_EQUAL( SMALL_COUNT, stats.blockCount );
+    TEST_ASSERT_EQUAL( SMALL_COUNT - 1, stats.inUse );
+    TEST_ASSERT_EQUAL( SMALL_COUNT, stats.highWater );
+    TEST_ASSERT_EQUAL( 1, stats.failures );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that allocations come from the smallest class that fits and
+ * spill into larger classes.
+ */
+TEST( Common_Unit_Slab, SizeClasses )
+{
+    size_t i = 0;
+    IotSlabStats_t pStats[ 2 ] = { { 0 } };
+
+    /* Allocations larger than the small class come from the large class. */
+    TEST_ASSERT_EQUAL_PTR( _pLargeBlocks[ 0 ], IotSlab_Alloc( _pSlabs, 2, SMALL_SIZE + 1 ) );
+
+    /* Allocations larger than every class fail without counting a failure. */
+    TEST_ASSERT_NULL( IotSlab_Alloc( _pSlabs, 2, LARGE_SIZE + 1 ) );
+
+    /* Exhaust the small class; the next small allocation spills. */
+    for( i = 0; i < SMALL_COUNT; i++ )
+    {
+        TEST_ASSERT_EQUAL_PTR( _pSmallBlocks[ i ], IotSlab_Alloc( _pSlabs, 2, SMALL_SIZE ) );
+    }
+
+    TEST_ASSERT_EQUAL_PTR( _pLargeBlocks[ 1 ], IotSlab_Alloc( _pSlabs, 2, SMALL_SIZE ) );
+    TEST_ASSERT_NULL( IotSlab_Alloc( _pSlabs, 2, SMALL_SIZE ) );
+
+    /* Each failed attempt is counted against the smallest class that fits. */
+    IotSlab_GetStats( _pSlabs, 2, pStats );
+    TEST_ASSERT_EQUAL( SMALL_COUNT, pStats[ 0 ].highWater );
+    TEST_ASSERT_EQUAL( 2, pStats[ 0 ].failures );
+    TEST_ASSERT_EQUAL( LARGE_COUNT, pStats[ 1 ].highWater );
+    TEST_ASSERT_EQUAL( 0, pStats[ 1 ].failures );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests finding the slab that owns a block.
+ */
+TEST( Common_Unit_Slab, Find )
+{
+    uint8_t pOther[ SMALL_SIZE ] = { 0 };
+
+    TEST_ASSERT_EQUAL_PTR( &( _pSlabs[ 0 ] ), IotSlab_Find( _pSlabs, 2, _pSmallBlocks[ SMALL_COUNT - 1 ] ) );
+    TEST_ASSERT_EQUAL_PTR( &( _pSlabs[ 1 ] ), IotSlab_Find( _pSlabs, 2, _pLargeBlocks[ 0 ] ) );
+
+    /* Pointers inside a block or outside every slab are not owned. */
+    TEST_ASSERT_NULL( IotSlab_Find( _pSlabs, 2, &( _pSmallBlocks[ 0 ][ 1 ] ) ) );
+    TEST_ASSERT_NULL( IotSlab_Find( _pSlabs, 2, pOther ) );
+}
+
+/*-----------------------------------------------------------*/
@@ -73,6 +73,42 @@ typedef struct JobBlockingUserContext
     IotSemaphore_t block;  /**< @brief A synch object to wait on. */
 } JobBlockingUserContext_t;
 
+/**
+ * @brief A user context to prove deferred callbacks are not called before their deadline.
+ */
+typedef struct JobDeferredUserContext
+{
+    JobUserContext_t * pUserContext; /**< @brief The context shared by all jobs. */
+    uint64_t deadline;               /**< @brief The earliest time the callback may be called. */
+    bool early;                      /**< @brief Set if the callback was called before the deadline. */
+} JobDeferredUserContext_t;
+
+/**
+ * @brief Maximum number of jobs whose execution order is recorded.
+ */
+#define TEST_TASKPOOL_MAX_ORDERED_JOBS    ( 16 )
+
+/**
+ * @brief A user context to record the order in which jobs execute.
+ */
+typedef struct JobOrderUserContext
+{
+    IotMutex_t lock;                                 /**< @brief Protection from concurrent updates. */
+    uint32_t counter;                                /**< @brief The number of jobs executed. */
+    uint32_t order[ TEST_TASKPOOL_MAX_ORDERED_JOBS ]; /**< @brief The identifiers of the jobs, in order of execution. */
+    uint32_t lateJobs;                               /**< @brief The number of jobs reported late. */
+    uint32_t lateMs;                                 /**< @brief The lateness of the last job reported late. */
+} JobOrderUserContext_t;
+
+/**
+ * @brief The per-job context of a job whose execution order is recorded.
+ */
+typedef struct JobOrderEntry
+{
+    JobOrderUserContext_t * pUserContext; /**< @brief The context shared by all jobs. */
+    uint32_t id;                          /**< @brief The identifier of the job. */
+} JobOrderEntry_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -124,6 +160,12 @@ TEST_GROUP_RUNNER( Common_Unit_Task_Pool )
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_ReSchedule );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_ReScheduleDeferred );
     RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_CancelTasks );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_Affinity );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_StealFromBlockedLane );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_DeferredTimerWheel );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_JobClasses );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_JobDeadline );
+    RUN_TEST_CASE( Common_Unit_Task_Pool, ScheduleTasks_Stats );
 }
 
 /*-----------------------------------------------------------*/
@@ -328,6 +370,67 @@ static void ExecutionLongWithoutDestroyCb( IotTaskPool_t pTaskPool,
     IotMutex_Unlock( &pUserContext->lock );
 }
 
+/**
+ * @brief A deferred callback that records whether it was called before its deadline.
+ */
+static void ExecutionDeferredCb( IotTaskPool_t pTaskPool,
+                                 IotTaskPoolJob_t pJob,
+                                 void * pContext )
+{
+    JobDeferredUserContext_t * pDeferredContext = ( JobDeferredUserContext_t * ) pContext;
+
+    ( void ) pTaskPool;
+    ( void ) pJob;
+
+    pDeferredContext->early = ( IotClock_GetTimeMs() < pDeferredContext->deadline );
+
+    IotMutex_Lock( &pDeferredContext->pUserContext->lock );
+    pDeferredContext->pUserContext->counter++;
+    IotMutex_Unlock( &pDeferredContext->pUserContext->lock );
+}
+
+/**
+ * @brief A callback that records the order in which jobs execute.
+ */
+static void ExecutionOrderCb( IotTaskPool_t pTaskPool,
+                              IotTaskPoolJob_t pJob,
+                              void * pContext )
+{
+    JobOrderEntry_t * pEntry = ( JobOrderEntry_t * ) pContext;
+
+    ( void ) pTaskPool;
+    ( void ) pJob;
+
+    IotMutex_Lock( &pEntry->pUserContext->lock );
+
+    if( pEntry->pUserContext->counter < TEST_TASKPOOL_MAX_ORDERED_JOBS )
+    {
+        pEntry->pUserContext->order[ pEntry->pUserContext->counter ] = pEntry->id;
+    }
+
+    pEntry->pUserContext->counter++;
+    IotMutex_Unlock( &pEntry->pUserContext->lock );
+}
+
+/**
+ * @brief A late job callback that counts late jobs.
+ */
+static void LateJobCb( IotTaskPool_t pTaskPool,
+                       IotTaskPoolJob_t pJob,
+                       uint32_t lateMs,
+                       void * pContext )
+{
+    JobOrderUserContext_t * pUserContext = ( JobOrderUserContext_t * ) pContext;
+
+    ( void ) pTaskPool;
+    ( void ) pJob;
+
+    IotMutex_Lock( &pUserContext->lock );
+    pUserContext->lateJobs++;
+    pUserContext->lateMs = lateMs;
+    IotMutex_Unlock( &pUserContext->lock );
+}
+
 /**
  * @brief A callback that does not recycle its job.
  */
@@ -692,6 +795,10 @@ TEST( Common_Unit_Task_Pool, ScheduleTasksError )
         TEST_ASSERT( IotTaskPool_Schedule( NULL, job, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
         /* NULL Work item Handle. */
         TEST_ASSERT( IotTaskPool_Schedule( taskPool, NULL, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
+        /* Unknown flags. */
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, job, 0x00000004UL ) == IOT_TASKPOOL_BAD_PARAMETER );
+        /* Affinity key without the affinity flag. */
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, job, 0x00010000UL ) == IOT_TASKPOOL_BAD_PARAMETER );
     }
 
     TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
@@ -1853,3 +1960,537 @@ TEST( Common_Unit_Task_Pool, ScheduleTasks_CancelTasks )
 }
 
 /*-----------------------------------------------------------*/
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that jobs scheduled with the same affinity hint are dispatched to the same lane.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_Affinity )
+{
+    uint32_t count;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 2, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolJobStorage_t jobsStorage[ TEST_TAKPOOL_NUMBER_OF_JOBS ];
+    IotTaskPoolJob_t jobs[ TEST_TAKPOOL_NUMBER_OF_JOBS ];
+
+    JobUserContext_t userContext;
+
+    memset( &userContext, 0, sizeof( JobUserContext_t ) );
+
+    /* Initialize user context. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        for( count = 0; count < TEST_TAKPOOL_NUMBER_OF_JOBS; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionWithoutDestroyCb, &userContext, &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+
+            TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ count ], IOT_TASKPOOL_JOB_AFFINITY( 0x1234 ) ) == IOT_TASKPOOL_SUCCESS );
+
+            /* All jobs with the same affinity hint go to the same lane. */
+            TEST_ASSERT_EQUAL_UINT32( jobs[ 0 ]->lane, jobs[ count ]->lane );
+        }
+
+        /* Ensure all callbacks actually executed. */
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == TEST_TAKPOOL_NUMBER_OF_JOBS )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user context. */
+    IotMutex_Destroy( &userContext.lock );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that jobs queued behind a blocked worker are stolen by the workers of other lanes.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_StealFromBlockedLane )
+{
+    uint32_t count;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 2, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolJobStorage_t blockingJobStorage;
+    IotTaskPoolJob_t blockingJob;
+    IotTaskPoolJobStorage_t jobsStorage[ TEST_TAKPOOL_NUMBER_OF_JOBS ];
+    IotTaskPoolJob_t jobs[ TEST_TAKPOOL_NUMBER_OF_JOBS ];
+
+    JobUserContext_t userContext;
+    JobBlockingUserContext_t blockingUserContext;
+
+    memset( &userContext, 0, sizeof( JobUserContext_t ) );
+
+    /* Initialize user contexts. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.signal, 0, 1 ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.block, 0, 1 ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        /* Block one worker with a job pinned to its lane. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionBlockingWithoutDestroyCb, &blockingUserContext, &blockingJobStorage, &blockingJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, blockingJob, IOT_TASKPOOL_JOB_AFFINITY( 1 ) ) == IOT_TASKPOOL_SUCCESS );
+
+        IotSemaphore_Wait( &blockingUserContext.signal );
+
+        /* Some of these jobs are dispatched to the blocked lane, the other worker must steal them. */
+        for( count = 0; count < TEST_TAKPOOL_NUMBER_OF_JOBS; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionWithoutDestroyCb, &userContext, &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ count ], 0 ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        /* Ensure all callbacks executed while the blocking job is still running. */
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == TEST_TAKPOOL_NUMBER_OF_JOBS )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+
+        /* Release the blocked worker. */
+        IotSemaphore_Post( &blockingUserContext.block );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user contexts. */
+    IotMutex_Destroy( &userContext.lock );
+    IotSemaphore_Destroy( &blockingUserContext.signal );
+    IotSemaphore_Destroy( &blockingUserContext.block );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of deferred jobs for the timer wheel test.
+ */
+#define TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS    ( 32 )
+
+/**
+ * @brief Test that deferred jobs spread over several levels of the timer wheel are dispatched
+ * no earlier than their deadline, and that canceled ones are not dispatched at all.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_DeferredTimerWheel )
+{
+    uint32_t count, expected = 0;
+    uint64_t lastDeadline = 0;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 2, .maxThreads = 2, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolJobStorage_t farJobStorage;
+    IotTaskPoolJob_t farJob;
+    IotTaskPoolJobStorage_t jobsStorage[ TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS ];
+    IotTaskPoolJob_t jobs[ TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS ];
+    JobDeferredUserContext_t deferredContexts[ TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS ];
+
+    JobUserContext_t userContext;
+
+    memset( &userContext, 0, sizeof( JobUserContext_t ) );
+    memset( deferredContexts, 0, sizeof( deferredContexts ) );
+
+    /* Initialize user context. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        /* A job far beyond the span of the timer wheel, canceled before it expires. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &BlankExecution, NULL, &farJobStorage, &farJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_ScheduleDeferred( taskPool, farJob, ONE_HOUR_FROM_NOW_MS ) == IOT_TASKPOOL_SUCCESS );
+
+        /* Deadlines from a few milliseconds to over a second, not in order. */
+        for( count = 0; count < TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS; ++count )
+        {
+            uint32_t timeMs = 1 + ( ( count * 397 ) % 1200 );
+
+            deferredContexts[ count ].pUserContext = &userContext;
+            deferredContexts[ count ].deadline = IotClock_GetTimeMs() + timeMs;
+
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionDeferredCb, &deferredContexts[ count ], &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_ScheduleDeferred( taskPool, jobs[ count ], timeMs ) == IOT_TASKPOOL_SUCCESS );
+
+            if( deferredContexts[ count ].deadline > lastDeadline )
+            {
+                lastDeadline = deferredContexts[ count ].deadline;
+            }
+        }
+
+        /* Cancel every other job. */
+        for( count = 0; count < TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS; ++count )
+        {
+            if( ( ( count % 2 ) == 1 ) &&
+                ( IotTaskPool_TryCancel( taskPool, jobs[ count ], NULL ) == IOT_TASKPOOL_SUCCESS ) )
+            {
+                continue;
+            }
+
+            expected++;
+        }
+
+        TEST_ASSERT( IotTaskPool_TryCancel( taskPool, farJob, NULL ) == IOT_TASKPOOL_SUCCESS );
+
+        /* Wait for all the jobs that were not canceled, and a little longer to catch any canceled one. */
+        while( IotClock_GetTimeMs() < ( lastDeadline + 200 ) )
+        {
+            IotClock_SleepMs( 50 );
+        }
+
+        IotMutex_Lock( &userContext.lock );
+        TEST_ASSERT_EQUAL_UINT32( expected, userContext.counter );
+        IotMutex_Unlock( &userContext.lock );
+
+        for( count = 0; count < TEST_TASKPOOL_NUMBER_OF_DEFERRED_JOBS; ++count )
+        {
+            TEST_ASSERT_FALSE( deferredContexts[ count ].early );
+        }
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user context. */
+    IotMutex_Destroy( &userContext.lock );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of jobs per class for the job classes test.
+ */
+#define TEST_TASKPOOL_JOBS_PER_CLASS    ( 4 )
+
+/**
+ * @brief Test that queued jobs are dequeued by class in weighted round robin order.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_JobClasses )
+{
+    uint32_t count;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 1, .maxThreads = 1, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolJobStorage_t blockingJobStorage;
+    IotTaskPoolJob_t blockingJob;
+    IotTaskPoolJobStorage_t jobsStorage[ 3 * TEST_TASKPOOL_JOBS_PER_CLASS ];
+    IotTaskPoolJob_t jobs[ 3 * TEST_TASKPOOL_JOBS_PER_CLASS ];
+    JobOrderEntry_t entries[ 3 * TEST_TASKPOOL_JOBS_PER_CLASS ];
+    JobOrderUserContext_t userContext;
+    JobBlockingUserContext_t blockingUserContext;
+
+    /* With the default weights, a round dequeues all control jobs, then the default jobs, then one bulk job. */
+    const uint32_t expectedClasses[ 3 * TEST_TASKPOOL_JOBS_PER_CLASS ] =
+    {
+        IOT_TASKPOOL_CLASS_CONTROL, IOT_TASKPOOL_CLASS_CONTROL, IOT_TASKPOOL_CLASS_CONTROL, IOT_TASKPOOL_CLASS_CONTROL,
+        IOT_TASKPOOL_CLASS_DEFAULT, IOT_TASKPOOL_CLASS_DEFAULT, IOT_TASKPOOL_CLASS_DEFAULT, IOT_TASKPOOL_CLASS_DEFAULT,
+        IOT_TASKPOOL_CLASS_BULK,    IOT_TASKPOOL_CLASS_BULK,    IOT_TASKPOOL_CLASS_BULK,    IOT_TASKPOOL_CLASS_BULK
+    };
+
+    memset( &userContext, 0, sizeof( JobOrderUserContext_t ) );
+
+    /* Initialize user contexts. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.signal, 0, 1 ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.block, 0, 1 ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        /* Invalid classes are rejected. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &BlankExecution, NULL, &blockingJobStorage, &blockingJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_SetJobClass( NULL, IOT_TASKPOOL_CLASS_CONTROL, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_SetJobClass( blockingJob, ( IotTaskPoolJobClass_t ) 3, 0 ) == IOT_TASKPOOL_BAD_PARAMETER );
+
+        /* Block the only worker, so that all the jobs below are queued. The blocking job takes
+         * one of the control credits of the round, which leaves enough for the control jobs. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionBlockingWithoutDestroyCb, &blockingUserContext, &blockingJobStorage, &blockingJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_SetJobClass( blockingJob, IOT_TASKPOOL_CLASS_CONTROL, 0 ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, blockingJob, 0 ) == IOT_TASKPOOL_SUCCESS );
+
+        IotSemaphore_Wait( &blockingUserContext.signal );
+
+        /* Queue the classes in reverse order of priority. */
+        for( count = 0; count < 3 * TEST_TASKPOOL_JOBS_PER_CLASS; ++count )
+        {
+            IotTaskPoolJobClass_t jobClass = ( IotTaskPoolJobClass_t ) ( IOT_TASKPOOL_CLASS_BULK - ( count / TEST_TASKPOOL_JOBS_PER_CLASS ) );
+
+            entries[ count ].pUserContext = &userContext;
+            entries[ count ].id = ( uint32_t ) jobClass;
+
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionOrderCb, &entries[ count ], &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_SetJobClass( jobs[ count ], jobClass, 0 ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ count ], 0 ) == IOT_TASKPOOL_SUCCESS );
+
+            /* The class of a queued job cannot change. */
+            TEST_ASSERT( IotTaskPool_SetJobClass( jobs[ count ], IOT_TASKPOOL_CLASS_DEFAULT, 0 ) == IOT_TASKPOOL_ILLEGAL_OPERATION );
+        }
+
+        /* Release the worker. */
+        IotSemaphore_Post( &blockingUserContext.block );
+
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == 3 * TEST_TASKPOOL_JOBS_PER_CLASS )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32_ARRAY( expectedClasses, userContext.order, 3 * TEST_TASKPOOL_JOBS_PER_CLASS );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user contexts. */
+    IotMutex_Destroy( &userContext.lock );
+    IotSemaphore_Destroy( &blockingUserContext.signal );
+    IotSemaphore_Destroy( &blockingUserContext.block );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that a job that missed its deadline jumps ahead of higher classes and is reported late.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_JobDeadline )
+{
+    uint32_t count;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 1, .maxThreads = 1, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolJobStorage_t blockingJobStorage;
+    IotTaskPoolJob_t blockingJob;
+    IotTaskPoolJobStorage_t jobsStorage[ TEST_TASKPOOL_JOBS_PER_CLASS ];
+    IotTaskPoolJob_t jobs[ TEST_TASKPOOL_JOBS_PER_CLASS ];
+    JobOrderEntry_t entries[ TEST_TASKPOOL_JOBS_PER_CLASS ];
+    JobOrderUserContext_t userContext;
+    JobBlockingUserContext_t blockingUserContext;
+
+    memset( &userContext, 0, sizeof( JobOrderUserContext_t ) );
+
+    /* Initialize user contexts. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.signal, 0, 1 ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.block, 0, 1 ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        TEST_ASSERT( IotTaskPool_SetLateJobCallback( NULL, LateJobCb, &userContext ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_SetLateJobCallback( taskPool, LateJobCb, &userContext ) == IOT_TASKPOOL_SUCCESS );
+
+        /* Block the only worker, so that all the jobs below are queued. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionBlockingWithoutDestroyCb, &blockingUserContext, &blockingJobStorage, &blockingJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, blockingJob, 0 ) == IOT_TASKPOOL_SUCCESS );
+
+        IotSemaphore_Wait( &blockingUserContext.signal );
+
+        /* Control jobs without a deadline, then a bulk job with a short deadline. */
+        for( count = 0; count < TEST_TASKPOOL_JOBS_PER_CLASS; ++count )
+        {
+            bool bulk = ( count == ( TEST_TASKPOOL_JOBS_PER_CLASS - 1 ) );
+
+            entries[ count ].pUserContext = &userContext;
+            entries[ count ].id = count;
+
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionOrderCb, &entries[ count ], &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_SetJobClass( jobs[ count ],
+                                                  bulk ? IOT_TASKPOOL_CLASS_BULK : IOT_TASKPOOL_CLASS_CONTROL,
+                                                  bulk ? 10 : 0 ) == IOT_TASKPOOL_SUCCESS );
+            TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ count ], 0 ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        /* Let the deadline pass, then release the worker. */
+        IotClock_SleepMs( 100 );
+
+        IotSemaphore_Post( &blockingUserContext.block );
+
+        while( true )
+        {
+            IotClock_SleepMs( 50 );
+
+            IotMutex_Lock( &userContext.lock );
+
+            if( userContext.counter == TEST_TASKPOOL_JOBS_PER_CLASS )
+            {
+                IotMutex_Unlock( &userContext.lock );
+
+                break;
+            }
+
+            IotMutex_Unlock( &userContext.lock );
+        }
+
+        /* The late bulk job ran first, and only it was reported. */
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_JOBS_PER_CLASS - 1, userContext.order[ 0 ] );
+        TEST_ASSERT_EQUAL_UINT32( 1, userContext.lateJobs );
+        TEST_ASSERT( userContext.lateMs >= 50 );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user contexts. */
+    IotMutex_Destroy( &userContext.lock );
+    IotSemaphore_Destroy( &blockingUserContext.signal );
+    IotSemaphore_Destroy( &blockingUserContext.block );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test that the task pool statistics account for queued, executed, cached and deferred jobs.
+ */
+TEST( Common_Unit_Task_Pool, ScheduleTasks_Stats )
+{
+    uint32_t count, bucket, bucketsTotal;
+    IotTaskPool_t taskPool = IOT_TASKPOOL_INITIALIZER;
+    const IotTaskPoolInfo_t tpInfo = { .minThreads = 1, .maxThreads = 1, .stackSize = IOT_THREAD_DEFAULT_STACK_SIZE, .priority = IOT_THREAD_DEFAULT_PRIORITY };
+    IotTaskPoolStats_t stats;
+    IotTaskPoolJobStorage_t blockingJobStorage;
+    IotTaskPoolJob_t blockingJob;
+    IotTaskPoolJob_t recyclableJob;
+    IotTaskPoolJobStorage_t jobsStorage[ TEST_TASKPOOL_JOBS_PER_CLASS + 1 ];
+    IotTaskPoolJob_t jobs[ TEST_TASKPOOL_JOBS_PER_CLASS + 1 ];
+    JobOrderEntry_t entries[ TEST_TASKPOOL_JOBS_PER_CLASS + 1 ];
+    JobOrderUserContext_t userContext;
+    JobBlockingUserContext_t blockingUserContext;
+
+    memset( &userContext, 0, sizeof( JobOrderUserContext_t ) );
+
+    /* Initialize user contexts. */
+    TEST_ASSERT( IotMutex_Create( &userContext.lock, false ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.signal, 0, 1 ) );
+    TEST_ASSERT( IotSemaphore_Create( &blockingUserContext.block, 0, 1 ) );
+
+    TEST_ASSERT( IotTaskPool_Create( &tpInfo, &taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    if( TEST_PROTECT() )
+    {
+        TEST_ASSERT( IotTaskPool_GetStats( NULL, &stats ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_GetStats( taskPool, NULL ) == IOT_TASKPOOL_BAD_PARAMETER );
+        TEST_ASSERT( IotTaskPool_ResetStats( NULL ) == IOT_TASKPOOL_BAD_PARAMETER );
+
+        /* A recyclable job is allocated first, then taken from the cache once recycled. */
+        TEST_ASSERT( IotTaskPool_CreateRecyclableJob( taskPool, &ExecutionOrderCb, NULL, &recyclableJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_RecycleJob( taskPool, recyclableJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_CreateRecyclableJob( taskPool, &ExecutionOrderCb, NULL, &recyclableJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_DestroyRecyclableJob( taskPool, recyclableJob ) == IOT_TASKPOOL_SUCCESS );
+
+        /* Block the only worker, so that the jobs below are queued. */
+        TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionBlockingWithoutDestroyCb, &blockingUserContext, &blockingJobStorage, &blockingJob ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_Schedule( taskPool, blockingJob, 0 ) == IOT_TASKPOOL_SUCCESS );
+
+        IotSemaphore_Wait( &blockingUserContext.signal );
+
+        for( count = 0; count < TEST_TASKPOOL_JOBS_PER_CLASS + 1; ++count )
+        {
+            entries[ count ].pUserContext = &userContext;
+            entries[ count ].id = count;
+
+            TEST_ASSERT( IotTaskPool_CreateJob( &ExecutionOrderCb, &entries[ count ], &jobsStorage[ count ], &jobs[ count ] ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        for( count = 0; count < TEST_TASKPOOL_JOBS_PER_CLASS; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_Schedule( taskPool, jobs[ count ], 0 ) == IOT_TASKPOOL_SUCCESS );
+        }
+
+        TEST_ASSERT( IotTaskPool_ScheduleDeferred( taskPool, jobs[ TEST_TASKPOOL_JOBS_PER_CLASS ], 200 ) == IOT_TASKPOOL_SUCCESS );
+
+        TEST_ASSERT( IotTaskPool_GetStats( taskPool, &stats ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_JOBS_PER_CLASS, stats.queuedJobs );
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_JOBS_PER_CLASS, stats.peakQueuedJobs );
+        TEST_ASSERT_EQUAL_UINT32( 1, stats.deferredJobs );
+        TEST_ASSERT_EQUAL_UINT32( 1, stats.activeThreads );
+        TEST_ASSERT_EQUAL_UINT32( 1, stats.cacheHits );
+        TEST_ASSERT_EQUAL_UINT32( 1, stats.cacheMisses );
+
+        /* Keep the jobs queued for a while, then release the worker. */
+        IotClock_SleepMs( 100 );
+
+        IotSemaphore_Post( &blockingUserContext.block );
+
+        /* The statistics of a job are recorded right after its callback returns. */
+        for( count = 0; count < 100; ++count )
+        {
+            TEST_ASSERT( IotTaskPool_GetStats( taskPool, &stats ) == IOT_TASKPOOL_SUCCESS );
+
+            if( stats.executionTime.count == TEST_TASKPOOL_JOBS_PER_CLASS + 2 )
+            {
+                break;
+            }
+
+            IotClock_SleepMs( 50 );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_JOBS_PER_CLASS + 2, stats.executionTime.count );
+        TEST_ASSERT_EQUAL_UINT32( TEST_TASKPOOL_JOBS_PER_CLASS + 2, stats.queueDelay.count );
+        TEST_ASSERT_EQUAL_UINT32( 1, stats.timerLateness.count );
+        TEST_ASSERT_EQUAL_UINT32( 0, stats.queuedJobs );
+        TEST_ASSERT_EQUAL_UINT32( 0, stats.deferredJobs );
+
+        /* The blocking job executed, and the jobs behind it waited, for at least 100 ms. */
+        TEST_ASSERT( stats.executionTime.maxMs >= 100 );
+        TEST_ASSERT( stats.queueDelay.maxMs >= 100 );
+        TEST_ASSERT( stats.queueDelay.sumMs >= ( 100 * TEST_TASKPOOL_JOBS_PER_CLASS ) );
+
+        for( bucket = 0, bucketsTotal = 0; bucket < IOT_TASKPOOL_HISTOGRAM_BUCKETS; ++bucket )
+        {
+            bucketsTotal += stats.queueDelay.buckets[ bucket ];
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( stats.queueDelay.count, bucketsTotal );
+
+        /* Resetting clears counters and histograms, but not gauges. */
+        TEST_ASSERT( IotTaskPool_ResetStats( taskPool ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT( IotTaskPool_GetStats( taskPool, &stats ) == IOT_TASKPOOL_SUCCESS );
+        TEST_ASSERT_EQUAL_UINT32( 0, stats.executionTime.count );
+        TEST_ASSERT_EQUAL_UINT32( 0, stats.timerLateness.count );
+        TEST_ASSERT_EQUAL_UINT32( 0, stats.cacheHits );
+        TEST_ASSERT_EQUAL_UINT32( 0, stats.peakQueuedJobs );
+        TEST_ASSERT_EQUAL_UINT32( 1, stats.activeThreads );
+    }
+
+    TEST_ASSERT( IotTaskPool_Destroy( taskPool ) == IOT_TASKPOOL_SUCCESS );
+
+    /* Destroy user contexts. */
+    IotMutex_Destroy( &userContext.lock );
+    IotSemaphore_Destroy( &blockingUserContext.signal );
+    IotSemaphore_Destroy( &blockingUserContext.block );
+}
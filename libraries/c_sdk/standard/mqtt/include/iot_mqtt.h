@@ -52,10 +52,14 @@
  * - @functionname{mqtt_function_timedunsubscribe}
  * - @functionname{mqtt_function_publish}
  * - @functionname{mqtt_function_timedpublish}
+ * - @functionname{mqtt_function_publishbatch}
  * - @functionname{mqtt_function_wait}
+ * - @functionname{mqtt_function_retainpublish}
+ * - @functionname{mqtt_function_releasepublish}
  * - @functionname{mqtt_function_strerror}
  * - @functionname{mqtt_function_operationtype}
  * - @functionname{mqtt_function_issubscribed}
+ * - @functionname{mqtt_function_getmemorystats}
  */
 
 /**
@@ -70,10 +74,14 @@
  * @functionpage{IotMqtt_TimedUnsubscribe,mqtt,timedunsubscribe}
  * @functionpage{IotMqtt_Publish,mqtt,publish}
  * @functionpage{IotMqtt_TimedPublish,mqtt,timedpublish}
+ * @functionpage{IotMqtt_PublishBatch,mqtt,publishbatch}
  * @functionpage{IotMqtt_Wait,mqtt,wait}
+ * @functionpage{IotMqtt_RetainPublish,mqtt,retainpublish}
+ * @functionpage{IotMqtt_ReleasePublish,mqtt,releasepublish}
  * @functionpage{IotMqtt_strerror,mqtt,strerror}
  * @functionpage{IotMqtt_OperationType,mqtt,operationtype}
  * @functionpage{IotMqtt_IsSubscribed,mqtt,issubscribed}
+ * @functionpage{IotMqtt_GetMemoryStats,mqtt,getmemorystats}
  */
 
 /**
@@ -682,6 +690,56 @@ IotMqttError_t IotMqtt_TimedPublish( IotMqttConnection_t mqttConnection,
                                      uint32_t timeoutMs );
 /* @[declare_mqtt_timedpublish] */
 
+/**
+ * @brief Publish several messages with a single network write and receive one
+ * notification when all of them complete.
+ *
+ * The PUBLISH packets are serialized one after another into a single buffer,
+ * which is sent with one call to the network interface. The packet identifiers
+ * of the QoS 1 messages are tracked in the MQTT connection's in-flight window
+ * (see @ref IOT_MQTT_INFLIGHT_WINDOW). The batch completes once every QoS 1
+ * message has been acknowledged by the server.
+ *
+ * @attention QoS 2 messages are currently unsupported. Only 0 or 1 are valid
+ * for message QoS. Messages of a batch are never retransmitted, so their
+ * [retryLimit](@ref IotMqttPublishInfo_t.retryLimit) must be `0`.
+ *
+ * @param[in] mqttConnection The MQTT connection to use for the publishes.
+ * @param[in] pPublishInfoList Pointer to the first element in an array of MQTT
+ * publish parameters.
+ * @param[in] publishCount The number of elements in `pPublishInfoList`.
+ * @param[in] flags Flags which modify the behavior of this function. See @ref mqtt_constants_flags.
+ * @param[in] pCallbackInfo Asynchronous notification of this function's completion.
+ * @param[out] pBatchOperation Set to a handle by which this batch may be
+ * referenced after this function returns. This reference is invalidated once
+ * the batch completes.
+ *
+ * @return This function will return #IOT_MQTT_STATUS_PENDING upon success for
+ * a batch with a QoS 1 message, and #IOT_MQTT_SUCCESS upon success for a batch
+ * of only QoS 0 messages.
+ * @return Upon completion of a batch with a QoS 1 message (either through an
+ * #IotMqttCallbackInfo_t or @ref mqtt_function_wait), the status will be one of:
+ * - #IOT_MQTT_SUCCESS
+ * - #IOT_MQTT_NETWORK_ERROR
+ * - #IOT_MQTT_SCHEDULING_ERROR
+ * - #IOT_MQTT_BAD_RESPONSE
+ * @return If this function fails before queuing the batch, it will return one of:
+ * - #IOT_MQTT_BAD_PARAMETER
+ * - #IOT_MQTT_NO_MEMORY (also returned if the in-flight window cannot hold
+ * every QoS 1 message of the batch)
+ *
+ * @note The parameters `pCallbackInfo` and `pBatchOperation` should only be used
+ * for batches with a QoS 1 message. Otherwise, they should both be `NULL`.
+ */
+/* @[declare_mqtt_publishbatch] */
+IotMqttError_t IotMqtt_PublishBatch( IotMqttConnection_t mqttConnection,
+                                     const IotMqttPublishInfo_t * pPublishInfoList,
+                                     size_t publishCount,
+                                     uint32_t flags,
+                                     const IotMqttCallbackInfo_t * pCallbackInfo,
+                                     IotMqttOperation_t * pBatchOperation );
+/* @[declare_mqtt_publishbatch] */
+
 /**
  * @brief Waits for an operation to complete.
  *
@@ -736,6 +794,68 @@ IotMqttError_t IotMqtt_Wait( IotMqttOperation_t operation,
                              uint32_t timeoutMs );
 /* @[declare_mqtt_wait] */
 
+/**
+ * @brief Keeps the buffer of an incoming PUBLISH after its subscription callback
+ * returns.
+ *
+ * Incoming PUBLISH messages are passed to subscription callbacks without being
+ * copied: the topic name and payload in [the callback parameter](@ref IotMqttCallbackParam_t.u.message.info)
+ * point into the buffer the PUBLISH was received in, which is normally freed as
+ * soon as all subscription callbacks return. Calling this function from a
+ * subscription callback takes a loan on that buffer, so that the application
+ * may keep using the received message without copying it.
+ *
+ * Each successful call to this function must be matched by a call to
+ * @ref mqtt_function_releasepublish. A retained PUBLISH also keeps its MQTT
+ * connection from being destroyed; the memory of the MQTT connection is not
+ * freed until all of its retained PUBLISH messages are released.
+ *
+ * @param[in] publish The [reference](@ref IotMqttCallbackParam_t.u.message.reference)
+ * of an incoming PUBLISH. This function must be called before the subscription
+ * callback that received `publish` returns, or while another loan on `publish`
+ * is held.
+ *
+ * @return One of the following:
+ * - #IOT_MQTT_SUCCESS
+ * - #IOT_MQTT_BAD_PARAMETER
+ *
+ * <b>Example</b>
+ * @code{c}
+ * // A queue of received messages processed outside of the MQTT callback.
+ * extern void enqueueMessage( IotMqttOperation_t publish,
+ *                             const IotMqttPublishInfo_t * pPublishInfo );
+ *
+ * void subscriptionCallback( void * pArgument,
+ *                            IotMqttCallbackParam_t * pPublish )
+ * {
+ *     // Keep the received message without copying it.
+ *     if( IotMqtt_RetainPublish( pPublish->u.message.reference ) == IOT_MQTT_SUCCESS )
+ *     {
+ *         // The consumer of the queue must call IotMqtt_ReleasePublish when
+ *         // it is finished with the message.
+ *         enqueueMessage( pPublish->u.message.reference,
+ *                         &( pPublish->u.message.info ) );
+ *     }
+ * }
+ * @endcode
+ */
+/* @[declare_mqtt_retainpublish] */
+IotMqttError_t IotMqtt_RetainPublish( IotMqttOperation_t publish );
+/* @[declare_mqtt_retainpublish] */
+
+/**
+ * @brief Releases a PUBLISH retained with @ref mqtt_function_retainpublish.
+ *
+ * The buffer of the PUBLISH is freed once all of its loans are released. After
+ * this function returns, the topic name and payload of `publish` must no longer
+ * be used.
+ *
+ * @param[in] publish The incoming PUBLISH to release.
+ */
+/* @[declare_mqtt_releasepublish] */
+void IotMqtt_ReleasePublish( IotMqttOperation_t publish );
+/* @[declare_mqtt_releasepublish] */
+
 /*-------------------------- MQTT helper functions --------------------------*/
 
 /**
@@ -820,4 +940,24 @@ bool IotMqtt_IsSubscribed( IotMqttConnection_t mqttConnection,
                            IotMqttSubscription_t * pCurrentSubscription );
 /* @[declare_mqtt_issubscribed] */
 
+/**
+ * @brief Get the usage of the MQTT library's fixed-size memory pools.
+ *
+ * With @ref IOT_STATIC_MEMORY_ONLY set to `1`, this function reports the pools
+ * of connections, operations, subscriptions, and topic nodes. Otherwise, only the
+ * [operation cache](@ref IOT_MQTT_OPERATION_CACHE_SIZE) and the
+ * [receive pool](@ref IOT_MQTT_RECEIVE_POOL_SIZE) are reported; memory taken
+ * from the system heap is not tracked and its statistics are zero.
+ *
+ * The high-water marks may be used to size @ref IOT_MQTT_CONNECTIONS,
+ * @ref IOT_MQTT_MAX_IN_PROGRESS_OPERATIONS, @ref IOT_MQTT_SUBSCRIPTIONS,
+ * @ref IOT_MQTT_TOPIC_NODES, @ref IOT_MQTT_OPERATION_CACHE_SIZE, and
+ * @ref IOT_MQTT_RECEIVE_POOL_SIZE.
+ *
+ * @param[out] pStats Receives the statistics of each pool.
+ */
+/* @[declare_mqtt_getmemorystats] */
+void IotMqtt_GetMemoryStats( IotMqttMemoryStats_t * pStats );
+/* @[declare_mqtt_getmemorystats] */
+
 #endif /* ifndef IOT_MQTT_H_ */
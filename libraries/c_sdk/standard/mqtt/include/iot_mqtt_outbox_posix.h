@@ -0,0 +1,59 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_mqtt_outbox_posix.h
+ * @brief Declares an MQTT outbox that stores its segments as files in a
+ * POSIX directory.
+ */
+
+#ifndef IOT_MQTT_OUTBOX_POSIX_H_
+#define IOT_MQTT_OUTBOX_POSIX_H_
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* MQTT types include. */
+#include "types/iot_mqtt_types.h"
+
+/**
+ * @brief Storage of an outbox in a POSIX directory, passed as
+ * #IotMqttOutboxInfo_t.pStorage.
+ *
+ * Every segment is a file named with the segment number in hexadecimal and a
+ * `.seg` extension. Appends are synced to the file system before they return.
+ */
+typedef struct IotMqttOutboxPosix
+{
+    const char * pDirectory; /**< @brief An existing directory used only by this outbox. */
+} IotMqttOutboxPosix_t;
+
+/**
+ * @brief Outbox storage functions for an #IotMqttOutboxPosix_t, passed as
+ * #IotMqttOutboxInfo_t.pInterface.
+ */
+extern const IotMqttOutboxInterface_t IotMqttOutboxPosix;
+
+#endif /* ifndef IOT_MQTT_OUTBOX_POSIX_H_ */
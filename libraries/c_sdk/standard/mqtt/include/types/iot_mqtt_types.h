@@ -46,6 +46,9 @@
 /* Platform network include. */
 #include "platform/iot_network.h"
 
+/* Slab allocator include. */
+#include "iot_slab.h"
+
 /*---------------------------- MQTT handle types ----------------------------*/
 
 /**
@@ -459,6 +462,17 @@ typedef struct IotMqttCallbackParam
             const char * pTopicFilter;  /**< @brief Topic filter that matched the message. */
             uint16_t topicFilterLength; /**< @brief Length of `pTopicFilter`. */
             IotMqttPublishInfo_t info;  /**< @brief PUBLISH message received from the server. */
+
+            /**
+             * @brief Reference to the received PUBLISH.
+             *
+             * The topic name and payload in `info` point directly into the
+             * buffer the PUBLISH was received in; they are only valid until the
+             * callback returns. Pass this reference to @ref mqtt_function_retainpublish
+             * to keep them valid after the callback returns, then to
+             * @ref mqtt_function_releasepublish once they are no longer needed.
+             */
+            IotMqttOperation_t reference;
         } message;
 
         /* Valid when a connection is disconnected. */
@@ -555,6 +569,97 @@ typedef struct IotMqttSubscription
     IotMqttCallbackInfo_t callback;
 } IotMqttSubscription_t;
 
+/**
+ * @ingroup mqtt_datatypes_paramstructs
+ * @brief Storage functions for a persistent MQTT outbox.
+ *
+ * @paramfor @ref mqtt_function_connect
+ *
+ * An outbox is an append-only log divided into numbered <i>segments</i>. The
+ * MQTT library appends records to the newest segment and removes the oldest
+ * segments once none of their QoS 1 PUBLISH messages remain unacknowledged.
+ * Segment numbers only increase. Each function receives the `pStorage` member
+ * of #IotMqttOutboxInfo_t.
+ *
+ * The MQTT library serializes all calls to these functions for a connection.
+ * Records are protected by a CRC, so a record that was only partially written
+ * when a device reset is discarded when the outbox is next read.
+ */
+typedef struct IotMqttOutboxInterface
+{
+    /**
+     * @brief Append data to the end of a segment, creating the segment if it
+     * does not exist.
+     *
+     * The data should be on non-volatile storage when this function returns.
+     *
+     * @return `true` if all of the data was appended; `false` otherwise.
+     */
+    bool ( * append )( void * pStorage,
+                       uint32_t segment,
+                       const uint8_t * pData,
+                       size_t length );
+
+    /**
+     * @brief Read data from a segment.
+     *
+     * @return The number of bytes read, which is less than `length` if the end
+     * of the segment was reached; `0` if the segment does not exist.
+     */
+    size_t ( * read )( void * pStorage,
+                       uint32_t segment,
+                       size_t offset,
+                       uint8_t * pBuffer,
+                       size_t length );
+
+    /**
+     * @brief Remove a segment.
+     *
+     * @return `true` if the segment was removed or did not exist; `false` otherwise.
+     */
+    bool ( * remove )( void * pStorage,
+                       uint32_t segment );
+
+    /**
+     * @brief Find the oldest and newest segments in storage.
+     *
+     * @return `true` if storage has any segments; `false` if it is empty.
+     */
+    bool ( * range )( void * pStorage,
+                      uint32_t * pFirstSegment,
+                      uint32_t * pLastSegment );
+} IotMqttOutboxInterface_t;
+
+/**
+ * @ingroup mqtt_datatypes_paramstructs
+ * @brief Information on a persistent MQTT outbox.
+ *
+ * @paramfor @ref mqtt_function_connect
+ *
+ * QoS 1 PUBLISH messages sent on a connection with an outbox are written to
+ * storage before they are sent, and are marked as acknowledged when their PUBACK
+ * is received. When a connection with the same outbox is established, the
+ * unacknowledged PUBLISH messages are sent again in the order they were first
+ * published, before any new PUBLISH.
+ *
+ * The outbox holds at most @ref IOT_MQTT_OUTBOX_SEGMENTS segments of
+ * #IotMqttOutboxInfo_t.segmentSize bytes. @ref mqtt_function_publish fails with
+ * #IOT_MQTT_NO_MEMORY when the outbox is full.
+ */
+typedef struct IotMqttOutboxInfo
+{
+    /**
+     * @brief The storage functions of this outbox.
+     *
+     * @attention The function pointers must remain valid for the lifetime of
+     * the MQTT connection.
+     */
+    const IotMqttOutboxInterface_t * pInterface;
+
+    void * pStorage;    /**< @brief Passed to every function of #IotMqttOutboxInfo_t.pInterface. */
+    size_t segmentSize; /**< @brief The largest size of a segment, in bytes. Limits the size of a persisted PUBLISH. */
+} IotMqttOutboxInfo_t;
+
 /**
  * @ingroup mqtt_datatypes_paramstructs
  * @brief Information on a new MQTT connection.
@@ -670,6 +775,18 @@ typedef struct IotMqttConnectInfo
     uint16_t userNameLength; /**< @brief Length of #IotMqttConnectInfo_t.pUserName. */
     const char * pPassword;  /**< @brief Password for MQTT connection. */
     uint16_t passwordLength; /**< @brief Length of #IotMqttConnectInfo_t.pPassword. */
+
+    /**
+     * @brief A persistent outbox for the QoS 1 PUBLISH messages of this
+     * connection, if any.
+     *
+     * Unacknowledged PUBLISH messages in the outbox are sent again once the
+     * connection is established. See #IotMqttOutboxInfo_t.
+     *
+     * This member is ignored if it is `NULL` or #IotMqttConnectInfo_t.cleanSession
+     * is `true`. An outbox cannot be used with MQTT packet serializer overrides.
+     */
+    const IotMqttOutboxInfo_t * pOutbox;
 } IotMqttConnectInfo_t;
 
 #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
@@ -994,6 +1111,21 @@ typedef struct IotMqttNetworkInfo
     #endif
 } IotMqttNetworkInfo_t;
 
+/**
+ * @ingroup mqtt_datatypes_paramstructs
+ * @brief Usage of the MQTT library's fixed-size memory pools.
+ *
+ * @paramfor @ref mqtt_function_getmemorystats
+ */
+typedef struct IotMqttMemoryStats
+{
+    IotSlabStats_t connections;   /**< @brief MQTT connections. */
+    IotSlabStats_t operations;    /**< @brief In-progress MQTT operations. */
+    IotSlabStats_t subscriptions; /**< @brief MQTT subscriptions. */
+    IotSlabStats_t topicNodes;    /**< @brief Topic levels of the subscription index. */
+    IotSlabStats_t receivePool;   /**< @brief Buffers of received packets. */
+} IotMqttMemoryStats_t;
+
 /*------------------------- MQTT defined constants --------------------------*/
 
 /**
@@ -1030,6 +1162,8 @@ typedef struct IotMqttNetworkInfo
  *   @copybrief IOT_MQTT_FLAG_WAITABLE
  * - #IOT_MQTT_FLAG_CLEANUP_ONLY <br>
  *   @copybrief IOT_MQTT_FLAG_CLEANUP_ONLY
+ * - #IOT_MQTT_FLAG_NO_COPY <br>
+ *   @copybrief IOT_MQTT_FLAG_NO_COPY
  *
  * Flags should be bitwise-ORed with each other to change the behavior of
  * @ref mqtt_function_subscribe, @ref mqtt_function_unsubscribe,
@@ -1084,4 +1218,22 @@ typedef struct IotMqttNetworkInfo
  */
 #define IOT_MQTT_FLAG_CLEANUP_ONLY    ( 0x00000001 )
 
+/**
+ * @brief Allows @ref mqtt_function_publish to send the payload without copying
+ * it into the MQTT packet.
+ *
+ * This flag is only valid for @ref mqtt_function_publish. If it is set, the
+ * PUBLISH payload is sent directly from [pPublishInfo->pPayload](@ref IotMqttPublishInfo_t.pPayload)
+ * using the network interface's @ref platform_network_function_sendv. The
+ * payload is copied as usual if the network interface does not provide
+ * @ref platform_network_function_sendv or a PUBLISH serializer override is set.
+ *
+ * @attention If this flag is set, the payload buffer <b>MUST</b> remain valid and
+ * unmodified until the PUBLISH operation completes (for QoS 1, including any
+ * retransmissions). For QoS 0, that is when the PUBLISH is sent; since QoS 0
+ * PUBLISH messages do not notify of completion, this flag should only be used
+ * with QoS 0 payloads that are never freed or modified.
+ */
+#define IOT_MQTT_FLAG_NO_COPY         ( 0x00000002 )
+
 #endif /* ifndef IOT_MQTT_TYPES_H_ */
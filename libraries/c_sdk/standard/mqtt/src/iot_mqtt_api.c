@@ -177,6 +177,9 @@ static void _mqttSubscription_tryDestroy( void * pData )
     /* Unsubscribed flag should be set. */
     IotMqtt_Assert( pSubscription->unsubscribed == true );
 
+    /* Remove the subscription from the subscription index. */
+    _IotMqtt_RemoveSubscriptionFromIndex( pSubscription );
+
     /* Free the subscription if it has no references. */
     if( pSubscription->references == 0 )
     {
@@ -294,6 +297,19 @@ static bool _createKeepAliveJob( const IotMqttNetworkInfo_t * pNetworkInfo,
                                            &( pMqttConnection->keepAliveJobStorage ),
                                            &( pMqttConnection->keepAliveJob ) );
 
+        /* Keep-alive must not wait behind bulk jobs, or the server may close
+         * the connection. */
+        if( jobStatus == IOT_TASKPOOL_SUCCESS )
+        {
+            jobStatus = IotTaskPool_SetJobClass( pMqttConnection->keepAliveJob,
+                                                 IOT_TASKPOOL_CLASS_CONTROL,
+                                                 0 );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
         /* Task pool job creation for a pre-allocated job should never fail.
          * Abort the program if it does. */
         if( jobStatus != IOT_TASKPOOL_SUCCESS )
@@ -323,6 +339,7 @@ static _mqttConnection_t * _createMqttConnection( bool awsIotMqttMode,
     IOT_FUNCTION_ENTRY( bool, true );
     _mqttConnection_t * pMqttConnection = NULL;
     bool referencesMutexCreated = false, subscriptionMutexCreated = false;
+    size_t i = 0;
 
     /* Allocate memory for the new MQTT connection. */
     pMqttConnection = IotMqtt_MallocConnection( sizeof( _mqttConnection_t ) );
@@ -379,6 +396,18 @@ static _mqttConnection_t * _createMqttConnection( bool awsIotMqttMode,
     IotListDouble_Create( &( pMqttConnection->pendingProcessing ) );
     IotListDouble_Create( &( pMqttConnection->pendingResponse ) );
 
+    /* Create the buckets of the subscription index. */
+    for( i = 0; i < IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS; i++ )
+    {
+        IotListDouble_Create( &( pMqttConnection->subscriptionIndex[ i ] ) );
+    }
+
+    /* Create the buckets of the in-flight table. */
+    for( i = 0; i < MQTT_INFLIGHT_BUCKETS; i++ )
+    {
+        IotListDouble_Create( &( pMqttConnection->inflight[ i ] ) );
+    }
+
     /* AWS IoT service limits set minimum and maximum values for keep-alive interval.
      * Adjust the user-provided keep-alive interval based on these requirements. */
     if( awsIotMqttMode == true )
@@ -471,6 +500,9 @@ static void _destroyMqttConnection( _mqttConnection_t * pMqttConnection )
 {
     IotNetworkError_t networkStatus = IOT_NETWORK_SUCCESS;
 
+    /* Close the outbox, destroying any PUBLISH messages it did not send. */
+    _IotMqtt_OutboxClose( pMqttConnection );
+
     /* Clean up keep-alive if still allocated. */
     if( pMqttConnection->keepAliveMs != 0 )
     {
@@ -705,32 +737,8 @@ static IotMqttError_t _subscriptionCommon( IotMqttOperationType_t operation,
         *pOperationReference = pSubscriptionOperation;
     }
 
-    /* Schedule the subscription operation for network transmission. */
-    status = _IotMqtt_ScheduleOperation( pSubscriptionOperation,
-                                         _IotMqtt_ProcessSend,
-                                         0 );
-
-    if( status != IOT_MQTT_SUCCESS )
-    {
-        IotLogError( "(MQTT connection %p) Failed to schedule %s for sending.",
-                     mqttConnection,
-                     IotMqtt_OperationType( operation ) );
-
-        if( operation == IOT_MQTT_SUBSCRIBE )
-        {
-            _IotMqtt_RemoveSubscriptionByPacket( mqttConnection,
-                                                 pSubscriptionOperation->u.operation.packetIdentifier,
-                                                 -1 );
-        }
-
-        /* Clear the previously set (and now invalid) reference. */
-        if( pOperationReference != NULL )
-        {
-            *pOperationReference = IOT_MQTT_OPERATION_INITIALIZER;
-        }
-
-        IOT_GOTO_CLEANUP();
-    }
+    /* Add the subscription operation to the send queue for network transmission. */
+    _IotMqtt_EnqueueSend( pSubscriptionOperation );
 
     /* Clean up if this function failed. */
     IOT_FUNCTION_CLEANUP_BEGIN();
@@ -852,10 +860,30 @@ IotMqttError_t IotMqtt_Init( void )
         #endif
     #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
 
+    /* Create the mutexes of the operation cache and receive pool if either is
+     * enabled. */
+    #if MQTT_MEMORY_CACHES == 1
+        if( status == IOT_MQTT_SUCCESS )
+        {
+            if( _IotMqtt_InitMemory() == false )
+            {
+                status = IOT_MQTT_INIT_FAILED;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    #endif
+
     /* Log initialization status. */
     if( status != IOT_MQTT_SUCCESS )
     {
-        IotLogError( "Failed to initialize MQTT library serializer. " );
+        IotLogError( "Failed to initialize MQTT library." );
     }
     else
     {
@@ -877,6 +905,10 @@ void IotMqtt_Cleanup( void )
         #endif
     #endif
 
+    #if MQTT_MEMORY_CACHES == 1
+        _IotMqtt_CleanupMemory();
+    #endif
+
     IotLogInfo( "MQTT library cleanup done." );
 }
 
@@ -920,6 +952,22 @@ IotMqttError_t IotMqtt_Connect( const IotMqttNetworkInfo_t * pNetworkInfo,
         EMPTY_ELSE_MARKER;
     }
 
+    /* An outbox persists PUBLISH packets from the default serializer. */
+    #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
+        if( ( pNetworkInfo->pMqttSerializer != NULL ) &&
+            ( pConnectInfo->cleanSession == false ) &&
+            ( pConnectInfo->pOutbox != NULL ) )
+        {
+            IotLogError( "An outbox cannot be used with MQTT packet serializer overrides." );
+
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
+
     /* If will info is provided, check that it is valid. */
     if( pConnectInfo->pWillInfo != NULL )
     {
@@ -1039,6 +1087,25 @@ IotMqttError_t IotMqtt_Connect( const IotMqttNetworkInfo_t * pNetworkInfo,
         EMPTY_ELSE_MARKER;
     }
 
+    /* Read the outbox of a persistent session. */
+    if( ( pConnectInfo->cleanSession == false ) && ( pConnectInfo->pOutbox != NULL ) )
+    {
+        status = _IotMqtt_OutboxOpen( pNewMqttConnection, pConnectInfo->pOutbox );
+
+        if( status != IOT_MQTT_SUCCESS )
+        {
+            IOT_GOTO_CLEANUP();
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Create a CONNECT operation. */
     status = _IotMqtt_CreateOperation( pNewMqttConnection,
                                        IOT_MQTT_FLAG_WAITABLE,
@@ -1127,24 +1194,15 @@ IotMqttError_t IotMqtt_Connect( const IotMqttNetworkInfo_t * pNetworkInfo,
     IotMqtt_Assert( pOperation->u.operation.packetSize > 0 );
 
     /* Add the CONNECT operation to the send queue for network transmission. */
-    status = _IotMqtt_ScheduleOperation( pOperation,
-                                         _IotMqtt_ProcessSend,
-                                         0 );
+    _IotMqtt_EnqueueSend( pOperation );
 
-    if( status != IOT_MQTT_SUCCESS )
-    {
-        IotLogError( "Failed to enqueue CONNECT for sending." );
-    }
-    else
-    {
-        /* Wait for the CONNECT operation to complete, i.e. wait for CONNACK. */
-        status = IotMqtt_Wait( pOperation,
-                               timeoutMs );
+    /* Wait for the CONNECT operation to complete, i.e. wait for CONNACK. */
+    status = IotMqtt_Wait( pOperation,
+                           timeoutMs );
 
-        /* The call to wait cleans up the CONNECT operation, so set the pointer
-         * to NULL. */
-        pOperation = NULL;
-    }
+    /* The call to wait cleans up the CONNECT operation, so set the pointer
+     * to NULL. */
+    pOperation = NULL;
 
     /* When a connection is successfully established, schedule keep-alive job. */
     if( status == IOT_MQTT_SUCCESS )
@@ -1171,6 +1229,10 @@ IotMqttError_t IotMqtt_Connect( const IotMqttNetworkInfo_t * pNetworkInfo,
         {
             EMPTY_ELSE_MARKER;
         }
+
+        /* Send any unacknowledged PUBLISH messages from the outbox before
+         * any new PUBLISH. */
+        _IotMqtt_OutboxReplay( pNewMqttConnection );
     }
     else
     {
@@ -1310,36 +1372,28 @@ void IotMqtt_Disconnect( IotMqttConnection_t mqttConnection,
                 IotMqtt_Assert( pOperation->u.operation.pMqttPacket != NULL );
                 IotMqtt_Assert( pOperation->u.operation.packetSize > 0 );
 
-                /* Schedule the DISCONNECT operation for network transmission. */
-                if( _IotMqtt_ScheduleOperation( pOperation,
-                                                _IotMqtt_ProcessSend,
-                                                0 ) != IOT_MQTT_SUCCESS )
+                /* Add the DISCONNECT operation to the send queue for network
+                 * transmission. */
+                _IotMqtt_EnqueueSend( pOperation );
+
+                /* Wait a short time for the DISCONNECT packet to be transmitted. */
+                status = IotMqtt_Wait( pOperation,
+                                       IOT_MQTT_RESPONSE_WAIT_MS );
+
+                /* A wait on DISCONNECT should only ever return SUCCESS, TIMEOUT,
+                 * or NETWORK ERROR. */
+                if( status == IOT_MQTT_SUCCESS )
                 {
-                    IotLogWarn( "(MQTT connection %p) Failed to schedule DISCONNECT for sending.",
-                                mqttConnection );
-                    _IotMqtt_DestroyOperation( pOperation );
+                    IotLogInfo( "(MQTT connection %p) Connection disconnected.", mqttConnection );
                 }
                 else
                 {
-                    /* Wait a short time for the DISCONNECT packet to be transmitted. */
-                    status = IotMqtt_Wait( pOperation,
-                                           IOT_MQTT_RESPONSE_WAIT_MS );
+                    IotMqtt_Assert( ( status == IOT_MQTT_TIMEOUT ) ||
+                                    ( status == IOT_MQTT_NETWORK_ERROR ) );
 
-                    /* A wait on DISCONNECT should only ever return SUCCESS, TIMEOUT,
-                     * or NETWORK ERROR. */
-                    if( status == IOT_MQTT_SUCCESS )
-                    {
-                        IotLogInfo( "(MQTT connection %p) Connection disconnected.", mqttConnection );
-                    }
-                    else
-                    {
-                        IotMqtt_Assert( ( status == IOT_MQTT_TIMEOUT ) ||
-                                        ( status == IOT_MQTT_NETWORK_ERROR ) );
-
-                        IotLogWarn( "(MQTT connection %p) DISCONNECT not sent, error %s.",
-                                    mqttConnection,
-                                    IotMqtt_strerror( status ) );
-                    }
+                    IotLogWarn( "(MQTT connection %p) DISCONNECT not sent, error %s.",
+                                mqttConnection,
+                                IotMqtt_strerror( status ) );
                 }
             }
             else
@@ -1505,6 +1559,7 @@ IotMqttError_t IotMqtt_Publish( IotMqttConnection_t mqttConnection,
     IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
     _mqttOperation_t * pOperation = NULL;
     uint8_t ** pPacketIdentifierHigh = NULL;
+    bool sendPayload = false;
 
     /* Default PUBLISH serializer function. */
     IotMqttError_t ( * serializePublish )( const IotMqttPublishInfo_t *,
@@ -1596,13 +1651,27 @@ IotMqttError_t IotMqtt_Publish( IotMqttConnection_t mqttConnection,
     IotMqtt_Assert( pOperation->u.operation.status == IOT_MQTT_STATUS_PENDING );
     pOperation->u.operation.type = IOT_MQTT_PUBLISH_TO_SERVER;
 
+    /* Check if the payload may be sent from the caller's buffer. */
+    if( ( ( flags & IOT_MQTT_FLAG_NO_COPY ) == IOT_MQTT_FLAG_NO_COPY ) &&
+        ( pPublishInfo->payloadLength > 0 ) &&
+        ( mqttConnection->pNetworkInterface->sendv != NULL ) )
+    {
+        sendPayload = true;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Choose a PUBLISH serializer function. */
     #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
         if( mqttConnection->pSerializer != NULL )
         {
             if( mqttConnection->pSerializer->serialize.publish != NULL )
             {
+                /* A serializer override always serializes the whole packet. */
                 serializePublish = mqttConnection->pSerializer->serialize.publish;
+                sendPayload = false;
             }
             else
             {
@@ -1626,11 +1695,33 @@ IotMqttError_t IotMqtt_Publish( IotMqttConnection_t mqttConnection,
     }
 
     /* Generate a PUBLISH packet from pPublishInfo. */
-    status = serializePublish( pPublishInfo,
-                               &( pOperation->u.operation.pMqttPacket ),
-                               &( pOperation->u.operation.packetSize ),
-                               &( pOperation->u.operation.packetIdentifier ),
-                               pPacketIdentifierHigh );
+    if( sendPayload == true )
+    {
+        /* Only serialize the headers; the payload is sent from pPublishInfo. */
+        status = _IotMqtt_SerializePublishHeader( pPublishInfo,
+                                                  &( pOperation->u.operation.pMqttPacket ),
+                                                  &( pOperation->u.operation.packetSize ),
+                                                  &( pOperation->u.operation.packetIdentifier ),
+                                                  pPacketIdentifierHigh );
+
+        if( status == IOT_MQTT_SUCCESS )
+        {
+            pOperation->u.operation.pPayload = pPublishInfo->pPayload;
+            pOperation->u.operation.payloadLength = pPublishInfo->payloadLength;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        status = serializePublish( pPublishInfo,
+                                   &( pOperation->u.operation.pMqttPacket ),
+                                   &( pOperation->u.operation.packetSize ),
+                                   &( pOperation->u.operation.packetIdentifier ),
+                                   pPacketIdentifierHigh );
+    }
 
     if( status != IOT_MQTT_SUCCESS )
     {
@@ -1645,6 +1736,26 @@ IotMqttError_t IotMqtt_Publish( IotMqttConnection_t mqttConnection,
     IotMqtt_Assert( pOperation->u.operation.pMqttPacket != NULL );
     IotMqtt_Assert( pOperation->u.operation.packetSize > 0 );
 
+    /* Write a QoS 1 PUBLISH to the outbox before it is sent. */
+    if( ( mqttConnection->outbox.pInterface != NULL ) &&
+        ( pPublishInfo->qos == IOT_MQTT_QOS_1 ) )
+    {
+        status = _IotMqtt_OutboxPut( pOperation );
+
+        if( status != IOT_MQTT_SUCCESS )
+        {
+            IOT_GOTO_CLEANUP();
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Initialize PUBLISH retry if retryLimit is set. */
     if( pPublishInfo->retryLimit > 0 )
     {
@@ -1681,40 +1792,25 @@ IotMqttError_t IotMqtt_Publish( IotMqttConnection_t mqttConnection,
         EMPTY_ELSE_MARKER;
     }
 
-    /* Add the PUBLISH operation to the send queue for network transmission. */
-    status = _IotMqtt_ScheduleOperation( pOperation,
-                                         _IotMqtt_ProcessSend,
-                                         0 );
-
-    if( status != IOT_MQTT_SUCCESS )
+    /* Index a QoS 1 PUBLISH without retries before it is sent, so that a PUBACK
+     * received before its send job finishes is not lost. */
+    if( ( pPublishInfo->qos == IOT_MQTT_QOS_1 ) &&
+        ( pOperation->u.operation.retry.limit == 0 ) )
     {
-        IotLogError( "(MQTT connection %p) Failed to enqueue PUBLISH for sending.",
-                     mqttConnection );
-
-        /* Clear the previously set (and now invalid) reference. */
-        if( pPublishInfo->qos != IOT_MQTT_QOS_0 )
-        {
-            if( pPublishOperation != NULL )
-            {
-                *pPublishOperation = IOT_MQTT_OPERATION_INITIALIZER;
-            }
-            else
-            {
-                EMPTY_ELSE_MARKER;
-            }
-        }
-        else
-        {
-            EMPTY_ELSE_MARKER;
-        }
-
-        IOT_GOTO_CLEANUP();
+        IotMutex_Lock( &( mqttConnection->referencesMutex ) );
+        ( void ) _IotMqtt_InflightInsert( mqttConnection,
+                                          pOperation->u.operation.packetIdentifier,
+                                          pOperation );
+        IotMutex_Unlock( &( mqttConnection->referencesMutex ) );
     }
     else
     {
         EMPTY_ELSE_MARKER;
     }
 
+    /* Add the PUBLISH operation to the send queue for network transmission. */
+    _IotMqtt_EnqueueSend( pOperation );
+
     /* Clean up the PUBLISH operation if this function fails. Otherwise, set the
      * appropriate return code based on QoS. */
     IOT_FUNCTION_CLEANUP_BEGIN();
@@ -1802,6 +1898,298 @@ IotMqttError_t IotMqtt_TimedPublish( IotMqttConnection_t mqttConnection,
 
 /*-----------------------------------------------------------*/
 
+IotMqttError_t IotMqtt_PublishBatch( IotMqttConnection_t mqttConnection,
+                                     const IotMqttPublishInfo_t * pPublishInfoList,
+                                     size_t publishCount,
+                                     uint32_t flags,
+                                     const IotMqttCallbackInfo_t * pCallbackInfo,
+                                     IotMqttOperation_t * pBatchOperation )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    _mqttOperation_t * pOperation = NULL;
+    size_t i = 0, qos1Count = 0;
+    uint16_t pPacketIdentifiers[ IOT_MQTT_INFLIGHT_WINDOW ] = { 0 };
+
+    /* Check that the batch is not empty. */
+    if( ( pPublishInfoList == NULL ) || ( publishCount == 0 ) )
+    {
+        IotLogError( "PUBLISH batch cannot be empty." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check that every PUBLISH in the batch is valid and count the QoS 1 PUBLISH
+     * messages. */
+    for( i = 0; i < publishCount; i++ )
+    {
+        if( _IotMqtt_ValidatePublish( mqttConnection->awsIotMqttMode,
+                                      &( pPublishInfoList[ i ] ) ) == false )
+        {
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        if( pPublishInfoList[ i ].retryLimit > 0 )
+        {
+            IotLogError( "PUBLISH %lu of batch has a retry limit. Batched PUBLISH "
+                         "messages are not retransmitted.",
+                         ( unsigned long ) i );
+
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        if( pPublishInfoList[ i ].qos == IOT_MQTT_QOS_1 )
+        {
+            qos1Count++;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    /* Check that the in-flight window can hold the batch. */
+    if( qos1Count > IOT_MQTT_INFLIGHT_WINDOW )
+    {
+        IotLogError( "PUBLISH batch has %lu QoS 1 messages, which is more than the "
+                     "in-flight window of %lu.",
+                     ( unsigned long ) qos1Count,
+                     ( unsigned long ) IOT_MQTT_INFLIGHT_WINDOW );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Batched QoS 1 PUBLISH messages are not written to an outbox. */
+    if( ( qos1Count > 0 ) && ( mqttConnection->outbox.pInterface != NULL ) )
+    {
+        IotLogError( "QoS 1 PUBLISH batch cannot be sent on a connection with an outbox." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check that no notification is requested for a batch of only QoS 0 messages. */
+    if( qos1Count == 0 )
+    {
+        if( ( pCallbackInfo != NULL ) || ( ( flags & IOT_MQTT_FLAG_WAITABLE ) != 0 ) )
+        {
+            IotLogError( "QoS 0 PUBLISH batch should not have notification parameters set." );
+
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        if( pBatchOperation != NULL )
+        {
+            IotLogWarn( "Ignoring reference parameter for QoS 0 PUBLISH batch." );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check that a reference pointer is provided for a waitable operation. */
+    if( ( flags & IOT_MQTT_FLAG_WAITABLE ) == IOT_MQTT_FLAG_WAITABLE )
+    {
+        if( pBatchOperation == NULL )
+        {
+            IotLogError( "Reference must be provided for a waitable PUBLISH batch." );
+
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* A serializer override serializes each PUBLISH into its own packet, so it
+     * cannot be used to build a batch. */
+    #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
+        if( mqttConnection->pSerializer != NULL )
+        {
+            if( mqttConnection->pSerializer->serialize.publish != NULL )
+            {
+                IotLogError( "(MQTT connection %p) PUBLISH batches cannot be used with "
+                             "a PUBLISH serializer override.",
+                             mqttConnection );
+
+                IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
+
+    /* Create a PUBLISH operation for the whole batch. */
+    status = _IotMqtt_CreateOperation( mqttConnection,
+                                       flags,
+                                       pCallbackInfo,
+                                       &pOperation );
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check the PUBLISH operation data and set the operation type. */
+    IotMqtt_Assert( pOperation->u.operation.status == IOT_MQTT_STATUS_PENDING );
+    pOperation->u.operation.type = IOT_MQTT_PUBLISH_TO_SERVER;
+
+    /* Generate all PUBLISH packets of the batch in one buffer. */
+    status = _IotMqtt_SerializePublishBatch( pPublishInfoList,
+                                             publishCount,
+                                             &( pOperation->u.operation.pMqttPacket ),
+                                             &( pOperation->u.operation.packetSize ),
+                                             pPacketIdentifiers );
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Check the serialized MQTT packet. */
+    IotMqtt_Assert( pOperation->u.operation.pMqttPacket != NULL );
+    IotMqtt_Assert( pOperation->u.operation.packetSize > 0 );
+
+    /* Add the packet identifiers of the batch to the in-flight window. This must
+     * happen before the batch is sent, as PUBACKs may arrive immediately after. */
+    if( qos1Count > 0 )
+    {
+        IotMutex_Lock( &( mqttConnection->referencesMutex ) );
+
+        if( mqttConnection->batchInflightCount + qos1Count > IOT_MQTT_INFLIGHT_WINDOW )
+        {
+            IotLogError( "(MQTT connection %p) In-flight window is full; %lu of %lu "
+                         "batch entries are in use.",
+                         mqttConnection,
+                         ( unsigned long ) mqttConnection->batchInflightCount,
+                         ( unsigned long ) IOT_MQTT_INFLIGHT_WINDOW );
+
+            status = IOT_MQTT_NO_MEMORY;
+        }
+        else
+        {
+            pOperation->u.operation.batchCount = qos1Count;
+            pOperation->u.operation.batchPending = qos1Count;
+
+            for( i = 0; i < qos1Count; i++ )
+            {
+                ( void ) _IotMqtt_InflightInsert( mqttConnection,
+                                                  pPacketIdentifiers[ i ],
+                                                  pOperation );
+            }
+        }
+
+        IotMutex_Unlock( &( mqttConnection->referencesMutex ) );
+
+        if( status != IOT_MQTT_SUCCESS )
+        {
+            IOT_GOTO_CLEANUP();
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        /* Set the reference, if provided. */
+        if( pBatchOperation != NULL )
+        {
+            *pBatchOperation = pOperation;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Add the batch to the send queue for network transmission. */
+    _IotMqtt_EnqueueSend( pOperation );
+
+    /* Clean up the batch operation if this function fails. Otherwise, set the
+     * appropriate return code based on QoS. */
+    IOT_FUNCTION_CLEANUP_BEGIN();
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        if( pOperation != NULL )
+        {
+            _IotMqtt_DestroyOperation( pOperation );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        if( qos1Count > 0 )
+        {
+            status = IOT_MQTT_STATUS_PENDING;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        IotLogInfo( "(MQTT connection %p) MQTT PUBLISH batch of %lu messages queued.",
+                    mqttConnection,
+                    ( unsigned long ) publishCount );
+    }
+
+    IOT_FUNCTION_CLEANUP_END();
+}
+
+/*-----------------------------------------------------------*/
+
 IotMqttError_t IotMqtt_Wait( IotMqttOperation_t operation,
                              uint32_t timeoutMs )
 {
@@ -1908,6 +2296,78 @@ IotMqttError_t IotMqtt_Wait( IotMqttOperation_t operation,
 
 /*-----------------------------------------------------------*/
 
+IotMqttError_t IotMqtt_RetainPublish( IotMqttOperation_t publish )
+{
+    IotMqttError_t status = IOT_MQTT_SUCCESS;
+    _mqttConnection_t * pMqttConnection = NULL;
+
+    /* Only incoming PUBLISH messages may be retained. */
+    if( publish == NULL )
+    {
+        IotLogError( "Incoming PUBLISH reference cannot be NULL." );
+
+        status = IOT_MQTT_BAD_PARAMETER;
+    }
+    else if( publish->incomingPublish == false )
+    {
+        IotLogError( "(MQTT connection %p) Operation %p is not an incoming PUBLISH.",
+                     publish->pMqttConnection,
+                     publish );
+
+        status = IOT_MQTT_BAD_PARAMETER;
+    }
+    else
+    {
+        pMqttConnection = publish->pMqttConnection;
+
+        IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+
+        /* A PUBLISH may only be retained while another loan keeps it alive. */
+        if( publish->u.publish.loans > 0 )
+        {
+            ( publish->u.publish.loans )++;
+
+            /* The existing loan holds a connection reference, so the new loan's
+             * reference may be taken even if the connection is closed. */
+            ( pMqttConnection->references )++;
+
+            IotLogDebug( "(MQTT connection %p) Incoming PUBLISH %p retained, %ld loans.",
+                         pMqttConnection,
+                         publish,
+                         ( long int ) publish->u.publish.loans );
+        }
+        else
+        {
+            IotLogError( "(MQTT connection %p) Incoming PUBLISH %p has already been released.",
+                         pMqttConnection,
+                         publish );
+
+            status = IOT_MQTT_BAD_PARAMETER;
+        }
+
+        IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotMqtt_ReleasePublish( IotMqttOperation_t publish )
+{
+    /* Only incoming PUBLISH messages may be released. */
+    IotMqtt_Assert( publish != NULL );
+    IotMqtt_Assert( publish->incomingPublish == true );
+
+    IotLogDebug( "(MQTT connection %p) Releasing incoming PUBLISH %p.",
+                 publish->pMqttConnection,
+                 publish );
+
+    _IotMqtt_ReleaseIncomingPublish( publish );
+}
+
+/*-----------------------------------------------------------*/
+
 const char * IotMqtt_strerror( IotMqttError_t status )
 {
     const char * pMessage = NULL;
@@ -45,6 +45,19 @@
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief The size of the buffer that small incoming packets other than PUBLISH
+ * are read into.
+ *
+ * These packets are processed before the receive callback returns, so they are
+ * read into a buffer on the receive callback's stack instead of an allocated
+ * one. This size covers a CONNACK, PUBACK, UNSUBACK, and a SUBACK for up to 30
+ * topic filters.
+ */
+#define MQTT_ACK_BUFFER_SIZE    ( 32 )
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Check if an incoming packet type is valid.
  *
@@ -60,12 +73,15 @@ static bool _incomingPacketValid( uint8_t packetType );
  * @param[in] pNetworkConnection Network connection to use for receive, which
  * may be different from the network connection associated with the MQTT connection.
  * @param[in] pMqttConnection The associated MQTT connection.
+ * @param[in] pAckBuffer A buffer of #MQTT_ACK_BUFFER_SIZE bytes for the remaining
+ * data of a packet that is not a PUBLISH. It must not be freed.
  * @param[out] pIncomingPacket Output parameter for the incoming packet.
  *
  * @return #IOT_MQTT_SUCCESS, #IOT_MQTT_NO_MEMORY or #IOT_MQTT_BAD_RESPONSE.
  */
 static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
                                           const _mqttConnection_t * pMqttConnection,
+                                          uint8_t * pAckBuffer,
                                           _mqttPacket_t * pIncomingPacket );
 
 /**
@@ -80,15 +96,6 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
 static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConnection,
                                                   _mqttPacket_t * pIncomingPacket );
 
-/**
- * @brief Send a PUBACK for a received QoS 1 PUBLISH packet.
- *
- * @param[in] pMqttConnection Which connection the PUBACK should be sent over.
- * @param[in] packetIdentifier Which packet identifier to include in PUBACK.
- */
-static void _sendPuback( _mqttConnection_t * pMqttConnection,
-                         uint16_t packetIdentifier );
-
 /*-----------------------------------------------------------*/
 
 static bool _incomingPacketValid( uint8_t packetType )
@@ -120,6 +127,7 @@ static bool _incomingPacketValid( uint8_t packetType )
 
 static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
                                           const _mqttConnection_t * pMqttConnection,
+                                          uint8_t * pAckBuffer,
                                           _mqttPacket_t * pIncomingPacket )
 {
     IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
@@ -194,10 +202,23 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
         EMPTY_ELSE_MARKER;
     }
 
-    /* Allocate a buffer for the remaining data and read the data. */
+    /* Allocate a buffer for the remaining data and read the data. Only a
+     * PUBLISH keeps its buffer after this receive callback, so other small
+     * packets do not need an allocated buffer. The network interface copies
+     * into a caller-provided buffer and cannot lend its own, so a PUBLISH is
+     * read into the receive pool, which only falls back to the heap for
+     * packets larger than its buffers or when all of them are in use. */
     if( pIncomingPacket->remainingLength > 0 )
     {
-        pIncomingPacket->pRemainingData = IotMqtt_MallocMessage( pIncomingPacket->remainingLength );
+        if( ( ( pIncomingPacket->type & 0xf0 ) != MQTT_PACKET_TYPE_PUBLISH ) &&
+            ( pIncomingPacket->remainingLength <= MQTT_ACK_BUFFER_SIZE ) )
+        {
+            pIncomingPacket->pRemainingData = pAckBuffer;
+        }
+        else
+        {
+            pIncomingPacket->pRemainingData = _IotMqtt_MallocReceiveBuffer( pIncomingPacket->remainingLength );
+        }
 
         if( pIncomingPacket->pRemainingData == NULL )
         {
@@ -231,9 +252,10 @@ static IotMqttError_t _getIncomingPacket( void * pNetworkConnection,
 
     if( status != IOT_MQTT_SUCCESS )
     {
-        if( pIncomingPacket->pRemainingData != NULL )
+        if( ( pIncomingPacket->pRemainingData != NULL ) &&
+            ( pIncomingPacket->pRemainingData != pAckBuffer ) )
         {
-            IotMqtt_FreeMessage( pIncomingPacket->pRemainingData );
+            _IotMqtt_FreeReceiveBuffer( pIncomingPacket->pRemainingData );
         }
         else
         {
@@ -315,7 +337,7 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
             IotLogDebug( "(MQTT connection %p) PUBLISH in data stream.", pMqttConnection );
 
             /* Allocate memory to handle the incoming PUBLISH. */
-            pOperation = IotMqtt_MallocOperation( sizeof( _mqttOperation_t ) );
+            pOperation = _IotMqtt_MallocOperation( sizeof( _mqttOperation_t ) );
 
             if( pOperation == NULL )
             {
@@ -362,7 +384,7 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
                 /* Send a PUBACK for QoS 1 PUBLISH. */
                 if( pOperation->u.publish.publishInfo.qos == IOT_MQTT_QOS_1 )
                 {
-                    _sendPuback( pMqttConnection, pIncomingPacket->packetIdentifier );
+                    _IotMqtt_EnqueuePuback( pMqttConnection, pIncomingPacket->packetIdentifier );
                 }
                 else
                 {
@@ -426,7 +448,7 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
                 IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
 
                 IotMqtt_Assert( pOperation != NULL );
-                IotMqtt_FreeOperation( pOperation );
+                _IotMqtt_FreeOperation( pOperation );
             }
             else
             {
@@ -634,97 +656,6 @@ static IotMqttError_t _deserializeIncomingPacket( _mqttConnection_t * pMqttConne
 
 /*-----------------------------------------------------------*/
 
-static void _sendPuback( _mqttConnection_t * pMqttConnection,
-                         uint16_t packetIdentifier )
-{
-    IotMqttError_t serializeStatus = IOT_MQTT_SUCCESS;
-    uint8_t * pPuback = NULL;
-    size_t pubackSize = 0, bytesSent = 0;
-
-    /* Default PUBACK serializer and free packet functions. */
-    IotMqttError_t ( * serializePuback )( uint16_t,
-                                          uint8_t **,
-                                          size_t * ) = _IotMqtt_SerializePuback;
-    void ( * freePacket )( uint8_t * ) = _IotMqtt_FreePacket;
-
-    IotLogDebug( "(MQTT connection %p) Sending PUBACK for received PUBLISH %hu.",
-                 pMqttConnection,
-                 packetIdentifier );
-
-    /* Choose PUBACK serializer and free packet functions. */
-    #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
-        if( pMqttConnection->pSerializer != NULL )
-        {
-            if( pMqttConnection->pSerializer->serialize.puback != NULL )
-            {
-                serializePuback = pMqttConnection->pSerializer->serialize.puback;
-            }
-            else
-            {
-                EMPTY_ELSE_MARKER;
-            }
-        }
-        else
-        {
-            EMPTY_ELSE_MARKER;
-        }
-    #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
-    #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
-        if( pMqttConnection->pSerializer != NULL )
-        {
-            if( pMqttConnection->pSerializer->freePacket != NULL )
-            {
-                freePacket = pMqttConnection->pSerializer->freePacket;
-            }
-            else
-            {
-                EMPTY_ELSE_MARKER;
-            }
-        }
-        else
-        {
-            EMPTY_ELSE_MARKER;
-        }
-    #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
-
-    /* Generate a PUBACK packet from the packet identifier. */
-    serializeStatus = serializePuback( packetIdentifier,
-                                       &pPuback,
-                                       &pubackSize );
-
-    if( serializeStatus != IOT_MQTT_SUCCESS )
-    {
-        IotLogWarn( "(MQTT connection %p) Failed to generate PUBACK packet for "
-                    "received PUBLISH %hu.",
-                    pMqttConnection,
-                    packetIdentifier );
-    }
-    else
-    {
-        bytesSent = pMqttConnection->pNetworkInterface->send( pMqttConnection->pNetworkConnection,
-                                                              pPuback,
-                                                              pubackSize );
-
-        if( bytesSent != pubackSize )
-        {
-            IotLogWarn( "(MQTT connection %p) Failed to send PUBACK for received"
-                        " PUBLISH %hu.",
-                        pMqttConnection,
-                        packetIdentifier );
-        }
-        else
-        {
-            IotLogDebug( "(MQTT connection %p) PUBACK for received PUBLISH %hu sent.",
-                         pMqttConnection,
-                         packetIdentifier );
-        }
-
-        freePacket( pPuback );
-    }
-}
-
-/*-----------------------------------------------------------*/
-
 bool _IotMqtt_GetNextByte( void * pNetworkConnection,
                            const IotNetworkInterface_t * pNetworkInterface,
                            uint8_t * pIncomingByte )
@@ -864,6 +795,7 @@ void IotMqtt_ReceiveCallback( void * pNetworkConnection,
 {
     IotMqttError_t status = IOT_MQTT_SUCCESS;
     _mqttPacket_t incomingPacket = { .u.pMqttConnection = NULL };
+    uint8_t pAckBuffer[ MQTT_ACK_BUFFER_SIZE ] = { 0 };
 
     /* Cast context to correct type. */
     _mqttConnection_t * pMqttConnection = ( _mqttConnection_t * ) pReceiveContext;
@@ -871,6 +803,7 @@ void IotMqtt_ReceiveCallback( void * pNetworkConnection,
     /* Read an MQTT packet from the network. */
     status = _getIncomingPacket( pNetworkConnection,
                                  pMqttConnection,
+                                 pAckBuffer,
                                  &incomingPacket );
 
     if( status == IOT_MQTT_SUCCESS )
@@ -880,9 +813,10 @@ void IotMqtt_ReceiveCallback( void * pNetworkConnection,
                                              &incomingPacket );
 
         /* Free any buffers allocated for the MQTT packet. */
-        if( incomingPacket.pRemainingData != NULL )
+        if( ( incomingPacket.pRemainingData != NULL ) &&
+            ( incomingPacket.pRemainingData != pAckBuffer ) )
         {
-            IotMqtt_FreeMessage( incomingPacket.pRemainingData );
+            _IotMqtt_FreeReceiveBuffer( incomingPacket.pRemainingData );
         }
         else
         {
@@ -44,6 +44,9 @@
 #include "platform/iot_clock.h"
 #include "platform/iot_threads.h"
 
+/* Atomics include. */
+#include "iot_atomic.h"
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -56,6 +59,17 @@ typedef struct _operationMatchParam
                                          * Set to `NULL` to ignore packet identifier. */
 } _operationMatchParam_t;
 
+/**
+ * @brief Packets copied into an MQTT connection's send buffer by the send queue
+ * writer, waiting to be sent together.
+ */
+typedef struct _sendRecord
+{
+    size_t length;             /**< @brief Number of bytes in #_mqttConnection_t.pSendBuffer. */
+    _mqttOperation_t * pFirst; /**< @brief First operation with a packet in the send buffer. */
+    _mqttOperation_t * pLast;  /**< @brief Last operation with a packet in the send buffer. */
+} _sendRecord_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -91,6 +105,162 @@ static bool _checkRetryLimit( _mqttOperation_t * pOperation );
  */
 static bool _scheduleNextRetry( _mqttOperation_t * pOperation );
 
+/**
+ * @brief Send the MQTT packet of an operation over the network.
+ *
+ * If the operation has a payload that was not copied into its packet, the
+ * packet and payload are sent together with the network interface's `sendv`.
+ *
+ * @param[in] pMqttConnection The MQTT connection of the operation.
+ * @param[in] pOperation The operation to send.
+ *
+ * @return The number of bytes sent.
+ */
+static size_t _sendPacket( _mqttConnection_t * pMqttConnection,
+                           const _mqttOperation_t * pOperation );
+
+/**
+ * @brief Calculate the bucket of a packet identifier in the in-flight table.
+ *
+ * @param[in] packetIdentifier The packet identifier to hash.
+ *
+ * @return A bucket of #_mqttConnection_t.inflight.
+ */
+static size_t _inflightBucket( uint16_t packetIdentifier );
+
+/**
+ * @brief Find the entry of an operation in the in-flight table by type and
+ * packet identifier.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the in-flight table.
+ * @param[in] type The operation type to look for.
+ * @param[in] packetIdentifier The packet identifier to find.
+ *
+ * @return The matching entry; `NULL` if no match was found.
+ */
+static _mqttInflight_t * _inflightFind( _mqttConnection_t * pMqttConnection,
+                                        IotMqttOperationType_t type,
+                                        uint16_t packetIdentifier );
+
+/**
+ * @brief Remove an entry from the in-flight table.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the in-flight table.
+ * @param[in] pEntry The entry to remove. Entries of a batch are freed.
+ */
+static void _inflightDelete( _mqttConnection_t * pMqttConnection,
+                             _mqttInflight_t * pEntry );
+
+/**
+ * @brief Remove all entries of an operation from the in-flight table.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the in-flight table.
+ * @param[in] pOperation The operation to remove.
+ *
+ * @return `true` if the operation had an entry in the table; `false` otherwise.
+ */
+static bool _inflightRemoveOperation( _mqttConnection_t * pMqttConnection,
+                                      _mqttOperation_t * pOperation );
+
+/**
+ * @brief Check an operation's retry limit before sending it.
+ *
+ * @param[in] pOperation The operation to send.
+ *
+ * @return `true` if the operation should be sent; `false` if it already has a
+ * status.
+ */
+static bool _prepareSend( _mqttOperation_t * pOperation );
+
+/**
+ * @brief Set the status of an operation after sending it, then transfer it to
+ * the pending response list, schedule its next retry, or notify of its
+ * completion.
+ *
+ * The operation may be destroyed by this function.
+ *
+ * @param[in] pOperation The operation that was sent.
+ * @param[in] sent Whether the operation's packet was sent. Ignored if the
+ * operation already has a status.
+ */
+static void _completeSend( _mqttOperation_t * pOperation,
+                           bool sent );
+
+/**
+ * @brief Start an MQTT connection's send queue writer if it is not running.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the send queue.
+ */
+static void _startSendQueue( _mqttConnection_t * pMqttConnection );
+
+/**
+ * @brief Send everything in an MQTT connection's send queue until it is empty,
+ * then stop the send queue writer.
+ *
+ * Releases the send queue writer's reference to the MQTT connection.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the send queue.
+ */
+static void _drainSendQueue( _mqttConnection_t * pMqttConnection );
+
+/**
+ * @brief Take all operations from an MQTT connection's send queue.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the send queue.
+ *
+ * @return The oldest operation taken, linked to the others in the order they
+ * were added; `NULL` if the send queue was empty.
+ */
+static _mqttOperation_t * _takeSendQueue( _mqttConnection_t * pMqttConnection );
+
+/**
+ * @brief Check if an MQTT connection has PUBACKs waiting to be sent.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the PUBACK queue.
+ *
+ * @return `true` if the PUBACK queue is not empty; `false` otherwise.
+ */
+static bool _pubackQueued( const _mqttConnection_t * pMqttConnection );
+
+/**
+ * @brief Send the queued PUBACKs and operations taken from an MQTT connection's
+ * send queue.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the send queue.
+ * @param[in] pOperations The oldest operation taken from the send queue.
+ */
+static void _sendQueued( _mqttConnection_t * pMqttConnection,
+                         _mqttOperation_t * pOperations );
+
+/**
+ * @brief Add the queued PUBACKs of an MQTT connection to its send buffer.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the PUBACK queue.
+ * @param[in] pRecord The packets in the send buffer.
+ */
+static void _appendPubacks( _mqttConnection_t * pMqttConnection,
+                            _sendRecord_t * pRecord );
+
+/**
+ * @brief Send a PUBACK for a received QoS 1 PUBLISH packet directly, outside
+ * the send queue.
+ *
+ * @param[in] pMqttConnection Which connection the PUBACK should be sent over.
+ * @param[in] packetIdentifier Which packet identifier to include in PUBACK.
+ */
+static void _sendPuback( _mqttConnection_t * pMqttConnection,
+                         uint16_t packetIdentifier );
+
+/**
+ * @brief Send an MQTT connection's send buffer, then complete the operations
+ * whose packets were in it.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the send buffer.
+ * @param[in] pRecord The packets in the send buffer. Emptied by this function.
+ */
+static void _flushSendRecord( _mqttConnection_t * pMqttConnection,
+                              _sendRecord_t * pRecord );
+
 /*-----------------------------------------------------------*/
 
 static bool _mqttOperation_match( const IotLink_t * pOperationLink,
@@ -133,7 +303,7 @@ static bool _mqttOperation_match( const IotLink_t * pOperationLink,
 static bool _checkRetryLimit( _mqttOperation_t * pOperation )
 {
     _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
-    bool status = true;
+    bool status = true, indexed = false;
 
     /* Choose a set DUP function. */
     void ( * publishSetDup )( uint8_t *,
@@ -175,28 +345,37 @@ static bool _checkRetryLimit( _mqttOperation_t * pOperation )
 
         status = false;
     }
-    /* Check if this is the first retry. */
-    else if( pOperation->u.operation.retry.count == 1 )
+    /* Set the DUP flag on the first retry. In AWS IoT MQTT mode, the DUP flag
+     * (really a change to the packet identifier) must be reset on every retry. */
+    else if( ( pOperation->u.operation.retry.count == 1 ) ||
+             ( pMqttConnection->awsIotMqttMode == true ) )
     {
-        /* Always set the DUP flag on the first retry. */
+        /* The packet identifier may change, so the PUBLISH must be indexed
+         * again in the in-flight table. */
+        IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+
+        indexed = _inflightRemoveOperation( pMqttConnection, pOperation );
+
         publishSetDup( pOperation->u.operation.pMqttPacket,
                        pOperation->u.operation.pPacketIdentifierHigh,
                        &( pOperation->u.operation.packetIdentifier ) );
-    }
-    else
-    {
-        /* In AWS IoT MQTT mode, the DUP flag (really a change to the packet
-         * identifier) must be reset on every retry. */
-        if( pMqttConnection->awsIotMqttMode == true )
+
+        if( indexed == true )
         {
-            publishSetDup( pOperation->u.operation.pMqttPacket,
-                           pOperation->u.operation.pPacketIdentifierHigh,
-                           &( pOperation->u.operation.packetIdentifier ) );
+            ( void ) _IotMqtt_InflightInsert( pMqttConnection,
+                                              pOperation->u.operation.packetIdentifier,
+                                              pOperation );
         }
         else
         {
             EMPTY_ELSE_MARKER;
         }
+
+        IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
     }
 
     return status;
@@ -288,6 +467,12 @@ static bool _scheduleNextRetry( _mqttOperation_t * pOperation )
             IotListDouble_Remove( &( pOperation->link ) );
             IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
                                       &( pOperation->link ) );
+            pOperation->u.operation.batchSent = true;
+
+            /* Index the PUBLISH by its packet identifier. */
+            ( void ) _IotMqtt_InflightInsert( pMqttConnection,
+                                              pOperation->u.operation.packetIdentifier,
+                                              pOperation );
         }
         else
         {
@@ -364,7 +549,7 @@ IotMqttError_t _IotMqtt_CreateOperation( _mqttConnection_t * pMqttConnection,
     }
 
     /* Allocate memory for a new operation. */
-    pOperation = IotMqtt_MallocOperation( sizeof( _mqttOperation_t ) );
+    pOperation = _IotMqtt_MallocOperation( sizeof( _mqttOperation_t ) );
 
     if( pOperation == NULL )
     {
@@ -445,7 +630,7 @@ IotMqttError_t _IotMqtt_CreateOperation( _mqttConnection_t * pMqttConnection,
 
         if( pOperation != NULL )
         {
-            IotMqtt_FreeOperation( pOperation );
+            _IotMqtt_FreeOperation( pOperation );
         }
         else
         {
@@ -462,6 +647,192 @@ IotMqttError_t _IotMqtt_CreateOperation( _mqttConnection_t * pMqttConnection,
 
 /*-----------------------------------------------------------*/
 
+static size_t _sendPacket( _mqttConnection_t * pMqttConnection,
+                           const _mqttOperation_t * pOperation )
+{
+    size_t bytesSent = 0;
+    IotNetworkIoVector_t pVectors[ 2 ] = { { 0 } };
+
+    if( pOperation->u.operation.pPayload == NULL )
+    {
+        bytesSent = pMqttConnection->pNetworkInterface->send( pMqttConnection->pNetworkConnection,
+                                                              pOperation->u.operation.pMqttPacket,
+                                                              pOperation->u.operation.packetSize );
+    }
+    else
+    {
+        /* Payloads are only left out of the packet if the network can send
+         * them together. */
+        IotMqtt_Assert( pMqttConnection->pNetworkInterface->sendv != NULL );
+
+        pVectors[ 0 ].pBuffer = pOperation->u.operation.pMqttPacket;
+        pVectors[ 0 ].length = pOperation->u.operation.packetSize;
+        pVectors[ 1 ].pBuffer = pOperation->u.operation.pPayload;
+        pVectors[ 1 ].length = pOperation->u.operation.payloadLength;
+
+        bytesSent = pMqttConnection->pNetworkInterface->sendv( pMqttConnection->pNetworkConnection,
+                                                               pVectors,
+                                                               2 );
+    }
+
+    return bytesSent;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t _inflightBucket( uint16_t packetIdentifier )
+{
+    /* Packet identifiers are generated in sequence, so consecutive identifiers
+     * fall in consecutive buckets. */
+    return ( size_t ) ( packetIdentifier % MQTT_INFLIGHT_BUCKETS );
+}
+
+/*-----------------------------------------------------------*/
+
+static _mqttInflight_t * _inflightFind( _mqttConnection_t * pMqttConnection,
+                                        IotMqttOperationType_t type,
+                                        uint16_t packetIdentifier )
+{
+    _mqttInflight_t * pEntry = NULL, * pResult = NULL;
+    IotLink_t * pLink = NULL;
+    IotListDouble_t * pBucket = &( pMqttConnection->inflight[ _inflightBucket( packetIdentifier ) ] );
+
+    IotContainers_ForEach( pBucket, pLink )
+    {
+        pEntry = IotLink_Container( _mqttInflight_t, pLink, link );
+
+        if( ( pEntry->packetIdentifier == packetIdentifier ) &&
+            ( pEntry->pOperation->u.operation.type == type ) )
+        {
+            pResult = pEntry;
+
+            break;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    return pResult;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _inflightDelete( _mqttConnection_t * pMqttConnection,
+                             _mqttInflight_t * pEntry )
+{
+    IotListDouble_Remove( &( pEntry->link ) );
+    pMqttConnection->inflightCount--;
+
+    /* Return an entry of a batch to the MQTT connection. */
+    if( pEntry->pOperation->u.operation.batchCount > 0 )
+    {
+        pEntry->packetIdentifier = 0;
+        pEntry->pOperation = NULL;
+        pMqttConnection->batchInflightCount--;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _inflightRemoveOperation( _mqttConnection_t * pMqttConnection,
+                                      _mqttOperation_t * pOperation )
+{
+    bool removed = false;
+    size_t i = 0;
+
+    if( pOperation->u.operation.batchCount > 0 )
+    {
+        removed = ( pOperation->u.operation.batchPending > 0 );
+
+        /* Every PUBACK a batch still awaits has exactly one entry. */
+        for( i = 0; ( i < IOT_MQTT_INFLIGHT_WINDOW ) &&
+             ( pOperation->u.operation.batchPending > 0 ); i++ )
+        {
+            if( pMqttConnection->batchInflight[ i ].pOperation == pOperation )
+            {
+                _inflightDelete( pMqttConnection, &( pMqttConnection->batchInflight[ i ] ) );
+                pOperation->u.operation.batchPending--;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+    }
+    else if( IotLink_IsLinked( &( pOperation->u.operation.inflight.link ) ) == true )
+    {
+        _inflightDelete( pMqttConnection, &( pOperation->u.operation.inflight ) );
+        removed = true;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return removed;
+}
+
+/*-----------------------------------------------------------*/
+
+bool _IotMqtt_InflightInsert( _mqttConnection_t * pMqttConnection,
+                              uint16_t packetIdentifier,
+                              _mqttOperation_t * pOperation )
+{
+    bool status = false;
+    size_t i = 0;
+    _mqttInflight_t * pEntry = NULL;
+
+    if( pOperation->u.operation.batchCount > 0 )
+    {
+        /* Take a free entry for a PUBACK of a batch. */
+        for( i = 0; i < IOT_MQTT_INFLIGHT_WINDOW; i++ )
+        {
+            if( pMqttConnection->batchInflight[ i ].pOperation == NULL )
+            {
+                pEntry = &( pMqttConnection->batchInflight[ i ] );
+                pMqttConnection->batchInflightCount++;
+
+                break;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+    }
+    else
+    {
+        /* Any other operation has at most one entry, which is its own. */
+        IotMqtt_Assert( IotLink_IsLinked( &( pOperation->u.operation.inflight.link ) ) == false );
+        pEntry = &( pOperation->u.operation.inflight );
+    }
+
+    if( pEntry != NULL )
+    {
+        pEntry->packetIdentifier = packetIdentifier;
+        pEntry->pOperation = pOperation;
+        IotListDouble_InsertHead( &( pMqttConnection->inflight[ _inflightBucket( packetIdentifier ) ] ),
+                                  &( pEntry->link ) );
+        pMqttConnection->inflightCount++;
+
+        status = true;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 bool _IotMqtt_DecrementOperationReferences( _mqttOperation_t * pOperation,
                                             bool cancelJob )
 {
@@ -472,9 +843,18 @@ bool _IotMqtt_DecrementOperationReferences( _mqttOperation_t * pOperation,
     /* Attempt to cancel the operation's job. */
     if( cancelJob == true )
     {
-        taskPoolStatus = IotTaskPool_TryCancel( IOT_SYSTEM_TASKPOOL,
-                                                pOperation->job,
-                                                NULL );
+        /* An operation in the send queue has no job. Like an executing job,
+         * it cannot be canceled. */
+        if( pOperation->job == NULL )
+        {
+            taskPoolStatus = IOT_TASKPOOL_CANCEL_FAILED;
+        }
+        else
+        {
+            taskPoolStatus = IotTaskPool_TryCancel( IOT_SYSTEM_TASKPOOL,
+                                                    pOperation->job,
+                                                    NULL );
+        }
 
         /* If the operation's job was not canceled, it must be already executing.
          * Any other return value is invalid. */
@@ -576,6 +956,10 @@ void _IotMqtt_DestroyOperation( _mqttOperation_t * pOperation )
                      pOperation );
     }
 
+    /* Remove any packet identifiers of this operation still in the in-flight
+     * table. */
+    ( void ) _inflightRemoveOperation( pMqttConnection, pOperation );
+
     IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
 
     /* Free any allocated MQTT packet. */
@@ -635,7 +1019,7 @@ void _IotMqtt_DestroyOperation( _mqttOperation_t * pOperation )
                  pOperation );
 
     /* Free the memory used to hold operation data. */
-    IotMqtt_FreeOperation( pOperation );
+    _IotMqtt_FreeOperation( pOperation );
 
     /* Decrement the MQTT connection's reference count after destroying an
      * operation. */
@@ -676,6 +1060,11 @@ void _IotMqtt_ProcessKeepAlive( IotTaskPool_t pTaskPool,
                                             &pKeepAliveJob );
     IotMqtt_Assert( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
 
+    taskPoolStatus = IotTaskPool_SetJobClass( pKeepAliveJob,
+                                              IOT_TASKPOOL_CLASS_CONTROL,
+                                              0 );
+    IotMqtt_Assert( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
+
     IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
 
     /* Determine whether to send a PINGREQ or check for PINGRESP. */
@@ -802,54 +1191,84 @@ void _IotMqtt_ProcessIncomingPublish( IotTaskPool_t pTaskPool,
         EMPTY_ELSE_MARKER;
     }
 
+    /* The subscription callbacks hold a loan on the PUBLISH while they run. This
+     * loan takes over the connection reference of the incoming PUBLISH job. */
+    IotMqtt_Assert( pOperation->u.publish.loans == 0 );
+    pOperation->u.publish.loans = 1;
+
     IotMutex_Unlock( &( pOperation->pMqttConnection->referencesMutex ) );
 
     /* Process the current PUBLISH. */
     callbackParam.u.message.info = pOperation->u.publish.publishInfo;
+    callbackParam.u.message.reference = pOperation;
 
     _IotMqtt_InvokeSubscriptionCallback( pOperation->pMqttConnection,
                                          &callbackParam );
 
-    /* Free any buffers associated with the current PUBLISH message. */
-    if( pOperation->u.publish.pReceivedData != NULL )
+    /* Release the loan of the subscription callbacks. The PUBLISH is freed
+     * here unless a callback retained it. */
+    _IotMqtt_ReleaseIncomingPublish( pOperation );
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_ReleaseIncomingPublish( _mqttOperation_t * pOperation )
+{
+    bool destroyPublish = false;
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+
+    IotMqtt_Assert( pOperation->incomingPublish == true );
+
+    /* Decrement the loan count. It must not be negative. */
+    IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+
+    ( pOperation->u.publish.loans )--;
+    IotMqtt_Assert( pOperation->u.publish.loans >= 0 );
+
+    if( pOperation->u.publish.loans == 0 )
+    {
+        destroyPublish = true;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+
+    if( destroyPublish == true )
     {
-        IotMqtt_FreeMessage( ( void * ) pOperation->u.publish.pReceivedData );
+        /* Free any buffers associated with the current PUBLISH message. */
+        if( pOperation->u.publish.pReceivedData != NULL )
+        {
+            _IotMqtt_FreeReceiveBuffer( ( void * ) pOperation->u.publish.pReceivedData );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        /* Free the incoming PUBLISH operation. */
+        _IotMqtt_FreeOperation( pOperation );
     }
     else
     {
         EMPTY_ELSE_MARKER;
     }
 
-    /* Free the incoming PUBLISH operation. */
-    IotMqtt_FreeOperation( pOperation );
+    /* Every loan holds a reference to the MQTT connection. */
+    _IotMqtt_DecrementConnectionReferences( pMqttConnection );
 }
 
 /*-----------------------------------------------------------*/
 
-void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
-                           IotTaskPoolJob_t pSendJob,
-                           void * pContext )
+static bool _prepareSend( _mqttOperation_t * pOperation )
 {
-    size_t bytesSent = 0;
-    bool destroyOperation = false, waitable = false, networkPending = false;
-    _mqttOperation_t * pOperation = ( _mqttOperation_t * ) pContext;
-    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
-
-    /* Check parameters. The task pool and job parameter is not used when asserts
-     * are disabled. */
-    ( void ) pTaskPool;
-    ( void ) pSendJob;
-    IotMqtt_Assert( pTaskPool == IOT_SYSTEM_TASKPOOL );
-    IotMqtt_Assert( pSendJob == pOperation->job );
-
     /* The given operation must have an allocated packet and be waiting for a status. */
     IotMqtt_Assert( pOperation->u.operation.pMqttPacket != NULL );
     IotMqtt_Assert( pOperation->u.operation.packetSize != 0 );
     IotMqtt_Assert( pOperation->u.operation.status == IOT_MQTT_STATUS_PENDING );
 
-    /* Check if this operation is waitable. */
-    waitable = ( pOperation->u.operation.flags & IOT_MQTT_FLAG_WAITABLE ) == IOT_MQTT_FLAG_WAITABLE;
-
     /* Check PUBLISH retry counts and limits. */
     if( pOperation->u.operation.retry.limit > 0 )
     {
@@ -867,21 +1286,24 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
         EMPTY_ELSE_MARKER;
     }
 
-    /* Send an operation that is waiting for a response. */
-    if( pOperation->u.operation.status == IOT_MQTT_STATUS_PENDING )
-    {
-        IotLogDebug( "(MQTT connection %p, %s operation %p) Sending MQTT packet.",
-                     pMqttConnection,
-                     IotMqtt_OperationType( pOperation->u.operation.type ),
-                     pOperation );
+    return( pOperation->u.operation.status == IOT_MQTT_STATUS_PENDING );
+}
 
-        /* Transmit the MQTT packet from the operation over the network. */
-        bytesSent = pMqttConnection->pNetworkInterface->send( pMqttConnection->pNetworkConnection,
-                                                              pOperation->u.operation.pMqttPacket,
-                                                              pOperation->u.operation.packetSize );
+/*-----------------------------------------------------------*/
 
-        /* Check transmission status. */
-        if( bytesSent != pOperation->u.operation.packetSize )
+static void _completeSend( _mqttOperation_t * pOperation,
+                           bool sent )
+{
+    bool destroyOperation = false, waitable = false, networkPending = false;
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+
+    /* Check if this operation is waitable. */
+    waitable = ( pOperation->u.operation.flags & IOT_MQTT_FLAG_WAITABLE ) == IOT_MQTT_FLAG_WAITABLE;
+
+    /* Check the transmission status of an operation that was sent. */
+    if( pOperation->u.operation.status == IOT_MQTT_STATUS_PENDING )
+    {
+        if( sent == false )
         {
             pOperation->u.operation.status = IOT_MQTT_NETWORK_ERROR;
         }
@@ -889,7 +1311,8 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
         {
             /* DISCONNECT operations are considered successful upon successful
              * transmission. In addition, non-waitable operations with no callback
-             * may also be considered successful. */
+             * may also be considered successful, unless they must be marked as
+             * acknowledged in the outbox. */
             if( pOperation->u.operation.type == IOT_MQTT_DISCONNECT )
             {
                 /* DISCONNECT operations are always waitable. */
@@ -899,7 +1322,8 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
             }
             else if( waitable == false )
             {
-                if( pOperation->u.operation.notify.callback.function == NULL )
+                if( ( pOperation->u.operation.notify.callback.function == NULL ) &&
+                    ( pOperation->u.operation.outboxSequence == 0 ) )
                 {
                     pOperation->u.operation.status = IOT_MQTT_SUCCESS;
                 }
@@ -955,18 +1379,60 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
             {
                 IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
 
-                /* Operation must be linked. */
-                IotMqtt_Assert( IotLink_IsLinked( &( pOperation->link ) ) );
+                if( IotLink_IsLinked( &( pOperation->link ) ) == false )
+                {
+                    /* An operation that is no longer linked was removed by a
+                     * disconnect while it waited in the send queue. */
+                    pOperation->u.operation.status = IOT_MQTT_NETWORK_ERROR;
+                }
+                else if( ( ( pOperation->u.operation.batchCount > 0 ) &&
+                           ( pOperation->u.operation.batchPending == 0 ) ) ||
+                         ( pOperation->u.operation.responded == true ) )
+                {
+                    /* A PUBLISH may have received all of its PUBACKs before it
+                     * could be transferred. Complete it here instead. */
+                    pOperation->u.operation.status = IOT_MQTT_SUCCESS;
 
-                /* Transfer to pending response list. */
-                IotListDouble_Remove( &( pOperation->link ) );
-                IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
-                                          &( pOperation->link ) );
+                    /* Increment job references of a waitable operation to prevent
+                     * Wait from destroying this operation if it times out, as
+                     * _IotMqtt_FindOperation would. */
+                    if( waitable == true )
+                    {
+                        ( pOperation->u.operation.jobReference )++;
+                    }
+                    else
+                    {
+                        EMPTY_ELSE_MARKER;
+                    }
+                }
+                else
+                {
+                    /* Transfer to pending response list. */
+                    IotListDouble_Remove( &( pOperation->link ) );
+                    IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
+                                              &( pOperation->link ) );
+                    pOperation->u.operation.batchSent = true;
+
+                    /* Index the operation by its packet identifier. A batch
+                     * and a PUBLISH without retries are already indexed. */
+                    if( ( pOperation->u.operation.packetIdentifier != 0 ) &&
+                        ( pOperation->u.operation.batchCount == 0 ) &&
+                        ( IotLink_IsLinked( &( pOperation->u.operation.inflight.link ) ) == false ) )
+                    {
+                        ( void ) _IotMqtt_InflightInsert( pMqttConnection,
+                                                          pOperation->u.operation.packetIdentifier,
+                                                          pOperation );
+                    }
+                    else
+                    {
+                        EMPTY_ELSE_MARKER;
+                    }
+
+                    /* This operation is now awaiting a response from the network. */
+                    networkPending = true;
+                }
 
                 IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
-
-                /* This operation is now awaiting a response from the network. */
-                networkPending = true;
             }
             else
             {
@@ -1009,6 +1475,585 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
 
 /*-----------------------------------------------------------*/
 
+void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
+                           IotTaskPoolJob_t pSendJob,
+                           void * pContext )
+{
+    bool sent = false;
+    _mqttOperation_t * pOperation = ( _mqttOperation_t * ) pContext;
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+
+    /* Check parameters. The task pool and job parameter is not used when asserts
+     * are disabled. */
+    ( void ) pTaskPool;
+    ( void ) pSendJob;
+    IotMqtt_Assert( pTaskPool == IOT_SYSTEM_TASKPOOL );
+    IotMqtt_Assert( pSendJob == pOperation->job );
+
+    /* Send an operation that is waiting for a response. */
+    if( _prepareSend( pOperation ) == true )
+    {
+        IotLogDebug( "(MQTT connection %p, %s operation %p) Sending MQTT packet.",
+                     pMqttConnection,
+                     IotMqtt_OperationType( pOperation->u.operation.type ),
+                     pOperation );
+
+        /* Transmit the MQTT packet from the operation over the network. */
+        sent = ( _sendPacket( pMqttConnection, pOperation ) ==
+                 ( pOperation->u.operation.packetSize + pOperation->u.operation.payloadLength ) );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    _completeSend( pOperation, sent );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _startSendQueue( _mqttConnection_t * pMqttConnection )
+{
+    IotTaskPoolError_t taskPoolStatus = IOT_TASKPOOL_SUCCESS;
+
+    /* Only one send queue writer runs at a time. */
+    if( Atomic_CompareAndSwap_u32( &( pMqttConnection->sendQueueActive ),
+                                   1,
+                                   0 ) == ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+    {
+        /* The writer holds a reference to the MQTT connection until it stops.
+         * The caller keeps the connection alive until then, so the reference
+         * is taken even if the connection was disconnected; the writer must
+         * still complete the queued operations. */
+        IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+        ( pMqttConnection->references )++;
+        IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+
+        /* Creating a new job should never fail when parameters are valid. */
+        taskPoolStatus = IotTaskPool_CreateJob( _IotMqtt_ProcessSendQueue,
+                                                pMqttConnection,
+                                                &( pMqttConnection->sendQueueJobStorage ),
+                                                &( pMqttConnection->sendQueueJob ) );
+        IotMqtt_Assert( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
+
+        /* The send queue carries acknowledgements, PINGREQs and SUBSCRIBEs as
+         * well as PUBLISH messages, so it is not queued behind bulk jobs. */
+        taskPoolStatus = IotTaskPool_SetJobClass( pMqttConnection->sendQueueJob,
+                                                  IOT_TASKPOOL_CLASS_CONTROL,
+                                                  0 );
+        IotMqtt_Assert( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
+
+        /* Keep the send queue jobs of one connection on the same task pool lane,
+         * so that unrelated connections do not contend on the same lane. */
+        taskPoolStatus = IotTaskPool_Schedule( IOT_SYSTEM_TASKPOOL,
+                                               pMqttConnection->sendQueueJob,
+                                               IOT_TASKPOOL_JOB_AFFINITY( ( uintptr_t ) pMqttConnection >> 4 ) );
+
+        if( taskPoolStatus != IOT_TASKPOOL_SUCCESS )
+        {
+            IotLogWarn( "(MQTT connection %p) Failed to schedule send queue job, error %s. "
+                        "Sending from the calling task.",
+                        pMqttConnection,
+                        IotTaskPool_strerror( taskPoolStatus ) );
+
+            _drainSendQueue( pMqttConnection );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _drainSendQueue( _mqttConnection_t * pMqttConnection )
+{
+    bool running = true;
+    _mqttOperation_t * pOperations = NULL;
+
+    while( running == true )
+    {
+        pOperations = _takeSendQueue( pMqttConnection );
+
+        if( ( pOperations != NULL ) || ( _pubackQueued( pMqttConnection ) == true ) )
+        {
+            _sendQueued( pMqttConnection, pOperations );
+        }
+        else
+        {
+            /* The send queue is empty. Stop the writer, then check for anything
+             * added before it stopped. Anything added after this check starts
+             * a new writer. */
+            ( void ) Atomic_CompareAndSwap_u32( &( pMqttConnection->sendQueueActive ),
+                                                0,
+                                                1 );
+
+            if( ( pMqttConnection->pSendQueue == NULL ) &&
+                ( _pubackQueued( pMqttConnection ) == false ) )
+            {
+                running = false;
+            }
+            else if( Atomic_CompareAndSwap_u32( &( pMqttConnection->sendQueueActive ),
+                                                1,
+                                                0 ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS )
+            {
+                /* Another writer was started. */
+                running = false;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+    }
+
+    /* Release the writer's reference to the MQTT connection. This may destroy
+     * the connection, so it must be the last use of it. */
+    _IotMqtt_DecrementConnectionReferences( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
+
+static _mqttOperation_t * _takeSendQueue( _mqttConnection_t * pMqttConnection )
+{
+    _mqttOperation_t * pNewest = NULL, * pOldest = NULL, * pNext = NULL;
+
+    pNewest = Atomic_SwapPointers_p32( ( void * volatile * ) &( pMqttConnection->pSendQueue ),
+                                       NULL );
+
+    /* The send queue is newest first. Reverse it so that operations are sent
+     * in the order they were added. */
+    while( pNewest != NULL )
+    {
+        pNext = pNewest->u.operation.pNextSend;
+        pNewest->u.operation.pNextSend = pOldest;
+        pOldest = pNewest;
+        pNewest = pNext;
+    }
+
+    return pOldest;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _pubackQueued( const _mqttConnection_t * pMqttConnection )
+{
+    return( pMqttConnection->pubackHead != pMqttConnection->pubackTail );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _sendQueued( _mqttConnection_t * pMqttConnection,
+                         _mqttOperation_t * pOperations )
+{
+    bool coalesce = false;
+    size_t packetLength = 0;
+    _sendRecord_t record = { 0 };
+    _mqttOperation_t * pOperation = pOperations, * pNext = NULL;
+
+    /* Send PUBACKs first, since the server may be waiting for them. */
+    _appendPubacks( pMqttConnection, &record );
+
+    while( pOperation != NULL )
+    {
+        /* Sending an operation may destroy it, so read its successor first. */
+        pNext = pOperation->u.operation.pNextSend;
+        pOperation->u.operation.pNextSend = NULL;
+
+        if( _prepareSend( pOperation ) == true )
+        {
+            packetLength = pOperation->u.operation.packetSize +
+                           pOperation->u.operation.payloadLength;
+
+            /* Only small packets are copied into the send buffer. A payload
+             * that was not copied into its packet is not copied here either. */
+            coalesce = ( ( pOperation->u.operation.pPayload == NULL ) &&
+                         ( packetLength <= IOT_MQTT_SEND_COALESCE_SIZE ) );
+
+            /* Send the buffered packets first if this packet will not be
+             * buffered after them. */
+            if( ( coalesce == false ) ||
+                ( packetLength > ( IOT_MQTT_SEND_COALESCE_SIZE - record.length ) ) )
+            {
+                _flushSendRecord( pMqttConnection, &record );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            if( coalesce == true )
+            {
+                /* The operation is completed when the send buffer is sent. */
+                ( void ) memcpy( pMqttConnection->pSendBuffer + record.length,
+                                 pOperation->u.operation.pMqttPacket,
+                                 packetLength );
+                record.length += packetLength;
+
+                if( record.pLast == NULL )
+                {
+                    record.pFirst = pOperation;
+                }
+                else
+                {
+                    record.pLast->u.operation.pNextSend = pOperation;
+                }
+
+                record.pLast = pOperation;
+            }
+            else
+            {
+                IotLogDebug( "(MQTT connection %p, %s operation %p) Sending MQTT packet.",
+                             pMqttConnection,
+                             IotMqtt_OperationType( pOperation->u.operation.type ),
+                             pOperation );
+
+                /* Send this packet directly. */
+                _completeSend( pOperation,
+                               ( _sendPacket( pMqttConnection, pOperation ) == packetLength ) );
+            }
+        }
+        else
+        {
+            /* The operation already has a status. */
+            _completeSend( pOperation, false );
+        }
+
+        pOperation = pNext;
+    }
+
+    _flushSendRecord( pMqttConnection, &record );
+}
+
+/*-----------------------------------------------------------*/
+
+static void _appendPubacks( _mqttConnection_t * pMqttConnection,
+                            _sendRecord_t * pRecord )
+{
+    IotMqttError_t serializeStatus = IOT_MQTT_SUCCESS;
+    uint16_t packetIdentifier = 0;
+    uint8_t * pPuback = NULL;
+    size_t pubackSize = 0, bytesSent = 0;
+
+    /* Default PUBACK serializer and free packet functions. */
+    IotMqttError_t ( * serializePuback )( uint16_t,
+                                          uint8_t **,
+                                          size_t * ) = _IotMqtt_SerializePuback;
+    void ( * freePacket )( uint8_t * ) = _IotMqtt_FreePacket;
+
+    /* Choose PUBACK serializer and free packet functions. */
+    #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
+        if( pMqttConnection->pSerializer != NULL )
+        {
+            if( pMqttConnection->pSerializer->serialize.puback != NULL )
+            {
+                serializePuback = pMqttConnection->pSerializer->serialize.puback;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            if( pMqttConnection->pSerializer->freePacket != NULL )
+            {
+                freePacket = pMqttConnection->pSerializer->freePacket;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
+
+    while( _pubackQueued( pMqttConnection ) == true )
+    {
+        packetIdentifier = pMqttConnection->pubackQueue[ pMqttConnection->pubackHead %
+                                                         MQTT_PUBACK_QUEUE_SIZE ];
+
+        /* Return the slot to the network receive callback. */
+        ( void ) Atomic_Increment_u32( &( pMqttConnection->pubackHead ) );
+
+        /* Generate a PUBACK packet from the packet identifier. */
+        serializeStatus = serializePuback( packetIdentifier,
+                                           &pPuback,
+                                           &pubackSize );
+
+        if( serializeStatus != IOT_MQTT_SUCCESS )
+        {
+            IotLogWarn( "(MQTT connection %p) Failed to generate PUBACK packet for "
+                        "received PUBLISH %hu.",
+                        pMqttConnection,
+                        packetIdentifier );
+        }
+        else
+        {
+            if( pubackSize > ( IOT_MQTT_SEND_COALESCE_SIZE - pRecord->length ) )
+            {
+                _flushSendRecord( pMqttConnection, pRecord );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            if( pubackSize <= IOT_MQTT_SEND_COALESCE_SIZE )
+            {
+                ( void ) memcpy( pMqttConnection->pSendBuffer + pRecord->length,
+                                 pPuback,
+                                 pubackSize );
+                pRecord->length += pubackSize;
+            }
+            else
+            {
+                bytesSent = pMqttConnection->pNetworkInterface->send( pMqttConnection->pNetworkConnection,
+                                                                      pPuback,
+                                                                      pubackSize );
+
+                if( bytesSent != pubackSize )
+                {
+                    IotLogWarn( "(MQTT connection %p) Failed to send PUBACK for received"
+                                " PUBLISH %hu.",
+                                pMqttConnection,
+                                packetIdentifier );
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+
+            freePacket( pPuback );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _sendPuback( _mqttConnection_t * pMqttConnection,
+                         uint16_t packetIdentifier )
+{
+    IotMqttError_t serializeStatus = IOT_MQTT_SUCCESS;
+    uint8_t * pPuback = NULL;
+    size_t pubackSize = 0, bytesSent = 0;
+
+    /* Default PUBACK serializer and free packet functions. */
+    IotMqttError_t ( * serializePuback )( uint16_t,
+                                          uint8_t **,
+                                          size_t * ) = _IotMqtt_SerializePuback;
+    void ( * freePacket )( uint8_t * ) = _IotMqtt_FreePacket;
+
+    IotLogDebug( "(MQTT connection %p) Sending PUBACK for received PUBLISH %hu.",
+                 pMqttConnection,
+                 packetIdentifier );
+
+    /* Choose PUBACK serializer and free packet functions. */
+    #if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1
+        if( pMqttConnection->pSerializer != NULL )
+        {
+            if( pMqttConnection->pSerializer->serialize.puback != NULL )
+            {
+                serializePuback = pMqttConnection->pSerializer->serialize.puback;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            if( pMqttConnection->pSerializer->freePacket != NULL )
+            {
+                freePacket = pMqttConnection->pSerializer->freePacket;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    #endif /* if IOT_MQTT_ENABLE_SERIALIZER_OVERRIDES == 1 */
+
+    /* Generate a PUBACK packet from the packet identifier. */
+    serializeStatus = serializePuback( packetIdentifier,
+                                       &pPuback,
+                                       &pubackSize );
+
+    if( serializeStatus != IOT_MQTT_SUCCESS )
+    {
+        IotLogWarn( "(MQTT connection %p) Failed to generate PUBACK packet for "
+                    "received PUBLISH %hu.",
+                    pMqttConnection,
+                    packetIdentifier );
+    }
+    else
+    {
+        bytesSent = pMqttConnection->pNetworkInterface->send( pMqttConnection->pNetworkConnection,
+                                                              pPuback,
+                                                              pubackSize );
+
+        if( bytesSent != pubackSize )
+        {
+            IotLogWarn( "(MQTT connection %p) Failed to send PUBACK for received"
+                        " PUBLISH %hu.",
+                        pMqttConnection,
+                        packetIdentifier );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        freePacket( pPuback );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _flushSendRecord( _mqttConnection_t * pMqttConnection,
+                              _sendRecord_t * pRecord )
+{
+    bool sent = true;
+    _mqttOperation_t * pOperation = pRecord->pFirst, * pNext = NULL;
+
+    if( pRecord->length > 0 )
+    {
+        IotLogDebug( "(MQTT connection %p) Sending %lu bytes of queued MQTT packets.",
+                     pMqttConnection,
+                     ( unsigned long ) pRecord->length );
+
+        sent = ( pMqttConnection->pNetworkInterface->send( pMqttConnection->pNetworkConnection,
+                                                           pMqttConnection->pSendBuffer,
+                                                           pRecord->length ) == pRecord->length );
+
+        if( sent == false )
+        {
+            IotLogWarn( "(MQTT connection %p) Failed to send queued MQTT packets.",
+                        pMqttConnection );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Complete the operations whose packets were in the send buffer. */
+    while( pOperation != NULL )
+    {
+        pNext = pOperation->u.operation.pNextSend;
+        pOperation->u.operation.pNextSend = NULL;
+
+        _completeSend( pOperation, sent );
+
+        pOperation = pNext;
+    }
+
+    pRecord->length = 0;
+    pRecord->pFirst = NULL;
+    pRecord->pLast = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_ProcessSendQueue( IotTaskPool_t pTaskPool,
+                                IotTaskPoolJob_t pSendQueueJob,
+                                void * pContext )
+{
+    _mqttConnection_t * pMqttConnection = ( _mqttConnection_t * ) pContext;
+
+    /* Check parameters. The task pool and job parameter is not used when asserts
+     * are disabled. */
+    ( void ) pTaskPool;
+    ( void ) pSendQueueJob;
+    IotMqtt_Assert( pTaskPool == IOT_SYSTEM_TASKPOOL );
+    IotMqtt_Assert( pSendQueueJob == pMqttConnection->sendQueueJob );
+
+    _drainSendQueue( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_EnqueueSend( _mqttOperation_t * pOperation )
+{
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+    _mqttOperation_t * pNewest = NULL;
+
+    /* The operation may be sent and destroyed as soon as it is added, so log
+     * before adding it. */
+    IotLogDebug( "(MQTT connection %p, %s operation %p) Adding operation to send queue.",
+                 pMqttConnection,
+                 IotMqtt_OperationType( pOperation->u.operation.type ),
+                 pOperation );
+
+    /* Push the operation onto the send queue. */
+    do
+    {
+        pNewest = pMqttConnection->pSendQueue;
+        pOperation->u.operation.pNextSend = pNewest;
+    } while( Atomic_CompareAndSwapPointers_p32( ( void * volatile * ) &( pMqttConnection->pSendQueue ),
+                                                pOperation,
+                                                pNewest ) != ATOMIC_COMPARE_AND_SWAP_SUCCESS );
+
+    _startSendQueue( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_EnqueuePuback( _mqttConnection_t * pMqttConnection,
+                             uint16_t packetIdentifier )
+{
+    bool disconnected = false;
+    uint32_t tail = pMqttConnection->pubackTail;
+
+    /* Only this function moves the tail, so the PUBACK queue cannot fill
+     * between this check and adding the PUBACK. */
+    if( ( tail - pMqttConnection->pubackHead ) < MQTT_PUBACK_QUEUE_SIZE )
+    {
+        pMqttConnection->pubackQueue[ tail % MQTT_PUBACK_QUEUE_SIZE ] = packetIdentifier;
+
+        /* Make the PUBACK visible to the send queue writer. */
+        ( void ) Atomic_Increment_u32( &( pMqttConnection->pubackTail ) );
+
+        _startSendQueue( pMqttConnection );
+    }
+    else
+    {
+        /* The send queue writer may be waiting for a task pool worker that
+         * will not run until this receive callback returns, so do not wait
+         * for room. Send the PUBACK directly, ahead of the queued ones. */
+        IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+        disconnected = pMqttConnection->disconnected;
+        IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+
+        if( disconnected == false )
+        {
+            _sendPuback( pMqttConnection, packetIdentifier );
+        }
+        else
+        {
+            IotLogWarn( "(MQTT connection %p) Connection is disconnected; dropping "
+                        "PUBACK for received PUBLISH %hu.",
+                        pMqttConnection,
+                        packetIdentifier );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 void _IotMqtt_ProcessCompletedOperation( IotTaskPool_t pTaskPool,
                                          IotTaskPoolJob_t pOperationJob,
                                          void * pContext )
@@ -1055,6 +2100,7 @@ IotMqttError_t _IotMqtt_ScheduleOperation( _mqttOperation_t * pOperation,
 {
     IotMqttError_t status = IOT_MQTT_SUCCESS;
     IotTaskPoolError_t taskPoolStatus = IOT_TASKPOOL_SUCCESS;
+    IotTaskPoolJobClass_t jobClass = IOT_TASKPOOL_CLASS_DEFAULT;
 
     /* Check that job routine is valid. */
     IotMqtt_Assert( ( jobRoutine == _IotMqtt_ProcessSend ) ||
@@ -1068,6 +2114,35 @@ IotMqttError_t _IotMqtt_ScheduleOperation( _mqttOperation_t * pOperation,
                                             &( pOperation->job ) );
     IotMqtt_Assert( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
 
+    /* Completed operations wake up waiting tasks and invoke acknowledgement
+     * callbacks, so they are not queued behind bulk jobs. Incoming PUBLISH
+     * messages and PUBLISH retransmissions are the bulk of the work. */
+    if( jobRoutine == _IotMqtt_ProcessCompletedOperation )
+    {
+        jobClass = IOT_TASKPOOL_CLASS_CONTROL;
+    }
+    else if( ( jobRoutine == _IotMqtt_ProcessIncomingPublish ) ||
+             ( pOperation->u.operation.type == IOT_MQTT_PUBLISH_TO_SERVER ) )
+    {
+        jobClass = IOT_TASKPOOL_CLASS_BULK;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( jobClass != IOT_TASKPOOL_CLASS_DEFAULT )
+    {
+        taskPoolStatus = IotTaskPool_SetJobClass( pOperation->job,
+                                                  jobClass,
+                                                  0 );
+        IotMqtt_Assert( taskPoolStatus == IOT_TASKPOOL_SUCCESS );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Schedule the new job with a delay. */
     taskPoolStatus = IotTaskPool_ScheduleDeferred( IOT_SYSTEM_TASKPOOL,
                                                    pOperation->job,
@@ -1102,6 +2177,7 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                                            const uint16_t * pPacketIdentifier )
 {
     bool waitable = false;
+    _mqttInflight_t * pEntry = NULL;
     IotTaskPoolError_t taskPoolStatus = IOT_TASKPOOL_SUCCESS;
     _mqttOperation_t * pResult = NULL;
     IotLink_t * pResultLink = NULL;
@@ -1122,12 +2198,90 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                      IotMqtt_OperationType( type ) );
     }
 
-    /* Find and remove the first matching element in the list. */
     IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
-    pResultLink = IotListDouble_FindFirstMatch( &( pMqttConnection->pendingResponse ),
-                                                NULL,
-                                                _mqttOperation_match,
-                                                &param );
+
+    /* Operations with a packet identifier are found in the in-flight table. */
+    if( pPacketIdentifier != NULL )
+    {
+        pEntry = _inflightFind( pMqttConnection, type, *pPacketIdentifier );
+
+        if( pEntry != NULL )
+        {
+            pResult = pEntry->pOperation;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( pResult != NULL )
+    {
+        if( pResult->u.operation.batchCount > 0 )
+        {
+            /* Every PUBACK of a batch has its own entry. */
+            _inflightDelete( pMqttConnection, pEntry );
+            pResult->u.operation.batchPending--;
+
+            /* A batch completes with its last PUBACK, but only once it is in the
+             * pending response list. Otherwise, its send job completes it. */
+            if( ( pResult->u.operation.batchPending == 0 ) &&
+                ( pResult->u.operation.batchSent == true ) &&
+                ( IotLink_IsLinked( &( pResult->link ) ) == true ) )
+            {
+                pResultLink = &( pResult->link );
+            }
+            else
+            {
+                IotLogDebug( "(MQTT connection %p, %s operation %p) PUBLISH batch awaits "
+                             "%lu more PUBACKs.",
+                             pMqttConnection,
+                             IotMqtt_OperationType( type ),
+                             pResult,
+                             ( unsigned long ) pResult->u.operation.batchPending );
+            }
+        }
+        else if( pResult->u.operation.batchSent == false )
+        {
+            /* A PUBLISH without retries is indexed before it is sent, so its
+             * PUBACK may arrive before its send job moves it to the pending
+             * response list. Its send job completes it instead. */
+            _inflightDelete( pMqttConnection, pEntry );
+            pResult->u.operation.responded = true;
+        }
+        else
+        {
+            /* An operation removed from the lists by a disconnect may linger in
+             * the table until it is destroyed. */
+            if( IotLink_IsLinked( &( pResult->link ) ) == true )
+            {
+                pResultLink = &( pResult->link );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+
+        pResult = NULL;
+    }
+    else if( pPacketIdentifier == NULL )
+    {
+        /* CONNECT has no packet identifier and is found by searching the list,
+         * which holds no other operations while a connection is established. */
+        pResultLink = IotListDouble_FindFirstMatch( &( pMqttConnection->pendingResponse ),
+                                                    NULL,
+                                                    _mqttOperation_match,
+                                                    &param );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
 
     /* Check if a match was found. */
     if( pResultLink != NULL )
@@ -1189,8 +2343,9 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                      pMqttConnection,
                      IotMqtt_OperationType( type ) );
 
-        /* Remove the matched operation from the list. */
+        /* Remove the matched operation from the list and the in-flight table. */
         IotListDouble_Remove( &( pResult->link ) );
+        ( void ) _inflightRemoveOperation( pMqttConnection, pResult );
     }
     else
     {
@@ -1214,6 +2369,18 @@ void _IotMqtt_Notify( _mqttOperation_t * pOperation )
     /* Check if operation is waitable. */
     bool waitable = ( pOperation->u.operation.flags & IOT_MQTT_FLAG_WAITABLE ) == IOT_MQTT_FLAG_WAITABLE;
 
+    /* Mark an acknowledged PUBLISH in the outbox. A PUBLISH that failed stays
+     * in the outbox to be sent on the next connection. */
+    if( ( pOperation->u.operation.outboxSequence != 0 ) &&
+        ( pOperation->u.operation.status == IOT_MQTT_SUCCESS ) )
+    {
+        _IotMqtt_OutboxAck( pOperation );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Remove any lingering subscriptions if a SUBSCRIBE failed. Rejected
      * subscriptions are removed by the deserializer, so not removed here. */
     if( pOperation->u.operation.type == IOT_MQTT_SUBSCRIBE )
@@ -0,0 +1,1190 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/**
+ * @file iot_mqtt_outbox.c
+ * @brief Implements the persistent outbox of QoS 1 PUBLISH messages.
+ *
+ * The outbox is a log of records. A PUT record holds a serialized PUBLISH and
+ * an ACK record marks the PUT with the same sequence number as acknowledged.
+ * Every record is:
+ * - 1 byte: record type.
+ * - 4 bytes: sequence number, big endian.
+ * - 4 bytes: data length, big endian.
+ * - Data.
+ * - 4 bytes: CRC-32 of all of the above, big endian.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* Error handling include. */
+#include "private/iot_error.h"
+
+/* MQTT internal include. */
+#include "private/iot_mqtt_internal.h"
+
+/* Platform layer includes. */
+#include "platform/iot_threads.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Outbox record types.
+ */
+#define OUTBOX_RECORD_PUT     ( ( uint8_t ) 0x01U ) /**< @brief A persisted PUBLISH. */
+#define OUTBOX_RECORD_ACK     ( ( uint8_t ) 0x02U ) /**< @brief An acknowledged PUBLISH. */
+
+/**
+ * @brief Size of the type, sequence number, and length of a record.
+ */
+#define OUTBOX_HEADER_SIZE    ( 9 )
+
+/**
+ * @brief Size of the CRC at the end of a record.
+ */
+#define OUTBOX_CRC_SIZE       ( 4 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The result of reading a record.
+ */
+typedef enum _outboxRead
+{
+    OUTBOX_READ_VALID,     /**< @brief A record was read and its CRC matched. */
+    OUTBOX_READ_END,       /**< @brief The end of the segment was reached. */
+    OUTBOX_READ_CORRUPT,   /**< @brief A record was incomplete or its CRC did not match. */
+    OUTBOX_READ_NO_MEMORY  /**< @brief The data of a record could not be allocated. */
+} _outboxRead_t;
+
+/**
+ * @brief State kept while an outbox is read by #_IotMqtt_OutboxOpen.
+ */
+typedef struct _outboxScan
+{
+    uint32_t firstSequence;               /**< @brief Lowest sequence number of a PUT; `0` if none. */
+    uint32_t lastSequence;                /**< @brief Highest sequence number of any record. */
+    uint8_t * pUnacked;                   /**< @brief One bit per sequence number from #_outboxScan_t.firstSequence; set if unacknowledged. */
+    _mqttOperation_t * pReplayTail;       /**< @brief The newest operation to replay. */
+    size_t replayCount;                   /**< @brief Number of operations to replay. */
+    size_t lastSegmentSize;               /**< @brief Bytes of valid records in the last segment. */
+    bool lastSegmentCorrupt;              /**< @brief Whether the last segment ends with a damaged record. */
+} _outboxScan_t;
+
+/**
+ * @brief Called by #_scanOutbox for every valid record.
+ *
+ * May take ownership of the record data by setting `*ppData` to `NULL`.
+ */
+typedef IotMqttError_t ( * _outboxVisitor_t )( _mqttConnection_t * pMqttConnection,
+                                               _outboxScan_t * pScan,
+                                               uint32_t segment,
+                                               uint8_t type,
+                                               uint32_t sequence,
+                                               uint8_t ** ppData,
+                                               size_t length );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Calculate a CRC-32 (IEEE 802.3).
+ *
+ * @param[in] crc The CRC of any preceding data; `0` to start.
+ * @param[in] pData The data.
+ * @param[in] length Length of `pData`.
+ *
+ * @return The CRC of the preceding data and `pData`.
+ */
+static uint32_t _crc32( uint32_t crc,
+                        const uint8_t * pData,
+                        size_t length );
+
+/**
+ * @brief Write a 4-byte big endian value.
+ *
+ * @param[out] pBuffer Where to write the value.
+ * @param[in] value The value to write.
+ */
+static void _encodeUint32( uint8_t * pBuffer,
+                           uint32_t value );
+
+/**
+ * @brief Read a 4-byte big endian value.
+ *
+ * @param[in] pBuffer The value to read.
+ *
+ * @return The value.
+ */
+static uint32_t _decodeUint32( const uint8_t * pBuffer );
+
+/**
+ * @brief Write the header and CRC of a record around its data.
+ *
+ * @param[in,out] pRecord A buffer of `length` + #MQTT_OUTBOX_RECORD_OVERHEAD bytes
+ * with the record data at offset #OUTBOX_HEADER_SIZE.
+ * @param[in] type The record type.
+ * @param[in] sequence The sequence number of the record.
+ * @param[in] length Length of the record data.
+ */
+static void _encodeRecord( uint8_t * pRecord,
+                           uint8_t type,
+                           uint32_t sequence,
+                           size_t length );
+
+/**
+ * @brief Read a record from a segment.
+ *
+ * @param[in] pOutbox The outbox to read.
+ * @param[in] segment The segment to read.
+ * @param[in] offset The offset of the record in the segment.
+ * @param[out] pType Set to the record type.
+ * @param[out] pSequence Set to the sequence number of the record.
+ * @param[out] ppData Set to the record data, allocated with #IotMqtt_MallocMessage;
+ * `NULL` if the record has no data.
+ * @param[out] pLength Set to the length of the record data.
+ *
+ * @return Whether a record was read.
+ */
+static _outboxRead_t _readRecord( const _mqttOutbox_t * pOutbox,
+                                  uint32_t segment,
+                                  size_t offset,
+                                  uint8_t * pType,
+                                  uint32_t * pSequence,
+                                  uint8_t ** ppData,
+                                  size_t * pLength );
+
+/**
+ * @brief Read every valid record of every segment in an outbox, oldest first.
+ *
+ * The records of a segment after a damaged record are ignored.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the outbox.
+ * @param[in] pScan State passed to `visitor`.
+ * @param[in] visitor Called for every valid record.
+ *
+ * @return #IOT_MQTT_SUCCESS, #IOT_MQTT_NO_MEMORY, or the first error returned
+ * by `visitor`.
+ */
+static IotMqttError_t _scanOutbox( _mqttConnection_t * pMqttConnection,
+                                   _outboxScan_t * pScan,
+                                   _outboxVisitor_t visitor );
+
+/**
+ * @brief Find the range of sequence numbers in an outbox.
+ *
+ * See #_outboxVisitor_t for a description of the parameters.
+ */
+static IotMqttError_t _findSequences( _mqttConnection_t * pMqttConnection,
+                                      _outboxScan_t * pScan,
+                                      uint32_t segment,
+                                      uint8_t type,
+                                      uint32_t sequence,
+                                      uint8_t ** ppData,
+                                      size_t length );
+
+/**
+ * @brief Find the unacknowledged PUBLISH messages in an outbox.
+ *
+ * See #_outboxVisitor_t for a description of the parameters.
+ */
+static IotMqttError_t _findUnacked( _mqttConnection_t * pMqttConnection,
+                                    _outboxScan_t * pScan,
+                                    uint32_t segment,
+                                    uint8_t type,
+                                    uint32_t sequence,
+                                    uint8_t ** ppData,
+                                    size_t length );
+
+/**
+ * @brief Create an operation for every unacknowledged PUBLISH in an outbox.
+ *
+ * See #_outboxVisitor_t for a description of the parameters.
+ */
+static IotMqttError_t _createReplay( _mqttConnection_t * pMqttConnection,
+                                     _outboxScan_t * pScan,
+                                     uint32_t segment,
+                                     uint8_t type,
+                                     uint32_t sequence,
+                                     uint8_t ** ppData,
+                                     size_t length );
+
+/**
+ * @brief Find the high byte of the packet identifier in a serialized QoS 1
+ * PUBLISH.
+ *
+ * @param[in] pPacket The serialized PUBLISH.
+ * @param[in] packetSize Size of `pPacket`.
+ *
+ * @return Pointer to the high byte of the packet identifier; `NULL` if
+ * `pPacket` is not a QoS 1 PUBLISH.
+ */
+static uint8_t * _publishIdentifierHigh( uint8_t * pPacket,
+                                         size_t packetSize );
+
+/**
+ * @brief Remove the oldest segments of an outbox while they have no
+ * unacknowledged PUBLISH messages. The last segment is never removed.
+ *
+ * The outbox mutex must be locked by the caller.
+ *
+ * @param[in] pOutbox The outbox to compact.
+ */
+static void _compact( _mqttOutbox_t * pOutbox );
+
+/**
+ * @brief Make room for a record in the last segment of an outbox, starting a
+ * new segment if necessary.
+ *
+ * The outbox mutex must be locked by the caller.
+ *
+ * @param[in] pOutbox The outbox to append to.
+ * @param[in] recordSize Size of the record to append.
+ *
+ * @return `true` if the record may be appended to the last segment; `false` if
+ * the outbox is full.
+ */
+static bool _reserve( _mqttOutbox_t * pOutbox,
+                      size_t recordSize );
+
+/*-----------------------------------------------------------*/
+
+static uint32_t _crc32( uint32_t crc,
+                        const uint8_t * pData,
+                        size_t length )
+{
+    size_t i = 0;
+
+    /* CRCs of every 4-bit value with the reflected polynomial 0xedb88320. */
+    static const uint32_t pTable[ 16 ] =
+    {
+        0x00000000UL, 0x1db71064UL, 0x3b6e20c8UL, 0x26d930acUL,
+        0x76dc4190UL, 0x6b6b51f4UL, 0x4db26158UL, 0x5005713cUL,
+        0xedb88320UL, 0xf00f9344UL, 0xd6d6a3e8UL, 0xcb61b38cUL,
+        0x9b64c2b0UL, 0x86d3d2d4UL, 0xa00ae278UL, 0xbdbdf21cUL
+    };
+
+    crc = ~crc;
+
+    for( i = 0; i < length; i++ )
+    {
+        crc = pTable[ ( crc ^ pData[ i ] ) & 0x0fU ] ^ ( crc >> 4 );
+        crc = pTable[ ( crc ^ ( ( uint32_t ) pData[ i ] >> 4 ) ) & 0x0fU ] ^ ( crc >> 4 );
+    }
+
+    return ~crc;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _encodeUint32( uint8_t * pBuffer,
+                           uint32_t value )
+{
+    pBuffer[ 0 ] = ( uint8_t ) ( value >> 24 );
+    pBuffer[ 1 ] = ( uint8_t ) ( value >> 16 );
+    pBuffer[ 2 ] = ( uint8_t ) ( value >> 8 );
+    pBuffer[ 3 ] = ( uint8_t ) value;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t _decodeUint32( const uint8_t * pBuffer )
+{
+    return ( ( uint32_t ) pBuffer[ 0 ] << 24 ) |
+           ( ( uint32_t ) pBuffer[ 1 ] << 16 ) |
+           ( ( uint32_t ) pBuffer[ 2 ] << 8 ) |
+           ( uint32_t ) pBuffer[ 3 ];
+}
+
+/*-----------------------------------------------------------*/
+
+static void _encodeRecord( uint8_t * pRecord,
+                           uint8_t type,
+                           uint32_t sequence,
+                           size_t length )
+{
+    pRecord[ 0 ] = type;
+    _encodeUint32( pRecord + 1, sequence );
+    _encodeUint32( pRecord + 5, ( uint32_t ) length );
+    _encodeUint32( pRecord + OUTBOX_HEADER_SIZE + length,
+                   _crc32( 0, pRecord, OUTBOX_HEADER_SIZE + length ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static _outboxRead_t _readRecord( const _mqttOutbox_t * pOutbox,
+                                  uint32_t segment,
+                                  size_t offset,
+                                  uint8_t * pType,
+                                  uint32_t * pSequence,
+                                  uint8_t ** ppData,
+                                  size_t * pLength )
+{
+    IOT_FUNCTION_ENTRY( _outboxRead_t, OUTBOX_READ_VALID );
+    uint8_t pHeader[ OUTBOX_HEADER_SIZE ] = { 0 }, pCrc[ OUTBOX_CRC_SIZE ] = { 0 };
+    uint8_t * pData = NULL;
+    size_t bytesRead = 0, length = 0;
+    uint32_t crc = 0;
+
+    /* Read the record header. */
+    bytesRead = pOutbox->pInterface->read( pOutbox->pStorage,
+                                           segment,
+                                           offset,
+                                           pHeader,
+                                           OUTBOX_HEADER_SIZE );
+
+    if( bytesRead == 0 )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_END );
+    }
+    else if( bytesRead < OUTBOX_HEADER_SIZE )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_CORRUPT );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    *pType = pHeader[ 0 ];
+    *pSequence = _decodeUint32( pHeader + 1 );
+    length = ( size_t ) _decodeUint32( pHeader + 5 );
+
+    /* Check the header before trusting its length. */
+    if( ( *pSequence == 0 ) ||
+        ( length + MQTT_OUTBOX_RECORD_OVERHEAD > pOutbox->segmentSize ) )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_CORRUPT );
+    }
+    else if( ( *pType == OUTBOX_RECORD_PUT ) && ( length > 0 ) )
+    {
+        EMPTY_ELSE_MARKER;
+    }
+    else if( ( *pType == OUTBOX_RECORD_ACK ) && ( length == 0 ) )
+    {
+        EMPTY_ELSE_MARKER;
+    }
+    else
+    {
+        IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_CORRUPT );
+    }
+
+    /* Read the record data. */
+    if( length > 0 )
+    {
+        pData = IotMqtt_MallocMessage( length );
+
+        if( pData == NULL )
+        {
+            IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_NO_MEMORY );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        bytesRead = pOutbox->pInterface->read( pOutbox->pStorage,
+                                               segment,
+                                               offset + OUTBOX_HEADER_SIZE,
+                                               pData,
+                                               length );
+
+        if( bytesRead < length )
+        {
+            IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_CORRUPT );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Read and check the CRC. */
+    bytesRead = pOutbox->pInterface->read( pOutbox->pStorage,
+                                           segment,
+                                           offset + OUTBOX_HEADER_SIZE + length,
+                                           pCrc,
+                                           OUTBOX_CRC_SIZE );
+
+    if( bytesRead < OUTBOX_CRC_SIZE )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_CORRUPT );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    crc = _crc32( 0, pHeader, OUTBOX_HEADER_SIZE );
+
+    if( pData != NULL )
+    {
+        crc = _crc32( crc, pData, length );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( crc != _decodeUint32( pCrc ) )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( OUTBOX_READ_CORRUPT );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IOT_FUNCTION_CLEANUP_BEGIN();
+
+    if( status == OUTBOX_READ_VALID )
+    {
+        *ppData = pData;
+        *pLength = length;
+    }
+    else
+    {
+        if( pData != NULL )
+        {
+            IotMqtt_FreeMessage( pData );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    IOT_FUNCTION_CLEANUP_END();
+}
+
+/*-----------------------------------------------------------*/
+
+static IotMqttError_t _scanOutbox( _mqttConnection_t * pMqttConnection,
+                                   _outboxScan_t * pScan,
+                                   _outboxVisitor_t visitor )
+{
+    IotMqttError_t status = IOT_MQTT_SUCCESS;
+    _outboxRead_t readStatus = OUTBOX_READ_VALID;
+    const _mqttOutbox_t * pOutbox = &( pMqttConnection->outbox );
+    uint32_t segment = pOutbox->firstSegment, sequence = 0;
+    size_t offset = 0, length = 0;
+    uint8_t type = 0, * pData = NULL;
+    bool lastSegment = false;
+
+    while( ( status == IOT_MQTT_SUCCESS ) && ( lastSegment == false ) )
+    {
+        lastSegment = ( segment == pOutbox->lastSegment );
+        offset = 0;
+        readStatus = OUTBOX_READ_VALID;
+
+        /* Visit every valid record of this segment. */
+        while( ( status == IOT_MQTT_SUCCESS ) && ( readStatus == OUTBOX_READ_VALID ) )
+        {
+            pData = NULL;
+            readStatus = _readRecord( pOutbox,
+                                      segment,
+                                      offset,
+                                      &type,
+                                      &sequence,
+                                      &pData,
+                                      &length );
+
+            if( readStatus == OUTBOX_READ_VALID )
+            {
+                status = visitor( pMqttConnection,
+                                  pScan,
+                                  segment,
+                                  type,
+                                  sequence,
+                                  &pData,
+                                  length );
+                offset += length + MQTT_OUTBOX_RECORD_OVERHEAD;
+
+                /* Free the record data unless the visitor took it. */
+                if( pData != NULL )
+                {
+                    IotMqtt_FreeMessage( pData );
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+            else if( readStatus == OUTBOX_READ_NO_MEMORY )
+            {
+                IotLogError( "(MQTT connection %p) Failed to allocate memory for "
+                             "outbox record.",
+                             pMqttConnection );
+
+                status = IOT_MQTT_NO_MEMORY;
+            }
+            else if( readStatus == OUTBOX_READ_CORRUPT )
+            {
+                IotLogWarn( "(MQTT connection %p) Outbox segment %lu is damaged at "
+                            "offset %lu. The rest of the segment is ignored.",
+                            pMqttConnection,
+                            ( unsigned long ) segment,
+                            ( unsigned long ) offset );
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+
+        segment++;
+    }
+
+    pScan->lastSegmentSize = offset;
+    pScan->lastSegmentCorrupt = ( readStatus == OUTBOX_READ_CORRUPT );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotMqttError_t _findSequences( _mqttConnection_t * pMqttConnection,
+                                      _outboxScan_t * pScan,
+                                      uint32_t segment,
+                                      uint8_t type,
+                                      uint32_t sequence,
+                                      uint8_t ** ppData,
+                                      size_t length )
+{
+    /* Unused parameters. */
+    ( void ) pMqttConnection;
+    ( void ) segment;
+    ( void ) ppData;
+    ( void ) length;
+
+    if( type == OUTBOX_RECORD_PUT )
+    {
+        if( ( pScan->firstSequence == 0 ) || ( sequence < pScan->firstSequence ) )
+        {
+            pScan->firstSequence = sequence;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( sequence > pScan->lastSequence )
+    {
+        pScan->lastSequence = sequence;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return IOT_MQTT_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotMqttError_t _findUnacked( _mqttConnection_t * pMqttConnection,
+                                    _outboxScan_t * pScan,
+                                    uint32_t segment,
+                                    uint8_t type,
+                                    uint32_t sequence,
+                                    uint8_t ** ppData,
+                                    size_t length )
+{
+    uint32_t bit = 0;
+
+    /* Unused parameters. */
+    ( void ) pMqttConnection;
+    ( void ) segment;
+    ( void ) ppData;
+    ( void ) length;
+
+    /* Acknowledgements of PUBLISH messages in removed segments are ignored. */
+    if( sequence >= pScan->firstSequence )
+    {
+        bit = sequence - pScan->firstSequence;
+
+        if( type == OUTBOX_RECORD_PUT )
+        {
+            pScan->pUnacked[ bit / 8 ] |= ( uint8_t ) ( 1U << ( bit % 8 ) );
+        }
+        else
+        {
+            pScan->pUnacked[ bit / 8 ] &= ( uint8_t ) ~( 1U << ( bit % 8 ) );
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return IOT_MQTT_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotMqttError_t _createReplay( _mqttConnection_t * pMqttConnection,
+                                     _outboxScan_t * pScan,
+                                     uint32_t segment,
+                                     uint8_t type,
+                                     uint32_t sequence,
+                                     uint8_t ** ppData,
+                                     size_t length )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    _mqttOutbox_t * pOutbox = &( pMqttConnection->outbox );
+    _mqttOperation_t * pOperation = NULL;
+    uint8_t * pPacketIdentifierHigh = NULL;
+    uint32_t bit = sequence - pScan->firstSequence;
+
+    /* Only unacknowledged PUBLISH messages are replayed. */
+    if( type != OUTBOX_RECORD_PUT )
+    {
+        IOT_GOTO_CLEANUP();
+    }
+    else if( ( pScan->pUnacked[ bit / 8 ] & ( 1U << ( bit % 8 ) ) ) == 0 )
+    {
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    pPacketIdentifierHigh = _publishIdentifierHigh( *ppData, length );
+
+    if( pPacketIdentifierHigh == NULL )
+    {
+        IotLogWarn( "(MQTT connection %p) Outbox record %lu is not a QoS 1 PUBLISH "
+                    "and will not be sent.",
+                    pMqttConnection,
+                    ( unsigned long ) sequence );
+
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Replayed PUBLISH messages are not waitable and have no callback. */
+    status = _IotMqtt_CreateOperation( pMqttConnection,
+                                       0,
+                                       NULL,
+                                       &pOperation );
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* The operation takes the record data as its packet. */
+    pOperation->u.operation.type = IOT_MQTT_PUBLISH_TO_SERVER;
+    pOperation->u.operation.pMqttPacket = *ppData;
+    pOperation->u.operation.packetSize = length;
+    pOperation->u.operation.outboxSequence = sequence;
+    pOperation->u.operation.outboxSegment = segment;
+    *ppData = NULL;
+
+    /* Packet identifiers are not persisted, so the PUBLISH gets a new packet
+     * identifier that cannot clash with one already in use. */
+    _IotMqtt_PublishSetDup( pOperation->u.operation.pMqttPacket,
+                            pPacketIdentifierHigh,
+                            &( pOperation->u.operation.packetIdentifier ) );
+
+    pOutbox->pLive[ segment % IOT_MQTT_OUTBOX_SEGMENTS ]++;
+
+    /* Add the operation to the end of the replay list. */
+    if( pScan->pReplayTail == NULL )
+    {
+        pOutbox->pReplay = pOperation;
+    }
+    else
+    {
+        pScan->pReplayTail->u.operation.pNextSend = pOperation;
+    }
+
+    pScan->pReplayTail = pOperation;
+    pScan->replayCount++;
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+static uint8_t * _publishIdentifierHigh( uint8_t * pPacket,
+                                         size_t packetSize )
+{
+    uint8_t * pPacketIdentifierHigh = NULL;
+    size_t index = 1;
+
+    if( ( pPacket[ 0 ] & 0xf6U ) == ( MQTT_PACKET_TYPE_PUBLISH | 0x02U ) )
+    {
+        /* Skip the remaining length, which is at most 4 bytes. */
+        while( ( index < packetSize ) && ( index < 4 ) && ( ( pPacket[ index ] & 0x80U ) != 0 ) )
+        {
+            index++;
+        }
+
+        /* Skip the topic name and its length. */
+        index++;
+
+        if( index + 2 <= packetSize )
+        {
+            index += 2 + ( ( ( size_t ) pPacket[ index ] << 8 ) | pPacket[ index + 1 ] );
+        }
+        else
+        {
+            index = packetSize;
+        }
+
+        /* The packet identifier follows the topic name. */
+        if( index + 2 <= packetSize )
+        {
+            pPacketIdentifierHigh = pPacket + index;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return pPacketIdentifierHigh;
+}
+
+/*-----------------------------------------------------------*/
+
+static void _compact( _mqttOutbox_t * pOutbox )
+{
+    bool removed = true;
+
+    while( ( removed == true ) &&
+           ( pOutbox->firstSegment != pOutbox->lastSegment ) &&
+           ( pOutbox->pLive[ pOutbox->firstSegment % IOT_MQTT_OUTBOX_SEGMENTS ] == 0 ) )
+    {
+        removed = pOutbox->pInterface->remove( pOutbox->pStorage,
+                                               pOutbox->firstSegment );
+
+        if( removed == true )
+        {
+            IotLogDebug( "Outbox segment %lu removed.",
+                         ( unsigned long ) pOutbox->firstSegment );
+
+            pOutbox->firstSegment++;
+        }
+        else
+        {
+            /* Segments must be removed oldest first, so that an acknowledgement
+             * is never removed before the PUBLISH it acknowledges. */
+            IotLogWarn( "Failed to remove outbox segment %lu.",
+                        ( unsigned long ) pOutbox->firstSegment );
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _reserve( _mqttOutbox_t * pOutbox,
+                      size_t recordSize )
+{
+    bool status = true;
+
+    if( pOutbox->lastSegmentSize + recordSize > pOutbox->segmentSize )
+    {
+        _compact( pOutbox );
+
+        if( pOutbox->lastSegment - pOutbox->firstSegment + 1 >= IOT_MQTT_OUTBOX_SEGMENTS )
+        {
+            status = false;
+        }
+        else
+        {
+            /* Start a new segment. */
+            pOutbox->lastSegment++;
+            pOutbox->lastSegmentSize = 0;
+            pOutbox->pLive[ pOutbox->lastSegment % IOT_MQTT_OUTBOX_SEGMENTS ] = 0;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+IotMqttError_t _IotMqtt_OutboxOpen( _mqttConnection_t * pMqttConnection,
+                                    const IotMqttOutboxInfo_t * pOutboxInfo )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    _mqttOutbox_t * pOutbox = &( pMqttConnection->outbox );
+    _outboxScan_t scan = { 0 };
+    size_t unackedSize = 0;
+
+    /* Create the outbox mutex. The outbox is closed with its MQTT connection
+     * once the mutex exists. */
+    if( IotMutex_Create( &( pOutbox->mutex ), false ) == false )
+    {
+        IotLogError( "(MQTT connection %p) Failed to create outbox mutex.",
+                     pMqttConnection );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        pOutbox->pInterface = pOutboxInfo->pInterface;
+        pOutbox->pStorage = pOutboxInfo->pStorage;
+        pOutbox->segmentSize = pOutboxInfo->segmentSize;
+        pOutbox->nextSequence = 1;
+    }
+
+    /* Nothing to read from empty storage. */
+    if( pOutbox->pInterface->range( pOutbox->pStorage,
+                                    &( pOutbox->firstSegment ),
+                                    &( pOutbox->lastSegment ) ) == false )
+    {
+        pOutbox->firstSegment = 0;
+        pOutbox->lastSegment = 0;
+
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( pOutbox->lastSegment - pOutbox->firstSegment >= IOT_MQTT_OUTBOX_SEGMENTS )
+    {
+        IotLogError( "(MQTT connection %p) Outbox has %lu segments, more than "
+                     "IOT_MQTT_OUTBOX_SEGMENTS.",
+                     pMqttConnection,
+                     ( unsigned long ) ( pOutbox->lastSegment - pOutbox->firstSegment + 1 ) );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Find the range of sequence numbers, then which PUBLISH messages are
+     * unacknowledged, then create their operations in order. */
+    status = _scanOutbox( pMqttConnection, &scan, _findSequences );
+
+    if( ( status == IOT_MQTT_SUCCESS ) && ( scan.firstSequence != 0 ) )
+    {
+        unackedSize = ( size_t ) ( scan.lastSequence - scan.firstSequence ) / 8 + 1;
+        scan.pUnacked = IotMqtt_MallocMessage( unackedSize );
+
+        if( scan.pUnacked == NULL )
+        {
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+        }
+        else
+        {
+            ( void ) memset( scan.pUnacked, 0x00, unackedSize );
+        }
+
+        status = _scanOutbox( pMqttConnection, &scan, _findUnacked );
+
+        if( status == IOT_MQTT_SUCCESS )
+        {
+            status = _scanOutbox( pMqttConnection, &scan, _createReplay );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        IOT_GOTO_CLEANUP();
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    pOutbox->nextSequence = scan.lastSequence + 1;
+    pOutbox->lastSegmentSize = scan.lastSegmentSize;
+
+    /* Never append after a damaged record; start a new segment instead. */
+    if( scan.lastSegmentCorrupt == true )
+    {
+        pOutbox->lastSegmentSize = pOutbox->segmentSize;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    _compact( pOutbox );
+
+    IotLogInfo( "(MQTT connection %p) Outbox has %lu unacknowledged PUBLISH messages.",
+                pMqttConnection,
+                ( unsigned long ) scan.replayCount );
+
+    IOT_FUNCTION_CLEANUP_BEGIN();
+
+    if( scan.pUnacked != NULL )
+    {
+        IotMqtt_FreeMessage( scan.pUnacked );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IOT_FUNCTION_CLEANUP_END();
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_OutboxReplay( _mqttConnection_t * pMqttConnection )
+{
+    _mqttOperation_t * pOperation = pMqttConnection->outbox.pReplay, * pNext = NULL;
+
+    pMqttConnection->outbox.pReplay = NULL;
+
+    while( pOperation != NULL )
+    {
+        pNext = pOperation->u.operation.pNextSend;
+        pOperation->u.operation.pNextSend = NULL;
+
+        _IotMqtt_EnqueueSend( pOperation );
+
+        pOperation = pNext;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_OutboxClose( _mqttConnection_t * pMqttConnection )
+{
+    _mqttOutbox_t * pOutbox = &( pMqttConnection->outbox );
+    _mqttOperation_t * pOperation = pOutbox->pReplay, * pNext = NULL;
+
+    if( pOutbox->pInterface != NULL )
+    {
+        /* Destroy any PUBLISH messages that were never replayed. They remain
+         * in storage. */
+        pOutbox->pReplay = NULL;
+
+        while( pOperation != NULL )
+        {
+            pNext = pOperation->u.operation.pNextSend;
+            _IotMqtt_DestroyOperation( pOperation );
+            pOperation = pNext;
+        }
+
+        IotMutex_Destroy( &( pOutbox->mutex ) );
+        pOutbox->pInterface = NULL;
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+IotMqttError_t _IotMqtt_OutboxPut( _mqttOperation_t * pOperation )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+    _mqttOutbox_t * pOutbox = &( pMqttConnection->outbox );
+    size_t length = pOperation->u.operation.packetSize + pOperation->u.operation.payloadLength;
+    uint8_t * pRecord = NULL;
+
+    if( length + MQTT_OUTBOX_RECORD_OVERHEAD > pOutbox->segmentSize )
+    {
+        IotLogError( "(MQTT connection %p) PUBLISH of %lu bytes is larger than an "
+                     "outbox segment.",
+                     pMqttConnection,
+                     ( unsigned long ) length );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Copy the PUBLISH and any payload sent from the caller's buffer into one
+     * record, so that it is appended with one write. */
+    pRecord = IotMqtt_MallocMessage( length + MQTT_OUTBOX_RECORD_OVERHEAD );
+
+    if( pRecord == NULL )
+    {
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        ( void ) memcpy( pRecord + OUTBOX_HEADER_SIZE,
+                         pOperation->u.operation.pMqttPacket,
+                         pOperation->u.operation.packetSize );
+
+        if( pOperation->u.operation.pPayload != NULL )
+        {
+            ( void ) memcpy( pRecord + OUTBOX_HEADER_SIZE + pOperation->u.operation.packetSize,
+                             pOperation->u.operation.pPayload,
+                             pOperation->u.operation.payloadLength );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    IotMutex_Lock( &( pOutbox->mutex ) );
+
+    if( _reserve( pOutbox, length + MQTT_OUTBOX_RECORD_OVERHEAD ) == false )
+    {
+        IotLogWarn( "(MQTT connection %p) Outbox is full.", pMqttConnection );
+
+        status = IOT_MQTT_NO_MEMORY;
+    }
+    else
+    {
+        _encodeRecord( pRecord, OUTBOX_RECORD_PUT, pOutbox->nextSequence, length );
+
+        if( pOutbox->pInterface->append( pOutbox->pStorage,
+                                         pOutbox->lastSegment,
+                                         pRecord,
+                                         length + MQTT_OUTBOX_RECORD_OVERHEAD ) == true )
+        {
+            pOperation->u.operation.outboxSequence = pOutbox->nextSequence;
+            pOperation->u.operation.outboxSegment = pOutbox->lastSegment;
+
+            pOutbox->pLive[ pOutbox->lastSegment % IOT_MQTT_OUTBOX_SEGMENTS ]++;
+            pOutbox->lastSegmentSize += length + MQTT_OUTBOX_RECORD_OVERHEAD;
+            pOutbox->nextSequence++;
+        }
+        else
+        {
+            IotLogError( "(MQTT connection %p) Failed to write PUBLISH to outbox.",
+                         pMqttConnection );
+
+            /* Part of the record may have been written. Start a new segment
+             * for the next record. */
+            pOutbox->lastSegmentSize = pOutbox->segmentSize;
+
+            status = IOT_MQTT_NO_MEMORY;
+        }
+    }
+
+    IotMutex_Unlock( &( pOutbox->mutex ) );
+
+    IOT_FUNCTION_CLEANUP_BEGIN();
+
+    if( pRecord != NULL )
+    {
+        IotMqtt_FreeMessage( pRecord );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IOT_FUNCTION_CLEANUP_END();
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_OutboxAck( _mqttOperation_t * pOperation )
+{
+    _mqttConnection_t * pMqttConnection = pOperation->pMqttConnection;
+    _mqttOutbox_t * pOutbox = &( pMqttConnection->outbox );
+    uint8_t pRecord[ MQTT_OUTBOX_RECORD_OVERHEAD ] = { 0 };
+
+    IotMutex_Lock( &( pOutbox->mutex ) );
+
+    /* Remove any segments this acknowledgement empties before appending, so
+     * that there is room for the acknowledgement. */
+    pOutbox->pLive[ pOperation->u.operation.outboxSegment % IOT_MQTT_OUTBOX_SEGMENTS ]--;
+    _compact( pOutbox );
+
+    if( _reserve( pOutbox, MQTT_OUTBOX_RECORD_OVERHEAD ) == true )
+    {
+        _encodeRecord( pRecord, OUTBOX_RECORD_ACK, pOperation->u.operation.outboxSequence, 0 );
+
+        if( pOutbox->pInterface->append( pOutbox->pStorage,
+                                         pOutbox->lastSegment,
+                                         pRecord,
+                                         MQTT_OUTBOX_RECORD_OVERHEAD ) == true )
+        {
+            pOutbox->lastSegmentSize += MQTT_OUTBOX_RECORD_OVERHEAD;
+        }
+        else
+        {
+            IotLogWarn( "(MQTT connection %p) Failed to write acknowledgement of "
+                        "outbox record %lu. It may be sent again.",
+                        pMqttConnection,
+                        ( unsigned long ) pOperation->u.operation.outboxSequence );
+
+            pOutbox->lastSegmentSize = pOutbox->segmentSize;
+        }
+    }
+    else
+    {
+        IotLogWarn( "(MQTT connection %p) Outbox is full. Outbox record %lu may "
+                    "be sent again.",
+                    pMqttConnection,
+                    ( unsigned long ) pOperation->u.operation.outboxSequence );
+    }
+
+    IotMutex_Unlock( &( pOutbox->mutex ) );
+
+    pOperation->u.operation.outboxSequence = 0;
+}
+
+/*-----------------------------------------------------------*/
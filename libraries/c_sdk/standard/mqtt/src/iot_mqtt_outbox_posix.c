@@ -0,0 +1,422 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_mqtt_outbox_posix.c
+ * @brief Implements an MQTT outbox that stores its segments as files in a
+ * POSIX directory.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX includes. */
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Error handling include. */
+#include "private/iot_error.h"
+
+/* POSIX outbox include. */
+#include "iot_mqtt_outbox_posix.h"
+
+/* Configure logs for the functions in this file. */
+#ifdef IOT_LOG_LEVEL_MQTT
+    #define LIBRARY_LOG_LEVEL        IOT_LOG_LEVEL_MQTT
+#else
+    #ifdef IOT_LOG_LEVEL_GLOBAL
+        #define LIBRARY_LOG_LEVEL    IOT_LOG_LEVEL_GLOBAL
+    #else
+        #define LIBRARY_LOG_LEVEL    IOT_LOG_NONE
+    #endif
+#endif
+
+#define LIBRARY_LOG_NAME    ( "MQTT" )
+#include "iot_logging_setup.h"
+
+/**
+ * @brief Marks the empty statement of an `else` branch.
+ */
+#ifndef EMPTY_ELSE_MARKER
+    #define EMPTY_ELSE_MARKER
+#endif
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Extension of segment file names.
+ */
+#define SEGMENT_EXTENSION       ".seg"
+
+/**
+ * @brief Length of a segment file name: 8 hexadecimal digits and an extension.
+ */
+#define SEGMENT_NAME_LENGTH     ( 8 + sizeof( SEGMENT_EXTENSION ) - 1 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write the path of a segment file.
+ *
+ * @param[in] pOutbox The outbox storage.
+ * @param[in] segment The segment number.
+ * @param[out] pPath Buffer of `PATH_MAX` characters.
+ *
+ * @return `true` if the path fit in `pPath`; `false` otherwise.
+ */
+static bool _segmentPath( const IotMqttOutboxPosix_t * pOutbox,
+                          uint32_t segment,
+                          char * pPath );
+
+/**
+ * @brief Implements #IotMqttOutboxInterface_t.append.
+ */
+static bool _append( void * pStorage,
+                     uint32_t segment,
+                     const uint8_t * pData,
+                     size_t length );
+
+/**
+ * @brief Implements #IotMqttOutboxInterface_t.read.
+ */
+static size_t _read( void * pStorage,
+                     uint32_t segment,
+                     size_t offset,
+                     uint8_t * pBuffer,
+                     size_t length );
+
+/**
+ * @brief Implements #IotMqttOutboxInterface_t.remove.
+ */
+static bool _remove( void * pStorage,
+                     uint32_t segment );
+
+/**
+ * @brief Implements #IotMqttOutboxInterface_t.range.
+ */
+static bool _range( void * pStorage,
+                    uint32_t * pFirstSegment,
+                    uint32_t * pLastSegment );
+
+/*-----------------------------------------------------------*/
+
+const IotMqttOutboxInterface_t IotMqttOutboxPosix =
+{
+    .append = _append,
+    .read   = _read,
+    .remove = _remove,
+    .range  = _range
+};
+
+/*-----------------------------------------------------------*/
+
+static bool _segmentPath( const IotMqttOutboxPosix_t * pOutbox,
+                          uint32_t segment,
+                          char * pPath )
+{
+    int pathLength = snprintf( pPath,
+                               PATH_MAX,
+                               "%s/%08lx" SEGMENT_EXTENSION,
+                               pOutbox->pDirectory,
+                               ( unsigned long ) segment );
+
+    return ( pathLength > 0 ) && ( pathLength < PATH_MAX );
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _append( void * pStorage,
+                     uint32_t segment,
+                     const uint8_t * pData,
+                     size_t length )
+{
+    IOT_FUNCTION_ENTRY( bool, true );
+    const IotMqttOutboxPosix_t * pOutbox = ( const IotMqttOutboxPosix_t * ) pStorage;
+    char pPath[ PATH_MAX ] = { 0 };
+    int fd = -1, directory = -1;
+    ssize_t bytesWritten = 0;
+    size_t offset = 0;
+    bool created = true;
+
+    if( _segmentPath( pOutbox, segment, pPath ) == false )
+    {
+        IotLogError( "Outbox path is too long." );
+
+        IOT_SET_AND_GOTO_CLEANUP( false );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Open the segment, noting whether it is new. */
+    fd = open( pPath, O_WRONLY | O_APPEND | O_CREAT | O_EXCL, 0600 );
+
+    if( ( fd == -1 ) && ( errno == EEXIST ) )
+    {
+        created = false;
+        fd = open( pPath, O_WRONLY | O_APPEND );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( fd == -1 )
+    {
+        IotLogError( "Failed to open outbox segment %s, errno %d.", pPath, errno );
+
+        IOT_SET_AND_GOTO_CLEANUP( false );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Write all of the data, retrying interrupted writes. */
+    while( offset < length )
+    {
+        bytesWritten = write( fd, pData + offset, length - offset );
+
+        if( bytesWritten > 0 )
+        {
+            offset += ( size_t ) bytesWritten;
+        }
+        else if( ( bytesWritten == -1 ) && ( errno == EINTR ) )
+        {
+            EMPTY_ELSE_MARKER;
+        }
+        else
+        {
+            IotLogError( "Failed to write outbox segment %s, errno %d.", pPath, errno );
+
+            IOT_SET_AND_GOTO_CLEANUP( false );
+        }
+    }
+
+    if( fsync( fd ) != 0 )
+    {
+        IotLogError( "Failed to sync outbox segment %s, errno %d.", pPath, errno );
+
+        IOT_SET_AND_GOTO_CLEANUP( false );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* The directory entry of a new segment must also reach storage. */
+    if( created == true )
+    {
+        directory = open( pOutbox->pDirectory, O_RDONLY );
+
+        if( directory != -1 )
+        {
+            ( void ) fsync( directory );
+            ( void ) close( directory );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IOT_FUNCTION_CLEANUP_BEGIN();
+
+    if( fd != -1 )
+    {
+        ( void ) close( fd );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IOT_FUNCTION_CLEANUP_END();
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t _read( void * pStorage,
+                     uint32_t segment,
+                     size_t offset,
+                     uint8_t * pBuffer,
+                     size_t length )
+{
+    const IotMqttOutboxPosix_t * pOutbox = ( const IotMqttOutboxPosix_t * ) pStorage;
+    char pPath[ PATH_MAX ] = { 0 };
+    int fd = -1;
+    ssize_t bytesRead = 1;
+    size_t totalRead = 0;
+
+    /* A segment that cannot be opened is read as empty. */
+    if( _segmentPath( pOutbox, segment, pPath ) == true )
+    {
+        fd = open( pPath, O_RDONLY );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    if( fd != -1 )
+    {
+        /* Read until the buffer is full or the end of the file. */
+        while( ( bytesRead != 0 ) && ( totalRead < length ) )
+        {
+            bytesRead = pread( fd,
+                               pBuffer + totalRead,
+                               length - totalRead,
+                               ( off_t ) ( offset + totalRead ) );
+
+            if( bytesRead > 0 )
+            {
+                totalRead += ( size_t ) bytesRead;
+            }
+            else if( ( bytesRead == -1 ) && ( errno != EINTR ) )
+            {
+                IotLogError( "Failed to read outbox segment %s, errno %d.", pPath, errno );
+
+                bytesRead = 0;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+
+        ( void ) close( fd );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return totalRead;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _remove( void * pStorage,
+                     uint32_t segment )
+{
+    bool status = false;
+    const IotMqttOutboxPosix_t * pOutbox = ( const IotMqttOutboxPosix_t * ) pStorage;
+    char pPath[ PATH_MAX ] = { 0 };
+
+    if( _segmentPath( pOutbox, segment, pPath ) == true )
+    {
+        status = ( unlink( pPath ) == 0 ) || ( errno == ENOENT );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static bool _range( void * pStorage,
+                    uint32_t * pFirstSegment,
+                    uint32_t * pLastSegment )
+{
+    bool found = false;
+    const IotMqttOutboxPosix_t * pOutbox = ( const IotMqttOutboxPosix_t * ) pStorage;
+    DIR * pDirectory = NULL;
+    const struct dirent * pEntry = NULL;
+    char * pEnd = NULL;
+    uint32_t segment = 0;
+
+    pDirectory = opendir( pOutbox->pDirectory );
+
+    if( pDirectory != NULL )
+    {
+        /* Find the lowest and highest segment numbers among the segment files. */
+        for( pEntry = readdir( pDirectory ); pEntry != NULL; pEntry = readdir( pDirectory ) )
+        {
+            if( strlen( pEntry->d_name ) == SEGMENT_NAME_LENGTH )
+            {
+                segment = ( uint32_t ) strtoul( pEntry->d_name, &pEnd, 16 );
+
+                if( ( pEnd == pEntry->d_name + 8 ) && ( strcmp( pEnd, SEGMENT_EXTENSION ) == 0 ) )
+                {
+                    if( ( found == false ) || ( segment < *pFirstSegment ) )
+                    {
+                        *pFirstSegment = segment;
+                    }
+                    else
+                    {
+                        EMPTY_ELSE_MARKER;
+                    }
+
+                    if( ( found == false ) || ( segment > *pLastSegment ) )
+                    {
+                        *pLastSegment = segment;
+                    }
+                    else
+                    {
+                        EMPTY_ELSE_MARKER;
+                    }
+
+                    found = true;
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+        }
+
+        ( void ) closedir( pDirectory );
+    }
+    else
+    {
+        IotLogError( "Failed to open outbox directory %s, errno %d.",
+                     pOutbox->pDirectory,
+                     errno );
+    }
+
+    return found;
+}
+
+/*-----------------------------------------------------------*/
@@ -270,6 +270,25 @@ static bool _subscriptionPacketSize( IotMqttOperationType_t type,
                                      size_t * pRemainingLength,
                                      size_t * pPacketSize );
 
+/**
+ * @brief Write the fixed and variable headers of a PUBLISH packet, i.e.
+ * everything except the payload.
+ *
+ * @param[in] pPublishInfo User-provided PUBLISH information.
+ * @param[in] remainingLength The "Remaining length" of the whole PUBLISH packet.
+ * @param[out] pPacketIdentifier The packet identifier generated for this PUBLISH.
+ * @param[out] pPacketIdentifierHigh Where the high byte of the packet identifier
+ * is written.
+ * @param[out] pBuffer Where the headers are written. Must be large enough.
+ *
+ * @return Pointer to the byte after the headers, where the payload belongs.
+ */
+static uint8_t * _serializePublishHeader( const IotMqttPublishInfo_t * pPublishInfo,
+                                          size_t remainingLength,
+                                          uint16_t * pPacketIdentifier,
+                                          uint8_t ** pPacketIdentifierHigh,
+                                          uint8_t * pBuffer );
+
 /*-----------------------------------------------------------*/
 
 #if LIBRARY_LOG_LEVEL > IOT_LOG_NONE
@@ -1019,55 +1038,14 @@ IotMqttError_t _IotMqtt_DeserializeConnack( _mqttPacket_t * pConnack )
 
 /*-----------------------------------------------------------*/
 
-IotMqttError_t _IotMqtt_SerializePublish( const IotMqttPublishInfo_t * pPublishInfo,
-                                          uint8_t ** pPublishPacket,
-                                          size_t * pPacketSize,
+static uint8_t * _serializePublishHeader( const IotMqttPublishInfo_t * pPublishInfo,
+                                          size_t remainingLength,
                                           uint16_t * pPacketIdentifier,
-                                          uint8_t ** pPacketIdentifierHigh )
+                                          uint8_t ** pPacketIdentifierHigh,
+                                          uint8_t * pBuffer )
 {
-    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
     uint8_t publishFlags = 0;
     uint16_t packetIdentifier = 0;
-    size_t remainingLength = 0, publishPacketSize = 0;
-    uint8_t * pBuffer = NULL;
-
-    /* Calculate the "Remaining length" field and total packet size. If it exceeds
-     * what is allowed in the MQTT standard, return an error. */
-    if( _publishPacketSize( pPublishInfo, &remainingLength, &publishPacketSize ) == false )
-    {
-        IotLogError( "Publish packet remaining length exceeds %lu, which is the "
-                     "maximum size allowed by MQTT 3.1.1.",
-                     MQTT_MAX_REMAINING_LENGTH );
-
-        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
-    }
-    else
-    {
-        EMPTY_ELSE_MARKER;
-    }
-
-    /* Total size of the publish packet should be larger than the "Remaining length"
-     * field. */
-    IotMqtt_Assert( publishPacketSize > remainingLength );
-
-    /* Allocate memory to hold the PUBLISH packet. */
-    pBuffer = IotMqtt_MallocMessage( publishPacketSize );
-
-    /* Check that sufficient memory was allocated. */
-    if( pBuffer == NULL )
-    {
-        IotLogError( "Failed to allocate memory for PUBLISH packet." );
-
-        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
-    }
-    else
-    {
-        EMPTY_ELSE_MARKER;
-    }
-
-    /* Set the output parameters. The remainder of this function always succeeds. */
-    *pPublishPacket = pBuffer;
-    *pPacketSize = publishPacketSize;
 
     /* The first byte of a PUBLISH packet contains the packet type and flags. */
     publishFlags = MQTT_PACKET_TYPE_PUBLISH;
@@ -1134,6 +1112,66 @@ IotMqttError_t _IotMqtt_SerializePublish( const IotMqttPublishInfo_t * pPublishI
         EMPTY_ELSE_MARKER;
     }
 
+    return pBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+IotMqttError_t _IotMqtt_SerializePublish( const IotMqttPublishInfo_t * pPublishInfo,
+                                          uint8_t ** pPublishPacket,
+                                          size_t * pPacketSize,
+                                          uint16_t * pPacketIdentifier,
+                                          uint8_t ** pPacketIdentifierHigh )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    size_t remainingLength = 0, publishPacketSize = 0;
+    uint8_t * pBuffer = NULL;
+
+    /* Calculate the "Remaining length" field and total packet size. If it exceeds
+     * what is allowed in the MQTT standard, return an error. */
+    if( _publishPacketSize( pPublishInfo, &remainingLength, &publishPacketSize ) == false )
+    {
+        IotLogError( "Publish packet remaining length exceeds %lu, which is the "
+                     "maximum size allowed by MQTT 3.1.1.",
+                     MQTT_MAX_REMAINING_LENGTH );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Total size of the publish packet should be larger than the "Remaining length"
+     * field. */
+    IotMqtt_Assert( publishPacketSize > remainingLength );
+
+    /* Allocate memory to hold the PUBLISH packet. */
+    pBuffer = IotMqtt_MallocMessage( publishPacketSize );
+
+    /* Check that sufficient memory was allocated. */
+    if( pBuffer == NULL )
+    {
+        IotLogError( "Failed to allocate memory for PUBLISH packet." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Set the output parameters. The remainder of this function always succeeds. */
+    *pPublishPacket = pBuffer;
+    *pPacketSize = publishPacketSize;
+
+    /* Write the fixed and variable headers. */
+    pBuffer = _serializePublishHeader( pPublishInfo,
+                                       remainingLength,
+                                       pPacketIdentifier,
+                                       pPacketIdentifierHigh,
+                                       pBuffer );
+
     /* The payload is placed after the packet identifier. */
     if( pPublishInfo->payloadLength > 0 )
     {
@@ -1157,6 +1195,169 @@ IotMqttError_t _IotMqtt_SerializePublish( const IotMqttPublishInfo_t * pPublishI
 
 /*-----------------------------------------------------------*/
 
+IotMqttError_t _IotMqtt_SerializePublishHeader( const IotMqttPublishInfo_t * pPublishInfo,
+                                                uint8_t ** pPublishHeader,
+                                                size_t * pHeaderSize,
+                                                uint16_t * pPacketIdentifier,
+                                                uint8_t ** pPacketIdentifierHigh )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    size_t remainingLength = 0, publishPacketSize = 0, headerSize = 0;
+    uint8_t * pBuffer = NULL;
+
+    /* Calculate the "Remaining length" field and total packet size. If it exceeds
+     * what is allowed in the MQTT standard, return an error. */
+    if( _publishPacketSize( pPublishInfo, &remainingLength, &publishPacketSize ) == false )
+    {
+        IotLogError( "Publish packet remaining length exceeds %lu, which is the "
+                     "maximum size allowed by MQTT 3.1.1.",
+                     MQTT_MAX_REMAINING_LENGTH );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Only the headers are allocated; the payload is sent from the caller's
+     * buffer. */
+    IotMqtt_Assert( publishPacketSize > pPublishInfo->payloadLength );
+    headerSize = publishPacketSize - pPublishInfo->payloadLength;
+
+    pBuffer = IotMqtt_MallocMessage( headerSize );
+
+    /* Check that sufficient memory was allocated. */
+    if( pBuffer == NULL )
+    {
+        IotLogError( "Failed to allocate memory for PUBLISH header." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Set the output parameters. The remainder of this function always succeeds. */
+    *pPublishHeader = pBuffer;
+    *pHeaderSize = headerSize;
+
+    /* Write the fixed and variable headers. */
+    pBuffer = _serializePublishHeader( pPublishInfo,
+                                       remainingLength,
+                                       pPacketIdentifier,
+                                       pPacketIdentifierHigh,
+                                       pBuffer );
+
+    /* Ensure that pBuffer did not overflow. */
+    IotMqtt_Assert( ( size_t ) ( pBuffer - *pPublishHeader ) == headerSize );
+
+    /* Print out the serialized PUBLISH header for debugging purposes. */
+    IotLog_PrintBuffer( "MQTT PUBLISH header:", *pPublishHeader, headerSize );
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
+IotMqttError_t _IotMqtt_SerializePublishBatch( const IotMqttPublishInfo_t * pPublishInfoList,
+                                               size_t publishCount,
+                                               uint8_t ** pBatchPacket,
+                                               size_t * pPacketSize,
+                                               uint16_t * pPacketIdentifiers )
+{
+    IOT_FUNCTION_ENTRY( IotMqttError_t, IOT_MQTT_SUCCESS );
+    size_t i = 0, remainingLength = 0, publishPacketSize = 0, batchPacketSize = 0;
+    uint8_t * pBuffer = NULL;
+    uint16_t * pNextPacketIdentifier = pPacketIdentifiers;
+
+    /* Calculate the size of every PUBLISH packet in the batch. */
+    for( i = 0; i < publishCount; i++ )
+    {
+        if( _publishPacketSize( &( pPublishInfoList[ i ] ),
+                                &remainingLength,
+                                &publishPacketSize ) == false )
+        {
+            IotLogError( "Publish packet %lu of batch remaining length exceeds %lu, "
+                         "which is the maximum size allowed by MQTT 3.1.1.",
+                         ( unsigned long ) i,
+                         MQTT_MAX_REMAINING_LENGTH );
+
+            IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_BAD_PARAMETER );
+        }
+        else
+        {
+            batchPacketSize += publishPacketSize;
+        }
+    }
+
+    /* Allocate one buffer to hold all PUBLISH packets of the batch. */
+    pBuffer = IotMqtt_MallocMessage( batchPacketSize );
+
+    /* Check that sufficient memory was allocated. */
+    if( pBuffer == NULL )
+    {
+        IotLogError( "Failed to allocate memory for PUBLISH batch." );
+
+        IOT_SET_AND_GOTO_CLEANUP( IOT_MQTT_NO_MEMORY );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Set the output parameters. The remainder of this function always succeeds. */
+    *pBatchPacket = pBuffer;
+    *pPacketSize = batchPacketSize;
+
+    /* Write each PUBLISH packet directly after the previous one. */
+    for( i = 0; i < publishCount; i++ )
+    {
+        ( void ) _publishPacketSize( &( pPublishInfoList[ i ] ),
+                                     &remainingLength,
+                                     &publishPacketSize );
+
+        pBuffer = _serializePublishHeader( &( pPublishInfoList[ i ] ),
+                                           remainingLength,
+                                           pNextPacketIdentifier,
+                                           NULL,
+                                           pBuffer );
+
+        /* Packet identifiers are only generated for QoS 1 and 2 messages. */
+        if( pPublishInfoList[ i ].qos > IOT_MQTT_QOS_0 )
+        {
+            pNextPacketIdentifier++;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        if( pPublishInfoList[ i ].payloadLength > 0 )
+        {
+            ( void ) memcpy( pBuffer,
+                             pPublishInfoList[ i ].pPayload,
+                             pPublishInfoList[ i ].payloadLength );
+            pBuffer += pPublishInfoList[ i ].payloadLength;
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+
+    /* Ensure that pBuffer did not overflow. */
+    IotMqtt_Assert( ( size_t ) ( pBuffer - *pBatchPacket ) == batchPacketSize );
+
+    /* Print out the serialized PUBLISH batch for debugging purposes. */
+    IotLog_PrintBuffer( "MQTT PUBLISH batch:", *pBatchPacket, batchPacketSize );
+
+    IOT_FUNCTION_EXIT_NO_CLEANUP();
+}
+
+/*-----------------------------------------------------------*/
+
 void _IotMqtt_PublishSetDup( uint8_t * pPublishPacket,
                              uint8_t * pPacketIdentifierHigh,
                              uint16_t * pNewPacketIdentifier )
@@ -25,28 +25,31 @@
 
 /**
  * @file iot_mqtt_static_memory.c
- * @brief Implementation of MQTT static memory functions.
+ * @brief Implementation of MQTT memory allocation functions for static memory,
+ * the operation cache, and the receive pool.
  */
 
 /* The config header is always included first. */
 #include "iot_config.h"
 
-/* This file should only be compiled if dynamic memory allocation is forbidden. */
-#if IOT_STATIC_MEMORY_ONLY == 1
-
 /* Standard includes. */
 #include <stdbool.h>
 #include <stddef.h>
 #include <string.h>
 
-/* Static memory include. */
-#include "private/iot_static_memory.h"
+/* Platform layer includes. */
+#include "platform/iot_threads.h"
 
 /* MQTT internal include. */
 #include "private/iot_mqtt_internal.h"
 
+/* Slab allocator include. */
+#include "iot_slab.h"
+
 /*-----------------------------------------------------------*/
 
+#if IOT_STATIC_MEMORY_ONLY == 1
+
 /**
  * @cond DOXYGEN_IGNORE
  * Doxygen should ignore this section.
@@ -62,6 +65,9 @@
 #ifndef IOT_MQTT_SUBSCRIPTIONS
     #define IOT_MQTT_SUBSCRIPTIONS                 ( 8 )
 #endif
+#ifndef IOT_MQTT_TOPIC_NODES
+    #define IOT_MQTT_TOPIC_NODES                   ( 4 * IOT_MQTT_SUBSCRIPTIONS )
+#endif
 /** @endcond */
 
 /* Validate static memory configuration settings. */
@@ -74,6 +80,9 @@
 #if IOT_MQTT_SUBSCRIPTIONS <= 0
     #error "IOT_MQTT_SUBSCRIPTIONS cannot be 0 or negative."
 #endif
+#if IOT_MQTT_TOPIC_NODES <= 0
+    #error "IOT_MQTT_TOPIC_NODES cannot be 0 or negative."
+#endif
 
 /**
  * @brief The size of a static memory MQTT subscription.
@@ -84,38 +93,54 @@
  */
 #define MQTT_SUBSCRIPTION_SIZE    ( sizeof( _mqttSubscription_t ) + AWS_IOT_MQTT_SERVER_MAX_TOPIC_LENGTH )
 
+/**
+ * @brief The size of a static memory MQTT topic node.
+ *
+ * A topic level may be as long as a whole topic filter, so the constant
+ * #AWS_IOT_MQTT_SERVER_MAX_TOPIC_LENGTH is used for the length of
+ * #_mqttTopicNode_t.pLevel.
+ */
+#define MQTT_TOPIC_NODE_SIZE      ( sizeof( _mqttTopicNode_t ) + AWS_IOT_MQTT_SERVER_MAX_TOPIC_LENGTH )
+
 /*-----------------------------------------------------------*/
 
 /*
- * Static memory buffers and flags, allocated and zeroed at compile-time.
+ * Static memory buffers, allocated and zeroed at compile-time.
  */
-static bool _pInUseMqttConnections[ IOT_MQTT_CONNECTIONS ] = { 0 };                               /**< @brief MQTT connection in-use flags. */
 static _mqttConnection_t _pMqttConnections[ IOT_MQTT_CONNECTIONS ] = { { 0 } };                   /**< @brief MQTT connections. */
 
-static bool _pInUseMqttOperations[ IOT_MQTT_MAX_IN_PROGRESS_OPERATIONS ] = { 0 };                        /**< @brief MQTT operation in-use flags. */
 static _mqttOperation_t _pMqttOperations[ IOT_MQTT_MAX_IN_PROGRESS_OPERATIONS ] = { { .link = { 0 } } }; /**< @brief MQTT operations. */
 
-static bool _pInUseMqttSubscriptions[ IOT_MQTT_SUBSCRIPTIONS ] = { 0 };                           /**< @brief MQTT subscription in-use flags. */
 static char _pMqttSubscriptions[ IOT_MQTT_SUBSCRIPTIONS ][ MQTT_SUBSCRIPTION_SIZE ] = { { 0 } };  /**< @brief MQTT subscriptions. */
 
+static char _pMqttTopicNodes[ IOT_MQTT_TOPIC_NODES ][ MQTT_TOPIC_NODE_SIZE ] = { { 0 } }; /**< @brief MQTT topic nodes. */
+
+/*
+ * Free lists of the static memory buffers.
+ */
+static IotSlab_t _connectionSlab = IOT_SLAB_INITIALIZER( _pMqttConnections,
+                                                         sizeof( _mqttConnection_t ),
+                                                         IOT_MQTT_CONNECTIONS );                /**< @brief MQTT connection slab. */
+static IotSlab_t _operationSlab = IOT_SLAB_INITIALIZER( _pMqttOperations,
+                                                        sizeof( _mqttOperation_t ),
+                                                        IOT_MQTT_MAX_IN_PROGRESS_OPERATIONS );  /**< @brief MQTT operation slab. */
+static IotSlab_t _subscriptionSlab = IOT_SLAB_INITIALIZER( _pMqttSubscriptions,
+                                                           MQTT_SUBSCRIPTION_SIZE,
+                                                           IOT_MQTT_SUBSCRIPTIONS );            /**< @brief MQTT subscription slab. */
+static IotSlab_t _topicNodeSlab = IOT_SLAB_INITIALIZER( _pMqttTopicNodes,
+                                                        MQTT_TOPIC_NODE_SIZE,
+                                                        IOT_MQTT_TOPIC_NODES );                 /**< @brief MQTT topic node slab. */
+
 /*-----------------------------------------------------------*/
 
 void * IotMqtt_MallocConnection( size_t size )
 {
-    int32_t freeIndex = -1;
     void * pNewConnection = NULL;
 
     /* Check size argument. */
     if( size == sizeof( _mqttConnection_t ) )
     {
-        /* Find a free MQTT connection. */
-        freeIndex = IotStaticMemory_FindFree( _pInUseMqttConnections,
-                                              IOT_MQTT_CONNECTIONS );
-
-        if( freeIndex != -1 )
-        {
-            pNewConnection = &( _pMqttConnections[ freeIndex ] );
-        }
+        pNewConnection = IotStaticMemory_Alloc( &_connectionSlab, 1, size );
     }
 
     return pNewConnection;
@@ -126,31 +151,19 @@ void * IotMqtt_MallocConnection( size_t size )
 void IotMqtt_FreeConnection( void * ptr )
 {
     /* Return the in-use MQTT connection. */
-    IotStaticMemory_ReturnInUse( ptr,
-                                 _pMqttConnections,
-                                 _pInUseMqttConnections,
-                                 IOT_MQTT_CONNECTIONS,
-                                 sizeof( _mqttConnection_t ) );
+    IotStaticMemory_Free( &_connectionSlab, 1, ptr );
 }
 
 /*-----------------------------------------------------------*/
 
 void * IotMqtt_MallocOperation( size_t size )
 {
-    int32_t freeIndex = -1;
     void * pNewOperation = NULL;
 
     /* Check size argument. */
     if( size == sizeof( _mqttOperation_t ) )
     {
-        /* Find a free MQTT operation. */
-        freeIndex = IotStaticMemory_FindFree( _pInUseMqttOperations,
-                                              IOT_MQTT_MAX_IN_PROGRESS_OPERATIONS );
-
-        if( freeIndex != -1 )
-        {
-            pNewOperation = &( _pMqttOperations[ freeIndex ] );
-        }
+        pNewOperation = IotStaticMemory_Alloc( &_operationSlab, 1, size );
     }
 
     return pNewOperation;
@@ -161,47 +174,313 @@ void * IotMqtt_MallocOperation( size_t size )
 void IotMqtt_FreeOperation( void * ptr )
 {
     /* Return the in-use MQTT operation. */
-    IotStaticMemory_ReturnInUse( ptr,
-                                 _pMqttOperations,
-                                 _pInUseMqttOperations,
-                                 IOT_MQTT_MAX_IN_PROGRESS_OPERATIONS,
-                                 sizeof( _mqttOperation_t ) );
+    IotStaticMemory_Free( &_operationSlab, 1, ptr );
 }
 
 /*-----------------------------------------------------------*/
 
 void * IotMqtt_MallocSubscription( size_t size )
 {
-    int32_t freeIndex = -1;
-    void * pNewSubscription = NULL;
+    /* Sizes larger than MQTT_SUBSCRIPTION_SIZE are rejected by the slab. */
+    return IotStaticMemory_Alloc( &_subscriptionSlab, 1, size );
+}
 
-    if( size <= MQTT_SUBSCRIPTION_SIZE )
-    {
-        /* Get the index of a free MQTT subscription. */
-        freeIndex = IotStaticMemory_FindFree( _pInUseMqttSubscriptions,
-                                              IOT_MQTT_SUBSCRIPTIONS );
+/*-----------------------------------------------------------*/
+
+void IotMqtt_FreeSubscription( void * ptr )
+{
+    /* Return the in-use MQTT subscription. */
+    IotStaticMemory_Free( &_subscriptionSlab, 1, ptr );
+}
+
+/*-----------------------------------------------------------*/
+
+void * IotMqtt_MallocTopicNode( size_t size )
+{
+    /* Sizes larger than MQTT_TOPIC_NODE_SIZE are rejected by the slab. */
+    return IotStaticMemory_Alloc( &_topicNodeSlab, 1, size );
+}
+
+/*-----------------------------------------------------------*/
 
-        if( freeIndex != -1 )
+void IotMqtt_FreeTopicNode( void * ptr )
+{
+    /* Return the in-use MQTT topic node. */
+    IotStaticMemory_Free( &_topicNodeSlab, 1, ptr );
+}
+
+/*-----------------------------------------------------------*/
+
+void IotMqtt_GetMemoryStats( IotMqttMemoryStats_t * pStats )
+{
+    IotStaticMemory_GetStats( &_connectionSlab, 1, &( pStats->connections ) );
+    IotStaticMemory_GetStats( &_operationSlab, 1, &( pStats->operations ) );
+    IotStaticMemory_GetStats( &_subscriptionSlab, 1, &( pStats->subscriptions ) );
+    IotStaticMemory_GetStats( &_topicNodeSlab, 1, &( pStats->topicNodes ) );
+
+    /* Received packets are read into the static message buffers, so there is
+     * no receive pool. */
+    ( void ) memset( &( pStats->receivePool ), 0x00, sizeof( IotSlabStats_t ) );
+}
+
+/*-----------------------------------------------------------*/
+
+#else /* if IOT_STATIC_MEMORY_ONLY == 1 */
+
+#if IOT_MQTT_OPERATION_CACHE_SIZE > 0
+
+/**
+ * @brief Guards the operation cache.
+ */
+    static IotMutex_t _operationCacheMutex;
+
+/**
+ * @brief Operations kept for reuse, so that most operations are not taken from
+ * the system heap.
+ */
+    static _mqttOperation_t _pOperationCache[ IOT_MQTT_OPERATION_CACHE_SIZE ];
+
+/**
+ * @brief Free list of the operation cache.
+ */
+    static IotSlab_t _operationSlab = IOT_SLAB_INITIALIZER( _pOperationCache,
+                                                            sizeof( _mqttOperation_t ),
+                                                            IOT_MQTT_OPERATION_CACHE_SIZE );
+#endif /* if IOT_MQTT_OPERATION_CACHE_SIZE > 0 */
+
+#if IOT_MQTT_RECEIVE_POOL_SIZE > 0
+
+/**
+ * @brief The size of each buffer in the receive pool, rounded up so that every
+ * buffer is aligned for the slab's free list.
+ */
+    #define MQTT_RECEIVE_POOL_BLOCK_SIZE \
+        ( ( ( IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE + sizeof( void * ) - 1U ) / sizeof( void * ) ) * sizeof( void * ) )
+
+/**
+ * @brief Guards the receive pool.
+ */
+    static IotMutex_t _receivePoolMutex;
+
+/**
+ * @brief Buffers for received packets, so that most incoming PUBLISH messages
+ * are not read into memory taken from the system heap.
+ */
+    static void * _pReceivePool[ IOT_MQTT_RECEIVE_POOL_SIZE ][ MQTT_RECEIVE_POOL_BLOCK_SIZE / sizeof( void * ) ];
+
+/**
+ * @brief Free list of the receive pool.
+ */
+    static IotSlab_t _receivePoolSlab = IOT_SLAB_INITIALIZER( _pReceivePool,
+                                                              MQTT_RECEIVE_POOL_BLOCK_SIZE,
+                                                              IOT_MQTT_RECEIVE_POOL_SIZE );
+#endif /* if IOT_MQTT_RECEIVE_POOL_SIZE > 0 */
+
+#if MQTT_MEMORY_CACHES == 1
+
+/*-----------------------------------------------------------*/
+
+bool _IotMqtt_InitMemory( void )
+{
+    bool status = true;
+
+    #if IOT_MQTT_OPERATION_CACHE_SIZE > 0
+        status = IotMutex_Create( &_operationCacheMutex, false );
+    #endif
+
+    #if IOT_MQTT_RECEIVE_POOL_SIZE > 0
+        if( status == true )
+        {
+            status = IotMutex_Create( &_receivePoolMutex, false );
+
+            #if IOT_MQTT_OPERATION_CACHE_SIZE > 0
+                if( status == false )
+                {
+                    IotMutex_Destroy( &_operationCacheMutex );
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            #endif
+        }
+        else
         {
-            pNewSubscription = &( _pMqttSubscriptions[ freeIndex ][ 0 ] );
+            EMPTY_ELSE_MARKER;
         }
+    #endif /* if IOT_MQTT_RECEIVE_POOL_SIZE > 0 */
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_CleanupMemory( void )
+{
+    #if IOT_MQTT_OPERATION_CACHE_SIZE > 0
+        IotMutex_Destroy( &_operationCacheMutex );
+    #endif
+
+    #if IOT_MQTT_RECEIVE_POOL_SIZE > 0
+        IotMutex_Destroy( &_receivePoolMutex );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+#endif /* if MQTT_MEMORY_CACHES == 1 */
+
+#if IOT_MQTT_OPERATION_CACHE_SIZE > 0
+
+void * _IotMqtt_MallocOperation( size_t size )
+{
+    void * pNewOperation = NULL;
+
+    if( size == sizeof( _mqttOperation_t ) )
+    {
+        IotMutex_Lock( &_operationCacheMutex );
+        pNewOperation = IotSlab_Alloc( &_operationSlab, 1, size );
+        IotMutex_Unlock( &_operationCacheMutex );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Fall back to the configured allocator when the cache is exhausted. */
+    if( pNewOperation == NULL )
+    {
+        pNewOperation = IotMqtt_MallocOperation( size );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
     }
 
-    return pNewSubscription;
+    return pNewOperation;
 }
 
 /*-----------------------------------------------------------*/
 
-void IotMqtt_FreeSubscription( void * ptr )
+void _IotMqtt_FreeOperation( void * ptr )
 {
-    /* Return the in-use MQTT subscription. */
-    IotStaticMemory_ReturnInUse( ptr,
-                                 _pMqttSubscriptions,
-                                 _pInUseMqttSubscriptions,
-                                 IOT_MQTT_SUBSCRIPTIONS,
-                                 MQTT_SUBSCRIPTION_SIZE );
+    IotSlab_t * pOwner = NULL;
+
+    IotMutex_Lock( &_operationCacheMutex );
+    pOwner = IotSlab_Find( &_operationSlab, 1, ptr );
+
+    if( pOwner != NULL )
+    {
+        IotSlab_Free( pOwner, ptr );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IotMutex_Unlock( &_operationCacheMutex );
+
+    /* Operations that did not come from the cache came from the configured
+     * allocator. */
+    if( pOwner == NULL )
+    {
+        IotMqtt_FreeOperation( ptr );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
 }
 
 /*-----------------------------------------------------------*/
 
-#endif
+#endif /* if IOT_MQTT_OPERATION_CACHE_SIZE > 0 */
+
+#if IOT_MQTT_RECEIVE_POOL_SIZE > 0
+
+void * _IotMqtt_MallocReceiveBuffer( size_t size )
+{
+    void * pBuffer = NULL;
+
+    if( size <= ( size_t ) IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE )
+    {
+        IotMutex_Lock( &_receivePoolMutex );
+        pBuffer = IotSlab_Alloc( &_receivePoolSlab, 1, size );
+        IotMutex_Unlock( &_receivePoolMutex );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Fall back to the configured allocator for large packets or when the
+     * pool is exhausted. */
+    if( pBuffer == NULL )
+    {
+        pBuffer = IotMqtt_MallocMessage( size );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return pBuffer;
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_FreeReceiveBuffer( void * ptr )
+{
+    IotSlab_t * pOwner = NULL;
+
+    IotMutex_Lock( &_receivePoolMutex );
+    pOwner = IotSlab_Find( &_receivePoolSlab, 1, ptr );
+
+    if( pOwner != NULL )
+    {
+        IotSlab_Free( pOwner, ptr );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    IotMutex_Unlock( &_receivePoolMutex );
+
+    /* Buffers that did not come from the pool came from the configured
+     * allocator. */
+    if( pOwner == NULL )
+    {
+        IotMqtt_FreeMessage( ptr );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#endif /* if IOT_MQTT_RECEIVE_POOL_SIZE > 0 */
+
+void IotMqtt_GetMemoryStats( IotMqttMemoryStats_t * pStats )
+{
+    /* Memory taken from the configured allocators is not tracked. */
+    ( void ) memset( pStats, 0x00, sizeof( IotMqttMemoryStats_t ) );
+
+    #if IOT_MQTT_OPERATION_CACHE_SIZE > 0
+        IotMutex_Lock( &_operationCacheMutex );
+        IotSlab_GetStats( &_operationSlab, 1, &( pStats->operations ) );
+        IotMutex_Unlock( &_operationCacheMutex );
+    #endif
+
+    #if IOT_MQTT_RECEIVE_POOL_SIZE > 0
+        IotMutex_Lock( &_receivePoolMutex );
+        IotSlab_GetStats( &_receivePoolSlab, 1, &( pStats->receivePool ) );
+        IotMutex_Unlock( &_receivePoolMutex );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+#endif /* if IOT_STATIC_MEMORY_ONLY == 1 */
@@ -46,15 +46,19 @@
 
 /*-----------------------------------------------------------*/
 
-/**
- * @brief First parameter to #_topicMatch.
- */
-typedef struct _topicMatchParams
-{
-    const char * pTopicName;  /**< @brief The topic name to parse. */
-    uint16_t topicNameLength; /**< @brief Length of #_topicMatchParams_t.pTopicName. */
-    bool exactMatchOnly;      /**< @brief Whether to allow wildcards or require exact matches. */
-} _topicMatchParams_t;
+/* Incoming publishes are matched through the topic trie; the full topic filter
+ * matcher below is kept for the unit tests. */
+#if IOT_BUILD_TESTS == 1
+    /**
+     * @brief First parameter to #_topicMatch.
+     */
+    typedef struct _topicMatchParams
+    {
+        const char * pTopicName;  /**< @brief The topic name to parse. */
+        uint16_t topicNameLength; /**< @brief Length of #_topicMatchParams_t.pTopicName. */
+        bool exactMatchOnly;      /**< @brief Whether to allow wildcards or require exact matches. */
+    } _topicMatchParams_t;
+#endif
 
 /**
  * @brief First parameter to #_packetMatch.
@@ -67,18 +71,20 @@ typedef struct _packetMatchParams
 
 /*-----------------------------------------------------------*/
 
-/**
- * @brief Matches a topic name (from a publish) with a topic filter (from a
- * subscription).
- *
- * @param[in] pSubscriptionLink Pointer to the link member of an #_mqttSubscription_t.
- * @param[in] pMatch Pointer to a #_topicMatchParams_t.
- *
- * @return `true` if the arguments match the subscription topic filter; `false`
- * otherwise.
- */
-static bool _topicMatch( const IotLink_t * pSubscriptionLink,
-                         void * pMatch );
+#if IOT_BUILD_TESTS == 1
+    /**
+     * @brief Matches a topic name (from a publish) with a topic filter (from a
+     * subscription).
+     *
+     * @param[in] pSubscriptionLink Pointer to the link member of an #_mqttSubscription_t.
+     * @param[in] pMatch Pointer to a #_topicMatchParams_t.
+     *
+     * @return `true` if the arguments match the subscription topic filter; `false`
+     * otherwise.
+     */
+    static bool _topicMatch( const IotLink_t * pSubscriptionLink,
+                             void * pMatch );
+#endif
 
 /**
  * @brief Matches a packet identifier and order.
@@ -92,70 +98,213 @@ static bool _topicMatch( const IotLink_t * pSubscriptionLink,
 static bool _packetMatch( const IotLink_t * pSubscriptionLink,
                           void * pMatch );
 
-/*-----------------------------------------------------------*/
+/**
+ * @brief Get the length of the first topic level of a topic name or filter.
+ *
+ * @param[in] pTopic The topic name or filter.
+ * @param[in] topicLength Length of `pTopic`.
+ *
+ * @return The number of characters before the first topic level separator.
+ */
+static uint16_t _topicLevelLength( const char * pTopic,
+                                   uint16_t topicLength );
 
-static bool _topicMatch( const IotLink_t * pSubscriptionLink,
-                         void * pMatch )
-{
-    IOT_FUNCTION_ENTRY( bool, false );
-    uint16_t nameIndex = 0, filterIndex = 0;
+/**
+ * @brief Calculate the hash of a node of the subscription index.
+ *
+ * @param[in] pParent The parent of the node; `NULL` for a first topic level.
+ * @param[in] pLevel The topic level of the node.
+ * @param[in] levelLength Length of `pLevel`.
+ *
+ * @return The hash of `pParent` and `pLevel`.
+ */
+static uint32_t _topicNodeHash( const _mqttTopicNode_t * pParent,
+                                const char * pLevel,
+                                uint16_t levelLength );
 
-    /* Because this function is called from a container function, the given link
-     * must never be NULL. */
-    IotMqtt_Assert( pSubscriptionLink != NULL );
+/**
+ * @brief Find a node of the subscription index.
+ *
+ * @param[in] pMqttConnection The MQTT connection that owns the subscription index.
+ * @param[in] pParent The parent of the node; `NULL` for a first topic level.
+ * @param[in] pLevel The topic level of the node.
+ * @param[in] levelLength Length of `pLevel`.
+ *
+ * @return The node; `NULL` if the node does not exist.
+ */
+static _mqttTopicNode_t * _findTopicNode( _mqttConnection_t * pMqttConnection,
+                                          const _mqttTopicNode_t * pParent,
+                                          const char * pLevel,
+                                          uint16_t levelLength );
 
-    _mqttSubscription_t * pSubscription = IotLink_Container( _mqttSubscription_t,
-                                                             pSubscriptionLink,
-                                                             link );
-    _topicMatchParams_t * pParam = ( _topicMatchParams_t * ) pMatch;
+/**
+ * @brief Find the node of the last topic level of a topic filter in the
+ * subscription index. Wildcards in the topic filter only match the same
+ * wildcards.
+ *
+ * @param[in] pMqttConnection The MQTT connection that owns the subscription index.
+ * @param[in] pTopicFilter The topic filter.
+ * @param[in] topicFilterLength Length of `pTopicFilter`.
+ *
+ * @return The node; `NULL` if the topic filter is not in the subscription index.
+ */
+static _mqttTopicNode_t * _findTopicFilter( _mqttConnection_t * pMqttConnection,
+                                            const char * pTopicFilter,
+                                            uint16_t topicFilterLength );
 
-    /* Extract the relevant strings and lengths from parameters. */
-    const char * pTopicName = pParam->pTopicName;
-    const char * pTopicFilter = pSubscription->pTopicFilter;
-    const uint16_t topicNameLength = pParam->topicNameLength;
-    const uint16_t topicFilterLength = pSubscription->topicFilterLength;
+/**
+ * @brief Add the nodes of a topic filter that are not yet in the subscription
+ * index.
+ *
+ * @param[in] pMqttConnection The MQTT connection that owns the subscription index.
+ * @param[in] pTopicFilter The topic filter.
+ * @param[in] topicFilterLength Length of `pTopicFilter`.
+ *
+ * @return The node of the last topic level of `pTopicFilter`; `NULL` if memory
+ * could not be allocated.
+ */
+static _mqttTopicNode_t * _addTopicFilter( _mqttConnection_t * pMqttConnection,
+                                           const char * pTopicFilter,
+                                           uint16_t topicFilterLength );
 
-    /* Check for an exact match. */
-    if( topicNameLength == topicFilterLength )
-    {
-        status = ( strncmp( pTopicName, pTopicFilter, topicNameLength ) == 0 );
+/**
+ * @brief Free a node of the subscription index and its parents, as long as
+ * they have no subscription, no children and are not in use by a PUBLISH
+ * dispatch.
+ *
+ * @param[in] pNode The node to free. May be `NULL`.
+ */
+static void _pruneTopicNode( _mqttTopicNode_t * pNode );
 
-        IOT_GOTO_CLEANUP();
-    }
-    else
-    {
-        EMPTY_ELSE_MARKER;
-    }
+/**
+ * @brief Invoke the callback of the subscription of a node of the subscription
+ * index, if it has one.
+ *
+ * The subscription mutex must be locked when this function is called. It is
+ * unlocked while the callback runs, so the caller must hold a reference to
+ * `pNode` and all its parents.
+ *
+ * @param[in] pMqttConnection The MQTT connection associated with the received
+ * PUBLISH.
+ * @param[in] pNode The node whose subscription matches the received PUBLISH.
+ * @param[in] pCallbackParam The parameter to pass to a PUBLISH callback.
+ */
+static void _invokeTopicNodeCallback( _mqttConnection_t * pMqttConnection,
+                                      _mqttTopicNode_t * pNode,
+                                      IotMqttCallbackParam_t * pCallbackParam );
 
-    /* If the topic lengths are different but an exact match is required, return
-     * false. */
-    if( pParam->exactMatchOnly == true )
-    {
-        IOT_SET_AND_GOTO_CLEANUP( false );
-    }
-    else
-    {
-        EMPTY_ELSE_MARKER;
-    }
+/**
+ * @brief Invoke the callbacks of all subscriptions below a node of the
+ * subscription index that match the remaining levels of a topic name.
+ *
+ * Only the exact topic level, `+` and `#` are looked up under each node, so the
+ * cost of a search depends on the number of topic levels and not on the number
+ * of subscriptions. This function recurses once per topic level, up to the
+ * number of levels of the longest topic filter.
+ *
+ * The subscription mutex must be locked when this function is called, and the
+ * caller must hold a reference to `pParent` and all its parents.
+ *
+ * @param[in] pMqttConnection The MQTT connection associated with the received
+ * PUBLISH.
+ * @param[in] pParent The node of the topic levels already matched; `NULL` to
+ * start at the first topic level.
+ * @param[in] pLevel The first topic level not yet matched.
+ * @param[in] remainingLength Length of the topic name from `pLevel`.
+ * @param[in] pCallbackParam The parameter to pass to a PUBLISH callback.
+ */
+static void _invokeMatchingCallbacks( _mqttConnection_t * pMqttConnection,
+                                      _mqttTopicNode_t * pParent,
+                                      const char * pLevel,
+                                      uint16_t remainingLength,
+                                      IotMqttCallbackParam_t * pCallbackParam );
+
+/**
+ * @brief Remove a subscription from the subscription index and free it.
+ *
+ * @param[in] pData The subscription to free.
+ */
+static void _freeSubscription( void * pData );
+
+/*-----------------------------------------------------------*/
 
-    while( ( nameIndex < topicNameLength ) && ( filterIndex < topicFilterLength ) )
+#if IOT_BUILD_TESTS == 1
+    static bool _topicMatch( const IotLink_t * pSubscriptionLink,
+                             void * pMatch )
     {
-        /* Check if the character in the topic name matches the corresponding
-         * character in the topic filter string. */
-        if( pTopicName[ nameIndex ] == pTopicFilter[ filterIndex ] )
+        IOT_FUNCTION_ENTRY( bool, false );
+        uint16_t nameIndex = 0, filterIndex = 0;
+
+        /* Because this function is called from a container function, the given link
+         * must never be NULL. */
+        IotMqtt_Assert( pSubscriptionLink != NULL );
+
+        _mqttSubscription_t * pSubscription = IotLink_Container( _mqttSubscription_t,
+                                                                 pSubscriptionLink,
+                                                                 link );
+        _topicMatchParams_t * pParam = ( _topicMatchParams_t * ) pMatch;
+
+        /* Extract the relevant strings and lengths from parameters. */
+        const char * pTopicName = pParam->pTopicName;
+        const char * pTopicFilter = pSubscription->pTopicFilter;
+        const uint16_t topicNameLength = pParam->topicNameLength;
+        const uint16_t topicFilterLength = pSubscription->topicFilterLength;
+
+        /* Check for an exact match. A topic filter with wildcards may have the same
+         * length as a topic name it matches, so a mismatch is only final when an
+         * exact match is required. */
+        if( topicNameLength == topicFilterLength )
         {
-            /* Handle special corner cases as documented by the MQTT protocol spec. */
+            status = ( strncmp( pTopicName, pTopicFilter, topicNameLength ) == 0 );
 
-            /* Filter "sport/#" also matches "sport" since # includes the parent level. */
-            if( nameIndex == topicNameLength - 1 )
+            if( ( status == true ) || ( pParam->exactMatchOnly == true ) )
+            {
+                IOT_GOTO_CLEANUP();
+            }
+            else
             {
-                if( filterIndex == topicFilterLength - 3 )
+                EMPTY_ELSE_MARKER;
+            }
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        /* If the topic lengths are different but an exact match is required, return
+         * false. */
+        if( pParam->exactMatchOnly == true )
+        {
+            IOT_SET_AND_GOTO_CLEANUP( false );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+
+        while( ( nameIndex < topicNameLength ) && ( filterIndex < topicFilterLength ) )
+        {
+            /* Check if the character in the topic name matches the corresponding
+             * character in the topic filter string. */
+            if( pTopicName[ nameIndex ] == pTopicFilter[ filterIndex ] )
+            {
+                /* Handle special corner cases as documented by the MQTT protocol spec. */
+
+                /* Filter "sport/#" also matches "sport" since # includes the parent level. */
+                if( nameIndex == topicNameLength - 1 )
                 {
-                    if( pTopicFilter[ filterIndex + 1 ] == '/' )
+                    if( filterIndex == topicFilterLength - 3 )
                     {
-                        if( pTopicFilter[ filterIndex + 2 ] == '#' )
+                        if( pTopicFilter[ filterIndex + 1 ] == '/' )
                         {
-                            IOT_SET_AND_GOTO_CLEANUP( true );
+                            if( pTopicFilter[ filterIndex + 2 ] == '#' )
+                            {
+                                IOT_SET_AND_GOTO_CLEANUP( true );
+                            }
+                            else
+                            {
+                                EMPTY_ELSE_MARKER;
+                            }
                         }
                         else
                         {
@@ -171,20 +320,20 @@ static bool _topicMatch( const IotLink_t * pSubscriptionLink,
                 {
                     EMPTY_ELSE_MARKER;
                 }
-            }
-            else
-            {
-                EMPTY_ELSE_MARKER;
-            }
 
-            /* Filter "sport/+" also matches the "sport/" but not "sport". */
-            if( nameIndex == topicNameLength - 1 )
-            {
-                if( filterIndex == topicFilterLength - 2 )
+                /* Filter "sport/+" also matches the "sport/" but not "sport". */
+                if( nameIndex == topicNameLength - 1 )
                 {
-                    if( pTopicFilter[ filterIndex + 1 ] == '+' )
+                    if( filterIndex == topicFilterLength - 2 )
                     {
-                        IOT_SET_AND_GOTO_CLEANUP( true );
+                        if( pTopicFilter[ filterIndex + 1 ] == '+' )
+                        {
+                            IOT_SET_AND_GOTO_CLEANUP( true );
+                        }
+                        else
+                        {
+                            EMPTY_ELSE_MARKER;
+                        }
                     }
                     else
                     {
@@ -198,56 +347,52 @@ static bool _topicMatch( const IotLink_t * pSubscriptionLink,
             }
             else
             {
-                EMPTY_ELSE_MARKER;
-            }
-        }
-        else
-        {
-            /* Check for wildcards. */
-            if( pTopicFilter[ filterIndex ] == '+' )
-            {
-                /* Move topic name index to the end of the current level.
-                 * This is identified by '/'. */
-                while( nameIndex < topicNameLength && pTopicName[ nameIndex ] != '/' )
+                /* Check for wildcards. */
+                if( pTopicFilter[ filterIndex ] == '+' )
                 {
-                    nameIndex++;
-                }
+                    /* Move topic name index to the end of the current level.
+                     * This is identified by '/'. */
+                    while( nameIndex < topicNameLength && pTopicName[ nameIndex ] != '/' )
+                    {
+                        nameIndex++;
+                    }
 
-                /* Increment filter index to skip '/'. */
-                filterIndex++;
-                continue;
-            }
-            else if( pTopicFilter[ filterIndex ] == '#' )
-            {
-                /* Subsequent characters don't need to be checked if the for the
-                 * multi-level wildcard. */
-                IOT_SET_AND_GOTO_CLEANUP( true );
-            }
-            else
-            {
-                /* Any character mismatch other than '+' or '#' means the topic
-                 * name does not match the topic filter. */
-                IOT_SET_AND_GOTO_CLEANUP( false );
+                    /* Increment filter index to skip '/'. */
+                    filterIndex++;
+                    continue;
+                }
+                else if( pTopicFilter[ filterIndex ] == '#' )
+                {
+                    /* Subsequent characters don't need to be checked if the for the
+                     * multi-level wildcard. */
+                    IOT_SET_AND_GOTO_CLEANUP( true );
+                }
+                else
+                {
+                    /* Any character mismatch other than '+' or '#' means the topic
+                     * name does not match the topic filter. */
+                    IOT_SET_AND_GOTO_CLEANUP( false );
+                }
             }
+
+            /* Increment indexes. */
+            nameIndex++;
+            filterIndex++;
         }
 
-        /* Increment indexes. */
-        nameIndex++;
-        filterIndex++;
-    }
+        /* If the end of both strings has been reached, they match. */
+        if( ( nameIndex == topicNameLength ) && ( filterIndex == topicFilterLength ) )
+        {
+            IOT_SET_AND_GOTO_CLEANUP( true );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
 
-    /* If the end of both strings has been reached, they match. */
-    if( ( nameIndex == topicNameLength ) && ( filterIndex == topicFilterLength ) )
-    {
-        IOT_SET_AND_GOTO_CLEANUP( true );
+        IOT_FUNCTION_EXIT_NO_CLEANUP();
     }
-    else
-    {
-        EMPTY_ELSE_MARKER;
-    }
-
-    IOT_FUNCTION_EXIT_NO_CLEANUP();
-}
+#endif
 
 /*-----------------------------------------------------------*/
 
@@ -310,135 +455,220 @@ static bool _packetMatch( const IotLink_t * pSubscriptionLink,
 
 /*-----------------------------------------------------------*/
 
-IotMqttError_t _IotMqtt_AddSubscriptions( _mqttConnection_t * pMqttConnection,
-                                          uint16_t subscribePacketIdentifier,
-                                          const IotMqttSubscription_t * pSubscriptionList,
-                                          size_t subscriptionCount )
+static uint16_t _topicLevelLength( const char * pTopic,
+                                   uint16_t topicLength )
+{
+    uint16_t length = 0;
+
+    while( ( length < topicLength ) && ( pTopic[ length ] != '/' ) )
+    {
+        length++;
+    }
+
+    return length;
+}
+
+/*-----------------------------------------------------------*/
+
+static uint32_t _topicNodeHash( const _mqttTopicNode_t * pParent,
+                                const char * pLevel,
+                                uint16_t levelLength )
 {
-    IotMqttError_t status = IOT_MQTT_SUCCESS;
     size_t i = 0;
-    _mqttSubscription_t * pNewSubscription = NULL;
-    IotLink_t * pSubscriptionLink = NULL;
-    _topicMatchParams_t topicMatchParams = { .exactMatchOnly = true };
+    uintptr_t parent = ( uintptr_t ) pParent;
 
-    IotMutex_Lock( &( pMqttConnection->subscriptionMutex ) );
+    /* FNV-1a hash of the parent's address followed by the topic level. */
+    uint32_t hash = 2166136261UL;
 
-    for( i = 0; i < subscriptionCount; i++ )
+    for( i = 0; i < sizeof( uintptr_t ); i++ )
     {
-        /* Check if this topic filter is already registered. */
-        topicMatchParams.pTopicName = pSubscriptionList[ i ].pTopicFilter;
-        topicMatchParams.topicNameLength = pSubscriptionList[ i ].topicFilterLength;
-        pSubscriptionLink = IotListDouble_FindFirstMatch( &( pMqttConnection->subscriptionList ),
-                                                          NULL,
-                                                          _topicMatch,
-                                                          &topicMatchParams );
-
-        if( pSubscriptionLink != NULL )
-        {
-            pNewSubscription = IotLink_Container( _mqttSubscription_t, pSubscriptionLink, link );
+        hash ^= ( uint32_t ) ( parent & 0xffU );
+        hash *= 16777619UL;
+        parent >>= 8;
+    }
 
-            /* The lengths of exactly matching topic filters must match. */
-            IotMqtt_Assert( pNewSubscription->topicFilterLength == pSubscriptionList[ i ].topicFilterLength );
+    for( i = 0; i < levelLength; i++ )
+    {
+        hash ^= ( uint32_t ) ( ( uint8_t ) pLevel[ i ] );
+        hash *= 16777619UL;
+    }
 
-            /* Replace the callback and packet info with the new parameters. */
-            pNewSubscription->callback = pSubscriptionList[ i ].callback;
-            pNewSubscription->packetInfo.identifier = subscribePacketIdentifier;
-            pNewSubscription->packetInfo.order = i;
+    return hash;
+}
+
+/*-----------------------------------------------------------*/
+
+static _mqttTopicNode_t * _findTopicNode( _mqttConnection_t * pMqttConnection,
+                                          const _mqttTopicNode_t * pParent,
+                                          const char * pLevel,
+                                          uint16_t levelLength )
+{
+    _mqttTopicNode_t * pNode = NULL, * pFoundNode = NULL;
+    IotLink_t * pLink = NULL;
+    const uint32_t hash = _topicNodeHash( pParent, pLevel, levelLength );
+    const IotListDouble_t * pBucket =
+        &( pMqttConnection->subscriptionIndex[ hash % IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS ] );
+
+    IotContainers_ForEach( pBucket, pLink )
+    {
+        pNode = IotLink_Container( _mqttTopicNode_t, pLink, link );
+
+        /* Compare the full hash first; it rules out almost all other nodes in
+         * the bucket. */
+        if( ( pNode->hash == hash ) &&
+            ( pNode->pParent == pParent ) &&
+            ( pNode->levelLength == levelLength ) &&
+            ( memcmp( pNode->pLevel, pLevel, levelLength ) == 0 ) )
+        {
+            pFoundNode = pNode;
+            break;
         }
         else
         {
-            /* Allocate memory for a new subscription. */
-            pNewSubscription = IotMqtt_MallocSubscription( sizeof( _mqttSubscription_t ) +
-                                                           pSubscriptionList[ i ].topicFilterLength );
+            EMPTY_ELSE_MARKER;
+        }
+    }
 
-            if( pNewSubscription == NULL )
+    return pFoundNode;
+}
+
+/*-----------------------------------------------------------*/
+
+static _mqttTopicNode_t * _findTopicFilter( _mqttConnection_t * pMqttConnection,
+                                            const char * pTopicFilter,
+                                            uint16_t topicFilterLength )
+{
+    _mqttTopicNode_t * pNode = NULL;
+    uint16_t levelLength = 0;
+    uint32_t offset = 0;
+
+    /* Follow the topic levels of the topic filter from the first level. A
+     * trailing '/' is followed by an empty topic level. */
+    do
+    {
+        levelLength = _topicLevelLength( pTopicFilter + offset,
+                                         ( uint16_t ) ( topicFilterLength - offset ) );
+        pNode = _findTopicNode( pMqttConnection,
+                                pNode,
+                                pTopicFilter + offset,
+                                levelLength );
+        offset += ( uint32_t ) levelLength + 1U;
+    } while( ( pNode != NULL ) && ( offset <= topicFilterLength ) );
+
+    return pNode;
+}
+
+/*-----------------------------------------------------------*/
+
+static _mqttTopicNode_t * _addTopicFilter( _mqttConnection_t * pMqttConnection,
+                                           const char * pTopicFilter,
+                                           uint16_t topicFilterLength )
+{
+    _mqttTopicNode_t * pParent = NULL, * pNode = NULL;
+    uint16_t levelLength = 0;
+    uint32_t offset = 0;
+
+    do
+    {
+        levelLength = _topicLevelLength( pTopicFilter + offset,
+                                         ( uint16_t ) ( topicFilterLength - offset ) );
+        pNode = _findTopicNode( pMqttConnection,
+                                pParent,
+                                pTopicFilter + offset,
+                                levelLength );
+
+        if( pNode == NULL )
+        {
+            pNode = IotMqtt_MallocTopicNode( sizeof( _mqttTopicNode_t ) + levelLength );
+
+            if( pNode == NULL )
             {
-                status = IOT_MQTT_NO_MEMORY;
+                /* Free the nodes added for this topic filter. */
+                _pruneTopicNode( pParent );
                 break;
             }
             else
             {
-                /* Clear the new subscription. */
-                ( void ) memset( pNewSubscription,
-                                 0x00,
-                                 sizeof( _mqttSubscription_t ) + pSubscriptionList[ i ].topicFilterLength );
+                EMPTY_ELSE_MARKER;
+            }
 
-                /* Set the members of the new subscription and add it to the list. */
-                pNewSubscription->packetInfo.identifier = subscribePacketIdentifier;
-                pNewSubscription->packetInfo.order = i;
-                pNewSubscription->callback = pSubscriptionList[ i ].callback;
-                pNewSubscription->topicFilterLength = pSubscriptionList[ i ].topicFilterLength;
-                ( void ) memcpy( pNewSubscription->pTopicFilter,
-                                 pSubscriptionList[ i ].pTopicFilter,
-                                 ( size_t ) ( pSubscriptionList[ i ].topicFilterLength ) );
+            ( void ) memset( pNode, 0x00, sizeof( _mqttTopicNode_t ) );
+            pNode->pParent = pParent;
+            pNode->hash = _topicNodeHash( pParent, pTopicFilter + offset, levelLength );
+            pNode->levelLength = levelLength;
+            ( void ) memcpy( pNode->pLevel, pTopicFilter + offset, levelLength );
 
-                IotListDouble_InsertHead( &( pMqttConnection->subscriptionList ),
-                                          &( pNewSubscription->link ) );
+            IotListDouble_InsertHead( &( pMqttConnection->subscriptionIndex[ pNode->hash % IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS ] ),
+                                      &( pNode->link ) );
+
+            if( pParent != NULL )
+            {
+                ( pParent->children )++;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
             }
         }
-    }
-
-    IotMutex_Unlock( &( pMqttConnection->subscriptionMutex ) );
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
 
-    /* If memory allocation failed, remove all previously added subscriptions. */
-    if( status != IOT_MQTT_SUCCESS )
-    {
-        _IotMqtt_RemoveSubscriptionByTopicFilter( pMqttConnection,
-                                                  pSubscriptionList,
-                                                  i );
-    }
-    else
-    {
-        EMPTY_ELSE_MARKER;
-    }
+        pParent = pNode;
+        offset += ( uint32_t ) levelLength + 1U;
+    } while( offset <= topicFilterLength );
 
-    return status;
+    return pNode;
 }
 
 /*-----------------------------------------------------------*/
 
-void _IotMqtt_InvokeSubscriptionCallback( _mqttConnection_t * pMqttConnection,
-                                          IotMqttCallbackParam_t * pCallbackParam )
+static void _pruneTopicNode( _mqttTopicNode_t * pNode )
 {
-    _mqttSubscription_t * pSubscription = NULL;
-    IotLink_t * pCurrentLink = NULL, * pNextLink = NULL;
-    void * pCallbackContext = NULL;
+    _mqttTopicNode_t * pParent = NULL;
 
-    void ( * callbackFunction )( void *,
-                                 IotMqttCallbackParam_t * ) = NULL;
-    _topicMatchParams_t topicMatchParams =
+    while( ( pNode != NULL ) &&
+           ( pNode->pSubscription == NULL ) &&
+           ( pNode->children == 0U ) &&
+           ( pNode->references == 0U ) )
     {
-        .pTopicName      = pCallbackParam->u.message.info.pTopicName,
-        .topicNameLength = pCallbackParam->u.message.info.topicNameLength,
-        .exactMatchOnly  = false
-    };
-
-    /* Prevent any other thread from modifying the subscription list while this
-     * function is searching. */
-    IotMutex_Lock( &( pMqttConnection->subscriptionMutex ) );
+        pParent = pNode->pParent;
 
-    /* Search the subscription list for all matching subscriptions starting at
-     * the list head. */
-    while( true )
-    {
-        pCurrentLink = IotListDouble_FindFirstMatch( &( pMqttConnection->subscriptionList ),
-                                                     pCurrentLink,
-                                                     _topicMatch,
-                                                     &topicMatchParams );
+        IotListDouble_Remove( &( pNode->link ) );
 
-        /* No subscription found. Exit loop. */
-        if( pCurrentLink == NULL )
+        if( pParent != NULL )
         {
-            break;
+            IotMqtt_Assert( pParent->children > 0U );
+            ( pParent->children )--;
         }
         else
         {
             EMPTY_ELSE_MARKER;
         }
 
-        /* Subscription found. Calculate pointer to subscription object. */
-        pSubscription = IotLink_Container( _mqttSubscription_t, pCurrentLink, link );
+        IotMqtt_FreeTopicNode( pNode );
+        pNode = pParent;
+    }
+}
 
+/*-----------------------------------------------------------*/
+
+static void _invokeTopicNodeCallback( _mqttConnection_t * pMqttConnection,
+                                      _mqttTopicNode_t * pNode,
+                                      IotMqttCallbackParam_t * pCallbackParam )
+{
+    _mqttSubscription_t * pSubscription = pNode->pSubscription;
+    void * pCallbackContext = NULL;
+
+    void ( * callbackFunction )( void *,
+                                 IotMqttCallbackParam_t * ) = NULL;
+
+    /* The caller holds a reference to this node. */
+    IotMqtt_Assert( pNode->references > 0U );
+
+    if( pSubscription != NULL )
+    {
         /* Subscription validation should not have allowed a NULL callback function. */
         IotMqtt_Assert( pSubscription->callback.function != NULL );
 
@@ -468,15 +698,14 @@ void _IotMqtt_InvokeSubscriptionCallback( _mqttConnection_t * pMqttConnection,
         ( pSubscription->references )--;
         IotMqtt_Assert( pSubscription->references >= 0 );
 
-        /* Save the pointer to the next link in case this subscription is freed. */
-        pNextLink = pCurrentLink->pNext;
-
         /* Remove this subscription if it has no references and the unsubscribed
          * flag is set. */
         if( pSubscription->unsubscribed == true )
         {
-            /* An unsubscribed subscription should have been removed from the list. */
+            /* An unsubscribed subscription should have been removed from the list
+             * and the index. */
             IotMqtt_Assert( IotLink_IsLinked( &( pSubscription->link ) ) == false );
+            IotMqtt_Assert( pSubscription->pTopicNode == NULL );
 
             /* Free subscriptions with no references. */
             if( pSubscription->references == 0 )
@@ -492,14 +721,233 @@ void _IotMqtt_InvokeSubscriptionCallback( _mqttConnection_t * pMqttConnection,
         {
             EMPTY_ELSE_MARKER;
         }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _invokeMatchingCallbacks( _mqttConnection_t * pMqttConnection,
+                                      _mqttTopicNode_t * pParent,
+                                      const char * pLevel,
+                                      uint16_t remainingLength,
+                                      IotMqttCallbackParam_t * pCallbackParam )
+{
+    size_t i = 0;
+    _mqttTopicNode_t * pNode = NULL, * pMultiLevelNode = NULL;
+    const uint16_t levelLength = _topicLevelLength( pLevel, remainingLength );
+    const bool lastLevel = ( levelLength == remainingLength );
+    const bool wildcardLevel = ( levelLength == 1U ) &&
+                               ( ( pLevel[ 0 ] == '+' ) || ( pLevel[ 0 ] == '#' ) );
+
+    /* A multi-level wildcard matches this topic level and all after it. */
+    pNode = _findTopicNode( pMqttConnection, pParent, "#", 1 );
+
+    if( pNode != NULL )
+    {
+        ( pNode->references )++;
+        _invokeTopicNodeCallback( pMqttConnection, pNode, pCallbackParam );
+        ( pNode->references )--;
+        _pruneTopicNode( pNode );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    /* Search below the exact topic level, then below a single-level wildcard.
+     * The nodes are looked up again after every callback, as a callback may
+     * change the subscriptions. */
+    for( i = 0; i < 2; i++ )
+    {
+        if( i == 0 )
+        {
+            /* Topic names should not contain wildcards; never match one as
+             * both the exact level and the wildcard. */
+            pNode = ( wildcardLevel == true ) ? NULL :
+                    _findTopicNode( pMqttConnection, pParent, pLevel, levelLength );
+        }
+        else
+        {
+            pNode = _findTopicNode( pMqttConnection, pParent, "+", 1 );
+        }
+
+        if( pNode != NULL )
+        {
+            /* Keep this node while the subscription mutex is unlocked for
+             * callbacks. */
+            ( pNode->references )++;
+
+            if( lastLevel == true )
+            {
+                _invokeTopicNodeCallback( pMqttConnection, pNode, pCallbackParam );
+
+                /* Filter "sport/#" also matches "sport" since # includes the
+                 * parent level. */
+                pMultiLevelNode = _findTopicNode( pMqttConnection, pNode, "#", 1 );
+
+                if( pMultiLevelNode != NULL )
+                {
+                    ( pMultiLevelNode->references )++;
+                    _invokeTopicNodeCallback( pMqttConnection, pMultiLevelNode, pCallbackParam );
+                    ( pMultiLevelNode->references )--;
+                    _pruneTopicNode( pMultiLevelNode );
+                }
+                else
+                {
+                    EMPTY_ELSE_MARKER;
+                }
+            }
+            else
+            {
+                _invokeMatchingCallbacks( pMqttConnection,
+                                          pNode,
+                                          pLevel + levelLength + 1,
+                                          ( uint16_t ) ( remainingLength - levelLength - 1U ),
+                                          pCallbackParam );
+            }
+
+            ( pNode->references )--;
+            _pruneTopicNode( pNode );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void _freeSubscription( void * pData )
+{
+    _mqttSubscription_t * pSubscription = ( _mqttSubscription_t * ) pData;
+
+    _IotMqtt_RemoveSubscriptionFromIndex( pSubscription );
+    IotMqtt_FreeSubscription( pSubscription );
+}
+
+/*-----------------------------------------------------------*/
+
+IotMqttError_t _IotMqtt_AddSubscriptions( _mqttConnection_t * pMqttConnection,
+                                          uint16_t subscribePacketIdentifier,
+                                          const IotMqttSubscription_t * pSubscriptionList,
+                                          size_t subscriptionCount )
+{
+    IotMqttError_t status = IOT_MQTT_SUCCESS;
+    size_t i = 0;
+    _mqttSubscription_t * pNewSubscription = NULL;
+    _mqttTopicNode_t * pTopicNode = NULL;
+
+    IotMutex_Lock( &( pMqttConnection->subscriptionMutex ) );
+
+    for( i = 0; i < subscriptionCount; i++ )
+    {
+        /* Check if this topic filter is already registered. */
+        pTopicNode = _findTopicFilter( pMqttConnection,
+                                       pSubscriptionList[ i ].pTopicFilter,
+                                       pSubscriptionList[ i ].topicFilterLength );
+
+        if( ( pTopicNode != NULL ) && ( pTopicNode->pSubscription != NULL ) )
+        {
+            pNewSubscription = pTopicNode->pSubscription;
+
+            /* The lengths of exactly matching topic filters must match. */
+            IotMqtt_Assert( pNewSubscription->topicFilterLength == pSubscriptionList[ i ].topicFilterLength );
+
+            /* Replace the callback and packet info with the new parameters. */
+            pNewSubscription->callback = pSubscriptionList[ i ].callback;
+            pNewSubscription->packetInfo.identifier = subscribePacketIdentifier;
+            pNewSubscription->packetInfo.order = i;
+        }
+        else
+        {
+            /* Allocate memory for a new subscription. */
+            pNewSubscription = IotMqtt_MallocSubscription( sizeof( _mqttSubscription_t ) +
+                                                           pSubscriptionList[ i ].topicFilterLength );
+
+            if( pNewSubscription == NULL )
+            {
+                status = IOT_MQTT_NO_MEMORY;
+                break;
+            }
+            else
+            {
+                EMPTY_ELSE_MARKER;
+            }
+
+            /* Add the topic levels of the new subscription to the index. */
+            pTopicNode = _addTopicFilter( pMqttConnection,
+                                          pSubscriptionList[ i ].pTopicFilter,
+                                          pSubscriptionList[ i ].topicFilterLength );
+
+            if( pTopicNode == NULL )
+            {
+                IotMqtt_FreeSubscription( pNewSubscription );
+                status = IOT_MQTT_NO_MEMORY;
+                break;
+            }
+            else
+            {
+                /* Clear the new subscription. */
+                ( void ) memset( pNewSubscription,
+                                 0x00,
+                                 sizeof( _mqttSubscription_t ) + pSubscriptionList[ i ].topicFilterLength );
+
+                /* Set the members of the new subscription and add it to the list. */
+                pNewSubscription->packetInfo.identifier = subscribePacketIdentifier;
+                pNewSubscription->packetInfo.order = i;
+                pNewSubscription->callback = pSubscriptionList[ i ].callback;
+                pNewSubscription->topicFilterLength = pSubscriptionList[ i ].topicFilterLength;
+                ( void ) memcpy( pNewSubscription->pTopicFilter,
+                                 pSubscriptionList[ i ].pTopicFilter,
+                                 ( size_t ) ( pSubscriptionList[ i ].topicFilterLength ) );
 
-        /* Move current link pointer. */
-        pCurrentLink = pNextLink;
+                IotListDouble_InsertHead( &( pMqttConnection->subscriptionList ),
+                                          &( pNewSubscription->link ) );
+
+                pNewSubscription->pTopicNode = pTopicNode;
+                pTopicNode->pSubscription = pNewSubscription;
+            }
+        }
     }
 
     IotMutex_Unlock( &( pMqttConnection->subscriptionMutex ) );
 
-    _IotMqtt_DecrementConnectionReferences( pMqttConnection );
+    /* If memory allocation failed, remove all previously added subscriptions. */
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        _IotMqtt_RemoveSubscriptionByTopicFilter( pMqttConnection,
+                                                  pSubscriptionList,
+                                                  i );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void _IotMqtt_InvokeSubscriptionCallback( _mqttConnection_t * pMqttConnection,
+                                          IotMqttCallbackParam_t * pCallbackParam )
+{
+    /* Prevent any other thread from modifying the subscription list while this
+     * function is searching. */
+    IotMutex_Lock( &( pMqttConnection->subscriptionMutex ) );
+
+    _invokeMatchingCallbacks( pMqttConnection,
+                              NULL,
+                              pCallbackParam->u.message.info.pTopicName,
+                              pCallbackParam->u.message.info.topicNameLength,
+                              pCallbackParam );
+
+    IotMutex_Unlock( &( pMqttConnection->subscriptionMutex ) );
 }
 
 /*-----------------------------------------------------------*/
@@ -518,7 +966,7 @@ void _IotMqtt_RemoveSubscriptionByPacket( _mqttConnection_t * pMqttConnection,
     IotListDouble_RemoveAllMatches( &( pMqttConnection->subscriptionList ),
                                     _packetMatch,
                                     ( void * ) ( &packetMatchParams ),
-                                    IotMqtt_FreeSubscription,
+                                    _freeSubscription,
                                     offsetof( _mqttSubscription_t, link ) );
     IotMutex_Unlock( &( pMqttConnection->subscriptionMutex ) );
 }
@@ -531,8 +979,7 @@ void _IotMqtt_RemoveSubscriptionByTopicFilter( _mqttConnection_t * pMqttConnecti
 {
     size_t i = 0;
     _mqttSubscription_t * pSubscription = NULL;
-    IotLink_t * pSubscriptionLink = NULL;
-    _topicMatchParams_t topicMatchParams = { 0 };
+    _mqttTopicNode_t * pTopicNode = NULL;
 
     /* Prevent any other thread from modifying the subscription list while this
      * function is running. */
@@ -541,24 +988,20 @@ void _IotMqtt_RemoveSubscriptionByTopicFilter( _mqttConnection_t * pMqttConnecti
     /* Find and remove each topic filter from the list. */
     for( i = 0; i < subscriptionCount; i++ )
     {
-        topicMatchParams.pTopicName = pSubscriptionList[ i ].pTopicFilter;
-        topicMatchParams.topicNameLength = pSubscriptionList[ i ].topicFilterLength;
-        topicMatchParams.exactMatchOnly = true;
-
-        pSubscriptionLink = IotListDouble_FindFirstMatch( &( pMqttConnection->subscriptionList ),
-                                                          NULL,
-                                                          _topicMatch,
-                                                          &topicMatchParams );
+        pTopicNode = _findTopicFilter( pMqttConnection,
+                                       pSubscriptionList[ i ].pTopicFilter,
+                                       pSubscriptionList[ i ].topicFilterLength );
 
-        if( pSubscriptionLink != NULL )
+        if( ( pTopicNode != NULL ) && ( pTopicNode->pSubscription != NULL ) )
         {
-            pSubscription = IotLink_Container( _mqttSubscription_t, pSubscriptionLink, link );
+            pSubscription = pTopicNode->pSubscription;
 
             /* Reference count must not be negative. */
             IotMqtt_Assert( pSubscription->references >= 0 );
 
-            /* Remove subscription from list. */
-            IotListDouble_Remove( pSubscriptionLink );
+            /* Remove subscription from list and index. */
+            IotListDouble_Remove( &( pSubscription->link ) );
+            _IotMqtt_RemoveSubscriptionFromIndex( pSubscription );
 
             /* Check the reference count. This subscription cannot be removed if
              * there are subscription callbacks using it. */
@@ -585,6 +1028,28 @@ void _IotMqtt_RemoveSubscriptionByTopicFilter( _mqttConnection_t * pMqttConnecti
 
 /*-----------------------------------------------------------*/
 
+void _IotMqtt_RemoveSubscriptionFromIndex( _mqttSubscription_t * pSubscription )
+{
+    _mqttTopicNode_t * pTopicNode = pSubscription->pTopicNode;
+
+    if( pTopicNode != NULL )
+    {
+        IotMqtt_Assert( pTopicNode->pSubscription == pSubscription );
+
+        pTopicNode->pSubscription = NULL;
+        pSubscription->pTopicNode = NULL;
+
+        /* Free the topic levels that no other subscription uses. */
+        _pruneTopicNode( pTopicNode );
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
 bool IotMqtt_IsSubscribed( IotMqttConnection_t mqttConnection,
                            const char * pTopicFilter,
                            uint16_t topicFilterLength,
@@ -592,28 +1057,19 @@ bool IotMqtt_IsSubscribed( IotMqttConnection_t mqttConnection,
 {
     bool status = false;
     _mqttSubscription_t * pSubscription = NULL;
-    IotLink_t * pSubscriptionLink = NULL;
-    _topicMatchParams_t topicMatchParams =
-    {
-        .pTopicName      = pTopicFilter,
-        .topicNameLength = topicFilterLength,
-        .exactMatchOnly  = true
-    };
+    _mqttTopicNode_t * pTopicNode = NULL;
 
     /* Prevent any other thread from modifying the subscription list while this
      * function is running. */
     IotMutex_Lock( &( mqttConnection->subscriptionMutex ) );
 
     /* Search for a matching subscription. */
-    pSubscriptionLink = IotListDouble_FindFirstMatch( &( mqttConnection->subscriptionList ),
-                                                      NULL,
-                                                      _topicMatch,
-                                                      &topicMatchParams );
+    pTopicNode = _findTopicFilter( mqttConnection, pTopicFilter, topicFilterLength );
 
     /* Check if a matching subscription was found. */
-    if( pSubscriptionLink != NULL )
+    if( ( pTopicNode != NULL ) && ( pTopicNode->pSubscription != NULL ) )
     {
-        pSubscription = IotLink_Container( _mqttSubscription_t, pSubscriptionLink, link );
+        pSubscription = pTopicNode->pSubscription;
 
         /* Copy the matching subscription to the output parameter. */
         if( pCurrentSubscription != NULL )
@@ -128,6 +128,41 @@ bool _IotMqtt_ValidateConnect( const IotMqttConnectInfo_t * pConnectInfo )
         EMPTY_ELSE_MARKER;
     }
 
+    /* Check the outbox of a persistent session. */
+    if( ( pConnectInfo->cleanSession == false ) && ( pConnectInfo->pOutbox != NULL ) )
+    {
+        if( pConnectInfo->pOutbox->pInterface == NULL )
+        {
+            IotLogError( "Outbox interface cannot be NULL." );
+
+            IOT_SET_AND_GOTO_CLEANUP( false );
+        }
+        else if( ( pConnectInfo->pOutbox->pInterface->append == NULL ) ||
+                 ( pConnectInfo->pOutbox->pInterface->read == NULL ) ||
+                 ( pConnectInfo->pOutbox->pInterface->remove == NULL ) ||
+                 ( pConnectInfo->pOutbox->pInterface->range == NULL ) )
+        {
+            IotLogError( "Outbox interface is missing a function." );
+
+            IOT_SET_AND_GOTO_CLEANUP( false );
+        }
+        else if( pConnectInfo->pOutbox->segmentSize <= MQTT_OUTBOX_RECORD_OVERHEAD )
+        {
+            IotLogError( "Outbox segment size must be greater than %d.",
+                         MQTT_OUTBOX_RECORD_OVERHEAD );
+
+            IOT_SET_AND_GOTO_CLEANUP( false );
+        }
+        else
+        {
+            EMPTY_ELSE_MARKER;
+        }
+    }
+    else
+    {
+        EMPTY_ELSE_MARKER;
+    }
+
     /* Check for compatibility with the AWS IoT MQTT service limits. */
     if( pConnectInfo->awsIotMqttMode == true )
     {
@@ -138,6 +138,20 @@
  * (http://pubs.opengroup.org/onlinepubs/9699919799/functions/free.html).
  */
     void IotMqtt_FreeSubscription( void * ptr );
+
+/**
+ * @brief Allocate an #_mqttTopicNode_t. This function should have the
+ * same signature as [malloc]
+ * (http://pubs.opengroup.org/onlinepubs/9699919799/functions/malloc.html).
+ */
+    void * IotMqtt_MallocTopicNode( size_t size );
+
+/**
+ * @brief Free an #_mqttTopicNode_t. This function should have the same
+ * signature as [free]
+ * (http://pubs.opengroup.org/onlinepubs/9699919799/functions/free.html).
+ */
+    void IotMqtt_FreeTopicNode( void * ptr );
 #else /* if IOT_STATIC_MEMORY_ONLY == 1 */
     #include <stdlib.h>
 
@@ -172,8 +186,114 @@
     #ifndef IotMqtt_FreeSubscription
         #define IotMqtt_FreeSubscription    free
     #endif
+
+    #ifndef IotMqtt_MallocTopicNode
+        #define IotMqtt_MallocTopicNode    malloc
+    #endif
+
+    #ifndef IotMqtt_FreeTopicNode
+        #define IotMqtt_FreeTopicNode    free
+    #endif
 #endif /* if IOT_STATIC_MEMORY_ONLY == 1 */
 
+/**
+ * @cond DOXYGEN_IGNORE
+ * Doxygen should ignore this section.
+ *
+ * Provide default values for the operation cache and receive pool sizes.
+ */
+#ifndef IOT_MQTT_OPERATION_CACHE_SIZE
+    #define IOT_MQTT_OPERATION_CACHE_SIZE        ( 0 )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_SIZE
+    #define IOT_MQTT_RECEIVE_POOL_SIZE           ( 4 )
+#endif
+#ifndef IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE
+    #define IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE    ( 256 )
+#endif
+/** @endcond */
+
+#if IOT_MQTT_OPERATION_CACHE_SIZE < 0
+    #error "IOT_MQTT_OPERATION_CACHE_SIZE cannot be negative."
+#endif
+#if IOT_MQTT_RECEIVE_POOL_SIZE < 0
+    #error "IOT_MQTT_RECEIVE_POOL_SIZE cannot be negative."
+#endif
+#if IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE <= 0
+    #error "IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE cannot be 0 or negative."
+#endif
+
+/**
+ * @brief Whether the operation cache or the receive pool is in use. Static
+ * memory has no need for either.
+ */
+#if ( IOT_STATIC_MEMORY_ONLY != 1 ) && \
+    ( ( IOT_MQTT_OPERATION_CACHE_SIZE > 0 ) || ( IOT_MQTT_RECEIVE_POOL_SIZE > 0 ) )
+    #define MQTT_MEMORY_CACHES    ( 1 )
+#else
+    #define MQTT_MEMORY_CACHES    ( 0 )
+#endif
+
+/*
+ * The MQTT library allocates operations through these functions, which use the
+ * operation cache when it is enabled.
+ */
+#if ( IOT_STATIC_MEMORY_ONLY != 1 ) && ( IOT_MQTT_OPERATION_CACHE_SIZE > 0 )
+
+/**
+ * @brief Allocate an #_mqttOperation_t from the operation cache, or with
+ * #IotMqtt_MallocOperation if the cache is exhausted.
+ */
+    void * _IotMqtt_MallocOperation( size_t size );
+
+/**
+ * @brief Free an #_mqttOperation_t allocated by #_IotMqtt_MallocOperation.
+ */
+    void _IotMqtt_FreeOperation( void * ptr );
+#else
+    #define _IotMqtt_MallocOperation    IotMqtt_MallocOperation
+    #define _IotMqtt_FreeOperation      IotMqtt_FreeOperation
+#endif
+
+/*
+ * The MQTT library allocates buffers for received packets through these
+ * functions, which use the receive pool when it is enabled.
+ */
+#if ( IOT_STATIC_MEMORY_ONLY != 1 ) && ( IOT_MQTT_RECEIVE_POOL_SIZE > 0 )
+
+/**
+ * @brief Allocate a buffer for a received packet from the receive pool, or
+ * with #IotMqtt_MallocMessage if the packet is too large or the pool is
+ * exhausted.
+ */
+    void * _IotMqtt_MallocReceiveBuffer( size_t size );
+
+/**
+ * @brief Free a buffer allocated by #_IotMqtt_MallocReceiveBuffer.
+ */
+    void _IotMqtt_FreeReceiveBuffer( void * ptr );
+#else
+    #define _IotMqtt_MallocReceiveBuffer    IotMqtt_MallocMessage
+    #define _IotMqtt_FreeReceiveBuffer      IotMqtt_FreeMessage
+#endif
+
+#if MQTT_MEMORY_CACHES == 1
+
+/**
+ * @brief Create the mutexes that guard the operation cache and the receive
+ * pool. Called by @ref mqtt_function_init.
+ *
+ * @return `true` if the mutexes were created; `false` otherwise.
+ */
+    bool _IotMqtt_InitMemory( void );
+
+/**
+ * @brief Destroy the mutexes created by #_IotMqtt_InitMemory. Called by
+ * @ref mqtt_function_cleanup.
+ */
+    void _IotMqtt_CleanupMemory( void );
+#endif
+
 /**
  * @cond DOXYGEN_IGNORE
  * Doxygen should ignore this section.
@@ -192,8 +312,65 @@
 #ifndef IOT_MQTT_RETRY_MS_CEILING
     #define IOT_MQTT_RETRY_MS_CEILING               ( 60000 )
 #endif
+#ifndef IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS
+    #define IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS      ( 64 )
+#endif
+#ifndef IOT_MQTT_INFLIGHT_WINDOW
+    #define IOT_MQTT_INFLIGHT_WINDOW                ( 32 )
+#endif
+#ifndef IOT_MQTT_SEND_COALESCE_SIZE
+    #define IOT_MQTT_SEND_COALESCE_SIZE             ( 128 )
+#endif
+#ifndef IOT_MQTT_OUTBOX_SEGMENTS
+    #define IOT_MQTT_OUTBOX_SEGMENTS                ( 8 )
+#endif
 /** @endcond */
 
+/* Validate the subscription index configuration. */
+#if IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS <= 0
+    #error "IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS cannot be 0 or negative."
+#endif
+
+/* Validate the in-flight window configuration. */
+#if IOT_MQTT_INFLIGHT_WINDOW <= 0
+    #error "IOT_MQTT_INFLIGHT_WINDOW cannot be 0 or negative."
+#endif
+
+/* Validate the send coalescing configuration. */
+#if IOT_MQTT_SEND_COALESCE_SIZE <= 0
+    #error "IOT_MQTT_SEND_COALESCE_SIZE cannot be 0 or negative."
+#endif
+
+/* Validate the outbox configuration. */
+#if IOT_MQTT_OUTBOX_SEGMENTS < 2
+    #error "IOT_MQTT_OUTBOX_SEGMENTS cannot be less than 2."
+#endif
+
+/**
+ * @brief Number of buckets in an MQTT connection's in-flight table.
+ *
+ * Packet identifiers are generated in sequence, so operations in flight are
+ * spread evenly over the buckets.
+ */
+#define MQTT_INFLIGHT_BUCKETS    ( 2 * IOT_MQTT_INFLIGHT_WINDOW )
+
+/**
+ * @brief Number of PUBACKs an MQTT connection can hold for its send queue
+ * writer. Must be a power of 2.
+ *
+ * When the queue is full, the network receive callback sends its PUBACK
+ * directly, ahead of the queued PUBACKs. It must not wait for room: the send
+ * queue writer may itself be waiting for a task pool worker that is blocked
+ * until the receive callback delivers another packet.
+ */
+#define MQTT_PUBACK_QUEUE_SIZE      ( 16 )
+
+/**
+ * @brief Bytes added to the data of every record in an outbox: a type byte,
+ * a 4-byte sequence number, a 4-byte data length, and a 4-byte CRC.
+ */
+#define MQTT_OUTBOX_RECORD_OVERHEAD    ( 13 )
+
 /**
  * @brief Marks the empty statement of an `else` branch.
  *
@@ -247,6 +424,51 @@
 
 /*---------------------- MQTT internal data structures ----------------------*/
 
+/**
+ * @brief An entry in an MQTT connection's in-flight table.
+ *
+ * Maps the packet identifier of a packet awaiting a PUBACK, SUBACK, or UNSUBACK
+ * to the operation that sent it. An entry is unused when its operation is `NULL`.
+ */
+typedef struct _mqttInflight
+{
+    IotLink_t link;                      /**< @brief Link in a bucket of the in-flight table. */
+    uint16_t packetIdentifier;           /**< @brief Packet identifier awaiting a PUBACK. */
+    struct _mqttOperation * pOperation;  /**< @brief The operation that sent the packet. */
+} _mqttInflight_t;
+
+/**
+ * @brief The state of an MQTT connection's persistent outbox.
+ *
+ * Segments from #_mqttOutbox_t.firstSegment to #_mqttOutbox_t.lastSegment
+ * may hold unacknowledged PUBLISH messages; records are only appended to
+ * #_mqttOutbox_t.lastSegment. Protected by #_mqttOutbox_t.mutex.
+ */
+typedef struct _mqttOutbox
+{
+    const IotMqttOutboxInterface_t * pInterface; /**< @brief Storage functions; `NULL` if the connection has no outbox. */
+    void * pStorage;                             /**< @brief Passed to the storage functions. */
+    size_t segmentSize;                          /**< @brief The largest size of a segment. */
+    IotMutex_t mutex;                            /**< @brief Serializes access to storage. */
+
+    uint32_t nextSequence;                       /**< @brief Sequence number of the next persisted PUBLISH. */
+    uint32_t firstSegment;                       /**< @brief The oldest segment in storage. */
+    uint32_t lastSegment;                        /**< @brief The segment that records are appended to. */
+    size_t lastSegmentSize;                      /**< @brief Bytes in #_mqttOutbox_t.lastSegment. */
+
+    /**
+     * @brief Unacknowledged PUBLISH messages in each segment, indexed by
+     * segment number modulo #IOT_MQTT_OUTBOX_SEGMENTS.
+     */
+    uint32_t pLive[ IOT_MQTT_OUTBOX_SEGMENTS ];
+
+    /**
+     * @brief PUBLISH operations read from storage and not yet sent, oldest
+     * first. Linked by their send queue link.
+     */
+    struct _mqttOperation * pReplay;
+} _mqttOutbox_t;
+
 /**
  * @brief Represents an MQTT connection.
  */
@@ -268,9 +490,69 @@ typedef struct _mqttConnection
     IotListDouble_t pendingProcessing;              /**< @brief List of operations waiting to be processed by a task pool routine. */
     IotListDouble_t pendingResponse;                /**< @brief List of processed operations awaiting a server response. */
 
+    /**
+     * @brief Hash table of the packet identifiers of operations in
+     * #_mqttConnection_t.pendingResponse, chained through #_mqttInflight_t.link.
+     *
+     * Every operation awaiting a PUBACK, SUBACK, or UNSUBACK has an entry, so
+     * responses are never matched by searching the list. Protected by
+     * #_mqttConnection_t.referencesMutex.
+     */
+    IotListDouble_t inflight[ MQTT_INFLIGHT_BUCKETS ];
+    size_t inflightCount;                           /**< @brief Number of entries in #_mqttConnection_t.inflight. */
+
+    /**
+     * @brief Entries for the PUBACKs awaited by PUBLISH batches.
+     *
+     * Other operations have their own entry; a batch needs one for each of its
+     * QoS 1 PUBLISH messages. Protected by #_mqttConnection_t.referencesMutex.
+     */
+    _mqttInflight_t batchInflight[ IOT_MQTT_INFLIGHT_WINDOW ];
+    size_t batchInflightCount;                      /**< @brief Number of entries of #_mqttConnection_t.batchInflight in use. */
+
+    /**
+     * @brief Operations waiting for the send queue writer, newest first.
+     *
+     * Any task may push an operation with a compare-and-swap. The send queue
+     * writer takes all queued operations at once by swapping in `NULL`.
+     */
+    struct _mqttOperation * volatile pSendQueue;
+    uint32_t volatile sendQueueActive;              /**< @brief `1` while a send queue writer is scheduled or running; `0` otherwise. */
+    IotTaskPoolJobStorage_t sendQueueJobStorage;    /**< @brief Task pool job for the send queue writer. */
+    IotTaskPoolJob_t sendQueueJob;                  /**< @brief Task pool job for the send queue writer. */
+
+    /**
+     * @brief Packet identifiers of received PUBLISH messages to acknowledge.
+     *
+     * Only the network receive callback adds PUBACKs and only the send queue
+     * writer takes them, so the indexes need no lock.
+     */
+    uint16_t pubackQueue[ MQTT_PUBACK_QUEUE_SIZE ];
+    uint32_t volatile pubackHead;                   /**< @brief Number of PUBACKs taken by the send queue writer. */
+    uint32_t volatile pubackTail;                   /**< @brief Number of PUBACKs added by the network receive callback. */
+
+    /**
+     * @brief Small packets are copied here by the send queue writer and sent
+     * with a single network send.
+     */
+    uint8_t pSendBuffer[ IOT_MQTT_SEND_COALESCE_SIZE ];
+
+    _mqttOutbox_t outbox;                           /**< @brief Persistent outbox of QoS 1 PUBLISH messages. */
+
     IotListDouble_t subscriptionList;               /**< @brief Holds subscriptions associated with this connection. */
     IotMutex_t subscriptionMutex;                   /**< @brief Grants exclusive access to the subscription list. */
 
+    /**
+     * @brief Trie of the topic levels of the subscriptions in
+     * #_mqttConnection_t.subscriptionList.
+     *
+     * Each #_mqttTopicNode_t is kept in the bucket given by a hash of its parent
+     * and its topic level, so the child of a node for a given level is found
+     * without visiting its siblings. Protected by
+     * #_mqttConnection_t.subscriptionMutex.
+     */
+    IotListDouble_t subscriptionIndex[ IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS ];
+
     bool keepAliveFailure;                          /**< @brief Failure flag for keep-alive operation. */
     uint32_t keepAliveMs;                           /**< @brief Keep-alive interval in milliseconds. Its max value (per spec) is 65,535,000. */
     uint32_t nextKeepAliveMs;                       /**< @brief Relative delay for next keep-alive job. */
@@ -280,12 +562,34 @@ typedef struct _mqttConnection
     size_t pingreqPacketSize;                       /**< @brief The size of an allocated PINGREQ packet. */
 } _mqttConnection_t;
 
+/**
+ * @brief Represents one topic level in the subscription index of an MQTT
+ * connection.
+ *
+ * A topic filter is stored as the path of nodes of its topic levels, starting
+ * from a node without a parent. Wildcards are stored as the levels `+` and `#`.
+ * Nodes are shared by all topic filters with the same leading levels and are
+ * freed when no topic filter uses them.
+ */
+typedef struct _mqttTopicNode
+{
+    IotLink_t link;                           /**< @brief Link member of a bucket in #_mqttConnection_t.subscriptionIndex. */
+    struct _mqttTopicNode * pParent;          /**< @brief The node of the previous topic level; `NULL` for the first level. */
+    struct _mqttSubscription * pSubscription; /**< @brief The subscription whose topic filter ends at this node, if any. */
+    uint32_t hash;                            /**< @brief Hash of #_mqttTopicNode_t.pParent and #_mqttTopicNode_t.pLevel. */
+    uint32_t children;                        /**< @brief Number of nodes whose parent is this node. */
+    uint32_t references;                      /**< @brief Number of PUBLISH dispatches paused at or below this node. */
+    uint16_t levelLength;                     /**< @brief Length of #_mqttTopicNode_t.pLevel. */
+    char pLevel[];                            /**< @brief The topic level. */
+} _mqttTopicNode_t;
+
 /**
  * @brief Represents a subscription stored in an MQTT connection.
  */
 typedef struct _mqttSubscription
 {
-    IotLink_t link;     /**< @brief List link member. */
+    IotLink_t link;                 /**< @brief List link member. */
+    _mqttTopicNode_t * pTopicNode;  /**< @brief The node of the last level of the topic filter in #_mqttConnection_t.subscriptionIndex. */
 
     int32_t references; /**< @brief How many subscription callbacks are using this subscription. */
 
@@ -339,12 +643,29 @@ typedef struct _mqttOperation
             IotMqttOperationType_t type; /**< @brief What operation this structure represents. */
             uint32_t flags;              /**< @brief Flags passed to the function that created this operation. */
             uint16_t packetIdentifier;   /**< @brief The packet identifier used with this operation. */
+            _mqttInflight_t inflight;    /**< @brief Entry in the MQTT connection's in-flight table; unused by a batch. */
+            struct _mqttOperation * pNextSend; /**< @brief Next operation in the MQTT connection's send queue. */
 
             /* Serialized packet and size. */
             uint8_t * pMqttPacket;           /**< @brief The MQTT packet to send over the network. */
             uint8_t * pPacketIdentifierHigh; /**< @brief The location of the high byte of the packet identifier in the MQTT packet. */
             size_t packetSize;               /**< @brief Size of `pMqttPacket`. */
 
+            /* Payload sent after pMqttPacket without being copied into it. */
+            const uint8_t * pPayload; /**< @brief A PUBLISH payload to send after `pMqttPacket`, or `NULL`. */
+            size_t payloadLength;     /**< @brief Length of `pPayload`. */
+
+            /* Completion of a PUBLISH batch. Protected by the MQTT connection's
+             * references mutex. */
+            size_t batchCount;   /**< @brief Number of PUBACKs this batch awaits in total; `0` if not a batch. */
+            size_t batchPending; /**< @brief Number of PUBACKs this batch still awaits. */
+            bool batchSent;      /**< @brief Whether this operation was moved to the pending response list. */
+            bool responded;      /**< @brief Whether a PUBACK arrived before this PUBLISH was moved to the pending response list. */
+
+            /* Record of a QoS 1 PUBLISH in the MQTT connection's outbox. */
+            uint32_t outboxSequence; /**< @brief Sequence number in the outbox; `0` if not persisted. */
+            uint32_t outboxSegment;  /**< @brief The outbox segment holding this PUBLISH. */
+
             /* How to notify of an operation's completion. */
             union
             {
@@ -366,6 +687,16 @@ typedef struct _mqttOperation
         {
             IotMqttPublishInfo_t publishInfo; /**< @brief Deserialized PUBLISH. */
             const void * pReceivedData;       /**< @brief Any buffer associated with this PUBLISH that should be freed. */
+
+            /**
+             * @brief Counts the holders of this PUBLISH's buffer.
+             *
+             * The subscription callbacks hold one loan while they run; each call
+             * to @ref mqtt_function_retainpublish adds one. Every loan holds a
+             * reference to the MQTT connection. Protected by the MQTT connection's
+             * references mutex.
+             */
+            int32_t loans;
         } publish;
     } u;                                      /**< @brief Valid member depends on _mqttOperation_t.incomingPublish. */
 } _mqttOperation_t;
@@ -522,6 +853,47 @@ IotMqttError_t _IotMqtt_SerializePublish( const IotMqttPublishInfo_t * pPublishI
                                           uint16_t * pPacketIdentifier,
                                           uint8_t ** pPacketIdentifierHigh );
 
+/**
+ * @brief Generate the headers of a PUBLISH packet, without its payload.
+ *
+ * The payload must be sent directly after the headers, from the buffer in
+ * `pPublishInfo`.
+ *
+ * @param[in] pPublishInfo User-provided PUBLISH information.
+ * @param[out] pPublishHeader Where the PUBLISH headers are written.
+ * @param[out] pHeaderSize Size of the headers written to `pPublishHeader`.
+ * @param[out] pPacketIdentifier The packet identifier generated for this PUBLISH.
+ * @param[out] pPacketIdentifierHigh Where the high byte of the packet identifier
+ * is written.
+ *
+ * @return #IOT_MQTT_SUCCESS, #IOT_MQTT_BAD_PARAMETER, or #IOT_MQTT_NO_MEMORY.
+ */
+IotMqttError_t _IotMqtt_SerializePublishHeader( const IotMqttPublishInfo_t * pPublishInfo,
+                                                uint8_t ** pPublishHeader,
+                                                size_t * pHeaderSize,
+                                                uint16_t * pPacketIdentifier,
+                                                uint8_t ** pPacketIdentifierHigh );
+
+/**
+ * @brief Generate a batch of PUBLISH packets, one after another in a single
+ * buffer.
+ *
+ * @param[in] pPublishInfoList User-provided PUBLISH information for each packet.
+ * @param[in] publishCount Number of elements in `pPublishInfoList`.
+ * @param[out] pBatchPacket Where the PUBLISH packets are written.
+ * @param[out] pPacketSize Total size of the packets written to `pBatchPacket`.
+ * @param[out] pPacketIdentifiers The packet identifiers generated for the QoS 1
+ * and 2 PUBLISH packets, in order. Must have room for one packet identifier per
+ * QoS 1 or 2 PUBLISH in `pPublishInfoList`.
+ *
+ * @return #IOT_MQTT_SUCCESS, #IOT_MQTT_BAD_PARAMETER, or #IOT_MQTT_NO_MEMORY.
+ */
+IotMqttError_t _IotMqtt_SerializePublishBatch( const IotMqttPublishInfo_t * pPublishInfoList,
+                                               size_t publishCount,
+                                               uint8_t ** pBatchPacket,
+                                               size_t * pPacketSize,
+                                               uint16_t * pPacketIdentifiers );
+
 /**
  * @brief Set the DUP bit in a QoS 1 PUBLISH packet.
  *
@@ -742,6 +1114,16 @@ void _IotMqtt_ProcessIncomingPublish( IotTaskPool_t pTaskPool,
                                       IotTaskPoolJob_t pPublishJob,
                                       void * pContext );
 
+/**
+ * @brief Release a loan on an incoming PUBLISH.
+ *
+ * Frees the incoming PUBLISH and its received data when its last loan is
+ * released, then decrements the reference count of its MQTT connection.
+ *
+ * @param[in] pOperation The incoming PUBLISH to release.
+ */
+void _IotMqtt_ReleaseIncomingPublish( _mqttOperation_t * pOperation );
+
 /**
  * @brief Task pool routine for processing an MQTT operation to send.
  *
@@ -754,6 +1136,47 @@ void _IotMqtt_ProcessSend( IotTaskPool_t pTaskPool,
                            IotTaskPoolJob_t pSendJob,
                            void * pContext );
 
+/**
+ * @brief Task pool routine for an MQTT connection's send queue writer.
+ *
+ * Sends every operation and PUBACK in the send queue, copying adjacent small
+ * packets into one buffer so that they are sent together. Runs until the send
+ * queue is empty.
+ *
+ * @param[in] pTaskPool Pointer to the system task pool.
+ * @param[in] pSendQueueJob Pointer to an MQTT connection's send queue job.
+ * @param[in] pContext Pointer to an MQTT connection, passed as an opaque context.
+ */
+void _IotMqtt_ProcessSendQueue( IotTaskPool_t pTaskPool,
+                                IotTaskPoolJob_t pSendQueueJob,
+                                void * pContext );
+
+/**
+ * @brief Add an operation to its MQTT connection's send queue.
+ *
+ * Starts the send queue writer if it is not already running. If the writer
+ * cannot be scheduled, the send queue is sent from the calling task.
+ *
+ * An operation in the send queue has no job to cancel; it is treated as if its
+ * send job were executing.
+ *
+ * @param[in] pOperation The operation to send.
+ */
+void _IotMqtt_EnqueueSend( _mqttOperation_t * pOperation );
+
+/**
+ * @brief Add a PUBACK to an MQTT connection's send queue.
+ *
+ * Must only be called from the network receive callback. Never blocks: if the
+ * PUBACK queue is full, the PUBACK is sent from the calling task, or dropped
+ * if the MQTT connection is disconnected.
+ *
+ * @param[in] pMqttConnection The MQTT connection to send the PUBACK on.
+ * @param[in] packetIdentifier The packet identifier of the received PUBLISH.
+ */
+void _IotMqtt_EnqueuePuback( _mqttConnection_t * pMqttConnection,
+                             uint16_t packetIdentifier );
+
 /**
  * @brief Task pool routine for processing a completed MQTT operation.
  *
@@ -786,6 +1209,10 @@ IotMqttError_t _IotMqtt_ScheduleOperation( _mqttOperation_t * pOperation,
  * @brief Search a list of MQTT operations pending responses using an operation
  * name and packet identifier. Removes a matching operation from the list if found.
  *
+ * Operations with a packet identifier are looked up in the MQTT connection's
+ * in-flight table first, so the list is only searched for operations that are
+ * not in the table.
+ *
  * @param[in] pMqttConnection The connection associated with the operation.
  * @param[in] type The operation type to look for.
  * @param[in] pPacketIdentifier A packet identifier to match. Pass `NULL` to ignore.
@@ -796,6 +1223,24 @@ _mqttOperation_t * _IotMqtt_FindOperation( _mqttConnection_t * pMqttConnection,
                                            IotMqttOperationType_t type,
                                            const uint16_t * pPacketIdentifier );
 
+/**
+ * @brief Add a packet identifier to an MQTT connection's in-flight table.
+ *
+ * The MQTT connection's references mutex must be locked by the caller. An
+ * operation uses its own entry; a PUBLISH batch takes an entry from
+ * #_mqttConnection_t.batchInflight for each packet identifier.
+ *
+ * @param[in] pMqttConnection The MQTT connection that sent the packet.
+ * @param[in] packetIdentifier The packet identifier awaiting a response.
+ * @param[in] pOperation The operation that sent the packet.
+ *
+ * @return `true` if the packet identifier was added; `false` if a batch found
+ * no free entry.
+ */
+bool _IotMqtt_InflightInsert( _mqttConnection_t * pMqttConnection,
+                              uint16_t packetIdentifier,
+                              _mqttOperation_t * pOperation );
+
 /**
  * @brief Notify of a completed MQTT operation.
  *
@@ -832,6 +1277,9 @@ IotMqttError_t _IotMqtt_AddSubscriptions( _mqttConnection_t * pMqttConnection,
  * @param[in] pMqttConnection The MQTT connection associated with the received
  * PUBLISH.
  * @param[in] pCallbackParam The parameter to pass to a PUBLISH callback.
+ *
+ * @note The caller must hold a reference to `pMqttConnection`; this function
+ * does not release it.
  */
 void _IotMqtt_InvokeSubscriptionCallback( _mqttConnection_t * pMqttConnection,
                                           IotMqttCallbackParam_t * pCallbackParam );
@@ -862,6 +1310,75 @@ void _IotMqtt_RemoveSubscriptionByTopicFilter( _mqttConnection_t * pMqttConnecti
                                                const IotMqttSubscription_t * pSubscriptionList,
                                                size_t subscriptionCount );
 
+/**
+ * @brief Remove a subscription from the subscription index, freeing the topic
+ * levels no other subscription uses.
+ *
+ * The subscription mutex of the subscription's connection must be locked, or
+ * the connection must no longer be in use.
+ *
+ * @param[in] pSubscription The subscription to remove. It remains in
+ * #_mqttConnection_t.subscriptionList.
+ */
+void _IotMqtt_RemoveSubscriptionFromIndex( _mqttSubscription_t * pSubscription );
+
+/*------------------------ MQTT outbox functions ----------------------------*/
+
+/**
+ * @brief Open the persistent outbox of a new MQTT connection.
+ *
+ * Reads every record in storage and creates a PUBLISH operation for each
+ * unacknowledged message, which is sent by #_IotMqtt_OutboxReplay. Segments
+ * with no unacknowledged messages are removed.
+ *
+ * @param[in] pMqttConnection The new MQTT connection.
+ * @param[in] pOutboxInfo The outbox passed to @ref mqtt_function_connect.
+ *
+ * @return #IOT_MQTT_SUCCESS, #IOT_MQTT_NO_MEMORY, or #IOT_MQTT_BAD_PARAMETER if
+ * storage has more than #IOT_MQTT_OUTBOX_SEGMENTS segments.
+ */
+IotMqttError_t _IotMqtt_OutboxOpen( _mqttConnection_t * pMqttConnection,
+                                    const IotMqttOutboxInfo_t * pOutboxInfo );
+
+/**
+ * @brief Add the unacknowledged PUBLISH messages read by #_IotMqtt_OutboxOpen
+ * to the send queue, oldest first.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the outbox.
+ */
+void _IotMqtt_OutboxReplay( _mqttConnection_t * pMqttConnection );
+
+/**
+ * @brief Close the persistent outbox of an MQTT connection.
+ *
+ * Destroys any PUBLISH operations that were read but not sent. Does nothing
+ * if the MQTT connection has no outbox.
+ *
+ * @param[in] pMqttConnection The MQTT connection with the outbox.
+ */
+void _IotMqtt_OutboxClose( _mqttConnection_t * pMqttConnection );
+
+/**
+ * @brief Write a QoS 1 PUBLISH to its MQTT connection's outbox.
+ *
+ * Must be called before the PUBLISH is sent. Sets the outbox members of the
+ * operation.
+ *
+ * @param[in] pOperation The serialized PUBLISH operation.
+ *
+ * @return #IOT_MQTT_SUCCESS or #IOT_MQTT_NO_MEMORY if the outbox is full or
+ * cannot be written.
+ */
+IotMqttError_t _IotMqtt_OutboxPut( _mqttOperation_t * pOperation );
+
+/**
+ * @brief Mark a persisted PUBLISH as acknowledged in its MQTT connection's
+ * outbox.
+ *
+ * @param[in] pOperation The PUBLISH operation that received a PUBACK.
+ */
+void _IotMqtt_OutboxAck( _mqttOperation_t * pOperation );
+
 /*------------------ MQTT connection management functions -------------------*/
 
 /**
@@ -0,0 +1,282 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_perf_mqtt_ack.c
+ * @brief Measures the cost of matching an acknowledgement to a pending MQTT
+ * operation against the number of operations in flight.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdio.h>
+#include <string.h>
+
+/* SDK initialization include. */
+#include "iot_init.h"
+
+/* MQTT internal include. */
+#include "private/iot_mqtt_internal.h"
+
+/* Platform layer includes. */
+#include "platform/iot_clock.h"
+#include "platform/iot_threads.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/* MQTT test access include. */
+#include "iot_test_access_mqtt.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief How many acknowledgements to process for each in-flight count.
+ */
+#define ACK_ITERATIONS    ( 100000 )
+
+/**
+ * @brief The largest number of operations kept in flight.
+ */
+#define MAX_IN_FLIGHT     ( 512 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The numbers of operations in flight to measure.
+ */
+static const size_t _pInFlightCounts[] = { 1, 8, 32, 128, MAX_IN_FLIGHT };
+
+/**
+ * @brief The operations in flight.
+ */
+static _mqttOperation_t * _pOperations[ MAX_IN_FLIGHT ] = { 0 };
+
+/**
+ * @brief Network info used by the MQTT connection.
+ */
+static IotMqttNetworkInfo_t _networkInfo = IOT_MQTT_NETWORK_INFO_INITIALIZER;
+
+/**
+ * @brief Network interface used by the MQTT connection. None of its functions
+ * are called.
+ */
+static IotNetworkInterface_t _networkInterface = { 0 };
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Print a line of results.
+ *
+ * The line is written to the test output, which unlike the log is not
+ * prefixed with a header on each call.
+ */
+static void _printLine( const char * pLine )
+{
+    while( *pLine != '\0' )
+    {
+        UNITY_OUTPUT_CHAR( *pLine );
+        pLine++;
+    }
+
+    UNITY_OUTPUT_CHAR( '\n' );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Place an operation in the pending response list and in-flight table,
+ * as #_IotMqtt_ProcessSend does after sending it.
+ */
+static void _addPendingResponse( _mqttConnection_t * pMqttConnection,
+                                 _mqttOperation_t * pOperation )
+{
+    IotMutex_Lock( &( pMqttConnection->referencesMutex ) );
+
+    if( IotLink_IsLinked( &( pOperation->link ) ) == true )
+    {
+        IotListDouble_Remove( &( pOperation->link ) );
+    }
+
+    IotListDouble_InsertHead( &( pMqttConnection->pendingResponse ),
+                              &( pOperation->link ) );
+    pOperation->u.operation.batchSent = true;
+    ( void ) _IotMqtt_InflightInsert( pMqttConnection,
+                                      pOperation->u.operation.packetIdentifier,
+                                      pOperation );
+
+    IotMutex_Unlock( &( pMqttConnection->referencesMutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Measure the cost of one acknowledgement with a number of operations
+ * in flight.
+ *
+ * Acknowledgements are processed oldest first, which is the worst case for a
+ * search of the pending response list. Each acknowledged operation is placed
+ * back in flight so that the in-flight count stays constant.
+ */
+static void _measureAcks( size_t inFlightCount )
+{
+    size_t i = 0, created = 0;
+    char pLine[ 96 ] = { 0 };
+    uint64_t startTime = 0, elapsedMs = 0;
+    uint16_t packetIdentifier = 0;
+    _mqttOperation_t * pAcked = NULL;
+    _mqttConnection_t * pMqttConnection = NULL;
+
+    pMqttConnection = IotTestMqtt_createMqttConnection( false, &_networkInfo, 0 );
+    TEST_ASSERT_NOT_NULL( pMqttConnection );
+
+    if( TEST_PROTECT() )
+    {
+        /* Put the operations in flight. With static memory, only as many
+         * operations as the operation pool holds can be in flight. */
+        for( created = 0; created < inFlightCount; created++ )
+        {
+            if( _IotMqtt_CreateOperation( pMqttConnection,
+                                          0,
+                                          NULL,
+                                          &( _pOperations[ created ] ) ) != IOT_MQTT_SUCCESS )
+            {
+                break;
+            }
+
+            _pOperations[ created ]->u.operation.type = IOT_MQTT_PUBLISH_TO_SERVER;
+            _pOperations[ created ]->u.operation.packetIdentifier = ( uint16_t ) ( 2 * created + 1 );
+            _addPendingResponse( pMqttConnection, _pOperations[ created ] );
+        }
+
+        TEST_ASSERT_GREATER_THAN( 0, created );
+        inFlightCount = created;
+
+        startTime = IotClock_GetTimeMs();
+
+        for( i = 0; i < ACK_ITERATIONS; i++ )
+        {
+            packetIdentifier = _pOperations[ i % inFlightCount ]->u.operation.packetIdentifier;
+
+            pAcked = _IotMqtt_FindOperation( pMqttConnection,
+                                             IOT_MQTT_PUBLISH_TO_SERVER,
+                                             &packetIdentifier );
+            TEST_ASSERT_EQUAL_PTR( _pOperations[ i % inFlightCount ], pAcked );
+
+            _addPendingResponse( pMqttConnection, pAcked );
+        }
+
+        elapsedMs = IotClock_GetTimeMs() - startTime;
+
+        ( void ) snprintf( pLine,
+                           sizeof( pLine ),
+                           "MQTT ack: %lu in flight (window %lu), %lu ns per ack",
+                           ( unsigned long ) inFlightCount,
+                           ( unsigned long ) IOT_MQTT_INFLIGHT_WINDOW,
+                           ( unsigned long ) ( ( elapsedMs * 1000000ULL ) / ACK_ITERATIONS ) );
+        _printLine( pLine );
+    }
+
+    /* Destroy the operations and the connection. */
+    for( i = 0; i < created; i++ )
+    {
+        _IotMqtt_DestroyOperation( _pOperations[ i ] );
+        _pOperations[ i ] = NULL;
+    }
+
+    TEST_ASSERT_EQUAL( 0, pMqttConnection->inflightCount );
+
+    IotMqtt_Disconnect( pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for MQTT acknowledgement performance.
+ */
+TEST_GROUP( MQTT_Perf_Ack );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT acknowledgement performance.
+ */
+TEST_SETUP( MQTT_Perf_Ack )
+{
+    ( void ) memset( &_networkInterface, 0x00, sizeof( IotNetworkInterface_t ) );
+    _networkInfo.pNetworkInterface = &_networkInterface;
+
+    /* Initialize libraries. */
+    TEST_ASSERT_EQUAL_INT( true, IotSdk_Init() );
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Init() );
+
+    /* Start the results on their own line, after the name of the test. */
+    UNITY_OUTPUT_CHAR( '\n' );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT acknowledgement performance.
+ */
+TEST_TEAR_DOWN( MQTT_Perf_Ack )
+{
+    IotMqtt_Cleanup();
+    IotSdk_Cleanup();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for MQTT acknowledgement performance.
+ */
+TEST_GROUP_RUNNER( MQTT_Perf_Ack )
+{
+    RUN_TEST_CASE( MQTT_Perf_Ack, AckLookup );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reports the cost of matching a PUBACK to its PUBLISH for increasing
+ * numbers of PUBLISH operations in flight.
+ *
+ * Every operation is found in the in-flight table, so the cost should grow
+ * only with the length of its buckets, which have one operation for every
+ * `2 * IOT_MQTT_INFLIGHT_WINDOW` in flight.
+ */
+TEST( MQTT_Perf_Ack, AckLookup )
+{
+    size_t i = 0;
+
+    for( i = 0; i < sizeof( _pInFlightCounts ) / sizeof( _pInFlightCounts[ 0 ] ); i++ )
+    {
+        _measureAcks( _pInFlightCounts[ i ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,802 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_perf_mqtt_client.c
+ * @brief Measures the throughput, latency, dispatch cost, and memory use of the
+ * MQTT client against the loopback server in iot_perf_mqtt_loopback.h.
+ *
+ * Each result is printed as a single line holding one JSON object, so that the
+ * results can be collected from the test output and compared between builds.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined( __linux__ )
+    #include <time.h>
+#endif
+
+/* SDK initialization include. */
+#include "iot_init.h"
+
+/* MQTT include. */
+#include "iot_mqtt.h"
+
+/* Platform layer includes. */
+#include "platform/iot_clock.h"
+#include "platform/iot_threads.h"
+
+/* Memory use is measured from the static memory pools or the FreeRTOS heap. */
+#if IOT_STATIC_MEMORY_ONLY == 1
+    #include "private/iot_static_memory.h"
+#else
+    #include "FreeRTOS.h"
+#endif
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/* Loopback server include. */
+#include "iot_perf_mqtt_loopback.h"
+
+/**
+ * @cond DOXYGEN_IGNORE
+ * Doxygen should ignore this section.
+ *
+ * Provide default values for test configuration constants.
+ */
+#ifndef IOT_PERF_MQTT_MESSAGE_COUNT
+    #define IOT_PERF_MQTT_MESSAGE_COUNT      ( 2000 )
+#endif
+#ifndef IOT_PERF_MQTT_PUBLISH_WINDOW
+    #define IOT_PERF_MQTT_PUBLISH_WINDOW     ( 8 )
+#endif
+#ifndef IOT_PERF_MQTT_LATENCY_SAMPLES
+    #define IOT_PERF_MQTT_LATENCY_SAMPLES    ( 500 )
+#endif
+#ifndef IOT_PERF_MQTT_LATENCY_MS
+    #define IOT_PERF_MQTT_LATENCY_MS         ( 5 )
+#endif
+#ifndef IOT_PERF_MQTT_LOSS_PERCENT
+    #define IOT_PERF_MQTT_LOSS_PERCENT       ( 2 )
+#endif
+#ifndef IOT_PERF_MQTT_DISPATCH_COUNT
+    #define IOT_PERF_MQTT_DISPATCH_COUNT     ( 5000 )
+#endif
+#ifndef IOT_PERF_MQTT_HEAP_MESSAGES
+    #define IOT_PERF_MQTT_HEAP_MESSAGES      ( 16 )
+#endif
+#ifndef IOT_PERF_MQTT_PAYLOAD_LENGTH
+    #define IOT_PERF_MQTT_PAYLOAD_LENGTH     ( 32 )
+#endif
+#ifndef IOT_PERF_MQTT_TIMEOUT_MS
+    #define IOT_PERF_MQTT_TIMEOUT_MS         ( 5000 )
+#endif
+/** @endcond */
+
+/**
+ * @brief Retransmission interval for QoS 1 PUBLISH messages when PUBACKs are
+ * being dropped.
+ */
+#define RETRY_MS                ( 20 )
+
+/**
+ * @brief Retransmission limit for QoS 1 PUBLISH messages when PUBACKs are
+ * being dropped.
+ */
+#define RETRY_LIMIT             ( 10 )
+
+/**
+ * @brief The largest number of topic filters subscribed for the dispatch test.
+ */
+#define MAX_FILTER_COUNT        ( 256 )
+
+/**
+ * @brief How many topic filters are placed in each SUBSCRIBE packet.
+ */
+#define SUBSCRIBE_CHUNK         ( 8 )
+
+/**
+ * @brief Length of the buffer that holds each topic filter.
+ */
+#define FILTER_BUFFER_LENGTH    ( 24 )
+
+/**
+ * @brief Topic name of PUBLISH messages sent by the tests.
+ */
+#define PUBLISH_TOPIC           "perf/publish"
+
+/**
+ * @brief Length of #PUBLISH_TOPIC.
+ */
+#define PUBLISH_TOPIC_LENGTH    ( ( uint16_t ) ( sizeof( PUBLISH_TOPIC ) - 1 ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Payload of PUBLISH messages sent by the tests.
+ */
+static const uint8_t _pPayload[ IOT_PERF_MQTT_PAYLOAD_LENGTH ] = { 0 };
+
+/**
+ * @brief The MQTT connection to the loopback server.
+ */
+static IotMqttConnection_t _mqttConnection = IOT_MQTT_CONNECTION_INITIALIZER;
+
+/**
+ * @brief Posted when a PUBLISH completes or a message is received.
+ */
+static IotSemaphore_t _completeSem;
+
+/**
+ * @brief Protects the counters below.
+ */
+static IotMutex_t _countMutex;
+
+/**
+ * @brief The number of PUBLISH operations that failed.
+ */
+static uint32_t _failureCount = 0;
+
+/**
+ * @brief The number of messages received by the dispatch test.
+ */
+static uint32_t _receivedCount = 0;
+
+/**
+ * @brief Latency samples, in microseconds.
+ */
+static uint32_t _pLatencyUs[ IOT_PERF_MQTT_LATENCY_SAMPLES ] = { 0 };
+
+/**
+ * @brief Topic filters used by the dispatch test.
+ */
+static char _pFilters[ MAX_FILTER_COUNT ][ FILTER_BUFFER_LENGTH ] = { { 0 } };
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a timestamp in microseconds.
+ *
+ * Linux hosts use the monotonic clock; other platforms are limited to the
+ * millisecond resolution of #IotClock_GetTimeMs.
+ */
+static uint64_t _timeUs( void )
+{
+    #if defined( __linux__ )
+        struct timespec now = { 0 };
+
+        ( void ) clock_gettime( CLOCK_MONOTONIC, &now );
+
+        return ( ( uint64_t ) now.tv_sec * 1000000ULL ) + ( ( uint64_t ) now.tv_nsec / 1000ULL );
+    #else
+        return IotClock_GetTimeMs() * 1000ULL;
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Print one result as a line of JSON.
+ *
+ * The line is written one character at a time to the test output, which adds
+ * no log header, so that every line parses as JSON.
+ */
+static void _printResult( const char * pFormat,
+                          ... )
+{
+    char pLine[ 256 ] = { 0 };
+    const char * pChar = pLine;
+    va_list args;
+
+    va_start( args, pFormat );
+    ( void ) vsnprintf( pLine, sizeof( pLine ), pFormat, args );
+    va_end( args );
+
+    while( *pChar != '\0' )
+    {
+        UNITY_OUTPUT_CHAR( *pChar );
+        pChar++;
+    }
+
+    UNITY_OUTPUT_CHAR( '\n' );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get the number of bytes of memory in use by the MQTT library and its
+ * message buffers.
+ */
+static size_t _memoryInUse( void )
+{
+    size_t bytesInUse = 0;
+
+    #if IOT_STATIC_MEMORY_ONLY == 1
+        size_t i = 0, classCount = 0;
+        IotSlabStats_t pBufferStats[ 4 ] = { { 0 } };
+        IotMqttMemoryStats_t mqttStats = { { 0 } };
+
+        IotMqtt_GetMemoryStats( &mqttStats );
+        classCount = Iot_MessageBufferStats( pBufferStats, 4 );
+
+        bytesInUse = ( mqttStats.connections.inUse * mqttStats.connections.blockSize ) +
+                     ( mqttStats.operations.inUse * mqttStats.operations.blockSize ) +
+                     ( mqttStats.subscriptions.inUse * mqttStats.subscriptions.blockSize ) +
+                     ( mqttStats.topicNodes.inUse * mqttStats.topicNodes.blockSize );
+
+        for( i = 0; i < classCount; i++ )
+        {
+            bytesInUse += pBufferStats[ i ].inUse * pBufferStats[ i ].blockSize;
+        }
+    #else
+        /* The heap only reports free space, so memory in use is the complement. */
+        bytesInUse = configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize();
+    #endif
+
+    return bytesInUse;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Compare two latency samples for qsort.
+ */
+static int _compareSamples( const void * pFirst,
+                            const void * pSecond )
+{
+    uint32_t first = *( ( const uint32_t * ) pFirst ),
+             second = *( ( const uint32_t * ) pSecond );
+
+    return ( first > second ) - ( first < second );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief PUBLISH completion callback. Counts failures and opens a slot in the
+ * publish window.
+ */
+static void _publishComplete( void * pArgument,
+                              IotMqttCallbackParam_t * pOperation )
+{
+    ( void ) pArgument;
+
+    if( pOperation->u.operation.result != IOT_MQTT_SUCCESS )
+    {
+        IotMutex_Lock( &_countMutex );
+        _failureCount++;
+        IotMutex_Unlock( &_countMutex );
+    }
+
+    IotSemaphore_Post( &_completeSem );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Subscription callback. Posts once for each received message, or once
+ * after the number of messages in `pArgument` have been received.
+ */
+static void _messageReceived( void * pArgument,
+                              IotMqttCallbackParam_t * pPublish )
+{
+    uint32_t expected = ( uint32_t ) ( uintptr_t ) pArgument;
+    bool post = false;
+
+    ( void ) pPublish;
+
+    IotMutex_Lock( &_countMutex );
+    _receivedCount++;
+    post = ( expected == 0 ) || ( _receivedCount == expected );
+    IotMutex_Unlock( &_countMutex );
+
+    if( post == true )
+    {
+        IotSemaphore_Post( &_completeSem );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start the loopback server and connect to it.
+ */
+static void _connect( uint32_t latencyMs,
+                      uint32_t lossPercent,
+                      bool echo )
+{
+    IotPerfMqttLoopbackConfig_t serverConfig = { 0 };
+    IotMqttNetworkInfo_t networkInfo = IOT_MQTT_NETWORK_INFO_INITIALIZER;
+    IotMqttConnectInfo_t connectInfo = IOT_MQTT_CONNECT_INFO_INITIALIZER;
+
+    serverConfig.latencyMs = latencyMs;
+    serverConfig.lossPercent = lossPercent;
+    serverConfig.echo = echo;
+    TEST_ASSERT_EQUAL_INT( true, IotPerfMqttLoopback_Start( &serverConfig ) );
+
+    networkInfo.createNetworkConnection = false;
+    networkInfo.u.pNetworkConnection = IotPerfMqttLoopback_Connection;
+    networkInfo.pNetworkInterface = &IotPerfMqttLoopback;
+
+    connectInfo.pClientIdentifier = "perf";
+    connectInfo.clientIdentifierLength = 4;
+    connectInfo.keepAliveSeconds = 0;
+
+    _failureCount = 0;
+    _receivedCount = 0;
+
+    if( IotMqtt_Connect( &networkInfo,
+                         &connectInfo,
+                         IOT_PERF_MQTT_TIMEOUT_MS,
+                         &_mqttConnection ) != IOT_MQTT_SUCCESS )
+    {
+        IotPerfMqttLoopback_Stop();
+        TEST_FAIL_MESSAGE( "Failed to connect to the loopback server." );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Disconnect from the loopback server and stop it.
+ */
+static void _disconnect( void )
+{
+    IotMqtt_Disconnect( _mqttConnection, 0 );
+    _mqttConnection = IOT_MQTT_CONNECTION_INITIALIZER;
+
+    IotPerfMqttLoopback_Stop();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Publish messages with a bounded number outstanding and report the
+ * message rate.
+ *
+ * QoS 1 messages are outstanding until their PUBACK; QoS 0 messages are
+ * outstanding until the server's echo is received.
+ */
+static void _measureThroughput( IotMqttQos_t qos,
+                                uint32_t latencyMs,
+                                uint32_t lossPercent )
+{
+    uint32_t i = 0;
+    uint64_t startTime = 0, elapsedUs = 0;
+    IotMqttError_t status = IOT_MQTT_STATUS_PENDING;
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+    IotMqttCallbackInfo_t callbackInfo = IOT_MQTT_CALLBACK_INFO_INITIALIZER;
+    IotMqttSubscription_t subscription = IOT_MQTT_SUBSCRIPTION_INITIALIZER;
+
+    _connect( latencyMs, lossPercent, ( qos == IOT_MQTT_QOS_0 ) );
+
+    if( TEST_PROTECT() )
+    {
+        if( qos == IOT_MQTT_QOS_0 )
+        {
+            subscription.pTopicFilter = PUBLISH_TOPIC;
+            subscription.topicFilterLength = PUBLISH_TOPIC_LENGTH;
+            subscription.callback.function = _messageReceived;
+            TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                               IotMqtt_TimedSubscribe( _mqttConnection,
+                                                       &subscription,
+                                                       1,
+                                                       0,
+                                                       IOT_PERF_MQTT_TIMEOUT_MS ) );
+        }
+        else
+        {
+            callbackInfo.function = _publishComplete;
+        }
+
+        publishInfo.qos = qos;
+        publishInfo.pTopicName = PUBLISH_TOPIC;
+        publishInfo.topicNameLength = PUBLISH_TOPIC_LENGTH;
+        publishInfo.pPayload = _pPayload;
+        publishInfo.payloadLength = sizeof( _pPayload );
+
+        if( lossPercent > 0 )
+        {
+            publishInfo.retryMs = RETRY_MS;
+            publishInfo.retryLimit = RETRY_LIMIT;
+        }
+
+        startTime = _timeUs();
+
+        for( i = 0; i < IOT_PERF_MQTT_MESSAGE_COUNT; i++ )
+        {
+            /* Wait for a slot in the window. */
+            if( i >= IOT_PERF_MQTT_PUBLISH_WINDOW )
+            {
+                TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &_completeSem,
+                                                                     IOT_PERF_MQTT_TIMEOUT_MS ) );
+            }
+
+            status = IotMqtt_Publish( _mqttConnection,
+                                      &publishInfo,
+                                      0,
+                                      ( qos == IOT_MQTT_QOS_1 ) ? &callbackInfo : NULL,
+                                      NULL );
+
+            if( ( status != IOT_MQTT_SUCCESS ) && ( status != IOT_MQTT_STATUS_PENDING ) )
+            {
+                /* The message will not complete, so its slot is free again. */
+                IotMutex_Lock( &_countMutex );
+                _failureCount++;
+                IotMutex_Unlock( &_countMutex );
+                IotSemaphore_Post( &_completeSem );
+            }
+        }
+
+        /* Wait for the messages still in the window. */
+        for( i = 0; i < IOT_PERF_MQTT_PUBLISH_WINDOW; i++ )
+        {
+            TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &_completeSem,
+                                                                 IOT_PERF_MQTT_TIMEOUT_MS ) );
+        }
+
+        elapsedUs = _timeUs() - startTime;
+
+        if( elapsedUs == 0 )
+        {
+            elapsedUs = 1;
+        }
+
+        _printResult( "{\"benchmark\":\"mqtt_publish_throughput\",\"qos\":%d,\"window\":%d,"
+                      "\"latency_ms\":%lu,\"loss_percent\":%lu,\"messages\":%d,"
+                      "\"publishes_per_s\":%lu,\"failures\":%lu}",
+                      ( int ) qos,
+                      IOT_PERF_MQTT_PUBLISH_WINDOW,
+                      ( unsigned long ) latencyMs,
+                      ( unsigned long ) lossPercent,
+                      IOT_PERF_MQTT_MESSAGE_COUNT,
+                      ( unsigned long ) ( ( IOT_PERF_MQTT_MESSAGE_COUNT * 1000000ULL ) / elapsedUs ),
+                      ( unsigned long ) _failureCount );
+    }
+
+    _disconnect();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send QoS 1 messages one at a time and report the distribution of the
+ * time from publish to PUBACK.
+ */
+static void _measureLatency( uint32_t latencyMs,
+                             uint32_t lossPercent )
+{
+    uint32_t i = 0, failures = 0;
+    uint64_t startTime = 0;
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+
+    _connect( latencyMs, lossPercent, false );
+
+    if( TEST_PROTECT() )
+    {
+        publishInfo.qos = IOT_MQTT_QOS_1;
+        publishInfo.pTopicName = PUBLISH_TOPIC;
+        publishInfo.topicNameLength = PUBLISH_TOPIC_LENGTH;
+        publishInfo.pPayload = _pPayload;
+        publishInfo.payloadLength = sizeof( _pPayload );
+
+        if( lossPercent > 0 )
+        {
+            publishInfo.retryMs = RETRY_MS;
+            publishInfo.retryLimit = RETRY_LIMIT;
+        }
+
+        for( i = 0; i < IOT_PERF_MQTT_LATENCY_SAMPLES; i++ )
+        {
+            startTime = _timeUs();
+
+            if( IotMqtt_TimedPublish( _mqttConnection,
+                                      &publishInfo,
+                                      0,
+                                      IOT_PERF_MQTT_TIMEOUT_MS ) != IOT_MQTT_SUCCESS )
+            {
+                failures++;
+            }
+
+            _pLatencyUs[ i ] = ( uint32_t ) ( _timeUs() - startTime );
+        }
+
+        qsort( _pLatencyUs, IOT_PERF_MQTT_LATENCY_SAMPLES, sizeof( uint32_t ), _compareSamples );
+
+        _printResult( "{\"benchmark\":\"mqtt_publish_latency\",\"latency_ms\":%lu,"
+                      "\"loss_percent\":%lu,\"samples\":%d,\"p50_us\":%lu,\"p99_us\":%lu,"
+                      "\"max_us\":%lu,\"failures\":%lu}",
+                      ( unsigned long ) latencyMs,
+                      ( unsigned long ) lossPercent,
+                      IOT_PERF_MQTT_LATENCY_SAMPLES,
+                      ( unsigned long ) _pLatencyUs[ IOT_PERF_MQTT_LATENCY_SAMPLES / 2 ],
+                      ( unsigned long ) _pLatencyUs[ ( IOT_PERF_MQTT_LATENCY_SAMPLES * 99 ) / 100 ],
+                      ( unsigned long ) _pLatencyUs[ IOT_PERF_MQTT_LATENCY_SAMPLES - 1 ],
+                      ( unsigned long ) failures );
+    }
+
+    _disconnect();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Subscribe to a number of topic filters and report the cost of
+ * dispatching a received message to the last one.
+ */
+static void _measureDispatch( size_t filterCount )
+{
+    size_t i = 0, subscribed = 0, chunk = 0;
+    uint64_t startTime = 0, elapsedUs = 0;
+    IotMqttSubscription_t pSubscriptions[ SUBSCRIBE_CHUNK ] = { IOT_MQTT_SUBSCRIPTION_INITIALIZER };
+
+    _connect( 0, 0, false );
+
+    if( TEST_PROTECT() )
+    {
+        /* Subscribe to distinct filters. With static memory, only as many
+         * filters as the subscription pool holds can be subscribed. */
+        while( subscribed < filterCount )
+        {
+            chunk = filterCount - subscribed;
+
+            if( chunk > SUBSCRIBE_CHUNK )
+            {
+                chunk = SUBSCRIBE_CHUNK;
+            }
+
+            for( i = 0; i < chunk; i++ )
+            {
+                pSubscriptions[ i ].qos = IOT_MQTT_QOS_0;
+                pSubscriptions[ i ].pTopicFilter = _pFilters[ subscribed + i ];
+                pSubscriptions[ i ].topicFilterLength = ( uint16_t ) strlen( _pFilters[ subscribed + i ] );
+                pSubscriptions[ i ].callback.function = _messageReceived;
+                pSubscriptions[ i ].callback.pCallbackContext = ( void * ) ( uintptr_t ) IOT_PERF_MQTT_DISPATCH_COUNT;
+            }
+
+            if( IotMqtt_TimedSubscribe( _mqttConnection,
+                                        pSubscriptions,
+                                        chunk,
+                                        0,
+                                        IOT_PERF_MQTT_TIMEOUT_MS ) != IOT_MQTT_SUCCESS )
+            {
+                break;
+            }
+
+            subscribed += chunk;
+        }
+
+        TEST_ASSERT_GREATER_THAN( 0, subscribed );
+
+        startTime = _timeUs();
+
+        TEST_ASSERT_EQUAL_INT( true,
+                               IotPerfMqttLoopback_Inject( _pFilters[ subscribed - 1 ],
+                                                           ( uint16_t ) strlen( _pFilters[ subscribed - 1 ] ),
+                                                           IOT_PERF_MQTT_PAYLOAD_LENGTH,
+                                                           IOT_PERF_MQTT_DISPATCH_COUNT ) );
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &_completeSem,
+                                                             IOT_PERF_MQTT_TIMEOUT_MS ) );
+
+        elapsedUs = _timeUs() - startTime;
+
+        _printResult( "{\"benchmark\":\"mqtt_subscribe_dispatch\",\"filters\":%lu,"
+                      "\"messages\":%d,\"ns_per_message\":%lu}",
+                      ( unsigned long ) subscribed,
+                      IOT_PERF_MQTT_DISPATCH_COUNT,
+                      ( unsigned long ) ( ( elapsedUs * 1000ULL ) / IOT_PERF_MQTT_DISPATCH_COUNT ) );
+    }
+
+    _disconnect();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for MQTT client performance.
+ */
+TEST_GROUP( MQTT_Perf_Client );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT client performance.
+ */
+TEST_SETUP( MQTT_Perf_Client )
+{
+    /* Initialize libraries. */
+    TEST_ASSERT_EQUAL_INT( true, IotSdk_Init() );
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Init() );
+
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &_completeSem, 0, IOT_PERF_MQTT_MESSAGE_COUNT ) );
+    TEST_ASSERT_EQUAL_INT( true, IotMutex_Create( &_countMutex, false ) );
+
+    /* Start the results on their own line, after the name of the test. */
+    UNITY_OUTPUT_CHAR( '\n' );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT client performance.
+ */
+TEST_TEAR_DOWN( MQTT_Perf_Client )
+{
+    IotMutex_Destroy( &_countMutex );
+    IotSemaphore_Destroy( &_completeSem );
+
+    IotMqtt_Cleanup();
+    IotSdk_Cleanup();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for MQTT client performance.
+ */
+TEST_GROUP_RUNNER( MQTT_Perf_Client )
+{
+    RUN_TEST_CASE( MQTT_Perf_Client, PublishThroughput );
+    RUN_TEST_CASE( MQTT_Perf_Client, PublishLatency );
+    RUN_TEST_CASE( MQTT_Perf_Client, SubscribeDispatch );
+    RUN_TEST_CASE( MQTT_Perf_Client, HeapPerMessage );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reports QoS 0 and QoS 1 publish rates with an ideal server, and the
+ * QoS 1 rate with server latency and PUBACK loss.
+ */
+TEST( MQTT_Perf_Client, PublishThroughput )
+{
+    _measureThroughput( IOT_MQTT_QOS_0, 0, 0 );
+    _measureThroughput( IOT_MQTT_QOS_1, 0, 0 );
+    _measureThroughput( IOT_MQTT_QOS_1, IOT_PERF_MQTT_LATENCY_MS, IOT_PERF_MQTT_LOSS_PERCENT );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reports the p50 and p99 of publish-to-PUBACK latency with an ideal
+ * server, with server latency, and with PUBACK loss.
+ */
+TEST( MQTT_Perf_Client, PublishLatency )
+{
+    _measureLatency( 0, 0 );
+    _measureLatency( IOT_PERF_MQTT_LATENCY_MS, 0 );
+    _measureLatency( 0, IOT_PERF_MQTT_LOSS_PERCENT );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reports the cost of dispatching an incoming PUBLISH against the
+ * number of subscribed topic filters.
+ */
+TEST( MQTT_Perf_Client, SubscribeDispatch )
+{
+    size_t i = 0;
+    const size_t pFilterCounts[] = { 1, 16, 64, MAX_FILTER_COUNT };
+
+    for( i = 0; i < MAX_FILTER_COUNT; i++ )
+    {
+        ( void ) snprintf( _pFilters[ i ], FILTER_BUFFER_LENGTH, "perf/dispatch/%lu", ( unsigned long ) i );
+    }
+
+    for( i = 0; i < sizeof( pFilterCounts ) / sizeof( pFilterCounts[ 0 ] ); i++ )
+    {
+        _measureDispatch( pFilterCounts[ i ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Reports the memory held by each unacknowledged QoS 1 PUBLISH.
+ *
+ * PUBACKs are held by the server so that every message stays in flight while
+ * memory use is measured.
+ */
+TEST( MQTT_Perf_Client, HeapPerMessage )
+{
+    uint32_t i = 0, published = 0;
+    size_t baseline = 0, inFlight = 0;
+    uint64_t startTime = 0;
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+    IotMqttCallbackInfo_t callbackInfo = IOT_MQTT_CALLBACK_INFO_INITIALIZER;
+
+    _connect( 0, 0, false );
+
+    if( TEST_PROTECT() )
+    {
+        publishInfo.qos = IOT_MQTT_QOS_1;
+        publishInfo.pTopicName = PUBLISH_TOPIC;
+        publishInfo.topicNameLength = PUBLISH_TOPIC_LENGTH;
+        publishInfo.pPayload = _pPayload;
+        publishInfo.payloadLength = sizeof( _pPayload );
+        callbackInfo.function = _publishComplete;
+
+        IotPerfMqttLoopback_HoldAcks( true );
+        baseline = _memoryInUse();
+
+        /* With static memory, only as many messages as the operation pool
+         * holds can be in flight. */
+        for( published = 0; published < IOT_PERF_MQTT_HEAP_MESSAGES; published++ )
+        {
+            if( IotMqtt_Publish( _mqttConnection,
+                                 &publishInfo,
+                                 0,
+                                 &callbackInfo,
+                                 NULL ) != IOT_MQTT_STATUS_PENDING )
+            {
+                break;
+            }
+        }
+
+        TEST_ASSERT_GREATER_THAN( 0, published );
+
+        /* Wait for every message to reach the server, so that none is still
+         * waiting in the send path. */
+        startTime = IotClock_GetTimeMs();
+
+        while( IotPerfMqttLoopback_PublishCount() < published )
+        {
+            TEST_ASSERT_LESS_THAN( IOT_PERF_MQTT_TIMEOUT_MS, IotClock_GetTimeMs() - startTime );
+            IotClock_SleepMs( 1 );
+        }
+
+        inFlight = _memoryInUse();
+
+        IotPerfMqttLoopback_HoldAcks( false );
+
+        for( i = 0; i < published; i++ )
+        {
+            TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &_completeSem,
+                                                                 IOT_PERF_MQTT_TIMEOUT_MS ) );
+        }
+
+        TEST_ASSERT_EQUAL( 0, _failureCount );
+
+        _printResult( "{\"benchmark\":\"mqtt_heap_per_message\",\"messages\":%lu,"
+                      "\"payload_bytes\":%d,\"bytes_per_message\":%lu}",
+                      ( unsigned long ) published,
+                      IOT_PERF_MQTT_PAYLOAD_LENGTH,
+                      ( unsigned long ) ( ( inFlight > baseline ) ? ( inFlight - baseline ) / published : 0 ) );
+    }
+
+    IotPerfMqttLoopback_HoldAcks( false );
+    _disconnect();
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,964 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_perf_mqtt_loopback.c
+ * @brief Implements the loopback MQTT server in iot_perf_mqtt_loopback.h
+ *
+ * The server keeps all of its state in statically-allocated buffers so that
+ * it does not affect measurements of the MQTT library's heap usage.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* Platform layer includes. */
+#include "platform/iot_clock.h"
+#include "platform/iot_threads.h"
+
+/* Loopback server include. */
+#include "iot_perf_mqtt_loopback.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Size of the buffer of bytes sent by the client but not yet processed.
+ */
+#define CLIENT_BUFFER_SIZE    ( 8192 )
+
+/**
+ * @brief Size of the buffer of responses waiting to be delivered.
+ */
+#define RESPONSE_RING_SIZE    ( 65536 )
+
+/**
+ * @brief Size of the buffer of bytes being delivered to the client. Also the
+ * largest response.
+ */
+#define DELIVERY_SIZE         ( 4096 )
+
+/**
+ * @brief The largest number of PUBACKs that may be held.
+ */
+#define MAX_HELD_ACKS         ( 1024 )
+
+/**
+ * @brief How long the server thread waits when it has nothing to deliver.
+ */
+#define IDLE_WAIT_MS          ( 100 )
+
+/*
+ * MQTT packet types, as the first byte of the fixed header.
+ */
+#define PACKET_CONNECT        ( 0x10 ) /**< @brief CONNECT. */
+#define PACKET_CONNACK        ( 0x20 ) /**< @brief CONNACK. */
+#define PACKET_PUBLISH        ( 0x30 ) /**< @brief PUBLISH, without flags. */
+#define PACKET_PUBACK         ( 0x40 ) /**< @brief PUBACK. */
+#define PACKET_SUBSCRIBE      ( 0x82 ) /**< @brief SUBSCRIBE. */
+#define PACKET_SUBACK         ( 0x90 ) /**< @brief SUBACK. */
+#define PACKET_UNSUBSCRIBE    ( 0xa2 ) /**< @brief UNSUBSCRIBE. */
+#define PACKET_UNSUBACK       ( 0xb0 ) /**< @brief UNSUBACK. */
+#define PACKET_PINGREQ        ( 0xc0 ) /**< @brief PINGREQ. */
+#define PACKET_PINGRESP       ( 0xd0 ) /**< @brief PINGRESP. */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Header of a response in the response ring.
+ */
+typedef struct _responseHeader
+{
+    uint64_t deliveryTime; /**< @brief When the response may be delivered. */
+    size_t length;         /**< @brief Length of the response that follows. */
+} _responseHeader_t;
+
+/**
+ * @brief State of the loopback server.
+ */
+typedef struct _loopbackServer
+{
+    IotMutex_t mutex;                     /**< @brief Guards the members below, except where noted. */
+    IotMutex_t callbackMutex;             /**< @brief Recursive; held while the receive callback is invoked. */
+    IotSemaphore_t wake;                  /**< @brief Wakes the server thread. */
+    IotSemaphore_t stopped;               /**< @brief Posted when the server thread exits. */
+    bool running;                         /**< @brief Whether the server thread should keep running. */
+    IotPerfMqttLoopbackConfig_t config;   /**< @brief Behavior of the server. */
+    uint32_t randomState;                 /**< @brief State of the generator used to drop PUBACKs. */
+
+    IotNetworkReceiveCallback_t callback; /**< @brief Receive callback; guarded by callbackMutex. */
+    void * pCallbackContext;              /**< @brief Receive callback context; guarded by callbackMutex. */
+
+    uint8_t pClientData[ CLIENT_BUFFER_SIZE ];     /**< @brief Bytes sent by the client but not processed. */
+    size_t clientDataLength;                       /**< @brief Length of pClientData. */
+
+    uint8_t pResponses[ RESPONSE_RING_SIZE ];      /**< @brief Responses waiting to be delivered. */
+    size_t responseStart;                          /**< @brief Offset of the oldest response. */
+    size_t responseLength;                         /**< @brief Bytes in use in pResponses. */
+
+    uint16_t pHeldAcks[ MAX_HELD_ACKS ];           /**< @brief Packet identifiers of held PUBACKs. */
+    size_t heldAckCount;                           /**< @brief Number of held PUBACKs. */
+    bool holdAcks;                                 /**< @brief Whether PUBACKs are being held. */
+
+    uint32_t publishCount;                         /**< @brief PUBLISH packets received from the client. */
+    uint8_t pScratch[ DELIVERY_SIZE ];             /**< @brief Used to build responses. */
+
+    uint8_t pInjectPacket[ 256 ];                  /**< @brief The PUBLISH sent by #IotPerfMqttLoopback_Inject. */
+    size_t injectPacketLength;                     /**< @brief Length of pInjectPacket. */
+    uint32_t injectRemaining;                      /**< @brief Copies of pInjectPacket left to send. */
+
+    uint8_t pDelivery[ DELIVERY_SIZE ];            /**< @brief Bytes being delivered; used only by the server thread. */
+    size_t deliveryLength;                         /**< @brief Length of pDelivery. */
+    size_t deliveryOffset;                         /**< @brief Bytes of pDelivery read by the client. */
+} _loopbackServer_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The loopback server.
+ */
+static _loopbackServer_t _server;
+
+/**
+ * @brief Connection handle given to the MQTT library. Its value is not used.
+ */
+static int _connection = 0;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Implements #IotNetworkInterface_t.setReceiveCallback.
+ */
+static IotNetworkError_t _setReceiveCallback( void * pConnection,
+                                              IotNetworkReceiveCallback_t receiveCallback,
+                                              void * pContext );
+
+/**
+ * @brief Implements #IotNetworkInterface_t.send.
+ */
+static size_t _send( void * pConnection,
+                     const uint8_t * pMessage,
+                     size_t messageLength );
+
+/**
+ * @brief Implements #IotNetworkInterface_t.sendv.
+ */
+static size_t _sendv( void * pConnection,
+                      const IotNetworkIoVector_t * pVectors,
+                      size_t vectorCount );
+
+/**
+ * @brief Implements #IotNetworkInterface_t.receive.
+ */
+static size_t _receive( void * pConnection,
+                        uint8_t * pBuffer,
+                        size_t bytesRequested );
+
+/**
+ * @brief Implements #IotNetworkInterface_t.close.
+ */
+static IotNetworkError_t _close( void * pConnection );
+
+/**
+ * @brief Implements #IotNetworkInterface_t.destroy.
+ */
+static IotNetworkError_t _destroy( void * pConnection );
+
+/*-----------------------------------------------------------*/
+
+const IotNetworkInterface_t IotPerfMqttLoopback =
+{
+    .create             = NULL,
+    .setReceiveCallback = _setReceiveCallback,
+    .send               = _send,
+    .receive            = _receive,
+    .close              = _close,
+    .destroy            = _destroy,
+    .sendv              = _sendv
+};
+
+void * const IotPerfMqttLoopback_Connection = &_connection;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Encode an MQTT remaining length.
+ *
+ * @param[in] length The remaining length.
+ * @param[out] pBuffer Receives up to 4 bytes.
+ *
+ * @return The number of bytes written.
+ */
+static size_t _encodeRemainingLength( size_t length,
+                                      uint8_t * pBuffer )
+{
+    size_t bytes = 0;
+    uint8_t byte = 0;
+
+    do
+    {
+        byte = ( uint8_t ) ( length % 128 );
+        length /= 128;
+
+        if( length > 0 )
+        {
+            byte |= 0x80;
+        }
+
+        pBuffer[ bytes ] = byte;
+        bytes++;
+    } while( length > 0 );
+
+    return bytes;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Decode an MQTT remaining length.
+ *
+ * @param[in] pBuffer The bytes following the first byte of a packet.
+ * @param[in] length Bytes available in `pBuffer`.
+ * @param[out] pRemainingLength The decoded remaining length.
+ *
+ * @return The number of bytes of the remaining length; `0` if `pBuffer` does
+ * not hold the whole remaining length.
+ */
+static size_t _decodeRemainingLength( const uint8_t * pBuffer,
+                                      size_t length,
+                                      size_t * pRemainingLength )
+{
+    size_t bytes = 0, multiplier = 1, remainingLength = 0;
+    bool complete = false;
+
+    while( ( bytes < length ) && ( bytes < 4 ) && ( complete == false ) )
+    {
+        remainingLength += ( size_t ) ( pBuffer[ bytes ] & 0x7f ) * multiplier;
+        multiplier *= 128;
+        complete = ( ( pBuffer[ bytes ] & 0x80 ) == 0 );
+        bytes++;
+    }
+
+    *pRemainingLength = remainingLength;
+
+    return ( complete == true ) ? bytes : 0;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Copy bytes into the response ring. The caller must check that the
+ * ring has space.
+ */
+static void _ringWrite( const void * pData,
+                        size_t length )
+{
+    size_t i = 0, offset = ( _server.responseStart + _server.responseLength ) % RESPONSE_RING_SIZE;
+    const uint8_t * pBytes = pData;
+
+    for( i = 0; i < length; i++ )
+    {
+        _server.pResponses[ offset ] = pBytes[ i ];
+        offset = ( offset + 1 ) % RESPONSE_RING_SIZE;
+    }
+
+    _server.responseLength += length;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Copy bytes out of the response ring.
+ *
+ * @param[out] pData Receives the bytes.
+ * @param[in] length Number of bytes to copy.
+ * @param[in] consume Whether to remove the bytes from the ring.
+ */
+static void _ringRead( void * pData,
+                       size_t length,
+                       bool consume )
+{
+    size_t i = 0, offset = _server.responseStart;
+    uint8_t * pBytes = pData;
+
+    for( i = 0; i < length; i++ )
+    {
+        pBytes[ i ] = _server.pResponses[ offset ];
+        offset = ( offset + 1 ) % RESPONSE_RING_SIZE;
+    }
+
+    if( consume == true )
+    {
+        _server.responseStart = offset;
+        _server.responseLength -= length;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Queue a response for delivery after the configured latency. Must be
+ * called with the server mutex held.
+ *
+ * Responses that do not fit are dropped, as a server would drop them when
+ * its buffers are full.
+ */
+static void _queueResponse( const uint8_t * pResponse,
+                            size_t length )
+{
+    _responseHeader_t header = { 0 };
+
+    if( ( length <= DELIVERY_SIZE ) &&
+        ( _server.responseLength + sizeof( header ) + length <= RESPONSE_RING_SIZE ) )
+    {
+        header.deliveryTime = IotClock_GetTimeMs() + _server.config.latencyMs;
+        header.length = length;
+
+        _ringWrite( &header, sizeof( header ) );
+        _ringWrite( pResponse, length );
+
+        IotSemaphore_Post( &( _server.wake ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Queue a PUBACK. Must be called with the server mutex held.
+ */
+static void _queuePuback( uint16_t packetIdentifier )
+{
+    uint8_t pPuback[ 4 ] = { PACKET_PUBACK, 2, 0, 0 };
+
+    pPuback[ 2 ] = ( uint8_t ) ( packetIdentifier >> 8 );
+    pPuback[ 3 ] = ( uint8_t ) ( packetIdentifier & 0xff );
+
+    _queueResponse( pPuback, sizeof( pPuback ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Decide whether to drop a PUBACK. Must be called with the server
+ * mutex held.
+ */
+static bool _dropPuback( void )
+{
+    /* A linear congruential generator gives repeatable loss between runs. */
+    _server.randomState = ( _server.randomState * 1103515245UL ) + 12345UL;
+
+    return ( ( ( _server.randomState >> 16 ) % 100 ) < _server.config.lossPercent );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Process a PUBLISH from the client. Must be called with the server
+ * mutex held.
+ */
+static void _processPublish( uint8_t firstByte,
+                             const uint8_t * pData,
+                             size_t length )
+{
+    uint8_t qos = ( uint8_t ) ( ( firstByte >> 1 ) & 0x03 );
+    uint16_t topicLength = 0, packetIdentifier = 0;
+    size_t headerLength = 0, payloadOffset = length + 1, echoLength = 0;
+
+    _server.publishCount++;
+
+    if( length >= 2 )
+    {
+        topicLength = ( uint16_t ) ( ( pData[ 0 ] << 8 ) | pData[ 1 ] );
+        payloadOffset = 2 + ( size_t ) topicLength + ( ( qos > 0 ) ? 2 : 0 );
+    }
+
+    /* Malformed PUBLISH packets are ignored. */
+    if( payloadOffset <= length )
+    {
+        if( qos > 0 )
+        {
+            packetIdentifier = ( uint16_t ) ( ( pData[ 2 + topicLength ] << 8 ) |
+                                              pData[ 3 + topicLength ] );
+
+            if( ( _server.holdAcks == true ) && ( _server.heldAckCount < MAX_HELD_ACKS ) )
+            {
+                _server.pHeldAcks[ _server.heldAckCount ] = packetIdentifier;
+                _server.heldAckCount++;
+            }
+            else if( _dropPuback() == false )
+            {
+                _queuePuback( packetIdentifier );
+            }
+        }
+
+        /* Echo the topic and payload as a QoS 0 PUBLISH. */
+        if( _server.config.echo == true )
+        {
+            echoLength = 2 + topicLength + ( length - payloadOffset );
+            _server.pScratch[ 0 ] = PACKET_PUBLISH;
+            headerLength = 1 + _encodeRemainingLength( echoLength, _server.pScratch + 1 );
+
+            if( headerLength + echoLength <= DELIVERY_SIZE )
+            {
+                ( void ) memcpy( _server.pScratch + headerLength, pData, 2 + ( size_t ) topicLength );
+                ( void ) memcpy( _server.pScratch + headerLength + 2 + topicLength,
+                                 pData + payloadOffset,
+                                 length - payloadOffset );
+
+                _queueResponse( _server.pScratch, headerLength + echoLength );
+            }
+        }
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Process a SUBSCRIBE from the client, granting every requested QoS.
+ * Must be called with the server mutex held.
+ */
+static void _processSubscribe( const uint8_t * pData,
+                               size_t length )
+{
+    size_t offset = 2, filterCount = 0, headerLength = 0;
+    uint16_t filterLength = 0;
+
+    /* Count the topic filters, each followed by its requested QoS. */
+    while( offset + 2 < length )
+    {
+        filterLength = ( uint16_t ) ( ( pData[ offset ] << 8 ) | pData[ offset + 1 ] );
+        offset += 3 + ( size_t ) filterLength;
+
+        if( offset <= length )
+        {
+            filterCount++;
+        }
+    }
+
+    _server.pScratch[ 0 ] = PACKET_SUBACK;
+    headerLength = 1 + _encodeRemainingLength( 2 + filterCount, _server.pScratch + 1 );
+
+    if( headerLength + 2 + filterCount <= DELIVERY_SIZE )
+    {
+        _server.pScratch[ headerLength ] = pData[ 0 ];
+        _server.pScratch[ headerLength + 1 ] = pData[ 1 ];
+
+        /* Grant the requested QoS of each topic filter. */
+        offset = 2;
+        filterCount = 0;
+
+        while( offset + 2 < length )
+        {
+            filterLength = ( uint16_t ) ( ( pData[ offset ] << 8 ) | pData[ offset + 1 ] );
+            offset += 3 + ( size_t ) filterLength;
+
+            if( offset <= length )
+            {
+                _server.pScratch[ headerLength + 2 + filterCount ] = pData[ offset - 1 ] & 0x03;
+                filterCount++;
+            }
+        }
+
+        _queueResponse( _server.pScratch, headerLength + 2 + filterCount );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Process one complete packet from the client. Must be called with the
+ * server mutex held.
+ */
+static void _processPacket( uint8_t firstByte,
+                            const uint8_t * pData,
+                            size_t length )
+{
+    uint8_t pResponse[ 4 ] = { 0 };
+
+    if( ( firstByte & 0xf0 ) == PACKET_PUBLISH )
+    {
+        _processPublish( firstByte, pData, length );
+    }
+    else if( firstByte == PACKET_CONNECT )
+    {
+        /* Accept the connection without a session present. */
+        pResponse[ 0 ] = PACKET_CONNACK;
+        pResponse[ 1 ] = 2;
+        _queueResponse( pResponse, 4 );
+    }
+    else if( ( firstByte == PACKET_SUBSCRIBE ) && ( length >= 2 ) )
+    {
+        _processSubscribe( pData, length );
+    }
+    else if( ( firstByte == PACKET_UNSUBSCRIBE ) && ( length >= 2 ) )
+    {
+        pResponse[ 0 ] = PACKET_UNSUBACK;
+        pResponse[ 1 ] = 2;
+        pResponse[ 2 ] = pData[ 0 ];
+        pResponse[ 3 ] = pData[ 1 ];
+        _queueResponse( pResponse, 4 );
+    }
+    else if( firstByte == PACKET_PINGREQ )
+    {
+        pResponse[ 0 ] = PACKET_PINGRESP;
+        _queueResponse( pResponse, 2 );
+    }
+    else
+    {
+        /* PUBACKs and DISCONNECT need no response. */
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Receive bytes from the client and process every complete packet.
+ */
+static size_t _receiveFromClient( const IotNetworkIoVector_t * pVectors,
+                                  size_t vectorCount )
+{
+    size_t i = 0, totalLength = 0, offset = 0, lengthBytes = 0, remainingLength = 0;
+    bool complete = false;
+
+    IotMutex_Lock( &( _server.mutex ) );
+
+    for( i = 0; i < vectorCount; i++ )
+    {
+        totalLength += pVectors[ i ].length;
+    }
+
+    if( _server.clientDataLength + totalLength > CLIENT_BUFFER_SIZE )
+    {
+        /* Refuse data that doesn't fit; the MQTT library treats this as a
+         * network error. */
+        totalLength = 0;
+    }
+    else
+    {
+        for( i = 0; i < vectorCount; i++ )
+        {
+            ( void ) memcpy( _server.pClientData + _server.clientDataLength,
+                             pVectors[ i ].pBuffer,
+                             pVectors[ i ].length );
+            _server.clientDataLength += pVectors[ i ].length;
+        }
+
+        /* Process every complete packet. */
+        do
+        {
+            complete = false;
+
+            if( _server.clientDataLength - offset >= 2 )
+            {
+                lengthBytes = _decodeRemainingLength( _server.pClientData + offset + 1,
+                                                      _server.clientDataLength - offset - 1,
+                                                      &remainingLength );
+
+                if( ( lengthBytes > 0 ) &&
+                    ( offset + 1 + lengthBytes + remainingLength <= _server.clientDataLength ) )
+                {
+                    _processPacket( _server.pClientData[ offset ],
+                                    _server.pClientData + offset + 1 + lengthBytes,
+                                    remainingLength );
+
+                    offset += 1 + lengthBytes + remainingLength;
+                    complete = true;
+                }
+            }
+        } while( complete == true );
+
+        /* Keep any partial packet for the next send. */
+        ( void ) memmove( _server.pClientData,
+                          _server.pClientData + offset,
+                          _server.clientDataLength - offset );
+        _server.clientDataLength -= offset;
+    }
+
+    IotMutex_Unlock( &( _server.mutex ) );
+
+    return totalLength;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Take the next response that is due, or injected PUBLISH messages, for
+ * delivery. Must be called with the server mutex held.
+ *
+ * @param[out] pWaitMs How long to wait if nothing was taken.
+ *
+ * @return `true` if bytes were placed in the delivery buffer.
+ */
+static bool _takeDelivery( uint32_t * pWaitMs )
+{
+    bool taken = false;
+    uint64_t currentTime = IotClock_GetTimeMs();
+    _responseHeader_t header = { 0 };
+
+    *pWaitMs = IDLE_WAIT_MS;
+
+    if( _server.responseLength > 0 )
+    {
+        _ringRead( &header, sizeof( header ), false );
+
+        if( header.deliveryTime <= currentTime )
+        {
+            _ringRead( &header, sizeof( header ), true );
+            _ringRead( _server.pDelivery, header.length, true );
+            _server.deliveryLength = header.length;
+            taken = true;
+        }
+        else
+        {
+            *pWaitMs = ( uint32_t ) ( header.deliveryTime - currentTime );
+        }
+    }
+    else if( _server.injectRemaining > 0 )
+    {
+        /* Fill the delivery buffer with as many copies as fit. */
+        while( ( _server.injectRemaining > 0 ) &&
+               ( _server.deliveryLength + _server.injectPacketLength <= DELIVERY_SIZE ) )
+        {
+            ( void ) memcpy( _server.pDelivery + _server.deliveryLength,
+                             _server.pInjectPacket,
+                             _server.injectPacketLength );
+            _server.deliveryLength += _server.injectPacketLength;
+            _server.injectRemaining--;
+        }
+
+        taken = true;
+    }
+
+    return taken;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Deliver the bytes in the delivery buffer to the client.
+ */
+static void _deliver( void )
+{
+    size_t previousOffset = 0;
+
+    IotMutex_Lock( &( _server.callbackMutex ) );
+
+    /* The receive callback processes one packet per call. Stop if it stops
+     * reading, which happens if the connection is closed. */
+    while( ( _server.callback != NULL ) &&
+           ( _server.deliveryOffset < _server.deliveryLength ) )
+    {
+        previousOffset = _server.deliveryOffset;
+        _server.callback( IotPerfMqttLoopback_Connection, _server.pCallbackContext );
+
+        if( _server.deliveryOffset == previousOffset )
+        {
+            break;
+        }
+    }
+
+    _server.deliveryOffset = 0;
+    _server.deliveryLength = 0;
+
+    IotMutex_Unlock( &( _server.callbackMutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The server thread, which delivers responses to the client.
+ */
+static void _serverThread( void * pArgument )
+{
+    bool running = true, delivery = false;
+    uint32_t waitMs = 0;
+
+    ( void ) pArgument;
+
+    while( running == true )
+    {
+        IotMutex_Lock( &( _server.mutex ) );
+        running = _server.running;
+        delivery = ( running == true ) && ( _takeDelivery( &waitMs ) == true );
+        IotMutex_Unlock( &( _server.mutex ) );
+
+        if( delivery == true )
+        {
+            _deliver();
+        }
+        else if( running == true )
+        {
+            ( void ) IotSemaphore_TimedWait( &( _server.wake ), waitMs );
+        }
+    }
+
+    IotSemaphore_Post( &( _server.stopped ) );
+}
+
+/*-----------------------------------------------------------*/
+
+static IotNetworkError_t _setReceiveCallback( void * pConnection,
+                                              IotNetworkReceiveCallback_t receiveCallback,
+                                              void * pContext )
+{
+    ( void ) pConnection;
+
+    IotMutex_Lock( &( _server.callbackMutex ) );
+    _server.callback = receiveCallback;
+    _server.pCallbackContext = pContext;
+    IotMutex_Unlock( &( _server.callbackMutex ) );
+
+    return IOT_NETWORK_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t _send( void * pConnection,
+                     const uint8_t * pMessage,
+                     size_t messageLength )
+{
+    IotNetworkIoVector_t vector = { 0 };
+
+    ( void ) pConnection;
+
+    vector.pBuffer = pMessage;
+    vector.length = messageLength;
+
+    return _receiveFromClient( &vector, 1 );
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t _sendv( void * pConnection,
+                      const IotNetworkIoVector_t * pVectors,
+                      size_t vectorCount )
+{
+    ( void ) pConnection;
+
+    return _receiveFromClient( pVectors, vectorCount );
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t _receive( void * pConnection,
+                        uint8_t * pBuffer,
+                        size_t bytesRequested )
+{
+    size_t bytesAvailable = _server.deliveryLength - _server.deliveryOffset;
+
+    ( void ) pConnection;
+
+    /* Only called from the receive callback, on the server thread. */
+    if( bytesRequested > bytesAvailable )
+    {
+        bytesRequested = bytesAvailable;
+    }
+
+    ( void ) memcpy( pBuffer, _server.pDelivery + _server.deliveryOffset, bytesRequested );
+    _server.deliveryOffset += bytesRequested;
+
+    return bytesRequested;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotNetworkError_t _close( void * pConnection )
+{
+    ( void ) pConnection;
+
+    /* Wait for any receive callback to return; the callback mutex is recursive
+     * so that the connection may be closed from the receive callback. */
+    IotMutex_Lock( &( _server.callbackMutex ) );
+    _server.callback = NULL;
+    _server.pCallbackContext = NULL;
+    IotMutex_Unlock( &( _server.callbackMutex ) );
+
+    /* Discard everything in flight. */
+    IotMutex_Lock( &( _server.mutex ) );
+    _server.clientDataLength = 0;
+    _server.responseStart = 0;
+    _server.responseLength = 0;
+    _server.heldAckCount = 0;
+    _server.injectRemaining = 0;
+    IotMutex_Unlock( &( _server.mutex ) );
+
+    return IOT_NETWORK_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotNetworkError_t _destroy( void * pConnection )
+{
+    ( void ) pConnection;
+
+    return IOT_NETWORK_SUCCESS;
+}
+
+/*-----------------------------------------------------------*/
+
+bool IotPerfMqttLoopback_Start( const IotPerfMqttLoopbackConfig_t * pConfig )
+{
+    bool status = true, mutexCreated = false, callbackMutexCreated = false,
+         wakeCreated = false, stoppedCreated = false;
+
+    ( void ) memset( &_server, 0x00, sizeof( _loopbackServer_t ) );
+    _server.config = *pConfig;
+    _server.randomState = 1;
+    _server.running = true;
+
+    mutexCreated = IotMutex_Create( &( _server.mutex ), false );
+    callbackMutexCreated = IotMutex_Create( &( _server.callbackMutex ), true );
+    wakeCreated = IotSemaphore_Create( &( _server.wake ), 0, RESPONSE_RING_SIZE );
+    stoppedCreated = IotSemaphore_Create( &( _server.stopped ), 0, 1 );
+
+    status = ( mutexCreated == true ) && ( callbackMutexCreated == true ) &&
+             ( wakeCreated == true ) && ( stoppedCreated == true );
+
+    if( status == true )
+    {
+        status = Iot_CreateDetachedThread( _serverThread,
+                                           NULL,
+                                           IOT_THREAD_DEFAULT_PRIORITY,
+                                           IOT_THREAD_DEFAULT_STACK_SIZE );
+    }
+
+    if( status == false )
+    {
+        if( mutexCreated == true )
+        {
+            IotMutex_Destroy( &( _server.mutex ) );
+        }
+
+        if( callbackMutexCreated == true )
+        {
+            IotMutex_Destroy( &( _server.callbackMutex ) );
+        }
+
+        if( wakeCreated == true )
+        {
+            IotSemaphore_Destroy( &( _server.wake ) );
+        }
+
+        if( stoppedCreated == true )
+        {
+            IotSemaphore_Destroy( &( _server.stopped ) );
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+void IotPerfMqttLoopback_Stop( void )
+{
+    IotMutex_Lock( &( _server.mutex ) );
+    _server.running = false;
+    IotMutex_Unlock( &( _server.mutex ) );
+
+    IotSemaphore_Post( &( _server.wake ) );
+    IotSemaphore_Wait( &( _server.stopped ) );
+
+    IotMutex_Destroy( &( _server.mutex ) );
+    IotMutex_Destroy( &( _server.callbackMutex ) );
+    IotSemaphore_Destroy( &( _server.wake ) );
+    IotSemaphore_Destroy( &( _server.stopped ) );
+}
+
+/*-----------------------------------------------------------*/
+
+void IotPerfMqttLoopback_HoldAcks( bool hold )
+{
+    size_t i = 0;
+
+    IotMutex_Lock( &( _server.mutex ) );
+
+    _server.holdAcks = hold;
+
+    if( hold == false )
+    {
+        for( i = 0; i < _server.heldAckCount; i++ )
+        {
+            _queuePuback( _server.pHeldAcks[ i ] );
+        }
+
+        _server.heldAckCount = 0;
+    }
+
+    IotMutex_Unlock( &( _server.mutex ) );
+}
+
+/*-----------------------------------------------------------*/
+
+uint32_t IotPerfMqttLoopback_PublishCount( void )
+{
+    uint32_t publishCount = 0;
+
+    IotMutex_Lock( &( _server.mutex ) );
+    publishCount = _server.publishCount;
+    IotMutex_Unlock( &( _server.mutex ) );
+
+    return publishCount;
+}
+
+/*-----------------------------------------------------------*/
+
+bool IotPerfMqttLoopback_Inject( const char * pTopicName,
+                                 uint16_t topicNameLength,
+                                 size_t payloadLength,
+                                 uint32_t count )
+{
+    bool status = false;
+    size_t headerLength = 0;
+    uint8_t pHeader[ 5 ] = { PACKET_PUBLISH };
+
+    headerLength = 1 + _encodeRemainingLength( 2 + ( size_t ) topicNameLength + payloadLength,
+                                               pHeader + 1 );
+
+    IotMutex_Lock( &( _server.mutex ) );
+
+    if( headerLength + 2 + topicNameLength + payloadLength <= sizeof( _server.pInjectPacket ) )
+    {
+        ( void ) memcpy( _server.pInjectPacket, pHeader, headerLength );
+        _server.pInjectPacket[ headerLength ] = ( uint8_t ) ( topicNameLength >> 8 );
+        _server.pInjectPacket[ headerLength + 1 ] = ( uint8_t ) ( topicNameLength & 0xff );
+        ( void ) memcpy( _server.pInjectPacket + headerLength + 2, pTopicName, topicNameLength );
+        ( void ) memset( _server.pInjectPacket + headerLength + 2 + topicNameLength, 0xa5, payloadLength );
+
+        _server.injectPacketLength = headerLength + 2 + topicNameLength + payloadLength;
+        _server.injectRemaining = count;
+        status = true;
+
+        IotSemaphore_Post( &( _server.wake ) );
+    }
+
+    IotMutex_Unlock( &( _server.mutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
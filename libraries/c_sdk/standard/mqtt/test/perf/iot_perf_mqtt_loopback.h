@@ -0,0 +1,128 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_perf_mqtt_loopback.h
+ * @brief An in-process MQTT server stand-in for the MQTT performance tests.
+ *
+ * The loopback server implements #IotNetworkInterface_t. It answers CONNECT,
+ * SUBSCRIBE, UNSUBSCRIBE, and PINGREQ, acknowledges QoS 1 PUBLISH messages, and
+ * may echo PUBLISH messages back to the client. Every response is delivered
+ * from a separate thread after a configurable latency, and PUBACKs may be
+ * dropped to simulate loss.
+ *
+ * Only one MQTT connection may use the loopback server at a time.
+ */
+
+#ifndef IOT_PERF_MQTT_LOOPBACK_H_
+#define IOT_PERF_MQTT_LOOPBACK_H_
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Platform network include. */
+#include "platform/iot_network.h"
+
+/**
+ * @brief Behavior of the loopback server.
+ */
+typedef struct IotPerfMqttLoopbackConfig
+{
+    uint32_t latencyMs;   /**< @brief Delay before each response is delivered to the client. */
+    uint32_t lossPercent; /**< @brief Percentage of PUBACKs that are not sent. */
+    bool echo;            /**< @brief Whether to send each PUBLISH back to the client at QoS 0. */
+} IotPerfMqttLoopbackConfig_t;
+
+/**
+ * @brief The network interface of the loopback server.
+ *
+ * Pass #IotPerfMqttLoopback_Connection as the network connection, with
+ * #IotMqttNetworkInfo_t.createNetworkConnection set to `false`.
+ */
+extern const IotNetworkInterface_t IotPerfMqttLoopback;
+
+/**
+ * @brief The network connection to the loopback server.
+ */
+extern void * const IotPerfMqttLoopback_Connection;
+
+/**
+ * @brief Start the loopback server.
+ *
+ * @param[in] pConfig Behavior of the server.
+ *
+ * @return `true` if the server was started; `false` otherwise.
+ */
+bool IotPerfMqttLoopback_Start( const IotPerfMqttLoopbackConfig_t * pConfig );
+
+/**
+ * @brief Stop the loopback server. Must be called after the MQTT connection
+ * has been closed.
+ */
+void IotPerfMqttLoopback_Stop( void );
+
+/**
+ * @brief Hold or release PUBACKs.
+ *
+ * While PUBACKs are held, QoS 1 PUBLISH messages are received but not
+ * acknowledged. Releasing them sends every held PUBACK.
+ *
+ * @param[in] hold `true` to hold PUBACKs; `false` to release them.
+ */
+void IotPerfMqttLoopback_HoldAcks( bool hold );
+
+/**
+ * @brief Get the number of PUBLISH messages received from the client.
+ *
+ * @return The number of PUBLISH packets, including retransmissions, received
+ * since the server was started.
+ */
+uint32_t IotPerfMqttLoopback_PublishCount( void );
+
+/**
+ * @brief Send QoS 0 PUBLISH messages to the client.
+ *
+ * The messages are generated on the server's thread, so that the cost of
+ * generating them is not attributed to the caller.
+ *
+ * @param[in] pTopicName Topic name of the messages.
+ * @param[in] topicNameLength Length of `pTopicName`.
+ * @param[in] payloadLength Length of the payload of each message.
+ * @param[in] count The number of messages to send.
+ *
+ * @return `true` if the messages will be sent; `false` if the topic and
+ * payload are too large.
+ */
+bool IotPerfMqttLoopback_Inject( const char * pTopicName,
+                                 uint16_t topicNameLength,
+                                 size_t payloadLength,
+                                 uint32_t count );
+
+#endif /* ifndef IOT_PERF_MQTT_LOOPBACK_H_ */
@@ -122,6 +122,12 @@
       4 * DUP_CHECK_RETRY_MS + \
       IOT_MQTT_RESPONSE_WAIT_MS )
 
+/**
+ * @brief How many PUBLISH messages #TEST_MQTT_Unit_API_SendQueueCoalesce queues
+ * behind a blocked send. They must fit in @ref IOT_MQTT_SEND_COALESCE_SIZE.
+ */
+#define COALESCE_PUBLISH_COUNT     ( 4 )
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -134,6 +140,21 @@ static bool _publishSetDupCalled = false;
  */
 static int32_t _pingreqSendCount = 0;
 
+/**
+ * @brief The payload that #_sendvChecker expects to be sent without a copy.
+ */
+static const uint8_t * _pNoCopyPayload = NULL;
+
+/**
+ * @brief Counts how many times #_sendBlockFirst has been called.
+ */
+static size_t _blockedSendCount = 0;
+
+/**
+ * @brief The lengths of the first three sends made by #_sendBlockFirst.
+ */
+static size_t _pBlockedSendLengths[ 3 ] = { 0 };
+
 /**
  * @brief Counts how many times #_close has been called.
  */
@@ -285,6 +306,35 @@ static size_t _sendPingreq( void * pSendContext,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief A gather send function that checks that a PUBLISH payload was not
+ * copied into the MQTT packet. Reports that it was invoked through a semaphore.
+ */
+static size_t _sendvChecker( void * pSendContext,
+                             const IotNetworkIoVector_t * pVectors,
+                             size_t vectorCount )
+{
+    size_t i = 0, bytesSent = 0;
+    IotSemaphore_t * pWaitSem = ( IotSemaphore_t * ) pSendContext;
+
+    /* The PUBLISH header and payload must be sent from separate buffers. */
+    TEST_ASSERT_EQUAL( 2, vectorCount );
+    TEST_ASSERT_EQUAL_HEX8( MQTT_PACKET_TYPE_PUBLISH, pVectors[ 0 ].pBuffer[ 0 ] & 0xf0 );
+    TEST_ASSERT_EQUAL_PTR( _pNoCopyPayload, pVectors[ 1 ].pBuffer );
+
+    for( i = 0; i < vectorCount; i++ )
+    {
+        bytesSent += pVectors[ i ].length;
+    }
+
+    IotSemaphore_Post( pWaitSem );
+
+    /* Report that all buffers were sent. */
+    return bytesSent;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief A send function that delays.
  */
@@ -309,6 +359,42 @@ static size_t _sendDelay( void * pSendContext,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief A send function that blocks its first call until released.
+ *
+ * The send context is an array of two semaphores. The first is posted after
+ * every send; the second releases the first send.
+ */
+static size_t _sendBlockFirst( void * pSendContext,
+                               const uint8_t * pMessage,
+                               size_t messageLength )
+{
+    IotSemaphore_t * pSemaphores = ( IotSemaphore_t * ) pSendContext;
+
+    /* Silence warnings about unused parameters. */
+    ( void ) pMessage;
+
+    if( _blockedSendCount < 3 )
+    {
+        _pBlockedSendLengths[ _blockedSendCount ] = messageLength;
+    }
+
+    _blockedSendCount++;
+
+    /* Report the send, then block if this is the first send. */
+    IotSemaphore_Post( &( pSemaphores[ 0 ] ) );
+
+    if( _blockedSendCount == 1 )
+    {
+        IotSemaphore_Wait( &( pSemaphores[ 1 ] ) );
+    }
+
+    /* This function returns the message length to simulate a successful send. */
+    return messageLength;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief This send function checks that a duplicate outgoing message differs from
  * the original.
@@ -565,6 +651,11 @@ TEST_GROUP_RUNNER( MQTT_Unit_API )
     RUN_TEST_CASE( MQTT_Unit_API, PublishQoS0MallocFail );
     RUN_TEST_CASE( MQTT_Unit_API, PublishQoS1 );
     RUN_TEST_CASE( MQTT_Unit_API, PublishDuplicates );
+    RUN_TEST_CASE( MQTT_Unit_API, PublishNoCopy );
+    RUN_TEST_CASE( MQTT_Unit_API, PublishBatch );
+    RUN_TEST_CASE( MQTT_Unit_API, InflightTable );
+    RUN_TEST_CASE( MQTT_Unit_API, SendQueueCoalesce );
+    RUN_TEST_CASE( MQTT_Unit_API, SendQueuePubackFull );
     RUN_TEST_CASE( MQTT_Unit_API, SubscribeUnsubscribeParameters );
     RUN_TEST_CASE( MQTT_Unit_API, SubscribeMallocFail );
     RUN_TEST_CASE( MQTT_Unit_API, UnsubscribeMallocFail );
@@ -1172,6 +1263,418 @@ TEST( MQTT_Unit_API, PublishDuplicates )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests that @ref mqtt_function_publish sends the payload from the
+ * caller's buffer when #IOT_MQTT_FLAG_NO_COPY is set.
+ */
+TEST( MQTT_Unit_API, PublishNoCopy )
+{
+    IotSemaphore_t waitSem;
+    static const uint8_t pPayload[ 64 ] = { 0 };
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendSuccess;
+    _networkInterface.sendv = _sendvChecker;
+    _pNoCopyPayload = pPayload;
+
+    publishInfo.pTopicName = TEST_TOPIC_NAME;
+    publishInfo.topicNameLength = TEST_TOPIC_NAME_LENGTH;
+    publishInfo.pPayload = pPayload;
+    publishInfo.payloadLength = sizeof( pPayload );
+
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &waitSem, 0, 1 ) );
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    if( TEST_PROTECT() )
+    {
+        _pMqttConnection->pNetworkConnection = &waitSem;
+
+        /* Send a QoS 0 PUBLISH without copying its payload. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Publish( _pMqttConnection,
+                                                              &publishInfo,
+                                                              IOT_MQTT_FLAG_NO_COPY,
+                                                              NULL,
+                                                              NULL ) );
+
+        /* Wait for the PUBLISH to be sent by the gather send function. */
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &waitSem, TIMEOUT_MS ) );
+    }
+
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+
+    IotSemaphore_Destroy( &waitSem );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that @ref mqtt_function_publishbatch sends its PUBLISH messages
+ * with one network write and completes once all of them are acknowledged.
+ */
+TEST( MQTT_Unit_API, PublishBatch )
+{
+    size_t i = 0, packetCount = 0;
+    IotSemaphore_t waitSem;
+    IotMqttError_t status = IOT_MQTT_STATUS_PENDING;
+    static IotMqttPublishInfo_t pPublishInfo[ IOT_MQTT_INFLIGHT_WINDOW + 1 ];
+    uint16_t pPacketIdentifiers[ 3 ] = { 0 };
+    IotMqttOperation_t batchOperation = IOT_MQTT_OPERATION_INITIALIZER;
+    _mqttOperation_t * pPuback = NULL;
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendSuccess;
+
+    for( i = 0; i < IOT_MQTT_INFLIGHT_WINDOW + 1; i++ )
+    {
+        pPublishInfo[ i ] = ( IotMqttPublishInfo_t ) IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+        pPublishInfo[ i ].qos = IOT_MQTT_QOS_1;
+        pPublishInfo[ i ].pTopicName = TEST_TOPIC_NAME;
+        pPublishInfo[ i ].topicNameLength = TEST_TOPIC_NAME_LENGTH;
+        pPublishInfo[ i ].pPayload = "test";
+        pPublishInfo[ i ].payloadLength = 4;
+    }
+
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &waitSem, 0, 2 ) );
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    if( TEST_PROTECT() )
+    {
+        _pMqttConnection->pNetworkConnection = &waitSem;
+
+        /* An empty batch is not allowed. */
+        status = IotMqtt_PublishBatch( _pMqttConnection, pPublishInfo, 0, 0, NULL, NULL );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, status );
+
+        /* Batched PUBLISH messages may not be retried. */
+        pPublishInfo[ 1 ].retryLimit = 1;
+        pPublishInfo[ 1 ].retryMs = 1000;
+        status = IotMqtt_PublishBatch( _pMqttConnection, pPublishInfo, 3, 0, NULL, NULL );
+        TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, status );
+        pPublishInfo[ 1 ].retryLimit = 0;
+        pPublishInfo[ 1 ].retryMs = 0;
+
+        /* A batch larger than the in-flight window is not allowed. */
+        status = IotMqtt_PublishBatch( _pMqttConnection,
+                                       pPublishInfo,
+                                       IOT_MQTT_INFLIGHT_WINDOW + 1,
+                                       0,
+                                       NULL,
+                                       NULL );
+        TEST_ASSERT_EQUAL( IOT_MQTT_NO_MEMORY, status );
+        TEST_ASSERT_EQUAL( 0, _pMqttConnection->inflightCount );
+
+        /* Send a waitable batch of 3 QoS 1 PUBLISH messages. */
+        status = IotMqtt_PublishBatch( _pMqttConnection,
+                                       pPublishInfo,
+                                       3,
+                                       IOT_MQTT_FLAG_WAITABLE,
+                                       NULL,
+                                       &batchOperation );
+        TEST_ASSERT_EQUAL( IOT_MQTT_STATUS_PENDING, status );
+
+        /* The whole batch is sent with a single network write. */
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &waitSem, TIMEOUT_MS ) );
+        TEST_ASSERT_EQUAL_INT( false, IotSemaphore_TryWait( &waitSem ) );
+
+        /* Get the packet identifiers of the batch from the in-flight window. */
+        IotMutex_Lock( &( _pMqttConnection->referencesMutex ) );
+        TEST_ASSERT_EQUAL( 3, _pMqttConnection->inflightCount );
+
+        for( i = 0; i < IOT_MQTT_INFLIGHT_WINDOW; i++ )
+        {
+            if( _pMqttConnection->batchInflight[ i ].pOperation == batchOperation )
+            {
+                pPacketIdentifiers[ packetCount ] = _pMqttConnection->batchInflight[ i ].packetIdentifier;
+                packetCount++;
+            }
+        }
+
+        IotMutex_Unlock( &( _pMqttConnection->referencesMutex ) );
+        TEST_ASSERT_EQUAL( 3, packetCount );
+
+        /* Acknowledge each PUBLISH of the batch as the PUBACK handler would. Only
+         * the last PUBACK may complete the batch. */
+        for( i = 0; i < packetCount; i++ )
+        {
+            pPuback = _IotMqtt_FindOperation( _pMqttConnection,
+                                              IOT_MQTT_PUBLISH_TO_SERVER,
+                                              &( pPacketIdentifiers[ i ] ) );
+
+            if( pPuback != NULL )
+            {
+                TEST_ASSERT_EQUAL( packetCount - 1, i );
+                TEST_ASSERT_EQUAL_PTR( batchOperation, pPuback );
+
+                pPuback->u.operation.status = IOT_MQTT_SUCCESS;
+                _IotMqtt_Notify( pPuback );
+            }
+        }
+
+        /* The batch completes once. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Wait( batchOperation, TIMEOUT_MS ) );
+        TEST_ASSERT_EQUAL( 0, _pMqttConnection->inflightCount );
+    }
+
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+
+    IotSemaphore_Destroy( &waitSem );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that operations beyond the in-flight window are still matched
+ * by packet identifier.
+ */
+TEST( MQTT_Unit_API, InflightTable )
+{
+    size_t i = 0, created = 0;
+    bool inserted = true;
+    uint16_t packetIdentifier = 0;
+    static _mqttOperation_t * pOperations[ MQTT_INFLIGHT_BUCKETS + IOT_MQTT_INFLIGHT_WINDOW ] = { 0 };
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    if( TEST_PROTECT() )
+    {
+        /* Put the operations in flight, as the send job does after sending them.
+         * With static memory, only as many operations as the operation pool
+         * holds can be in flight. */
+        for( created = 0; created < MQTT_INFLIGHT_BUCKETS + IOT_MQTT_INFLIGHT_WINDOW; created++ )
+        {
+            if( _IotMqtt_CreateOperation( _pMqttConnection,
+                                          0,
+                                          NULL,
+                                          &( pOperations[ created ] ) ) != IOT_MQTT_SUCCESS )
+            {
+                break;
+            }
+
+            pOperations[ created ]->u.operation.type = IOT_MQTT_SUBSCRIBE;
+            pOperations[ created ]->u.operation.packetIdentifier = ( uint16_t ) ( created + 1 );
+
+            IotMutex_Lock( &( _pMqttConnection->referencesMutex ) );
+            IotListDouble_Remove( &( pOperations[ created ]->link ) );
+            IotListDouble_InsertHead( &( _pMqttConnection->pendingResponse ),
+                                      &( pOperations[ created ]->link ) );
+            pOperations[ created ]->u.operation.batchSent = true;
+            inserted = inserted && _IotMqtt_InflightInsert( _pMqttConnection,
+                                                            pOperations[ created ]->u.operation.packetIdentifier,
+                                                            pOperations[ created ] );
+            IotMutex_Unlock( &( _pMqttConnection->referencesMutex ) );
+        }
+
+        TEST_ASSERT_GREATER_THAN( 0, created );
+        TEST_ASSERT_EQUAL_INT( true, inserted );
+        TEST_ASSERT_EQUAL( created, _pMqttConnection->inflightCount );
+
+        /* A response of another type does not match. */
+        packetIdentifier = 1;
+        TEST_ASSERT_NULL( _IotMqtt_FindOperation( _pMqttConnection,
+                                                  IOT_MQTT_UNSUBSCRIBE,
+                                                  &packetIdentifier ) );
+
+        /* Every operation is matched and removed from the table, including those
+         * in the same bucket as others. */
+        for( i = 0; i < created; i++ )
+        {
+            packetIdentifier = ( uint16_t ) ( i + 1 );
+
+            TEST_ASSERT_EQUAL_PTR( pOperations[ i ],
+                                   _IotMqtt_FindOperation( _pMqttConnection,
+                                                           IOT_MQTT_SUBSCRIBE,
+                                                           &packetIdentifier ) );
+            TEST_ASSERT_EQUAL( created - i - 1, _pMqttConnection->inflightCount );
+        }
+
+        /* An operation is matched only once. */
+        packetIdentifier = 1;
+        TEST_ASSERT_NULL( _IotMqtt_FindOperation( _pMqttConnection,
+                                                  IOT_MQTT_SUBSCRIBE,
+                                                  &packetIdentifier ) );
+    }
+
+    for( i = 0; i < created; i++ )
+    {
+        _IotMqtt_DestroyOperation( pOperations[ i ] );
+    }
+
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that small packets added to the send queue while a send is in
+ * progress are sent together.
+ */
+TEST( MQTT_Unit_API, SendQueueCoalesce )
+{
+    size_t i = 0;
+    IotSemaphore_t pSemaphores[ 2 ];
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendBlockFirst;
+    _blockedSendCount = 0;
+
+    publishInfo.pTopicName = TEST_TOPIC_NAME;
+    publishInfo.topicNameLength = TEST_TOPIC_NAME_LENGTH;
+    publishInfo.pPayload = "test";
+    publishInfo.payloadLength = 4;
+
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( pSemaphores[ 0 ] ), 0, 2 ) );
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( pSemaphores[ 1 ] ), 0, 1 ) );
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    if( TEST_PROTECT() )
+    {
+        _pMqttConnection->pNetworkConnection = pSemaphores;
+
+        /* The first PUBLISH blocks the send queue writer. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Publish( _pMqttConnection,
+                                                              &publishInfo,
+                                                              0,
+                                                              NULL,
+                                                              NULL ) );
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &( pSemaphores[ 0 ] ), TIMEOUT_MS ) );
+
+        /* Queue more PUBLISH messages while the writer is blocked. */
+        for( i = 0; i < COALESCE_PUBLISH_COUNT; i++ )
+        {
+            TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Publish( _pMqttConnection,
+                                                                  &publishInfo,
+                                                                  0,
+                                                                  NULL,
+                                                                  NULL ) );
+        }
+
+        /* Release the writer and wait for its next send. */
+        IotSemaphore_Post( &( pSemaphores[ 1 ] ) );
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &( pSemaphores[ 0 ] ), TIMEOUT_MS ) );
+
+        /* The queued PUBLISH messages must have been sent with one send. */
+        TEST_ASSERT_EQUAL( 2, _blockedSendCount );
+        TEST_ASSERT_EQUAL( COALESCE_PUBLISH_COUNT * _pBlockedSendLengths[ 0 ],
+                           _pBlockedSendLengths[ 1 ] );
+    }
+
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+
+    IotSemaphore_Destroy( &( pSemaphores[ 0 ] ) );
+    IotSemaphore_Destroy( &( pSemaphores[ 1 ] ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that the network receive callback does not wait for room when
+ * the PUBACK queue is full.
+ */
+TEST( MQTT_Unit_API, SendQueuePubackFull )
+{
+    uint16_t i = 0;
+    IotSemaphore_t pSemaphores[ 2 ];
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+
+    /* Initialize parameters. */
+    _networkInterface.send = _sendBlockFirst;
+    _blockedSendCount = 0;
+
+    publishInfo.pTopicName = TEST_TOPIC_NAME;
+    publishInfo.topicNameLength = TEST_TOPIC_NAME_LENGTH;
+    publishInfo.pPayload = "test";
+    publishInfo.payloadLength = 4;
+
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( pSemaphores[ 0 ] ), 0, 2 ) );
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( pSemaphores[ 1 ] ), 0, 1 ) );
+
+    /* Create a new MQTT connection. */
+    _pMqttConnection = IotTestMqtt_createMqttConnection( AWS_IOT_MQTT_SERVER,
+                                                         &_networkInfo,
+                                                         0 );
+    TEST_ASSERT_NOT_NULL( _pMqttConnection );
+
+    if( TEST_PROTECT() )
+    {
+        _pMqttConnection->pNetworkConnection = pSemaphores;
+
+        /* The first PUBLISH blocks the send queue writer. */
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Publish( _pMqttConnection,
+                                                              &publishInfo,
+                                                              0,
+                                                              NULL,
+                                                              NULL ) );
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &( pSemaphores[ 0 ] ), TIMEOUT_MS ) );
+
+        /* Fill the PUBACK queue while the writer is blocked. */
+        for( i = 1; i <= MQTT_PUBACK_QUEUE_SIZE; i++ )
+        {
+            _IotMqtt_EnqueuePuback( _pMqttConnection, i );
+        }
+
+        TEST_ASSERT_EQUAL( 1, _blockedSendCount );
+
+        /* The next PUBACK is sent from the calling task. */
+        _IotMqtt_EnqueuePuback( _pMqttConnection, MQTT_PUBACK_QUEUE_SIZE + 1 );
+        TEST_ASSERT_EQUAL( 2, _blockedSendCount );
+        TEST_ASSERT_EQUAL( 4, _pBlockedSendLengths[ 1 ] );
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &( pSemaphores[ 0 ] ), TIMEOUT_MS ) );
+
+        /* Once the connection is disconnected, it is dropped instead. */
+        IotMutex_Lock( &( _pMqttConnection->referencesMutex ) );
+        _pMqttConnection->disconnected = true;
+        IotMutex_Unlock( &( _pMqttConnection->referencesMutex ) );
+
+        _IotMqtt_EnqueuePuback( _pMqttConnection, MQTT_PUBACK_QUEUE_SIZE + 2 );
+        TEST_ASSERT_EQUAL( 2, _blockedSendCount );
+
+        IotMutex_Lock( &( _pMqttConnection->referencesMutex ) );
+        _pMqttConnection->disconnected = false;
+        IotMutex_Unlock( &( _pMqttConnection->referencesMutex ) );
+
+        /* Release the writer; the queued PUBACKs are sent with one send. */
+        IotSemaphore_Post( &( pSemaphores[ 1 ] ) );
+        TEST_ASSERT_EQUAL_INT( true, IotSemaphore_TimedWait( &( pSemaphores[ 0 ] ), TIMEOUT_MS ) );
+
+        TEST_ASSERT_EQUAL( 3, _blockedSendCount );
+        TEST_ASSERT_EQUAL( MQTT_PUBACK_QUEUE_SIZE * 4, _pBlockedSendLengths[ 2 ] );
+    }
+    else
+    {
+        /* Release the writer if an assertion failed while it was blocked. */
+        IotSemaphore_Post( &( pSemaphores[ 1 ] ) );
+        IotClock_SleepMs( 100 );
+    }
+
+    IotMqtt_Disconnect( _pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+
+    IotSemaphore_Destroy( &( pSemaphores[ 0 ] ) );
+    IotSemaphore_Destroy( &( pSemaphores[ 1 ] ) );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests the behavior of @ref mqtt_function_subscribe and
  * @ref mqtt_function_unsubscribe with various invalid parameters.
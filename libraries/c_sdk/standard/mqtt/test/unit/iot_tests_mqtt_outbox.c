@@ -0,0 +1,554 @@
+/*
+ * Amazon FreeRTOS MQTT V2.0.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_mqtt_outbox.c
+ * @brief Tests for the functions in iot_mqtt_outbox.c
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <string.h>
+
+/* SDK initialization include. */
+#include "iot_init.h"
+
+/* MQTT internal include. */
+#include "private/iot_mqtt_internal.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/* MQTT test access include. */
+#include "iot_test_access_mqtt.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of segments the test storage can hold.
+ */
+#define STORAGE_SEGMENTS    ( 32 )
+
+/**
+ * @brief Size of each outbox segment in the tests.
+ */
+#define SEGMENT_SIZE        ( 128 )
+
+/**
+ * @brief Number of PUBLISH messages written by the tests.
+ */
+#define PUBLISH_COUNT       ( 6 )
+
+/**
+ * @brief Topic name of the PUBLISH messages written by the tests.
+ */
+#define TEST_TOPIC_NAME     ( "/outbox" )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A segment of the test storage.
+ */
+typedef struct _testSegment
+{
+    bool exists;                   /**< @brief Whether this segment exists. */
+    size_t size;                   /**< @brief Bytes written to this segment. */
+    uint8_t pData[ SEGMENT_SIZE ]; /**< @brief Data written to this segment. */
+} _testSegment_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test storage, indexed by segment number.
+ */
+static _testSegment_t _pSegments[ STORAGE_SEGMENTS ] = { 0 };
+
+/**
+ * @brief Network interface used by the MQTT connections. None of its functions
+ * are called.
+ */
+static IotNetworkInterface_t _networkInterface = { 0 };
+
+/**
+ * @brief Network info used by the MQTT connections.
+ */
+static IotMqttNetworkInfo_t _networkInfo = IOT_MQTT_NETWORK_INFO_INITIALIZER;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test implementation of #IotMqttOutboxInterface_t.append.
+ */
+static bool _append( void * pStorage,
+                     uint32_t segment,
+                     const uint8_t * pData,
+                     size_t length )
+{
+    ( void ) pStorage;
+
+    TEST_ASSERT_LESS_THAN( STORAGE_SEGMENTS, segment );
+    TEST_ASSERT_TRUE( _pSegments[ segment ].size + length <= SEGMENT_SIZE );
+
+    ( void ) memcpy( _pSegments[ segment ].pData + _pSegments[ segment ].size, pData, length );
+    _pSegments[ segment ].size += length;
+    _pSegments[ segment ].exists = true;
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test implementation of #IotMqttOutboxInterface_t.read.
+ */
+static size_t _read( void * pStorage,
+                     uint32_t segment,
+                     size_t offset,
+                     uint8_t * pBuffer,
+                     size_t length )
+{
+    size_t bytesRead = 0;
+
+    ( void ) pStorage;
+
+    if( ( segment < STORAGE_SEGMENTS ) && ( offset < _pSegments[ segment ].size ) )
+    {
+        bytesRead = _pSegments[ segment ].size - offset;
+
+        if( bytesRead > length )
+        {
+            bytesRead = length;
+        }
+
+        ( void ) memcpy( pBuffer, _pSegments[ segment ].pData + offset, bytesRead );
+    }
+
+    return bytesRead;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test implementation of #IotMqttOutboxInterface_t.remove.
+ */
+static bool _remove( void * pStorage,
+                     uint32_t segment )
+{
+    ( void ) pStorage;
+
+    TEST_ASSERT_LESS_THAN( STORAGE_SEGMENTS, segment );
+    ( void ) memset( &( _pSegments[ segment ] ), 0x00, sizeof( _testSegment_t ) );
+
+    return true;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test implementation of #IotMqttOutboxInterface_t.range.
+ */
+static bool _range( void * pStorage,
+                    uint32_t * pFirstSegment,
+                    uint32_t * pLastSegment )
+{
+    bool found = false;
+    uint32_t segment = 0;
+
+    ( void ) pStorage;
+
+    for( segment = 0; segment < STORAGE_SEGMENTS; segment++ )
+    {
+        if( _pSegments[ segment ].exists == true )
+        {
+            if( found == false )
+            {
+                *pFirstSegment = segment;
+                found = true;
+            }
+
+            *pLastSegment = segment;
+        }
+    }
+
+    return found;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The test storage functions.
+ */
+static const IotMqttOutboxInterface_t _outboxInterface =
+{
+    .append = _append,
+    .read   = _read,
+    .remove = _remove,
+    .range  = _range
+};
+
+/**
+ * @brief The outbox used by the tests.
+ */
+static const IotMqttOutboxInfo_t _outboxInfo =
+{
+    .pInterface  = &_outboxInterface,
+    .pStorage    = NULL,
+    .segmentSize = SEGMENT_SIZE
+};
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Create an MQTT connection and open its outbox.
+ */
+static _mqttConnection_t * _openOutbox( void )
+{
+    _mqttConnection_t * pMqttConnection = IotTestMqtt_createMqttConnection( false,
+                                                                           &_networkInfo,
+                                                                           0 );
+
+    TEST_ASSERT_NOT_NULL( pMqttConnection );
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _IotMqtt_OutboxOpen( pMqttConnection, &_outboxInfo ) );
+
+    return pMqttConnection;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Close an outbox and destroy its MQTT connection.
+ */
+static void _closeOutbox( _mqttConnection_t * pMqttConnection )
+{
+    _IotMqtt_OutboxClose( pMqttConnection );
+    IotMqtt_Disconnect( pMqttConnection, IOT_MQTT_FLAG_CLEANUP_ONLY );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write a QoS 1 PUBLISH whose payload is its index to an outbox.
+ *
+ * @return The PUBLISH operation; `NULL` if it could not be written.
+ */
+static _mqttOperation_t * _putPublish( _mqttConnection_t * pMqttConnection,
+                                       uint8_t index )
+{
+    IotMqttError_t status = IOT_MQTT_STATUS_PENDING;
+    IotMqttPublishInfo_t publishInfo = IOT_MQTT_PUBLISH_INFO_INITIALIZER;
+    _mqttOperation_t * pOperation = NULL;
+
+    publishInfo.qos = IOT_MQTT_QOS_1;
+    publishInfo.pTopicName = TEST_TOPIC_NAME;
+    publishInfo.topicNameLength = ( uint16_t ) ( sizeof( TEST_TOPIC_NAME ) - 1 );
+    publishInfo.pPayload = &index;
+    publishInfo.payloadLength = 1;
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _IotMqtt_CreateOperation( pMqttConnection,
+                                                                   0,
+                                                                   NULL,
+                                                                   &pOperation ) );
+    pOperation->u.operation.type = IOT_MQTT_PUBLISH_TO_SERVER;
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _IotMqtt_SerializePublish( &publishInfo,
+                                                                    &( pOperation->u.operation.pMqttPacket ),
+                                                                    &( pOperation->u.operation.packetSize ),
+                                                                    &( pOperation->u.operation.packetIdentifier ),
+                                                                    NULL ) );
+
+    status = _IotMqtt_OutboxPut( pOperation );
+
+    if( status != IOT_MQTT_SUCCESS )
+    {
+        TEST_ASSERT_EQUAL( IOT_MQTT_NO_MEMORY, status );
+        TEST_ASSERT_EQUAL_UINT32( 0, pOperation->u.operation.outboxSequence );
+
+        _IotMqtt_DestroyOperation( pOperation );
+        pOperation = NULL;
+    }
+
+    return pOperation;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check the payload of a PUBLISH read from an outbox.
+ */
+static void _checkReplay( const _mqttOperation_t * pOperation,
+                          uint8_t index )
+{
+    TEST_ASSERT_NOT_NULL( pOperation );
+    TEST_ASSERT_EQUAL( IOT_MQTT_PUBLISH_TO_SERVER, pOperation->u.operation.type );
+    TEST_ASSERT_NOT_EQUAL( 0, pOperation->u.operation.packetIdentifier );
+    TEST_ASSERT_EQUAL_UINT8( index,
+                             pOperation->u.operation.pMqttPacket[ pOperation->u.operation.packetSize - 1 ] );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for MQTT outbox tests.
+ */
+TEST_GROUP( MQTT_Unit_Outbox );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for MQTT outbox tests.
+ */
+TEST_SETUP( MQTT_Unit_Outbox )
+{
+    ( void ) memset( _pSegments, 0x00, sizeof( _pSegments ) );
+    _networkInfo.pNetworkInterface = &_networkInterface;
+
+    /* Initialize libraries. */
+    TEST_ASSERT_EQUAL_INT( true, IotSdk_Init() );
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, IotMqtt_Init() );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for MQTT outbox tests.
+ */
+TEST_TEAR_DOWN( MQTT_Unit_Outbox )
+{
+    IotMqtt_Cleanup();
+    IotSdk_Cleanup();
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for MQTT outbox tests.
+ */
+TEST_GROUP_RUNNER( MQTT_Unit_Outbox )
+{
+    RUN_TEST_CASE( MQTT_Unit_Outbox, ReplayUnacked );
+    RUN_TEST_CASE( MQTT_Unit_Outbox, Compaction );
+    RUN_TEST_CASE( MQTT_Unit_Outbox, Full );
+    RUN_TEST_CASE( MQTT_Unit_Outbox, DamagedRecord );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that only unacknowledged PUBLISH messages are read from an
+ * outbox, in the order they were written.
+ */
+TEST( MQTT_Unit_Outbox, ReplayUnacked )
+{
+    uint8_t i = 0;
+    _mqttConnection_t * pMqttConnection = NULL;
+    _mqttOperation_t * pOperations[ PUBLISH_COUNT ] = { NULL }, * pReplay = NULL;
+
+    /* Write PUBLISH messages and acknowledge the first and fourth. */
+    pMqttConnection = _openOutbox();
+
+    for( i = 0; i < PUBLISH_COUNT; i++ )
+    {
+        pOperations[ i ] = _putPublish( pMqttConnection, i );
+        TEST_ASSERT_NOT_NULL( pOperations[ i ] );
+        TEST_ASSERT_EQUAL_UINT32( i + 1, pOperations[ i ]->u.operation.outboxSequence );
+    }
+
+    _IotMqtt_OutboxAck( pOperations[ 0 ] );
+    _IotMqtt_OutboxAck( pOperations[ 3 ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, pOperations[ 0 ]->u.operation.outboxSequence );
+
+    for( i = 0; i < PUBLISH_COUNT; i++ )
+    {
+        _IotMqtt_DestroyOperation( pOperations[ i ] );
+    }
+
+    _closeOutbox( pMqttConnection );
+
+    /* Open the outbox again and check the PUBLISH messages to replay. */
+    pMqttConnection = _openOutbox();
+    pReplay = pMqttConnection->outbox.pReplay;
+
+    for( i = 1; i < PUBLISH_COUNT; i++ )
+    {
+        if( i != 3 )
+        {
+            _checkReplay( pReplay, i );
+            TEST_ASSERT_EQUAL_UINT32( i + 1, pReplay->u.operation.outboxSequence );
+            pReplay = pReplay->u.operation.pNextSend;
+        }
+    }
+
+    TEST_ASSERT_NULL( pReplay );
+
+    /* New PUBLISH messages continue the sequence numbers. */
+    TEST_ASSERT_EQUAL_UINT32( PUBLISH_COUNT + 1, pMqttConnection->outbox.nextSequence );
+
+    _closeOutbox( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that segments are removed once all of their PUBLISH messages
+ * are acknowledged.
+ */
+TEST( MQTT_Unit_Outbox, Compaction )
+{
+    uint8_t i = 0;
+    _mqttConnection_t * pMqttConnection = NULL;
+    _mqttOperation_t * pOperations[ PUBLISH_COUNT ] = { NULL };
+
+    pMqttConnection = _openOutbox();
+
+    for( i = 0; i < PUBLISH_COUNT; i++ )
+    {
+        pOperations[ i ] = _putPublish( pMqttConnection, i );
+        TEST_ASSERT_NOT_NULL( pOperations[ i ] );
+    }
+
+    /* The PUBLISH messages must span more than one segment for this test. */
+    TEST_ASSERT_NOT_EQUAL( pOperations[ 0 ]->u.operation.outboxSegment,
+                           pOperations[ PUBLISH_COUNT - 1 ]->u.operation.outboxSegment );
+
+    /* Acknowledge all PUBLISH messages in the first segment. */
+    for( i = 0; i < PUBLISH_COUNT; i++ )
+    {
+        if( pOperations[ i ]->u.operation.outboxSegment == 0 )
+        {
+            _IotMqtt_OutboxAck( pOperations[ i ] );
+        }
+    }
+
+    TEST_ASSERT_FALSE( _pSegments[ 0 ].exists );
+    TEST_ASSERT_TRUE( _pSegments[ 1 ].exists );
+    TEST_ASSERT_EQUAL_UINT32( 1, pMqttConnection->outbox.firstSegment );
+
+    for( i = 0; i < PUBLISH_COUNT; i++ )
+    {
+        _IotMqtt_DestroyOperation( pOperations[ i ] );
+    }
+
+    _closeOutbox( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that an outbox holds at most #IOT_MQTT_OUTBOX_SEGMENTS segments.
+ */
+TEST( MQTT_Unit_Outbox, Full )
+{
+    size_t i = 0, count = 0;
+    _mqttConnection_t * pMqttConnection = NULL;
+    _mqttOperation_t * pOperations[ STORAGE_SEGMENTS * 8 ] = { NULL };
+
+    pMqttConnection = _openOutbox();
+
+    /* Write PUBLISH messages until the outbox is full. */
+    for( count = 0; count < STORAGE_SEGMENTS * 8; count++ )
+    {
+        pOperations[ count ] = _putPublish( pMqttConnection, ( uint8_t ) count );
+
+        if( pOperations[ count ] == NULL )
+        {
+            break;
+        }
+    }
+
+    TEST_ASSERT_LESS_THAN( STORAGE_SEGMENTS * 8, count );
+    TEST_ASSERT_EQUAL_UINT32( IOT_MQTT_OUTBOX_SEGMENTS - 1,
+                              pMqttConnection->outbox.lastSegment - pMqttConnection->outbox.firstSegment );
+
+    /* Acknowledging the PUBLISH messages of the first segment makes room. */
+    for( i = 0; i < count; i++ )
+    {
+        if( pOperations[ i ]->u.operation.outboxSegment == 0 )
+        {
+            _IotMqtt_OutboxAck( pOperations[ i ] );
+        }
+    }
+
+    pOperations[ count ] = _putPublish( pMqttConnection, ( uint8_t ) count );
+    TEST_ASSERT_NOT_NULL( pOperations[ count ] );
+    count++;
+
+    for( i = 0; i < count; i++ )
+    {
+        _IotMqtt_DestroyOperation( pOperations[ i ] );
+    }
+
+    _closeOutbox( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that a damaged record and the records after it in its segment
+ * are ignored, and that new records are not appended after it.
+ */
+TEST( MQTT_Unit_Outbox, DamagedRecord )
+{
+    uint8_t i = 0;
+    uint32_t lastSegment = 0;
+    _mqttConnection_t * pMqttConnection = NULL;
+    _mqttOperation_t * pOperations[ 2 ] = { NULL };
+
+    pMqttConnection = _openOutbox();
+
+    for( i = 0; i < 2; i++ )
+    {
+        pOperations[ i ] = _putPublish( pMqttConnection, i );
+        TEST_ASSERT_NOT_NULL( pOperations[ i ] );
+        _IotMqtt_DestroyOperation( pOperations[ i ] );
+    }
+
+    /* Both PUBLISH messages must be in the same segment for this test. */
+    TEST_ASSERT_EQUAL_UINT32( 0, pMqttConnection->outbox.lastSegment );
+    _closeOutbox( pMqttConnection );
+
+    /* Damage the data of the second record and add a partial record. */
+    _pSegments[ 0 ].pData[ _pSegments[ 0 ].size - 5 ] ^= 0xff;
+    _pSegments[ 0 ].pData[ _pSegments[ 0 ].size ] = 0x01;
+    _pSegments[ 0 ].size++;
+
+    pMqttConnection = _openOutbox();
+    lastSegment = pMqttConnection->outbox.lastSegment;
+
+    /* Only the first PUBLISH is read. */
+    _checkReplay( pMqttConnection->outbox.pReplay, 0 );
+    TEST_ASSERT_NULL( pMqttConnection->outbox.pReplay->u.operation.pNextSend );
+
+    /* A new PUBLISH starts a new segment. */
+    pOperations[ 0 ] = _putPublish( pMqttConnection, 2 );
+    TEST_ASSERT_NOT_NULL( pOperations[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT32( lastSegment + 1, pOperations[ 0 ]->u.operation.outboxSegment );
+    _IotMqtt_DestroyOperation( pOperations[ 0 ] );
+
+    _closeOutbox( pMqttConnection );
+}
+
+/*-----------------------------------------------------------*/
@@ -38,6 +38,7 @@
 #include "iot_init.h"
 
 /* Platform layer includes. */
+#include "platform/iot_memory.h"
 #include "platform/iot_threads.h"
 
 /* MQTT internal include. */
@@ -293,6 +294,19 @@ static void _operationResetAndPush( _mqttOperation_t * pOperation )
     pOperation->u.operation.status = IOT_MQTT_STATUS_PENDING;
     pOperation->u.operation.jobReference = 1;
     IotListDouble_InsertHead( &( _pMqttConnection->pendingResponse ), &( pOperation->link ) );
+    pOperation->u.operation.batchSent = true;
+
+    /* Index the operation by its packet identifier, as the send job does. An
+     * operation whose response was not processed is still indexed. */
+    if( pOperation->u.operation.packetIdentifier != 0 )
+    {
+        if( IotLink_IsLinked( &( pOperation->u.operation.inflight.link ) ) == false )
+        {
+            ( void ) _IotMqtt_InflightInsert( _pMqttConnection,
+                                              pOperation->u.operation.packetIdentifier,
+                                              pOperation );
+        }
+    }
 }
 
 /*-----------------------------------------------------------*/
@@ -327,6 +341,25 @@ static bool _processBuffer( const _mqttOperation_t * pOperation,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Count the allocations made through @ref platform_memory_function_malloc.
+ */
+static uint32_t _memoryAllocations( void )
+{
+    IotMemoryCacheStats_t stats[ 16 ];
+    size_t classCount = IotMemory_GetCacheStats( stats, 16 ), i = 0;
+    uint32_t allocations = 0;
+
+    for( i = 0; ( i < classCount ) && ( i < 16 ); i++ )
+    {
+        allocations += stats[ i ].hits + stats[ i ].misses;
+    }
+
+    return allocations;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Process a PUBLISH message and check the result.
  */
@@ -614,6 +647,8 @@ TEST_GROUP_RUNNER( MQTT_Unit_Receive )
     RUN_TEST_CASE( MQTT_Unit_Receive, UnsubackValid );
     RUN_TEST_CASE( MQTT_Unit_Receive, UnsubackInvalid );
     RUN_TEST_CASE( MQTT_Unit_Receive, Pingresp );
+    RUN_TEST_CASE( MQTT_Unit_Receive, AckAllocations );
+    RUN_TEST_CASE( MQTT_Unit_Receive, PublishReceivePool );
 }
 
 /*-----------------------------------------------------------*/
@@ -1733,3 +1768,135 @@ TEST( MQTT_Unit_Receive, Pingresp )
 }
 
 /*-----------------------------------------------------------*/
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that @ref mqtt_function_receivecallback does not allocate memory
+ * for small packets other than PUBLISH.
+ */
+TEST( MQTT_Unit_Receive, AckAllocations )
+{
+    uint32_t allocations = 0;
+    _mqttOperation_t publish = INITIALIZE_OPERATION( IOT_MQTT_PUBLISH_TO_SERVER );
+
+    /* A SUBACK too large for the stack buffer of the receive callback. */
+    uint8_t pLargeSuback[ 68 ] = { 0 };
+
+    pLargeSuback[ 0 ] = MQTT_PACKET_TYPE_SUBACK;
+    pLargeSuback[ 1 ] = ( uint8_t ) ( sizeof( pLargeSuback ) - 2 );
+    pLargeSuback[ 3 ] = 1;
+
+    TEST_ASSERT_EQUAL_INT( true, IotSemaphore_Create( &( publish.u.operation.notify.waitSemaphore ),
+                                                      0,
+                                                      10 ) );
+
+    allocations = _memoryAllocations();
+
+    /* Process a valid PUBACK, SUBACK, UNSUBACK and PINGRESP. */
+    {
+        DECLARE_PACKET( _pPubackTemplate, pPuback, pubackSize );
+        _operationResetAndPush( &publish );
+        TEST_ASSERT_EQUAL_INT( true, _processBuffer( &publish,
+                                                     pPuback,
+                                                     pubackSize,
+                                                     IOT_MQTT_SUCCESS ) );
+    }
+
+    {
+        DECLARE_PACKET( _pSubackTemplate, pSuback, subackSize );
+        TEST_ASSERT_EQUAL_INT( true, _processBuffer( NULL,
+                                                     pSuback,
+                                                     subackSize,
+                                                     IOT_MQTT_SUCCESS ) );
+    }
+
+    {
+        DECLARE_PACKET( _pUnsubackTemplate, pUnsuback, unsubackSize );
+        TEST_ASSERT_EQUAL_INT( true, _processBuffer( NULL,
+                                                     pUnsuback,
+                                                     unsubackSize,
+                                                     IOT_MQTT_SUCCESS ) );
+    }
+
+    {
+        DECLARE_PACKET( _pPingrespTemplate, pPingresp, pingrespSize );
+        TEST_ASSERT_EQUAL_INT( true, _processBuffer( NULL,
+                                                     pPingresp,
+                                                     pingrespSize,
+                                                     IOT_MQTT_SUCCESS ) );
+    }
+
+    /* None of these packets should have been read into an allocated buffer. */
+    TEST_ASSERT_EQUAL_UINT32( allocations, _memoryAllocations() );
+
+    /* A large SUBACK is still received and processed. */
+    TEST_ASSERT_EQUAL_INT( true, _processBuffer( NULL,
+                                                 pLargeSuback,
+                                                 sizeof( pLargeSuback ),
+                                                 IOT_MQTT_SUCCESS ) );
+
+    IotSemaphore_Destroy( &( publish.u.operation.notify.waitSemaphore ) );
+
+    /* Network close function should not have been invoked. */
+    TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+    TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+}
+
+/*-----------------------------------------------------------*/
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that @ref mqtt_function_receivecallback reads small PUBLISH
+ * messages into the receive pool and returns the buffers to it.
+ */
+TEST( MQTT_Unit_Receive, PublishReceivePool )
+{
+    #if ( IOT_STATIC_MEMORY_ONLY == 1 ) || ( IOT_MQTT_RECEIVE_POOL_SIZE == 0 )
+        TEST_IGNORE_MESSAGE( "The receive pool is disabled." );
+    #else
+        IotMqttMemoryStats_t stats = { 0 };
+        size_t highWater = 0;
+
+        /* A QoS 0 PUBLISH with the test topic and a 16-byte payload. */
+        uint8_t pSmallPublish[ 31 ] = { 0 };
+
+        ( void ) memcpy( pSmallPublish + 2, _pPublishTemplate + 3, sizeof( pSmallPublish ) - 2 );
+        pSmallPublish[ 0 ] = MQTT_PACKET_TYPE_PUBLISH;
+        pSmallPublish[ 1 ] = ( uint8_t ) ( sizeof( pSmallPublish ) - 2 );
+
+        IotMqtt_GetMemoryStats( &stats );
+        TEST_ASSERT_EQUAL( 0, stats.receivePool.inUse );
+        highWater = stats.receivePool.highWater;
+
+        /* A small PUBLISH is read into the pool. Its buffer is returned once
+         * the callback has run. */
+        TEST_ASSERT_EQUAL_INT( true, _processPublish( pSmallPublish,
+                                                      sizeof( pSmallPublish ),
+                                                      1 ) );
+
+        IotMqtt_GetMemoryStats( &stats );
+        TEST_ASSERT_EQUAL( 0, stats.receivePool.inUse );
+        TEST_ASSERT_TRUE( stats.receivePool.highWater >= 1 );
+        TEST_ASSERT_TRUE( stats.receivePool.highWater >= highWater );
+
+        /* A PUBLISH larger than the pool buffers is still received. */
+        if( sizeof( _pPublishTemplate ) - 3 > IOT_MQTT_RECEIVE_POOL_BUFFER_SIZE )
+        {
+            DECLARE_PACKET( _pPublishTemplate, pPublish, publishSize );
+            TEST_ASSERT_EQUAL_INT( true, _processPublish( pPublish,
+                                                          publishSize,
+                                                          1 ) );
+
+            IotMqtt_GetMemoryStats( &stats );
+            TEST_ASSERT_EQUAL( 0, stats.receivePool.inUse );
+        }
+
+        /* Network close function should not have been invoked. */
+        TEST_ASSERT_EQUAL_INT( false, _networkCloseCalled );
+        TEST_ASSERT_EQUAL_INT( false, _disconnectCallbackCalled );
+    #endif /* if ( IOT_STATIC_MEMORY_ONLY == 1 ) || ( IOT_MQTT_RECEIVE_POOL_SIZE == 0 ) */
+}
+
+/*-----------------------------------------------------------*/
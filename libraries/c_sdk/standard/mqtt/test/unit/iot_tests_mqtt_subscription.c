@@ -122,6 +122,32 @@
                                IotTestMqtt_topicMatch( &( pTopicFilter->link ), &_topicMatchParams ) ); \
     }
 
+/**
+ * @brief Subscribe to a topic filter, dispatch a PUBLISH through the subscription
+ * index, and check how many times the subscription callback was invoked.
+ */
+#define TEST_INDEX_MATCH( topicNameString, topicFilterString, expectedCount )                         \
+    {                                                                                                 \
+        uint32_t _invokeCount = 0;                                                                    \
+        IotMqttSubscription_t _subscription = IOT_MQTT_SUBSCRIPTION_INITIALIZER;                      \
+        IotMqttCallbackParam_t _callbackParam = { .u.message = { 0 } };                               \
+                                                                                                      \
+        _subscription.pTopicFilter = topicFilterString;                                               \
+        _subscription.topicFilterLength = ( uint16_t ) strlen( topicFilterString );                   \
+        _subscription.callback.function = _countingCallback;                                          \
+        _subscription.callback.pCallbackContext = &_invokeCount;                                      \
+        _callbackParam.u.message.info.pTopicName = topicNameString;                                   \
+        _callbackParam.u.message.info.topicNameLength = ( uint16_t ) strlen( topicNameString );       \
+                                                                                                      \
+        TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,                                                          \
+                           _IotMqtt_AddSubscriptions( _pMqttConnection, 1, &_subscription, 1 ) );    \
+        _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection, &_callbackParam );                     \
+        _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection, &_subscription, 1 );              \
+                                                                                                      \
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE( expectedCount, _invokeCount, topicFilterString );           \
+        TEST_ASSERT_EQUAL_INT( true, _indexEmpty() );                                                 \
+    }
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -142,25 +168,26 @@ static _mqttConnection_t * _pMqttConnection = IOT_MQTT_CONNECTION_INITIALIZER;
 static void _populateList( void )
 {
     size_t i = 0;
-    _mqttSubscription_t * pSubscription = NULL;
+    char pTopicFilters[ LIST_ITEM_COUNT ][ TEST_TOPIC_FILTER_LENGTH ] = { { 0 } };
+    IotMqttSubscription_t subscription[ LIST_ITEM_COUNT ] = { IOT_MQTT_SUBSCRIPTION_INITIALIZER };
 
     for( i = 0; i < LIST_ITEM_COUNT; i++ )
     {
-        pSubscription = IotMqtt_MallocSubscription( sizeof( _mqttSubscription_t ) + TEST_TOPIC_FILTER_LENGTH );
-        TEST_ASSERT_NOT_NULL( pSubscription );
-
-        ( void ) memset( pSubscription, 0x00, sizeof( _mqttSubscription_t ) + TEST_TOPIC_FILTER_LENGTH );
-        pSubscription->packetInfo.identifier = 1;
-        pSubscription->packetInfo.order = i;
-        pSubscription->callback.function = SUBSCRIPTION_CALLBACK_FUNCTION;
-        pSubscription->topicFilterLength = ( uint16_t ) snprintf( pSubscription->pTopicFilter,
-                                                                  TEST_TOPIC_FILTER_LENGTH,
-                                                                  TEST_TOPIC_FILTER_FORMAT,
-                                                                  ( unsigned long ) i );
-
-        IotListDouble_InsertHead( &( _pMqttConnection->subscriptionList ),
-                                  &( pSubscription->link ) );
+        subscription[ i ].callback.function = SUBSCRIPTION_CALLBACK_FUNCTION;
+        subscription[ i ].pTopicFilter = pTopicFilters[ i ];
+        subscription[ i ].topicFilterLength = ( uint16_t ) snprintf( pTopicFilters[ i ],
+                                                                     TEST_TOPIC_FILTER_LENGTH,
+                                                                     TEST_TOPIC_FILTER_FORMAT,
+                                                                     ( unsigned long ) i );
     }
+
+    /* Add the subscriptions through the library so that they are also placed
+     * in the subscription index. */
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                       _IotMqtt_AddSubscriptions( _pMqttConnection,
+                                                  1,
+                                                  subscription,
+                                                  LIST_ITEM_COUNT ) );
 }
 
 /*-----------------------------------------------------------*/
@@ -261,6 +288,79 @@ static void _blockingCallback( void * pArgument,
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief A subscription callback function that retains the incoming PUBLISH.
+ */
+static void _retainCallback( void * pArgument,
+                             IotMqttCallbackParam_t * pPublish )
+{
+    IotMqttCallbackParam_t * pRetained = ( IotMqttCallbackParam_t * ) pArgument;
+
+    /* Keep the received PUBLISH after this callback returns. */
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                       IotMqtt_RetainPublish( pPublish->u.message.reference ) );
+
+    *pRetained = *pPublish;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A subscription callback function that counts its invocations.
+ */
+static void _countingCallback( void * pArgument,
+                               IotMqttCallbackParam_t * pPublish )
+{
+    uint32_t * pInvokeCount = ( uint32_t * ) pArgument;
+
+    /* Silence warnings about unused parameters. */
+    ( void ) pPublish;
+
+    ( *pInvokeCount )++;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A subscription callback function that removes the subscription passed
+ * as its context.
+ */
+static void _unsubscribeCallback( void * pArgument,
+                                  IotMqttCallbackParam_t * pPublish )
+{
+    _IotMqtt_RemoveSubscriptionByTopicFilter( pPublish->mqttConnection,
+                                              ( const IotMqttSubscription_t * ) pArgument,
+                                              1 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check that the subscription index holds no topic levels.
+ */
+static bool _indexEmpty( void )
+{
+    bool status = true;
+    size_t i = 0;
+
+    IotMutex_Lock( &( _pMqttConnection->subscriptionMutex ) );
+
+    for( i = 0; i < IOT_MQTT_SUBSCRIPTION_HASH_BUCKETS; i++ )
+    {
+        if( IotListDouble_IsEmpty( &( _pMqttConnection->subscriptionIndex[ i ] ) ) == false )
+        {
+            status = false;
+            break;
+        }
+    }
+
+    IotMutex_Unlock( &( _pMqttConnection->subscriptionMutex ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Test group for MQTT subscription tests.
  */
@@ -328,7 +428,12 @@ TEST_GROUP_RUNNER( MQTT_Unit_Subscription )
     RUN_TEST_CASE( MQTT_Unit_Subscription, SubscriptionAddMallocFail );
     RUN_TEST_CASE( MQTT_Unit_Subscription, ProcessPublish );
     RUN_TEST_CASE( MQTT_Unit_Subscription, ProcessPublishMultiple );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, ProcessPublishIndexed );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, ProcessPublishTopicLevels );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, ProcessPublishUnsubscribe );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, IndexTopicMatch );
     RUN_TEST_CASE( MQTT_Unit_Subscription, SubscriptionReferences );
+    RUN_TEST_CASE( MQTT_Unit_Subscription, ProcessPublishRetain );
     RUN_TEST_CASE( MQTT_Unit_Subscription, TopicFilterMatchTrue );
     RUN_TEST_CASE( MQTT_Unit_Subscription, TopicFilterMatchFalse );
 }
@@ -620,8 +725,9 @@ TEST( MQTT_Unit_Subscription, SubscriptionAddDuplicate )
     TEST_ASSERT_EQUAL_PTR( _pMqttConnection, pSubscription->callback.pCallbackContext );
 
     /* Check that a duplicate entry wasn't created. */
-    IotListDouble_Remove( &( pSubscription->link ) );
-    IotMqtt_FreeSubscription( pSubscription );
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection,
+                                              &( subscription[ 1 ] ),
+                                              1 );
     pSubscriptionLink = IotListDouble_FindFirstMatch( &( _pMqttConnection->subscriptionList ),
                                                       NULL,
                                                       IotTestMqtt_topicMatch,
@@ -707,6 +813,7 @@ TEST( MQTT_Unit_Subscription, ProcessPublish )
     /* Find the subscription and invoke its callback. */
     _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection,
                                          &callbackParam );
+    _IotMqtt_DecrementConnectionReferences( _pMqttConnection );
 
     /* Check that the callback was invoked. */
     TEST_ASSERT_EQUAL_INT( true, callbackInvoked );
@@ -759,6 +866,7 @@ TEST( MQTT_Unit_Subscription, ProcessPublishMultiple )
     /* Invoke subscription callbacks. */
     _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection,
                                          &callbackParam );
+    _IotMqtt_DecrementConnectionReferences( _pMqttConnection );
 
     /* Check that all 3 callbacks were invoked. */
     TEST_ASSERT_EQUAL_INT( true, callbackInvoked[ 0 ] );
@@ -768,6 +876,259 @@ TEST( MQTT_Unit_Subscription, ProcessPublishMultiple )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests that only matching subscription callbacks are invoked when
+ * many subscriptions are spread across the subscription index.
+ */
+TEST( MQTT_Unit_Subscription, ProcessPublishIndexed )
+{
+    size_t i = 0;
+    bool callbackInvoked[ 5 ] = { false };
+    IotMqttSubscription_t subscription[ 5 ] = { IOT_MQTT_SUBSCRIPTION_INITIALIZER };
+    IotMqttCallbackParam_t callbackParam = { .u.message = { 0 } };
+
+    /* Fill the index with exact topic filters that never match the PUBLISH.
+     * Their callbacks would crash if invoked. */
+    _populateList();
+
+    /* Exact filter, wildcard filter under the PUBLISH's first level, and
+     * wildcard filter with a wildcard first level; all of these match. */
+    subscription[ 0 ].pTopicFilter = "sensor/1/temp";
+    subscription[ 0 ].topicFilterLength = 13;
+    subscription[ 1 ].pTopicFilter = "sensor/+/temp";
+    subscription[ 1 ].topicFilterLength = 13;
+    subscription[ 2 ].pTopicFilter = "+/1/#";
+    subscription[ 2 ].topicFilterLength = 5;
+
+    /* Wildcard filter under another first level and a similar exact filter;
+     * neither of these match. */
+    subscription[ 3 ].pTopicFilter = "actuator/#";
+    subscription[ 3 ].topicFilterLength = 10;
+    subscription[ 4 ].pTopicFilter = "sensor/1/humidity";
+    subscription[ 4 ].topicFilterLength = 17;
+
+    for( i = 0; i < 5; i++ )
+    {
+        subscription[ i ].callback.function = _publishCallback;
+        subscription[ i ].callback.pCallbackContext = &( callbackInvoked[ i ] );
+    }
+
+    callbackParam.u.message.info.pTopicName = "sensor/1/temp";
+    callbackParam.u.message.info.topicNameLength = 13;
+    callbackParam.u.message.info.pPayload = "";
+    callbackParam.u.message.info.payloadLength = 0;
+
+    /* Add the subscriptions. */
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                       _IotMqtt_AddSubscriptions( _pMqttConnection,
+                                                  2,
+                                                  subscription,
+                                                  5 ) );
+
+    /* Increment connection reference count for processing subscription callbacks. */
+    TEST_ASSERT_EQUAL_INT( true, _IotMqtt_IncrementConnectionReferences( _pMqttConnection ) );
+
+    /* Invoke subscription callbacks. */
+    _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection,
+                                         &callbackParam );
+    _IotMqtt_DecrementConnectionReferences( _pMqttConnection );
+
+    /* Check that only the matching callbacks were invoked. */
+    TEST_ASSERT_EQUAL_INT( true, callbackInvoked[ 0 ] );
+    TEST_ASSERT_EQUAL_INT( true, callbackInvoked[ 1 ] );
+    TEST_ASSERT_EQUAL_INT( true, callbackInvoked[ 2 ] );
+    TEST_ASSERT_EQUAL_INT( false, callbackInvoked[ 3 ] );
+    TEST_ASSERT_EQUAL_INT( false, callbackInvoked[ 4 ] );
+
+    /* Removing a wildcard subscription removes it from the index as well. */
+    TEST_ASSERT_EQUAL_INT( true, IotMqtt_IsSubscribed( _pMqttConnection,
+                                                       "+/1/#",
+                                                       5,
+                                                       NULL ) );
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection,
+                                              &( subscription[ 2 ] ),
+                                              1 );
+    TEST_ASSERT_EQUAL_INT( false, IotMqtt_IsSubscribed( _pMqttConnection,
+                                                        "+/1/#",
+                                                        5,
+                                                        NULL ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that a PUBLISH invokes every matching subscription exactly once
+ * when topic filters share topic levels.
+ */
+TEST( MQTT_Unit_Subscription, ProcessPublishTopicLevels )
+{
+    size_t i = 0;
+    uint32_t invokeCount[ 8 ] = { 0 };
+    IotMqttSubscription_t subscription[ 8 ] = { IOT_MQTT_SUBSCRIPTION_INITIALIZER };
+    IotMqttCallbackParam_t callbackParam = { .u.message = { 0 } };
+    const char * const pTopicFilters[ 8 ] =
+    {
+        "aws/iot", "aws/+", "+/iot", "aws/#", "#", "aws/iot/#", "+/+/+", "aws/iot/shadow"
+    };
+
+    for( i = 0; i < 8; i++ )
+    {
+        subscription[ i ].pTopicFilter = pTopicFilters[ i ];
+        subscription[ i ].topicFilterLength = ( uint16_t ) strlen( pTopicFilters[ i ] );
+        subscription[ i ].callback.function = _countingCallback;
+        subscription[ i ].callback.pCallbackContext = &( invokeCount[ i ] );
+    }
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                       _IotMqtt_AddSubscriptions( _pMqttConnection,
+                                                  1,
+                                                  subscription,
+                                                  8 ) );
+
+    /* "aws/iot" matches every filter except the three-level ones. */
+    callbackParam.u.message.info.pTopicName = "aws/iot";
+    callbackParam.u.message.info.topicNameLength = 7;
+    _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection, &callbackParam );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 2 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 3 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 4 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 5 ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, invokeCount[ 6 ] );
+    TEST_ASSERT_EQUAL_UINT32( 0, invokeCount[ 7 ] );
+
+    /* "aws/iot/shadow" matches the multi-level and three-level filters. */
+    callbackParam.u.message.info.pTopicName = "aws/iot/shadow";
+    callbackParam.u.message.info.topicNameLength = 14;
+    _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection, &callbackParam );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 2 ] );
+    TEST_ASSERT_EQUAL_UINT32( 2, invokeCount[ 3 ] );
+    TEST_ASSERT_EQUAL_UINT32( 2, invokeCount[ 4 ] );
+    TEST_ASSERT_EQUAL_UINT32( 2, invokeCount[ 5 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 6 ] );
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 7 ] );
+
+    /* Removing a filter keeps the topic levels shared with other filters. */
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection,
+                                              &( subscription[ 0 ] ),
+                                              1 );
+    TEST_ASSERT_EQUAL_INT( false, IotMqtt_IsSubscribed( _pMqttConnection, "aws/iot", 7, NULL ) );
+    TEST_ASSERT_EQUAL_INT( true, IotMqtt_IsSubscribed( _pMqttConnection, "aws/iot/#", 9, NULL ) );
+    TEST_ASSERT_EQUAL_INT( true, IotMqtt_IsSubscribed( _pMqttConnection, "aws/iot/shadow", 14, NULL ) );
+
+    /* Topic levels without subscriptions are not subscriptions. */
+    TEST_ASSERT_EQUAL_INT( false, IotMqtt_IsSubscribed( _pMqttConnection, "aws", 3, NULL ) );
+    TEST_ASSERT_EQUAL_INT( false, IotMqtt_IsSubscribed( _pMqttConnection, "+/+", 3, NULL ) );
+
+    callbackParam.u.message.info.pTopicName = "aws/iot";
+    callbackParam.u.message.info.topicNameLength = 7;
+    _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection, &callbackParam );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, invokeCount[ 0 ] );
+    TEST_ASSERT_EQUAL_UINT32( 2, invokeCount[ 1 ] );
+    TEST_ASSERT_EQUAL_UINT32( 2, invokeCount[ 2 ] );
+
+    /* Removing every filter frees every topic level. */
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection,
+                                              subscription,
+                                              8 );
+    TEST_ASSERT_EQUAL_INT( true, _indexEmpty() );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that a subscription removed by a subscription callback is not
+ * invoked for the same PUBLISH.
+ */
+TEST( MQTT_Unit_Subscription, ProcessPublishUnsubscribe )
+{
+    uint32_t invokeCount = 0;
+    IotMqttSubscription_t subscription[ 2 ] = { IOT_MQTT_SUBSCRIPTION_INITIALIZER };
+    IotMqttCallbackParam_t callbackParam = { .u.message = { 0 } };
+
+    /* The "#" subscription is invoked before "+/iot/shadow" and removes it. */
+    subscription[ 0 ].pTopicFilter = "#";
+    subscription[ 0 ].topicFilterLength = 1;
+    subscription[ 0 ].callback.function = _unsubscribeCallback;
+    subscription[ 0 ].callback.pCallbackContext = &( subscription[ 1 ] );
+    subscription[ 1 ].pTopicFilter = "+/iot/shadow";
+    subscription[ 1 ].topicFilterLength = 12;
+    subscription[ 1 ].callback.function = _countingCallback;
+    subscription[ 1 ].callback.pCallbackContext = &invokeCount;
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS,
+                       _IotMqtt_AddSubscriptions( _pMqttConnection,
+                                                  1,
+                                                  subscription,
+                                                  2 ) );
+
+    callbackParam.u.message.info.pTopicName = "aws/iot/shadow";
+    callbackParam.u.message.info.topicNameLength = 14;
+    _IotMqtt_InvokeSubscriptionCallback( _pMqttConnection, &callbackParam );
+
+    TEST_ASSERT_EQUAL_UINT32( 0, invokeCount );
+    TEST_ASSERT_EQUAL_INT( false, IotMqtt_IsSubscribed( _pMqttConnection, "+/iot/shadow", 12, NULL ) );
+
+    /* The topic levels of the removed filter were freed once unused. */
+    _IotMqtt_RemoveSubscriptionByTopicFilter( _pMqttConnection,
+                                              subscription,
+                                              1 );
+    TEST_ASSERT_EQUAL_INT( true, _indexEmpty() );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tests that the subscription index matches topic names the same way as
+ * the topic filter matching function.
+ */
+TEST( MQTT_Unit_Subscription, IndexTopicMatch )
+{
+    /* Exact matching. */
+    TEST_INDEX_MATCH( "/exact", "/exact", 1 );
+    TEST_INDEX_MATCH( "/short", "/toolong", 0 );
+    TEST_INDEX_MATCH( "/exact", "/eXaCt", 0 );
+    TEST_INDEX_MATCH( "aws/", "aws/iot", 0 );
+    TEST_INDEX_MATCH( "aws/iot", "aws", 0 );
+
+    /* Topic level wildcard matching. */
+    TEST_INDEX_MATCH( "/aws", "/+", 1 );
+    TEST_INDEX_MATCH( "/aws/iot", "/aws/+", 1 );
+    TEST_INDEX_MATCH( "/aws/iot/shadow", "/aws/+/shadow", 1 );
+    TEST_INDEX_MATCH( "/aws/iot/shadow", "/aws/+/+", 1 );
+    TEST_INDEX_MATCH( "aws/", "aws/+", 1 );
+    TEST_INDEX_MATCH( "/aws", "+/+", 1 );
+    TEST_INDEX_MATCH( "aws//iot", "aws/+/iot", 1 );
+    TEST_INDEX_MATCH( "aws//iot", "aws//+", 1 );
+    TEST_INDEX_MATCH( "aws///iot", "aws/+/+/iot", 1 );
+    TEST_INDEX_MATCH( "aws", "aws/", 0 );
+    TEST_INDEX_MATCH( "aws/iot/shadow", "aws/+", 0 );
+    TEST_INDEX_MATCH( "aws/iot/shadow", "aws/+/thing", 0 );
+    TEST_INDEX_MATCH( "/aws", "+", 0 );
+
+    /* Multi level wildcard matching. */
+    TEST_INDEX_MATCH( "/aws/iot/shadow", "#", 1 );
+    TEST_INDEX_MATCH( "aws/iot/shadow", "#", 1 );
+    TEST_INDEX_MATCH( "/aws/iot/shadow", "/#", 1 );
+    TEST_INDEX_MATCH( "aws/iot/shadow", "aws/iot/#", 1 );
+    TEST_INDEX_MATCH( "aws/iot/shadow/thing", "aws/iot/#", 1 );
+    TEST_INDEX_MATCH( "aws", "aws/#", 1 );
+    TEST_INDEX_MATCH( "aws/iot/shadow", "iot/#", 0 );
+    TEST_INDEX_MATCH( "aws/iot", "/#", 0 );
+
+    /* Both topic level and multi level wildcard. */
+    TEST_INDEX_MATCH( "aws/iot/shadow/thing/temp", "aws/+/shadow/#", 1 );
+    TEST_INDEX_MATCH( "aws/iot", "aws/+/#", 1 );
+    TEST_INDEX_MATCH( "aws/iot/shadow", "iot/+/#", 0 );
+}
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests that subscriptions are properly reference counted.
  */
@@ -884,6 +1245,77 @@ TEST( MQTT_Unit_Subscription, SubscriptionReferences )
 
 /*-----------------------------------------------------------*/
 
+/**
+ * @brief Tests that an incoming PUBLISH retained by a subscription callback
+ * remains valid until it is released.
+ */
+TEST( MQTT_Unit_Subscription, ProcessPublishRetain )
+{
+    int32_t references = 0;
+    uint8_t * pReceivedData = NULL;
+    _mqttOperation_t * pIncomingPublish = NULL;
+    IotMqttSubscription_t subscription = IOT_MQTT_SUBSCRIPTION_INITIALIZER;
+    IotMqttCallbackParam_t retained = { .u.message = { 0 } };
+
+    /* A NULL reference cannot be retained. */
+    TEST_ASSERT_EQUAL( IOT_MQTT_BAD_PARAMETER, IotMqtt_RetainPublish( NULL ) );
+
+    subscription.pTopicFilter = "/test";
+    subscription.topicFilterLength = 5;
+    subscription.callback.function = _retainCallback;
+    subscription.callback.pCallbackContext = &retained;
+
+    TEST_ASSERT_EQUAL( IOT_MQTT_SUCCESS, _IotMqtt_AddSubscriptions( _pMqttConnection,
+                                                                    1,
+                                                                    &subscription,
+                                                                    1 ) );
+
+    /* Create an incoming PUBLISH whose topic name and payload are in its
+     * received data. */
+    pReceivedData = IotMqtt_MallocMessage( 12 );
+    TEST_ASSERT_NOT_NULL( pReceivedData );
+    ( void ) memcpy( pReceivedData, "/testpayload", 12 );
+
+    pIncomingPublish = IotMqtt_MallocOperation( sizeof( _mqttOperation_t ) );
+
+    if( pIncomingPublish == NULL )
+    {
+        IotMqtt_FreeMessage( pReceivedData );
+        TEST_FAIL();
+    }
+
+    ( void ) memset( pIncomingPublish, 0x00, sizeof( _mqttOperation_t ) );
+    pIncomingPublish->incomingPublish = true;
+    pIncomingPublish->pMqttConnection = _pMqttConnection;
+    pIncomingPublish->u.publish.pReceivedData = pReceivedData;
+    pIncomingPublish->u.publish.publishInfo.pTopicName = ( const char * ) pReceivedData;
+    pIncomingPublish->u.publish.publishInfo.topicNameLength = 5;
+    pIncomingPublish->u.publish.publishInfo.pPayload = pReceivedData + 5;
+    pIncomingPublish->u.publish.publishInfo.payloadLength = 7;
+
+    /* Process the incoming PUBLISH with a reference to the connection, as the
+     * receive callback would. */
+    references = _pMqttConnection->references;
+    TEST_ASSERT_EQUAL_INT( true, _IotMqtt_IncrementConnectionReferences( _pMqttConnection ) );
+    _IotMqtt_ProcessIncomingPublish( IOT_SYSTEM_TASKPOOL,
+                                     pIncomingPublish->job,
+                                     pIncomingPublish );
+
+    /* The retained PUBLISH keeps a reference to the connection, and its buffer
+     * is still valid. */
+    TEST_ASSERT_EQUAL_PTR( pIncomingPublish, retained.u.message.reference );
+    TEST_ASSERT_EQUAL_INT32( references + 1, _pMqttConnection->references );
+    TEST_ASSERT_EQUAL_INT32( 1, pIncomingPublish->u.publish.loans );
+    TEST_ASSERT_EQUAL_PTR( pReceivedData, retained.u.message.info.pTopicName );
+    TEST_ASSERT_EQUAL_MEMORY( "payload", retained.u.message.info.pPayload, 7 );
+
+    /* Releasing the PUBLISH frees it and its connection reference. */
+    IotMqtt_ReleasePublish( retained.u.message.reference );
+    TEST_ASSERT_EQUAL_INT32( references, _pMqttConnection->references );
+}
+
+/*-----------------------------------------------------------*/
+
 /**
  * @brief Tests result of matching topic filters and topic names.
  */
@@ -0,0 +1,65 @@
+/*
+ * Amazon FreeRTOS Serializer V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_serializer_taskpool.h
+ * @brief Declares the function to encode the statistics of a task pool.
+ */
+
+#ifndef IOT_SERIALIZER_TASKPOOL_H_
+#define IOT_SERIALIZER_TASKPOOL_H_
+
+/* Standard includes. */
+#include <stddef.h>
+#include <stdint.h>
+
+/* Serializer include. */
+#include "iot_serializer.h"
+
+/* Task pool types include. */
+#include "types/iot_taskpool_types.h"
+
+/**
+ * @brief Encode the statistics of a task pool, as returned by @ref taskpool_function_getstats.
+ *
+ * The statistics are encoded as a map with one key per counter or gauge of #IotTaskPoolStats_t,
+ * e.g. `queued_jobs` or `cache_hits`, and one nested map per histogram, with the keys `count`,
+ * `max`, `sum` and `buckets`.
+ *
+ * @param[in] pEncoder The encoder to use, e.g. `&_IotSerializerCborEncoder` or `&_IotSerializerJsonEncoder`.
+ * @param[in] pStats The statistics to encode.
+ * @param[in] pBuffer The buffer to encode to, or `NULL` to compute the size needed.
+ * @param[in,out] pSize The size of `pBuffer` on input. On output, the size of the encoded statistics,
+ * or the size needed if `pBuffer` is `NULL` or too small.
+ *
+ * @return #IOT_SERIALIZER_SUCCESS, #IOT_SERIALIZER_BUFFER_TOO_SMALL if `pBuffer` is too small, or
+ * any other error returned by the encoder.
+ */
+IotSerializerError_t IotSerializer_EncodeTaskPoolStats( const IotSerializerEncodeInterface_t * pEncoder,
+                                                        const IotTaskPoolStats_t * pStats,
+                                                        uint8_t * pBuffer,
+                                                        size_t * pSize );
+
+#endif /* ifndef IOT_SERIALIZER_TASKPOOL_H_ */
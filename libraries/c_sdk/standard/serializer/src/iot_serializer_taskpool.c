@@ -0,0 +1,244 @@
+/*
+ * Amazon FreeRTOS Serializer V1.0.0
+ * Copyright (C) 2018 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_serializer_taskpool.c
+ * @brief Implements the functions in iot_serializer_taskpool.h
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Task pool statistics encoder include. */
+#include "iot_serializer_taskpool.h"
+
+/**
+ * @brief Number of keys in the map of the statistics.
+ */
+#define TASKPOOL_STATS_MAP_SIZE        ( 12 )
+
+/**
+ * @brief Number of keys in the map of a histogram.
+ */
+#define TASKPOOL_HISTOGRAM_MAP_SIZE    ( 4 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Merge the error of an encoder call into the status of the encoding.
+ *
+ * A full buffer does not stop the encoding, so that the size needed is computed.
+ *
+ * @param[in] status The status of the encoding so far.
+ * @param[in] error The error of the last encoder call.
+ *
+ * @return The status of the encoding.
+ */
+static IotSerializerError_t _mergeError( IotSerializerError_t status,
+                                         IotSerializerError_t error );
+
+/**
+ * @brief Encode a histogram as a map with the given key.
+ *
+ * @param[in] pEncoder The encoder.
+ * @param[in] pMap The map to add the histogram to.
+ * @param[in] pKey The key of the histogram.
+ * @param[in] pHistogram The histogram.
+ *
+ * @return The status of the encoding.
+ */
+static IotSerializerError_t _encodeHistogram( const IotSerializerEncodeInterface_t * pEncoder,
+                                              IotSerializerEncoderObject_t * pMap,
+                                              const char * pKey,
+                                              const IotTaskPoolHistogram_t * pHistogram );
+
+/**
+ * @brief Encode the statistics as the outermost map.
+ *
+ * @param[in] pEncoder The encoder.
+ * @param[in] pEncoderObject The initialized outermost encoder object.
+ * @param[in] pStats The statistics.
+ *
+ * @return The status of the encoding.
+ */
+static IotSerializerError_t _encodeStats( const IotSerializerEncodeInterface_t * pEncoder,
+                                          IotSerializerEncoderObject_t * pEncoderObject,
+                                          const IotTaskPoolStats_t * pStats );
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _mergeError( IotSerializerError_t status,
+                                         IotSerializerError_t error )
+{
+    if( ( status == IOT_SERIALIZER_SUCCESS ) ||
+        ( ( status == IOT_SERIALIZER_BUFFER_TOO_SMALL ) && ( error != IOT_SERIALIZER_SUCCESS ) ) )
+    {
+        status = error;
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _encodeHistogram( const IotSerializerEncodeInterface_t * pEncoder,
+                                              IotSerializerEncoderObject_t * pMap,
+                                              const char * pKey,
+                                              const IotTaskPoolHistogram_t * pHistogram )
+{
+    IotSerializerError_t status = IOT_SERIALIZER_SUCCESS;
+    IotSerializerEncoderObject_t histogramMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    IotSerializerEncoderObject_t bucketsArray = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_ARRAY;
+    size_t i = 0;
+
+    status = _mergeError( status, pEncoder->openContainerWithKey( pMap, pKey, &histogramMap, TASKPOOL_HISTOGRAM_MAP_SIZE ) );
+
+    if( ( status != IOT_SERIALIZER_SUCCESS ) && ( status != IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+    {
+        return status;
+    }
+
+    status = _mergeError( status, pEncoder->appendKeyValue( &histogramMap, "count",
+                                                            IotSerializer_ScalarSignedInt( ( int64_t ) pHistogram->count ) ) );
+    status = _mergeError( status, pEncoder->appendKeyValue( &histogramMap, "max",
+                                                            IotSerializer_ScalarSignedInt( ( int64_t ) pHistogram->maxMs ) ) );
+    status = _mergeError( status, pEncoder->appendKeyValue( &histogramMap, "sum",
+                                                            IotSerializer_ScalarSignedInt( ( int64_t ) pHistogram->sumMs ) ) );
+    status = _mergeError( status, pEncoder->openContainerWithKey( &histogramMap, "buckets", &bucketsArray,
+                                                                  IOT_TASKPOOL_HISTOGRAM_BUCKETS ) );
+
+    if( ( status == IOT_SERIALIZER_SUCCESS ) || ( status == IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+    {
+        for( i = 0; i < IOT_TASKPOOL_HISTOGRAM_BUCKETS; i++ )
+        {
+            status = _mergeError( status, pEncoder->append( &bucketsArray,
+                                                            IotSerializer_ScalarSignedInt( ( int64_t ) pHistogram->buckets[ i ] ) ) );
+        }
+
+        status = _mergeError( status, pEncoder->closeContainer( &histogramMap, &bucketsArray ) );
+    }
+
+    status = _mergeError( status, pEncoder->closeContainer( pMap, &histogramMap ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static IotSerializerError_t _encodeStats( const IotSerializerEncodeInterface_t * pEncoder,
+                                          IotSerializerEncoderObject_t * pEncoderObject,
+                                          const IotTaskPoolStats_t * pStats )
+{
+    IotSerializerError_t status = IOT_SERIALIZER_SUCCESS;
+    IotSerializerEncoderObject_t statsMap = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_MAP;
+    size_t i = 0;
+
+    const struct
+    {
+        const char * pKey;
+        uint32_t value;
+    } counters[] =
+    {
+        { "queued_jobs",            pStats->queuedJobs           },
+        { "peak_queued_jobs",       pStats->peakQueuedJobs       },
+        { "deferred_jobs",          pStats->deferredJobs         },
+        { "active_threads",         pStats->activeThreads        },
+        { "threads_created",        pStats->threadsCreated       },
+        { "threads_exited",         pStats->threadsExited        },
+        { "thread_create_failures", pStats->threadCreateFailures },
+        { "cache_hits",             pStats->cacheHits            },
+        { "cache_misses",           pStats->cacheMisses          }
+    };
+
+    status = _mergeError( status, pEncoder->openContainer( pEncoderObject, &statsMap, TASKPOOL_STATS_MAP_SIZE ) );
+
+    if( ( status != IOT_SERIALIZER_SUCCESS ) && ( status != IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+    {
+        return status;
+    }
+
+    for( i = 0; i < sizeof( counters ) / sizeof( counters[ 0 ] ); i++ )
+    {
+        status = _mergeError( status, pEncoder->appendKeyValue( &statsMap,
+                                                                counters[ i ].pKey,
+                                                                IotSerializer_ScalarSignedInt( ( int64_t ) counters[ i ].value ) ) );
+    }
+
+    status = _mergeError( status, _encodeHistogram( pEncoder, &statsMap, "queue_delay_ms", &pStats->queueDelay ) );
+    status = _mergeError( status, _encodeHistogram( pEncoder, &statsMap, "execution_time_ms", &pStats->executionTime ) );
+    status = _mergeError( status, _encodeHistogram( pEncoder, &statsMap, "timer_lateness_ms", &pStats->timerLateness ) );
+
+    status = _mergeError( status, pEncoder->closeContainer( pEncoderObject, &statsMap ) );
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+IotSerializerError_t IotSerializer_EncodeTaskPoolStats( const IotSerializerEncodeInterface_t * pEncoder,
+                                                        const IotTaskPoolStats_t * pStats,
+                                                        uint8_t * pBuffer,
+                                                        size_t * pSize )
+{
+    IotSerializerError_t status = IOT_SERIALIZER_SUCCESS;
+    IotSerializerEncoderObject_t encoderObject = IOT_SERIALIZER_ENCODER_CONTAINER_INITIALIZER_STREAM;
+    size_t maxSize = 0;
+
+    if( ( pEncoder == NULL ) || ( pStats == NULL ) || ( pSize == NULL ) )
+    {
+        return IOT_SERIALIZER_INVALID_INPUT;
+    }
+
+    /* Without a buffer, the encoding is a dry run to compute the size needed. */
+    if( pBuffer != NULL )
+    {
+        maxSize = *pSize;
+    }
+
+    status = pEncoder->init( &encoderObject, pBuffer, maxSize );
+
+    if( status == IOT_SERIALIZER_SUCCESS )
+    {
+        status = _encodeStats( pEncoder, &encoderObject, pStats );
+
+        if( ( status == IOT_SERIALIZER_SUCCESS ) && ( pBuffer != NULL ) )
+        {
+            *pSize = pEncoder->getEncodedSize( &encoderObject, pBuffer );
+        }
+        else if( ( status == IOT_SERIALIZER_SUCCESS ) || ( status == IOT_SERIALIZER_BUFFER_TOO_SMALL ) )
+        {
+            *pSize = maxSize + pEncoder->getExtraBufferSizeNeeded( &encoderObject );
+
+            if( pBuffer == NULL )
+            {
+                status = IOT_SERIALIZER_SUCCESS;
+            }
+        }
+
+        pEncoder->destroy( &encoderObject );
+    }
+
+    return status;
+}
@@ -29,6 +29,7 @@
 
 /* Serializer includes. */
 #include "iot_serializer.h"
+#include "iot_serializer_taskpool.h"
 
 #define _encoder        _IotSerializerJsonEncoder
 #define _decoder        _IotSerializerJsonDecoder
@@ -78,6 +79,8 @@ TEST_GROUP_RUNNER( Full_Serializer_JSON )
 
     RUN_TEST_CASE( Full_Serializer_JSON, Encoder_map_nest_map );
     RUN_TEST_CASE( Full_Serializer_JSON, Encoder_map_nest_array );
+
+    RUN_TEST_CASE( Full_Serializer_JSON, Encoder_taskpool_stats );
 }
 
 TEST( Full_Serializer_JSON, Encoder_init_with_null_buffer )
@@ -264,6 +267,47 @@ TEST( Full_Serializer_JSON, Encoder_map_nest_array )
     _verifyExpectedString( "{\"array\":[3,2,1]}" );
 }
 
+TEST( Full_Serializer_JSON, Encoder_taskpool_stats )
+{
+    IotTaskPoolStats_t stats;
+    size_t size = 0, neededSize = 0;
+    uint8_t statsBuffer[ 1024 ] = { 0 };
+
+    memset( &stats, 0, sizeof( IotTaskPoolStats_t ) );
+    stats.queuedJobs = 2;
+    stats.cacheHits = 3;
+    stats.executionTime.count = 1;
+    stats.executionTime.maxMs = 5;
+    stats.executionTime.sumMs = 5;
+    stats.executionTime.buckets[ 3 ] = 1;
+
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_INVALID_INPUT,
+                       IotSerializer_EncodeTaskPoolStats( &_encoder, NULL, statsBuffer, &size ) );
+
+    /* Compute the size needed, then encode in a buffer of that size. */
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       IotSerializer_EncodeTaskPoolStats( &_encoder, &stats, NULL, &neededSize ) );
+    TEST_ASSERT_TRUE( neededSize < sizeof( statsBuffer ) );
+
+    size = neededSize - 1;
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_BUFFER_TOO_SMALL,
+                       IotSerializer_EncodeTaskPoolStats( &_encoder, &stats, statsBuffer, &size ) );
+    TEST_ASSERT_EQUAL( neededSize, size );
+
+    memset( statsBuffer, 0, sizeof( statsBuffer ) );
+    size = neededSize;
+    TEST_ASSERT_EQUAL( IOT_SERIALIZER_SUCCESS,
+                       IotSerializer_EncodeTaskPoolStats( &_encoder, &stats, statsBuffer, &size ) );
+    TEST_ASSERT_TRUE( size <= neededSize );
+
+    /* --- Verification --- */
+    TEST_ASSERT_EQUAL( 0, strncmp( "{\"queued_jobs\":2,", ( const char * ) statsBuffer, 16 ) );
+    TEST_ASSERT_NOT_NULL( strstr( ( const char * ) statsBuffer, "\"cache_hits\":3" ) );
+    TEST_ASSERT_NOT_NULL( strstr( ( const char * ) statsBuffer,
+                                  "\"execution_time_ms\":{\"count\":1,\"max\":5,\"sum\":5,\"buckets\":[0,0,0,1,0,0,0,0,0,0,0,0,0,0,0,0]}" ) );
+    TEST_ASSERT_EQUAL( '}', statsBuffer[ size - 1 ] );
+}
+
 /*-----------------------------------------------------------*/
 
 static void _verifyExpectedString( const char * pExpectedResult )
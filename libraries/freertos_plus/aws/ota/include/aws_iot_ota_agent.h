@@ -41,6 +41,11 @@
 /* Include for console serial output. */
 #include "aws_logging_task.h"
 
+/* Include for the stdio file handle used by the simulators. */
+#if defined( WIN32 ) || defined( __linux__ )
+    #include <stdio.h>
+#endif
+
 /* Evaluates to the length of a constant string defined like 'static const char str[]= "xyz"; */
 #define CONST_STRLEN( s )    ( ( ( uint32_t ) sizeof( s ) ) - 1UL )
 
@@ -219,7 +224,7 @@ typedef struct
     {
         int32_t lFileHandle;      /*!< Device internal file pointer or handle.
 	                                     * File type is handle after file is open for write. */
-#if WIN32
+#if defined( WIN32 ) || defined( __linux__ )
             FILE * pxFile;       /*!< File type is stdio FILE structure after file is open for write. */
 #endif
 		uint8_t    *pucFile;            /*!< File type is RAM/Flash image pointer after file is open for write. */
@@ -60,8 +60,8 @@
  * us to do the same thing as a zero offset without the lint warnings of using a
  * null pointer. No structure is anywhere near 64K in size.
  * */
-/*lint -emacro((923,9078),OFFSET_OF) Intentionally cast pointer to uint32_t because we are using it as an offset. */
-#define OFFSET_OF( t, e )    ( ( uint32_t ) ( &( ( t * ) 0x10000UL )->e ) & 0xffffUL )
+/*lint -emacro((923,9078),OFFSET_OF) Intentionally cast pointer to uintptr_t because we are using it as an offset. */
+#define OFFSET_OF( t, e )    ( ( uintptr_t ) ( &( ( t * ) 0x10000UL )->e ) & 0xffffUL )
 
 /* General constants. */
 #define OTA_MAX_JSON_STR_LEN               256U             /* Limit our JSON string compares to something small to avoid going into the weeds. */
@@ -206,7 +206,7 @@ static const char * pcOTA_JobStatus_Strings[ eNumJobStatusMappings ] =
 #define OTA_DOC_MODEL_MAX_PARAMS    32U                    /* The parameter list is backed by a 32 bit longword bitmap by design. */
 #define OTA_JOB_PARAM_REQUIRED      ( ( bool_t ) pdTRUE )  /* Used to denote a required document model parameter. */
 #define OTA_JOB_PARAM_OPTIONAL      ( ( bool_t ) pdFALSE ) /* Used to denote an optional document model parameter. */
-#define OTA_DONT_STORE_PARAM        0xffffffffUL           /* If ulDestOffset in the model is 0xffffffff, do not store the value. */
+#define OTA_DONT_STORE_PARAM        UINTPTR_MAX            /* If ulDestOffset in the model is all ones, do not store the value. */
 
 /* This union allows us to access document model parameter addresses as their
  * actual type without casting every time we access a parameter. */
@@ -216,7 +216,7 @@ typedef union MultiParmPtr
     char ** ppcPtr;
     const char ** ppccPtr;
     uint32_t * pulPtr;
-    uint32_t ulVal;
+    uintptr_t ulVal;
     bool_t * pxBoolPtr;
     Sig256_t ** ppxSig256Ptr;
     void ** ppvPtr;
@@ -398,7 +398,7 @@ static DocParseErr_t prvSearchModelForTokenKey( JSON_DocModel_t * pxDocModel,
 
 static DocParseErr_t prvInitDocModel( JSON_DocModel_t * pxDocModel,
                                       const JSON_DocParam_t * pxBodyDef,
-                                      uint32_t ulContextBaseAddr,
+                                      uintptr_t ulContextBaseAddr,
                                       uint32_t ulContextSize,
                                       uint16_t usNumJobParams );
 
@@ -913,11 +913,11 @@ OTA_Err_t OTA_SetImageState( OTA_ImageState_t eState )
             break;
 
         case eOTA_ImageState_Rejected:
-            xErr = prvSetImageStateWithReason( eState, ( uint32_t ) NULL );
+            xErr = prvSetImageStateWithReason( eState, ( uint32_t ) ( uintptr_t ) NULL );
             break;
 
         case eOTA_ImageState_Accepted:
-            xErr = prvSetImageStateWithReason( eState, ( uint32_t ) NULL );
+            xErr = prvSetImageStateWithReason( eState, ( uint32_t ) ( uintptr_t ) NULL );
 
             if( xErr == kOTA_Err_None )
             {
@@ -985,7 +985,7 @@ static OTA_Err_t prvSetImageStateWithReason( OTA_ImageState_t eState,
         {
             if( eState == eOTA_ImageState_Testing )
             { /* We discovered we're ready for test mode, put job status in self_test active. */
-                prvUpdateJobStatus( NULL, eJobStatus_InProgress, ( int32_t ) eJobReason_SelfTestActive, ( int32_t ) NULL );
+                prvUpdateJobStatus( NULL, eJobStatus_InProgress, ( int32_t ) eJobReason_SelfTestActive, ( int32_t ) ( uintptr_t ) NULL );
             }
             else
             {
@@ -1319,9 +1319,9 @@ static void prvOTAPublishCallback( void * pvCallbackContext,
 
         if(pxMsg != NULL)
         {
-			pxMsg->lMsgType = ( int32_t ) pvCallbackContext; /*lint !e923 The context variable is actually the message type. */
+			pxMsg->lMsgType = ( int32_t ) ( uintptr_t ) pvCallbackContext; /*lint !e923 The context variable is actually the message type. */
 			pxMsg->pxPubData.ulDataLength = pxPublishData->u.message.info.payloadLength;
-			if ( ( int32_t ) pvCallbackContext == eOTA_PubMsgType_Stream){
+			if ( ( int32_t ) ( uintptr_t ) pvCallbackContext == eOTA_PubMsgType_Stream){
 				OTA_LOG_L2( "[%s] Stream Received.\r\n", OTA_METHOD_NAME );
 				}
 
@@ -1508,7 +1508,7 @@ static void prvOTAUpdateTask( void * pvUnused )
                                         if( xResult == eIngest_Result_FileComplete )
                                         {
                                             /* File receive is complete and authenticated. Update the job status with the self_test ready identifier. */
-                                            prvUpdateJobStatus( C, eJobStatus_InProgress, ( int32_t ) eJobReason_SigCheckPassed, ( int32_t ) NULL );
+                                            prvUpdateJobStatus( C, eJobStatus_InProgress, ( int32_t ) eJobReason_SigCheckPassed, ( int32_t ) ( uintptr_t ) NULL );
                                         }
                                         else
                                         {
@@ -1549,7 +1549,7 @@ static void prvOTAUpdateTask( void * pvUnused )
                                             /* We're actively receiving a file so update the job status as needed. */
                                             /* First reset the momentum counter since we received a good block. */
                                             C->ulRequestMomentum = 0;
-                                            prvUpdateJobStatus( C, eJobStatus_InProgress, ( int32_t ) eJobReason_Receiving, ( int32_t ) NULL );
+                                            prvUpdateJobStatus( C, eJobStatus_InProgress, ( int32_t ) eJobReason_Receiving, ( int32_t ) ( uintptr_t ) NULL );
                                         }
                                     }
                                 }
@@ -2215,7 +2215,7 @@ static DocParseErr_t prvParseJSONbyModel( const char * pcJSON,
 
 static DocParseErr_t prvInitDocModel( JSON_DocModel_t * pxDocModel,
                                       const JSON_DocParam_t * pxBodyDef,
-                                      uint32_t ulContextBaseAddr,
+                                      uintptr_t ulContextBaseAddr,
                                       uint32_t ulContextSize,
                                       uint16_t usNumJobParams )
 {
@@ -2282,7 +2282,7 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
     /* Namely union initialization and pointers converted to values. */
     static const JSON_DocParam_t xOTA_JobDocModelParamStructure[ OTA_NUM_JOB_PARAMS ] =
     {
-        { pcOTA_JSON_ClientTokenKey,   OTA_JOB_PARAM_OPTIONAL, { ( uint32_t ) &xOTA_Agent.pcClientTokenFromJob }, eModelParamType_StringInDoc, JSMN_STRING    }, /*lint !e9078 !e923 Get address of token as value. */
+        { pcOTA_JSON_ClientTokenKey,   OTA_JOB_PARAM_OPTIONAL, { ( uintptr_t ) &xOTA_Agent.pcClientTokenFromJob }, eModelParamType_StringInDoc, JSMN_STRING    }, /*lint !e9078 !e923 Get address of token as value. */
         { pcOTA_JSON_ExecutionKey,     OTA_JOB_PARAM_REQUIRED, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
         { pcOTA_JSON_JobIDKey,         OTA_JOB_PARAM_REQUIRED, { OFFSET_OF( OTA_FileContext_t, pucJobName )    }, eModelParamType_StringCopy,  JSMN_STRING    },
         { pcOTA_JSON_StatusDetailsKey, OTA_JOB_PARAM_OPTIONAL, { OTA_DONT_STORE_PARAM                          }, eModelParamType_Object,      JSMN_OBJECT    },
@@ -2317,7 +2317,7 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
 
         if( prvInitDocModel( &xOTA_JobDocModel,
                              xOTA_JobDocModelParamStructure,
-                             ( uint32_t ) C, /*lint !e9078 !e923 Intentionally casting context pointer to a value for prvInitDocModel. */
+                             ( uintptr_t ) C, /*lint !e9078 !e923 Intentionally casting context pointer to a value for prvInitDocModel. */
                              sizeof( OTA_FileContext_t ),
                              OTA_NUM_JOB_PARAMS ) != eDocParseErr_None )
         {
@@ -2389,7 +2389,7 @@ static OTA_FileContext_t * prvParseJobDoc( const char * pcJSON,
                          *
                          * Set image state accordingly and update job status with self test identifier.
                          */
-                        ( void ) prvSetImageStateWithReason( eOTA_ImageState_Testing, ( uint32_t ) NULL );
+                        ( void ) prvSetImageStateWithReason( eOTA_ImageState_Testing, ( uint32_t ) ( uintptr_t ) NULL );
                     }
                     else
                     {
@@ -113,7 +113,7 @@ typedef struct
     const bool_t bRequired; /* If true, this parameter must exist in the document. */
     union
     {
-        const uint32_t ulDestOffset;        /* Pointer or offset to where we'll store the value, if not ~0. */
+        const uintptr_t ulDestOffset;       /* Pointer or offset to where we'll store the value, if not ~0. */
         void * const pvDestOffset;          /* Pointer or offset to where we'll store the value, if not ~0. */
     };
     const ModelParamType_t xModelParamType; /* We extract the value, if found, based on this type. */
@@ -132,7 +132,7 @@ typedef struct
  */
 typedef struct
 {
-    uint32_t ulContextBase;            /* The base address of the destination OTA context structure. */
+    uintptr_t ulContextBase;           /* The base address of the destination OTA context structure. */
     uint32_t ulContextSize;            /* The size, in bytes, of the destination context structure. */
     const JSON_DocParam_t * pxBodyDef; /* Pointer to the document model body definition. */
     uint16_t usNumModelParams;         /* The number of entries in the document model (limited to 32). */
@@ -615,12 +615,12 @@ TEST( Full_OTA_PAL, prvPAL_WriteBlock_WriteManyBlocks )
 
 /**
  * Call prvPAL_ActivateNewImage() and verify success. This function is expected to
- * reset the device, so this test is only supported on the Windows Simulator environment.
- * The Windows Simulator environment does not reset.
+ * reset the device, so this test is only supported on the Windows and Linux Simulator
+ * environments.  The simulator environments do not reset.
  */
 TEST( Full_OTA_PAL, prvPAL_ActivateNewImage )
 {
-#ifdef WIN32
+#if defined( WIN32 ) || defined( __linux__ )
     OTA_Err_t xOtaStatus = prvPAL_ActivateNewImage();
 
     TEST_ASSERT_EQUAL_INT( kOTA_Err_None, xOtaStatus );
@@ -740,7 +740,7 @@ TEST( Full_OTA_PAL, prvPAL_SetPlatformImageState_UnknownImageState )
  */
 TEST( Full_OTA_PAL, prvPAL_SetPlatformImageState_AcceptedImageStateButImageNotClosed )
 {
-#ifndef WIN32
+#if !defined( WIN32 ) && !defined( __linux__ )
     OTA_Err_t xOtaStatus;
     OTA_ImageState_t eImageState = eOTA_ImageState_Unknown;
 
@@ -0,0 +1,246 @@
+/*
+FreeRTOS+TCP V2.0.11
+Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of
+this software and associated documentation files (the "Software"), to deal in
+the Software without restriction, including without limitation the rights to
+use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+the Software, and to permit persons to whom the Software is furnished to do so,
+subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ http://aws.amazon.com/freertos
+ http://www.FreeRTOS.org
+*/
+
+/* Network interface for the FreeRTOS Linux simulator.  Frames are exchanged
+with the host through a TAP device, named by configLINUX_TAP_DEVICE, which must
+have been created and brought up before the application starts. */
+
+/* Standard includes. */
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <linux/if_tun.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* FreeRTOS+TCP includes. */
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkBufferManagement.h"
+
+/* If ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES is set to 1, then the Ethernet
+driver will filter incoming packets and only pass the stack those packets it
+considers need processing. */
+#if( ipconfigETHERNET_DRIVER_FILTERS_FRAME_TYPES == 0 )
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eProcessBuffer
+#else
+	#define ipCONSIDER_FRAME_FOR_PROCESSING( pucEthernetBuffer ) eConsiderFrameForProcessing( ( pucEthernetBuffer ) )
+#endif
+
+#ifndef configLINUX_TAP_DEVICE
+	#define configLINUX_TAP_DEVICE	"tap0"
+#endif
+
+#ifndef configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY
+	#define configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY	( 1 )
+#endif
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Open the TAP device named by configLINUX_TAP_DEVICE for non-blocking access.
+ */
+static int prvOpenTapDevice( void );
+
+/*
+ * A task that polls the TAP device and passes received frames to the IP task,
+ * standing in for the receive interrupt of a real MAC.
+ */
+static void prvInterruptSimulatorTask( void *pvParameters );
+
+/*-----------------------------------------------------------*/
+
+/* The file descriptor of the open TAP device, or -1. */
+static int iTapDevice = -1;
+
+/* Logs the number of TAP send failures, for viewing in the debugger only. */
+static volatile uint32_t ulTapSendFailures = 0;
+
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceInitialise( void )
+{
+BaseType_t xReturn = pdFAIL;
+
+	/* The interface may be initialised again after the network goes down, in
+	which case the device and the task already exist. */
+	if( iTapDevice < 0 )
+	{
+		iTapDevice = prvOpenTapDevice();
+
+		if( iTapDevice >= 0 )
+		{
+			if( xTaskCreate( prvInterruptSimulatorTask,
+							 "MAC_ISR",
+							 configMINIMAL_STACK_SIZE,
+							 NULL,
+							 configMAC_ISR_SIMULATOR_PRIORITY,
+							 NULL ) != pdPASS )
+			{
+				close( iTapDevice );
+				iTapDevice = -1;
+			}
+		}
+	}
+
+	if( iTapDevice >= 0 )
+	{
+		xReturn = pdPASS;
+	}
+
+	return xReturn;
+}
+/*-----------------------------------------------------------*/
+
+BaseType_t xNetworkInterfaceOutput( NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t bReleaseAfterSend )
+{
+ssize_t xWritten;
+
+	iptraceNETWORK_INTERFACE_TRANSMIT();
+
+	/* A TAP device accepts one whole frame per write.  The write does not
+	block, so a frame the host cannot queue is dropped as a real MAC would. */
+	xWritten = write( iTapDevice, pxNetworkBuffer->pucEthernetBuffer, pxNetworkBuffer->xDataLength );
+
+	if( xWritten != ( ssize_t ) pxNetworkBuffer->xDataLength )
+	{
+		ulTapSendFailures++;
+	}
+
+	/* The buffer has been sent so can be released. */
+	if( bReleaseAfterSend != pdFALSE )
+	{
+		vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+	}
+
+	return pdPASS;
+}
+/*-----------------------------------------------------------*/
+
+static int prvOpenTapDevice( void )
+{
+int iDevice;
+struct ifreq xRequest;
+
+	iDevice = open( "/dev/net/tun", O_RDWR | O_NONBLOCK );
+
+	if( iDevice < 0 )
+	{
+		FreeRTOS_printf( ( "Failed to open /dev/net/tun: %s\n", strerror( errno ) ) );
+	}
+	else
+	{
+		memset( &xRequest, 0x00, sizeof( xRequest ) );
+		xRequest.ifr_flags = IFF_TAP | IFF_NO_PI;
+		strncpy( xRequest.ifr_name, configLINUX_TAP_DEVICE, IFNAMSIZ - 1 );
+
+		if( ioctl( iDevice, TUNSETIFF, &xRequest ) < 0 )
+		{
+			FreeRTOS_printf( ( "Failed to attach to TAP device %s: %s\n", configLINUX_TAP_DEVICE, strerror( errno ) ) );
+			close( iDevice );
+			iDevice = -1;
+		}
+		else
+		{
+			FreeRTOS_printf( ( "Using TAP device %s\n", configLINUX_TAP_DEVICE ) );
+		}
+	}
+
+	return iDevice;
+}
+/*-----------------------------------------------------------*/
+
+static void prvInterruptSimulatorTask( void *pvParameters )
+{
+uint8_t ucRecvBuffer[ ipTOTAL_ETHERNET_FRAME_SIZE ];
+ssize_t xReceived;
+NetworkBufferDescriptor_t *pxNetworkBuffer;
+IPStackEvent_t xRxEvent = { eNetworkRxEvent, NULL };
+eFrameProcessingResult_t eResult;
+
+	/* Remove compiler warnings about unused parameters. */
+	( void ) pvParameters;
+
+	for( ;; )
+	{
+		/* The device is non-blocking, so the task never blocks the simulator
+		inside the host kernel. */
+		xReceived = read( iTapDevice, ucRecvBuffer, sizeof( ucRecvBuffer ) );
+
+		if( xReceived > 0 )
+		{
+			iptraceNETWORK_INTERFACE_RECEIVE();
+
+			/* Check for minimal size. */
+			if( xReceived >= ( ssize_t ) sizeof( EthernetHeader_t ) )
+			{
+				eResult = ipCONSIDER_FRAME_FOR_PROCESSING( ucRecvBuffer );
+			}
+			else
+			{
+				eResult = eReleaseBuffer;
+			}
+
+			if( eResult == eProcessBuffer )
+			{
+				/* Obtain a buffer into which the data can be placed.  This is
+				only an interrupt simulator, not a real interrupt, so it is ok
+				to call the task level function here. */
+				pxNetworkBuffer = pxGetNetworkBufferWithDescriptor( ( size_t ) xReceived, 0 );
+
+				if( pxNetworkBuffer != NULL )
+				{
+					memcpy( pxNetworkBuffer->pucEthernetBuffer, ucRecvBuffer, ( size_t ) xReceived );
+					pxNetworkBuffer->xDataLength = ( size_t ) xReceived;
+					xRxEvent.pvData = ( void * ) pxNetworkBuffer;
+
+					/* Data was received and stored.  Send a message to the IP
+					task to let it know. */
+					if( xSendEventStructToIPTask( &xRxEvent, ( TickType_t ) 0 ) == pdFAIL )
+					{
+						vReleaseNetworkBufferAndDescriptor( pxNetworkBuffer );
+						iptraceETHERNET_RX_EVENT_LOST();
+					}
+				}
+				else
+				{
+					iptraceETHERNET_RX_EVENT_LOST();
+				}
+			}
+		}
+		else
+		{
+			/* There is no real way of simulating an interrupt.  Make sure
+			other tasks can run. */
+			vTaskDelay( configLINUX_MAC_INTERRUPT_SIMULATOR_DELAY );
+		}
+	}
+}
+/*-----------------------------------------------------------*/
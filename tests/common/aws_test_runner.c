@@ -72,6 +72,16 @@ static void RunTests( void )
 
     #if ( testrunnerFULL_TASKPOOL_ENABLED == 1 )
             RUN_TEST_GROUP( Common_Unit_Task_Pool );
+            RUN_TEST_GROUP( Common_Unit_Slab );
+            RUN_TEST_GROUP( Common_Unit_Logging_Task );
+            RUN_TEST_GROUP( Common_Unit_Logging_Binary );
+    #endif
+
+    #if ( testrunnerFULL_KERNEL_ENABLED == 1 )
+        RUN_TEST_GROUP( Full_Kernel_Queue );
+        RUN_TEST_GROUP( Full_Kernel_Stream_Buffer );
+        RUN_TEST_GROUP( Full_Kernel_Timers );
+        RUN_TEST_GROUP( Full_Kernel_Profile );
     #endif
 
     #if ( testrunnerFULL_WIFI_PROVISIONING_ENABLED == 1 )
@@ -105,9 +115,15 @@ static void RunTests( void )
         RUN_TEST_GROUP( MQTT_Unit_Subscription );
         RUN_TEST_GROUP( MQTT_Unit_Receive );
         RUN_TEST_GROUP( MQTT_Unit_API );
+        RUN_TEST_GROUP( MQTT_Unit_Outbox );
         RUN_TEST_GROUP( MQTT_System );
     #endif /* if ( testrunnerFULL_MQTTv4_ENABLED == 1 ) */
 
+    #if ( testrunnerFULL_MQTT_PERF_ENABLED == 1 )
+        RUN_TEST_GROUP( MQTT_Perf_Ack );
+        RUN_TEST_GROUP( MQTT_Perf_Client );
+    #endif
+
     #if ( testrunnerFULL_MQTT_STRESS_TEST_ENABLED == 1 )
         RUN_TEST_GROUP( Full_MQTT_Agent_Stress_Tests );
     #endif
@@ -170,6 +186,10 @@ static void RunTests( void )
         RUN_TEST_GROUP( UTIL_Platform_Threads );
     #endif
 
+    #if ( testrunnerUTIL_PLATFORM_MEMORY_ENABLED == 1 )
+        RUN_TEST_GROUP( UTIL_Platform_Memory );
+    #endif
+
     #if ( testrunnerFULL_BLE_ENABLED == 1 )
         RUN_TEST_GROUP( MQTT_Unit_BLE_Serialize );
         RUN_TEST_GROUP( Full_BLE );
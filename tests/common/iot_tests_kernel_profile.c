@@ -0,0 +1,428 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_kernel_profile.c
+ * @brief Tests for the scheduler profiler.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Number of times the helper task blocks on the queue.
+ */
+#define TEST_QUEUE_WAITS           ( 5 )
+
+/**
+ * @brief Number of times the helper task blocks on the stream buffer.
+ */
+#define TEST_STREAM_WAITS          ( 3 )
+
+/**
+ * @brief Number of times the helper task delays.
+ */
+#define TEST_DELAYS                ( 4 )
+
+/**
+ * @brief Ticks to wait for the helper task.
+ */
+#define TEST_TIMEOUT_TICKS         ( pdMS_TO_TICKS( 5000 ) )
+
+/**
+ * @brief Stack size of the helper task.
+ */
+#define TEST_TASK_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 4 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The queue the helper task blocks on.
+ */
+static QueueHandle_t _queue = NULL;
+
+/**
+ * @brief The stream buffer the helper task blocks on.
+ */
+static StreamBufferHandle_t _streamBuffer = NULL;
+
+/**
+ * @brief Given by the helper task when it is done.
+ */
+static SemaphoreHandle_t _helperDone = NULL;
+
+/**
+ * @brief The helper task.
+ */
+static TaskHandle_t _helperTask = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait until the helper task is blocked.
+ */
+static void _waitForHelperToBlock( void )
+{
+    TickType_t waited = 0;
+
+    while( ( eTaskGetState( _helperTask ) != eBlocked ) && ( waited < TEST_TIMEOUT_TICKS ) )
+    {
+        vTaskDelay( 1 );
+        waited++;
+    }
+
+    TEST_ASSERT_EQUAL( eBlocked, eTaskGetState( _helperTask ) );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+/**
+ * @brief Block on the queue, on the stream buffer and in delays a known number
+ * of times, then wait to be deleted.
+ */
+    static void _helperTaskFunction( void * pArgument )
+    {
+        uint32_t i = 0, item = 0;
+        uint8_t byte = 0;
+
+        ( void ) pArgument;
+
+        for( i = 0; i < TEST_QUEUE_WAITS; i++ )
+        {
+            ( void ) xQueueReceive( _queue, &item, portMAX_DELAY );
+        }
+
+        for( i = 0; i < TEST_STREAM_WAITS; i++ )
+        {
+            ( void ) xStreamBufferReceive( _streamBuffer, &byte, sizeof( byte ), portMAX_DELAY );
+        }
+
+        for( i = 0; i < TEST_DELAYS; i++ )
+        {
+            vTaskDelay( 2 );
+        }
+
+        ( void ) xSemaphoreGive( _helperDone );
+
+        for( ; ; )
+        {
+            ( void ) ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run the helper task through all its waits, and leave it blocked.
+ */
+    static void _runHelper( void )
+    {
+        uint32_t i = 0;
+        uint8_t byte = 0;
+
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _helperTaskFunction,
+                                                "Profiled",
+                                                TEST_TASK_STACK_SIZE,
+                                                NULL,
+                                                uxTaskPriorityGet( NULL ) + 1,
+                                                &_helperTask ) );
+
+        /* Only send once the helper task is blocked, so it blocks every time. */
+        for( i = 0; i < TEST_QUEUE_WAITS; i++ )
+        {
+            _waitForHelperToBlock();
+            TEST_ASSERT_EQUAL( pdTRUE, xQueueSend( _queue, &i, 0 ) );
+        }
+
+        for( i = 0; i < TEST_STREAM_WAITS; i++ )
+        {
+            _waitForHelperToBlock();
+            TEST_ASSERT_EQUAL( sizeof( byte ), xStreamBufferSend( _streamBuffer, &byte, sizeof( byte ), 0 ) );
+        }
+
+        TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+        _waitForHelperToBlock();
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Read a little endian value of a number of bytes from a record.
+ */
+    static uint64_t _readValue( const uint8_t ** ppNext,
+                                size_t length )
+    {
+        uint64_t value = 0;
+        size_t i = 0;
+
+        for( i = 0; i < length; i++ )
+        {
+            value |= ( ( uint64_t ) ( *ppNext )[ i ] ) << ( 8 * i );
+        }
+
+        *ppNext += length;
+
+        return value;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a histogram read from a record.
+ */
+    static void _checkHistogram( const uint8_t ** ppNext,
+                                 const TaskProfileHistogram_t * pHistogram )
+    {
+        uint32_t i = 0;
+
+        TEST_ASSERT_EQUAL_UINT32( pHistogram->ulCount, ( uint32_t ) _readValue( ppNext, 4 ) );
+        TEST_ASSERT_EQUAL_UINT32( pHistogram->ulMax, ( uint32_t ) _readValue( ppNext, 4 ) );
+
+        for( i = 0; i < configPROFILER_HISTOGRAM_BUCKETS; i++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( pHistogram->ulBuckets[ i ], ( uint32_t ) _readValue( ppNext, 4 ) );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a wait entry read from a record.
+ */
+    static void _checkWait( const uint8_t ** ppNext,
+                            const TaskProfileWait_t * pWait )
+    {
+        TEST_ASSERT_EQUAL_UINT64( ( uint64_t ) ( portPOINTER_SIZE_TYPE ) pWait->pvObject,
+                                  _readValue( ppNext, sizeof( portPOINTER_SIZE_TYPE ) ) );
+        TEST_ASSERT_EQUAL_UINT32( pWait->ulCount, ( uint32_t ) _readValue( ppNext, 4 ) );
+        TEST_ASSERT_EQUAL_UINT32( pWait->ulTotalTime, ( uint32_t ) _readValue( ppNext, 4 ) );
+        TEST_ASSERT_EQUAL_UINT32( pWait->ulMaxTime, ( uint32_t ) _readValue( ppNext, 4 ) );
+    }
+
+#endif /* if ( configUSE_SCHEDULER_PROFILER == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for scheduler profiler tests.
+ */
+TEST_GROUP( Full_Kernel_Profile );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for scheduler profiler tests.
+ */
+TEST_SETUP( Full_Kernel_Profile )
+{
+    _queue = xQueueCreate( 1, sizeof( uint32_t ) );
+    TEST_ASSERT_NOT_NULL( _queue );
+
+    _streamBuffer = xStreamBufferCreate( 8, 1 );
+    TEST_ASSERT_NOT_NULL( _streamBuffer );
+
+    _helperDone = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL( _helperDone );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for scheduler profiler tests.
+ */
+TEST_TEAR_DOWN( Full_Kernel_Profile )
+{
+    if( _helperTask != NULL )
+    {
+        /* Only delete the helper task while it is blocked. */
+        _waitForHelperToBlock();
+        vTaskDelete( _helperTask );
+        _helperTask = NULL;
+    }
+
+    vSemaphoreDelete( _helperDone );
+    vStreamBufferDelete( _streamBuffer );
+    vQueueDelete( _queue );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for scheduler profiler tests.
+ */
+TEST_GROUP_RUNNER( Full_Kernel_Profile )
+{
+    #if ( configUSE_SCHEDULER_PROFILER == 1 )
+        RUN_TEST_CASE( Full_Kernel_Profile, WaitCounts );
+        RUN_TEST_CASE( Full_Kernel_Profile, SerialisedLayout );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_SCHEDULER_PROFILER == 1 )
+
+/**
+ * @brief Each block on a queue or stream buffer is counted against that
+ * object, and each delay against no object.
+ */
+    TEST( Full_Kernel_Profile, WaitCounts )
+    {
+        TaskProfile_t profile;
+        const TaskProfileWait_t * pWait = NULL;
+        uint32_t i = 0, buckets = 0;
+
+        _runHelper();
+        vTaskGetProfile( _helperTask, &profile );
+
+        /* The objects are entered in the order the task first blocked on
+         * them. */
+        pWait = &( profile.xWaits[ 0 ] );
+        TEST_ASSERT_EQUAL_PTR( _queue, pWait->pvObject );
+        TEST_ASSERT_EQUAL_UINT32( TEST_QUEUE_WAITS, pWait->ulCount );
+        TEST_ASSERT_TRUE( pWait->ulMaxTime <= pWait->ulTotalTime );
+
+        pWait = &( profile.xWaits[ 1 ] );
+        TEST_ASSERT_EQUAL_PTR( _streamBuffer, pWait->pvObject );
+        TEST_ASSERT_EQUAL_UINT32( TEST_STREAM_WAITS, pWait->ulCount );
+        TEST_ASSERT_TRUE( pWait->ulMaxTime <= pWait->ulTotalTime );
+
+        for( i = 2; i < configPROFILER_WAIT_OBJECTS; i++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( 0, profile.xWaits[ i ].ulCount );
+        }
+
+        pWait = &( profile.xOtherWaits );
+        TEST_ASSERT_NULL( pWait->pvObject );
+        TEST_ASSERT_EQUAL_UINT32( TEST_DELAYS, pWait->ulCount );
+
+        /* The task ran once after each wake, and the delays took at least a
+         * tick each. */
+        TEST_ASSERT_EQUAL_UINT32( TEST_QUEUE_WAITS + TEST_STREAM_WAITS + TEST_DELAYS, profile.xWakeLatency.ulCount );
+        TEST_ASSERT_TRUE( pWait->ulTotalTime > 0 );
+
+        for( i = 0; i < configPROFILER_HISTOGRAM_BUCKETS; i++ )
+        {
+            buckets += profile.xWakeLatency.ulBuckets[ i ];
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( profile.xWakeLatency.ulCount, buckets );
+
+        /* Resetting the profile clears every count. */
+        vTaskResetProfile( _helperTask );
+        vTaskGetProfile( _helperTask, &profile );
+        TEST_ASSERT_EQUAL_UINT32( 0, profile.xWaits[ 0 ].ulCount );
+        TEST_ASSERT_EQUAL_UINT32( 0, profile.xOtherWaits.ulCount );
+        TEST_ASSERT_EQUAL_UINT32( 0, profile.xWakeLatency.ulCount );
+        TEST_ASSERT_EQUAL_UINT32( 0, profile.xRunSlice.ulCount );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The serialised record follows the layout documented for
+ * xTaskSerialiseProfile(), and holds the same values as vTaskGetProfile().
+ */
+    TEST( Full_Kernel_Profile, SerialisedLayout )
+    {
+        static uint8_t pRecord[ taskPROFILE_SERIALISED_SIZE + 1 ];
+        TaskProfile_t profile;
+        const uint8_t * pNext = pRecord;
+
+        #if ( configUSE_TRACE_FACILITY == 1 )
+            TaskStatus_t status;
+        #endif
+        uint32_t i = 0;
+
+        _runHelper();
+
+        /* The helper task is blocked, so its profile does not change between
+         * the two calls. */
+        vTaskGetProfile( _helperTask, &profile );
+
+        TEST_ASSERT_EQUAL( 0, xTaskSerialiseProfile( _helperTask, pRecord, taskPROFILE_SERIALISED_SIZE - 1 ) );
+
+        ( void ) memset( pRecord, 0xa5, sizeof( pRecord ) );
+        TEST_ASSERT_EQUAL( taskPROFILE_SERIALISED_SIZE, xTaskSerialiseProfile( _helperTask, pRecord, sizeof( pRecord ) ) );
+        TEST_ASSERT_EQUAL_UINT8( 0xa5, pRecord[ taskPROFILE_SERIALISED_SIZE ] );
+
+        /* Header. */
+        TEST_ASSERT_EQUAL( taskPROFILE_SERIALISED_VERSION, _readValue( &pNext, 1 ) );
+        TEST_ASSERT_EQUAL( configPROFILER_HISTOGRAM_BUCKETS, _readValue( &pNext, 1 ) );
+        TEST_ASSERT_EQUAL( configPROFILER_WAIT_OBJECTS, _readValue( &pNext, 1 ) );
+        TEST_ASSERT_EQUAL( sizeof( portPOINTER_SIZE_TYPE ), _readValue( &pNext, 1 ) );
+        TEST_ASSERT_EQUAL( configMAX_TASK_NAME_LEN, _readValue( &pNext, 1 ) );
+
+        TEST_ASSERT_EQUAL_STRING_LEN( "Profiled", ( const char * ) pNext, sizeof( "Profiled" ) );
+        pNext += configMAX_TASK_NAME_LEN;
+
+        /* Task. */
+        #if ( configUSE_TRACE_FACILITY == 1 )
+            vTaskGetInfo( _helperTask, &status, pdFALSE, eInvalid );
+            TEST_ASSERT_EQUAL_UINT32( status.xTaskNumber, ( uint32_t ) _readValue( &pNext, 4 ) );
+            TEST_ASSERT_EQUAL_UINT32( status.uxCurrentPriority, ( uint32_t ) _readValue( &pNext, 4 ) );
+            TEST_ASSERT_EQUAL_UINT32( status.ulRunTimeCounter, ( uint32_t ) _readValue( &pNext, 4 ) );
+        #else
+            TEST_ASSERT_EQUAL_UINT32( 0, ( uint32_t ) _readValue( &pNext, 4 ) );
+            TEST_ASSERT_EQUAL_UINT32( uxTaskPriorityGet( _helperTask ), ( uint32_t ) _readValue( &pNext, 4 ) );
+            ( void ) _readValue( &pNext, 4 );
+        #endif
+        TEST_ASSERT_EQUAL_UINT32( profile.ulPreemptions, ( uint32_t ) _readValue( &pNext, 4 ) );
+
+        /* Histograms and waits. */
+        _checkHistogram( &pNext, &( profile.xWakeLatency ) );
+        _checkHistogram( &pNext, &( profile.xRunSlice ) );
+
+        for( i = 0; i < configPROFILER_WAIT_OBJECTS; i++ )
+        {
+            _checkWait( &pNext, &( profile.xWaits[ i ] ) );
+        }
+
+        _checkWait( &pNext, &( profile.xOtherWaits ) );
+
+        TEST_ASSERT_EQUAL( taskPROFILE_SERIALISED_SIZE, pNext - pRecord );
+    }
+
+#endif /* if ( configUSE_SCHEDULER_PROFILER == 1 ) */
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,394 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_kernel_queue.c
+ * @brief Tests for the functions that send and receive several queue items.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdint.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The number of items the queue of the tests holds.
+ */
+#define TEST_QUEUE_LENGTH          ( 8 )
+
+/**
+ * @brief The number of items sent by the tests, more than the queue holds.
+ */
+#define TEST_ITEM_COUNT            ( 20 )
+
+/**
+ * @brief Ticks to wait for the helper task of a test.
+ */
+#define TEST_TIMEOUT_TICKS         ( pdMS_TO_TICKS( 5000 ) )
+
+/**
+ * @brief Stack size of the helper task of a test.
+ */
+#define TEST_TASK_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 4 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The queue of the tests.
+ */
+static QueueHandle_t _queue = NULL;
+
+/**
+ * @brief Given by the helper task of a test when it is done.
+ */
+static SemaphoreHandle_t _helperDone = NULL;
+
+/**
+ * @brief The items received by the helper task of a test.
+ */
+static uint32_t _pReceived[ TEST_ITEM_COUNT ];
+
+/**
+ * @brief The number of items received by the helper task of a test.
+ */
+static volatile UBaseType_t _receivedCount = 0;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Fill a buffer with the numbers from `first`.
+ */
+static void _fillItems( uint32_t * pItems,
+                        UBaseType_t count,
+                        uint32_t first )
+{
+    UBaseType_t i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        pItems[ i ] = first + ( uint32_t ) i;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a buffer holds the numbers from `first`.
+ */
+static void _checkItems( const uint32_t * pItems,
+                         UBaseType_t count,
+                         uint32_t first )
+{
+    UBaseType_t i = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        TEST_ASSERT_EQUAL_UINT32( first + ( uint32_t ) i, pItems[ i ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Receive TEST_ITEM_COUNT items, a few at a time.
+ */
+static void _receiverTask( void * pArgument )
+{
+    UBaseType_t received = 0;
+
+    ( void ) pArgument;
+
+    while( _receivedCount < TEST_ITEM_COUNT )
+    {
+        received = uxQueueReceiveMultiple( _queue,
+                                           &( _pReceived[ _receivedCount ] ),
+                                           3,
+                                           TEST_TIMEOUT_TICKS );
+
+        if( received == 0 )
+        {
+            break;
+        }
+
+        _receivedCount += received;
+    }
+
+    ( void ) xSemaphoreGive( _helperDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait, then send 3 items in one call.
+ */
+static void _delayedSenderTask( void * pArgument )
+{
+    uint32_t pItems[ 3 ] = { 0 };
+
+    ( void ) pArgument;
+
+    _fillItems( pItems, 3, 100 );
+    vTaskDelay( pdMS_TO_TICKS( 50 ) );
+    ( void ) uxQueueSendMultiple( _queue, pItems, 3, 0 );
+
+    ( void ) xSemaphoreGive( _helperDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for queue tests.
+ */
+TEST_GROUP( Full_Kernel_Queue );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for queue tests.
+ */
+TEST_SETUP( Full_Kernel_Queue )
+{
+    _receivedCount = 0;
+
+    _queue = xQueueCreate( TEST_QUEUE_LENGTH, sizeof( uint32_t ) );
+    TEST_ASSERT_NOT_NULL( _queue );
+
+    _helperDone = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL( _helperDone );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for queue tests.
+ */
+TEST_TEAR_DOWN( Full_Kernel_Queue )
+{
+    vQueueDelete( _queue );
+    _queue = NULL;
+
+    vSemaphoreDelete( _helperDone );
+    _helperDone = NULL;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for queue tests.
+ */
+TEST_GROUP_RUNNER( Full_Kernel_Queue )
+{
+    RUN_TEST_CASE( Full_Kernel_Queue, SendReceiveMultipleWrap );
+    RUN_TEST_CASE( Full_Kernel_Queue, SendMultiplePartialOnTimeout );
+    RUN_TEST_CASE( Full_Kernel_Queue, SendMultipleBlocksForSpace );
+    RUN_TEST_CASE( Full_Kernel_Queue, ReceiveMultipleReturnsFirstItems );
+    RUN_TEST_CASE( Full_Kernel_Queue, MultipleFromISR );
+    RUN_TEST_CASE( Full_Kernel_Queue, MultipleFromISRWakesTask );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Batches that wrap around the end of the queue storage keep their
+ * order, and a full queue takes no more items.
+ */
+TEST( Full_Kernel_Queue, SendReceiveMultipleWrap )
+{
+    uint32_t pItems[ TEST_ITEM_COUNT ] = { 0 };
+
+    /* Move the read and write positions to the middle of the storage. */
+    _fillItems( pItems, 5, 0 );
+    TEST_ASSERT_EQUAL( 5, uxQueueSendMultiple( _queue, pItems, 5, 0 ) );
+    TEST_ASSERT_EQUAL( 5, uxQueueReceiveMultiple( _queue, pItems, TEST_ITEM_COUNT, 0 ) );
+    _checkItems( pItems, 5, 0 );
+
+    /* Fill the queue in one call, which wraps. */
+    _fillItems( pItems, TEST_ITEM_COUNT, 10 );
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueSendMultiple( _queue, pItems, TEST_QUEUE_LENGTH, 0 ) );
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueMessagesWaiting( _queue ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueSendMultiple( _queue, pItems, 1, 0 ) );
+
+    /* Receive in two calls, the first of which wraps. */
+    TEST_ASSERT_EQUAL( 6, uxQueueReceiveMultiple( _queue, pItems, 6, 0 ) );
+    _checkItems( pItems, 6, 10 );
+    TEST_ASSERT_EQUAL( 2, uxQueueReceiveMultiple( _queue, pItems, TEST_ITEM_COUNT, 0 ) );
+    _checkItems( pItems, 2, 16 );
+
+    /* Nothing is left. */
+    TEST_ASSERT_EQUAL( 0, uxQueueReceiveMultiple( _queue, pItems, TEST_ITEM_COUNT, 0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief When the block time expires, the items that fit are sent and the
+ * others are not.
+ */
+TEST( Full_Kernel_Queue, SendMultiplePartialOnTimeout )
+{
+    uint32_t pItems[ TEST_ITEM_COUNT ] = { 0 };
+    TickType_t start = 0;
+
+    _fillItems( pItems, TEST_ITEM_COUNT, 0 );
+
+    start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueSendMultiple( _queue, pItems, TEST_ITEM_COUNT, 5 ) );
+    TEST_ASSERT_TRUE( xTaskGetTickCount() - start >= 5 );
+
+    /* The items sent are the first ones. */
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueReceiveMultiple( _queue, pItems, TEST_ITEM_COUNT, 0 ) );
+    _checkItems( pItems, TEST_QUEUE_LENGTH, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A batch larger than the queue is sent in full as a receiver makes
+ * space.
+ */
+TEST( Full_Kernel_Queue, SendMultipleBlocksForSpace )
+{
+    uint32_t pItems[ TEST_ITEM_COUNT ] = { 0 };
+
+    _fillItems( pItems, TEST_ITEM_COUNT, 0 );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _receiverTask,
+                                            "QueueReceiver",
+                                            TEST_TASK_STACK_SIZE,
+                                            NULL,
+                                            uxTaskPriorityGet( NULL ),
+                                            NULL ) );
+
+    TEST_ASSERT_EQUAL( TEST_ITEM_COUNT, uxQueueSendMultiple( _queue, pItems, TEST_ITEM_COUNT, TEST_TIMEOUT_TICKS ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+
+    TEST_ASSERT_EQUAL( TEST_ITEM_COUNT, _receivedCount );
+    _checkItems( _pReceived, TEST_ITEM_COUNT, 0 );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A receiver blocked on an empty queue returns the items available
+ * once it is woken, rather than waiting for as many as it asked for.
+ */
+TEST( Full_Kernel_Queue, ReceiveMultipleReturnsFirstItems )
+{
+    uint32_t pItems[ TEST_QUEUE_LENGTH ] = { 0 };
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _delayedSenderTask,
+                                            "QueueSender",
+                                            TEST_TASK_STACK_SIZE,
+                                            NULL,
+                                            uxTaskPriorityGet( NULL ),
+                                            NULL ) );
+
+    TEST_ASSERT_EQUAL( 3, uxQueueReceiveMultiple( _queue, pItems, TEST_QUEUE_LENGTH, TEST_TIMEOUT_TICKS ) );
+    _checkItems( pItems, 3, 100 );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The FromISR variants move the items that fit without blocking,
+ * including when they wrap.
+ */
+TEST( Full_Kernel_Queue, MultipleFromISR )
+{
+    uint32_t pItems[ TEST_ITEM_COUNT ] = { 0 };
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    /* Only the items that fit are sent. */
+    _fillItems( pItems, TEST_ITEM_COUNT, 0 );
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueSendMultipleFromISR( _queue, pItems, TEST_ITEM_COUNT, &higherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL( 0, uxQueueSendMultipleFromISR( _queue, pItems, 1, &higherPriorityTaskWoken ) );
+
+    /* Receive part of them, then send more, which wrap. */
+    TEST_ASSERT_EQUAL( 5, uxQueueReceiveMultipleFromISR( _queue, pItems, 5, &higherPriorityTaskWoken ) );
+    _checkItems( pItems, 5, 0 );
+
+    _fillItems( pItems, 5, TEST_QUEUE_LENGTH );
+    TEST_ASSERT_EQUAL( 5, uxQueueSendMultipleFromISR( _queue, pItems, 5, &higherPriorityTaskWoken ) );
+
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueReceiveMultipleFromISR( _queue, pItems, TEST_ITEM_COUNT, &higherPriorityTaskWoken ) );
+    _checkItems( pItems, TEST_QUEUE_LENGTH, 5 );
+    TEST_ASSERT_EQUAL( 0, uxQueueReceiveMultipleFromISR( _queue, pItems, TEST_ITEM_COUNT, &higherPriorityTaskWoken ) );
+
+    /* No task was waiting. */
+    TEST_ASSERT_EQUAL( pdFALSE, higherPriorityTaskWoken );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Sending from an interrupt to a queue a higher priority task waits
+ * on reports that the task was woken.
+ */
+TEST( Full_Kernel_Queue, MultipleFromISRWakesTask )
+{
+    uint32_t pItems[ TEST_ITEM_COUNT ] = { 0 };
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    /* The receiver runs first, and blocks on the empty queue. */
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _receiverTask,
+                                            "QueueReceiver",
+                                            TEST_TASK_STACK_SIZE,
+                                            NULL,
+                                            uxTaskPriorityGet( NULL ) + 1,
+                                            NULL ) );
+
+    _fillItems( pItems, TEST_ITEM_COUNT, 0 );
+    TEST_ASSERT_EQUAL( TEST_QUEUE_LENGTH, uxQueueSendMultipleFromISR( _queue, pItems, TEST_QUEUE_LENGTH, &higherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL( pdTRUE, higherPriorityTaskWoken );
+
+    /* Send the rest from a task, as the receiver makes space. */
+    TEST_ASSERT_EQUAL( TEST_ITEM_COUNT - TEST_QUEUE_LENGTH,
+                       uxQueueSendMultiple( _queue,
+                                            &( pItems[ TEST_QUEUE_LENGTH ] ),
+                                            TEST_ITEM_COUNT - TEST_QUEUE_LENGTH,
+                                            TEST_TIMEOUT_TICKS ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+    TEST_ASSERT_EQUAL( TEST_ITEM_COUNT, _receivedCount );
+    _checkItems( _pReceived, TEST_ITEM_COUNT, 0 );
+}
+
+/*-----------------------------------------------------------*/
@@ -0,0 +1,905 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_kernel_stream_buffer.c
+ * @brief Tests for writing and reading stream and message buffers in place.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "stream_buffer.h"
+#include "message_buffer.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Size of the storage area of the buffers of the tests. One byte of
+ * it is never used.
+ */
+#define TEST_STORAGE_SIZE          ( 40 )
+
+/**
+ * @brief The number of bytes the length of a message takes in a message
+ * buffer.
+ */
+#define TEST_LENGTH_BYTES          ( sizeof( configMESSAGE_BUFFER_LENGTH_TYPE ) )
+
+/**
+ * @brief The number of bytes written in place by the tests.
+ */
+#define TEST_DATA_LENGTH           ( 12 )
+
+/**
+ * @brief Ticks to wait for the helper task of a test.
+ */
+#define TEST_TIMEOUT_TICKS         ( pdMS_TO_TICKS( 5000 ) )
+
+/**
+ * @brief Stack size of the helper task of a test.
+ */
+#define TEST_TASK_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 4 )
+
+/**
+ * @brief Size of the storage area of the multi-producer message buffers of
+ * the tests.
+ */
+#define TEST_MULTI_PRODUCER_SIZE    ( 256 )
+
+/**
+ * @brief Number of tasks sending to a multi-producer message buffer at the
+ * same time. The last one has a higher priority than the others.
+ */
+#define TEST_WRITER_COUNT           ( 5 )
+
+/**
+ * @brief Number of messages sent by each writer.
+ */
+#define TEST_WRITER_MESSAGES        ( 2000 )
+
+/**
+ * @brief The longest message sent by a writer.
+ */
+#define TEST_MESSAGE_MAX_LENGTH     ( 48 )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The storage area of the buffer of the tests.
+ */
+static uint8_t _pStorage[ TEST_STORAGE_SIZE ];
+
+/**
+ * @brief The buffer of the tests.
+ */
+static StaticStreamBuffer_t _staticBuffer;
+
+/**
+ * @brief The handle of the buffer of the tests.
+ */
+static StreamBufferHandle_t _buffer = NULL;
+
+/**
+ * @brief The index in the storage area the buffer writes to and reads from
+ * next.
+ */
+static size_t _position = 0;
+
+/**
+ * @brief Given by the helper task of a test when it is done.
+ */
+static SemaphoreHandle_t _helperDone = NULL;
+
+/**
+ * @brief The number of bytes handed out to the helper task of a test.
+ */
+static volatile size_t _helperLength = 0;
+
+/**
+ * @brief Given by each writer to a multi-producer message buffer when it is
+ * done.
+ */
+static SemaphoreHandle_t _writersDone = NULL;
+
+/**
+ * @brief The header of the messages sent by the writers to a multi-producer
+ * message buffer. Numbered bytes follow it.
+ */
+typedef struct _testMessage
+{
+    uint32_t writer;   /**< @brief The writer of the message. */
+    uint32_t sequence; /**< @brief The number of the message, counting from 0 for each writer. */
+} _testMessage_t;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Get a byte of a region, counting from the start of its first part.
+ */
+static uint8_t * _regionByte( const StreamBufferRegion_t * pRegion,
+                              size_t index )
+{
+    uint8_t * pByte = NULL;
+
+    if( index < pRegion->xFirstLengthBytes )
+    {
+        pByte = pRegion->pucFirst + index;
+    }
+    else
+    {
+        pByte = pRegion->pucSecond + ( index - pRegion->xFirstLengthBytes );
+    }
+
+    return pByte;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a region describes `length` bytes of the storage area from
+ * `start`, wrapping at its end.
+ */
+static void _checkRegion( const StreamBufferRegion_t * pRegion,
+                          size_t start,
+                          size_t length )
+{
+    size_t firstLength = TEST_STORAGE_SIZE - ( start % TEST_STORAGE_SIZE );
+
+    if( firstLength > length )
+    {
+        firstLength = length;
+    }
+
+    TEST_ASSERT_EQUAL_PTR( &( _pStorage[ start % TEST_STORAGE_SIZE ] ), pRegion->pucFirst );
+    TEST_ASSERT_EQUAL( firstLength, pRegion->xFirstLengthBytes );
+    TEST_ASSERT_EQUAL( length - firstLength, pRegion->xSecondLengthBytes );
+
+    if( length > firstLength )
+    {
+        TEST_ASSERT_EQUAL_PTR( _pStorage, pRegion->pucSecond );
+    }
+    else
+    {
+        TEST_ASSERT_NULL( pRegion->pucSecond );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Write numbered bytes to a region.
+ */
+static void _writeRegion( const StreamBufferRegion_t * pRegion,
+                          size_t length,
+                          uint8_t first )
+{
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        *_regionByte( pRegion, i ) = ( uint8_t ) ( first + i );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Check a region holds numbered bytes.
+ */
+static void _checkRegionData( const StreamBufferRegion_t * pRegion,
+                              size_t length,
+                              uint8_t first )
+{
+    size_t i = 0;
+
+    for( i = 0; i < length; i++ )
+    {
+        TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) ( first + i ), *_regionByte( pRegion, i ) );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Create the buffer of a test, with its next write at the start of the
+ * storage area.
+ */
+static void _createBuffer( BaseType_t isMessageBuffer )
+{
+    ( void ) memset( _pStorage, 0x00, sizeof( _pStorage ) );
+
+    if( isMessageBuffer == pdTRUE )
+    {
+        _buffer = ( StreamBufferHandle_t ) xMessageBufferCreateStatic( TEST_STORAGE_SIZE, _pStorage, &_staticBuffer );
+    }
+    else
+    {
+        _buffer = xStreamBufferCreateStatic( TEST_STORAGE_SIZE, 1, _pStorage, &_staticBuffer );
+    }
+
+    TEST_ASSERT_NOT_NULL( _buffer );
+    _position = 0;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Move the next write and read of the empty buffer of a test to an
+ * index in the storage area, by sending and receiving data.
+ */
+static void _moveTo( size_t index,
+                     size_t lengthBytes )
+{
+    uint8_t pData[ TEST_STORAGE_SIZE ] = { 0 };
+    size_t distance = 0, step = 0;
+
+    while( _position != index )
+    {
+        /* Each message takes its length as well as its data, so a short
+         * distance is covered by wrapping around the storage area twice. */
+        distance = ( index + TEST_STORAGE_SIZE - _position ) % TEST_STORAGE_SIZE;
+
+        if( distance > lengthBytes )
+        {
+            step = distance;
+        }
+        else
+        {
+            step = TEST_STORAGE_SIZE / 2;
+        }
+
+        TEST_ASSERT_EQUAL( step - lengthBytes, xStreamBufferSend( _buffer, pData, step - lengthBytes, 0 ) );
+        TEST_ASSERT_EQUAL( step - lengthBytes, xStreamBufferReceive( _buffer, pData, sizeof( pData ), 0 ) );
+
+        _position = ( _position + step ) % TEST_STORAGE_SIZE;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait for data in the buffer of a test, then release it.
+ */
+static void _receiveAcquireTask( void * pArgument )
+{
+    StreamBufferRegion_t region = { 0 };
+
+    ( void ) pArgument;
+
+    _helperLength = xStreamBufferReceiveAcquire( _buffer, &region, TEST_TIMEOUT_TICKS );
+    ( void ) xStreamBufferReceiveRelease( _buffer, _helperLength );
+
+    ( void ) xSemaphoreGive( _helperDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait, then release the data in the buffer of a test.
+ */
+static void _delayedReleaseTask( void * pArgument )
+{
+    StreamBufferRegion_t region = { 0 };
+
+    ( void ) pArgument;
+
+    vTaskDelay( pdMS_TO_TICKS( 50 ) );
+    _helperLength = xStreamBufferReceiveAcquire( _buffer, &region, 0 );
+    ( void ) xStreamBufferReceiveRelease( _buffer, _helperLength );
+
+    ( void ) xSemaphoreGive( _helperDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The length of a message sent by a writer to a multi-producer message
+ * buffer, which varies so that records wrap around the storage area at
+ * different places.
+ */
+static size_t _messageLength( uint32_t writer,
+                              uint32_t sequence )
+{
+    return sizeof( _testMessage_t ) +
+           ( ( ( size_t ) writer * 13U + ( size_t ) sequence * 7U ) % ( TEST_MESSAGE_MAX_LENGTH - sizeof( _testMessage_t ) + 1U ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Send numbered messages to a multi-producer message buffer, waiting a
+ * tick whenever it is full. The first writer sends from an interrupt, and the
+ * last one, which has a higher priority, sends bursts of messages a tick apart
+ * to preempt the others.
+ */
+static void _multiProducerWriterTask( void * pArgument )
+{
+    uint32_t writer = ( uint32_t ) ( uintptr_t ) pArgument, sequence = 0;
+    uint8_t pMessage[ TEST_MESSAGE_MAX_LENGTH ] = { 0 };
+    _testMessage_t * pHeader = ( _testMessage_t * ) pMessage;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    size_t length = 0, i = 0, sent = 0;
+
+    for( sequence = 0; sequence < TEST_WRITER_MESSAGES; sequence++ )
+    {
+        length = _messageLength( writer, sequence );
+        pHeader->writer = writer;
+        pHeader->sequence = sequence;
+
+        for( i = sizeof( _testMessage_t ); i < length; i++ )
+        {
+            pMessage[ i ] = ( uint8_t ) ( sequence + i );
+        }
+
+        do
+        {
+            if( writer == 0 )
+            {
+                sent = xMessageBufferMultiProducerSendFromISR( _buffer, pMessage, length, &higherPriorityTaskWoken );
+                portYIELD_FROM_ISR( higherPriorityTaskWoken );
+            }
+            else
+            {
+                sent = xMessageBufferMultiProducerSend( _buffer, pMessage, length );
+            }
+
+            if( sent == 0 )
+            {
+                vTaskDelay( 1 );
+            }
+        } while( sent == 0 );
+
+        if( ( writer == TEST_WRITER_COUNT - 1 ) && ( ( sequence % 4 ) == 3 ) )
+        {
+            vTaskDelay( 1 );
+        }
+    }
+
+    ( void ) xSemaphoreGive( _writersDone );
+    vTaskDelete( NULL );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for stream buffer tests.
+ */
+TEST_GROUP( Full_Kernel_Stream_Buffer );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for stream buffer tests.
+ */
+TEST_SETUP( Full_Kernel_Stream_Buffer )
+{
+    _buffer = NULL;
+    _helperLength = 0;
+
+    _helperDone = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL( _helperDone );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for stream buffer tests.
+ */
+TEST_TEAR_DOWN( Full_Kernel_Stream_Buffer )
+{
+    if( _buffer != NULL )
+    {
+        vStreamBufferDelete( _buffer );
+        _buffer = NULL;
+    }
+
+    vSemaphoreDelete( _helperDone );
+    _helperDone = NULL;
+
+    if( _writersDone != NULL )
+    {
+        vSemaphoreDelete( _writersDone );
+        _writersDone = NULL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for stream buffer tests.
+ */
+TEST_GROUP_RUNNER( Full_Kernel_Stream_Buffer )
+{
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, StreamAcquireWrap );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, StreamPartialCommit );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, StreamPartialRelease );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, StreamAcquireFreeSpace );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, MessageAcquireWrap );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, MessagePartialCommit );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, MessageAcquireNoSpace );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, CommitWakesReader );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, ReleaseWakesWriter );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, MultiProducerSize );
+    RUN_TEST_CASE( Full_Kernel_Stream_Buffer, MultiProducerLoad );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Data written and read in place from every position of the storage
+ * area, including regions that wrap around its end.
+ */
+TEST( Full_Kernel_Stream_Buffer, StreamAcquireWrap )
+{
+    StreamBufferRegion_t region = { 0 };
+    size_t start = 0;
+
+    for( start = 0; start < TEST_STORAGE_SIZE; start++ )
+    {
+        _createBuffer( pdFALSE );
+        _moveTo( start, 0 );
+
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+        _checkRegion( &region, start, TEST_DATA_LENGTH );
+        _writeRegion( &region, TEST_DATA_LENGTH, ( uint8_t ) start );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferSendCommit( _buffer, TEST_DATA_LENGTH ) );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferBytesAvailable( _buffer ) );
+
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferReceiveAcquire( _buffer, &region, 0 ) );
+        _checkRegion( &region, start, TEST_DATA_LENGTH );
+        _checkRegionData( &region, TEST_DATA_LENGTH, ( uint8_t ) start );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferReceiveRelease( _buffer, TEST_DATA_LENGTH ) );
+
+        TEST_ASSERT_EQUAL( pdTRUE, xStreamBufferIsEmpty( _buffer ) );
+
+        vStreamBufferDelete( _buffer );
+        _buffer = NULL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Committing part of the space acquired makes only that part
+ * available, and returns the rest to the buffer.
+ */
+TEST( Full_Kernel_Stream_Buffer, StreamPartialCommit )
+{
+    StreamBufferRegion_t region = { 0 };
+    uint8_t pData[ TEST_STORAGE_SIZE ] = { 0 };
+    size_t start = TEST_STORAGE_SIZE - 4;
+
+    _createBuffer( pdFALSE );
+    _moveTo( start, 0 );
+
+    /* Acquire space that wraps, and commit the part before the wrap and some
+     * of the part after it. */
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+    _writeRegion( &region, TEST_DATA_LENGTH, 0 );
+    TEST_ASSERT_EQUAL( 6, xStreamBufferSendCommit( _buffer, 6 ) );
+
+    TEST_ASSERT_EQUAL( 6, xStreamBufferBytesAvailable( _buffer ) );
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1 - 6, xStreamBufferSpacesAvailable( _buffer ) );
+
+    /* The next space acquired follows the committed bytes. */
+    TEST_ASSERT_EQUAL( 4, xStreamBufferSendAcquire( _buffer, 4, &region, 0 ) );
+    _checkRegion( &region, start + 6, 4 );
+    _writeRegion( &region, 4, 6 );
+    TEST_ASSERT_EQUAL( 4, xStreamBufferSendCommit( _buffer, 4 ) );
+
+    /* Committing nothing writes nothing. */
+    TEST_ASSERT_EQUAL( 4, xStreamBufferSendAcquire( _buffer, 4, &region, 0 ) );
+    TEST_ASSERT_EQUAL( 0, xStreamBufferSendCommit( _buffer, 0 ) );
+
+    TEST_ASSERT_EQUAL( 10, xStreamBufferReceive( _buffer, pData, sizeof( pData ), 0 ) );
+
+    for( start = 0; start < 10; start++ )
+    {
+        TEST_ASSERT_EQUAL_UINT8( start, pData[ start ] );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Releasing part of the data acquired leaves the rest in place, to be
+ * acquired again.
+ */
+TEST( Full_Kernel_Stream_Buffer, StreamPartialRelease )
+{
+    StreamBufferRegion_t region = { 0 };
+    uint8_t pData[ TEST_DATA_LENGTH ] = { 0 };
+    size_t start = TEST_STORAGE_SIZE - 4;
+
+    _createBuffer( pdFALSE );
+    _moveTo( start, 0 );
+
+    for( start = 0; start < TEST_DATA_LENGTH; start++ )
+    {
+        pData[ start ] = ( uint8_t ) start;
+    }
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferSend( _buffer, pData, TEST_DATA_LENGTH, 0 ) );
+
+    /* Release the part before the wrap and one byte more. */
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferReceiveAcquire( _buffer, &region, 0 ) );
+    _checkRegion( &region, TEST_STORAGE_SIZE - 4, TEST_DATA_LENGTH );
+    TEST_ASSERT_EQUAL( 5, xStreamBufferReceiveRelease( _buffer, 5 ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH - 5, xStreamBufferBytesAvailable( _buffer ) );
+
+    /* The rest no longer wraps. */
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH - 5, xStreamBufferReceiveAcquire( _buffer, &region, 0 ) );
+    _checkRegion( &region, 1, TEST_DATA_LENGTH - 5 );
+    _checkRegionData( &region, TEST_DATA_LENGTH - 5, 5 );
+
+    /* Releasing nothing leaves the buffer unchanged. */
+    TEST_ASSERT_EQUAL( 0, xStreamBufferReceiveRelease( _buffer, 0 ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH - 5, xStreamBufferBytesAvailable( _buffer ) );
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH - 5, xStreamBufferReceiveRelease( _buffer, TEST_DATA_LENGTH - 5 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xStreamBufferIsEmpty( _buffer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A stream buffer hands out as much of the space asked for as is
+ * free.
+ */
+TEST( Full_Kernel_Stream_Buffer, StreamAcquireFreeSpace )
+{
+    StreamBufferRegion_t region = { 0 };
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    _createBuffer( pdFALSE );
+    _moveTo( 10, 0 );
+
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1, xStreamBufferSendAcquireFromISR( _buffer, 2 * TEST_STORAGE_SIZE, &region ) );
+    _checkRegion( &region, 10, TEST_STORAGE_SIZE - 1 );
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1, xStreamBufferSendCommitFromISR( _buffer, TEST_STORAGE_SIZE - 1, &higherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xStreamBufferIsFull( _buffer ) );
+
+    /* Nothing is free, and nothing was waiting. */
+    TEST_ASSERT_EQUAL( 0, xStreamBufferSendAcquire( _buffer, 1, &region, 0 ) );
+    TEST_ASSERT_EQUAL( pdFALSE, higherPriorityTaskWoken );
+
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1, xStreamBufferReceiveAcquireFromISR( _buffer, &region ) );
+    _checkRegion( &region, 10, TEST_STORAGE_SIZE - 1 );
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1, xStreamBufferReceiveReleaseFromISR( _buffer, TEST_STORAGE_SIZE - 1, &higherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL( pdFALSE, higherPriorityTaskWoken );
+
+    TEST_ASSERT_EQUAL( 0, xStreamBufferReceiveAcquireFromISR( _buffer, &region ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Messages written and read in place from every position of the
+ * storage area, including records whose length or data wrap around its end.
+ */
+TEST( Full_Kernel_Stream_Buffer, MessageAcquireWrap )
+{
+    StreamBufferRegion_t region = { 0 };
+    uint8_t pData[ TEST_DATA_LENGTH ] = { 0 };
+    size_t start = 0, i = 0;
+
+    for( start = 0; start < TEST_STORAGE_SIZE; start++ )
+    {
+        _createBuffer( pdTRUE );
+        _moveTo( start, TEST_LENGTH_BYTES );
+
+        /* The space handed out follows the length of the message. */
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+        _checkRegion( &region, start + TEST_LENGTH_BYTES, TEST_DATA_LENGTH );
+        _writeRegion( &region, TEST_DATA_LENGTH, ( uint8_t ) start );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendCommit( _buffer, TEST_DATA_LENGTH ) );
+
+        /* The record reads back whole, in place and by copy. */
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferNextMessageLengthBytes( _buffer ) );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferReceiveAcquire( _buffer, &region, 0 ) );
+        _checkRegion( &region, start + TEST_LENGTH_BYTES, TEST_DATA_LENGTH );
+        _checkRegionData( &region, TEST_DATA_LENGTH, ( uint8_t ) start );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferReceiveRelease( _buffer, TEST_DATA_LENGTH ) );
+        TEST_ASSERT_EQUAL( pdTRUE, xMessageBufferIsEmpty( _buffer ) );
+
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+        _writeRegion( &region, TEST_DATA_LENGTH, ( uint8_t ) start );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendCommit( _buffer, TEST_DATA_LENGTH ) );
+        TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferReceive( _buffer, pData, sizeof( pData ), 0 ) );
+
+        for( i = 0; i < TEST_DATA_LENGTH; i++ )
+        {
+            TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) ( start + i ), pData[ i ] );
+        }
+
+        vMessageBufferDelete( _buffer );
+        _buffer = NULL;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Committing a message shorter than the space acquired records the
+ * length committed, and returns the rest of the space to the buffer.
+ */
+TEST( Full_Kernel_Stream_Buffer, MessagePartialCommit )
+{
+    StreamBufferRegion_t region = { 0 };
+    size_t start = TEST_STORAGE_SIZE - TEST_LENGTH_BYTES - 2;
+
+    _createBuffer( pdTRUE );
+    _moveTo( start, TEST_LENGTH_BYTES );
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+    _checkRegion( &region, start + TEST_LENGTH_BYTES, TEST_DATA_LENGTH );
+    _writeRegion( &region, TEST_DATA_LENGTH, 0 );
+    TEST_ASSERT_EQUAL( 5, xMessageBufferSendCommit( _buffer, 5 ) );
+
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1 - TEST_LENGTH_BYTES - 5, xStreamBufferSpacesAvailable( _buffer ) );
+
+    /* The next message follows the 5 bytes committed. */
+    TEST_ASSERT_EQUAL( 3, xMessageBufferSendAcquire( _buffer, 3, &region, 0 ) );
+    _checkRegion( &region, start + 2 * TEST_LENGTH_BYTES + 5, 3 );
+    _writeRegion( &region, 3, 100 );
+    TEST_ASSERT_EQUAL( 3, xMessageBufferSendCommit( _buffer, 3 ) );
+
+    TEST_ASSERT_EQUAL( 5, xMessageBufferReceiveAcquire( _buffer, &region, 0 ) );
+    _checkRegion( &region, start + TEST_LENGTH_BYTES, 5 );
+    _checkRegionData( &region, 5, 0 );
+    TEST_ASSERT_EQUAL( 5, xMessageBufferReceiveRelease( _buffer, 5 ) );
+
+    TEST_ASSERT_EQUAL( 3, xMessageBufferReceiveAcquire( _buffer, &region, 0 ) );
+    _checkRegionData( &region, 3, 100 );
+    TEST_ASSERT_EQUAL( 3, xMessageBufferReceiveRelease( _buffer, 3 ) );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xMessageBufferIsEmpty( _buffer ) );
+    TEST_ASSERT_EQUAL( 0, xMessageBufferReceiveAcquire( _buffer, &region, 0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A message buffer hands out space for the whole message, or nothing.
+ */
+TEST( Full_Kernel_Stream_Buffer, MessageAcquireNoSpace )
+{
+    StreamBufferRegion_t region = { 0 };
+    TickType_t start = 0;
+
+    _createBuffer( pdTRUE );
+
+    /* Too large to ever fit. */
+    TEST_ASSERT_EQUAL( 0, xMessageBufferSendAcquire( _buffer, TEST_STORAGE_SIZE - TEST_LENGTH_BYTES, &region, 0 ) );
+    TEST_ASSERT_EQUAL( 0, region.xFirstLengthBytes );
+
+    /* Fill part of the buffer, then wait for more space than is left. */
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xMessageBufferSendCommit( _buffer, TEST_DATA_LENGTH ) );
+
+    start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( 0, xMessageBufferSendAcquire( _buffer, TEST_STORAGE_SIZE - 2 * TEST_LENGTH_BYTES - TEST_DATA_LENGTH, &region, 5 ) );
+    TEST_ASSERT_TRUE( xTaskGetTickCount() - start >= 5 );
+    TEST_ASSERT_EQUAL( 0, xMessageBufferSendAcquireFromISR( _buffer, TEST_STORAGE_SIZE - 2 * TEST_LENGTH_BYTES - TEST_DATA_LENGTH, &region ) );
+
+    /* The largest message that fits. */
+    TEST_ASSERT_EQUAL( TEST_STORAGE_SIZE - 1 - 2 * TEST_LENGTH_BYTES - TEST_DATA_LENGTH,
+                       xMessageBufferSendAcquire( _buffer, TEST_STORAGE_SIZE - 1 - 2 * TEST_LENGTH_BYTES - TEST_DATA_LENGTH, &region, 0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Committing data wakes a higher priority reader blocked waiting to
+ * acquire it.
+ */
+TEST( Full_Kernel_Stream_Buffer, CommitWakesReader )
+{
+    StreamBufferRegion_t region = { 0 };
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+
+    _createBuffer( pdFALSE );
+
+    /* From a task. The reader runs first, and blocks. */
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _receiveAcquireTask,
+                                            "AcquireReader",
+                                            TEST_TASK_STACK_SIZE,
+                                            NULL,
+                                            uxTaskPriorityGet( NULL ) + 1,
+                                            NULL ) );
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferSendAcquire( _buffer, TEST_DATA_LENGTH, &region, 0 ) );
+    TEST_ASSERT_EQUAL( 4, xStreamBufferSendCommit( _buffer, 4 ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+    TEST_ASSERT_EQUAL( 4, _helperLength );
+
+    /* From an interrupt. */
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _receiveAcquireTask,
+                                            "AcquireReader",
+                                            TEST_TASK_STACK_SIZE,
+                                            NULL,
+                                            uxTaskPriorityGet( NULL ) + 1,
+                                            NULL ) );
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH, xStreamBufferSendAcquireFromISR( _buffer, TEST_DATA_LENGTH, &region ) );
+    TEST_ASSERT_EQUAL( 7, xStreamBufferSendCommitFromISR( _buffer, 7, &higherPriorityTaskWoken ) );
+    TEST_ASSERT_EQUAL( pdTRUE, higherPriorityTaskWoken );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+    TEST_ASSERT_EQUAL( 7, _helperLength );
+
+    TEST_ASSERT_EQUAL( pdTRUE, xStreamBufferIsEmpty( _buffer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Releasing data wakes a writer blocked waiting to acquire space.
+ */
+TEST( Full_Kernel_Stream_Buffer, ReleaseWakesWriter )
+{
+    StreamBufferRegion_t region = { 0 };
+
+    _createBuffer( pdTRUE );
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH * 2, xMessageBufferSendAcquire( _buffer, TEST_DATA_LENGTH * 2, &region, 0 ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH * 2, xMessageBufferSendCommit( _buffer, TEST_DATA_LENGTH * 2 ) );
+
+    TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _delayedReleaseTask,
+                                            "DelayedRelease",
+                                            TEST_TASK_STACK_SIZE,
+                                            NULL,
+                                            uxTaskPriorityGet( NULL ),
+                                            NULL ) );
+
+    /* Blocks until the helper releases the first message. */
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH * 2, xMessageBufferSendAcquire( _buffer, TEST_DATA_LENGTH * 2, &region, TEST_TIMEOUT_TICKS ) );
+    TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _helperDone, TEST_TIMEOUT_TICKS ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH * 2, _helperLength );
+
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH * 2, xMessageBufferSendCommit( _buffer, TEST_DATA_LENGTH * 2 ) );
+    TEST_ASSERT_EQUAL( TEST_DATA_LENGTH * 2, xStreamBufferNextMessageLengthBytes( _buffer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief A multi-producer message buffer uses the largest power of two bytes
+ * of its storage area, and messages that do not fit before its end are
+ * preceded by padding.
+ */
+TEST( Full_Kernel_Stream_Buffer, MultiProducerSize )
+{
+    static uint32_t pStorage[ ( TEST_MULTI_PRODUCER_SIZE + 100 ) / sizeof( uint32_t ) ];
+    uint8_t pMessage[ TEST_MESSAGE_MAX_LENGTH ] = { 0 };
+    size_t i = 0;
+
+    _buffer = ( StreamBufferHandle_t ) xMessageBufferCreateMultiProducerStatic( sizeof( pStorage ),
+                                                                                ( uint8_t * ) pStorage,
+                                                                                &_staticBuffer );
+    TEST_ASSERT_NOT_NULL( _buffer );
+    TEST_ASSERT_EQUAL( TEST_MULTI_PRODUCER_SIZE, xMessageBufferSpaceAvailable( _buffer ) );
+
+    /* Send and receive enough messages of a length that is not a divisor of
+     * the storage size for the records to wrap several times. */
+    for( i = 0; i < 4 * TEST_MULTI_PRODUCER_SIZE / 24; i++ )
+    {
+        pMessage[ 0 ] = ( uint8_t ) i;
+        TEST_ASSERT_EQUAL( 13, xMessageBufferMultiProducerSend( _buffer, pMessage, 13 ) );
+        TEST_ASSERT_EQUAL( 13, xMessageBufferMultiProducerSend( _buffer, pMessage, 13 ) );
+
+        TEST_ASSERT_EQUAL( 13, xMessageBufferMultiProducerReceive( _buffer, pMessage, sizeof( pMessage ), 0 ) );
+        TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) i, pMessage[ 0 ] );
+        TEST_ASSERT_EQUAL( 13, xMessageBufferMultiProducerReceive( _buffer, pMessage, sizeof( pMessage ), 0 ) );
+        TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) i, pMessage[ 0 ] );
+    }
+
+    TEST_ASSERT_EQUAL( pdTRUE, xMessageBufferIsEmpty( _buffer ) );
+    TEST_ASSERT_EQUAL( TEST_MULTI_PRODUCER_SIZE, xMessageBufferSpaceAvailable( _buffer ) );
+
+    /* Fill the buffer, which takes no more. */
+    while( xMessageBufferMultiProducerSend( _buffer, pMessage, 1 ) == 1 )
+    {
+    }
+
+    TEST_ASSERT_EQUAL( pdTRUE, xMessageBufferIsFull( _buffer ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Tasks that send to a multi-producer message buffer at the same time,
+ * while it is often full, reserve records concurrently. Every message is
+ * received whole and in order.
+ */
+TEST( Full_Kernel_Stream_Buffer, MultiProducerLoad )
+{
+    uint32_t pNextSequence[ TEST_WRITER_COUNT ] = { 0 };
+    uint8_t pMessage[ TEST_MESSAGE_MAX_LENGTH ] = { 0 };
+    const _testMessage_t * pHeader = ( const _testMessage_t * ) pMessage;
+    uint32_t writer = 0, received = 0;
+    size_t length = 0, i = 0;
+
+    _writersDone = xSemaphoreCreateCounting( TEST_WRITER_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( _writersDone );
+
+    _buffer = ( StreamBufferHandle_t ) xMessageBufferCreateMultiProducer( TEST_MULTI_PRODUCER_SIZE );
+    TEST_ASSERT_NOT_NULL( _buffer );
+
+    for( writer = 0; writer < TEST_WRITER_COUNT; writer++ )
+    {
+        TEST_ASSERT_EQUAL( pdPASS, xTaskCreate( _multiProducerWriterTask,
+                                                "MultiProducer",
+                                                TEST_TASK_STACK_SIZE,
+                                                ( void * ) ( uintptr_t ) writer,
+                                                uxTaskPriorityGet( NULL ) + ( ( writer == TEST_WRITER_COUNT - 1 ) ? 1 : 0 ),
+                                                NULL ) );
+    }
+
+    while( received < TEST_WRITER_COUNT * TEST_WRITER_MESSAGES )
+    {
+        length = xMessageBufferMultiProducerReceive( _buffer, pMessage, sizeof( pMessage ), TEST_TIMEOUT_TICKS );
+        TEST_ASSERT_GREATER_THAN( 0, length );
+
+        /* Each message is whole, and follows the previous one of its writer. */
+        TEST_ASSERT_LESS_THAN_UINT32( TEST_WRITER_COUNT, pHeader->writer );
+        TEST_ASSERT_EQUAL_UINT32( pNextSequence[ pHeader->writer ], pHeader->sequence );
+        TEST_ASSERT_EQUAL( _messageLength( pHeader->writer, pHeader->sequence ), length );
+
+        for( i = sizeof( _testMessage_t ); i < length; i++ )
+        {
+            TEST_ASSERT_EQUAL_UINT8( ( uint8_t ) ( pHeader->sequence + i ), pMessage[ i ] );
+        }
+
+        pNextSequence[ pHeader->writer ]++;
+        received++;
+    }
+
+    for( writer = 0; writer < TEST_WRITER_COUNT; writer++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _writersDone, TEST_TIMEOUT_TICKS ) );
+    }
+
+    vSemaphoreDelete( _writersDone );
+    _writersDone = NULL;
+
+    TEST_ASSERT_EQUAL( pdTRUE, xMessageBufferIsEmpty( _buffer ) );
+    TEST_ASSERT_EQUAL( TEST_MULTI_PRODUCER_SIZE, xMessageBufferSpaceAvailable( _buffer ) );
+}
+
+/*-----------------------------------------------------------*/
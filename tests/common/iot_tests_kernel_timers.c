@@ -0,0 +1,602 @@
+/*
+ * Amazon FreeRTOS V201906.00 Major
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+/**
+ * @file iot_tests_kernel_timers.c
+ * @brief Tests for the active timers of the timer service task, and for the
+ * timing wheel that holds them when configUSE_TIMER_WHEEL is 1.
+ */
+
+/* The config header is always included first. */
+#include "iot_config.h"
+
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "semphr.h"
+
+/* Test framework includes. */
+#include "unity_fixture.h"
+
+/*-----------------------------------------------------------*/
+
+/*
+ * The timing wheel cannot be moved to an arbitrary tick count through the
+ * timer service task, so the timers module is compiled into this test with its
+ * public functions renamed.  The tests drive the timing wheel of this copy
+ * directly, without its timer service task.  The names are restored after the
+ * include, so the other tests use the timer service task of the kernel.
+ */
+#define xTimerCreateTimerTask                 xTestTimerCreateTimerTask
+#define xTimerCreate                          xTestTimerCreate
+#define xTimerCreateStatic                    xTestTimerCreateStatic
+#define xTimerGenericCommand                  xTestTimerGenericCommand
+#define xTimerGetTimerDaemonTaskHandle        xTestTimerGetTimerDaemonTaskHandle
+#define xTimerGetPeriod                       xTestTimerGetPeriod
+#define vTimerSetReloadMode                   vTestTimerSetReloadMode
+#define xTimerGetExpiryTime                   xTestTimerGetExpiryTime
+#define pcTimerGetName                        pcTestTimerGetName
+#define xTimerIsTimerActive                   xTestTimerIsTimerActive
+#define pvTimerGetTimerID                     pvTestTimerGetTimerID
+#define vTimerSetTimerID                      vTestTimerSetTimerID
+#define xTimerPendFunctionCallFromISR         xTestTimerPendFunctionCallFromISR
+#define xTimerPendFunctionCall                xTestTimerPendFunctionCall
+#define uxTimerGetTimerNumber                 uxTestTimerGetTimerNumber
+#define vTimerSetTimerNumber                  vTestTimerSetTimerNumber
+
+#include "../../freertos_kernel/timers.c"
+
+#undef xTimerCreateTimerTask
+#undef xTimerCreate
+#undef xTimerCreateStatic
+#undef xTimerGenericCommand
+#undef xTimerGetTimerDaemonTaskHandle
+#undef xTimerGetPeriod
+#undef vTimerSetReloadMode
+#undef xTimerGetExpiryTime
+#undef pcTimerGetName
+#undef xTimerIsTimerActive
+#undef pvTimerGetTimerID
+#undef vTimerSetTimerID
+#undef xTimerPendFunctionCallFromISR
+#undef xTimerPendFunctionCall
+#undef uxTimerGetTimerNumber
+#undef vTimerSetTimerNumber
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The most timers used by a test.
+ */
+#define TEST_TIMER_COUNT           ( 16 )
+
+/**
+ * @brief Ticks a timer of the timer service task may expire late by.
+ */
+#define TEST_LATENESS_TICKS        ( 3 )
+
+/**
+ * @brief Ticks to wait for the timers of a test, beyond their period.
+ */
+#define TEST_TIMEOUT_TICKS         ( pdMS_TO_TICKS( 2000 ) )
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The timers of the timer service task used by a test.
+ */
+static TimerHandle_t _pTimers[ TEST_TIMER_COUNT ];
+
+/**
+ * @brief The tick count each timer was started at.
+ */
+static TickType_t _pStartTimes[ TEST_TIMER_COUNT ];
+
+/**
+ * @brief The IDs of the timers, in the order they expired.
+ */
+static uint32_t _pExpiredIds[ TEST_TIMER_COUNT ];
+
+/**
+ * @brief The times the timers expired at, in the order they expired.
+ */
+static TickType_t _pExpiredTimes[ TEST_TIMER_COUNT ];
+
+/**
+ * @brief The number of times timers expired.
+ */
+static volatile UBaseType_t _expiredCount = 0;
+
+/**
+ * @brief Given each time a timer expires.
+ */
+static SemaphoreHandle_t _timerExpired = NULL;
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Record the timer expiring at a time.
+ */
+static void _recordExpiry( TimerHandle_t timer,
+                           TickType_t time )
+{
+    if( _expiredCount < TEST_TIMER_COUNT )
+    {
+        _pExpiredIds[ _expiredCount ] = ( uint32_t ) ( uintptr_t ) pvTimerGetTimerID( timer );
+        _pExpiredTimes[ _expiredCount ] = time;
+    }
+
+    _expiredCount++;
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Callback of the timers of the timer service task.
+ */
+static void _timerCallback( TimerHandle_t timer )
+{
+    _recordExpiry( timer, xTaskGetTickCount() );
+    ( void ) xSemaphoreGive( _timerExpired );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Create a one shot timer of the timer service task.
+ */
+static void _createTimer( uint32_t id,
+                          TickType_t period )
+{
+    _pTimers[ id ] = xTimerCreate( "TestTimer",
+                                   period,
+                                   pdFALSE,
+                                   ( void * ) ( uintptr_t ) id,
+                                   _timerCallback );
+    TEST_ASSERT_NOT_NULL( _pTimers[ id ] );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start a timer of the timer service task, and note when.
+ */
+static void _startTimer( uint32_t id )
+{
+    _pStartTimes[ id ] = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( pdPASS, xTimerStart( _pTimers[ id ], 0 ) );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Wait for a number of timers to expire, then check they expired in the
+ * order of their IDs, neither early nor later than the timer service task can
+ * be expected to run.
+ */
+static void _checkExpiredInOrder( UBaseType_t count )
+{
+    UBaseType_t i = 0;
+    uint32_t id = 0;
+    TickType_t expiryTime = 0;
+
+    for( i = 0; i < count; i++ )
+    {
+        TEST_ASSERT_EQUAL( pdTRUE, xSemaphoreTake( _timerExpired, xTimerGetPeriod( _pTimers[ i ] ) + TEST_TIMEOUT_TICKS ) );
+    }
+
+    TEST_ASSERT_EQUAL( count, _expiredCount );
+
+    for( i = 0; i < count; i++ )
+    {
+        id = _pExpiredIds[ i ];
+        TEST_ASSERT_EQUAL_UINT32( i, id );
+
+        expiryTime = _pStartTimes[ id ] + xTimerGetPeriod( _pTimers[ id ] );
+        TEST_ASSERT_TRUE( ( TickType_t ) ( _pExpiredTimes[ i ] - _pStartTimes[ id ] ) >= xTimerGetPeriod( _pTimers[ id ] ) );
+        TEST_ASSERT_TRUE( ( TickType_t ) ( _pExpiredTimes[ i ] - expiryTime ) <= TEST_LATENESS_TICKS );
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+/**
+ * @brief The timers of the copy of the timers module used by a test.
+ */
+    static Timer_t _pWheelTimers[ TEST_TIMER_COUNT ];
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Callback of the timers of the copy of the timers module.
+ */
+    static void _wheelCallback( TimerHandle_t timer )
+    {
+        /* The wheel has just reached the expiry time of the timer. */
+        _recordExpiry( timer, xWheelTime );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Empty the timing wheel of the copy of the timers module.
+ */
+    static void _resetWheel( TickType_t time )
+    {
+        prvInitialiseTimerWheel();
+        xWheelTime = time;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Start a timer of the copy of the timers module at a time.
+ */
+    static void _startWheelTimer( uint32_t id,
+                                  TickType_t period,
+                                  BaseType_t autoReload,
+                                  TickType_t time )
+    {
+        Timer_t * pTimer = &( _pWheelTimers[ id ] );
+
+        ( void ) memset( pTimer, 0x00, sizeof( Timer_t ) );
+        pTimer->pcTimerName = "WheelTimer";
+        pTimer->xTimerPeriodInTicks = period;
+        pTimer->pvTimerID = ( void * ) ( uintptr_t ) id;
+        pTimer->pxCallbackFunction = _wheelCallback;
+        pTimer->ucStatus = ( uint8_t ) ( tmrSTATUS_IS_STATICALLY_ALLOCATED | tmrSTATUS_IS_ACTIVE );
+
+        if( autoReload != pdFALSE )
+        {
+            pTimer->ucStatus |= tmrSTATUS_IS_AUTORELOAD;
+        }
+
+        vListInitialiseItem( &( pTimer->xTimerListItem ) );
+
+        TEST_ASSERT_EQUAL( pdFALSE, prvInsertTimerInActiveList( pTimer, time + period, time, time ) );
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Run the timing wheel as the timer service task would, if the tick
+ * count jumped to each time it waits for, up to and including a time.
+ *
+ * @return The number of slots the wheel reached, cascaded or expired.
+ */
+    static UBaseType_t _runWheel( TickType_t endTime )
+    {
+        UBaseType_t slotCount = 0;
+        BaseType_t listWasEmpty = pdTRUE;
+        TickType_t nextExpireTime = 0;
+
+        for( ; ; )
+        {
+            nextExpireTime = prvGetNextExpireTime( &listWasEmpty );
+
+            if( ( listWasEmpty != pdFALSE ) ||
+                ( ( TickType_t ) ( nextExpireTime - xWheelTime ) > ( TickType_t ) ( endTime - xWheelTime ) ) )
+            {
+                break;
+            }
+
+            prvAdvanceTimerWheel( nextExpireTime, nextExpireTime );
+            slotCount++;
+        }
+
+        return slotCount;
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief The level of the timing wheel that holds a timer.
+ */
+    static UBaseType_t _wheelLevel( uint32_t id )
+    {
+        List_t * pList = ( List_t * ) listLIST_ITEM_CONTAINER( &( _pWheelTimers[ id ].xTimerListItem ) );
+
+        TEST_ASSERT_NOT_NULL( pList );
+
+        return tmrWHEEL_LEVEL_OF( pList );
+    }
+
+#endif /* if ( configUSE_TIMER_WHEEL == 1 ) */
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group for timer tests.
+ */
+TEST_GROUP( Full_Kernel_Timers );
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test setup for timer tests.
+ */
+TEST_SETUP( Full_Kernel_Timers )
+{
+    ( void ) memset( _pTimers, 0x00, sizeof( _pTimers ) );
+    _expiredCount = 0;
+
+    _timerExpired = xSemaphoreCreateCounting( TEST_TIMER_COUNT, 0 );
+    TEST_ASSERT_NOT_NULL( _timerExpired );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test tear down for timer tests.
+ */
+TEST_TEAR_DOWN( Full_Kernel_Timers )
+{
+    uint32_t id = 0;
+
+    for( id = 0; id < TEST_TIMER_COUNT; id++ )
+    {
+        if( _pTimers[ id ] != NULL )
+        {
+            ( void ) xTimerDelete( _pTimers[ id ], portMAX_DELAY );
+            _pTimers[ id ] = NULL;
+        }
+    }
+
+    /* Let the timer service task delete the timers before the semaphore. */
+    vTaskDelay( 2 );
+    vSemaphoreDelete( _timerExpired );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Test group runner for timer tests.
+ */
+TEST_GROUP_RUNNER( Full_Kernel_Timers )
+{
+    RUN_TEST_CASE( Full_Kernel_Timers, ExpireInOrder );
+    RUN_TEST_CASE( Full_Kernel_Timers, StopAndChangePeriod );
+
+    #if ( configUSE_TIMER_WHEEL == 1 )
+        RUN_TEST_CASE( Full_Kernel_Timers, WheelCascade );
+        RUN_TEST_CASE( Full_Kernel_Timers, WheelNextExpireWrap );
+        RUN_TEST_CASE( Full_Kernel_Timers, WheelAutoReloadWrap );
+    #endif
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Timers with periods that span several levels of the timing wheel
+ * expire in order, at their expiry time.
+ */
+TEST( Full_Kernel_Timers, ExpireInOrder )
+{
+    static const TickType_t pPeriods[] = { 2, 17, 40, 300, 1100, 4200 };
+    const UBaseType_t count = sizeof( pPeriods ) / sizeof( pPeriods[ 0 ] );
+    uint32_t id = 0;
+
+    for( id = 0; id < count; id++ )
+    {
+        _createTimer( id, pdMS_TO_TICKS( pPeriods[ id ] ) );
+    }
+
+    /* Start the longest timers first, so the shorter ones are placed in a
+     * wheel that already holds timers. */
+    for( id = count; id > 0; id-- )
+    {
+        _startTimer( id - 1 );
+    }
+
+    _checkExpiredInOrder( count );
+}
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Timers stopped or given a new period while in a higher level of the
+ * timing wheel do not expire at their old time.
+ */
+TEST( Full_Kernel_Timers, StopAndChangePeriod )
+{
+    uint32_t id = 0;
+
+    _createTimer( 0, pdMS_TO_TICKS( 600 ) );
+    _createTimer( 1, pdMS_TO_TICKS( 300 ) );
+    _createTimer( 2, pdMS_TO_TICKS( 1100 ) );
+
+    for( id = 0; id < 3; id++ )
+    {
+        _startTimer( id );
+    }
+
+    vTaskDelay( pdMS_TO_TICKS( 100 ) );
+
+    /* Timer 0 is now due before timer 1, and timer 2 never expires. */
+    _pStartTimes[ 0 ] = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL( pdPASS, xTimerChangePeriod( _pTimers[ 0 ], pdMS_TO_TICKS( 50 ), 0 ) );
+    TEST_ASSERT_EQUAL( pdPASS, xTimerStop( _pTimers[ 2 ], 0 ) );
+
+    _checkExpiredInOrder( 2 );
+
+    vTaskDelay( pdMS_TO_TICKS( 1100 ) );
+    TEST_ASSERT_EQUAL( 2, _expiredCount );
+    TEST_ASSERT_EQUAL( pdFALSE, xTimerIsTimerActive( _pTimers[ 2 ] ) );
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TIMER_WHEEL == 1 )
+
+/**
+ * @brief Timers placed in every level of the timing wheel are moved down
+ * level by level, and each expires exactly at its expiry time.
+ */
+    TEST( Full_Kernel_Timers, WheelCascade )
+    {
+        static const TickType_t pPeriods[] =
+        {
+            1, 15, 16, 17, 255, 256, 257, 4095, 4097, 65537, 0x00100003UL, 0x01000005UL, 0x10000007UL
+        };
+        const UBaseType_t count = sizeof( pPeriods ) / sizeof( pPeriods[ 0 ] );
+        const TickType_t startTime = 0x12345678UL;
+        uint32_t id = 0;
+
+        _resetWheel( startTime );
+
+        for( id = count; id > 0; id-- )
+        {
+            _startWheelTimer( id - 1, pPeriods[ id - 1 ], pdFALSE, startTime );
+        }
+
+        /* The longest timers start in higher levels. */
+        TEST_ASSERT_EQUAL( 0, _wheelLevel( 0 ) );
+        TEST_ASSERT_TRUE( _wheelLevel( count - 1 ) > _wheelLevel( count - 4 ) );
+        TEST_ASSERT_TRUE( _wheelLevel( count - 4 ) > 0 );
+
+        /* More slots are reached than timers expire, as timers cascade. */
+        TEST_ASSERT_TRUE( _runWheel( startTime + pPeriods[ count - 1 ] ) > count );
+        TEST_ASSERT_EQUAL( count, _expiredCount );
+
+        for( id = 0; id < count; id++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( id, _pExpiredIds[ id ] );
+            TEST_ASSERT_EQUAL_UINT32( startTime + pPeriods[ id ], _pExpiredTimes[ id ] );
+        }
+
+        /* The wheel is empty. */
+        for( id = 0; id < tmrWHEEL_LEVELS; id++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( 0, ulWheelOccupied[ id ] );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief Timers that expire after the tick count overflows are found by
+ * wrapping the search of the top level of the timing wheel round to its first
+ * slot.
+ */
+    TEST( Full_Kernel_Timers, WheelNextExpireWrap )
+    {
+        static const TickType_t pPeriods[] = { 5, 0x40, 0x100, 0x123, 0x10000 };
+        const UBaseType_t count = sizeof( pPeriods ) / sizeof( pPeriods[ 0 ] );
+        const TickType_t startTime = 0xffffff00UL;
+        const TickType_t farStartTime = 0xa0000000UL, farPeriod = 0x70000005UL;
+        const TickType_t topSlotMask = ~( ( ( TickType_t ) 1 << ( ( tmrWHEEL_LEVELS - 1 ) * tmrWHEEL_SLOT_BITS ) ) - ( TickType_t ) 1 );
+        BaseType_t listWasEmpty = pdTRUE;
+        uint32_t id = 0;
+
+        /* A timer due after the overflow, alone in the wheel, is in the top
+         * level, in a slot before the one the wheel is in. */
+        _resetWheel( startTime );
+        _startWheelTimer( 0, 0x200, pdFALSE, startTime );
+        TEST_ASSERT_EQUAL( tmrWHEEL_LEVELS - 1, _wheelLevel( 0 ) );
+
+        /* The next event is the start of the first slot of the top level,
+         * when the tick count overflows. */
+        TEST_ASSERT_EQUAL_UINT32( 0, prvGetNextExpireTime( &listWasEmpty ) );
+        TEST_ASSERT_EQUAL( pdFALSE, listWasEmpty );
+        TEST_ASSERT_EQUAL_PTR( &( xTimerWheel[ tmrWHEEL_LEVELS - 1 ][ 0 ] ), pxCurrentTimerList );
+
+        ( void ) _runWheel( startTime + 0x200 );
+        TEST_ASSERT_EQUAL( 1, _expiredCount );
+        TEST_ASSERT_EQUAL_UINT32( startTime + 0x200, _pExpiredTimes[ 0 ] );
+
+        /* A timer due more than half the tick range away is also in a slot of
+         * the top level before the one the wheel is in, so the search of the
+         * top level starts part way through and wraps past its last slot. */
+        _expiredCount = 0;
+        _resetWheel( farStartTime );
+        _startWheelTimer( 0, farPeriod, pdFALSE, farStartTime );
+        TEST_ASSERT_EQUAL( tmrWHEEL_LEVELS - 1, _wheelLevel( 0 ) );
+
+        TEST_ASSERT_EQUAL_UINT32( ( farStartTime + farPeriod ) & topSlotMask, prvGetNextExpireTime( &listWasEmpty ) );
+        TEST_ASSERT_EQUAL( pdFALSE, listWasEmpty );
+
+        ( void ) _runWheel( farStartTime + farPeriod );
+        TEST_ASSERT_EQUAL( 1, _expiredCount );
+        TEST_ASSERT_EQUAL_UINT32( farStartTime + farPeriod, _pExpiredTimes[ 0 ] );
+
+        /* Timers due before and after the overflow expire in order. */
+        _expiredCount = 0;
+        _resetWheel( startTime );
+
+        for( id = 0; id < count; id++ )
+        {
+            _startWheelTimer( id, pPeriods[ id ], pdFALSE, startTime );
+        }
+
+        TEST_ASSERT_EQUAL_UINT32( startTime + pPeriods[ 0 ], prvGetNextExpireTime( &listWasEmpty ) );
+
+        ( void ) _runWheel( startTime + pPeriods[ count - 1 ] );
+        TEST_ASSERT_EQUAL( count, _expiredCount );
+
+        for( id = 0; id < count; id++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( id, _pExpiredIds[ id ] );
+            TEST_ASSERT_EQUAL_UINT32( startTime + pPeriods[ id ], _pExpiredTimes[ id ] );
+        }
+    }
+
+/*-----------------------------------------------------------*/
+
+/**
+ * @brief An auto reload timer is placed back in the timing wheel relative to
+ * its expiry time, so it expires every period while the tick count overflows.
+ */
+    TEST( Full_Kernel_Timers, WheelAutoReloadWrap )
+    {
+        const TickType_t period = 37, startTime = 0xffffff80UL;
+        UBaseType_t i = 0;
+
+        _resetWheel( startTime );
+        _startWheelTimer( 0, period, pdTRUE, startTime );
+
+        ( void ) _runWheel( startTime + ( TEST_TIMER_COUNT * period ) );
+        TEST_ASSERT_EQUAL( TEST_TIMER_COUNT, _expiredCount );
+
+        for( i = 0; i < TEST_TIMER_COUNT; i++ )
+        {
+            TEST_ASSERT_EQUAL_UINT32( startTime + ( ( i + 1 ) * period ), _pExpiredTimes[ i ] );
+        }
+
+        /* The timer is still active, due one period after the last expiry. */
+        TEST_ASSERT_EQUAL_UINT32( startTime + ( ( TEST_TIMER_COUNT + 1 ) * period ),
+                                  listGET_LIST_ITEM_VALUE( &( _pWheelTimers[ 0 ].xTimerListItem ) ) );
+        prvRemoveTimerFromActiveList( &( _pWheelTimers[ 0 ] ) );
+    }
+
+#endif /* if ( configUSE_TIMER_WHEEL == 1 ) */
+
+/*-----------------------------------------------------------*/
@@ -105,6 +105,10 @@
 /* Memory allocation function configuration for the MQTT library. The MQTT library
  * will be affected by IOT_STATIC_MEMORY_ONLY. */
 #if IOT_STATIC_MEMORY_ONLY == 0
+    /* The task pool and MQTT libraries take their small, frequent allocations
+     * from the magazine caches of the platform memory component. */
+    #include "platform/iot_memory.h"
+
     #define IotMetrics_MallocTcpConnection       pvPortMalloc
     #define IotMetrics_FreeTcpConnection         vPortFree
     #define IotMetrics_MallocIpAddress           pvPortMalloc
@@ -112,19 +116,19 @@
 
     #define IotTaskPool_MallocTaskPool           pvPortMalloc
     #define IotTaskPool_FreeTaskPool             vPortFree
-    #define IotTaskPool_MallocJob                pvPortMalloc
-    #define IotTaskPool_FreeJob                  vPortFree
-    #define IotTaskPool_MallocTimerEvent         pvPortMalloc
-    #define IotTaskPool_FreeTimerEvent           vPortFree
+    #define IotTaskPool_MallocJob                IotMemory_Malloc
+    #define IotTaskPool_FreeJob                  IotMemory_Free
+    #define IotTaskPool_MallocTimerEvent         IotMemory_Malloc
+    #define IotTaskPool_FreeTimerEvent           IotMemory_Free
 
     #define IotMqtt_MallocConnection             pvPortMalloc
     #define IotMqtt_FreeConnection               vPortFree
-    #define IotMqtt_MallocMessage                pvPortMalloc
-    #define IotMqtt_FreeMessage                  vPortFree
-    #define IotMqtt_MallocOperation              pvPortMalloc
-    #define IotMqtt_FreeOperation                vPortFree
-    #define IotMqtt_MallocSubscription           pvPortMalloc
-    #define IotMqtt_FreeSubscription             vPortFree
+    #define IotMqtt_MallocMessage                IotMemory_Malloc
+    #define IotMqtt_FreeMessage                  IotMemory_Free
+    #define IotMqtt_MallocOperation              IotMemory_Malloc
+    #define IotMqtt_FreeOperation                IotMemory_Free
+    #define IotMqtt_MallocSubscription           IotMemory_Malloc
+    #define IotMqtt_FreeSubscription             IotMemory_Free
 
     #define IotSerializer_MallocCborEncoder      pvPortMalloc
     #define IotSerializer_FreeCborEncoder        vPortFree
@@ -187,7 +191,7 @@ extern int snprintf( char *,
                      const char *,
                      ... );
 #define UnityPrint( X )          configPRINTF( ( X ) )
-#define UnityPrintNumber( X )    { char number[ 12 ] = { 0 }; snprintf( number, 12, "%d", X ); configPRINTF( ( number ) ); }
+#define UnityPrintNumber( X )    { char number[ 12 ] = { 0 }; snprintf( number, 12, "%d", ( int ) ( X ) ); configPRINTF( ( number ) ); }
 #undef UNITY_PRINT_EOL
 #define UNITY_PRINT_EOL()        configPRINTF( ( "\r\n" ) )
 
@@ -0,0 +1,60 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * The configuration the heap implementations are built with by the heap
+ * benchmark.  Only the definitions the heap files and the headers they include
+ * need are set; no scheduler runs.
+ */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+/* The size of the heap, which can be set on the command line of make with
+HEAP_SIZE=<bytes>. */
+#ifndef benchHEAP_SIZE
+	#define benchHEAP_SIZE	( 256U * 1024U )
+#endif
+
+#define configUSE_PREEMPTION					1
+#define configUSE_IDLE_HOOK						0
+#define configUSE_TICK_HOOK						0
+#define configTICK_RATE_HZ						( 1000 )
+#define configMAX_PRIORITIES					( 7 )
+#define configMINIMAL_STACK_SIZE				( ( unsigned short ) 128 )
+#define configUSE_16_BIT_TICKS					0
+#define configSUPPORT_DYNAMIC_ALLOCATION		1
+#define configSUPPORT_STATIC_ALLOCATION			0
+#define configUSE_MALLOC_FAILED_HOOK			0
+
+/* heap_5.c is given its memory with vPortDefineHeapRegions(), the other heaps
+allocate an array of configTOTAL_HEAP_SIZE bytes. */
+#ifndef benchDEFINE_HEAP_REGIONS
+	#define configTOTAL_HEAP_SIZE				( ( size_t ) benchHEAP_SIZE )
+#endif
+
+#endif /* FREERTOS_CONFIG_H */
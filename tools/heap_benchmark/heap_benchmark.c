@@ -0,0 +1,452 @@
+/*
+ * FreeRTOS Kernel V10.2.0
+ * Copyright (C) 2019 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://www.FreeRTOS.org
+ * http://aws.amazon.com/freertos
+ *
+ * 1 tab == 4 spaces!
+ */
+
+/*
+ * Replays an allocation trace against one of the FreeRTOS heap implementations
+ * and reports the latency of pvPortMalloc() and vPortFree(), the allocations
+ * that failed, and the free heap space.  The Makefile builds one executable
+ * per heap implementation, so that the same trace can be replayed against each.
+ *
+ * A trace is a text file with one operation per line:
+ *
+ *   m <id> <size>   pvPortMalloc( size ), the result is known as <id>.
+ *   f <id>          vPortFree() of the memory allocated as <id>.
+ *
+ * Any other line is ignored.  <id> is any integer, typically the address
+ * returned on the device, as printed by traceMALLOC() and traceFREE(); an <id>
+ * of 0 marks an allocation that failed on the device, which is replayed but
+ * never freed.
+ *
+ * Usage:
+ *
+ *   heap_benchmark_heap_4 [-r <repeat>] <trace>
+ *   heap_benchmark_heap_4 -g <operations> [<seed>] > <trace>
+ *
+ * -g writes a synthetic trace that mixes short lived small and medium blocks,
+ * like the messages and packets of MQTT, with long lived large blocks, like the
+ * record buffers of TLS sessions.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* FreeRTOS includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* The largest number of blocks allocated at the same time in a trace. */
+#define benchMAX_LIVE_BLOCKS		( 1U << 16 )
+
+/* Size of the table that maps trace ids to live blocks, a power of two. */
+#define benchID_TABLE_SIZE			( benchMAX_LIVE_BLOCKS * 4U )
+
+/* The most short lived blocks live at the same time in a synthetic trace,
+sized so that a synthetic trace fits, though tightly, in the default heap. */
+#define benchSYNTHETIC_MAX_LIVE		512UL
+
+/*-----------------------------------------------------------*/
+
+/* An operation of the trace, with the trace id replaced by a slot in the table
+of live blocks. */
+typedef struct BenchOperation
+{
+	uint32_t ulSlot;	/*<< The slot of the block in pvLiveBlocks. */
+	uint32_t ulSize;	/*<< The size to allocate, or 0 to free the block. */
+} BenchOperation_t;
+
+/* An entry of the table that maps trace ids to slots. */
+typedef struct BenchId
+{
+	unsigned long long ullId;	/*<< The trace id. */
+	uint32_t ulSlot;			/*<< The slot + 1, 0 if the entry is unused. */
+} BenchId_t;
+
+/*-----------------------------------------------------------*/
+
+/* The scheduler does not run, so there is nothing to suspend. */
+void vTaskSuspendAll( void )
+{
+}
+
+BaseType_t xTaskResumeAll( void )
+{
+	return pdFALSE;
+}
+
+#ifdef benchNO_MINIMUM_EVER_FREE_HEAP_SIZE
+	/* heap_2.c does not keep the low water mark of the free heap. */
+	size_t xPortGetMinimumEverFreeHeapSize( void )
+	{
+		return 0;
+	}
+#endif
+
+#ifdef benchDEFINE_HEAP_REGIONS
+	/* heap_5.c is given two regions, so that replays also cross regions. */
+	static uint8_t ucRegion1[ benchHEAP_SIZE / 2 ];
+	static uint8_t ucRegion2[ benchHEAP_SIZE - ( benchHEAP_SIZE / 2 ) ];
+#endif
+
+/*-----------------------------------------------------------*/
+
+static BenchOperation_t *pxOperations = NULL;
+static size_t xOperationCount = 0;
+static void *pvLiveBlocks[ benchMAX_LIVE_BLOCKS ];
+static uint32_t ulSlotCount = 0;
+
+/*-----------------------------------------------------------*/
+
+static uint64_t prvNowNs( void )
+{
+struct timespec xNow;
+
+	clock_gettime( CLOCK_MONOTONIC, &xNow );
+
+	return ( ( uint64_t ) xNow.tv_sec * 1000000000ULL ) + ( uint64_t ) xNow.tv_nsec;
+}
+/*-----------------------------------------------------------*/
+
+static BenchId_t *prvFindId( BenchId_t *pxTable, unsigned long long ullId )
+{
+size_t xIndex = ( size_t ) ( ( ullId * 0x9E3779B97F4A7C15ULL ) >> 40 ) & ( benchID_TABLE_SIZE - 1U );
+
+	/* Open addressing; entries are never removed, only marked unused, so the
+	search stops at the first never used entry. */
+	while( ( pxTable[ xIndex ].ulSlot != 0U ) || ( pxTable[ xIndex ].ullId != 0ULL ) )
+	{
+		if( ( pxTable[ xIndex ].ullId == ullId ) && ( pxTable[ xIndex ].ulSlot != 0U ) )
+		{
+			break;
+		}
+
+		xIndex = ( xIndex + 1U ) & ( benchID_TABLE_SIZE - 1U );
+	}
+
+	return &( pxTable[ xIndex ] );
+}
+/*-----------------------------------------------------------*/
+
+static int prvLoadTrace( const char *pcPath )
+{
+FILE *pxFile;
+char cLine[ 128 ], cType;
+unsigned long long ullId;
+unsigned long ulSize;
+BenchId_t *pxTable, *pxEntry;
+uint32_t *pulFreeSlots, ulFreeSlotCount = 0;
+size_t xCapacity = 1024;
+
+	pxFile = fopen( pcPath, "r" );
+
+	if( pxFile == NULL )
+	{
+		perror( pcPath );
+		return -1;
+	}
+
+	pxTable = calloc( benchID_TABLE_SIZE, sizeof( BenchId_t ) );
+	pulFreeSlots = malloc( benchMAX_LIVE_BLOCKS * sizeof( uint32_t ) );
+	pxOperations = malloc( xCapacity * sizeof( BenchOperation_t ) );
+
+	while( fgets( cLine, sizeof( cLine ), pxFile ) != NULL )
+	{
+		ulSize = 0;
+
+		if( ( sscanf( cLine, " %c %lli %lu", &cType, &ullId, &ulSize ) < 2 ) || ( ( cType != 'm' ) && ( cType != 'f' ) ) )
+		{
+			continue;
+		}
+
+		if( xOperationCount == xCapacity )
+		{
+			xCapacity *= 2;
+			pxOperations = realloc( pxOperations, xCapacity * sizeof( BenchOperation_t ) );
+		}
+
+		if( cType == 'm' )
+		{
+			if( ulSize == 0 )
+			{
+				continue;
+			}
+
+			/* Take a slot for the block; allocations that failed on the
+			device keep theirs for ever. */
+			if( ulFreeSlotCount > 0 )
+			{
+				pxOperations[ xOperationCount ].ulSlot = pulFreeSlots[ --ulFreeSlotCount ];
+			}
+			else if( ulSlotCount < benchMAX_LIVE_BLOCKS )
+			{
+				pxOperations[ xOperationCount ].ulSlot = ulSlotCount++;
+			}
+			else
+			{
+				fprintf( stderr, "More than %u blocks live at the same time.\n", benchMAX_LIVE_BLOCKS );
+				return -1;
+			}
+
+			pxOperations[ xOperationCount ].ulSize = ( uint32_t ) ulSize;
+
+			if( ullId != 0ULL )
+			{
+				pxEntry = prvFindId( pxTable, ullId );
+				pxEntry->ullId = ullId;
+				pxEntry->ulSlot = pxOperations[ xOperationCount ].ulSlot + 1U;
+			}
+
+			xOperationCount++;
+		}
+		else
+		{
+			pxEntry = prvFindId( pxTable, ullId );
+
+			/* Frees of blocks allocated before the trace started are skipped. */
+			if( pxEntry->ulSlot != 0U )
+			{
+				pxOperations[ xOperationCount ].ulSlot = pxEntry->ulSlot - 1U;
+				pxOperations[ xOperationCount ].ulSize = 0;
+				pulFreeSlots[ ulFreeSlotCount++ ] = pxEntry->ulSlot - 1U;
+				pxEntry->ulSlot = 0U;
+				xOperationCount++;
+			}
+		}
+	}
+
+	fclose( pxFile );
+	free( pxTable );
+	free( pulFreeSlots );
+
+	return 0;
+}
+/*-----------------------------------------------------------*/
+
+static void prvGenerateTrace( unsigned long ulOperations, unsigned int uxSeed )
+{
+unsigned long ulOperation, ulNextId = 1, ulId;
+unsigned long ulLive[ benchSYNTHETIC_MAX_LIVE ], ulLiveCount = 0;
+unsigned long ulLongLived[ 8 ], ulLongLivedCount = 0;
+unsigned long ulSize;
+unsigned int uxIndex, uxChoice;
+
+	srand( uxSeed );
+
+	for( ulOperation = 0; ulOperation < ulOperations; ulOperation++ )
+	{
+		uxChoice = ( unsigned int ) rand() % 100U;
+
+		if( uxChoice < 2U )
+		{
+			/* A TLS session closes and another opens: free a long lived block
+			and allocate one of a similar size. */
+			if( ulLongLivedCount == 8U )
+			{
+				uxIndex = ( unsigned int ) rand() % 8U;
+				printf( "f %lu\n", ulLongLived[ uxIndex ] );
+				ulLongLived[ uxIndex ] = ulLongLived[ --ulLongLivedCount ];
+			}
+
+			ulSize = 4096UL + ( ( unsigned long ) rand() % 12288UL );
+			ulId = ulNextId++;
+			printf( "m %lu %lu\n", ulId, ulSize );
+			ulLongLived[ ulLongLivedCount++ ] = ulId;
+		}
+		else if( ( uxChoice < 52U ) && ( ulLiveCount < benchSYNTHETIC_MAX_LIVE ) )
+		{
+			/* Mostly small blocks, such as subscriptions, operations and
+			jobs, some medium blocks such as packets. */
+			if( ( ( unsigned int ) rand() % 8U ) == 0U )
+			{
+				ulSize = 256UL + ( ( unsigned long ) rand() % 1792UL );
+			}
+			else
+			{
+				ulSize = 8UL + ( ( unsigned long ) rand() % 120UL );
+			}
+
+			ulId = ulNextId++;
+			printf( "m %lu %lu\n", ulId, ulSize );
+			ulLive[ ulLiveCount++ ] = ulId;
+		}
+		else if( ulLiveCount > 0U )
+		{
+			/* Free a random short lived block, so that blocks are freed in a
+			different order than they were allocated. */
+			uxIndex = ( unsigned int ) ( ( unsigned long ) rand() % ulLiveCount );
+			printf( "f %lu\n", ulLive[ uxIndex ] );
+			ulLive[ uxIndex ] = ulLive[ --ulLiveCount ];
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+static int prvCompareLatencies( const void *pvA, const void *pvB )
+{
+uint32_t ulA = *( const uint32_t * ) pvA, ulB = *( const uint32_t * ) pvB;
+
+	return ( ulA > ulB ) - ( ulA < ulB );
+}
+/*-----------------------------------------------------------*/
+
+static void prvReport( const char *pcName, uint32_t *pulLatencies, size_t xCount )
+{
+uint64_t ullTotal = 0;
+size_t x;
+
+	if( xCount == 0 )
+	{
+		return;
+	}
+
+	for( x = 0; x < xCount; x++ )
+	{
+		ullTotal += pulLatencies[ x ];
+	}
+
+	qsort( pulLatencies, xCount, sizeof( uint32_t ), prvCompareLatencies );
+
+	printf( "  %-6s %10zu calls  mean %6llu ns  p50 %6u ns  p99 %6u ns  p99.9 %7u ns  max %8u ns\n",
+			pcName,
+			xCount,
+			( unsigned long long ) ( ullTotal / xCount ),
+			pulLatencies[ xCount / 2 ],
+			pulLatencies[ ( xCount * 99 ) / 100 ],
+			pulLatencies[ ( xCount * 999 ) / 1000 ],
+			pulLatencies[ xCount - 1 ] );
+}
+/*-----------------------------------------------------------*/
+
+int main( int argc, char **argv )
+{
+unsigned long ulRepeat = 1, ulRun;
+uint32_t *pulMallocLatencies, *pulFreeLatencies, ulSlot;
+size_t xMallocCount = 0, xFreeCount = 0, xFailures = 0, x;
+uint64_t ullStart;
+int iArgument = 1;
+
+	if( ( argc >= 3 ) && ( strcmp( argv[ 1 ], "-g" ) == 0 ) )
+	{
+		prvGenerateTrace( strtoul( argv[ 2 ], NULL, 0 ), ( argc >= 4 ) ? ( unsigned int ) strtoul( argv[ 3 ], NULL, 0 ) : 1U );
+		return 0;
+	}
+
+	if( ( argc >= 4 ) && ( strcmp( argv[ 1 ], "-r" ) == 0 ) )
+	{
+		ulRepeat = strtoul( argv[ 2 ], NULL, 0 );
+		iArgument = 3;
+	}
+
+	if( ( iArgument != argc - 1 ) || ( prvLoadTrace( argv[ iArgument ] ) != 0 ) )
+	{
+		fprintf( stderr, "Usage: %s [-r <repeat>] <trace>\n       %s -g <operations> [<seed>]\n", argv[ 0 ], argv[ 0 ] );
+		return 1;
+	}
+
+	#ifdef benchDEFINE_HEAP_REGIONS
+	{
+		HeapRegion_t xRegions[] =
+		{
+			{ ucRegion1, sizeof( ucRegion1 ) },
+			{ ucRegion2, sizeof( ucRegion2 ) },
+			{ NULL, 0 }
+		};
+
+		/* heap_5.c needs the regions in address order. */
+		if( ( uintptr_t ) ucRegion2 < ( uintptr_t ) ucRegion1 )
+		{
+			xRegions[ 0 ].pucStartAddress = ucRegion2;
+			xRegions[ 0 ].xSizeInBytes = sizeof( ucRegion2 );
+			xRegions[ 1 ].pucStartAddress = ucRegion1;
+			xRegions[ 1 ].xSizeInBytes = sizeof( ucRegion1 );
+		}
+
+		vPortDefineHeapRegions( xRegions );
+	}
+	#endif
+
+	pulMallocLatencies = malloc( ( xOperationCount * ulRepeat + 1 ) * sizeof( uint32_t ) );
+	pulFreeLatencies = malloc( ( xOperationCount * ulRepeat + ulSlotCount + 1 ) * sizeof( uint32_t ) );
+
+	for( ulRun = 0; ulRun < ulRepeat; ulRun++ )
+	{
+		for( x = 0; x < xOperationCount; x++ )
+		{
+			ulSlot = pxOperations[ x ].ulSlot;
+
+			if( pxOperations[ x ].ulSize != 0U )
+			{
+				ullStart = prvNowNs();
+				pvLiveBlocks[ ulSlot ] = pvPortMalloc( pxOperations[ x ].ulSize );
+				pulMallocLatencies[ xMallocCount++ ] = ( uint32_t ) ( prvNowNs() - ullStart );
+
+				if( pvLiveBlocks[ ulSlot ] == NULL )
+				{
+					xFailures++;
+				}
+				else
+				{
+					/* Touch the block, as the application would. */
+					memset( pvLiveBlocks[ ulSlot ], 0xA5, pxOperations[ x ].ulSize );
+				}
+			}
+			else if( pvLiveBlocks[ ulSlot ] != NULL )
+			{
+				ullStart = prvNowNs();
+				vPortFree( pvLiveBlocks[ ulSlot ] );
+				pulFreeLatencies[ xFreeCount++ ] = ( uint32_t ) ( prvNowNs() - ullStart );
+				pvLiveBlocks[ ulSlot ] = NULL;
+			}
+		}
+
+		/* Free the blocks still allocated at the end of the trace, so that the
+		next run starts from an empty heap. */
+		for( ulSlot = 0; ulSlot < ulSlotCount; ulSlot++ )
+		{
+			if( pvLiveBlocks[ ulSlot ] != NULL )
+			{
+				vPortFree( pvLiveBlocks[ ulSlot ] );
+				pvLiveBlocks[ ulSlot ] = NULL;
+			}
+		}
+	}
+
+	printf( "%s: %zu operations x %lu, %zu failed allocations, %u bytes heap, %zu bytes minimum ever free, %zu bytes free at end\n",
+			benchHEAP_NAME,
+			xOperationCount,
+			ulRepeat,
+			xFailures,
+			( unsigned ) benchHEAP_SIZE,
+			xPortGetMinimumEverFreeHeapSize(),
+			xPortGetFreeHeapSize() );
+	prvReport( "malloc", pulMallocLatencies, xMallocCount );
+	prvReport( "free", pulFreeLatencies, xFreeCount );
+
+	return 0;
+}
@@ -0,0 +1,245 @@
+#!/usr/bin/env python3
+"""Decode binary log records written by the logging library with IOT_LOG_BINARY set to 1.
+
+Records are read from lines that start with '#' and carry a base64 encoded
+record, as printed by the default IotLogging_PutBinary. Other lines are
+printed unchanged. Format strings and library names are read from the ELF
+file of the build that produced the log.
+
+Record format, little endian:
+    uint8   version (low 4 bits), 0x10 if truncated
+    uint8   log level (low 3 bits), 0x10/0x20/0x40 to hide level/library/time
+    int32   library name address - IotLog_BinaryAnchor address
+    int32   format string address - IotLog_BinaryAnchor address
+    uint32  time in milliseconds, unless hidden
+    ...     arguments, in the order of the format string
+
+Usage: decode_binary_log.py aws_tests.elf < log.txt
+"""
+
+import argparse
+import base64
+import re
+import struct
+import sys
+
+LOG_LEVELS = ["", "ERROR", "WARN ", "INFO ", "DEBUG"]
+ANCHOR_SYMBOL = "IotLog_BinaryAnchor"
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|j|z|t|L)?([diouxXcpsfFeEgGaAn%])")
+
+
+class Elf:
+    """The loadable sections and symbols of an ELF file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as elf_file:
+            self.data = elf_file.read()
+
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+
+        self.is64 = self.data[4] == 2
+        self.endian = "<" if self.data[5] == 1 else ">"
+
+        if self.is64:
+            shoff, = self._unpack("Q", 0x28)
+            shentsize, shnum, shstrndx = self._unpack("HHH", 0x3A)
+        else:
+            shoff, = self._unpack("I", 0x20)
+            shentsize, shnum, shstrndx = self._unpack("HHH", 0x2E)
+
+        self.sections = [self._section(shoff + i * shentsize) for i in range(shnum)]
+        names = self.sections[shstrndx]
+
+        for section in self.sections:
+            section["name"] = self._string(names["offset"] + section["name_offset"])
+
+    def _unpack(self, fmt, offset):
+        return struct.unpack_from(self.endian + fmt, self.data, offset)
+
+    def _section(self, offset):
+        if self.is64:
+            name, kind, _, addr, off, size, link, _, _, entsize = self._unpack("IIQQQQIIQQ", offset)
+        else:
+            name, kind, _, addr, off, size, link, _, _, entsize = self._unpack("IIIIIIIIII", offset)
+
+        return {"name_offset": name, "type": kind, "addr": addr, "offset": off,
+                "size": size, "link": link, "entsize": entsize}
+
+    def _string(self, offset):
+        end = self.data.index(b"\0", offset)
+        return self.data[offset:end].decode("utf-8", "replace")
+
+    def symbol(self, wanted):
+        """Return the address of a symbol, from the symbol table."""
+        for section in self.sections:
+            if section["type"] != 2:  # SHT_SYMTAB
+                continue
+
+            strings = self.sections[section["link"]]["offset"]
+
+            for offset in range(section["offset"], section["offset"] + section["size"], section["entsize"]):
+                if self.is64:
+                    name, _, _, _, value, _ = self._unpack("IBBHQQ", offset)
+                else:
+                    name, value, _, _, _, _ = self._unpack("IIIBBH", offset)
+
+                if name != 0 and self._string(strings + name) == wanted:
+                    return value
+
+        raise KeyError("symbol %s not found, is the ELF file stripped?" % wanted)
+
+    def string_at(self, address):
+        """Return the C string at an address, or None if no section holds it."""
+        for section in self.sections:
+            if section["type"] in (1,) and section["addr"] <= address < section["addr"] + section["size"]:
+                return self._string(section["offset"] + address - section["addr"])
+
+        return None
+
+
+class Record:
+    """Reads the fields of a binary log record in order."""
+
+    def __init__(self, data):
+        self.data = data
+        self.position = 0
+
+    def take(self, fmt):
+        size = struct.calcsize("<" + fmt)
+
+        if self.position + size > len(self.data):
+            raise EOFError()
+
+        value, = struct.unpack_from("<" + fmt, self.data, self.position)
+        self.position += size
+        return value
+
+    def take_string(self):
+        length = self.take("B")
+
+        if self.position + length > len(self.data):
+            raise EOFError()
+
+        value = self.data[self.position:self.position + length].decode("utf-8", "replace")
+        self.position += length
+        return value
+
+
+def format_message(fmt, record):
+    """Format a message with the arguments of a record, as printf would."""
+    output = []
+    last = 0
+
+    for match in CONVERSION.finditer(fmt):
+        output.append(fmt[last:match.start()])
+        last = match.end()
+        flags, width, precision, length, conversion = match.groups()
+
+        if conversion == "%":
+            output.append("%")
+            continue
+
+        try:
+            if width == "*":
+                width = str(record.take("i"))
+
+            if precision == "*":
+                precision = str(record.take("i"))
+
+            wide = length in ("l", "ll", "j", "z", "t")
+
+            if conversion in "di":
+                value = record.take("q" if wide else "i")
+            elif conversion in "ouxX":
+                value = record.take("Q" if wide else "I")
+            elif conversion == "c":
+                value = chr(record.take("i") & 0xFF)
+                conversion = "s"
+            elif conversion == "p":
+                value = record.take("Q")
+                conversion = "x"
+                flags += "#"
+            elif conversion == "s":
+                value = record.take_string()
+            elif conversion == "n":
+                continue
+            else:
+                value = record.take("d")
+
+                if conversion in "aA":
+                    output.append(value.hex())
+                    continue
+        except EOFError:
+            output.append("<truncated>")
+            return "".join(output)
+
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "") + conversion.replace("u", "d")
+        output.append(spec % value)
+
+    output.append(fmt[last:])
+    return "".join(output)
+
+
+def decode(elf, anchor, data):
+    """Decode one binary log record to the line the logging library would have printed."""
+    record = Record(data)
+    version = record.take("B")
+
+    if version & 0x0F != 1:
+        raise ValueError("unknown binary log record version %d" % (version & 0x0F))
+
+    flags = record.take("B")
+    library = elf.string_at(anchor + record.take("i"))
+    fmt_address = anchor + record.take("i")
+    fmt = elf.string_at(fmt_address)
+    prefix = ""
+
+    if flags & 0x10 == 0:
+        prefix += "[%s]" % LOG_LEVELS[flags & 0x07]
+
+    if flags & 0x20 == 0:
+        prefix += "[%s]" % library
+
+    if flags & 0x40 == 0:
+        prefix += "[%d]" % record.take("I")
+
+    if prefix:
+        prefix += " "
+
+    if fmt is None:
+        return prefix + "<unknown format string at 0x%x>" % fmt_address
+
+    message = format_message(fmt, record)
+
+    if version & 0x10:
+        message += " <truncated>"
+
+    return prefix + message
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("elf", help="ELF file of the build that produced the log")
+    parser.add_argument("log", nargs="?", type=argparse.FileType("r"), default=sys.stdin,
+                        help="log to decode, standard input by default")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    anchor = elf.symbol(ANCHOR_SYMBOL)
+
+    for line in args.log:
+        line = line.rstrip("\r\n")
+        start = line.find("#")
+
+        if start >= 0:
+            try:
+                line = line[:start] + decode(elf, anchor, base64.b64decode(line[start + 1:], validate=True))
+            except (ValueError, EOFError):
+                pass
+
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
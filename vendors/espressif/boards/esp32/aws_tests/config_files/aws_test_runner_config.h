@@ -58,5 +58,6 @@
 #define testrunnerUTIL_PLATFORM_CLOCK_ENABLED      0
 #define testrunnerFULL_LINEAR_CONTAINERS_ENABLED   0
 #define testrunnerUTIL_PLATFORM_THREADS_ENABLED    0
+#define testrunnerUTIL_PLATFORM_MEMORY_ENABLED     0
 
 #endif /* AWS_TEST_RUNNER_CONFIG_H */
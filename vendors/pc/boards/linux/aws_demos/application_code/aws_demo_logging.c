@@ -0,0 +1,261 @@
+/*
+ * Amazon FreeRTOS V1.4.8
+ * Copyright (C) 2017 Amazon.com, Inc. or its affiliates.  All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of
+ * this software and associated documentation files (the "Software"), to deal in
+ * the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+ * the Software, and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+ * FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ * COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ * http://aws.amazon.com/freertos
+ * http://www.FreeRTOS.org
+ */
+
+
+/*
+ * Logging utility that allows FreeRTOS tasks to log to stdout and a disk file.
+ *
+ * In the Linux simulator each FreeRTOS task runs in its own pthread and the
+ * tick interrupt is simulated with a signal, so a task can be switched out at
+ * any point.  Messages are therefore formatted into a local buffer and written
+ * with write(2), which does not take any C library locks that a switched out
+ * task could be holding.
+ */
+
+/* Standard includes. */
+#include <stdio.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* FreeRTOS includes. */
+#include <FreeRTOS.h>
+#include "task.h"
+
+/* Demo includes. */
+#include "aws_demo_logging.h"
+
+/*-----------------------------------------------------------*/
+
+/* The maximum size to which the log file may grow, before being renamed
+ * to .ful. */
+#define dlLOGGING_FILE_SIZE          ( 40 * 1024 * 1024 )
+
+/* Dimensions the arrays into which print messages are created. */
+#define dlMAX_PRINT_STRING_LENGTH    255
+
+/*-----------------------------------------------------------*/
+
+/*
+ * Called from vLoggingInit() to start a new disk log file.
+ */
+static void prvFileLoggingInit( void );
+
+/*
+ * Attempt to write a message to the file.
+ */
+static void prvLogToFile( const char * pcMessage,
+                          size_t xLength );
+
+/*
+ * Write a message to the selected outputs, either with or without a
+ * time-stamp.
+ */
+static void prvLoggingPrintf( BaseType_t xFormatted,
+                              const char * pcFormat,
+                              va_list * pxArgs );
+
+/*-----------------------------------------------------------*/
+
+/* Stores the selected logging targets passed in as parameters to the
+ * vLoggingInit() function. */
+BaseType_t xStdoutLoggingUsed = pdTRUE,
+           xDiskFileLoggingUsed = pdFALSE;
+
+/* File descriptor of the file used for logging, or -1 if it is not open. */
+static int iLoggingFile = -1;
+
+/* File names for the in use and complete (full) log files. */
+static const char * pcLogFileName = "RTOSDemo.log";
+static const char * pcFullLogFileName = "RTOSDemo.ful";
+
+/* Keep the current file size in a variable, as an optimisation. */
+static size_t ulSizeOfLoggingFile = 0;
+
+/*-----------------------------------------------------------*/
+
+void vLoggingInit( BaseType_t xLogToStdout,
+                   BaseType_t xLogToFile,
+                   BaseType_t xLogToUDP,
+                   uint32_t ulRemoteIPAddress,
+                   uint16_t usRemotePort )
+{
+    /* Can only be called before the scheduler has started. */
+    configASSERT( xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED );
+
+    /* Logging to a UDP port is not supported by the Linux simulator. */
+    ( void ) xLogToUDP;
+    ( void ) ulRemoteIPAddress;
+    ( void ) usRemotePort;
+
+    xStdoutLoggingUsed = xLogToStdout;
+    xDiskFileLoggingUsed = xLogToFile;
+
+    if( xDiskFileLoggingUsed != pdFALSE )
+    {
+        prvFileLoggingInit();
+    }
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrintf( const char * pcFormat,
+                     ... )
+{
+    va_list xArgs;
+
+    va_start( xArgs, pcFormat );
+    prvLoggingPrintf( pdTRUE, pcFormat, &xArgs );
+    va_end( xArgs );
+}
+/*-----------------------------------------------------------*/
+
+void vLoggingPrint( const char * pcFormat )
+{
+    prvLoggingPrintf( pdFALSE, pcFormat, NULL );
+}
+/*-----------------------------------------------------------*/
+
+static void prvLoggingPrintf( BaseType_t xFormatted,
+                              const char * pcFormat,
+                              va_list * pxArgs )
+{
+    char cPrintString[ dlMAX_PRINT_STRING_LENGTH ];
+    size_t xLength = 0;
+    int iLength;
+    static unsigned long ulMessageNumber = 0;
+    const char * pcTaskName = "None";
+
+    if( ( xStdoutLoggingUsed != pdFALSE ) ||
+        ( xDiskFileLoggingUsed != pdFALSE ) )
+    {
+        if( ( strcmp( pcFormat, "\n" ) != 0 ) && ( xFormatted != pdFALSE ) )
+        {
+            /* Additional info to place at the start of the log. */
+            if( xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED )
+            {
+                pcTaskName = pcTaskGetName( NULL );
+            }
+
+            iLength = snprintf( cPrintString,
+                                dlMAX_PRINT_STRING_LENGTH,
+                                "%lu %lu [%s] ",
+                                ulMessageNumber++,
+                                ( unsigned long ) xTaskGetTickCount(),
+                                pcTaskName );
+
+            if( iLength > 0 )
+            {
+                xLength = ( size_t ) iLength;
+            }
+        }
+
+        if( pxArgs != NULL )
+        {
+            iLength = vsnprintf( cPrintString + xLength,
+                                 dlMAX_PRINT_STRING_LENGTH - xLength,
+                                 pcFormat,
+                                 *pxArgs );
+        }
+        else
+        {
+            iLength = snprintf( cPrintString + xLength,
+                                dlMAX_PRINT_STRING_LENGTH - xLength,
+                                "%s",
+                                pcFormat );
+        }
+
+        if( iLength > 0 )
+        {
+            xLength += ( size_t ) iLength;
+        }
+
+        /* Truncated messages are still logged, up to the buffer size. */
+        if( xLength >= dlMAX_PRINT_STRING_LENGTH )
+        {
+            xLength = dlMAX_PRINT_STRING_LENGTH - 1;
+        }
+
+        if( xStdoutLoggingUsed != pdFALSE )
+        {
+            ( void ) write( STDOUT_FILENO, cPrintString, xLength );
+        }
+
+        if( xDiskFileLoggingUsed != pdFALSE )
+        {
+            vTaskSuspendAll();
+            {
+                prvLogToFile( cPrintString, xLength );
+            }
+            ( void ) xTaskResumeAll();
+        }
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvFileLoggingInit( void )
+{
+    iLoggingFile = open( pcLogFileName, O_WRONLY | O_CREAT | O_APPEND, 0644 );
+
+    if( iLoggingFile >= 0 )
+    {
+        ulSizeOfLoggingFile = ( size_t ) lseek( iLoggingFile, 0, SEEK_END );
+    }
+    else
+    {
+        ulSizeOfLoggingFile = 0ul;
+    }
+}
+/*-----------------------------------------------------------*/
+
+static void prvLogToFile( const char * pcMessage,
+                          size_t xLength )
+{
+    if( iLoggingFile < 0 )
+    {
+        prvFileLoggingInit();
+    }
+
+    if( iLoggingFile >= 0 )
+    {
+        if( write( iLoggingFile, pcMessage, xLength ) > 0 )
+        {
+            ulSizeOfLoggingFile += xLength;
+        }
+
+        /* If the file has grown to its maximum permissible size then close and
+         * rename it - then start with a new file. */
+        if( ulSizeOfLoggingFile > ( size_t ) dlLOGGING_FILE_SIZE )
+        {
+            close( iLoggingFile );
+            iLoggingFile = -1;
+
+            ( void ) rename( pcLogFileName, pcFullLogFileName );
+            ulSizeOfLoggingFile = 0;
+        }
+    }
+}
+/*-----------------------------------------------------------*/